@@ -310,12 +310,13 @@ int main(int argc, char *argv[])
                 Request_Invoke_ID = Send_Delete_Object_Request(
                     Target_Device_Object_Instance, Target_Object_Type,
                     Target_Object_Instance);
-            } else if (tsm_invoke_id_free(Request_Invoke_ID)) {
+            } else if (tsm_invoke_id_free(&Target_Address, Request_Invoke_ID)) {
                 break;
-            } else if (tsm_invoke_id_failed(Request_Invoke_ID)) {
+            } else if (tsm_invoke_id_failed(
+                           &Target_Address, Request_Invoke_ID)) {
                 MyPrintHandler(
                     ERROR_CLASS_COMMUNICATION, ERROR_CODE_ABORT_TSM_TIMEOUT);
-                tsm_free_invoke_id(Request_Invoke_ID);
+                tsm_free_invoke_id(&Target_Address, Request_Invoke_ID);
                 Error_Detected = true;
                 /* abort */
                 break;
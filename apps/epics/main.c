@@ -1523,14 +1523,16 @@ int main(int argc, char *argv[])
                     Read_Property_Multiple_Data.new_data = false;
                     myState = ProcessRPMData(
                         Read_Property_Multiple_Data.rpm_data, myState);
-                    if (tsm_invoke_id_free(Request_Invoke_ID)) {
+                    if (tsm_invoke_id_free(
+                            &Target_Address, Request_Invoke_ID)) {
                         Request_Invoke_ID = 0;
                     } else {
                         assert(false); /* How can this be? */
                         Request_Invoke_ID = 0;
                     }
                     elapsed_seconds = 0;
-                } else if (tsm_invoke_id_free(Request_Invoke_ID)) {
+                } else if (tsm_invoke_id_free(
+                               &Target_Address, Request_Invoke_ID)) {
                     elapsed_seconds = 0;
                     Request_Invoke_ID = 0;
                     if (myState == GET_HEADING_RESPONSE) {
@@ -1561,9 +1563,10 @@ int main(int argc, char *argv[])
                     } else {
                         myState = GET_PROPERTY_REQUEST;
                     }
-                } else if (tsm_invoke_id_failed(Request_Invoke_ID)) {
+                } else if (tsm_invoke_id_failed(
+                               &Target_Address, Request_Invoke_ID)) {
                     fprintf(stderr, "\rError: TSM Timeout!\n");
-                    tsm_free_invoke_id(Request_Invoke_ID);
+                    tsm_free_invoke_id(&Target_Address, Request_Invoke_ID);
                     Request_Invoke_ID = 0;
                     elapsed_seconds = 0;
                     if (myState == GET_HEADING_RESPONSE) {
@@ -1621,7 +1624,8 @@ int main(int argc, char *argv[])
                         Read_Property_Multiple_Data.rpm_data->object_type,
                         Read_Property_Multiple_Data.rpm_data->object_instance,
                         Read_Property_Multiple_Data.rpm_data->listOfProperties);
-                    if (tsm_invoke_id_free(Request_Invoke_ID)) {
+                    if (tsm_invoke_id_free(
+                            &Target_Address, Request_Invoke_ID)) {
                         Request_Invoke_ID = 0;
                     } else {
                         assert(false); /* How can this be? */
@@ -1640,7 +1644,8 @@ int main(int argc, char *argv[])
                         Property_List_Index++;
                     }
                     myState = GET_PROPERTY_REQUEST; /* Go fetch next Property */
-                } else if (tsm_invoke_id_free(Request_Invoke_ID)) {
+                } else if (tsm_invoke_id_free(
+                               &Target_Address, Request_Invoke_ID)) {
                     Request_Invoke_ID = 0;
                     elapsed_seconds = 0;
                     myState = GET_PROPERTY_REQUEST;
@@ -1677,9 +1682,10 @@ int main(int argc, char *argv[])
                             }
                         }
                     }
-                } else if (tsm_invoke_id_failed(Request_Invoke_ID)) {
+                } else if (tsm_invoke_id_failed(
+                               &Target_Address, Request_Invoke_ID)) {
                     fprintf(stderr, "\rError: TSM Timeout!\n");
-                    tsm_free_invoke_id(Request_Invoke_ID);
+                    tsm_free_invoke_id(&Target_Address, Request_Invoke_ID);
                     elapsed_seconds = 0;
                     Request_Invoke_ID = 0;
                     myState = 3; /* Let's try again, same Property */
@@ -28,6 +28,7 @@
 #include "bacnet/basic/tsm/tsm.h"
 #include "bacnet/basic/services.h"
 #include "bacnet/basic/sys/debug.h"
+#include "bacnet/basic/sys/mstimer.h"
 #include "bacnet/datalink/datalink.h"
 #include "bacnet/datalink/dlenv.h"
 /* include the device object */
@@ -101,9 +102,10 @@ static void Initialize_Device_Addresses(void)
     int i = 0; /* First entry is Gateway Device */
     uint32_t virtual_mac = 0;
     BACNET_ADDRESS virtual_address = { 0 };
+    BACNET_ADDRESS device_address = { 0 };
     DEVICE_OBJECT_DATA *pDev = NULL;
     /* Setup info for the main gateway device first */
-    pDev = Get_Routed_Device_Object(i);
+    Get_Routed_Device_Object(i);
 
     /* we can't use datalink_get_my_address() since it is
        mapped to routed_get_my_address() in this app
@@ -121,7 +123,7 @@ static void Initialize_Device_Addresses(void)
 #else
 #error "No support for this Data Link Layer type "
 #endif
-    bacnet_address_copy(&pDev->bacDevAddr, &virtual_address);
+    Routed_Device_Set_Address(&virtual_address);
     /* broadcast an I-Am on startup */
     Send_I_Am(&Handler_Transmit_Buffer[0]);
 
@@ -131,13 +133,14 @@ static void Initialize_Device_Addresses(void)
             continue;
         }
         /* start with the router address */
-        bacnet_address_copy(&pDev->bacDevAddr, &virtual_address);
+        bacnet_address_copy(&device_address, &virtual_address);
         /* add the network number to each gateway device */
-        pDev->bacDevAddr.net = VIRTUAL_DNET;
+        device_address.net = VIRTUAL_DNET;
         /* use a virtual MAC for each gateway device */
         virtual_mac = pDev->bacObj.Object_Instance_Number;
-        encode_unsigned24(&pDev->bacDevAddr.adr[0], virtual_mac);
-        pDev->bacDevAddr.len = 3;
+        encode_unsigned24(&device_address.adr[0], virtual_mac);
+        device_address.len = 3;
+        Routed_Device_Set_Address(&device_address);
     }
 }
 
@@ -213,7 +216,11 @@ int main(int argc, char *argv[])
     time_t current_seconds = 0;
     uint32_t elapsed_seconds = 0;
     uint32_t elapsed_milliseconds = 0;
+    unsigned long last_milliseconds = 0;
+    unsigned long current_milliseconds = 0;
     uint32_t first_object_instance = FIRST_DEVICE_NUMBER;
+    uint16_t iam_rate = 0, iam_jitter = 0, iam_window = 0;
+    char *pEnv = NULL;
 #ifdef BACNET_TEST_VMAC
     /* Router data */
     BACNET_DEVICE_PROFILE *device;
@@ -242,6 +249,21 @@ int main(int argc, char *argv[])
     atexit(datalink_cleanup);
     Devices_Init(first_object_instance);
     Initialize_Device_Addresses();
+    /* pace the I-Am replies of the routed Devices to a global Who-Is */
+    pEnv = getenv("BACNET_IAM_RATE");
+    if (pEnv) {
+        iam_rate = (uint16_t)strtol(pEnv, NULL, 0);
+        pEnv = getenv("BACNET_IAM_JITTER");
+        if (pEnv) {
+            iam_jitter = (uint16_t)strtol(pEnv, NULL, 0);
+        }
+        pEnv = getenv("BACNET_IAM_WINDOW");
+        if (pEnv) {
+            iam_window = (uint16_t)strtol(pEnv, NULL, 0);
+        }
+        handler_who_is_pacing_size_set(MAX_NUM_DEVICES);
+        handler_who_is_pacing_set(iam_rate, iam_jitter, iam_window);
+    }
 
 #ifdef BACNET_TEST_VMAC
     /* initialize vmac table and router device */
@@ -250,6 +272,7 @@ int main(int argc, char *argv[])
 #endif
     /* configure the timeout values */
     last_seconds = time(NULL);
+    last_milliseconds = mstimer_now();
 
     /* broadcast an I-am-router-to-network on startup */
     printf("Remote Network DNET Number %d \n", DNET_list[0]);
@@ -279,6 +302,12 @@ int main(int argc, char *argv[])
             Device_Timer(elapsed_milliseconds);
         }
         handler_cov_task();
+        current_milliseconds = mstimer_now();
+        handler_who_is_pacing_timer(
+            (uint16_t)(current_milliseconds - last_milliseconds));
+        last_milliseconds = current_milliseconds;
+        /* wake up in time for the next paced I-Am */
+        timeout = handler_who_is_pacing_pending() ? 1 : 1000;
         if (Routed_Device_Index < MAX_NUM_DEVICES) {
             Routed_Device_Index++;
             Get_Routed_Device_Object(Routed_Device_Index);
@@ -248,13 +248,14 @@ int main(int argc, char *argv[])
                 Request_Invoke_ID = Send_GetEvent(
                     &Target_Address, &LastReceivedObjectIdentifier);
                 More_Events = false;
-            } else if (tsm_invoke_id_free(Request_Invoke_ID)) {
+            } else if (tsm_invoke_id_free(&Target_Address, Request_Invoke_ID)) {
                 if (Recieved_Ack) {
                     break;
                 }
-            } else if (tsm_invoke_id_failed(Request_Invoke_ID)) {
+            } else if (tsm_invoke_id_failed(
+                           &Target_Address, Request_Invoke_ID)) {
                 fprintf(stderr, "\rError: TSM Timeout!\r\n");
-                tsm_free_invoke_id(Request_Invoke_ID);
+                tsm_free_invoke_id(&Target_Address, Request_Invoke_ID);
                 Error_Detected = true;
                 /* try again or abort? */
                 break;
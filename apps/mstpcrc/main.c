@@ -18,7 +18,9 @@
 #include "bacnet/bacdef.h"
 /* BACnet Stack API */
 #include "bacnet/basic/sys/mstimer.h"
+#include "bacnet/datalink/cobs.h"
 #include "bacnet/datalink/crc.h"
+#include "bacnet/datalink/mstpdef.h"
 #include "bacnet/version.h"
 /* OS specific include*/
 #include "bacport.h"
@@ -236,12 +238,72 @@ static void Process_Text_File(void)
     }
 }
 
+/**
+ * @brief Print the time taken by each CRC-32K implementation to check
+ *  the largest BACnet extended frame a number of times.
+ * @param count - number of frames to check with each implementation
+ */
+static void Benchmark_CRC32K(unsigned long count)
+{
+    static uint8_t frame[Nmax_COBS_length_BACnet];
+    uint32_t crc[3] = { CRC32K_INITIAL_VALUE, CRC32K_INITIAL_VALUE,
+                        CRC32K_INITIAL_VALUE };
+    const char *name[3] = { "bitwise", "table", "buffer" };
+    clock_t start, ticks[3];
+    unsigned long n;
+    unsigned i, k;
+    double seconds;
+
+    for (i = 0; i < sizeof(frame); i++) {
+        frame[i] = (uint8_t)rand();
+    }
+    for (k = 0; k < 3; k++) {
+        start = clock();
+        for (n = 0; n < count; n++) {
+            if (k == 0) {
+                for (i = 0; i < sizeof(frame); i++) {
+                    crc[k] = cobs_crc32k_bitwise(frame[i], crc[k]);
+                }
+            } else if (k == 1) {
+                for (i = 0; i < sizeof(frame); i++) {
+                    crc[k] = cobs_crc32k(frame[i], crc[k]);
+                }
+            } else {
+                crc[k] = cobs_crc32k_buffer(frame, sizeof(frame), crc[k]);
+            }
+        }
+        ticks[k] = clock() - start;
+    }
+    printf(
+        "CRC-32K of %lu frames of %u octets%s\r\n", count,
+        (unsigned)sizeof(frame),
+#if defined(COBS_CRC32K_SLICE_BY_8)
+        ", buffer is slice-by-8"
+#else
+        ""
+#endif
+    );
+    for (k = 0; k < 3; k++) {
+        seconds = (double)ticks[k] / CLOCKS_PER_SEC;
+        printf(
+            "%-8s %8.3f s %10.1f MB/s 0x%08lX\r\n", name[k], seconds,
+            (seconds > 0.0)
+                ? ((double)count * sizeof(frame)) / (seconds * 1000000.0)
+                : 0.0,
+            (unsigned long)crc[k]);
+    }
+    if ((crc[0] != crc[1]) || (crc[0] != crc[2])) {
+        printf("CRC-32K mismatch!\r\n");
+    }
+}
+
 /* simple program to CRC the data and print the CRC */
 int main(int argc, char *argv[])
 {
     /* accumulates the crc value */
     uint8_t crc8 = 0xff;
     uint16_t crc16 = 0xffff;
+    uint32_t crc32 = CRC32K_INITIAL_VALUE;
     unsigned i = 0;
 
     /* initialize our interface */
@@ -256,7 +318,9 @@ int main(int argc, char *argv[])
             "[-8] calculate the MS/TP 8-bit Header CRC (default)\r\n"
             "[-16] calculate the MS/TP 16-bit Data CRC\r\n"
             "[-32] calculate the MS/TP 32-bit Extended Frame CRC\r\n"
-            "[-f filename] read MS/TP capture data from text file\r\n"
+            "[-f filename] read MS/TP capture data from text file\r\n");
+        printf(
+            "--benchmark [count] time the CRC-32K implementations\r\n"
             "Note: MS/TP Header CRC does not include the 55 FF preamble.\r\n");
         return 0;
     }
@@ -269,6 +333,10 @@ int main(int argc, char *argv[])
             "FITNESS FOR A PARTICULAR PURPOSE.\r\n");
         return 0;
     }
+    if ((argc > 1) && (strcmp(argv[1], "--benchmark") == 0)) {
+        Benchmark_CRC32K((argc > 2) ? strtoul(argv[2], NULL, 0) : 10000UL);
+        return 0;
+    }
     Parse_Arguments(argc, argv);
     if (MSTP_Text_File) {
         Process_Text_File();
@@ -281,6 +349,8 @@ int main(int argc, char *argv[])
                     crc8 = CRC_Calc_Header(CRC_Buffer[i], crc8);
                 } else if (CRC_Size == 16) {
                     crc16 = CRC_Calc_Data(CRC_Buffer[i], crc16);
+                } else if (CRC_Size == 32) {
+                    crc32 = cobs_crc32k(CRC_Buffer[i], crc32);
                 }
                 if (ASCII_Decimal) {
                     printf("%u\r\n", (unsigned)CRC_Buffer[i]);
@@ -304,6 +374,19 @@ int main(int argc, char *argv[])
                     printf("0x%02X Data CRC\r\n", (crc16 & 0xFF));
                     printf("0x%02X Data CRC\r\n", (crc16 >> 8));
                 }
+            } else if (CRC_Size == 32) {
+                crc32 = ~crc32;
+                for (i = 0; i < 4; i++) {
+                    if (ASCII_Decimal) {
+                        printf(
+                            "%u Extended Frame CRC\r\n",
+                            (unsigned)((crc32 >> (8 * i)) & 0xFF));
+                    } else {
+                        printf(
+                            "0x%02X Extended Frame CRC\r\n",
+                            (unsigned)((crc32 >> (8 * i)) & 0xFF));
+                    }
+                }
             }
         }
     }
@@ -360,7 +360,8 @@ int main(int argc, char *argv[])
             }
             /* has the previous invoke id expired or returned?
                note: invoke ID = 0 is invalid, so it will be idle */
-            if ((invoke_id == 0) || tsm_invoke_id_free(invoke_id)) {
+            if ((invoke_id == 0) ||
+                tsm_invoke_id_free(&Target_Address, invoke_id)) {
                 if (End_Of_File_Detected || Error_Detected) {
                     break;
                 }
@@ -372,9 +373,9 @@ int main(int argc, char *argv[])
                     Target_File_Start_Position,
                     Target_File_Requested_Octet_Count);
                 Request_Invoke_ID = invoke_id;
-            } else if (tsm_invoke_id_failed(invoke_id)) {
+            } else if (tsm_invoke_id_failed(&Target_Address, invoke_id)) {
                 fprintf(stderr, "\rError: TSM Timeout!\n");
-                tsm_free_invoke_id(invoke_id);
+                tsm_free_invoke_id(&Target_Address, invoke_id);
                 /* try again or abort? */
                 Error_Detected = true;
                 break;
@@ -207,11 +207,11 @@ int main(int argc, char *argv[])
                 invoke_id = Send_Reinitialize_Device_Request(
                     Target_Device_Object_Instance, Reinitialize_State,
                     Reinitialize_Password);
-            } else if (tsm_invoke_id_free(invoke_id)) {
+            } else if (tsm_invoke_id_free(&Target_Address, invoke_id)) {
                 break;
-            } else if (tsm_invoke_id_failed(invoke_id)) {
+            } else if (tsm_invoke_id_failed(&Target_Address, invoke_id)) {
                 fprintf(stderr, "\rError: TSM Timeout!\r\n");
-                tsm_free_invoke_id(invoke_id);
+                tsm_free_invoke_id(&Target_Address, invoke_id);
                 /* try again or abort? */
                 Error_Detected = true;
                 break;
@@ -9,6 +9,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <signal.h>
 #include <time.h>
 #include <assert.h>
@@ -26,6 +27,7 @@
 #include "bacnet/basic/sys/debug.h"
 #include "bacnet/basic/tsm/tsm.h"
 #include "bacnet/basic/binding/address.h"
+#include "bacnet/basic/npdu/route_table.h"
 #include "bacnet/basic/services.h"
 /* port agnostic file */
 #include "bacport.h"
@@ -60,17 +62,14 @@ static uint32_t Device_Instance_Number = BACNET_MAX_INSTANCE;
  * such as might result from the failure of a router, and "temporary"
  * unreachability due to the imposition of a congestion control
  * restriction.
+ *
+ * The ports and the networks reachable through them are kept in the
+ * route_table module, which finds a network by number in constant time.
  */
-typedef struct _dnet {
-    uint8_t mac[MAX_MAC_LEN];
-    uint8_t mac_len;
-    uint16_t net;
-    bool enabled;
-    struct _dnet *dnets;
-    struct _dnet *next;
-} DNET;
-/* The list of DNETs that our router can reach. */
-static DNET *Router_Table_Head;
+/* the directly connected ports, in the order they were added */
+#define ROUTER_PORT_MAX 2
+static uint16_t Router_Port_Net[ROUTER_PORT_MAX];
+static unsigned Router_Port_Count;
 /* track our directly connected ports network number */
 static uint16_t BIP_Net;
 static uint16_t BIP6_Net;
@@ -89,65 +88,45 @@ static bool Exit_Requested;
  * @param net - network number to find a match
  * @param addr - address to be filled with remote router address
  *
- * @return NULL if not found, or a pointer to the directly connected port.
- * If addr is not NULL, the DNET entry address is copied to addr
- * The caller will need to compare the sought after net with the
- * returned port->net to determine if the addr is filled.
+ * @return NULL if not found, or the routing table entry of the network.
+ * The network is reachable through the directly connected port
+ * entry->port_net, and is directly connected if it is entry->net.
+ * If addr is not NULL and the network is not directly connected,
+ * the next router MAC address is copied to addr.
  */
-static DNET *dnet_find(uint16_t net, BACNET_ADDRESS *addr)
+static BACNET_ROUTE_TABLE_ENTRY *dnet_find(uint16_t net, BACNET_ADDRESS *addr)
 {
-    DNET *port = Router_Table_Head;
-    DNET *dnet = NULL;
+    BACNET_ROUTE_TABLE_ENTRY *dnet = NULL;
     unsigned int i = 0;
 
-    while (port != NULL) {
-        if (net == port->net) {
-            /* DNET is directly connected to the router */
-            return port;
-        } else if (port->dnets) {
-            /* search router ports DNET list */
-            dnet = port->dnets;
-            while (dnet != NULL) {
-                if (net == dnet->net) {
-                    if (addr) {
-                        addr->mac_len = dnet->mac_len;
-                        for (i = 0; i < MAX_MAC_LEN; i++) {
-                            addr->mac[i] = dnet->mac[i];
-                        }
-                    }
-                    return port;
-                }
-                dnet = dnet->next;
-            }
+    dnet = route_table_find(net);
+    if (dnet && addr && (dnet->port_net != dnet->net)) {
+        addr->mac_len = dnet->mac_len;
+        for (i = 0; i < MAX_MAC_LEN; i++) {
+            addr->mac[i] = dnet->mac[i];
         }
-        port = port->next;
     }
 
-    return NULL;
+    return dnet;
 }
 
 static bool port_find(uint16_t snet, BACNET_ADDRESS *addr)
 {
-    DNET *port = NULL;
-    bool found = false;
+    BACNET_ROUTE_TABLE_ENTRY *port = NULL;
     unsigned int i = 0;
 
-    port = Router_Table_Head;
-    while (port) {
-        if (port->net == snet) {
-            if (addr) {
-                addr->mac_len = port->mac_len;
-                for (i = 0; i < MAX_MAC_LEN; i++) {
-                    addr->mac[i] = port->mac[i];
-                }
-            }
-            found = true;
-            break;
+    port = route_table_find(snet);
+    if (!port || (port->port_net != snet)) {
+        return false;
+    }
+    if (addr) {
+        addr->mac_len = port->mac_len;
+        for (i = 0; i < MAX_MAC_LEN; i++) {
+            addr->mac[i] = port->mac[i];
         }
-        port = port->next;
     }
 
-    return found;
+    return true;
 }
 
 /**
@@ -158,47 +137,24 @@ static bool port_find(uint16_t snet, BACNET_ADDRESS *addr)
  */
 static void port_add(uint16_t snet, const BACNET_ADDRESS *addr)
 {
-    DNET *port = NULL;
-    DNET *dnet = NULL;
-    unsigned int i = 0;
+    bool added = false;
 
-    port = dnet_find(snet, NULL);
-    if (!port) {
-        port = Router_Table_Head;
-        if (!port) {
-            /* create first port */
-            port = (DNET *)calloc(1, sizeof(DNET));
-            assert(port);
-            Router_Table_Head = port;
-        } else {
-            while (port) {
-                if (port->next) {
-                    port = port->next;
-                } else {
-                    /* create next port */
-                    dnet = (DNET *)calloc(1, sizeof(DNET));
-                    assert(dnet);
-                    port->next = dnet;
-                    port = port->next;
-                    break;
-                }
-            }
-        }
-        port->net = snet;
-        if (addr) {
-            port->mac_len = addr->mac_len;
-            for (i = 0; i < MAX_MAC_LEN; i++) {
-                port->mac[i] = addr->mac[i];
-            }
-        } else {
-            port->mac_len = 0;
-        }
-        port->enabled = true;
+    if (port_find(snet, NULL) || (Router_Port_Count >= ROUTER_PORT_MAX)) {
+        return;
+    }
+    if (addr) {
+        added = route_table_port_add(snet, addr->mac, addr->mac_len);
+    } else {
+        added = route_table_port_add(snet, NULL, 0);
+    }
+    if (added) {
+        Router_Port_Net[Router_Port_Count] = snet;
+        Router_Port_Count++;
     }
 }
 
 /**
- * Add a route to the router table
+ * Add a route to the router table, or refresh its age
  *
  * @param snet - router port SNET
  * @param net - net to be added
@@ -206,73 +162,53 @@ static void port_add(uint16_t snet, const BACNET_ADDRESS *addr)
  */
 static void dnet_add(uint16_t snet, uint16_t net, const BACNET_ADDRESS *addr)
 {
-    DNET *dnet = NULL;
-    DNET *port = NULL;
-    DNET *prior_dnet = NULL;
-    unsigned int i = 0;
-
-    /* make sure NETs are not repeated */
-    dnet = dnet_find(net, NULL);
-    if (dnet) {
-        return;
-    }
-    /* start with the source network number table */
-    port = dnet_find(snet, NULL);
-    if (!port) {
-        return;
-    }
-    dnet = port->dnets;
-    if (dnet == NULL) {
-        /* first DNET to add */
-        dnet = (DNET *)calloc(1, sizeof(DNET));
-        assert(dnet);
-        port->dnets = dnet;
-        if (addr) {
-            dnet->mac_len = addr->mac_len;
-            for (i = 0; i < MAX_MAC_LEN; i++) {
-                dnet->mac[i] = addr->mac[i];
-            }
-        }
-        dnet->net = net;
-        dnet->enabled = true;
-        dnet->next = NULL;
+    /* directly connected networks are never replaced */
+    if (addr) {
+        route_table_learn(net, snet, addr->mac, addr->mac_len);
     } else {
-        while (dnet != NULL) {
-            if (dnet->net == net) {
-                /* make sure NETs are not repeated */
-                return;
-            }
-            prior_dnet = dnet;
-            dnet = dnet->next;
-        }
-        /* next DNET to add */
-        dnet = (DNET *)calloc(1, sizeof(DNET));
-        if (addr) {
-            dnet->mac_len = addr->mac_len;
-            for (i = 0; i < MAX_MAC_LEN; i++) {
-                dnet->mac[i] = addr->mac[i];
-            }
-        }
-        dnet->net = net;
-        dnet->enabled = true;
-        dnet->next = NULL;
-        prior_dnet->next = dnet;
+        route_table_learn(net, snet, NULL, 0);
     }
 }
 
 /**
- * Free the DNET data of a route
+ * Set the reachability status of the networks served by a router,
+ * from a Router-Busy-To-Network or Router-Available-To-Network message.
  *
- * @param dnets - router info to be freed
+ * @param snet - router port SNET
+ * @param src - address of the router that sent the message
+ * @param npdu - list of network numbers, or empty for all the
+ *  networks served by the router
+ * @param npdu_len - number of octets in the list
+ * @param status - reachability status of the networks
  */
-static void dnet_cleanup(DNET *dnets)
+static void dnet_status_set(
+    uint16_t snet,
+    const BACNET_ADDRESS *src,
+    const uint8_t *npdu,
+    uint16_t npdu_len,
+    BACNET_ROUTE_STATUS status)
 {
-    DNET *dnet = dnets;
-    while (dnet != NULL) {
-        debug_printf("DNET %u removed\n", (unsigned)dnet->net);
-        dnet = dnet->next;
-        free(dnets);
-        dnets = dnet;
+    BACNET_ROUTE_TABLE_ENTRY *dnet = NULL;
+    uint16_t npdu_offset = 0;
+    uint16_t net = 0;
+    unsigned index = 0;
+
+    if (npdu_len >= 2) {
+        while ((npdu_offset + 2) <= npdu_len) {
+            npdu_offset += decode_unsigned16(&npdu[npdu_offset], &net);
+            fprintf(stderr, "%hu ", net);
+            route_table_status_set(net, status);
+        }
+        fprintf(stderr, "\n");
+        return;
+    }
+    for (index = 0; index < route_table_size(); index++) {
+        dnet = route_table_entry(index);
+        if (dnet && (dnet->port_net == snet) && (dnet->net != snet) &&
+            (dnet->mac_len == src->mac_len) &&
+            (memcmp(dnet->mac, src->mac, src->mac_len) == 0)) {
+            route_table_status_set(dnet->net, status);
+        }
     }
 }
 
@@ -344,8 +280,8 @@ static void send_i_am_router_to_network(uint16_t snet, uint16_t net)
     BACNET_NPDU_DATA npdu_data;
     int pdu_len = 0;
     int len = 0;
-    DNET *port = NULL;
-    DNET *dnet = NULL;
+    BACNET_ROUTE_TABLE_ENTRY *dnet = NULL;
+    unsigned index = 0;
 
     datalink_get_broadcast_address(&dest);
     npdu_encode_npdu_network(
@@ -366,21 +302,18 @@ static void send_i_am_router_to_network(uint16_t snet, uint16_t net)
             This enables routers to build or update their routing table
             entries for each of the network numbers contained in the message.
         */
-        port = Router_Table_Head;
-        while (port != NULL) {
-            if (port->net != snet) {
-                debug_printf("%u,", port->net);
-                len = encode_unsigned16(&Tx_Buffer[pdu_len], port->net);
-                pdu_len += len;
-                dnet = port->dnets;
-                while (dnet != NULL) {
-                    debug_printf("%u,", dnet->net);
-                    len = encode_unsigned16(&Tx_Buffer[pdu_len], dnet->net);
-                    pdu_len += len;
-                    dnet = dnet->next;
-                }
+        for (index = 0; index < route_table_size(); index++) {
+            dnet = route_table_entry(index);
+            if (!dnet || (dnet->port_net == snet) ||
+                (dnet->status == BACNET_ROUTE_UNREACHABLE)) {
+                continue;
             }
-            port = port->next;
+            if ((pdu_len + 2) > (int)sizeof(Tx_Buffer)) {
+                break;
+            }
+            debug_printf("%u,", dnet->net);
+            len = encode_unsigned16(&Tx_Buffer[pdu_len], dnet->net);
+            pdu_len += len;
         }
         debug_printf("from %u\n", snet);
     }
@@ -410,7 +343,7 @@ send_initialize_routing_table_ack(uint8_t snet, const BACNET_ADDRESS *dst)
     int len = 0;
     uint8_t count = 0;
     uint8_t port_id = 1;
-    DNET *port = NULL;
+    unsigned index = 0;
 
     if (dst) {
         bacnet_address_copy(&dest, dst);
@@ -424,11 +357,7 @@ send_initialize_routing_table_ack(uint8_t snet, const BACNET_ADDRESS *dst)
        our downstream BACnet network. */
     pdu_len = npdu_encode_pdu(&Tx_Buffer[0], &dest, NULL, &npdu_data);
     /* First, count the number of Ports we will encode */
-    port = Router_Table_Head;
-    while (port != NULL) {
-        count++;
-        port = port->next;
-    }
+    count = (uint8_t)Router_Port_Count;
     Tx_Buffer[pdu_len] = count;
     pdu_len++;
     if (count > 0) {
@@ -436,16 +365,15 @@ send_initialize_routing_table_ack(uint8_t snet, const BACNET_ADDRESS *dst)
          * We will simply use a positive index for PortID,
          * and have no PortInfo.
          */
-        port = Router_Table_Head;
-        while (port != NULL) {
-            len = encode_unsigned16(&Tx_Buffer[pdu_len], port->net);
+        for (index = 0; index < Router_Port_Count; index++) {
+            len = encode_unsigned16(
+                &Tx_Buffer[pdu_len], Router_Port_Net[index]);
             pdu_len += len;
             Tx_Buffer[pdu_len] = port_id;
             pdu_len++;
             port_id++;
             Tx_Buffer[pdu_len] = 0;
             pdu_len++;
-            port = port->next;
         }
     }
     /* Now send the message */
@@ -584,30 +512,30 @@ static void who_is_router_to_network_handler(
     const uint8_t *npdu,
     uint16_t npdu_len)
 {
-    DNET *port = NULL;
+    BACNET_ROUTE_TABLE_ENTRY *dnet = NULL;
     uint16_t network = 0;
     uint16_t len = 0;
+    unsigned index = 0;
 
     (void)src;
     (void)npdu_data;
     if (npdu) {
         if (npdu_len >= 2) {
             len += decode_unsigned16(&npdu[len], &network);
-            port = dnet_find(network, NULL);
-            if (port) {
+            dnet = dnet_find(network, NULL);
+            if (dnet && (dnet->status != BACNET_ROUTE_UNREACHABLE)) {
                 /* found in my list! */
-                if (port->net != snet) {
+                if (dnet->port_net != snet) {
                     /* reachable not through the port this message received */
                     send_i_am_router_to_network(snet, network);
                 }
             } else {
                 /* discover the next router on the path to the network */
-                port = Router_Table_Head;
-                while (port) {
-                    if (port->net != snet) {
-                        send_who_is_router_to_network(port->net, network);
+                for (index = 0; index < Router_Port_Count; index++) {
+                    if (Router_Port_Net[index] != snet) {
+                        send_who_is_router_to_network(
+                            Router_Port_Net[index], network);
                     }
-                    port = port->next;
                 }
             }
         } else {
@@ -679,9 +607,12 @@ static void network_control_handler(
                         break;
                     case 1:
                         fprintf(stderr, "Reason: Network unreachable.\n");
+                        route_table_status_set(
+                            dnet, BACNET_ROUTE_UNREACHABLE);
                         break;
                     case 2:
                         fprintf(stderr, "Reason: Network is busy.\n");
+                        route_table_status_set(dnet, BACNET_ROUTE_BUSY);
                         break;
                     case 3:
                         fprintf(
@@ -703,8 +634,15 @@ static void network_control_handler(
             }
             break;
         case NETWORK_MESSAGE_ROUTER_BUSY_TO_NETWORK:
+            /* stop routing to the networks until they are available,
+               or the busy time ends */
+            fprintf(stderr, "for Networks: ");
+            dnet_status_set(snet, src, npdu, npdu_len, BACNET_ROUTE_BUSY);
+            break;
         case NETWORK_MESSAGE_ROUTER_AVAILABLE_TO_NETWORK:
-            /* Do nothing - don't support upstream traffic congestion control */
+            fprintf(stderr, "for Networks: ");
+            dnet_status_set(
+                snet, src, npdu, npdu_len, BACNET_ROUTE_AVAILABLE);
             break;
         case NETWORK_MESSAGE_INIT_RT_TABLE:
             /* If sent with Number of Ports == 0, we respond with
@@ -816,11 +754,12 @@ static void routed_apdu_handler(
     uint8_t *apdu,
     uint16_t apdu_len)
 {
-    DNET *port = NULL;
+    BACNET_ROUTE_TABLE_ENTRY *port = NULL;
     BACNET_ADDRESS local_dest;
     BACNET_ADDRESS remote_dest;
     BACNET_ADDRESS router_src;
     int npdu_len = 0;
+    unsigned index = 0;
 
     /* for broadcast messages no search is needed */
     if (dest->net == BACNET_BROADCAST_NETWORK) {
@@ -845,21 +784,27 @@ static void routed_apdu_handler(
         memmove(&Tx_Buffer[npdu_len], apdu, apdu_len);
         /* send to my other ports */
         debug_printf("Routing a BROADCAST from %u\n", (unsigned)snet);
-        port = Router_Table_Head;
-        while (port != NULL) {
-            if (port->net != snet) {
+        for (index = 0; index < Router_Port_Count; index++) {
+            if (Router_Port_Net[index] != snet) {
                 datalink_send_pdu(
-                    port->net, &local_dest, npdu, &Tx_Buffer[0],
+                    Router_Port_Net[index], &local_dest, npdu, &Tx_Buffer[0],
                     npdu_len + apdu_len);
             }
-            port = port->next;
         }
         return;
     }
     remote_dest = *dest;
     port = dnet_find(dest->net, &remote_dest);
-    if (port) {
-        if (port->net == dest->net) {
+    if (port && (port->status == BACNET_ROUTE_UNREACHABLE)) {
+        /* find the route again */
+        port = NULL;
+    }
+    if (port && (port->status == BACNET_ROUTE_BUSY)) {
+        debug_printf("Route to %u is busy\n", (unsigned)dest->net);
+        send_reject_message_to_network(
+            snet, src, NETWORK_REJECT_ROUTER_BUSY, dest->net);
+    } else if (port) {
+        if (port->port_net == dest->net) {
             debug_printf("Routing to Port %u\n", (unsigned)dest->net);
             /*  Case 1: the router is directly
                 connected to the network referred to by DNET. */
@@ -877,7 +822,7 @@ static void routed_apdu_handler(
                 npdu_encode_pdu(&Tx_Buffer[0], &local_dest, &router_src, npdu);
             memmove(&Tx_Buffer[npdu_len], apdu, apdu_len);
             datalink_send_pdu(
-                port->net, &local_dest, npdu, &Tx_Buffer[0],
+                port->port_net, &local_dest, npdu, &Tx_Buffer[0],
                 npdu_len + apdu_len);
         } else {
             debug_printf(
@@ -895,7 +840,7 @@ static void routed_apdu_handler(
                 npdu_encode_pdu(&Tx_Buffer[0], &remote_dest, &router_src, npdu);
             memmove(&Tx_Buffer[npdu_len], apdu, apdu_len);
             datalink_send_pdu(
-                port->net, &remote_dest, npdu, &Tx_Buffer[0],
+                port->port_net, &remote_dest, npdu, &Tx_Buffer[0],
                 npdu_len + apdu_len);
         }
     } else if (dest->net) {
@@ -908,13 +853,12 @@ static void routed_apdu_handler(
         npdu_len = npdu_encode_pdu(&Tx_Buffer[0], dest, &router_src, npdu);
         memmove(&Tx_Buffer[npdu_len], apdu, apdu_len);
         /* send to all other ports */
-        port = Router_Table_Head;
-        while (port != NULL) {
-            if (port->net != snet) {
+        for (index = 0; index < Router_Port_Count; index++) {
+            if (Router_Port_Net[index] != snet) {
                 datalink_send_pdu(
-                    port->net, dest, npdu, &Tx_Buffer[0], npdu_len + apdu_len);
+                    Router_Port_Net[index], dest, npdu, &Tx_Buffer[0],
+                    npdu_len + apdu_len);
             }
-            port = port->next;
         }
         /*  If the next router is unknown, an attempt shall be made to
             identify it using a Who-Is-Router-To-Network message. */
@@ -1070,22 +1014,15 @@ static void datalink_init(void)
 }
 
 /**
- * Cleanup memory
+ * Cleanup the routing table
  *
  */
 static void cleanup(void)
 {
-    DNET *port = NULL;
-
     fprintf(stderr, "Cleaning up...\n");
-    /* clean up the remote networks */
-    port = Router_Table_Head;
-    while (port != NULL) {
-        dnet_cleanup(port->dnets);
-        port = port->next;
-    }
-    /* clean up the directly connected networks */
-    dnet_cleanup(Router_Table_Head);
+    /* forget the directly connected and the remote networks */
+    route_table_init();
+    Router_Port_Count = 0;
 }
 
 #if defined(_WIN32)
@@ -1197,6 +1134,7 @@ int main(int argc, char *argv[])
             last_seconds = current_seconds;
             bvlc_maintenance_timer(elapsed_seconds);
             bvlc6_maintenance_timer(elapsed_seconds);
+            route_table_timer_seconds(elapsed_seconds);
         }
         if (Exit_Requested) {
             break;
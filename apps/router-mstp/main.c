@@ -35,10 +35,22 @@
 #include "bacnet/datalink/bip.h"
 #include "bacnet/datalink/bvlc.h"
 #include "bacnet/basic/bbmd/h_bbmd.h"
+#if defined(__linux__)
+#include "dlmstp_port.h"
+#endif
 
 /* current version of the BACnet stack */
 static const char *BACnet_Version = BACNET_VERSION_TEXT;
 
+/* number of MS/TP networks that can be routed */
+#ifndef ROUTER_MSTP_PORT_MAX
+#if defined(__linux__)
+#define ROUTER_MSTP_PORT_MAX 4
+#else
+#define ROUTER_MSTP_PORT_MAX 1
+#endif
+#endif
+
 /**
  * 6.6.1 Routing Tables
  *
@@ -71,7 +83,12 @@ typedef struct _dnet {
 static DNET *Router_Table_Head;
 /* track our directly connected ports network number */
 static uint16_t BIP_Net;
-static uint16_t MSTP_Net;
+static uint16_t MSTP_Net[ROUTER_MSTP_PORT_MAX];
+static unsigned MSTP_Port_Count;
+#if defined(__linux__)
+/* each MS/TP network has a port with its own serial port and thread */
+static struct dlmstp_port MSTP_Port[ROUTER_MSTP_PORT_MAX];
+#endif
 /* buffer for receiving packets from the directly connected ports */
 static uint8_t BIP_Rx_Buffer[BIP_MPDU_MAX];
 static uint8_t MSTP_Rx_Buffer[DLMSTP_MPDU_MAX];
@@ -313,6 +330,138 @@ static void datalink_get_broadcast_address(BACNET_ADDRESS *dest)
     return;
 }
 
+#if defined(__linux__)
+/**
+ * @brief Initialize a directly connected MS/TP port
+ * @param index - MS/TP port index
+ * @param ifname - serial port name
+ * @param mac - MAC address of the port
+ * @param baud - baud rate of the port
+ * @param max_master - Max_Master of the port
+ * @param max_info_frames - Max_Info_Frames of the port
+ * @return true if the port was started
+ */
+static bool mstp_port_init(
+    unsigned index,
+    const char *ifname,
+    uint8_t mac,
+    uint32_t baud,
+    uint8_t max_master,
+    uint8_t max_info_frames)
+{
+    struct dlmstp_port *port = &MSTP_Port[index];
+
+    dlmstp_port_set_max_info_frames(port, max_info_frames);
+    dlmstp_port_set_max_master(port, max_master);
+    dlmstp_port_set_baud_rate(port, baud);
+    dlmstp_port_set_mac_address(port, mac);
+
+    return dlmstp_port_init(port, ifname);
+}
+
+/**
+ * @brief Stop the MS/TP ports
+ */
+static void mstp_port_cleanup(void)
+{
+    unsigned index;
+
+    for (index = 0; index < MSTP_Port_Count; index++) {
+        dlmstp_port_cleanup(&MSTP_Port[index]);
+    }
+}
+
+/**
+ * @brief Get the address of a directly connected MS/TP port
+ * @param index - MS/TP port index
+ * @param my_address - where the address is stored
+ */
+static void mstp_port_get_my_address(unsigned index, BACNET_ADDRESS *my_address)
+{
+    dlmstp_port_get_my_address(&MSTP_Port[index], my_address);
+}
+
+/**
+ * @brief Send a packet out a directly connected MS/TP port
+ * @param index - MS/TP port index
+ * @param dest - address to where packet is sent
+ * @param npdu_data - NPCI data to control network destination
+ * @param pdu - protocol data unit to be sent
+ * @param pdu_len - number of bytes to send
+ * @return number of bytes sent
+ */
+static int mstp_port_send_pdu(
+    unsigned index,
+    BACNET_ADDRESS *dest,
+    BACNET_NPDU_DATA *npdu_data,
+    uint8_t *pdu,
+    unsigned int pdu_len)
+{
+    return dlmstp_port_send_pdu(
+        &MSTP_Port[index], dest, npdu_data, pdu, pdu_len);
+}
+
+/**
+ * @brief Get a packet received by a directly connected MS/TP port
+ * @param index - MS/TP port index
+ * @param src - source address of the packet
+ * @param pdu - where the packet is copied
+ * @param max_pdu - number of bytes that fit in the pdu
+ * @return number of bytes received, or zero if none
+ */
+static uint16_t mstp_port_receive(
+    unsigned index, BACNET_ADDRESS *src, uint8_t *pdu, uint16_t max_pdu)
+{
+    return dlmstp_port_receive(&MSTP_Port[index], src, pdu, max_pdu, 0);
+}
+#else
+static bool mstp_port_init(
+    unsigned index,
+    const char *ifname,
+    uint8_t mac,
+    uint32_t baud,
+    uint8_t max_master,
+    uint8_t max_info_frames)
+{
+    (void)index;
+    dlmstp_set_max_info_frames(max_info_frames);
+    dlmstp_set_max_master(max_master);
+    dlmstp_set_baud_rate(baud);
+    dlmstp_set_mac_address(mac);
+
+    return dlmstp_init((char *)ifname);
+}
+
+static void mstp_port_cleanup(void)
+{
+    dlmstp_cleanup();
+}
+
+static void mstp_port_get_my_address(unsigned index, BACNET_ADDRESS *my_address)
+{
+    (void)index;
+    dlmstp_get_my_address(my_address);
+}
+
+static int mstp_port_send_pdu(
+    unsigned index,
+    BACNET_ADDRESS *dest,
+    BACNET_NPDU_DATA *npdu_data,
+    uint8_t *pdu,
+    unsigned int pdu_len)
+{
+    (void)index;
+    return dlmstp_send_pdu(dest, npdu_data, pdu, pdu_len);
+}
+
+static uint16_t mstp_port_receive(
+    unsigned index, BACNET_ADDRESS *src, uint8_t *pdu, uint16_t max_pdu)
+{
+    (void)index;
+    return dlmstp_receive(src, pdu, max_pdu, 0);
+}
+#endif
+
 /**
  * function to send a packet out the BACnet/IP and BACnet MSTP ports
  *
@@ -332,17 +481,27 @@ static int datalink_send_pdu(
     unsigned int pdu_len)
 {
     int bytes_sent = 0;
+    unsigned index;
 
     if (snet == 0) {
         log_printf("BVLC & MS/TP Send to DNET %u\n", (unsigned)dest->net);
         bytes_sent = bip_send_pdu(dest, npdu_data, pdu, pdu_len);
-        bytes_sent = dlmstp_send_pdu(dest, npdu_data, pdu, pdu_len);
+        for (index = 0; index < MSTP_Port_Count; index++) {
+            bytes_sent =
+                mstp_port_send_pdu(index, dest, npdu_data, pdu, pdu_len);
+        }
     } else if (snet == BIP_Net) {
         log_printf("BVLC Send to DNET %u\n", (unsigned)dest->net);
         bytes_sent = bip_send_pdu(dest, npdu_data, pdu, pdu_len);
-    } else if (snet == MSTP_Net) {
-        log_printf("MS/TP Send to DNET %u\n", (unsigned)dest->net);
-        bytes_sent = dlmstp_send_pdu(dest, npdu_data, pdu, pdu_len);
+    } else {
+        for (index = 0; index < MSTP_Port_Count; index++) {
+            if (snet == MSTP_Net[index]) {
+                log_printf("MS/TP Send to DNET %u\n", (unsigned)dest->net);
+                bytes_sent =
+                    mstp_port_send_pdu(index, dest, npdu_data, pdu, pdu_len);
+                break;
+            }
+        }
     }
 
     return bytes_sent;
@@ -1019,13 +1178,39 @@ static void my_routing_npdu_handler(
     return;
 }
 
+/**
+ * @brief Get the environment variable of an MS/TP port. The first port
+ *  uses the name, and the other ports add their number to it,
+ *  i.e. BACNET_MSTP_IFACE_2 for the second port.
+ * @param name - environment variable name of the first port
+ * @param index - MS/TP port index
+ * @return the value, or NULL if it is not set
+ */
+static char *mstp_getenv(const char *name, unsigned index)
+{
+    char env_name[64];
+
+    if (index == 0) {
+        return getenv(name);
+    }
+    snprintf(env_name, sizeof(env_name), "%s_%u", name, index + 1);
+
+    return getenv(env_name);
+}
+
 /**
  * Initialize the BACnet MSTP and BACnet/IP data links
  */
 static void datalink_init(void)
 {
     char *pEnv = NULL;
+    char *ifname = NULL;
     BACNET_ADDRESS my_address = { 0 };
+    uint8_t max_info_frames = 128;
+    uint8_t max_master = 127;
+    uint32_t baud = 38400;
+    uint8_t mac = 127;
+    unsigned index;
 
     pEnv = getenv("BACNET_ROUTER_DEBUG");
     if (pEnv) {
@@ -1057,32 +1242,42 @@ static void datalink_init(void)
     /* MS/TP Initialization */
     pEnv = getenv("BACNET_MAX_INFO_FRAMES");
     if (pEnv) {
-        dlmstp_set_max_info_frames(strtol(pEnv, NULL, 0));
-    } else {
-        dlmstp_set_max_info_frames(128);
+        max_info_frames = strtol(pEnv, NULL, 0);
     }
     pEnv = getenv("BACNET_MAX_MASTER");
     if (pEnv) {
-        dlmstp_set_max_master(strtol(pEnv, NULL, 0));
-    } else {
-        dlmstp_set_max_master(127);
+        max_master = strtol(pEnv, NULL, 0);
     }
-    pEnv = getenv("BACNET_MSTP_BAUD");
-    if (pEnv) {
-        dlmstp_set_baud_rate(strtol(pEnv, NULL, 0));
-    } else {
-        dlmstp_set_baud_rate(38400);
-    }
-    pEnv = getenv("BACNET_MSTP_MAC");
-    if (pEnv) {
-        dlmstp_set_mac_address(strtol(pEnv, NULL, 0));
-    } else {
-        dlmstp_set_mac_address(127);
-    }
-    if (!dlmstp_init(getenv("BACNET_MSTP_IFACE"))) {
-        exit(1);
+    for (index = 0; index < ROUTER_MSTP_PORT_MAX; index++) {
+        ifname = mstp_getenv("BACNET_MSTP_IFACE", index);
+        if ((index > 0) && !ifname) {
+            /* only the first port can use the default serial port */
+            continue;
+        }
+        pEnv = mstp_getenv("BACNET_MSTP_BAUD", index);
+        if (pEnv) {
+            baud = strtol(pEnv, NULL, 0);
+        }
+        pEnv = mstp_getenv("BACNET_MSTP_MAC", index);
+        if (pEnv) {
+            mac = strtol(pEnv, NULL, 0);
+        } else {
+            mac = 127;
+        }
+        if (!mstp_port_init(
+                MSTP_Port_Count, ifname, mac, baud, max_master,
+                max_info_frames)) {
+            exit(1);
+        }
+        pEnv = mstp_getenv("BACNET_MSTP_NET", index);
+        if (pEnv) {
+            MSTP_Net[MSTP_Port_Count] = strtol(pEnv, NULL, 0);
+        } else {
+            MSTP_Net[MSTP_Port_Count] = 2 + index;
+        }
+        MSTP_Port_Count++;
     }
-    atexit(dlmstp_cleanup);
+    atexit(mstp_port_cleanup);
     /* router network numbers */
     pEnv = getenv("BACNET_IP_NET");
     if (pEnv) {
@@ -1093,16 +1288,11 @@ static void datalink_init(void)
     /* configure the first entry in the table - home port */
     bip_get_my_address(&my_address);
     port_add(BIP_Net, &my_address);
-    /* MS/TP network */
-    pEnv = getenv("BACNET_MSTP_NET");
-    if (pEnv) {
-        MSTP_Net = strtol(pEnv, NULL, 0);
-    } else {
-        MSTP_Net = 2;
+    /* configure the next entries in the table - MS/TP networks */
+    for (index = 0; index < MSTP_Port_Count; index++) {
+        mstp_port_get_my_address(index, &my_address);
+        port_add(MSTP_Net[index], &my_address);
     }
-    /* configure the next entry in the table */
-    dlmstp_get_my_address(&my_address);
-    port_add(MSTP_Net, &my_address);
 }
 
 /**
@@ -1178,6 +1368,7 @@ int main(int argc, char *argv[])
     time_t last_seconds = 0;
     time_t current_seconds = 0;
     uint32_t elapsed_seconds = 0;
+    unsigned index;
 
     (void)argc;
     (void)argv;
@@ -1191,8 +1382,10 @@ int main(int argc, char *argv[])
     /* broadcast an I-Am on startup */
     printf("BACnet/IP Network: %u\n", (unsigned)BIP_Net);
     send_i_am_router_to_network(BIP_Net, 0);
-    printf("BACnet MS/TP Network: %u\n", (unsigned)MSTP_Net);
-    send_i_am_router_to_network(MSTP_Net, 0);
+    for (index = 0; index < MSTP_Port_Count; index++) {
+        printf("BACnet MS/TP Network: %u\n", (unsigned)MSTP_Net[index]);
+        send_i_am_router_to_network(MSTP_Net[index], 0);
+    }
     /* loop forever */
     for (;;) {
         /* input */
@@ -1205,14 +1398,16 @@ int main(int argc, char *argv[])
             log_printf("BACnet/IP Received packet\n");
             my_routing_npdu_handler(BIP_Net, &src, &BIP_Rx_Buffer[0], pdu_len);
         }
-        /* returns 0 bytes on timeout */
-        pdu_len =
-            dlmstp_receive(&src, &MSTP_Rx_Buffer[0], sizeof(MSTP_Rx_Buffer), 5);
-        /* process */
-        if (pdu_len) {
-            log_printf("BACnet MS/TP Received packet\n");
-            my_routing_npdu_handler(
-                MSTP_Net, &src, &MSTP_Rx_Buffer[0], pdu_len);
+        for (index = 0; index < MSTP_Port_Count; index++) {
+            /* returns 0 bytes when nothing was received */
+            pdu_len = mstp_port_receive(
+                index, &src, &MSTP_Rx_Buffer[0], sizeof(MSTP_Rx_Buffer));
+            /* process */
+            if (pdu_len) {
+                log_printf("BACnet MS/TP Received packet\n");
+                my_routing_npdu_handler(
+                    MSTP_Net[index], &src, &MSTP_Rx_Buffer[0], pdu_len);
+            }
         }
         /* at least one second has passed */
         elapsed_seconds = (uint32_t)(current_seconds - last_seconds);
@@ -11,7 +11,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <sys/ipc.h>
+#include <sys/uio.h>
 #include "ipmodule.h"
 #include "bacnet/bacint.h"
 
@@ -26,7 +26,7 @@ void *dl_ip_thread(void *pArgs)
 {
     MSGBOX_ID msgboxid;
     BACMSG msg_storage, *bacmsg = NULL;
-    MSG_DATA *msg_data;
+    MSG_DATA *msg_data = NULL;
     ROUTER_PORT *port = (ROUTER_PORT *)pArgs;
     IP_DATA ip_data; /* port specific parameters */
     BACNET_ADDRESS address = { 0 };
@@ -39,7 +39,7 @@ void *dl_ip_thread(void *pArgs)
         return NULL;
     }
 
-    /* allocate buffer */
+    /* allocate buffer to discard packets when the pool is empty */
     ip_data.max_buff = MAX_BIP_MPDU;
     ip_data.buff = (uint8_t *)malloc(ip_data.max_buff);
 
@@ -60,7 +60,7 @@ void *dl_ip_thread(void *pArgs)
 
     while (!shutdown) {
         /* check for incoming messages */
-        bacmsg = recv_from_msgbox(port->port_id, &msg_storage, IPC_NOWAIT);
+        bacmsg = recv_from_msgbox(port->port_id, &msg_storage, MSGBOX_NOWAIT);
 
         if (bacmsg) {
             switch (bacmsg->type) {
@@ -210,39 +210,44 @@ int dl_ip_send(
     unsigned pdu_len)
 {
     struct sockaddr_in bip_dest = { 0 };
-    int buff_len = 0;
+    uint8_t header[BIP_HEADER_MAX];
+    struct iovec iov[2];
+    struct msghdr msg = { 0 };
     int bytes_sent = 0;
 
     if (data->socket < 0) {
         return -1;
     }
 
-    data->buff[0] = BVLL_TYPE_BACNET_IP;
+    header[0] = BVLL_TYPE_BACNET_IP;
     bip_dest.sin_family = AF_INET;
     if (dest->net == BACNET_BROADCAST_NETWORK) {
         /* broadcast */
         bip_dest.sin_addr.s_addr = data->broadcast_addr.s_addr;
         bip_dest.sin_port = data->port;
-        data->buff[1] = BVLC_ORIGINAL_BROADCAST_NPDU;
+        header[1] = BVLC_ORIGINAL_BROADCAST_NPDU;
     } else if (dest->mac_len == 6) {
         memcpy(&bip_dest.sin_addr.s_addr, &dest->mac[0], 4);
         memcpy(&bip_dest.sin_port, &dest->mac[4], 2);
-        data->buff[1] = BVLC_ORIGINAL_UNICAST_NPDU;
+        header[1] = BVLC_ORIGINAL_UNICAST_NPDU;
     } else {
         /* invalid address */
         return -1;
     }
-
-    buff_len = 2;
-    buff_len += encode_unsigned16(
-        &data->buff[buff_len], (uint16_t)(pdu_len + 4 /*inclusive */));
-    memcpy(&data->buff[buff_len], pdu, pdu_len);
-    buff_len += pdu_len;
-
-    /* send the packet */
-    bytes_sent = sendto(
-        data->socket, (char *)data->buff, buff_len, 0,
-        (struct sockaddr *)&bip_dest, sizeof(struct sockaddr));
+    encode_unsigned16(
+        &header[2], (uint16_t)(pdu_len + BIP_HEADER_MAX /*inclusive */));
+
+    /* send the header and the packet without copying them together,
+       since the packet may be sent by other ports at the same time */
+    iov[0].iov_base = header;
+    iov[0].iov_len = sizeof(header);
+    iov[1].iov_base = (void *)pdu;
+    iov[1].iov_len = pdu_len;
+    msg.msg_name = &bip_dest;
+    msg.msg_namelen = sizeof(bip_dest);
+    msg.msg_iov = iov;
+    msg.msg_iovlen = 2;
+    bytes_sent = sendmsg(data->socket, &msg, 0);
 
     PRINT(DEBUG, "send to %s\n", inet_ntoa(bip_dest.sin_addr));
 
@@ -254,6 +259,9 @@ int dl_ip_recv(
 {
     int received_bytes = 0;
     uint16_t buff_len = 0; /* return value */
+    uint16_t pdu_offset = 0;
+    uint8_t *mpdu = NULL;
+    uint16_t max_mpdu = 0;
     fd_set read_fds;
     struct timeval select_timeout;
     struct sockaddr_in sin = { 0 };
@@ -276,9 +284,20 @@ int dl_ip_recv(
     FD_ZERO(&read_fds);
     FD_SET(data->socket, &read_fds);
 
+    /* receive into a packet from the pool, so that the PDU is passed
+       on without a copy, and the NPDU header is after the headroom */
+    *msg_data = alloc_data();
+    if (*msg_data) {
+        mpdu = (*msg_data)->pdu - BIP_HEADER_MAX;
+        max_mpdu =
+            ROUTER_PACKET_SIZE - (ROUTER_PACKET_HEADROOM - BIP_HEADER_MAX);
+    } else {
+        mpdu = data->buff;
+        max_mpdu = data->max_buff;
+    }
 #ifdef TEST_PACKET
     received_bytes = sizeof(test_packet);
-    memmove(data->buff, &test_packet, received_bytes);
+    memmove(mpdu, &test_packet, received_bytes);
     sin.sin_addr.s_addr = 0x7E1D40A;
     sin.sin_port = 0xC0BA;
 #else
@@ -286,25 +305,34 @@ int dl_ip_recv(
     /* see if there is a packet for us */
     if (ret > 0) {
         received_bytes = recvfrom(
-            data->socket, (char *)&data->buff[0], data->max_buff, 0,
-            (struct sockaddr *)&sin, &sin_len);
+            data->socket, (char *)mpdu, max_mpdu, 0, (struct sockaddr *)&sin,
+            &sin_len);
     } else {
+        free_data(*msg_data);
+        *msg_data = NULL;
         return 0;
     }
 #endif
     PRINT(DEBUG, "received from %s\n", inet_ntoa(sin.sin_addr));
 
-    /* check for errors */
-    if (received_bytes <= 0) {
+    /* check for errors, or no packet to receive into */
+    if ((received_bytes <= 0) || (*msg_data == NULL)) {
+        if (received_bytes > 0) {
+            PRINT(ERROR, "BIP: no packet buffer. Discarded!\n");
+        }
+        free_data(*msg_data);
+        *msg_data = NULL;
         return 0;
     }
 
     /* the signature of a BACnet/IP packet */
-    if (data->buff[0] != BVLL_TYPE_BACNET_IP) {
+    if (mpdu[0] != BVLL_TYPE_BACNET_IP) {
+        free_data(*msg_data);
+        *msg_data = NULL;
         return 0;
     }
 
-    switch (data->buff[1]) {
+    switch (mpdu[1]) {
         case BVLC_ORIGINAL_UNICAST_NPDU:
         case BVLC_ORIGINAL_BROADCAST_NPDU: {
             if ((sin.sin_addr.s_addr == data->local_addr.s_addr) &&
@@ -317,32 +345,16 @@ int dl_ip_recv(
                 memcpy(&src->mac[0], &sin.sin_addr.s_addr, 4);
                 memcpy(&src->mac[4], &sin.sin_port, 2);
 
-                (void)decode_unsigned16(&data->buff[2], &buff_len);
+                (void)decode_unsigned16(&mpdu[2], &buff_len);
                 /* subtract off the BVLC header */
                 buff_len -= 4;
-                if (buff_len < data->max_buff) {
-                    /* allocate data message stucture */
-                    (*msg_data) = (MSG_DATA *)malloc(sizeof(MSG_DATA));
-                    (*msg_data)->pdu_len = buff_len;
-                    (*msg_data)->pdu = (uint8_t *)malloc((*msg_data)->pdu_len);
-                    /* fill up data message structure */
-                    memmove(
-                        &(*msg_data)->pdu[0], &data->buff[4],
-                        (*msg_data)->pdu_len);
-                    memmove(&(*msg_data)->src, src, sizeof(BACNET_ADDRESS));
-                }
-                /* ignore packets that are too large */
-                else {
-                    buff_len = 0;
-
-                    PRINT(ERROR, "BIP: PDU too large. Discarded!.\n");
-                }
+                pdu_offset = 4;
             }
         } break;
 
         case BVLC_FORWARDED_NPDU: {
-            memcpy(&sin.sin_addr.s_addr, &data->buff[4], 4);
-            memcpy(&sin.sin_port, &data->buff[8], 2);
+            memcpy(&sin.sin_addr.s_addr, &mpdu[4], 4);
+            memcpy(&sin.sin_port, &mpdu[8], 2);
             if ((sin.sin_addr.s_addr == data->local_addr.s_addr) &&
                 (sin.sin_port == data->port)) {
                 buff_len = 0;
@@ -351,23 +363,10 @@ int dl_ip_recv(
                 memcpy(&src->mac[0], &sin.sin_addr.s_addr, 4);
                 memcpy(&src->mac[4], &sin.sin_port, 2);
 
-                (void)decode_unsigned16(&data->buff[2], &buff_len);
+                (void)decode_unsigned16(&mpdu[2], &buff_len);
                 /* subtract off the BVLC header */
                 buff_len -= 10;
-                if (buff_len < data->max_buff) {
-                    /* allocate data message stucture */
-                    (*msg_data) = (MSG_DATA *)malloc(sizeof(MSG_DATA));
-                    (*msg_data)->pdu_len = buff_len;
-                    (*msg_data)->pdu = (uint8_t *)malloc((*msg_data)->pdu_len);
-                    /* fill up data message structure */
-                    memmove(
-                        &(*msg_data)->pdu[0], &data->buff[4 + 6],
-                        (*msg_data)->pdu_len);
-                    memmove(&(*msg_data)->src, src, sizeof(BACNET_ADDRESS));
-                } else {
-                    /* ignore packets that are too large */
-                    buff_len = 0;
-                }
+                pdu_offset = 10;
             }
         } break;
         default:
@@ -376,6 +375,23 @@ int dl_ip_recv(
 
             break;
     }
+    if (buff_len > 0) {
+        if ((pdu_offset + buff_len) <= received_bytes) {
+            /* fill up data message structure */
+            (*msg_data)->pdu = &mpdu[pdu_offset];
+            (*msg_data)->pdu_len = buff_len;
+            memmove(&(*msg_data)->src, src, sizeof(BACNET_ADDRESS));
+        } else {
+            /* ignore packets that are too large or truncated */
+            buff_len = 0;
+
+            PRINT(ERROR, "BIP: PDU too large. Discarded!.\n");
+        }
+    }
+    if (buff_len == 0) {
+        free_data(*msg_data);
+        *msg_data = NULL;
+    }
     return buff_len;
 }
 
@@ -55,7 +55,7 @@ void cleanup(void);
 
 void print_msg(const BACMSG *msg);
 
-uint16_t process_msg(BACMSG *msg, MSG_DATA *data, uint8_t **buff);
+uint16_t process_msg(BACMSG *msg, MSG_DATA *data);
 
 uint16_t get_next_free_dnet(void);
 
@@ -68,8 +68,9 @@ int main(int argc, char *argv[])
     ROUTER_PORT *port;
     BACMSG msg_storage, *bacmsg = NULL;
     MSG_DATA *msg_data = NULL;
-    uint8_t *buff = NULL;
     int16_t buff_len = 0;
+    time_t last_seconds = 0;
+    time_t current_seconds = 0;
 
     atexit(cleanup);
 
@@ -83,8 +84,8 @@ int main(int argc, char *argv[])
         return -1;
     }
 
-    send_network_message(
-        NETWORK_MESSAGE_I_AM_ROUTER_TO_NETWORK, msg_data, &buff, NULL);
+    send_network_message(NETWORK_MESSAGE_I_AM_ROUTER_TO_NETWORK, NULL, NULL);
+    last_seconds = time(NULL);
 
     while (true) {
         if (kbhit()) {
@@ -97,29 +98,39 @@ int main(int argc, char *argv[])
 
         /* blocking dequeue here */
         bacmsg = recv_from_msgbox(head->main_id, &msg_storage, 0);
+        /* age the learned networks before they are used for routing */
+        current_seconds = time(NULL);
+        if (current_seconds != last_seconds) {
+            route_table_timer_seconds(
+                (uint32_t)(current_seconds - last_seconds));
+            last_seconds = current_seconds;
+        }
         if (bacmsg) {
             switch (bacmsg->type) {
                 case DATA: {
                     MSGBOX_ID msg_src = bacmsg->origin;
-
-                    /* allocate message structure */
-                    msg_data = malloc(sizeof(MSG_DATA));
-                    if (!msg_data) {
-                        PRINT(ERROR, "Error: Could not allocate memory\n");
-                        break;
-                    }
+                    bool network_msg = is_network_msg(bacmsg);
 
                     /* print_msg(bacmsg); */
 
-                    if (is_network_msg(bacmsg)) {
-                        buff_len =
-                            process_network_message(bacmsg, msg_data, &buff);
-                        if (buff_len == 0) {
+                    if (network_msg) {
+                        /* the reply is a new packet */
+                        msg_data = alloc_data();
+                        if (!msg_data) {
+                            PRINT(ERROR, "Error: No packet buffer\n");
                             free_data(bacmsg->data);
                             break;
                         }
+                        buff_len = process_network_message(bacmsg, msg_data);
+                        free_data(bacmsg->data);
+                        if (buff_len == 0) {
+                            free_data(msg_data);
+                            break;
+                        }
                     } else {
-                        buff_len = process_msg(bacmsg, msg_data, &buff);
+                        /* the packet is routed in place */
+                        msg_data = (MSG_DATA *)bacmsg->data;
+                        buff_len = process_msg(bacmsg, msg_data);
                     }
 
                     /* if buff_len */
@@ -129,42 +140,34 @@ int main(int argc, char *argv[])
 
                     if (buff_len > 0) {
                         /* form new message */
-                        msg_data->pdu = buff;
                         msg_data->pdu_len = buff_len;
                         msg_storage.origin = head->main_id;
                         msg_storage.type = DATA;
                         msg_storage.data = msg_data;
 
-                        /* print_msg(bacmsg); */
-
-                        if (is_network_msg(bacmsg)) {
+                        if (network_msg) {
                             msg_data->ref_count = 1;
-                            send_to_msgbox(msg_src, &msg_storage);
+                            if (!send_to_msgbox(msg_src, &msg_storage)) {
+                                free_data(msg_data);
+                            }
                         } else if (
                             msg_data->dest.net != BACNET_BROADCAST_NETWORK) {
                             msg_data->ref_count = 1;
                             port =
                                 find_dnet(msg_data->dest.net, &msg_data->dest);
-                            send_to_msgbox(port->port_id, &msg_storage);
-                        } else {
-                            port = head;
-                            msg_data->ref_count = port_count - 1;
-                            while (port != NULL) {
-                                if (port->port_id == msg_src ||
-                                    port->state == FINISHED) {
-                                    port = port->next;
-                                    continue;
-                                }
-                                send_to_msgbox(port->port_id, &msg_storage);
-                                port = port->next;
+                            if (!port ||
+                                !send_to_msgbox(port->port_id, &msg_storage)) {
+                                free_data(msg_data);
                             }
+                        } else {
+                            send_to_ports(&msg_storage, msg_src);
                         }
                     } else if (buff_len == -1) {
                         uint16_t net = msg_data->dest.net; /* NET to find */
                         PRINT(INFO, "Searching NET...\n");
                         send_network_message(
                             NETWORK_MESSAGE_WHO_IS_ROUTER_TO_NETWORK, msg_data,
-                            &buff, &net);
+                            &net);
                     } else {
                         /* if invalid message send Reject-Message-To-Network */
                         PRINT(ERROR, "Error: Invalid message\n");
@@ -691,6 +694,16 @@ bool init_router(void)
         }
     }
 
+    /* the port addresses are known once the ports are running */
+    route_table_init();
+    port = head;
+    while (port != NULL) {
+        route_table_port_add(
+            port->route_info.net, port->route_info.mac,
+            port->route_info.mac_len);
+        port = port->next;
+    }
+
     return true;
 }
 
@@ -721,7 +734,7 @@ void cleanup(void)
     port = head;
     while (port != NULL) {
         if (port->state == FINISHED) {
-            cleanup_dnets(port->route_info.dnets);
+            route_table_remove(port->route_info.net);
             port = port->next;
             free(head->iface);
             free(head);
@@ -729,7 +742,6 @@ void cleanup(void)
         }
     }
 
-    pthread_mutex_destroy(&msg_lock);
 }
 
 void print_msg(const BACMSG *msg)
@@ -748,24 +760,31 @@ void print_msg(const BACMSG *msg)
     }
 }
 
-uint16_t process_msg(BACMSG *msg, MSG_DATA *data, uint8_t **buff)
+uint16_t process_msg(BACMSG *msg, MSG_DATA *data)
 {
     BACNET_ADDRESS addr;
     BACNET_NPDU_DATA npdu_data;
     ROUTER_PORT *srcport;
     ROUTER_PORT *destport;
-    uint8_t npdu[MAX_NPDU];
+    BACNET_ROUTE_TABLE_ENTRY *dnet;
+    BACNET_ADDRESS *dest = NULL;
+    uint8_t *apdu;
     int16_t buff_len = 0;
     int apdu_offset;
     int apdu_len;
     int npdu_len;
 
-    memmove(data, msg->data, sizeof(MSG_DATA));
-
     apdu_offset = bacnet_npdu_decode(
         data->pdu, data->pdu_len, &data->dest, &addr, &npdu_data);
     apdu_len = data->pdu_len - apdu_offset;
 
+    dnet = route_table_find(data->dest.net);
+    if (dnet && (dnet->status == BACNET_ROUTE_BUSY)) {
+        /* congestion control - do not route until the network is
+           available again */
+        PRINT(INFO, "Message discarded: NET %u is busy\n", data->dest.net);
+        return -2;
+    }
     srcport = find_snet(msg->origin);
     destport = find_dnet(data->dest.net, NULL);
     assert(srcport);
@@ -784,28 +803,25 @@ uint16_t process_msg(BACMSG *msg, MSG_DATA *data, uint8_t **buff)
          * communication */
         if (data->dest.net == BACNET_BROADCAST_NETWORK ||
             destport->route_info.net != data->dest.net) {
-            npdu_len =
-                npdu_encode_pdu(npdu, &data->dest, &data->src, &npdu_data);
-        } else {
-            npdu_len = npdu_encode_pdu(npdu, NULL, &data->src, &npdu_data);
+            dest = &data->dest;
         }
 
-        buff_len = npdu_len + data->pdu_len - apdu_offset;
-
-        *buff = (uint8_t *)malloc(buff_len);
-        memmove(*buff, npdu, npdu_len); /* copy newly formed NPDU */
-        memmove(
-            *buff + npdu_len, &data->pdu[apdu_offset],
-            apdu_len); /* copy APDU */
+        /* write the new NPDU header in place, just before the APDU */
+        apdu = &data->pdu[apdu_offset];
+        npdu_len = npdu_encode_pdu(NULL, dest, &data->src, &npdu_data);
+        if ((apdu - npdu_len) < &data->buffer[0]) {
+            /* not enough headroom - discard message */
+            return -2;
+        }
+        data->pdu = apdu - npdu_len;
+        npdu_encode_pdu(data->pdu, dest, &data->src, &npdu_data);
 
+        buff_len = npdu_len + apdu_len;
     } else {
         /* request net search */
         return -1;
     }
 
-    /* delete received message */
-    free_data((MSG_DATA *)msg->data);
-
     return buff_len;
 }
 
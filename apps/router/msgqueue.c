@@ -15,70 +15,247 @@
 #include <pthread.h>
 #include "msgqueue.h"
 
-pthread_mutex_t msg_lock = PTHREAD_MUTEX_INITIALIZER;
+#if (ROUTER_MSGBOX_SIZE & (ROUTER_MSGBOX_SIZE - 1))
+#error "ROUTER_MSGBOX_SIZE must be a power of two"
+#endif
+#if (ROUTER_PACKET_POOL_SIZE > ROUTER_MSGBOX_SIZE)
+#error "ROUTER_PACKET_POOL_SIZE must fit in a message box"
+#endif
+
+/* one slot of a bounded multiple producer, multiple consumer ring.
+   The sequence tells whether the slot is ready to be written, or read,
+   for the current lap of the ring. */
+typedef struct _msgbox_slot {
+    unsigned sequence;
+    BACMSG msg;
+} MSGBOX_SLOT;
+
+typedef struct _msgbox {
+    bool valid;
+    /* next slot to write, and next slot to read */
+    unsigned head;
+    unsigned tail;
+    MSGBOX_SLOT slot[ROUTER_MSGBOX_SIZE];
+    /* number of receivers sleeping until a message is sent */
+    unsigned waiting;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+} MSGBOX;
+
+static MSGBOX Msgbox[ROUTER_MSGBOX_MAX];
+static unsigned Msgbox_Count;
+/* the pool of free packets is a message box of DATA messages */
+static MSGBOX Packet_Pool;
+static MSG_DATA Packet_Data[ROUTER_PACKET_POOL_SIZE];
+static pthread_once_t Packet_Pool_Once = PTHREAD_ONCE_INIT;
+
+static void msgbox_init(MSGBOX *box)
+{
+    unsigned i;
+
+    box->head = 0;
+    box->tail = 0;
+    for (i = 0; i < ROUTER_MSGBOX_SIZE; i++) {
+        box->slot[i].sequence = i;
+    }
+    box->waiting = 0;
+    pthread_mutex_init(&box->lock, NULL);
+    pthread_cond_init(&box->cond, NULL);
+    __atomic_store_n(&box->valid, true, __ATOMIC_RELEASE);
+}
+
+static bool msgbox_put(MSGBOX *box, const BACMSG *msg)
+{
+    MSGBOX_SLOT *slot;
+    unsigned pos, sequence;
+    int diff;
+
+    pos = __atomic_load_n(&box->head, __ATOMIC_RELAXED);
+    for (;;) {
+        slot = &box->slot[pos & (ROUTER_MSGBOX_SIZE - 1)];
+        sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        diff = (int)(sequence - pos);
+        if (diff == 0) {
+            /* the slot is free for this lap - claim it */
+            if (__atomic_compare_exchange_n(
+                    &box->head, &pos, pos + 1, true, __ATOMIC_RELAXED,
+                    __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            /* full */
+            return false;
+        } else {
+            pos = __atomic_load_n(&box->head, __ATOMIC_RELAXED);
+        }
+    }
+    slot->msg = *msg;
+    __atomic_store_n(&slot->sequence, pos + 1, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+static bool msgbox_get(MSGBOX *box, BACMSG *msg)
+{
+    MSGBOX_SLOT *slot;
+    unsigned pos, sequence;
+    int diff;
+
+    pos = __atomic_load_n(&box->tail, __ATOMIC_RELAXED);
+    for (;;) {
+        slot = &box->slot[pos & (ROUTER_MSGBOX_SIZE - 1)];
+        sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        diff = (int)(sequence - (pos + 1));
+        if (diff == 0) {
+            /* the slot was written for this lap - claim it */
+            if (__atomic_compare_exchange_n(
+                    &box->tail, &pos, pos + 1, true, __ATOMIC_RELAXED,
+                    __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            /* empty */
+            return false;
+        } else {
+            pos = __atomic_load_n(&box->tail, __ATOMIC_RELAXED);
+        }
+    }
+    *msg = slot->msg;
+    __atomic_store_n(
+        &slot->sequence, pos + ROUTER_MSGBOX_SIZE, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+static MSGBOX *msgbox_find(MSGBOX_ID id)
+{
+    if ((id < 0) || (id >= ROUTER_MSGBOX_MAX)) {
+        return NULL;
+    }
+    if (!__atomic_load_n(&Msgbox[id].valid, __ATOMIC_ACQUIRE)) {
+        return NULL;
+    }
+
+    return &Msgbox[id];
+}
+
+static void packet_pool_init(void)
+{
+    BACMSG msg = { 0 };
+    unsigned i;
+
+    msgbox_init(&Packet_Pool);
+    msg.type = DATA;
+    for (i = 0; i < ROUTER_PACKET_POOL_SIZE; i++) {
+        msg.data = &Packet_Data[i];
+        msgbox_put(&Packet_Pool, &msg);
+    }
+}
 
 MSGBOX_ID create_msgbox(void)
 {
-    MSGBOX_ID msgboxid;
+    unsigned index;
 
-    msgboxid = msgget(IPC_PRIVATE, 0666 | IPC_CREAT);
-    if (msgboxid == INVALID_MSGBOX_ID) {
+    index = __atomic_fetch_add(&Msgbox_Count, 1, __ATOMIC_RELAXED);
+    if (index >= ROUTER_MSGBOX_MAX) {
         return INVALID_MSGBOX_ID;
     }
+    msgbox_init(&Msgbox[index]);
 
-    return msgboxid;
+    return (MSGBOX_ID)index;
 }
 
-bool send_to_msgbox(MSGBOX_ID dest, BACMSG *msg)
+bool send_to_msgbox(MSGBOX_ID dest, const BACMSG *msg)
 {
-    int err;
+    MSGBOX *box;
 
-    err = msgsnd(dest, msg, sizeof(BACMSG) - sizeof(MSGTYPE), 0);
-    if (err) {
+    box = msgbox_find(dest);
+    if (!box) {
+        return false;
+    }
+    if (!msgbox_put(box, msg)) {
         return false;
     }
+    /* a receiver checks the ring after it says it is waiting,
+       so one of us sees the other */
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&box->waiting, __ATOMIC_RELAXED) > 0) {
+        pthread_mutex_lock(&box->lock);
+        pthread_cond_signal(&box->cond);
+        pthread_mutex_unlock(&box->lock);
+    }
+
     return true;
 }
 
 BACMSG *recv_from_msgbox(MSGBOX_ID src, BACMSG *msg, int flags)
 {
-    int recv_bytes;
+    MSGBOX *box;
 
-    recv_bytes = msgrcv(src, msg, sizeof(BACMSG) - sizeof(MSGTYPE), 0, flags);
-    if (recv_bytes > 0) {
+    box = msgbox_find(src);
+    if (!box) {
+        return NULL;
+    }
+    if (msgbox_get(box, msg)) {
         return msg;
-    } else {
+    }
+    if (flags & MSGBOX_NOWAIT) {
         return NULL;
     }
+    /* count each receiver, so that one that got a message does not
+       hide the others that are still waiting */
+    pthread_mutex_lock(&box->lock);
+    __atomic_add_fetch(&box->waiting, 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    while (!msgbox_get(box, msg)) {
+        pthread_cond_wait(&box->cond, &box->lock);
+    }
+    __atomic_sub_fetch(&box->waiting, 1, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&box->lock);
+
+    return msg;
 }
 
 void del_msgbox(MSGBOX_ID msgboxid)
 {
-    if (msgboxid == INVALID_MSGBOX_ID) {
+    if ((msgboxid < 0) || (msgboxid >= ROUTER_MSGBOX_MAX)) {
         return;
     } else {
-        msgctl(msgboxid, IPC_RMID, NULL);
+        __atomic_store_n(&Msgbox[msgboxid].valid, false, __ATOMIC_RELEASE);
     }
 }
 
-void free_data(MSG_DATA *data)
+MSG_DATA *alloc_data(void)
 {
-    if (data->pdu) {
-        free(data->pdu);
-        data->pdu = NULL;
+    BACMSG msg;
+    MSG_DATA *data = NULL;
+
+    pthread_once(&Packet_Pool_Once, packet_pool_init);
+    if (msgbox_get(&Packet_Pool, &msg)) {
+        data = (MSG_DATA *)msg.data;
+        data->pdu = &data->buffer[ROUTER_PACKET_HEADROOM];
+        data->pdu_len = 0;
+        data->ref_count = 1;
     }
+
+    return data;
+}
+
+void free_data(MSG_DATA *data)
+{
+    BACMSG msg = { 0 };
+
     if (data) {
-        free(data);
-        data = NULL;
+        msg.type = DATA;
+        msg.data = data;
+        msgbox_put(&Packet_Pool, &msg);
     }
 }
 
 void check_data(MSG_DATA *data)
 {
-    /* lock and decrement messages reference count */
-    pthread_mutex_lock(&msg_lock);
-    if (--data->ref_count == 0) {
+    /* decrement messages reference count */
+    if (__atomic_sub_fetch(&data->ref_count, 1, __ATOMIC_ACQ_REL) == 0) {
         free_data(data);
     }
-    pthread_mutex_unlock(&msg_lock);
 }
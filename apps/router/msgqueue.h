@@ -4,6 +4,13 @@
  * @date 2012
  * @brief Message queue module
  *
+ * Messages are passed between the router port threads and main()
+ * through bounded lock-free ring queues in the same process, and the
+ * packets are taken from a pool of buffers that is allocated once.
+ * Only a pointer to the packet is passed, so routing a packet does not
+ * allocate memory or make a system call, except when main() sleeps
+ * waiting for a message.
+ *
  * @section LICENSE
  *
  * SPDX-License-Identifier: MIT
@@ -13,18 +20,35 @@
 
 #include <stdint.h>
 #include <stdbool.h>
-#include <sys/types.h>
-#include <sys/ipc.h>
-#include <sys/msg.h>
 /* BACnet Stack defines - first */
 #include "bacnet/bacdef.h"
 /* BACnet Stack API */
 #include "bacnet/npdu.h"
 
-extern pthread_mutex_t msg_lock;
+/* number of messages in each message box - must be a power of two */
+#ifndef ROUTER_MSGBOX_SIZE
+#define ROUTER_MSGBOX_SIZE 256
+#endif
+/* number of message boxes: main() and one for each router port */
+#ifndef ROUTER_MSGBOX_MAX
+#define ROUTER_MSGBOX_MAX 16
+#endif
+/* number of packet buffers shared by all the router ports */
+#ifndef ROUTER_PACKET_POOL_SIZE
+#define ROUTER_PACKET_POOL_SIZE 128
+#endif
+/* largest PDU that is routed: an NPDU and the largest B/IP APDU */
+#define ROUTER_PDU_MAX (MAX_NPDU + 1476)
+/* space before the PDU, so that a larger NPDU header can be written
+   in place of the received one, and a datalink header received */
+#define ROUTER_PACKET_HEADROOM MAX_NPDU
+#define ROUTER_PACKET_SIZE (ROUTER_PACKET_HEADROOM + ROUTER_PDU_MAX)
 
 #define INVALID_MSGBOX_ID -1
 
+/* do not wait for a message in recv_from_msgbox() */
+#define MSGBOX_NOWAIT 1
+
 typedef int MSGBOX_ID;
 
 typedef enum { DATA = 1, SERVICE } MSGTYPE;
@@ -43,21 +67,27 @@ typedef struct _message {
 typedef struct _msg_data {
     BACNET_ADDRESS dest;
     BACNET_ADDRESS src;
+    /* the PDU is somewhere in the buffer, after the headroom */
     uint8_t *pdu;
     uint16_t pdu_len;
+    /* number of router ports that have yet to send the packet */
     uint8_t ref_count;
+    uint8_t buffer[ROUTER_PACKET_SIZE];
 } MSG_DATA;
 
 MSGBOX_ID create_msgbox(void);
 
-/* returns sent byte count */
-bool send_to_msgbox(MSGBOX_ID dest, BACMSG *msg);
+/* returns true if the message was queued */
+bool send_to_msgbox(MSGBOX_ID dest, const BACMSG *msg);
 
 /* returns received message */
 BACMSG *recv_from_msgbox(MSGBOX_ID src, BACMSG *msg, int flags);
 
 void del_msgbox(MSGBOX_ID msgboxid);
 
+/* take a packet from the pool, with the PDU after the headroom */
+MSG_DATA *alloc_data(void);
+
 /* free message data structure */
 void free_data(MSG_DATA *data);
 
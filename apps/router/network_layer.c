@@ -14,9 +14,41 @@
 #include "network_layer.h"
 #include "bacnet/bacint.h"
 
-uint16_t
-process_network_message(const BACMSG *msg, MSG_DATA *data, uint8_t **buff)
+/* set the reachability of the listed networks, or if none are listed,
+   of every network reached through the router that sent the message */
+static void set_dnet_status(
+    const BACNET_ADDRESS *src,
+    uint16_t snet,
+    const uint8_t *list,
+    int list_len,
+    BACNET_ROUTE_STATUS status)
 {
+    BACNET_ROUTE_TABLE_ENTRY *dnet;
+    uint16_t net;
+    unsigned index;
+    int i;
+
+    if (list_len >= 2) {
+        for (i = 0; (i + 2) <= list_len; i += 2) {
+            decode_unsigned16(&list[i], &net);
+            route_table_status_set(net, status);
+        }
+        return;
+    }
+    for (index = 0; index < route_table_size(); index++) {
+        dnet = route_table_entry(index);
+        if (dnet && (dnet->port_net == snet) && (dnet->net != snet) &&
+            (dnet->mac_len == src->len) &&
+            (memcmp(&dnet->mac[0], &src->adr[0], src->len) == 0)) {
+            route_table_status_set(dnet->net, status);
+        }
+    }
+}
+
+uint16_t process_network_message(const BACMSG *msg, MSG_DATA *data)
+{
+    const MSG_DATA *received = (const MSG_DATA *)msg->data;
+    const uint8_t *pdu = received->pdu;
     BACNET_NPDU_DATA npdu_data;
     ROUTER_PORT *srcport;
     ROUTER_PORT *destport;
@@ -26,11 +58,11 @@ process_network_message(const BACMSG *msg, MSG_DATA *data, uint8_t **buff)
     int apdu_offset;
     int apdu_len;
 
-    memmove(data, msg->data, sizeof(MSG_DATA));
-
+    /* the reply is built in its own packet */
+    data->src = received->src;
     apdu_offset = bacnet_npdu_decode(
-        data->pdu, data->pdu_len, &data->dest, NULL, &npdu_data);
-    apdu_len = data->pdu_len - apdu_offset;
+        pdu, received->pdu_len, &data->dest, NULL, &npdu_data);
+    apdu_len = received->pdu_len - apdu_offset;
 
     srcport = find_snet(msg->origin);
     data->src.net = srcport->route_info.net;
@@ -40,19 +72,24 @@ process_network_message(const BACMSG *msg, MSG_DATA *data, uint8_t **buff)
             PRINT(INFO, "Recieved Who-Is-Router-To-Network message\n");
             if (apdu_len) {
                 /* if NET specified */
-                decode_unsigned16(&data->pdu[apdu_offset], &net);
+                decode_unsigned16(&pdu[apdu_offset], &net);
                 if (srcport->route_info.net == net) {
                     PRINT(INFO, "Message discarded: NET directly connected\n");
                     return -2;
                 }
 
+                dnet = route_table_find(net);
+                if (dnet && (dnet->status == BACNET_ROUTE_BUSY)) {
+                    /* known, but not offered until it is available */
+                    PRINT(INFO, "Message discarded: NET %u is busy\n", net);
+                    return -2;
+                }
                 destport = find_dnet(net, NULL); /* see if NET can be reached */
                 if (destport) {
                     /* if TRUE send reply */
                     PRINT(INFO, "Sending I-Am-Router-To-Network message\n");
                     buff_len = create_network_message(
-                        NETWORK_MESSAGE_I_AM_ROUTER_TO_NETWORK, data, buff,
-                        &net);
+                        NETWORK_MESSAGE_I_AM_ROUTER_TO_NETWORK, data, &net);
                 } else {
                     data->dest.net = net; /* NET to look for */
                     return -1; /* else initiate NET search procedure */
@@ -61,7 +98,7 @@ process_network_message(const BACMSG *msg, MSG_DATA *data, uint8_t **buff)
                 /* if NET is omitted (message sent with -1) */
                 PRINT(INFO, "Sending I-Am-Router-To-Network message\n");
                 buff_len = create_network_message(
-                    NETWORK_MESSAGE_I_AM_ROUTER_TO_NETWORK, data, buff, NULL);
+                    NETWORK_MESSAGE_I_AM_ROUTER_TO_NETWORK, data, NULL);
             }
 
             break;
@@ -72,7 +109,7 @@ process_network_message(const BACMSG *msg, MSG_DATA *data, uint8_t **buff)
             int i;
             for (i = 0; i < net_count; i++) {
                 decode_unsigned16(
-                    &data->pdu[apdu_offset + 2 * i],
+                    &pdu[apdu_offset + 2 * i],
                     &net); /* decode received NET values */
                 add_dnet(
                     &srcport->route_info, net,
@@ -84,16 +121,22 @@ process_network_message(const BACMSG *msg, MSG_DATA *data, uint8_t **buff)
             /* first octet of the message contains rejection reason */
             /* next two octets contain NET (can be decoded for additional info
              * on error) */
-            error_code = data->pdu[apdu_offset];
+            error_code = pdu[apdu_offset];
+            net = 0;
+            if (apdu_len >= 3) {
+                decode_unsigned16(&pdu[apdu_offset + 1], &net);
+            }
             switch (error_code) {
                 case 0:
                     PRINT(ERROR, "Error!\n");
                     break;
                 case 1:
                     PRINT(ERROR, "Error: Network unreachable\n");
+                    route_table_status_set(net, BACNET_ROUTE_UNREACHABLE);
                     break;
                 case 2:
                     PRINT(ERROR, "Error: Network is busy\n");
+                    route_table_status_set(net, BACNET_ROUTE_BUSY);
                     break;
                 case 3:
                     PRINT(ERROR, "Error: Unknown network message type\n");
@@ -108,46 +151,46 @@ process_network_message(const BACMSG *msg, MSG_DATA *data, uint8_t **buff)
         }
         case NETWORK_MESSAGE_INIT_RT_TABLE:
             PRINT(INFO, "Recieved Initialize-Routing-Table message\n");
-            if (data->pdu[apdu_offset] > 0) {
-                int net_count = data->pdu[apdu_offset];
+            if (pdu[apdu_offset] > 0) {
+                int net_count = pdu[apdu_offset];
                 while (net_count--) {
                     int i = 1;
                     decode_unsigned16(
-                        &data->pdu[apdu_offset + i],
+                        &pdu[apdu_offset + i],
                         &net); /* decode received NET values */
                     add_dnet(
                         &srcport->route_info, net,
                         data->src); /* and update routing table */
-                    if (data->pdu[apdu_offset + i + 3] >
+                    if (pdu[apdu_offset + i + 3] >
                         0) { /* find next NET value */
-                        i = data->pdu[apdu_offset + i + 3] + 4;
+                        i = pdu[apdu_offset + i + 3] + 4;
                     } else {
                         i = i + 4;
                     }
                 }
                 buff_len = create_network_message(
-                    NETWORK_MESSAGE_INIT_RT_TABLE_ACK, data, buff, NULL);
+                    NETWORK_MESSAGE_INIT_RT_TABLE_ACK, data, NULL);
             } else {
                 buff_len = create_network_message(
-                    NETWORK_MESSAGE_INIT_RT_TABLE_ACK, data, buff, &buff);
+                    NETWORK_MESSAGE_INIT_RT_TABLE_ACK, data, &net);
             }
             break;
 
         case NETWORK_MESSAGE_INIT_RT_TABLE_ACK:
             PRINT(INFO, "Recieved Initialize-Routing-Table-Ack message\n");
-            if (data->pdu[apdu_offset] > 0) {
-                int net_count = data->pdu[apdu_offset];
+            if (pdu[apdu_offset] > 0) {
+                int net_count = pdu[apdu_offset];
                 while (net_count--) {
                     int i = 1;
                     decode_unsigned16(
-                        &data->pdu[apdu_offset + i],
+                        &pdu[apdu_offset + i],
                         &net); /* decode received NET values */
                     add_dnet(
                         &srcport->route_info, net,
                         data->src); /* and update routing table */
-                    if (data->pdu[apdu_offset + i + 3] >
+                    if (pdu[apdu_offset + i + 3] >
                         0) { /* find next NET value */
-                        i = data->pdu[apdu_offset + i + 3] + 4;
+                        i = pdu[apdu_offset + i + 3] + 4;
                     } else {
                         i = i + 4;
                     }
@@ -155,10 +198,20 @@ process_network_message(const BACMSG *msg, MSG_DATA *data, uint8_t **buff)
             }
             break;
 
-        case NETWORK_MESSAGE_INVALID:
-        case NETWORK_MESSAGE_I_COULD_BE_ROUTER_TO_NETWORK:
         case NETWORK_MESSAGE_ROUTER_BUSY_TO_NETWORK:
+            PRINT(INFO, "Recieved Router-Busy-To-Network message\n");
+            set_dnet_status(
+                &data->src, srcport->route_info.net, &pdu[apdu_offset],
+                apdu_len, BACNET_ROUTE_BUSY);
+            break;
         case NETWORK_MESSAGE_ROUTER_AVAILABLE_TO_NETWORK:
+            PRINT(INFO, "Recieved Router-Available-To-Network message\n");
+            set_dnet_status(
+                &data->src, srcport->route_info.net, &pdu[apdu_offset],
+                apdu_len, BACNET_ROUTE_AVAILABLE);
+            break;
+        case NETWORK_MESSAGE_INVALID:
+        case NETWORK_MESSAGE_I_COULD_BE_ROUTER_TO_NETWORK:
         case NETWORK_MESSAGE_ESTABLISH_CONNECTION_TO_NETWORK:
         case NETWORK_MESSAGE_DISCONNECT_CONNECTION_TO_NETWORK:
             /* hell if I know what to do with these messages */
@@ -176,7 +229,7 @@ process_network_message(const BACMSG *msg, MSG_DATA *data, uint8_t **buff)
             break;
         case NETWORK_MESSAGE_WHAT_IS_NETWORK_NUMBER:
             buff_len = create_network_message(
-                NETWORK_MESSAGE_NETWORK_NUMBER_IS, data, buff, &buff);
+                NETWORK_MESSAGE_NETWORK_NUMBER_IS, data, &net);
             break;
 
         default:
@@ -190,30 +243,32 @@ process_network_message(const BACMSG *msg, MSG_DATA *data, uint8_t **buff)
 uint16_t create_network_message(
     BACNET_NETWORK_MESSAGE_TYPE network_message_type,
     MSG_DATA *data,
-    uint8_t **buff,
     void *val)
 {
     int16_t buff_len;
     bool data_expecting_reply = false;
     BACNET_NPDU_DATA npdu_data;
+    uint8_t *buff;
 
     if (network_message_type == NETWORK_MESSAGE_INIT_RT_TABLE) {
         data_expecting_reply = true;
     }
     init_npdu(&npdu_data, network_message_type, data_expecting_reply);
 
-    *buff = (uint8_t *)malloc(128); /* resolve different length */
+    /* the message is written after the headroom of the packet */
+    data->pdu = &data->buffer[ROUTER_PACKET_HEADROOM];
+    buff = data->pdu;
 
     /* manual destination setup for Init-RT-Table-Ack message */
     data->dest.net = BACNET_BROADCAST_NETWORK;
-    buff_len = npdu_encode_pdu(*buff, &data->dest, NULL, &npdu_data);
+    buff_len = npdu_encode_pdu(buff, &data->dest, NULL, &npdu_data);
 
     switch (network_message_type) {
         case NETWORK_MESSAGE_WHO_IS_ROUTER_TO_NETWORK:
             if (val != NULL) {
                 uint8_t *valptr = (uint8_t *)val;
                 uint16_t val16 = (valptr[0]) + (valptr[1] << 8);
-                buff_len += encode_unsigned16(*buff + buff_len, val16);
+                buff_len += encode_unsigned16(buff + buff_len, val16);
             }
             break;
 
@@ -221,30 +276,22 @@ uint16_t create_network_message(
             if (val != NULL) {
                 uint8_t *valptr = (uint8_t *)val;
                 uint16_t val16 = (valptr[0]) + (valptr[1] << 8);
-                buff_len += encode_unsigned16(*buff + buff_len, val16);
+                buff_len += encode_unsigned16(buff + buff_len, val16);
             } else {
-                ROUTER_PORT *port = head;
-                DNET *dnet;
-                while (port != NULL) {
-                    if (port->route_info.net != data->src.net) {
-                        buff_len += encode_unsigned16(
-                            *buff + buff_len, port->route_info.net);
-                        dnet = port->route_info.dnets;
-                        while (dnet != NULL) {
-                            buff_len +=
-                                encode_unsigned16(*buff + buff_len, dnet->net);
-                            dnet = dnet->next;
-                        }
-                        port = port->next;
-                    } else {
-                        dnet = port->route_info.dnets;
-                        while (dnet != NULL) {
-                            buff_len +=
-                                encode_unsigned16(*buff + buff_len, dnet->net);
-                            dnet = dnet->next;
-                        }
-                        port = port->next;
+                /* every network not reached through the port the
+                   message is sent to, unless permanently unreachable */
+                BACNET_ROUTE_TABLE_ENTRY *dnet;
+                unsigned index;
+                for (index = 0; index < route_table_size(); index++) {
+                    dnet = route_table_entry(index);
+                    if (!dnet || (dnet->port_net == data->src.net) ||
+                        (dnet->status == BACNET_ROUTE_UNREACHABLE)) {
+                        continue;
+                    }
+                    if ((buff_len + 2) > ROUTER_PDU_MAX) {
+                        break;
                     }
+                    buff_len += encode_unsigned16(buff + buff_len, dnet->net);
                 }
             }
             break;
@@ -252,13 +299,13 @@ uint16_t create_network_message(
         case NETWORK_MESSAGE_REJECT_MESSAGE_TO_NETWORK: {
             uint8_t *valptr = (uint8_t *)val;
             uint16_t val16 = (valptr[0]) + (valptr[1] << 8);
-            buff_len += encode_unsigned16(*buff + buff_len, val16);
+            buff_len += encode_unsigned16(buff + buff_len, val16);
             break;
         }
         case NETWORK_MESSAGE_INIT_RT_TABLE:
         case NETWORK_MESSAGE_INIT_RT_TABLE_ACK:
             if ((uint8_t *)val) {
-                (*buff)[buff_len++] = (uint8_t)port_count;
+                buff[buff_len++] = (uint8_t)port_count;
 
                 if (port_count > 0) {
                     ROUTER_PORT *port = head;
@@ -266,14 +313,14 @@ uint16_t create_network_message(
 
                     while (port != NULL) {
                         buff_len += encode_unsigned16(
-                            *buff + buff_len, port->route_info.net);
-                        (*buff)[buff_len++] = portID++;
-                        (*buff)[buff_len++] = 0;
+                            buff + buff_len, port->route_info.net);
+                        buff[buff_len++] = portID++;
+                        buff[buff_len++] = 0;
                         port = port->next;
                     }
                 }
             } else {
-                (*buff)[buff_len++] = (uint8_t)0;
+                buff[buff_len++] = (uint8_t)0;
             }
             break;
 
@@ -308,37 +355,32 @@ uint16_t create_network_message(
 void send_network_message(
     BACNET_NETWORK_MESSAGE_TYPE network_message_type,
     MSG_DATA *data,
-    uint8_t **buff,
     void *val)
 {
     BACMSG msg;
-    ROUTER_PORT *port = head;
     int16_t buff_len;
 
     if (!data) {
-        data = (MSG_DATA *)malloc(sizeof(MSG_DATA));
+        data = alloc_data();
+        if (!data) {
+            PRINT(ERROR, "Error: No packet buffer available\n");
+            return;
+        }
         data->dest.net = BACNET_BROADCAST_NETWORK;
         data->dest.len = 0;
+        /* not a reply to any port */
+        data->src.net = 0;
     }
 
-    buff_len = create_network_message(network_message_type, data, buff, val);
+    buff_len = create_network_message(network_message_type, data, val);
 
     /* form network message */
-    data->pdu = *buff;
     data->pdu_len = buff_len;
     msg.origin = head->main_id;
     msg.type = DATA;
     msg.data = data;
 
-    data->ref_count = port_count;
-    while (port != NULL) {
-        if (port->state == FINISHED) {
-            port = port->next;
-            continue;
-        }
-        send_to_msgbox(port->port_id, &msg);
-        port = port->next;
-    }
+    send_to_ports(&msg, INVALID_MSGBOX_ID);
 }
 
 void init_npdu(
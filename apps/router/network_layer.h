@@ -24,19 +24,16 @@
 #include "bacport.h"
 #include "portthread.h"
 
-uint16_t
-process_network_message(const BACMSG *msg, MSG_DATA *data, uint8_t **buff);
+uint16_t process_network_message(const BACMSG *msg, MSG_DATA *data);
 
 uint16_t create_network_message(
     BACNET_NETWORK_MESSAGE_TYPE network_message_type,
     MSG_DATA *data,
-    uint8_t **buff,
     void *val);
 
 void send_network_message(
     BACNET_NETWORK_MESSAGE_TYPE network_message_type,
     MSG_DATA *data,
-    uint8_t **buff,
     void *val);
 
 void init_npdu(
@@ -27,34 +27,13 @@ ROUTER_PORT *find_snet(MSGBOX_ID id)
     return NULL;
 }
 
-ROUTER_PORT *find_dnet(uint16_t net, BACNET_ADDRESS *addr)
+ROUTER_PORT *find_port(uint16_t net)
 {
     ROUTER_PORT *port = head;
-    DNET *dnet;
-
-    /* for broadcast messages no search is needed */
-    if (net == BACNET_BROADCAST_NETWORK) {
-        return port;
-    }
 
     while (port != NULL) {
-        /* check if DNET is directly connected to the router */
-        if (net == port->route_info.net) {
+        if (port->route_info.net == net) {
             return port;
-
-            /* else search router ports DNET list */
-        } else if (port->route_info.dnets) {
-            dnet = port->route_info.dnets;
-            while (dnet != NULL) {
-                if (net == dnet->net) {
-                    if (addr) {
-                        memmove(&addr->len, &dnet->mac_len, 1);
-                        memmove(&addr->adr[0], &dnet->mac[0], MAX_MAC_LEN);
-                    }
-                    return port;
-                }
-                dnet = dnet->next;
-            }
         }
         port = port->next;
     }
@@ -62,43 +41,59 @@ ROUTER_PORT *find_dnet(uint16_t net, BACNET_ADDRESS *addr)
     return NULL;
 }
 
-void add_dnet(RT_ENTRY *route_info, uint16_t net, BACNET_ADDRESS addr)
+ROUTER_PORT *find_dnet(uint16_t net, BACNET_ADDRESS *addr)
 {
-    DNET *dnet = route_info->dnets;
-    DNET *tmp;
+    BACNET_ROUTE_TABLE_ENTRY *dnet;
 
-    if (dnet == NULL) {
-        route_info->dnets = (DNET *)malloc(sizeof(DNET));
-        memmove(&route_info->dnets->mac_len, &addr.len, 1);
-        memmove(&route_info->dnets->mac[0], &addr.adr[0], MAX_MAC_LEN);
-        route_info->dnets->net = net;
-        route_info->dnets->state = true;
-        route_info->dnets->next = NULL;
-    } else {
-        while (dnet != NULL) {
-            if (dnet->net == net) { /* make sure NETs are not repeated */
-                return;
-            }
-            tmp = dnet;
-            dnet = dnet->next;
-        }
+    /* for broadcast messages no search is needed */
+    if (net == BACNET_BROADCAST_NETWORK) {
+        return head;
+    }
 
-        dnet = (DNET *)malloc(sizeof(DNET));
-        memmove(&dnet->mac_len, &addr.len, 1);
-        memmove(&dnet->mac[0], &addr.adr[0], MAX_MAC_LEN);
-        dnet->net = net;
-        dnet->state = true;
-        dnet->next = NULL;
-        tmp->next = dnet;
+    /* the routing table finds the network by number. Nothing is
+       forwarded to a busy network until it is available again. */
+    dnet = route_table_find(net);
+    if (!dnet || (dnet->status != BACNET_ROUTE_AVAILABLE)) {
+        return NULL;
+    }
+    /* copy the next router address, if DNET is not directly connected */
+    if (addr && (dnet->port_net != dnet->net)) {
+        addr->len = dnet->mac_len;
+        memmove(&addr->adr[0], &dnet->mac[0], MAX_MAC_LEN);
     }
+
+    return find_port(dnet->port_net);
 }
 
-void cleanup_dnets(DNET *dnets)
+void send_to_ports(const BACMSG *msg, MSGBOX_ID skip)
 {
-    DNET *dnet = dnets;
-    while (dnet != NULL) {
-        dnet = dnet->next;
-        free(dnets);
-        dnets = dnet;
+    ROUTER_PORT *port;
+    MSG_DATA *data = (MSG_DATA *)msg->data;
+    uint8_t count = 0;
+
+    /* the packet is shared, and freed after the last port sends it */
+    for (port = head; port != NULL; port = port->next) {
+        if ((port->port_id != skip) && (port->state != FINISHED)) {
+            count++;
+        }
+    }
+    if (count == 0) {
+        free_data(data);
+        return;
     }
+    data->ref_count = count;
+    for (port = head; port != NULL; port = port->next) {
+        if ((port->port_id != skip) && (port->state != FINISHED)) {
+            if (!send_to_msgbox(port->port_id, msg)) {
+                check_data(data);
+            }
+        }
+    }
+}
+
+void add_dnet(RT_ENTRY *route_info, uint16_t net, BACNET_ADDRESS addr)
+{
+    /* learned again, or moved to another router; ports are never
+       replaced by a learned network */
+    route_table_learn(net, route_info->net, &addr.adr[0], addr.len);
 }
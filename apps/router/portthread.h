@@ -18,6 +18,7 @@
 #include "bacnet/bacdef.h"
 /* BACnet Stack API */
 #include "bacnet/npdu.h"
+#include "bacnet/basic/npdu/route_table.h"
 /* router utils */
 #include "msgqueue.h"
 
@@ -61,21 +62,12 @@ typedef union _port_params {
     } mstp_params;
 } PORT_PARAMS;
 
-/* list node for reacheble networks */
-typedef struct _dnet {
-    uint8_t mac[MAX_MAC_LEN];
-    uint8_t mac_len;
-    uint16_t net;
-    bool state; /* enabled or disabled */
-    struct _dnet *next;
-} DNET;
-
-/* information for routing table */
+/* information for routing table - the networks reachable through
+   the port are kept in the route_table module */
 typedef struct _routing_table_entry {
     uint8_t mac[MAX_MAC_LEN];
     uint8_t mac_len;
     uint16_t net;
-    DNET *dnets;
 } RT_ENTRY;
 
 typedef struct _port {
@@ -96,12 +88,16 @@ extern int port_count;
 /* get recieving router port */
 ROUTER_PORT *find_snet(MSGBOX_ID id);
 
+/* get router port by its directly connected network number */
+ROUTER_PORT *find_port(uint16_t net);
+
 /* get sending router port */
 ROUTER_PORT *find_dnet(uint16_t net, BACNET_ADDRESS *addr);
 
+/* send a packet to every running router port, except one */
+void send_to_ports(const BACMSG *msg, MSGBOX_ID skip);
+
 /* add reacheble network for specified router port */
 void add_dnet(RT_ENTRY *route_info, uint16_t net, BACNET_ADDRESS addr);
 
-void cleanup_dnets(DNET *dnets);
-
 #endif /* end of PORTTHREAD_H */
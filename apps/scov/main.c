@@ -396,7 +396,7 @@ int main(int argc, char *argv[])
                     "Sent SubscribeCOV request. "
                     " Waiting up to %u seconds....\n",
                     (unsigned)(timeout_seconds - elapsed_seconds));
-            } else if (tsm_invoke_id_free(Request_Invoke_ID)) {
+            } else if (tsm_invoke_id_free(&Target_Address, Request_Invoke_ID)) {
                 if (cov_data->next) {
                     cov_data = cov_data->next;
                     Request_Invoke_ID = 0;
@@ -405,9 +405,10 @@ int main(int argc, char *argv[])
                         break;
                     }
                 }
-            } else if (tsm_invoke_id_failed(Request_Invoke_ID)) {
+            } else if (tsm_invoke_id_failed(
+                           &Target_Address, Request_Invoke_ID)) {
                 fprintf(stderr, "\rError: TSM Timeout!\n");
-                tsm_free_invoke_id(Request_Invoke_ID);
+                tsm_free_invoke_id(&Target_Address, Request_Invoke_ID);
                 Error_Detected = true;
                 break;
             }
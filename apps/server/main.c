@@ -25,6 +25,7 @@
 #include "bacnet/version.h"
 /* some demo stuff needed */
 #include "bacnet/basic/binding/address.h"
+#include "bacnet/basic/client/bac-trend.h"
 #include "bacnet/basic/services.h"
 #include "bacnet/basic/sys/filename.h"
 #include "bacnet/basic/sys/mstimer.h"
@@ -54,6 +55,10 @@
 #if defined(BAC_UCI)
 #include "bacnet/basic/ucix/ucix.h"
 #endif /* defined(BAC_UCI) */
+#if defined(__linux__)
+#include "event-loop.h"
+#include "trendlog-mmap.h"
+#endif
 
 /* (Doxygen note: The next two lines pull all the following Javadoc
  *  into the ServerDemo module.) */
@@ -256,6 +261,214 @@ static void Init_Service_Handlers(void)
 #endif
 }
 
+/**
+ * @brief Receive and handle the waiting packets
+ * @param fd - readable datalink file descriptor, or -1 when polled
+ * @param context - not used
+ */
+static void datalink_receive_handler(int fd, void *context)
+{
+    BACNET_ADDRESS src = { 0 }; /* address where message came from */
+    uint16_t pdu_len = 0;
+
+    (void)fd;
+    (void)context;
+    do {
+        pdu_len = datalink_receive(&src, &Rx_Buf[0], MAX_MPDU, 0);
+        if (pdu_len) {
+            npdu_handler(&src, &Rx_Buf[0], pdu_len);
+        }
+    } while (pdu_len);
+}
+
+/**
+ * @brief Poll a datalink that has no file descriptor to wait on
+ * @param milliseconds - elapsed time, not used
+ * @param context - not used
+ */
+static void datalink_poll_handler(uint32_t milliseconds, void *context)
+{
+    (void)milliseconds;
+    datalink_receive_handler(-1, context);
+}
+
+/**
+ * @brief 1 second tasks
+ * @param milliseconds - elapsed time
+ * @param context - not used
+ */
+static void task_timer_handler(uint32_t milliseconds, void *context)
+{
+    uint32_t elapsed_seconds = milliseconds / 1000;
+#if defined(BACNET_TIME_MASTER)
+    BACNET_DATE_TIME bdatetime;
+#endif
+
+    (void)context;
+    dcc_timer_seconds(elapsed_seconds);
+    datalink_maintenance_timer(elapsed_seconds);
+    dlenv_maintenance_timer(elapsed_seconds);
+    handler_cov_timer_seconds(elapsed_seconds);
+    trend_log_timer(elapsed_seconds);
+#if defined(INTRINSIC_REPORTING)
+    Device_local_reporting();
+#endif
+#if defined(BACNET_TIME_MASTER)
+    Device_getCurrentDateTime(&bdatetime);
+    handler_timesync_task(&bdatetime);
+#endif
+}
+
+/**
+ * @brief TSM timeouts
+ * @param milliseconds - elapsed time
+ * @param context - not used
+ */
+static void tsm_timer_handler(uint32_t milliseconds, void *context)
+{
+    (void)context;
+    tsm_timer_milliseconds(milliseconds);
+}
+
+/**
+ * @brief Address binding timeouts
+ * @param milliseconds - elapsed time
+ * @param context - not used
+ */
+static void address_timer_handler(uint32_t milliseconds, void *context)
+{
+    (void)context;
+    address_cache_timer(milliseconds / 1000);
+}
+
+#if defined(INTRINSIC_REPORTING)
+/**
+ * @brief Notification recipient timeouts
+ * @param milliseconds - elapsed time, not used
+ * @param context - not used
+ */
+static void notification_timer_handler(uint32_t milliseconds, void *context)
+{
+    (void)milliseconds;
+    (void)context;
+    Notification_Class_find_recipient();
+}
+#endif
+
+/**
+ * @brief Object tasks
+ * @param milliseconds - elapsed time
+ * @param context - not used
+ */
+static void object_timer_handler(uint32_t milliseconds, void *context)
+{
+    (void)context;
+    Device_Timer(milliseconds);
+}
+
+#if defined(__linux__)
+/**
+ * @brief Run the TSM timer only while a transaction is timing, so that
+ *  an idle server is not woken for it.
+ * @param timer - the TSM timer of the event loop, or -1 if none
+ * @return the TSM timer of the event loop, or -1 if none
+ */
+static int event_loop_tsm_timer(int timer)
+{
+    if (tsm_timer_active()) {
+        if (timer < 0) {
+            timer = event_loop_timer_add(
+                mstimer_interval(&BACnet_TSM_Timer), tsm_timer_handler, NULL);
+        }
+    } else if (timer >= 0) {
+        event_loop_timer_remove(timer);
+        timer = -1;
+    }
+
+    return timer;
+}
+
+/**
+ * @brief Wait for the datalink and the cyclic timers in an event loop,
+ *  so that the server sleeps until there is work to do.
+ * @return false if the event loop could not be started
+ */
+static bool event_loop_task(void)
+{
+    int tsm_timer = -1;
+
+    if (!event_loop_init()) {
+        return false;
+    }
+    if (!event_loop_datalink_add(datalink_receive_handler, NULL)) {
+        /* this datalink has no file descriptor to wait on */
+        event_loop_timer_add(1, datalink_poll_handler, NULL);
+    }
+    event_loop_timer_add(
+        mstimer_interval(&BACnet_Task_Timer), task_timer_handler, NULL);
+    event_loop_timer_add(
+        mstimer_interval(&BACnet_Address_Timer), address_timer_handler, NULL);
+#if defined(INTRINSIC_REPORTING)
+    event_loop_timer_add(
+        mstimer_interval(&BACnet_Notification_Timer),
+        notification_timer_handler, NULL);
+#endif
+    event_loop_timer_add(
+        mstimer_interval(&BACnet_Object_Timer), object_timer_handler, NULL);
+    for (;;) {
+        /* a request may have been sent since the last wakeup */
+        tsm_timer = event_loop_tsm_timer(tsm_timer);
+        if (event_loop_run_once(-1) < 0) {
+            break;
+        }
+        /* run a whole COV cycle, since the next wakeup may be a while */
+        while (!handler_cov_fsm(false)) {
+            /* more COV work to do */
+        }
+        bacnet_trend_task();
+    }
+    event_loop_cleanup();
+
+    return false;
+}
+#endif
+
+#if defined(__linux__)
+/**
+ * @brief Keep the log buffers of the Trend Logs in files in the directory
+ *  named by BACNET_TRENDLOG_PATH, so that the records survive a restart.
+ *  BACNET_TRENDLOG_SIZE sets the number of records of each log buffer.
+ */
+static void trend_log_storage_init(void)
+{
+    char pathname[256];
+    const char *path;
+    const char *pEnv;
+    uint32_t buffer_size = TL_MAX_ENTRIES;
+    uint32_t instance;
+    unsigned i;
+
+    path = getenv("BACNET_TRENDLOG_PATH");
+    if (!path) {
+        return;
+    }
+    pEnv = getenv("BACNET_TRENDLOG_SIZE");
+    if (pEnv) {
+        buffer_size = strtoul(pEnv, NULL, 0);
+    }
+    for (i = 0; i < Trend_Log_Count(); i++) {
+        instance = Trend_Log_Index_To_Instance(i);
+        snprintf(
+            pathname, sizeof(pathname), "%s/trendlog-%lu.bin", path,
+            (unsigned long)instance);
+        if (!trend_log_mmap_open(instance, pathname, buffer_size)) {
+            fprintf(stderr, "Failed to open %s\n", pathname);
+        }
+    }
+    atexit(trend_log_mmap_cleanup);
+}
+#endif
+
 static void print_usage(const char *filename)
 {
     printf("Usage: %s [device-instance [device-name]]\n", filename);
@@ -297,12 +510,7 @@ int main(int argc, char *argv[])
     BACNET_ADDRESS src = { 0 }; /* address where message came from */
     uint16_t pdu_len = 0;
     unsigned timeout = 1; /* milliseconds */
-    uint32_t elapsed_milliseconds = 0;
-    uint32_t elapsed_seconds = 0;
     BACNET_CHARACTER_STRING DeviceName;
-#if defined(BACNET_TIME_MASTER)
-    BACNET_DATE_TIME bdatetime;
-#endif
 #if defined(BAC_UCI)
     int uciId = 0;
     struct uci_context *ctx;
@@ -357,6 +565,10 @@ int main(int argc, char *argv[])
        in our device bindings list */
     address_init();
     Init_Service_Handlers();
+    bacnet_trend_init();
+#if defined(__linux__)
+    trend_log_storage_init();
+#endif
     /* initialize timesync callback function. */
     handler_timesync_set_callback_set(&datetime_timesync);
 
@@ -385,6 +597,9 @@ int main(int argc, char *argv[])
     atexit(datalink_cleanup);
     /* broadcast an I-Am on startup */
     Send_I_Am(&Handler_Transmit_Buffer[0]);
+#if defined(__linux__)
+    event_loop_task();
+#endif
     /* loop forever */
     for (;;) {
         /* input */
@@ -396,45 +611,30 @@ int main(int argc, char *argv[])
         }
         if (mstimer_expired(&BACnet_Task_Timer)) {
             mstimer_reset(&BACnet_Task_Timer);
-            elapsed_milliseconds = mstimer_interval(&BACnet_Task_Timer);
-            elapsed_seconds = elapsed_milliseconds / 1000;
-            /* 1 second tasks */
-            dcc_timer_seconds(elapsed_seconds);
-            datalink_maintenance_timer(elapsed_seconds);
-            dlenv_maintenance_timer(elapsed_seconds);
-            handler_cov_timer_seconds(elapsed_seconds);
-            trend_log_timer(elapsed_seconds);
-#if defined(INTRINSIC_REPORTING)
-            Device_local_reporting();
-#endif
-#if defined(BACNET_TIME_MASTER)
-            Device_getCurrentDateTime(&bdatetime);
-            handler_timesync_task(&bdatetime);
-#endif
+            task_timer_handler(mstimer_interval(&BACnet_Task_Timer), NULL);
         }
         if (mstimer_expired(&BACnet_TSM_Timer)) {
             mstimer_reset(&BACnet_TSM_Timer);
-            elapsed_milliseconds = mstimer_interval(&BACnet_TSM_Timer);
-            tsm_timer_milliseconds(elapsed_milliseconds);
+            tsm_timer_handler(mstimer_interval(&BACnet_TSM_Timer), NULL);
         }
         if (mstimer_expired(&BACnet_Address_Timer)) {
             mstimer_reset(&BACnet_Address_Timer);
-            elapsed_milliseconds = mstimer_interval(&BACnet_Address_Timer);
-            elapsed_seconds = elapsed_milliseconds / 1000;
-            address_cache_timer(elapsed_seconds);
+            address_timer_handler(
+                mstimer_interval(&BACnet_Address_Timer), NULL);
         }
         handler_cov_task();
+        bacnet_trend_task();
 #if defined(INTRINSIC_REPORTING)
         if (mstimer_expired(&BACnet_Notification_Timer)) {
             mstimer_reset(&BACnet_Notification_Timer);
-            Notification_Class_find_recipient();
+            notification_timer_handler(
+                mstimer_interval(&BACnet_Notification_Timer), NULL);
         }
 #endif
         /* output */
         if (mstimer_expired(&BACnet_Object_Timer)) {
             mstimer_reset(&BACnet_Object_Timer);
-            elapsed_milliseconds = mstimer_interval(&BACnet_Object_Timer);
-            Device_Timer(elapsed_milliseconds);
+            object_timer_handler(mstimer_interval(&BACnet_Object_Timer), NULL);
         }
     }
 
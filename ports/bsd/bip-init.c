@@ -281,6 +281,39 @@ int bip_send_mpdu(
         (struct sockaddr *)&bip_dest, sizeof(struct sockaddr));
 }
 
+/**
+ * The send function for BACnet/IP driver layer, to send the same MPDU
+ * to a list of destinations, one datagram at a time.
+ *
+ * @param dest - array of destination addresses
+ * @param dest_count - number of destination addresses
+ * @param mtu - the bytes of data to send
+ * @param mtu_len - the number of bytes of data to send
+ *
+ * @return Upon successful completion, returns the number of destinations
+ *  the MPDU was sent to. Otherwise, -1 shall be returned.
+ */
+int bip_send_mpdu_multiple(
+    const BACNET_IP_ADDRESS *dest,
+    unsigned dest_count,
+    const uint8_t *mtu,
+    uint16_t mtu_len)
+{
+    unsigned i = 0;
+    int sent = 0;
+
+    for (i = 0; i < dest_count; i++) {
+        if (bip_send_mpdu(&dest[i], mtu, mtu_len) > 0) {
+            sent++;
+        }
+    }
+    if ((sent == 0) && (dest_count > 0)) {
+        return -1;
+    }
+
+    return sent;
+}
+
 /**
  * BACnet/IP Datalink Receive handler.
  *
@@ -147,6 +147,15 @@ uint16_t bip6_get_port(void)
     return BIP6_Addr.port;
 }
 
+/**
+ * @brief Return the active BIP6 socket.
+ * @return The active BIP6 socket, or -1 if uninitialized.
+ */
+int bip6_get_socket(void)
+{
+    return BIP6_Socket;
+}
+
 /**
  * Get the BACnet broadcast address for my interface.
  * Used as dest address in messages sent as BROADCAST
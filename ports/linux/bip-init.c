@@ -6,6 +6,10 @@
  *
  *********************************************************************/
 /* linux Ethernet/IP specific */
+#ifndef _GNU_SOURCE
+/* for recvmmsg() and sendmmsg() */
+#define _GNU_SOURCE
+#endif
 #include <asm/types.h>
 #include <netinet/ether.h>
 #include <netinet/in.h>
@@ -54,6 +58,15 @@ static struct in_addr BIP_Broadcast_Binding_Address;
 static bool BIP_Debug = false;
 /* interface name */
 static char BIP_Interface_Name[IF_NAMESIZE] = { 0 };
+/* number of destinations sent in one system call */
+#ifndef BIP_SEND_BATCH
+#define BIP_SEND_BATCH 128
+#endif
+/* datagrams received in one batch that bip_receive() has not returned */
+static uint8_t BIP_Rx_Buffer[BIP_RECEIVE_BATCH][BIP_MPDU_MAX];
+static BIP_PACKET BIP_Rx_Packet[BIP_RECEIVE_BATCH];
+static unsigned BIP_Rx_Count;
+static unsigned BIP_Rx_Index;
 
 /**
  * @brief Print the IPv4 address with debug info
@@ -301,114 +314,319 @@ int bip_send_mpdu(
 }
 
 /**
- * BACnet/IP Datalink Receive handler.
+ * The send function for BACnet/IP driver layer, to send the same MPDU
+ * to a list of destinations. The datagrams are passed to the kernel
+ * in batches using sendmmsg().
  *
- * @param src - returns the source address
- * @param npdu - returns the NPDU buffer
- * @param max_npdu -maximum size of the NPDU buffer
- * @param timeout - number of milliseconds to wait for a packet
+ * @param dest - array of destination addresses
+ * @param dest_count - number of destination addresses
+ * @param mtu - the bytes of data to send
+ * @param mtu_len - the number of bytes of data to send
  *
- * @return Number of bytes received, or 0 if none or timeout.
+ * @return Upon successful completion, returns the number of destinations
+ *  the MPDU was sent to. Otherwise, -1 shall be returned and errno set
+ *  to indicate the error.
  */
-uint16_t bip_receive(
-    BACNET_ADDRESS *src, uint8_t *npdu, uint16_t max_npdu, unsigned timeout)
+int bip_send_mpdu_multiple(
+    const BACNET_IP_ADDRESS *dest,
+    unsigned dest_count,
+    const uint8_t *mtu,
+    uint16_t mtu_len)
 {
-    uint16_t npdu_len = 0; /* return value */
-    fd_set read_fds;
-    int max = 0;
-    struct timeval select_timeout;
-    struct sockaddr_in sin = { 0 };
-    BACNET_IP_ADDRESS addr = { 0 };
-    socklen_t sin_len = sizeof(sin);
-    int received_bytes = 0;
-    int offset = 0;
-    uint16_t i = 0;
-    int socket;
+    struct mmsghdr msgs[BIP_SEND_BATCH];
+    struct sockaddr_in bip_dest[BIP_SEND_BATCH];
+    struct iovec iov;
+    unsigned count = 0;
+    unsigned sent = 0;
+    unsigned i = 0;
+    int rv = 0;
 
-    /* Make sure the socket is open */
+    /* assumes that the driver has already been initialized */
     if (BIP_Socket < 0) {
-        return 0;
+        if (BIP_Debug) {
+            fprintf(stderr, "BIP: driver not initialized!\n");
+            fflush(stderr);
+        }
+        return BIP_Socket;
     }
-    /* we could just use a non-blocking socket, but that consumes all
-       the CPU time.  We can use a timeout; it is only supported as
-       a select. */
-    if (timeout >= 1000) {
-        select_timeout.tv_sec = timeout / 1000;
-        select_timeout.tv_usec =
-            1000 * (timeout - select_timeout.tv_sec * 1000);
-    } else {
-        select_timeout.tv_sec = 0;
-        select_timeout.tv_usec = 1000 * timeout;
-    }
-    FD_ZERO(&read_fds);
-    FD_SET(BIP_Socket, &read_fds);
-    FD_SET(BIP_Broadcast_Socket, &read_fds);
-
-    max = BIP_Socket > BIP_Broadcast_Socket ? BIP_Socket : BIP_Broadcast_Socket;
-
-    /* see if there is a packet for us */
-    if (select(max + 1, &read_fds, NULL, NULL, &select_timeout) > 0) {
-        socket =
-            FD_ISSET(BIP_Socket, &read_fds) ? BIP_Socket : BIP_Broadcast_Socket;
-        received_bytes = recvfrom(
-            socket, (char *)&npdu[0], max_npdu, 0, (struct sockaddr *)&sin,
-            &sin_len);
-    } else {
-        return 0;
+    /* every datagram shares the same payload */
+    iov.iov_base = (void *)mtu;
+    iov.iov_len = mtu_len;
+    while (sent < dest_count) {
+        count = dest_count - sent;
+        if (count > BIP_SEND_BATCH) {
+            count = BIP_SEND_BATCH;
+        }
+        memset(msgs, 0, count * sizeof(struct mmsghdr));
+        memset(bip_dest, 0, count * sizeof(struct sockaddr_in));
+        for (i = 0; i < count; i++) {
+            bip_dest[i].sin_family = AF_INET;
+            memcpy(
+                &bip_dest[i].sin_addr.s_addr, &dest[sent + i].address[0], 4);
+            bip_dest[i].sin_port = htons(dest[sent + i].port);
+            msgs[i].msg_hdr.msg_name = &bip_dest[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+            msgs[i].msg_hdr.msg_iov = &iov;
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            debug_print_ipv4(
+                "Sending MPDU->", &bip_dest[i].sin_addr, bip_dest[i].sin_port,
+                mtu_len);
+        }
+        rv = sendmmsg(BIP_Socket, msgs, count, 0);
+        if (rv <= 0) {
+            break;
+        }
+        sent += (unsigned)rv;
     }
-    /* See if there is a problem */
-    if (received_bytes < 0) {
-        return 0;
+    if ((sent == 0) && (dest_count > 0)) {
+        return -1;
     }
+
+    return (int)sent;
+}
+
+/**
+ * Handle the BVLC header of a received datagram, and find its NPDU
+ *
+ * @param socket - socket the datagram was received from
+ * @param sin - source IP address and UDP port of the datagram
+ * @param packet - the datagram, which returns the NPDU offset and length
+ * @param received_bytes - number of bytes in the datagram
+ *
+ * @return Number of bytes in the NPDU, or 0 if there is no NPDU
+ */
+static uint16_t bip_packet_handler(
+    int socket,
+    const struct sockaddr_in *sin,
+    BIP_PACKET *packet,
+    int received_bytes)
+{
+    BACNET_IP_ADDRESS addr = { 0 };
+    uint8_t *mpdu = packet->mpdu;
+    int offset = 0;
+    int max = 0;
+
+    packet->npdu_offset = 0;
+    packet->npdu_len = 0;
     /* no problem, just no bytes */
-    if (received_bytes == 0) {
+    if (received_bytes <= 0) {
         return 0;
     }
     /* the signature of a BACnet/IPv packet */
-    if (npdu[0] != BVLL_TYPE_BACNET_IP) {
+    if (mpdu[0] != BVLL_TYPE_BACNET_IP) {
         return 0;
     }
     /* Erase up to 16 bytes after the received bytes as safety margin to
      * ensure that the decoding functions will run into a 'safe field'
      * of zero, if for any reason they would overrun, when parsing the
      * message. */
-    max = (int)max_npdu - received_bytes;
+    max = (int)packet->mpdu_size - received_bytes;
     if (max > 0) {
         if (max > 16) {
             max = 16;
         }
-        memset(&npdu[received_bytes], 0, max);
+        memset(&mpdu[received_bytes], 0, max);
     }
     /* Data link layer addressing between B/IPv4 nodes consists of a 32-bit
        IPv4 address followed by a two-octet UDP port number (both of which
        shall be transmitted with the most significant octet first). This
        address shall be referred to as a B/IPv4 address.
     */
-    memcpy(&addr.address[0], &sin.sin_addr.s_addr, 4);
-    addr.port = ntohs(sin.sin_port);
+    memcpy(&addr.address[0], &sin->sin_addr.s_addr, 4);
+    addr.port = ntohs(sin->sin_port);
     debug_print_ipv4(
-        "Received MPDU->", &sin.sin_addr, sin.sin_port, received_bytes);
+        "Received MPDU->", &sin->sin_addr, sin->sin_port, received_bytes);
     /* pass the packet into the BBMD handler */
     if (socket == BIP_Socket) {
-        offset = bvlc_handler(&addr, src, npdu, received_bytes);
+        offset = bvlc_handler(&addr, &packet->src, mpdu, received_bytes);
     } else {
-        offset = bvlc_broadcast_handler(&addr, src, npdu, received_bytes);
+        offset =
+            bvlc_broadcast_handler(&addr, &packet->src, mpdu, received_bytes);
     }
     if (offset > 0) {
-        npdu_len = received_bytes - offset;
+        packet->bvlc_function = bvlc_get_function_code();
+        packet->npdu_offset = (uint16_t)offset;
+        packet->npdu_len = (uint16_t)(received_bytes - offset);
         debug_print_ipv4(
-            "Received NPDU->", &sin.sin_addr, sin.sin_port, npdu_len);
-        if (npdu_len <= max_npdu) {
-            /* shift the buffer to return a valid NPDU */
-            for (i = 0; i < npdu_len; i++) {
-                npdu[i] = npdu[offset + i];
-            }
+            "Received NPDU->", &sin->sin_addr, sin->sin_port,
+            packet->npdu_len);
+    }
+
+    return packet->npdu_len;
+}
+
+/**
+ * Receive the datagrams waiting on a socket, up to the number of packets,
+ * and keep those that hold an NPDU at the start of the packets.
+ *
+ * @param socket - socket to receive from
+ * @param packets - array of packets with their datagram buffers
+ * @param count - number of packets
+ *
+ * @return Number of packets that hold an NPDU
+ */
+static unsigned
+bip_receive_socket(int socket, BIP_PACKET *packets, unsigned count)
+{
+    struct mmsghdr msgs[BIP_RECEIVE_BATCH];
+    struct iovec iov[BIP_RECEIVE_BATCH];
+    struct sockaddr_in sin[BIP_RECEIVE_BATCH];
+    BIP_PACKET packet;
+    unsigned npdu_count = 0;
+    unsigned i = 0;
+    int received = 0;
+
+    if (count > BIP_RECEIVE_BATCH) {
+        count = BIP_RECEIVE_BATCH;
+    }
+    memset(msgs, 0, count * sizeof(struct mmsghdr));
+    for (i = 0; i < count; i++) {
+        iov[i].iov_base = packets[i].mpdu;
+        iov[i].iov_len = packets[i].mpdu_size;
+        msgs[i].msg_hdr.msg_name = &sin[i];
+        msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    /* the socket is readable, so only take what is already waiting */
+    received = recvmmsg(socket, msgs, count, MSG_DONTWAIT, NULL);
+    if (received <= 0) {
+        return 0;
+    }
+    for (i = 0; i < (unsigned)received; i++) {
+        if (bip_packet_handler(
+                socket, &sin[i], &packets[i], (int)msgs[i].msg_len) == 0) {
+            continue;
+        }
+        if (i != npdu_count) {
+            /* swap the buffers, so none are lost */
+            packet = packets[npdu_count];
+            packets[npdu_count] = packets[i];
+            packets[i] = packet;
+        }
+        npdu_count++;
+    }
+
+    return npdu_count;
+}
+
+/**
+ * BACnet/IP Datalink Receive handler for a batch of datagrams.
+ * Waits for a datagram, then drains up to count datagrams from the
+ * sockets with recvmmsg(). The NPDU is not moved in the datagram buffer.
+ * A timeout of zero does not wait, so a caller that already knows that
+ * a socket is readable, such as an event loop, avoids the select().
+ *
+ * @param packets - array of packets, each with its datagram buffer.
+ *  The packets are reordered so that those with an NPDU come first.
+ * @param count - number of packets
+ * @param timeout - number of milliseconds to wait for a packet
+ *
+ * @return Number of packets with an NPDU, or 0 if none or timeout.
+ */
+unsigned bip_receive_packets(
+    BIP_PACKET *packets, unsigned count, unsigned timeout)
+{
+    fd_set read_fds;
+    int max = 0;
+    struct timeval select_timeout;
+    unsigned npdu_count = 0;
+    bool unicast = true;
+    bool broadcast = true;
+
+    /* Make sure the socket is open */
+    if ((BIP_Socket < 0) || !packets || (count == 0)) {
+        return 0;
+    }
+    if (timeout > 0) {
+        /* we could just use a non-blocking socket, but that consumes all
+           the CPU time.  We can use a timeout; it is only supported as
+           a select. */
+        if (timeout >= 1000) {
+            select_timeout.tv_sec = timeout / 1000;
+            select_timeout.tv_usec =
+                1000 * (timeout - select_timeout.tv_sec * 1000);
         } else {
-            if (BIP_Debug) {
-                fprintf(stderr, "BIP: NPDU dropped!\n");
-                fflush(stderr);
+            select_timeout.tv_sec = 0;
+            select_timeout.tv_usec = 1000 * timeout;
+        }
+        FD_ZERO(&read_fds);
+        FD_SET(BIP_Socket, &read_fds);
+        FD_SET(BIP_Broadcast_Socket, &read_fds);
+
+        max = BIP_Socket > BIP_Broadcast_Socket ? BIP_Socket
+                                                : BIP_Broadcast_Socket;
+
+        /* see if there is a packet for us */
+        if (select(max + 1, &read_fds, NULL, NULL, &select_timeout) <= 0) {
+            return 0;
+        }
+        unicast = FD_ISSET(BIP_Socket, &read_fds);
+        broadcast = FD_ISSET(BIP_Broadcast_Socket, &read_fds);
+    }
+    if (unicast) {
+        npdu_count = bip_receive_socket(BIP_Socket, packets, count);
+    }
+    if (broadcast && (BIP_Broadcast_Socket >= 0) && (npdu_count < count)) {
+        npdu_count += bip_receive_socket(
+            BIP_Broadcast_Socket, &packets[npdu_count], count - npdu_count);
+    }
+
+    return npdu_count;
+}
+
+/**
+ * BACnet/IP Datalink Receive handler.
+ * The datagrams are received in batches, and returned one at a time.
+ *
+ * @param src - returns the source address
+ * @param npdu - returns the NPDU buffer
+ * @param max_npdu -maximum size of the NPDU buffer
+ * @param timeout - number of milliseconds to wait for a packet
+ *
+ * @return Number of bytes received, or 0 if none or timeout.
+ */
+uint16_t bip_receive(
+    BACNET_ADDRESS *src, uint8_t *npdu, uint16_t max_npdu, unsigned timeout)
+{
+    const BIP_PACKET *packet;
+    uint16_t npdu_len = 0; /* return value */
+    unsigned i = 0;
+    int max = 0;
+
+    if (BIP_Rx_Index >= BIP_Rx_Count) {
+        for (i = 0; i < BIP_RECEIVE_BATCH; i++) {
+            BIP_Rx_Packet[i].mpdu = &BIP_Rx_Buffer[i][0];
+            BIP_Rx_Packet[i].mpdu_size = sizeof(BIP_Rx_Buffer[i]);
+        }
+        BIP_Rx_Index = 0;
+        BIP_Rx_Count =
+            bip_receive_packets(BIP_Rx_Packet, BIP_RECEIVE_BATCH, timeout);
+    }
+    /* a dropped NPDU does not end the batch, so that a caller that
+       receives until zero does not leave packets behind */
+    while ((npdu_len == 0) && (BIP_Rx_Index < BIP_Rx_Count)) {
+        packet = &BIP_Rx_Packet[BIP_Rx_Index];
+        BIP_Rx_Index++;
+        if (packet->npdu_len <= max_npdu) {
+            npdu_len = packet->npdu_len;
+            memcpy(npdu, &packet->mpdu[packet->npdu_offset], npdu_len);
+            if (src) {
+                *src = packet->src;
+            }
+            /* the function of this NPDU, not the last one in the batch */
+            bvlc_set_function_code(packet->bvlc_function);
+            /* keep a 'safe field' of zero after the NPDU for the decoders */
+            max = (int)max_npdu - npdu_len;
+            if (max > 0) {
+                if (max > 16) {
+                    max = 16;
+                }
+                memset(&npdu[npdu_len], 0, max);
             }
-            npdu_len = 0;
+        } else if (BIP_Debug) {
+            fprintf(stderr, "BIP: NPDU dropped!\n");
+            fflush(stderr);
         }
     }
 
@@ -957,6 +1175,9 @@ void bip_cleanup(void)
         close(BIP_Broadcast_Socket);
     }
     BIP_Broadcast_Socket = -1;
+    /* forget the datagrams not yet returned */
+    BIP_Rx_Count = 0;
+    BIP_Rx_Index = 0;
 
     return;
 }
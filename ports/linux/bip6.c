@@ -158,6 +158,15 @@ uint16_t bip6_get_port(void)
     return BIP6_Addr.port;
 }
 
+/**
+ * @brief Return the active BIP6 socket.
+ * @return The active BIP6 socket, or -1 if uninitialized.
+ */
+int bip6_get_socket(void)
+{
+    return BIP6_Socket;
+}
+
 /**
  * Get the BACnet broadcast address for my interface.
  * Used as dest address in messages sent as BROADCAST
@@ -320,28 +329,30 @@ uint16_t bip6_receive(
     if (BIP6_Socket < 0) {
         return 0;
     }
-    /* we could just use a non-blocking socket, but that consumes all
-       the CPU time.  We can use a timeout; it is only supported as
-       a select. */
-    if (timeout >= 1000) {
-        select_timeout.tv_sec = timeout / 1000;
-        select_timeout.tv_usec =
-            1000 * (timeout - select_timeout.tv_sec * 1000);
-    } else {
-        select_timeout.tv_sec = 0;
-        select_timeout.tv_usec = 1000 * timeout;
-    }
-    FD_ZERO(&read_fds);
-    FD_SET(BIP6_Socket, &read_fds);
-    max = BIP6_Socket;
-    /* see if there is a packet for us */
-    if (select(max + 1, &read_fds, NULL, NULL, &select_timeout) > 0) {
-        received_bytes = recvfrom(
-            BIP6_Socket, (char *)&npdu[0], max_npdu, 0, (struct sockaddr *)&sin,
-            &sin_len);
-    } else {
-        return 0;
+    if (timeout > 0) {
+        /* we could just use a non-blocking socket, but that consumes all
+           the CPU time.  We can use a timeout; it is only supported as
+           a select. */
+        if (timeout >= 1000) {
+            select_timeout.tv_sec = timeout / 1000;
+            select_timeout.tv_usec =
+                1000 * (timeout - select_timeout.tv_sec * 1000);
+        } else {
+            select_timeout.tv_sec = 0;
+            select_timeout.tv_usec = 1000 * timeout;
+        }
+        FD_ZERO(&read_fds);
+        FD_SET(BIP6_Socket, &read_fds);
+        max = BIP6_Socket;
+        /* see if there is a packet for us */
+        if (select(max + 1, &read_fds, NULL, NULL, &select_timeout) <= 0) {
+            return 0;
+        }
     }
+    /* a timeout of zero does not wait for the socket to be readable */
+    received_bytes = recvfrom(
+        BIP6_Socket, (char *)&npdu[0], max_npdu, MSG_DONTWAIT,
+        (struct sockaddr *)&sin, &sin_len);
     /* See if there is a problem */
     if (received_bytes < 0) {
         return 0;
@@ -13,6 +13,7 @@
 #include <string.h>
 #include <stdio.h>
 #include <sys/time.h>
+#include <sys/eventfd.h>
 /* BACnet Stack defines - first */
 #include "bacnet/bacdef.h"
 /* BACnet Stack API */
@@ -26,45 +27,18 @@
 #include "bacport.h"
 /* port specific */
 #include "rs485.h"
+#include "dlmstp_port.h"
 
 /** @file linux/dlmstp.c  Provides Linux-specific DataLink functions for MS/TP.
+ *  The state of each MS/TP port is in a struct dlmstp_port, and the
+ *  dlmstp_ functions use a port of their own.
  */
 
 /* Number of MS/TP Packets Rx/Tx */
 uint16_t MSTP_Packets = 0;
 
-/* packet queues */
-static DLMSTP_PACKET Receive_Packet;
-/* mechanism to wait for a packet */
-static pthread_cond_t Receive_Packet_Flag;
-static pthread_mutex_t Receive_Packet_Mutex;
-static pthread_cond_t Received_Frame_Flag;
-static pthread_mutex_t Received_Frame_Mutex;
-static pthread_cond_t Master_Done_Flag;
-static pthread_mutex_t Master_Done_Mutex;
-static pthread_mutex_t Ring_Buffer_Mutex;
-static pthread_mutex_t Thread_Mutex;
-static pthread_t hThread;
-static bool run_thread;
-
-/* local MS/TP port data - shared with RS-485 */
-static struct mstp_port_struct_t MSTP_Port;
-/* buffers needed by mstp port struct */
-static uint8_t TxBuffer[DLMSTP_MPDU_MAX];
-static uint8_t RxBuffer[DLMSTP_MPDU_MAX];
-/* data structure for MS/TP PDU Queue */
-struct mstp_pdu_packet {
-    bool data_expecting_reply;
-    uint8_t destination_mac;
-    uint16_t length;
-    uint8_t buffer[DLMSTP_MPDU_MAX];
-};
-/* count must be a power of 2 for ringbuf library */
-#ifndef MSTP_PDU_PACKET_COUNT
-#define MSTP_PDU_PACKET_COUNT 8
-#endif
-static struct mstp_pdu_packet PDU_Buffer[MSTP_PDU_PACKET_COUNT];
-static RING_BUFFER PDU_Queue;
+/* the port used by the dlmstp_ functions */
+static struct dlmstp_port MSTP_Default_Port;
 /* The minimum time without a DataAvailable or ReceiveError event */
 /* that a node must wait for a station to begin replying to a */
 /* confirmed request: 255 milliseconds. (Implementations may use */
@@ -75,9 +49,6 @@ static uint16_t Treply_timeout = 300;
 /* Master frame: 20 milliseconds. (Implementations may use larger values for */
 /* this timeout, not to exceed 35 milliseconds.) */
 static uint8_t Tusage_timeout = 30;
-/* Timer that indicates line silence - and functions */
-
-static struct timespec start;
 
 /**
  * Calculate the time difference between two timespec values.
@@ -132,14 +103,26 @@ static void timespec_add_ns(struct timespec *ts, long ns)
     }
 }
 
+/**
+ * @brief Get the port that holds the MS/TP state machine data
+ * @param mstp_port - MS/TP state machine data of a port
+ * @return the port
+ */
+static struct dlmstp_port *dlmstp_port_of(struct mstp_port_struct_t *mstp_port)
+{
+    return (struct dlmstp_port *)((char *)mstp_port -
+                                  offsetof(struct dlmstp_port, MSTP_Port));
+}
+
+/* Timer that indicates line silence - and functions */
 static uint32_t Timer_Silence(void *pArg)
 {
+    struct dlmstp_port *port = dlmstp_port_of(pArg);
     struct timespec now, diff;
     int32_t res;
 
-    (void)pArg;
     clock_gettime(CLOCK_MONOTONIC, &now);
-    timespec_subtract(&diff, &now, &start);
+    timespec_subtract(&diff, &now, &port->Silence_Start);
     res = ((diff.tv_sec) * 1000 + (diff.tv_nsec) / 1000000);
 
     return (res >= 0 ? res : 0);
@@ -147,8 +130,9 @@ static uint32_t Timer_Silence(void *pArg)
 
 static void Timer_Silence_Reset(void *pArg)
 {
-    (void)pArg;
-    clock_gettime(CLOCK_MONOTONIC, &start);
+    struct dlmstp_port *port = dlmstp_port_of(pArg);
+
+    clock_gettime(CLOCK_MONOTONIC, &port->Silence_Start);
 }
 
 static void get_abstime(struct timespec *abstime, unsigned long milliseconds)
@@ -163,37 +147,113 @@ static void get_abstime(struct timespec *abstime, unsigned long milliseconds)
     timespec_add_ns(abstime, 1000000 * milliseconds);
 }
 
+/**
+ * @brief Stop the thread of a port, and close its serial port
+ * @param port - MS/TP port started with dlmstp_port_init()
+ */
+void dlmstp_port_cleanup(struct dlmstp_port *port)
+{
+    bool running;
+
+    pthread_mutex_lock(&port->Mutex);
+    running = port->Thread_Running;
+    port->Thread_Running = false;
+    pthread_mutex_unlock(&port->Mutex);
+    if (!running) {
+        return;
+    }
+    pthread_join(port->Thread, NULL);
+    pthread_cond_destroy(&port->Receive_Flag);
+    pthread_mutex_destroy(&port->Mutex);
+    if (port->Receive_Event != -1) {
+        close(port->Receive_Event);
+        port->Receive_Event = -1;
+    }
+    RS485_Port_Close(&port->RS485);
+}
+
 void dlmstp_cleanup(void)
 {
-    pthread_mutex_lock(&Thread_Mutex);
-    run_thread = false;
-    pthread_mutex_unlock(&Thread_Mutex);
-    pthread_join(hThread, NULL);
-    pthread_cond_destroy(&Received_Frame_Flag);
-    pthread_cond_destroy(&Receive_Packet_Flag);
-    pthread_cond_destroy(&Master_Done_Flag);
-    pthread_mutex_destroy(&Received_Frame_Mutex);
-    pthread_mutex_destroy(&Receive_Packet_Mutex);
-    pthread_mutex_destroy(&Master_Done_Mutex);
-    pthread_mutex_destroy(&Ring_Buffer_Mutex);
+    dlmstp_port_cleanup(&MSTP_Default_Port);
 }
 
-/* returns number of bytes sent on success, zero on failure */
-int dlmstp_send_pdu(
-    BACNET_ADDRESS *dest, /* destination address */
-    BACNET_NPDU_DATA *npdu_data, /* network information */
-    uint8_t *pdu, /* any data to be sent - may be null */
+/**
+ * @brief Get a file descriptor that is readable while a received packet
+ *  of a port is ready for dlmstp_port_receive(). The serial port is
+ *  serviced by the thread of the port, so an event loop waits on this
+ *  instead.
+ * @param port - MS/TP port
+ * @return the file descriptor, or -1 if uninitialized.
+ */
+int dlmstp_port_receive_fd(const struct dlmstp_port *port)
+{
+    if (!port->Thread_Running) {
+        return -1;
+    }
+
+    return port->Receive_Event;
+}
+
+/**
+ * @brief Get a file descriptor that is readable while a received packet
+ *  is ready for dlmstp_receive(). The serial port is serviced by the
+ *  MS/TP thread, so an event loop waits on this instead.
+ * @return the file descriptor, or -1 if uninitialized.
+ */
+int dlmstp_get_receive_fd(void)
+{
+    return dlmstp_port_receive_fd(&MSTP_Default_Port);
+}
+
+/**
+ * @brief Signal or clear the received packet event of a port
+ * @param port - MS/TP port
+ * @param ready - true if a received packet is ready
+ */
+static void dlmstp_receive_event(struct dlmstp_port *port, bool ready)
+{
+    uint64_t count = 1;
+    ssize_t rv = 0;
+
+    if (port->Receive_Event == -1) {
+        return;
+    }
+    if (ready) {
+        rv = write(port->Receive_Event, &count, sizeof(count));
+    } else {
+        rv = read(port->Receive_Event, &count, sizeof(count));
+    }
+    (void)rv;
+}
+
+/**
+ * @brief Queue a PDU to be sent by a port when it has the token
+ * @param port - MS/TP port
+ * @param dest - destination address
+ * @param npdu_data - network information
+ * @param pdu - any data to be sent - may be null
+ * @param pdu_len - number of bytes of data
+ * @return number of bytes sent on success, zero on failure
+ */
+int dlmstp_port_send_pdu(
+    struct dlmstp_port *port,
+    const BACNET_ADDRESS *dest,
+    const BACNET_NPDU_DATA *npdu_data,
+    const uint8_t *pdu,
     unsigned pdu_len)
-{ /* number of bytes of data */
+{
     int bytes_sent = 0;
-    struct mstp_pdu_packet *pkt;
-    unsigned i = 0;
-    pthread_mutex_lock(&Ring_Buffer_Mutex);
-    pkt = (struct mstp_pdu_packet *)Ringbuf_Data_Peek(&PDU_Queue);
+    struct dlmstp_pdu_packet *pkt;
+
+    if (pdu_len > sizeof(pkt->buffer)) {
+        return 0;
+    }
+    pthread_mutex_lock(&port->Mutex);
+    pkt = (struct dlmstp_pdu_packet *)Ringbuf_Data_Peek(&port->PDU_Queue);
     if (pkt) {
         pkt->data_expecting_reply = npdu_data->data_expecting_reply;
-        for (i = 0; i < pdu_len; i++) {
-            pkt->buffer[i] = pdu[i];
+        if (pdu_len) {
+            memcpy(pkt->buffer, pdu, pdu_len);
         }
         pkt->length = pdu_len;
         if (dest && dest->mac_len) {
@@ -202,70 +262,130 @@ int dlmstp_send_pdu(
             /* mac_len = 0 is a broadcast address */
             pkt->destination_mac = MSTP_BROADCAST_ADDRESS;
         }
-        if (Ringbuf_Data_Put(&PDU_Queue, (uint8_t *)pkt)) {
+        if (Ringbuf_Data_Put(&port->PDU_Queue, (uint8_t *)pkt)) {
             bytes_sent = pdu_len;
         }
     }
-    pthread_mutex_unlock(&Ring_Buffer_Mutex);
+    pthread_mutex_unlock(&port->Mutex);
 
     return bytes_sent;
 }
 
-uint16_t dlmstp_receive(
-    BACNET_ADDRESS *src, /* source address */
-    uint8_t *pdu, /* PDU data */
-    uint16_t max_pdu, /* amount of space available in the PDU  */
+/* returns number of bytes sent on success, zero on failure */
+int dlmstp_send_pdu(
+    BACNET_ADDRESS *dest, /* destination address */
+    BACNET_NPDU_DATA *npdu_data, /* network information */
+    uint8_t *pdu, /* any data to be sent - may be null */
+    unsigned pdu_len)
+{ /* number of bytes of data */
+    return dlmstp_port_send_pdu(
+        &MSTP_Default_Port, dest, npdu_data, pdu, pdu_len);
+}
+
+/**
+ * @brief Get a packet received by a port
+ * @param port - MS/TP port
+ * @param src - source address of the packet
+ * @param pdu - where the PDU of the packet is copied
+ * @param max_pdu - number of bytes that fit in the pdu
+ * @param timeout - milliseconds to wait for a packet
+ * @return number of bytes in the PDU, or zero if none was received
+ */
+uint16_t dlmstp_port_receive(
+    struct dlmstp_port *port,
+    BACNET_ADDRESS *src,
+    uint8_t *pdu,
+    uint16_t max_pdu,
     unsigned timeout)
-{ /* milliseconds to wait for a packet */
+{
     uint16_t pdu_len = 0;
     struct timespec abstime;
+    DLMSTP_PACKET *pkt;
 
-    (void)max_pdu;
-    /* see if there is a packet available, and a place
-       to put the reply (if necessary) and process it */
-    pthread_mutex_lock(&Receive_Packet_Mutex);
-    get_abstime(&abstime, timeout);
-    pthread_cond_timedwait(
-        &Receive_Packet_Flag, &Receive_Packet_Mutex, &abstime);
-    if (Receive_Packet.ready) {
-        if (Receive_Packet.pdu_len) {
+    pthread_mutex_lock(&port->Mutex);
+    if (Ringbuf_Empty(&port->Receive_Queue) && timeout) {
+        get_abstime(&abstime, timeout);
+        pthread_cond_timedwait(&port->Receive_Flag, &port->Mutex, &abstime);
+    }
+    pkt = (DLMSTP_PACKET *)Ringbuf_Peek(&port->Receive_Queue);
+    if (pkt) {
+        if (pkt->pdu_len && (!pdu || (pkt->pdu_len <= max_pdu))) {
+            port->Packets++;
             MSTP_Packets++;
             if (src) {
-                memmove(
-                    src, &Receive_Packet.address,
-                    sizeof(Receive_Packet.address));
+                memmove(src, &pkt->address, sizeof(pkt->address));
             }
             if (pdu) {
-                memmove(pdu, &Receive_Packet.pdu, sizeof(Receive_Packet.pdu));
+                memmove(pdu, pkt->pdu, pkt->pdu_len);
             }
-            pdu_len = Receive_Packet.pdu_len;
+            pdu_len = pkt->pdu_len;
+        }
+        (void)Ringbuf_Pop(&port->Receive_Queue, NULL);
+        if (Ringbuf_Empty(&port->Receive_Queue)) {
+            dlmstp_receive_event(port, false);
         }
-        Receive_Packet.ready = false;
     }
-    pthread_mutex_unlock(&Receive_Packet_Mutex);
+    pthread_mutex_unlock(&port->Mutex);
 
     return pdu_len;
 }
 
+uint16_t dlmstp_receive(
+    BACNET_ADDRESS *src, /* source address */
+    uint8_t *pdu, /* PDU data */
+    uint16_t max_pdu, /* amount of space available in the PDU  */
+    unsigned timeout)
+{ /* milliseconds to wait for a packet */
+    return dlmstp_port_receive(&MSTP_Default_Port, src, pdu, max_pdu, timeout);
+}
+
+/**
+ * @brief Check if the thread of a port is to keep running
+ * @param port - MS/TP port
+ * @return true if the thread is to keep running
+ */
+static bool dlmstp_port_running(struct dlmstp_port *port)
+{
+    bool running;
+
+    pthread_mutex_lock(&port->Mutex);
+    running = port->Thread_Running;
+    pthread_mutex_unlock(&port->Mutex);
+
+    return running;
+}
+
 static void *dlmstp_master_fsm_task(void *pArg)
 {
+    struct dlmstp_port *port = pArg;
+    struct mstp_port_struct_t *mstp_port = &port->MSTP_Port;
     uint32_t silence = 0;
     bool run_master = false;
     bool thread_alive = true;
     bool run_loop;
 
-    (void)pArg;
     while (thread_alive) {
-        if (MSTP_Port.ReceivedValidFrame == false &&
-            MSTP_Port.ReceivedInvalidFrame == false) {
-            RS485_Check_UART_Data(&MSTP_Port);
-            MSTP_Receive_Frame_FSM(&MSTP_Port);
+        if (mstp_port->ReceivedValidFrame == false &&
+            mstp_port->ReceivedInvalidFrame == false) {
+            if (port->Rx_Span_Offset >= port->Rx_Span_Length) {
+                port->Rx_Span_Offset = 0;
+                port->Rx_Span_Length = RS485_Port_Receive_Span(
+                    &port->RS485, port->Rx_Span, sizeof(port->Rx_Span));
+            }
+            if (port->Rx_Span_Offset < port->Rx_Span_Length) {
+                port->Rx_Span_Offset += MSTP_Receive_Frame_Span(
+                    mstp_port, &port->Rx_Span[port->Rx_Span_Offset],
+                    port->Rx_Span_Length - port->Rx_Span_Offset);
+            } else {
+                /* nothing received - check the timeouts */
+                MSTP_Receive_Frame_FSM(mstp_port);
+            }
         }
-        if (MSTP_Port.ReceivedValidFrame || MSTP_Port.ReceivedInvalidFrame) {
+        if (mstp_port->ReceivedValidFrame || mstp_port->ReceivedInvalidFrame) {
             run_master = true;
         } else {
-            silence = MSTP_Port.SilenceTimer(&MSTP_Port);
-            switch (MSTP_Port.master_state) {
+            silence = mstp_port->SilenceTimer(mstp_port);
+            switch (mstp_port->master_state) {
                 case MSTP_MASTER_STATE_IDLE:
                     if (silence >= Tno_token) {
                         run_master = true;
@@ -287,24 +407,20 @@ static void *dlmstp_master_fsm_task(void *pArg)
             }
         }
         if (run_master) {
-            if (MSTP_Port.This_Station <= 127) {
+            if (mstp_port->This_Station <= 127) {
                 run_loop = true;
                 while (run_loop) {
                     /* do nothing while immediate transitioning */
-                    run_loop = MSTP_Master_Node_FSM(&MSTP_Port);
-                    pthread_mutex_lock(&Thread_Mutex);
-                    if (!run_thread) {
+                    run_loop = MSTP_Master_Node_FSM(mstp_port);
+                    if (!dlmstp_port_running(port)) {
                         run_loop = false;
                     }
-                    pthread_mutex_unlock(&Thread_Mutex);
                 }
-            } else if (MSTP_Port.This_Station < 255) {
-                MSTP_Slave_Node_FSM(&MSTP_Port);
+            } else if (mstp_port->This_Station < 255) {
+                MSTP_Slave_Node_FSM(mstp_port);
             }
         }
-        pthread_mutex_lock(&Thread_Mutex);
-        thread_alive = run_thread;
-        pthread_mutex_unlock(&Thread_Mutex);
+        thread_alive = dlmstp_port_running(port);
     }
 
     return NULL;
@@ -336,30 +452,33 @@ void dlmstp_fill_bacnet_address(BACNET_ADDRESS *src, uint8_t mstp_address)
 /* for the MS/TP state machine to use for putting received data */
 uint16_t MSTP_Put_Receive(struct mstp_port_struct_t *mstp_port)
 {
+    struct dlmstp_port *port = dlmstp_port_of(mstp_port);
     uint16_t pdu_len = 0;
+    DLMSTP_PACKET *pkt;
 
-    pthread_mutex_lock(&Receive_Packet_Mutex);
-    if (Receive_Packet.ready) {
+    pthread_mutex_lock(&port->Mutex);
+    pkt = (DLMSTP_PACKET *)Ringbuf_Data_Peek(&port->Receive_Queue);
+    if (!pkt) {
         debug_printf("MS/TP: Dropped! Not Ready.\n");
     } else {
         /* bounds check - maybe this should send an abort? */
         pdu_len = mstp_port->DataLength;
-        if (pdu_len > sizeof(Receive_Packet.pdu)) {
-            pdu_len = sizeof(Receive_Packet.pdu);
+        if (pdu_len > sizeof(pkt->pdu)) {
+            pdu_len = sizeof(pkt->pdu);
         }
         if (pdu_len == 0) {
             debug_printf("MS/TP: PDU Length is 0!\n");
         }
         memmove(
-            (void *)&Receive_Packet.pdu[0], (void *)&mstp_port->InputBuffer[0],
-            pdu_len);
-        dlmstp_fill_bacnet_address(
-            &Receive_Packet.address, mstp_port->SourceAddress);
-        Receive_Packet.pdu_len = mstp_port->DataLength;
-        Receive_Packet.ready = true;
-        pthread_cond_signal(&Receive_Packet_Flag);
+            (void *)&pkt->pdu[0], (void *)&mstp_port->InputBuffer[0], pdu_len);
+        dlmstp_fill_bacnet_address(&pkt->address, mstp_port->SourceAddress);
+        pkt->pdu_len = pdu_len;
+        pkt->ready = true;
+        (void)Ringbuf_Data_Put(&port->Receive_Queue, (uint8_t *)pkt);
+        pthread_cond_signal(&port->Receive_Flag);
+        dlmstp_receive_event(port, true);
     }
-    pthread_mutex_unlock(&Receive_Packet_Mutex);
+    pthread_mutex_unlock(&port->Mutex);
 
     return pdu_len;
 }
@@ -368,17 +487,18 @@ uint16_t MSTP_Put_Receive(struct mstp_port_struct_t *mstp_port)
 /* Return: amount of PDU data */
 uint16_t MSTP_Get_Send(struct mstp_port_struct_t *mstp_port, unsigned timeout)
 { /* milliseconds to wait for a packet */
+    struct dlmstp_port *port = dlmstp_port_of(mstp_port);
     uint16_t pdu_len = 0;
     uint8_t frame_type = 0;
-    struct mstp_pdu_packet *pkt;
+    struct dlmstp_pdu_packet *pkt;
 
     (void)timeout;
-    pthread_mutex_lock(&Ring_Buffer_Mutex);
-    if (Ringbuf_Empty(&PDU_Queue)) {
-        pthread_mutex_unlock(&Ring_Buffer_Mutex);
+    pthread_mutex_lock(&port->Mutex);
+    if (Ringbuf_Empty(&port->PDU_Queue)) {
+        pthread_mutex_unlock(&port->Mutex);
         return 0;
     }
-    pkt = (struct mstp_pdu_packet *)Ringbuf_Peek(&PDU_Queue);
+    pkt = (struct dlmstp_pdu_packet *)Ringbuf_Peek(&port->PDU_Queue);
     if (pkt->data_expecting_reply) {
         frame_type = FRAME_TYPE_BACNET_DATA_EXPECTING_REPLY;
     } else {
@@ -389,8 +509,8 @@ uint16_t MSTP_Get_Send(struct mstp_port_struct_t *mstp_port, unsigned timeout)
         &mstp_port->OutputBuffer[0], /* <-- loading this */
         mstp_port->OutputBufferSize, frame_type, pkt->destination_mac,
         mstp_port->This_Station, (uint8_t *)&pkt->buffer[0], pkt->length);
-    (void)Ringbuf_Pop(&PDU_Queue, NULL);
-    pthread_mutex_unlock(&Ring_Buffer_Mutex);
+    (void)Ringbuf_Pop(&port->PDU_Queue, NULL);
+    pthread_mutex_unlock(&port->Mutex);
 
     return pdu_len;
 }
@@ -406,7 +526,11 @@ void MSTP_Send_Frame(
     const uint8_t *buffer,
     uint16_t nbytes)
 {
-    RS485_Send_Frame(mstp_port, buffer, nbytes);
+    struct dlmstp_port *port = dlmstp_port_of(mstp_port);
+
+    RS485_Port_Send_Frame(&port->RS485, buffer, nbytes);
+    /* per MSTP spec, sort of */
+    mstp_port->SilenceTimerReset((void *)mstp_port);
 }
 
 static bool dlmstp_compare_data_expecting_reply(
@@ -544,55 +668,87 @@ static bool dlmstp_compare_data_expecting_reply(
 /* Get the reply to a DATA_EXPECTING_REPLY frame, or nothing */
 uint16_t MSTP_Get_Reply(struct mstp_port_struct_t *mstp_port, unsigned timeout)
 { /* milliseconds to wait for a packet */
+    struct dlmstp_port *port = dlmstp_port_of(mstp_port);
     uint16_t pdu_len = 0; /* return value */
     bool matched = false;
     uint8_t frame_type = 0;
-    struct mstp_pdu_packet *pkt;
+    struct dlmstp_pdu_packet *pkt;
 
     (void)timeout;
-    if (Ringbuf_Empty(&PDU_Queue)) {
-        return 0;
-    }
-    pkt = (struct mstp_pdu_packet *)Ringbuf_Peek(&PDU_Queue);
-    /* is this the reply to the DER? */
-    matched = dlmstp_compare_data_expecting_reply(
-        &mstp_port->InputBuffer[0], mstp_port->DataLength,
-        mstp_port->SourceAddress, (uint8_t *)&pkt->buffer[0], pkt->length,
-        pkt->destination_mac);
-    if (!matched) {
-        return 0;
+    pthread_mutex_lock(&port->Mutex);
+    pkt = (struct dlmstp_pdu_packet *)Ringbuf_Peek(&port->PDU_Queue);
+    if (pkt) {
+        /* is this the reply to the DER? */
+        matched = dlmstp_compare_data_expecting_reply(
+            &mstp_port->InputBuffer[0], mstp_port->DataLength,
+            mstp_port->SourceAddress, (uint8_t *)&pkt->buffer[0],
+            pkt->length, pkt->destination_mac);
     }
-    if (pkt->data_expecting_reply) {
-        frame_type = FRAME_TYPE_BACNET_DATA_EXPECTING_REPLY;
-    } else {
-        frame_type = FRAME_TYPE_BACNET_DATA_NOT_EXPECTING_REPLY;
+    if (matched) {
+        if (pkt->data_expecting_reply) {
+            frame_type = FRAME_TYPE_BACNET_DATA_EXPECTING_REPLY;
+        } else {
+            frame_type = FRAME_TYPE_BACNET_DATA_NOT_EXPECTING_REPLY;
+        }
+        /* convert the PDU into the MSTP Frame */
+        pdu_len = MSTP_Create_Frame(
+            &mstp_port->OutputBuffer[0], /* <-- loading this */
+            mstp_port->OutputBufferSize, frame_type, pkt->destination_mac,
+            mstp_port->This_Station, (uint8_t *)&pkt->buffer[0], pkt->length);
+        (void)Ringbuf_Pop(&port->PDU_Queue, NULL);
     }
-    /* convert the PDU into the MSTP Frame */
-    pdu_len = MSTP_Create_Frame(
-        &mstp_port->OutputBuffer[0], /* <-- loading this */
-        mstp_port->OutputBufferSize, frame_type, pkt->destination_mac,
-        mstp_port->This_Station, (uint8_t *)&pkt->buffer[0], pkt->length);
-    (void)Ringbuf_Pop(&PDU_Queue, NULL);
+    pthread_mutex_unlock(&port->Mutex);
 
     return pdu_len;
 }
 
-void dlmstp_set_mac_address(uint8_t mac_address)
+/**
+ * @brief Set the MAC address of a port
+ * @param port - MS/TP port
+ * @param mac_address - MAC address 0..127
+ */
+void dlmstp_port_set_mac_address(struct dlmstp_port *port, uint8_t mac_address)
 {
     /* Master Nodes can only have address 0-127 */
     if (mac_address <= 127) {
-        MSTP_Port.This_Station = mac_address;
-        if (mac_address > MSTP_Port.Nmax_master) {
-            dlmstp_set_max_master(mac_address);
+        port->MSTP_Port.This_Station = mac_address;
+        if (mac_address > port->MSTP_Port.Nmax_master) {
+            dlmstp_port_set_max_master(port, mac_address);
         }
     }
+}
 
-    return;
+void dlmstp_set_mac_address(uint8_t mac_address)
+{
+    dlmstp_port_set_mac_address(&MSTP_Default_Port, mac_address);
+}
+
+/**
+ * @brief Get the MAC address of a port
+ * @param port - MS/TP port
+ * @return MAC address
+ */
+uint8_t dlmstp_port_mac_address(const struct dlmstp_port *port)
+{
+    return port->MSTP_Port.This_Station;
 }
 
 uint8_t dlmstp_mac_address(void)
 {
-    return MSTP_Port.This_Station;
+    return dlmstp_port_mac_address(&MSTP_Default_Port);
+}
+
+/**
+ * @brief Set the Max_Info_Frames of a port
+ * @param port - MS/TP port
+ * @param max_info_frames - number of frames sent before passing the token
+ */
+void dlmstp_port_set_max_info_frames(
+    struct dlmstp_port *port, uint8_t max_info_frames)
+{
+    if (max_info_frames >= 1) {
+        port->MSTP_Port.Nmax_info_frames = max_info_frames;
+    }
 }
 
 /* This parameter represents the value of the Max_Info_Frames property of */
@@ -604,16 +760,36 @@ uint8_t dlmstp_mac_address(void)
 /* node, its value shall be 1. */
 void dlmstp_set_max_info_frames(uint8_t max_info_frames)
 {
-    if (max_info_frames >= 1) {
-        MSTP_Port.Nmax_info_frames = max_info_frames;
-    }
+    dlmstp_port_set_max_info_frames(&MSTP_Default_Port, max_info_frames);
+}
 
-    return;
+/**
+ * @brief Get the Max_Info_Frames of a port
+ * @param port - MS/TP port
+ * @return number of frames sent before passing the token
+ */
+uint8_t dlmstp_port_max_info_frames(const struct dlmstp_port *port)
+{
+    return port->MSTP_Port.Nmax_info_frames;
 }
 
 uint8_t dlmstp_max_info_frames(void)
 {
-    return MSTP_Port.Nmax_info_frames;
+    return dlmstp_port_max_info_frames(&MSTP_Default_Port);
+}
+
+/**
+ * @brief Set the Max_Master of a port
+ * @param port - MS/TP port
+ * @param max_master - highest master MAC address, up to 127
+ */
+void dlmstp_port_set_max_master(struct dlmstp_port *port, uint8_t max_master)
+{
+    if (max_master <= 127) {
+        if (port->MSTP_Port.This_Station <= max_master) {
+            port->MSTP_Port.Nmax_master = max_master;
+        }
+    }
 }
 
 /* This parameter represents the value of the Max_Master property of the */
@@ -623,44 +799,87 @@ uint8_t dlmstp_max_info_frames(void)
 /* its value shall be 127. */
 void dlmstp_set_max_master(uint8_t max_master)
 {
-    if (max_master <= 127) {
-        if (MSTP_Port.This_Station <= max_master) {
-            MSTP_Port.Nmax_master = max_master;
-        }
-    }
+    dlmstp_port_set_max_master(&MSTP_Default_Port, max_master);
+}
 
-    return;
+/**
+ * @brief Get the Max_Master of a port
+ * @param port - MS/TP port
+ * @return highest master MAC address
+ */
+uint8_t dlmstp_port_max_master(const struct dlmstp_port *port)
+{
+    return port->MSTP_Port.Nmax_master;
 }
 
 uint8_t dlmstp_max_master(void)
 {
-    return MSTP_Port.Nmax_master;
+    return dlmstp_port_max_master(&MSTP_Default_Port);
+}
+
+/**
+ * @brief Set the baud rate of a port, used when the port is initialized
+ * @param port - MS/TP port
+ * @param baud - RS485 Baud Rate 9600, 19200, 38400, 57600, 76800, 115200
+ * @return true if the baud rate is valid
+ */
+bool dlmstp_port_set_baud_rate(struct dlmstp_port *port, uint32_t baud)
+{
+    if (!RS485_Port_Baud_Rate_Valid(baud)) {
+        return false;
+    }
+    port->RS485.baud = baud;
+
+    return true;
 }
 
 /* RS485 Baud Rate 9600, 19200, 38400, 57600, 115200 */
 void dlmstp_set_baud_rate(uint32_t baud)
 {
-    RS485_Set_Baud_Rate(baud);
+    (void)dlmstp_port_set_baud_rate(&MSTP_Default_Port, baud);
+}
+
+/**
+ * @brief Get the baud rate of a port
+ * @param port - MS/TP port
+ * @return baud rate in bits per second
+ */
+uint32_t dlmstp_port_baud_rate(const struct dlmstp_port *port)
+{
+    if (port->RS485.baud == 0) {
+        return 38400;
+    }
+
+    return port->RS485.baud;
 }
 
 uint32_t dlmstp_baud_rate(void)
 {
-    return RS485_Get_Baud_Rate();
+    return dlmstp_port_baud_rate(&MSTP_Default_Port);
 }
 
-void dlmstp_get_my_address(BACNET_ADDRESS *my_address)
+/**
+ * @brief Get the address of a port on its MS/TP network
+ * @param port - MS/TP port
+ * @param my_address - where the address is stored
+ */
+void dlmstp_port_get_my_address(
+    const struct dlmstp_port *port, BACNET_ADDRESS *my_address)
 {
     int i = 0; /* counter */
 
     my_address->mac_len = 1;
-    my_address->mac[0] = MSTP_Port.This_Station;
+    my_address->mac[0] = port->MSTP_Port.This_Station;
     my_address->net = 0; /* local only, no routing */
     my_address->len = 0;
     for (i = 0; i < MAX_MAC_LEN; i++) {
         my_address->adr[i] = 0;
     }
+}
 
-    return;
+void dlmstp_get_my_address(BACNET_ADDRESS *my_address)
+{
+    dlmstp_port_get_my_address(&MSTP_Default_Port, my_address);
 }
 
 void dlmstp_get_broadcast_address(BACNET_ADDRESS *dest)
@@ -680,73 +899,114 @@ void dlmstp_get_broadcast_address(BACNET_ADDRESS *dest)
     return;
 }
 
-bool dlmstp_init(char *ifname)
+/**
+ * @brief Release the resources of a port that could not be started
+ * @param port - MS/TP port
+ */
+static void dlmstp_port_init_failed(struct dlmstp_port *port)
+{
+    pthread_cond_destroy(&port->Receive_Flag);
+    pthread_mutex_destroy(&port->Mutex);
+    if (port->Receive_Event != -1) {
+        close(port->Receive_Event);
+        port->Receive_Event = -1;
+    }
+}
+
+/**
+ * @brief Open the serial port of a port, and start the thread that runs
+ *  its MS/TP state machines
+ * @param port - zero initialized MS/TP port, configured with the
+ *  dlmstp_port_set functions
+ * @param ifname - serial port name, i.e. /dev/ttyUSB0, or NULL for the
+ *  default. Expects a constant char, or char from the heap.
+ * @return true if the port was started
+ */
+bool dlmstp_port_init(struct dlmstp_port *port, const char *ifname)
 {
     pthread_condattr_t attr;
     int rv = 0;
 
+    if (ifname) {
+        port->RS485.name = ifname;
+    }
     pthread_condattr_init(&attr);
     if ((rv = pthread_condattr_setclock(&attr, CLOCK_MONOTONIC)) != 0) {
         fprintf(
             stderr, "MS/TP Interface: %s\n failed to set MONOTONIC clock\n",
             ifname);
-        exit(1);
+        return false;
     }
-
-    pthread_mutex_init(&Ring_Buffer_Mutex, NULL);
-    pthread_mutex_init(&Thread_Mutex, NULL);
-
-    /* initialize PDU queue */
-    Ringbuf_Init(
-        &PDU_Queue, (uint8_t *)&PDU_Buffer, sizeof(struct mstp_pdu_packet),
-        MSTP_PDU_PACKET_COUNT);
-    /* initialize packet queue */
-    Receive_Packet.ready = false;
-    Receive_Packet.pdu_len = 0;
-    rv = pthread_cond_init(&Receive_Packet_Flag, &attr);
+    rv = pthread_cond_init(&port->Receive_Flag, &attr);
+    pthread_condattr_destroy(&attr);
     if (rv != 0) {
         fprintf(
             stderr,
             "MS/TP Interface: %s\n cannot allocate PThread Condition.\n",
             ifname);
-        exit(1);
+        return false;
     }
-    rv = pthread_mutex_init(&Receive_Packet_Mutex, NULL);
+    rv = pthread_mutex_init(&port->Mutex, NULL);
     if (rv != 0) {
         fprintf(
             stderr, "MS/TP Interface: %s\n cannot allocate PThread Mutex.\n",
             ifname);
-        exit(1);
+        pthread_cond_destroy(&port->Receive_Flag);
+        return false;
     }
+    /* initialize PDU queue */
+    Ringbuf_Init(
+        &port->PDU_Queue, (uint8_t *)&port->PDU_Buffer,
+        sizeof(struct dlmstp_pdu_packet), MSTP_PDU_PACKET_COUNT);
+    /* initialize packet queue */
+    Ringbuf_Init(
+        &port->Receive_Queue, (uint8_t *)&port->Receive_Buffer,
+        sizeof(DLMSTP_PACKET), DLMSTP_RECEIVE_PACKET_COUNT);
+    port->Receive_Event = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    port->Rx_Span_Length = 0;
+    port->Rx_Span_Offset = 0;
     /* initialize hardware */
     if (ifname) {
-        RS485_Set_Interface(ifname);
         debug_fprintf(stderr, "MS/TP Interface: %s\n", ifname);
     }
-    RS485_Initialize();
-    MSTP_Port.InputBuffer = &RxBuffer[0];
-    MSTP_Port.InputBufferSize = sizeof(RxBuffer);
-    MSTP_Port.OutputBuffer = &TxBuffer[0];
-    MSTP_Port.OutputBufferSize = sizeof(TxBuffer);
-    clock_gettime(CLOCK_MONOTONIC, &start);
-    MSTP_Port.SilenceTimer = Timer_Silence;
-    MSTP_Port.SilenceTimerReset = Timer_Silence_Reset;
-    MSTP_Init(&MSTP_Port);
-    debug_fprintf(stderr, "MS/TP MAC: %02X\n", MSTP_Port.This_Station);
-    debug_fprintf(stderr, "MS/TP Max_Master: %02X\n", MSTP_Port.Nmax_master);
+    if (!RS485_Port_Open(&port->RS485)) {
+        dlmstp_port_init_failed(port);
+        return false;
+    }
+    port->MSTP_Port.InputBuffer = &port->RxBuffer[0];
+    port->MSTP_Port.InputBufferSize = sizeof(port->RxBuffer);
+    port->MSTP_Port.OutputBuffer = &port->TxBuffer[0];
+    port->MSTP_Port.OutputBufferSize = sizeof(port->TxBuffer);
+    clock_gettime(CLOCK_MONOTONIC, &port->Silence_Start);
+    port->MSTP_Port.SilenceTimer = Timer_Silence;
+    port->MSTP_Port.SilenceTimerReset = Timer_Silence_Reset;
+    MSTP_Init(&port->MSTP_Port);
+    debug_fprintf(stderr, "MS/TP MAC: %02X\n", port->MSTP_Port.This_Station);
     debug_fprintf(
-        stderr, "MS/TP Max_Info_Frames: %u\n", MSTP_Port.Nmax_info_frames);
+        stderr, "MS/TP Max_Master: %02X\n", port->MSTP_Port.Nmax_master);
+    debug_fprintf(
+        stderr, "MS/TP Max_Info_Frames: %u\n",
+        port->MSTP_Port.Nmax_info_frames);
     fflush(stderr);
-    /* start one thread */
-    run_thread = true;
-    rv = pthread_create(&hThread, NULL, dlmstp_master_fsm_task, NULL);
+    /* start one thread for this port */
+    port->Thread_Running = true;
+    rv = pthread_create(&port->Thread, NULL, dlmstp_master_fsm_task, port);
     if (rv != 0) {
         fprintf(stderr, "Failed to start Master Node FSM task\n");
+        port->Thread_Running = false;
+        RS485_Port_Close(&port->RS485);
+        dlmstp_port_init_failed(port);
+        return false;
     }
 
     return true;
 }
 
+bool dlmstp_init(char *ifname)
+{
+    return dlmstp_port_init(&MSTP_Default_Port, ifname);
+}
+
 #ifdef TEST_DLMSTP
 #include <stdio.h>
 
@@ -779,8 +1039,9 @@ int main(int argc, char *argv[])
     for (;;) {
         pdu_len = dlmstp_receive(NULL, NULL, 0, UINT_MAX);
         MSTP_Create_And_Send_Frame(
-            &MSTP_Port, FRAME_TYPE_TEST_REQUEST, MSTP_Port.SourceAddress,
-            MSTP_Port.This_Station, NULL, 0);
+            &MSTP_Default_Port.MSTP_Port, FRAME_TYPE_TEST_REQUEST,
+            MSTP_Default_Port.MSTP_Port.SourceAddress,
+            MSTP_Default_Port.MSTP_Port.This_Station, NULL, 0);
     }
 
     return 0;
@@ -0,0 +1,137 @@
+/**
+ * @file
+ * @brief BACnet MS/TP datalink for Linux with the state of each port
+ *  in its own structure, so that one process can run more than one
+ *  MS/TP network.
+ * @author agent <agent@local>
+ * @date October 2026
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * Each port has its own serial port, state machines, queues and thread.
+ * The queues of a port are guarded by the mutex of that port only, so
+ * the ports do not wait on each other. The dlmstp_ API in dlmstp.h uses
+ * a port of its own.
+ */
+#ifndef DLMSTP_PORT_H
+#define DLMSTP_PORT_H
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+/* BACnet Stack API */
+#include "bacnet/npdu.h"
+#include "bacnet/datalink/mstp.h"
+#include "bacnet/datalink/dlmstp.h"
+#include "bacnet/basic/sys/ringbuf.h"
+/* port specific */
+#include "rs485.h"
+
+/* count must be a power of 2 for ringbuf library */
+#ifndef MSTP_PDU_PACKET_COUNT
+#define MSTP_PDU_PACKET_COUNT 8
+#endif
+/* count must be a power of 2 for ringbuf library */
+#ifndef DLMSTP_RECEIVE_PACKET_COUNT
+#define DLMSTP_RECEIVE_PACKET_COUNT 4
+#endif
+/* octets taken from the UART with one read() */
+#ifndef DLMSTP_RECEIVE_SPAN_MAX
+#define DLMSTP_RECEIVE_SPAN_MAX 512
+#endif
+
+/* data structure for MS/TP PDU Queue */
+struct dlmstp_pdu_packet {
+    bool data_expecting_reply;
+    uint8_t destination_mac;
+    uint16_t length;
+    uint8_t buffer[DLMSTP_MPDU_MAX];
+};
+
+/* A port is zero initialized, then configured with the dlmstp_port_set
+   functions, and then started with dlmstp_port_init() */
+struct dlmstp_port {
+    /* MS/TP state machine data of this port */
+    struct mstp_port_struct_t MSTP_Port;
+    /* serial port of this port */
+    struct rs485_port RS485;
+    /* buffers needed by mstp port struct */
+    uint8_t TxBuffer[DLMSTP_MPDU_MAX];
+    uint8_t RxBuffer[DLMSTP_MPDU_MAX];
+    /* octets of one read() of the UART, given to the receive FSM */
+    uint8_t Rx_Span[DLMSTP_RECEIVE_SPAN_MAX];
+    unsigned Rx_Span_Length;
+    unsigned Rx_Span_Offset;
+    /* PDUs waiting for the token */
+    struct dlmstp_pdu_packet PDU_Buffer[MSTP_PDU_PACKET_COUNT];
+    RING_BUFFER PDU_Queue;
+    /* PDUs received, waiting for dlmstp_port_receive() */
+    DLMSTP_PACKET Receive_Buffer[DLMSTP_RECEIVE_PACKET_COUNT];
+    RING_BUFFER Receive_Queue;
+    /* guards the queues and the thread flag of this port */
+    pthread_mutex_t Mutex;
+    /* signaled when a packet is put in the receive queue */
+    pthread_cond_t Receive_Flag;
+    /* readable while a received packet is ready, for an event loop */
+    int Receive_Event;
+    /* Timer that indicates line silence */
+    struct timespec Silence_Start;
+    /* thread running the state machines of this port */
+    pthread_t Thread;
+    bool Thread_Running;
+    /* Number of MS/TP Packets Rx */
+    uint32_t Packets;
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+BACNET_STACK_EXPORT
+bool dlmstp_port_init(struct dlmstp_port *port, const char *ifname);
+BACNET_STACK_EXPORT
+void dlmstp_port_cleanup(struct dlmstp_port *port);
+
+BACNET_STACK_EXPORT
+int dlmstp_port_send_pdu(
+    struct dlmstp_port *port,
+    const BACNET_ADDRESS *dest,
+    const BACNET_NPDU_DATA *npdu_data,
+    const uint8_t *pdu,
+    unsigned pdu_len);
+BACNET_STACK_EXPORT
+uint16_t dlmstp_port_receive(
+    struct dlmstp_port *port,
+    BACNET_ADDRESS *src,
+    uint8_t *pdu,
+    uint16_t max_pdu,
+    unsigned timeout);
+BACNET_STACK_EXPORT
+int dlmstp_port_receive_fd(const struct dlmstp_port *port);
+
+BACNET_STACK_EXPORT
+void dlmstp_port_set_mac_address(struct dlmstp_port *port, uint8_t mac_address);
+BACNET_STACK_EXPORT
+uint8_t dlmstp_port_mac_address(const struct dlmstp_port *port);
+BACNET_STACK_EXPORT
+void dlmstp_port_set_max_info_frames(
+    struct dlmstp_port *port, uint8_t max_info_frames);
+BACNET_STACK_EXPORT
+uint8_t dlmstp_port_max_info_frames(const struct dlmstp_port *port);
+BACNET_STACK_EXPORT
+void dlmstp_port_set_max_master(struct dlmstp_port *port, uint8_t max_master);
+BACNET_STACK_EXPORT
+uint8_t dlmstp_port_max_master(const struct dlmstp_port *port);
+BACNET_STACK_EXPORT
+bool dlmstp_port_set_baud_rate(struct dlmstp_port *port, uint32_t baud);
+BACNET_STACK_EXPORT
+uint32_t dlmstp_port_baud_rate(const struct dlmstp_port *port);
+BACNET_STACK_EXPORT
+void dlmstp_port_get_my_address(
+    const struct dlmstp_port *port, BACNET_ADDRESS *my_address);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
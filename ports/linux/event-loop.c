@@ -0,0 +1,349 @@
+/**
+ * @file
+ * @brief An event loop for the Linux port that waits on the datalink
+ *  file descriptors and timer deadlines with epoll and a timerfd.
+ * @author agent <agent@local>
+ * @date October 2026
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+/* BACnet Stack API */
+#include "bacnet/datalink/datalink.h"
+/* port specific */
+#include "event-loop.h"
+
+struct event_loop_fd {
+    int fd;
+    event_loop_fd_callback callback;
+    void *context;
+};
+
+struct event_loop_timer {
+    uint32_t interval;
+    /* CLOCK_MONOTONIC milliseconds of the next expiry */
+    uint64_t deadline;
+    event_loop_timer_callback callback;
+    void *context;
+};
+
+static int Epoll_FD = -1;
+static int Timer_FD = -1;
+static struct event_loop_fd Event_FD[EVENT_LOOP_FD_MAX];
+static struct event_loop_timer Event_Timer[EVENT_LOOP_TIMER_MAX];
+/* the epoll data of the timerfd is past the file descriptor indexes */
+#define EVENT_LOOP_TIMER_FD_INDEX EVENT_LOOP_FD_MAX
+
+/**
+ * @brief Get the monotonic clock, as used by the timerfd
+ * @return the monotonic clock in milliseconds
+ */
+static uint64_t event_loop_now(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((uint64_t)now.tv_sec * 1000ULL) +
+        ((uint64_t)now.tv_nsec / 1000000ULL);
+}
+
+/**
+ * @brief Arm the timerfd for the earliest timer deadline, or disarm it
+ *  if there are no timers.
+ */
+static void event_loop_timer_arm(void)
+{
+    struct itimerspec spec = { 0 };
+    uint64_t deadline = 0;
+    unsigned i;
+
+    for (i = 0; i < EVENT_LOOP_TIMER_MAX; i++) {
+        if (Event_Timer[i].callback &&
+            ((deadline == 0) || (Event_Timer[i].deadline < deadline))) {
+            deadline = Event_Timer[i].deadline;
+        }
+    }
+    if (deadline) {
+        spec.it_value.tv_sec = (time_t)(deadline / 1000ULL);
+        spec.it_value.tv_nsec = (long)((deadline % 1000ULL) * 1000000ULL);
+    }
+    timerfd_settime(Timer_FD, TFD_TIMER_ABSTIME, &spec, NULL);
+}
+
+/**
+ * @brief Call the timers that are due, and re-arm the timerfd
+ * @return number of timers called
+ */
+static int event_loop_timer_task(void)
+{
+    struct event_loop_timer *timer;
+    uint64_t expirations = 0;
+    uint64_t now, periods;
+    ssize_t rv;
+    unsigned i;
+    int count = 0;
+
+    /* clear the readable timerfd */
+    rv = read(Timer_FD, &expirations, sizeof(expirations));
+    (void)rv;
+    now = event_loop_now();
+    for (i = 0; i < EVENT_LOOP_TIMER_MAX; i++) {
+        timer = &Event_Timer[i];
+        if (!timer->callback || (timer->deadline > now)) {
+            continue;
+        }
+        /* whole intervals, so the elapsed time does not drift when the
+           loop is late, and missed intervals are not called again */
+        periods = ((now - timer->deadline) / timer->interval) + 1;
+        timer->deadline += periods * timer->interval;
+        timer->callback((uint32_t)(periods * timer->interval), timer->context);
+        count++;
+    }
+    event_loop_timer_arm();
+
+    return count;
+}
+
+/**
+ * @brief Add a file descriptor to the event loop
+ * @param fd - file descriptor to wait for to be readable
+ * @param callback - function called when the file descriptor is readable
+ * @param context - passed to the callback
+ * @return true if the file descriptor was added
+ */
+bool event_loop_fd_add(int fd, event_loop_fd_callback callback, void *context)
+{
+    struct epoll_event event = { 0 };
+    unsigned i, index = EVENT_LOOP_FD_MAX;
+
+    if ((Epoll_FD < 0) || (fd < 0) || !callback) {
+        return false;
+    }
+    for (i = 0; i < EVENT_LOOP_FD_MAX; i++) {
+        if (Event_FD[i].callback) {
+            if (Event_FD[i].fd == fd) {
+                return false;
+            }
+        } else if (index == EVENT_LOOP_FD_MAX) {
+            index = i;
+        }
+    }
+    if (index == EVENT_LOOP_FD_MAX) {
+        return false;
+    }
+    event.events = EPOLLIN;
+    event.data.u32 = index;
+    if (epoll_ctl(Epoll_FD, EPOLL_CTL_ADD, fd, &event) != 0) {
+        return false;
+    }
+    Event_FD[index].fd = fd;
+    Event_FD[index].callback = callback;
+    Event_FD[index].context = context;
+
+    return true;
+}
+
+/**
+ * @brief Remove a file descriptor from the event loop
+ * @param fd - file descriptor to no longer wait for
+ * @return true if the file descriptor was removed
+ */
+bool event_loop_fd_remove(int fd)
+{
+    unsigned i;
+
+    for (i = 0; i < EVENT_LOOP_FD_MAX; i++) {
+        if (Event_FD[i].callback && (Event_FD[i].fd == fd)) {
+            epoll_ctl(Epoll_FD, EPOLL_CTL_DEL, fd, NULL);
+            Event_FD[i].fd = -1;
+            Event_FD[i].callback = NULL;
+            Event_FD[i].context = NULL;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Add the file descriptors of the initialized datalinks to the
+ *  event loop. The callback is expected to call datalink_receive() with
+ *  a timeout of zero until it returns zero.
+ * @param callback - function called when a datalink is readable
+ * @param context - passed to the callback
+ * @return true if any datalink file descriptor was added, or false if
+ *  the datalink has none and has to be polled.
+ */
+bool event_loop_datalink_add(event_loop_fd_callback callback, void *context)
+{
+    bool status = false;
+
+#if defined(BACDL_BIP)
+    if (event_loop_fd_add(bip_get_socket(), callback, context)) {
+        status = true;
+    }
+    if (bip_get_broadcast_socket() != bip_get_socket()) {
+        if (event_loop_fd_add(bip_get_broadcast_socket(), callback, context)) {
+            status = true;
+        }
+    }
+#endif
+#if defined(BACDL_BIP6)
+    if (event_loop_fd_add(bip6_get_socket(), callback, context)) {
+        status = true;
+    }
+#endif
+#if defined(BACDL_MSTP)
+    if (event_loop_fd_add(dlmstp_get_receive_fd(), callback, context)) {
+        status = true;
+    }
+#endif
+    (void)callback;
+    (void)context;
+
+    return status;
+}
+
+/**
+ * @brief Add a periodic timer to the event loop
+ * @param interval - milliseconds between calls to the callback
+ * @param callback - function called when the timer expires
+ * @param context - passed to the callback
+ * @return the timer, or -1 if the timer was not added
+ */
+int event_loop_timer_add(
+    uint32_t interval, event_loop_timer_callback callback, void *context)
+{
+    unsigned i;
+
+    if ((Timer_FD < 0) || (interval == 0) || !callback) {
+        return -1;
+    }
+    for (i = 0; i < EVENT_LOOP_TIMER_MAX; i++) {
+        if (!Event_Timer[i].callback) {
+            Event_Timer[i].interval = interval;
+            Event_Timer[i].deadline = event_loop_now() + interval;
+            Event_Timer[i].callback = callback;
+            Event_Timer[i].context = context;
+            event_loop_timer_arm();
+            return (int)i;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief Remove a periodic timer from the event loop
+ * @param timer - timer returned from event_loop_timer_add()
+ * @return true if the timer was removed
+ */
+bool event_loop_timer_remove(int timer)
+{
+    if ((timer < 0) || (timer >= EVENT_LOOP_TIMER_MAX) ||
+        !Event_Timer[timer].callback) {
+        return false;
+    }
+    memset(&Event_Timer[timer], 0, sizeof(Event_Timer[timer]));
+    event_loop_timer_arm();
+
+    return true;
+}
+
+/**
+ * @brief Wait for a file descriptor to be readable or a timer to expire,
+ *  and call their callbacks.
+ * @param timeout - milliseconds to wait, or -1 to wait until an event
+ * @return number of callbacks called, or -1 on error
+ */
+int event_loop_run_once(int timeout)
+{
+    struct epoll_event events[EVENT_LOOP_FD_MAX + 1];
+    struct event_loop_fd *entry;
+    unsigned index;
+    int count = 0;
+    int i, n;
+
+    if (Epoll_FD < 0) {
+        return -1;
+    }
+    n = epoll_wait(Epoll_FD, events, EVENT_LOOP_FD_MAX + 1, timeout);
+    if (n < 0) {
+        return (errno == EINTR) ? 0 : -1;
+    }
+    for (i = 0; i < n; i++) {
+        index = events[i].data.u32;
+        if (index == EVENT_LOOP_TIMER_FD_INDEX) {
+            count += event_loop_timer_task();
+        } else if (index < EVENT_LOOP_FD_MAX) {
+            /* an earlier callback may have removed it */
+            entry = &Event_FD[index];
+            if (entry->callback) {
+                entry->callback(entry->fd, entry->context);
+                count++;
+            }
+        }
+    }
+
+    return count;
+}
+
+/**
+ * @brief Close the event loop, and forget its file descriptors and timers
+ */
+void event_loop_cleanup(void)
+{
+    unsigned i;
+
+    if (Timer_FD >= 0) {
+        close(Timer_FD);
+        Timer_FD = -1;
+    }
+    if (Epoll_FD >= 0) {
+        close(Epoll_FD);
+        Epoll_FD = -1;
+    }
+    for (i = 0; i < EVENT_LOOP_FD_MAX; i++) {
+        Event_FD[i].fd = -1;
+        Event_FD[i].callback = NULL;
+        Event_FD[i].context = NULL;
+    }
+    memset(Event_Timer, 0, sizeof(Event_Timer));
+}
+
+/**
+ * @brief Create the epoll instance and the timerfd of the event loop
+ * @return true if the event loop is ready
+ */
+bool event_loop_init(void)
+{
+    struct epoll_event event = { 0 };
+
+    event_loop_cleanup();
+    Epoll_FD = epoll_create1(EPOLL_CLOEXEC);
+    if (Epoll_FD < 0) {
+        return false;
+    }
+    Timer_FD = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (Timer_FD < 0) {
+        event_loop_cleanup();
+        return false;
+    }
+    event.events = EPOLLIN;
+    event.data.u32 = EVENT_LOOP_TIMER_FD_INDEX;
+    if (epoll_ctl(Epoll_FD, EPOLL_CTL_ADD, Timer_FD, &event) != 0) {
+        event_loop_cleanup();
+        return false;
+    }
+
+    return true;
+}
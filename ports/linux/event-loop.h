@@ -0,0 +1,72 @@
+/**
+ * @file
+ * @brief An event loop for the Linux port that waits on the datalink
+ *  file descriptors and timer deadlines with epoll and a timerfd.
+ * @author agent <agent@local>
+ * @date October 2026
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * The loop sleeps until a registered file descriptor is readable or the
+ * earliest timer deadline is reached, and only then calls back into the
+ * application, so an idle device does not wake up to poll its timers.
+ */
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+#include <stdbool.h>
+#include <stdint.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+
+/* number of file descriptors that can be registered */
+#ifndef EVENT_LOOP_FD_MAX
+#define EVENT_LOOP_FD_MAX 8
+#endif
+/* number of periodic timers that can be registered */
+#ifndef EVENT_LOOP_TIMER_MAX
+#define EVENT_LOOP_TIMER_MAX 16
+#endif
+
+/**
+ * @brief Called when a registered file descriptor is readable
+ * @param fd - the readable file descriptor
+ * @param context - context given when the file descriptor was added
+ */
+typedef void (*event_loop_fd_callback)(int fd, void *context);
+
+/**
+ * @brief Called when a periodic timer expires
+ * @param milliseconds - time elapsed since the previous call
+ * @param context - context given when the timer was added
+ */
+typedef void (*event_loop_timer_callback)(
+    uint32_t milliseconds, void *context);
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+BACNET_STACK_EXPORT
+bool event_loop_init(void);
+BACNET_STACK_EXPORT
+void event_loop_cleanup(void);
+
+BACNET_STACK_EXPORT
+bool event_loop_fd_add(int fd, event_loop_fd_callback callback, void *context);
+BACNET_STACK_EXPORT
+bool event_loop_fd_remove(int fd);
+BACNET_STACK_EXPORT
+bool event_loop_datalink_add(event_loop_fd_callback callback, void *context);
+
+BACNET_STACK_EXPORT
+int event_loop_timer_add(
+    uint32_t interval, event_loop_timer_callback callback, void *context);
+BACNET_STACK_EXPORT
+bool event_loop_timer_remove(int timer);
+
+BACNET_STACK_EXPORT
+int event_loop_run_once(int timeout);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
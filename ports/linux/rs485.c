@@ -262,91 +262,144 @@ uint32_t RS485_Get_Port_Baud_Rate(struct mstp_port_struct_t *mstp_port)
     return baud;
 }
 
-/****************************************************************************
- * DESCRIPTION: Sets the baud rate for the chip USART
- * RETURN:      none
- * ALGORITHM:   none
- * NOTES:       none
- *****************************************************************************/
-bool RS485_Set_Baud_Rate(uint32_t baud)
+/**
+ * @brief Convert a baud rate to its termios speed
+ * @param baud - baud rate in bits per second
+ * @param code - termios speed, set if the baud rate is valid
+ * @param special - set true if the speed needs a custom divisor
+ * @return true if the baud rate is valid
+ */
+static bool rs485_baud_code(uint32_t baud, unsigned int *code, bool *special)
 {
     bool valid = true;
 
-    RS485_SpecBaud = false;
+    *special = false;
     switch (baud) {
         case 0:
-            RS485_Baud = B0;
+            *code = B0;
             break;
         case 50:
-            RS485_Baud = B50;
+            *code = B50;
             break;
         case 75:
-            RS485_Baud = B75;
+            *code = B75;
             break;
         case 110:
-            RS485_Baud = B110;
+            *code = B110;
             break;
         case 134:
-            RS485_Baud = B134;
+            *code = B134;
             break;
         case 150:
-            RS485_Baud = B150;
+            *code = B150;
             break;
         case 200:
-            RS485_Baud = B200;
+            *code = B200;
             break;
         case 300:
-            RS485_Baud = B300;
+            *code = B300;
             break;
         case 600:
-            RS485_Baud = B600;
+            *code = B600;
             break;
         case 1200:
-            RS485_Baud = B1200;
+            *code = B1200;
             break;
         case 1800:
-            RS485_Baud = B1800;
+            *code = B1800;
             break;
         case 2400:
-            RS485_Baud = B2400;
+            *code = B2400;
             break;
         case 4800:
-            RS485_Baud = B4800;
+            *code = B4800;
             break;
         case 9600:
-            RS485_Baud = B9600;
+            *code = B9600;
             break;
         case 19200:
-            RS485_Baud = B19200;
+            *code = B19200;
             break;
         case 38400:
-            RS485_Baud = B38400;
+            *code = B38400;
             break;
         case 57600:
-            RS485_Baud = B57600;
+            *code = B57600;
             break;
         case 76800:
-            RS485_Baud = B38400;
-            RS485_SpecBaud = true;
+            *code = B38400;
+            *special = true;
             break;
         case 115200:
-            RS485_Baud = B115200;
+            *code = B115200;
             break;
         case 230400:
-            RS485_Baud = B230400;
+            *code = B230400;
             break;
         default:
             valid = false;
             break;
     }
 
+    return valid;
+}
+
+/****************************************************************************
+ * DESCRIPTION: Sets the baud rate for the chip USART
+ * RETURN:      none
+ * ALGORITHM:   none
+ * NOTES:       none
+ *****************************************************************************/
+bool RS485_Set_Baud_Rate(uint32_t baud)
+{
+    unsigned int code = RS485_Baud;
+    bool valid;
+
+    valid = rs485_baud_code(baud, &code, &RS485_SpecBaud);
     if (valid) {
-        /* FIXME: store the baud rate */
+        RS485_Baud = code;
     }
 
     return valid;
 }
 
+/**
+ * @brief Write a frame to a serial port, after the turnaround time
+ * @param handle - serial port handle returned from open()
+ * @param baud - baud rate in bits per second
+ * @param buffer - frame to send
+ * @param nbytes - number of bytes of data
+ */
+static void
+rs485_write(int handle, uint32_t baud, const uint8_t *buffer, uint16_t nbytes)
+{
+    uint32_t turnaround_time = Tturnaround * 1000;
+    ssize_t written = 0;
+    int greska;
+
+    if (baud) {
+        /* sleeping for turnaround time is necessary to give other devices
+           time to change from sending to receiving state. */
+        usleep(turnaround_time / baud);
+    }
+    /*
+       On  success,  the  number of bytes written are returned (zero
+       indicates nothing was written).  On error, -1  is  returned,  and
+       errno  is  set appropriately.   If  count  is zero and the file
+       descriptor refers to a regular file, 0 will be returned without
+       causing any other effect.  For a special file, the results are not
+       portable.
+     */
+    written = write(handle, buffer, nbytes);
+    greska = errno;
+    if (written <= 0) {
+        printf("write error: %s\n", strerror(greska));
+    } else {
+        /* wait until all output has been transmitted. */
+        tcdrain(handle);
+    }
+}
+
 /****************************************************************************
  * DESCRIPTION: Transmit a frame on the wire
  * RETURN:      none
@@ -358,67 +411,21 @@ void RS485_Send_Frame(
     const uint8_t *buffer, /* frame to send (up to 501 bytes of data) */
     uint16_t nbytes)
 { /* number of bytes of data (up to 501) */
-    uint32_t turnaround_time = Tturnaround * 1000;
-    uint32_t baud;
-    ssize_t written = 0;
-    int greska;
     const SHARED_MSTP_DATA *poSharedData = NULL;
 
     if (mstp_port) {
         poSharedData = (SHARED_MSTP_DATA *)mstp_port->UserData;
     }
     if (!poSharedData) {
-        baud = RS485_Get_Baud_Rate();
-        /* sleeping for turnaround time is necessary to give other devices
-           time to change from sending to receiving state. */
-        usleep(turnaround_time / baud);
-        /*
-           On  success,  the  number of bytes written are returned (zero
-           indicates nothing was written).  On error, -1  is  returned,  and
-           errno  is  set appropriately.   If  count  is zero and the file
-           descriptor refers to a regular file, 0 will be returned without
-           causing any other effect.  For a special file, the results are not
-           portable.
-         */
-        written = write(RS485_Handle, buffer, nbytes);
-        greska = errno;
-        if (written <= 0) {
-            printf("write error: %s\n", strerror(greska));
-        } else {
-            /* wait until all output has been transmitted. */
-            tcdrain(RS485_Handle);
-        }
-        /*  tcdrain(RS485_Handle); */
-        /* per MSTP spec, sort of */
-        if (mstp_port) {
-            mstp_port->SilenceTimerReset((void *)mstp_port);
-        }
+        rs485_write(RS485_Handle, RS485_Get_Baud_Rate(), buffer, nbytes);
     } else {
-        baud = RS485_Get_Port_Baud_Rate(mstp_port);
-        /* sleeping for turnaround time is necessary to give other devices
-           time to change from sending to receiving state. */
-        usleep(turnaround_time / baud);
-        /*
-           On  success,  the  number of bytes written are returned (zero
-           indicates nothing was written).  On error, -1  is  returned,  and
-           errno  is  set appropriately.   If  count  is zero and the file
-           descriptor refers to a regular file, 0 will be returned without
-           causing any other effect.  For a special file, the results are not
-           portable.
-         */
-        written = write(poSharedData->RS485_Handle, buffer, nbytes);
-        greska = errno;
-        if (written <= 0) {
-            printf("write error: %s\n", strerror(greska));
-        } else {
-            /* wait until all output has been transmitted. */
-            tcdrain(poSharedData->RS485_Handle);
-        }
-        /*  tcdrain(RS485_Handle); */
-        /* per MSTP spec, sort of */
-        if (mstp_port) {
-            mstp_port->SilenceTimerReset((void *)mstp_port);
-        }
+        rs485_write(
+            poSharedData->RS485_Handle, RS485_Get_Port_Baud_Rate(mstp_port),
+            buffer, nbytes);
+    }
+    /* per MSTP spec, sort of */
+    if (mstp_port) {
+        mstp_port->SilenceTimerReset((void *)mstp_port);
     }
 
     return;
@@ -505,6 +512,64 @@ void RS485_Check_UART_Data(struct mstp_port_struct_t *mstp_port)
     }
 }
 
+/**
+ * @brief Read the octets that are available from a serial port
+ * @param handle - serial port handle returned from open()
+ * @param buffer - where to store the octets received
+ * @param size - number of octets that fit in the buffer
+ * @return number of octets received, or zero if none were received
+ *  after waiting up to 5 milliseconds.
+ */
+static unsigned rs485_read_span(int handle, uint8_t *buffer, unsigned size)
+{
+    fd_set input;
+    struct timeval waiter;
+    ssize_t n;
+
+    waiter.tv_sec = 0;
+    waiter.tv_usec = 5000;
+    FD_ZERO(&input);
+    FD_SET(handle, &input);
+    if (select(handle + 1, &input, NULL, NULL, &waiter) <= 0) {
+        return 0;
+    }
+    n = read(handle, buffer, size);
+    if (n <= 0) {
+        return 0;
+    }
+
+    return (unsigned)n;
+}
+
+/**
+ * @brief Get the received octets, as many as are available, so that the
+ *  MS/TP Receive Frame state machine can take them as a span with
+ *  MSTP_Receive_Frame_Span() rather than one octet per call.
+ * @param mstp_port - port specific data
+ * @param buffer - where to store the octets received
+ * @param size - number of octets that fit in the buffer
+ * @return number of octets received, or zero if none were received
+ *  after waiting up to 5 milliseconds.
+ */
+unsigned RS485_Receive_Span(
+    struct mstp_port_struct_t *mstp_port, uint8_t *buffer, unsigned size)
+{
+    SHARED_MSTP_DATA *poSharedData = (SHARED_MSTP_DATA *)mstp_port->UserData;
+    FIFO_BUFFER *fifo = &Rx_FIFO;
+    int handle = RS485_Handle;
+
+    if (poSharedData) {
+        fifo = &poSharedData->Rx_FIFO;
+        handle = poSharedData->RS485_Handle;
+    }
+    if (FIFO_Count(fifo) > 0) {
+        /* left over from RS485_Check_UART_Data() */
+        return FIFO_Pull(fifo, buffer, size);
+    }
+
+    return rs485_read_span(handle, buffer, size);
+}
+
 void RS485_Cleanup(void)
 {
     /* restore the old port settings */
@@ -513,37 +578,49 @@ void RS485_Cleanup(void)
     close(RS485_Handle);
 }
 
-void RS485_Initialize(void)
+/**
+ * @brief Open a serial port for MS/TP, and configure its baud rate
+ * @param name - serial port name, i.e. /dev/ttyUSB0
+ * @param code - termios speed
+ * @param special - true if the speed needs a custom divisor
+ * @param oldtio - where the previous serial settings are saved
+ * @param oldserial - where the previous serial setup is saved
+ * @return the handle returned from open(), or -1 on failure
+ */
+static int rs485_open(
+    const char *name,
+    unsigned int code,
+    bool special,
+    struct termios *oldtio,
+    struct serial_struct *oldserial)
 {
     struct termios newtio;
     struct serial_struct newserial;
     float baud_error = 0.0;
+    int handle;
 
-#if PRINT_ENABLED
-    fprintf(stdout, "RS485 Interface: %s\n", RS485_Port_Name);
-#endif
     /*
        Open device for reading and writing.
        Blocking mode - more CPU effecient
      */
-    RS485_Handle = open(RS485_Port_Name, O_RDWR | O_NOCTTY /*| O_NDELAY */);
-    if (RS485_Handle < 0) {
-        perror(RS485_Port_Name);
-        exit(-1);
+    handle = open(name, O_RDWR | O_NOCTTY /*| O_NDELAY */);
+    if (handle < 0) {
+        perror(name);
+        return -1;
     }
 #if 0
     /* non blocking for the read */
-    fcntl(RS485_Handle, F_SETFL, FNDELAY);
+    fcntl(handle, F_SETFL, FNDELAY);
 #else
     /* efficient blocking for the read */
-    fcntl(RS485_Handle, F_SETFL, 0);
+    fcntl(handle, F_SETFL, 0);
 #endif
     /* save current serial port settings */
-    tcgetattr(RS485_Handle, &RS485_oldtio);
+    tcgetattr(handle, oldtio);
     /* we read the old serial setup */
-    ioctl(RS485_Handle, TIOCGSERIAL, &RS485_oldserial);
+    ioctl(handle, TIOCGSERIAL, oldserial);
     /* we need a copy of existing settings */
-    memcpy(&newserial, &RS485_oldserial, sizeof(struct serial_struct));
+    memcpy(&newserial, oldserial, sizeof(struct serial_struct));
     /* clear struct for new port settings */
     bzero(&newtio, sizeof(newtio));
     /*
@@ -554,7 +631,7 @@ void RS485_Initialize(void)
        CLOCAL  : local connection, no modem contol
        CREAD   : enable receiving characters
      */
-    newtio.c_cflag = RS485_Baud | CS8 | CLOCAL | CREAD | RS485MOD;
+    newtio.c_cflag = code | CS8 | CLOCAL | CREAD | RS485MOD;
     /* Raw input */
     newtio.c_iflag = 0;
     /* Raw output */
@@ -562,8 +639,8 @@ void RS485_Initialize(void)
     /* no processing */
     newtio.c_lflag = 0;
     /* activate the settings for the port after flushing I/O */
-    tcsetattr(RS485_Handle, TCSAFLUSH, &newtio);
-    if (RS485_SpecBaud) {
+    tcsetattr(handle, TCSAFLUSH, &newtio);
+    if (special) {
         /* 76800, custom divisor must be set */
         newserial.flags |= ASYNC_SPD_CUST;
         newserial.custom_divisor = round(((float)newserial.baud_base) / 76800);
@@ -578,30 +655,133 @@ void RS485_Initialize(void)
             fprintf(
                 stderr, "RS485 bad custom divisor %d, base baud %d\n",
                 newserial.custom_divisor, newserial.baud_base);
-            exit(EXIT_FAILURE);
+            tcsetattr(handle, TCSANOW, oldtio);
+            close(handle);
+            return -1;
         }
 
-    } else if (RS485_Baud == B38400) {
+    } else if (code == B38400) {
         /* restting 38400 baud */
         newserial.flags &= ~ASYNC_SPD_CUST;
         newserial.custom_divisor = 0;
     }
 
-    ioctl(RS485_Handle, TIOCSSERIAL, &newserial);
+    ioctl(handle, TIOCSSERIAL, &newserial);
+    /* flush any data waiting */
+    usleep(200000);
+    tcflush(handle, TCIOFLUSH);
+
+    return handle;
+}
 
+void RS485_Initialize(void)
+{
+#if PRINT_ENABLED
+    fprintf(stdout, "RS485 Interface: %s\n", RS485_Port_Name);
+#endif
+    RS485_Handle = rs485_open(
+        RS485_Port_Name, RS485_Baud, RS485_SpecBaud, &RS485_oldtio,
+        &RS485_oldserial);
+    if (RS485_Handle < 0) {
+        exit(EXIT_FAILURE);
+    }
 #if PRINT_ENABLED
     fprintf(stdout, "RS485 Baud Rate %u\n", RS485_Get_Baud_Rate());
     fflush(stdout);
 #endif
     /* destructor */
     atexit(RS485_Cleanup);
-    /* flush any data waiting */
-    usleep(200000);
-    tcflush(RS485_Handle, TCIOFLUSH);
     /* ringbuffer */
     FIFO_Init(&Rx_FIFO, Rx_Buffer, sizeof(Rx_Buffer));
 }
 
+/**
+ * @brief Open the serial port of an RS485 port. Unlike RS485_Initialize(),
+ *  the port does not use the RS485_ settings, so more than one serial
+ *  port can be open in the same process.
+ * @param port - RS485 port with its name and baud rate set
+ * @return true if the serial port was opened
+ */
+bool RS485_Port_Open(struct rs485_port *port)
+{
+    unsigned int code = B38400;
+    bool special = false;
+
+    if (!port) {
+        return false;
+    }
+    if (!port->name) {
+        port->name = "/dev/ttyUSB0";
+    }
+    if (port->baud == 0) {
+        port->baud = 38400;
+    }
+    if (!rs485_baud_code(port->baud, &code, &special)) {
+        fprintf(
+            stderr, "RS485 %s: invalid baud rate %lu\n", port->name,
+            (unsigned long)port->baud);
+        return false;
+    }
+    port->handle = rs485_open(
+        port->name, code, special, &port->oldtio, &port->oldserial);
+
+    return port->handle >= 0;
+}
+
+/**
+ * @brief Restore the serial settings of an RS485 port, and close it
+ * @param port - RS485 port opened with RS485_Port_Open()
+ */
+void RS485_Port_Close(struct rs485_port *port)
+{
+    if (port && (port->handle >= 0)) {
+        tcsetattr(port->handle, TCSANOW, &port->oldtio);
+        ioctl(port->handle, TIOCSSERIAL, &port->oldserial);
+        close(port->handle);
+        port->handle = -1;
+    }
+}
+
+/**
+ * @brief Check that a baud rate can be used by an RS485 port
+ * @param baud - baud rate in bits per second
+ * @return true if the baud rate is valid
+ */
+bool RS485_Port_Baud_Rate_Valid(uint32_t baud)
+{
+    unsigned int code;
+    bool special;
+
+    return rs485_baud_code(baud, &code, &special);
+}
+
+/**
+ * @brief Transmit a frame on the serial port of an RS485 port
+ * @param port - RS485 port opened with RS485_Port_Open()
+ * @param buffer - frame to send
+ * @param nbytes - number of bytes of data
+ */
+void RS485_Port_Send_Frame(
+    const struct rs485_port *port, const uint8_t *buffer, uint16_t nbytes)
+{
+    rs485_write(port->handle, port->baud, buffer, nbytes);
+}
+
+/**
+ * @brief Get the received octets of an RS485 port, as many as are
+ *  available, for MSTP_Receive_Frame_Span()
+ * @param port - RS485 port opened with RS485_Port_Open()
+ * @param buffer - where to store the octets received
+ * @param size - number of octets that fit in the buffer
+ * @return number of octets received, or zero if none were received
+ *  after waiting up to 5 milliseconds.
+ */
+unsigned RS485_Port_Receive_Span(
+    const struct rs485_port *port, uint8_t *buffer, unsigned size)
+{
+    return rs485_read_span(port->handle, buffer, size);
+}
+
 /* Print in a format for Wireshark ExtCap */
 void RS485_Print_Ports(void)
 {
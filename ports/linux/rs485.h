@@ -8,9 +8,27 @@
 #ifndef RS485_H
 #define RS485_H
 
+#include <stdbool.h>
 #include <stdint.h>
+#include <termios.h>
+#include <linux/serial.h>
 #include "bacnet/datalink/mstp.h"
 
+/* A serial port that keeps its own settings, so that one process can
+   have more than one MS/TP port open. Set the name and baud rate, and
+   then open it with RS485_Port_Open(). */
+struct rs485_port {
+    /* serial port name - expects a constant char, or char from the heap */
+    const char *name;
+    /* baud rate in bits per second */
+    uint32_t baud;
+    /* handle returned from open() */
+    int handle;
+    /* serial I/O settings to restore */
+    struct termios oldtio;
+    struct serial_struct oldserial;
+};
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -33,6 +51,9 @@ BACNET_STACK_EXPORT
 void RS485_Check_UART_Data(
     struct mstp_port_struct_t *mstp_port); /* port specific data */
 BACNET_STACK_EXPORT
+unsigned RS485_Receive_Span(
+    struct mstp_port_struct_t *mstp_port, uint8_t *buffer, unsigned size);
+BACNET_STACK_EXPORT
 uint32_t RS485_Get_Port_Baud_Rate(struct mstp_port_struct_t *mstp_port);
 BACNET_STACK_EXPORT
 uint32_t RS485_Get_Baud_Rate(void);
@@ -44,6 +65,19 @@ void RS485_Cleanup(void);
 BACNET_STACK_EXPORT
 void RS485_Print_Ports(void);
 
+BACNET_STACK_EXPORT
+bool RS485_Port_Open(struct rs485_port *port);
+BACNET_STACK_EXPORT
+void RS485_Port_Close(struct rs485_port *port);
+BACNET_STACK_EXPORT
+bool RS485_Port_Baud_Rate_Valid(uint32_t baud);
+BACNET_STACK_EXPORT
+void RS485_Port_Send_Frame(
+    const struct rs485_port *port, const uint8_t *buffer, uint16_t nbytes);
+BACNET_STACK_EXPORT
+unsigned RS485_Port_Receive_Span(
+    const struct rs485_port *port, uint8_t *buffer, unsigned size);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -0,0 +1,322 @@
+/**
+ * @file
+ * @brief Log buffers of Trend Log objects kept in memory-mapped files,
+ *  so that the records survive a restart.
+ * @author agent <agent@local>
+ * @date October 2026
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+/* BACnet Stack API */
+#include "bacnet/basic/object/trendlog.h"
+/* port specific */
+#include "trendlog-mmap.h"
+
+/* "BNTL" */
+#define TREND_LOG_MMAP_MAGIC 0x4C544E42UL
+#define TREND_LOG_MMAP_VERSION 1
+/* the records follow the header, at an offset that keeps them aligned */
+#define TREND_LOG_MMAP_HEADER_SIZE 64
+
+/* position of the records, written to the older of two blocks so that
+   the newer block stays complete if the write is interrupted */
+struct trend_log_mmap_commit {
+    uint32_t sequence;
+    uint32_t index;
+    uint32_t record_count;
+    uint32_t total_record_count;
+    uint32_t check;
+};
+
+struct trend_log_mmap_header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size;
+    uint32_t buffer_size;
+    uint32_t reserved;
+    struct trend_log_mmap_commit commit[2];
+};
+
+struct trend_log_mmap {
+    bool used;
+    uint32_t object_instance;
+    int fd;
+    uint8_t *map;
+    size_t map_size;
+    /* sequence of the newest commit block */
+    uint32_t sequence;
+};
+
+static struct trend_log_mmap Trend_Log_Mmap[TREND_LOG_MMAP_MAX];
+
+/**
+ * @brief Find the file of a Trend Log
+ * @param object_instance - object-instance number of the Trend Log
+ * @return the file, or NULL if the Trend Log is not kept in a file
+ */
+static struct trend_log_mmap *trend_log_mmap_find(uint32_t object_instance)
+{
+    unsigned i;
+
+    for (i = 0; i < TREND_LOG_MMAP_MAX; i++) {
+        if (Trend_Log_Mmap[i].used &&
+            (Trend_Log_Mmap[i].object_instance == object_instance)) {
+            return &Trend_Log_Mmap[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Compute the FNV-1a check value of a commit block
+ * @param commit - commit block
+ * @return check value of the other members of the commit block
+ */
+static uint32_t trend_log_mmap_check(const struct trend_log_mmap_commit *commit)
+{
+    uint32_t value[4];
+    uint32_t hash = 2166136261UL;
+    unsigned i, j;
+
+    value[0] = commit->sequence;
+    value[1] = commit->index;
+    value[2] = commit->record_count;
+    value[3] = commit->total_record_count;
+    for (i = 0; i < 4; i++) {
+        for (j = 0; j < 4; j++) {
+            hash ^= (value[i] >> (j * 8)) & 0xFF;
+            hash *= 16777619UL;
+        }
+    }
+
+    return hash;
+}
+
+/**
+ * @brief Find the newest complete commit block of a file
+ * @param header - header of the file
+ * @param buffer_size - number of records expected in the file
+ * @return the commit block, or NULL if the file has to be initialized
+ */
+static const struct trend_log_mmap_commit *
+trend_log_mmap_commit_newest(
+    const struct trend_log_mmap_header *header, uint32_t buffer_size)
+{
+    const struct trend_log_mmap_commit *newest = NULL;
+    const struct trend_log_mmap_commit *commit;
+    unsigned i;
+
+    if ((header->magic != TREND_LOG_MMAP_MAGIC) ||
+        (header->version != TREND_LOG_MMAP_VERSION) ||
+        (header->record_size != sizeof(TL_DATA_REC)) ||
+        (header->buffer_size != buffer_size)) {
+        return NULL;
+    }
+    for (i = 0; i < 2; i++) {
+        commit = &header->commit[i];
+        if ((commit->check != trend_log_mmap_check(commit)) ||
+            (commit->index >= buffer_size) ||
+            (commit->record_count > buffer_size)) {
+            continue;
+        }
+        if (!newest || ((int32_t)(commit->sequence - newest->sequence) > 0)) {
+            newest = commit;
+        }
+    }
+
+    return newest;
+}
+
+/**
+ * @brief Save the position of the records after a record was added, or
+ *  before the slot of the oldest record is reused. A record that was added
+ *  is already in the mapped file.
+ * @param object_instance - object-instance number of the Trend Log
+ * @param index - insertion point, the position of the next record
+ * @param record_count - number of records in the log buffer
+ * @param total_record_count - number of records ever added
+ */
+static void trend_log_mmap_commit(
+    uint32_t object_instance,
+    uint32_t index,
+    uint32_t record_count,
+    uint32_t total_record_count)
+{
+    struct trend_log_mmap *entry;
+    struct trend_log_mmap_header *header;
+    struct trend_log_mmap_commit *commit;
+    uint32_t sequence;
+
+    entry = trend_log_mmap_find(object_instance);
+    if (!entry) {
+        return;
+    }
+#if defined(TREND_LOG_MMAP_SYNC)
+    /* the record reaches the disk before the commit that refers to it */
+    msync(entry->map, entry->map_size, MS_SYNC);
+#endif
+    header = (struct trend_log_mmap_header *)entry->map;
+    sequence = entry->sequence + 1;
+    commit = &header->commit[sequence & 1];
+    commit->check = 0;
+    commit->sequence = sequence;
+    commit->index = index;
+    commit->record_count = record_count;
+    commit->total_record_count = total_record_count;
+    __sync_synchronize();
+    commit->check = trend_log_mmap_check(commit);
+    entry->sequence = sequence;
+#if defined(TREND_LOG_MMAP_SYNC)
+    msync(entry->map, TREND_LOG_MMAP_HEADER_SIZE, MS_SYNC);
+#endif
+}
+
+/**
+ * @brief Keep the log buffer of a Trend Log in a memory-mapped file. The
+ *  records already in the file are used, unless the file was made with
+ *  another Buffer_Size or record layout, in which case it is emptied.
+ * @param object_instance - object-instance number of the Trend Log
+ * @param pathname - file of the log buffer, created if it does not exist
+ * @param buffer_size - number of records in the log buffer
+ * @return true if the log buffer is kept in the file
+ */
+bool trend_log_mmap_open(
+    uint32_t object_instance, const char *pathname, uint32_t buffer_size)
+{
+    struct trend_log_mmap *entry = NULL;
+    struct trend_log_mmap_header *header;
+    const struct trend_log_mmap_commit *commit;
+    TL_STORAGE storage = { 0 };
+    struct stat st;
+    size_t map_size;
+    void *map;
+    unsigned i;
+    int fd;
+
+    if (!pathname || (buffer_size == 0) ||
+        (((uint64_t)buffer_size * sizeof(TL_DATA_REC)) >
+         (SIZE_MAX - TREND_LOG_MMAP_HEADER_SIZE))) {
+        return false;
+    }
+    trend_log_mmap_close(object_instance);
+    for (i = 0; i < TREND_LOG_MMAP_MAX; i++) {
+        if (!Trend_Log_Mmap[i].used) {
+            entry = &Trend_Log_Mmap[i];
+            break;
+        }
+    }
+    if (!entry) {
+        return false;
+    }
+    map_size = TREND_LOG_MMAP_HEADER_SIZE +
+        ((size_t)buffer_size * sizeof(TL_DATA_REC));
+    fd = open(pathname, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    if ((fstat(fd, &st) != 0) ||
+        (((size_t)st.st_size != map_size) &&
+         ((ftruncate(fd, 0) != 0) || (ftruncate(fd, map_size) != 0)))) {
+        close(fd);
+        return false;
+    }
+    map = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+    header = (struct trend_log_mmap_header *)map;
+    commit = trend_log_mmap_commit_newest(header, buffer_size);
+    if (!commit) {
+        /* a new file, or one that cannot be used: start it empty */
+        memset(header, 0, TREND_LOG_MMAP_HEADER_SIZE);
+        header->magic = TREND_LOG_MMAP_MAGIC;
+        header->version = TREND_LOG_MMAP_VERSION;
+        header->record_size = sizeof(TL_DATA_REC);
+        header->buffer_size = buffer_size;
+        header->commit[0].check = trend_log_mmap_check(&header->commit[0]);
+        commit = &header->commit[0];
+    }
+    storage.pRecords =
+        (TL_DATA_REC *)((uint8_t *)map + TREND_LOG_MMAP_HEADER_SIZE);
+    storage.ulBufferSize = buffer_size;
+    storage.ulIndex = commit->index;
+    storage.ulRecordCount = commit->record_count;
+    storage.ulTotalRecordCount = commit->total_record_count;
+    entry->used = true;
+    entry->object_instance = object_instance;
+    entry->fd = fd;
+    entry->map = map;
+    entry->map_size = map_size;
+    entry->sequence = commit->sequence;
+    if (!Trend_Log_Storage_Set(
+            object_instance, &storage, trend_log_mmap_commit)) {
+        entry->used = false;
+        munmap(map, map_size);
+        close(fd);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Write the log buffer of a Trend Log to its file now
+ * @param object_instance - object-instance number of the Trend Log
+ * @return true if the file was written
+ */
+bool trend_log_mmap_sync(uint32_t object_instance)
+{
+    struct trend_log_mmap *entry;
+
+    entry = trend_log_mmap_find(object_instance);
+    if (!entry) {
+        return false;
+    }
+
+    return msync(entry->map, entry->map_size, MS_SYNC) == 0;
+}
+
+/**
+ * @brief Stop keeping the log buffer of a Trend Log in its file. The
+ *  Trend Log goes back to its default log buffer, empty.
+ * @param object_instance - object-instance number of the Trend Log
+ */
+void trend_log_mmap_close(uint32_t object_instance)
+{
+    struct trend_log_mmap *entry;
+
+    entry = trend_log_mmap_find(object_instance);
+    if (!entry) {
+        return;
+    }
+    Trend_Log_Storage_Set(object_instance, NULL, NULL);
+    msync(entry->map, entry->map_size, MS_SYNC);
+    munmap(entry->map, entry->map_size);
+    close(entry->fd);
+    memset(entry, 0, sizeof(*entry));
+}
+
+/**
+ * @brief Close the files of all of the Trend Logs
+ */
+void trend_log_mmap_cleanup(void)
+{
+    unsigned i;
+
+    for (i = 0; i < TREND_LOG_MMAP_MAX; i++) {
+        if (Trend_Log_Mmap[i].used) {
+            trend_log_mmap_close(Trend_Log_Mmap[i].object_instance);
+        }
+    }
+}
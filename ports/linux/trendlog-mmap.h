@@ -0,0 +1,45 @@
+/**
+ * @file
+ * @brief Log buffers of Trend Log objects kept in memory-mapped files,
+ *  so that the records survive a restart.
+ * @author agent <agent@local>
+ * @date October 2026
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * Each Trend Log has its own file: a header followed by a ring of
+ * Buffer_Size records with the layout of TL_DATA_REC. The records are
+ * read in place by ReadRange. The position of the records is kept in
+ * two alternating commit blocks in the header, so that a restart after
+ * a crash finds the last complete commit. The slot of the oldest record
+ * is only reused after a commit that no longer counts that record.
+ */
+#ifndef TRENDLOG_MMAP_H
+#define TRENDLOG_MMAP_H
+#include <stdbool.h>
+#include <stdint.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+
+/* number of Trend Logs that can be kept in files */
+#ifndef TREND_LOG_MMAP_MAX
+#define TREND_LOG_MMAP_MAX 8
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+BACNET_STACK_EXPORT
+bool trend_log_mmap_open(
+    uint32_t object_instance, const char *pathname, uint32_t buffer_size);
+BACNET_STACK_EXPORT
+bool trend_log_mmap_sync(uint32_t object_instance);
+BACNET_STACK_EXPORT
+void trend_log_mmap_close(uint32_t object_instance);
+BACNET_STACK_EXPORT
+void trend_log_mmap_cleanup(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
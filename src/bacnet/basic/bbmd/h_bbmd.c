@@ -8,7 +8,9 @@
 #include <stdio.h> /* for standard i/o, like printing */
 #include <stdint.h> /* for standard integer types uint8_t etc. */
 #include <stdbool.h> /* for the standard bool type. */
+#include <stdlib.h> /* for calloc */
 #include <string.h> /* for memcpy */
+#include <limits.h> /* for UINT_MAX */
 #include "bacnet/bacdcode.h"
 #include "bacnet/npdu.h"
 #include "bacnet/datalink/bip.h"
@@ -55,18 +57,55 @@ static uint16_t Remote_BBMD_TTL_Seconds;
 static uint8_t BVLC_Buffer[BIP_MPDU_MAX];
 static uint16_t BVLC_Buffer_Len;
 #endif
-#if BBMD_ENABLED /* Broadcast Distribution Table */
+#if BBMD_ENABLED
+/* Broadcast Distribution Table */
 #ifndef MAX_BBMD_ENTRIES
 #define MAX_BBMD_ENTRIES 128
+#endif
 static BACNET_IP_BROADCAST_DISTRIBUTION_TABLE_ENTRY
     BBMD_Table[MAX_BBMD_ENTRIES];
-/* Foreign Device Table */
+/* Foreign Device Table, until bvlc_fdt_size_set() is called */
 #ifndef MAX_FD_ENTRIES
 #define MAX_FD_ENTRIES 128
 #endif
-static BACNET_IP_FOREIGN_DEVICE_TABLE_ENTRY FD_Table[MAX_FD_ENTRIES];
-#endif /* BBMD_ENABLED */
+/* foreign devices by the second that their registration expires */
+#ifndef BBMD_FDT_TIMER_SLOTS
+#define BBMD_FDT_TIMER_SLOTS 256
 #endif
+/* end of a list, or not in a list */
+#define FDT_NONE UINT_MAX
+typedef struct bbmd_fdt_index {
+    /* next entry with the same address hash, or in the free list */
+    unsigned next;
+    /* position in the list of registered foreign devices */
+    unsigned active;
+    /* value of FDT_Seconds when the registration expires */
+    uint32_t expires;
+    /* entries that expire in the same timer wheel slot */
+    unsigned timer_prev;
+    unsigned timer_next;
+} BBMD_FDT_INDEX;
+static BACNET_IP_FOREIGN_DEVICE_TABLE_ENTRY FD_Table_Default[MAX_FD_ENTRIES];
+static BBMD_FDT_INDEX FDT_Index_Default[MAX_FD_ENTRIES];
+static unsigned FDT_Buckets_Default[MAX_FD_ENTRIES];
+static unsigned FDT_Active_Default[MAX_FD_ENTRIES];
+static BACNET_IP_FOREIGN_DEVICE_TABLE_ENTRY *FD_Table = FD_Table_Default;
+static BBMD_FDT_INDEX *FDT_Index = FDT_Index_Default;
+/* entries by the hash of their B/IP address */
+static unsigned *FDT_Buckets = FDT_Buckets_Default;
+/* registered entries, packed so that forwarding skips no empty slots */
+static unsigned *FDT_Active = FDT_Active_Default;
+static unsigned FDT_Size = MAX_FD_ENTRIES;
+static unsigned FDT_Count;
+static unsigned FDT_Free;
+static unsigned FDT_Timer_Wheel[BBMD_FDT_TIMER_SLOTS];
+static uint32_t FDT_Seconds;
+static bool FDT_Initialized;
+/* destinations of a Forwarded-NPDU, which are sent in one call */
+#define BBMD_FORWARD_MAX \
+    ((MAX_BBMD_ENTRIES > MAX_FD_ENTRIES) ? MAX_BBMD_ENTRIES : MAX_FD_ENTRIES)
+static BACNET_IP_ADDRESS BBMD_Forward_Address[BBMD_FORWARD_MAX];
+#endif /* BBMD_ENABLED */
 
 /**
  * @brief Enabled debug printing of BACnet/IPv4 BBMD
@@ -237,14 +276,322 @@ void bvlc_bdt_restore_local(void)
 #endif
 #endif
 
+#if BBMD_ENABLED
+/**
+ * @brief Empty the Foreign Device Table
+ */
+static void bbmd_fdt_reset(void)
+{
+    unsigned i;
+
+    for (i = 0; i < FDT_Size; i++) {
+        memset(&FD_Table[i], 0, sizeof(FD_Table[i]));
+        /* free entries are taken in index order */
+        if ((i + 1) < FDT_Size) {
+            FDT_Index[i].next = i + 1;
+        } else {
+            FDT_Index[i].next = FDT_NONE;
+        }
+        FDT_Index[i].active = FDT_NONE;
+        FDT_Index[i].expires = 0;
+        FDT_Index[i].timer_prev = FDT_NONE;
+        FDT_Index[i].timer_next = FDT_NONE;
+        FDT_Buckets[i] = FDT_NONE;
+    }
+    /* the table is also a list for the BVLC encoders and Network Port */
+    bvlc_foreign_device_table_link_array(FD_Table, FDT_Size);
+    for (i = 0; i < BBMD_FDT_TIMER_SLOTS; i++) {
+        FDT_Timer_Wheel[i] = FDT_NONE;
+    }
+    FDT_Free = 0;
+    FDT_Count = 0;
+    FDT_Seconds = 0;
+    FDT_Initialized = true;
+}
+
+/**
+ * @brief Empty the Foreign Device Table once, before it is first used
+ */
+static void bbmd_fdt_init_check(void)
+{
+    if (!FDT_Initialized) {
+        bbmd_fdt_reset();
+    }
+}
+
+/**
+ * @brief Find the hash chain of a B/IP address
+ * @param addr - B/IP address and port of the foreign device
+ * @return the head of the hash chain
+ */
+static unsigned *bbmd_fdt_bucket(const BACNET_IP_ADDRESS *addr)
+{
+    uint32_t hash;
+
+    hash = ((uint32_t)addr->address[0] << 24) |
+        ((uint32_t)addr->address[1] << 16) |
+        ((uint32_t)addr->address[2] << 8) | (uint32_t)addr->address[3];
+    hash ^= (uint32_t)addr->port << 7;
+    /* spread sequential addresses of remote sites across the buckets */
+    hash *= 2654435761UL;
+
+    return &FDT_Buckets[(hash >> 8) % FDT_Size];
+}
+
+/**
+ * @brief Find a foreign device by its B/IP address
+ * @param addr - B/IP address and port of the foreign device
+ * @return index of the FDT entry, or FDT_NONE if not registered
+ */
+static unsigned bbmd_fdt_find(const BACNET_IP_ADDRESS *addr)
+{
+    unsigned index;
+
+    bbmd_fdt_init_check();
+    index = *bbmd_fdt_bucket(addr);
+    while (index != FDT_NONE) {
+        if (!bvlc_address_different(&FD_Table[index].dest_address, addr)) {
+            break;
+        }
+        index = FDT_Index[index].next;
+    }
+
+    return index;
+}
+
+/**
+ * @brief Start the registration timer of an entry in the timer wheel
+ * @param index - FDT entry index
+ * @param seconds - seconds until the registration expires
+ */
+static void bbmd_fdt_timer_add(unsigned index, uint32_t seconds)
+{
+    BBMD_FDT_INDEX *entry = &FDT_Index[index];
+    unsigned slot;
+
+    if (seconds > (UINT32_MAX - FDT_Seconds)) {
+        entry->expires = UINT32_MAX;
+    } else {
+        entry->expires = FDT_Seconds + seconds;
+    }
+    slot = entry->expires % BBMD_FDT_TIMER_SLOTS;
+    entry->timer_prev = FDT_NONE;
+    entry->timer_next = FDT_Timer_Wheel[slot];
+    if (entry->timer_next != FDT_NONE) {
+        FDT_Index[entry->timer_next].timer_prev = index;
+    }
+    FDT_Timer_Wheel[slot] = index;
+}
+
+/**
+ * @brief Stop the registration timer of an entry in the timer wheel
+ * @param index - FDT entry index
+ */
+static void bbmd_fdt_timer_remove(unsigned index)
+{
+    BBMD_FDT_INDEX *entry = &FDT_Index[index];
+
+    if (entry->timer_prev != FDT_NONE) {
+        FDT_Index[entry->timer_prev].timer_next = entry->timer_next;
+    } else {
+        FDT_Timer_Wheel[entry->expires % BBMD_FDT_TIMER_SLOTS] =
+            entry->timer_next;
+    }
+    if (entry->timer_next != FDT_NONE) {
+        FDT_Index[entry->timer_next].timer_prev = entry->timer_prev;
+    }
+    entry->timer_prev = FDT_NONE;
+    entry->timer_next = FDT_NONE;
+}
+
+/**
+ * @brief Register a foreign device, or restart its registration timer
+ * @param addr - B/IP address and port of the foreign device
+ * @param ttl_seconds - Time-to-Live T, in seconds
+ * @return true if the foreign device is registered
+ */
+static bool bbmd_fdt_add(const BACNET_IP_ADDRESS *addr, uint16_t ttl_seconds)
+{
+    BACNET_IP_FOREIGN_DEVICE_TABLE_ENTRY *fdt_entry;
+    unsigned *bucket;
+    unsigned index;
+    uint16_t seconds;
+
+    index = bbmd_fdt_find(addr);
+    if (index == FDT_NONE) {
+        index = FDT_Free;
+        if (index == FDT_NONE) {
+            return false;
+        }
+        FDT_Free = FDT_Index[index].next;
+        bucket = bbmd_fdt_bucket(addr);
+        FDT_Index[index].next = *bucket;
+        *bucket = index;
+        FDT_Index[index].active = FDT_Count;
+        FDT_Active[FDT_Count] = index;
+        FDT_Count++;
+        fdt_entry = &FD_Table[index];
+        bvlc_address_copy(&fdt_entry->dest_address, addr);
+        fdt_entry->valid = true;
+    } else {
+        bbmd_fdt_timer_remove(index);
+    }
+    /* Upon receipt of a BVLL Register-Foreign-Device message,
+       a BBMD shall start a timer with a value equal to the
+       Time-to-Live parameter supplied plus a fixed grace
+       period of 30 seconds. */
+    if (ttl_seconds < (UINT16_MAX - 30)) {
+        seconds = ttl_seconds + 30;
+    } else {
+        seconds = UINT16_MAX;
+    }
+    FD_Table[index].ttl_seconds = ttl_seconds;
+    FD_Table[index].ttl_seconds_remaining = seconds;
+    bbmd_fdt_timer_add(index, seconds);
+
+    return true;
+}
+
+/**
+ * @brief Clear a foreign device entry, and return it to the free list
+ * @param index - FDT entry index
+ */
+static void bbmd_fdt_remove(unsigned index)
+{
+    BACNET_IP_FOREIGN_DEVICE_TABLE_ENTRY *fdt_entry = &FD_Table[index];
+    unsigned *link;
+    unsigned active, last;
+
+    link = bbmd_fdt_bucket(&fdt_entry->dest_address);
+    while (*link != index) {
+        link = &FDT_Index[*link].next;
+    }
+    *link = FDT_Index[index].next;
+    bbmd_fdt_timer_remove(index);
+    /* move the last registered entry into the hole */
+    active = FDT_Index[index].active;
+    FDT_Count--;
+    last = FDT_Active[FDT_Count];
+    FDT_Active[active] = last;
+    FDT_Index[last].active = active;
+    FDT_Index[index].active = FDT_NONE;
+    /* keep the list link of the entry */
+    fdt_entry->valid = false;
+    memset(&fdt_entry->dest_address, 0, sizeof(fdt_entry->dest_address));
+    fdt_entry->ttl_seconds = 0;
+    fdt_entry->ttl_seconds_remaining = 0;
+    FDT_Index[index].next = FDT_Free;
+    FDT_Free = index;
+}
+
+/**
+ * @brief Set the number of foreign devices that can register.
+ *  The Foreign Device Table is emptied. Call it before bvlc_init() and
+ *  before bvlc_fdt_list(), since the table storage moves.
+ * @param size - number of Foreign Device Table entries
+ * @return true if the storage was allocated
+ */
+bool bvlc_fdt_size_set(unsigned size)
+{
+    BACNET_IP_FOREIGN_DEVICE_TABLE_ENTRY *table = FD_Table_Default;
+    BBMD_FDT_INDEX *index = FDT_Index_Default;
+    unsigned *buckets = FDT_Buckets_Default;
+    unsigned *active = FDT_Active_Default;
+
+    if ((size == 0) || (size >= FDT_NONE)) {
+        return false;
+    }
+    if (size != MAX_FD_ENTRIES) {
+        table = calloc(size, sizeof(BACNET_IP_FOREIGN_DEVICE_TABLE_ENTRY));
+        index = calloc(size, sizeof(BBMD_FDT_INDEX));
+        buckets = calloc(size, sizeof(unsigned));
+        active = calloc(size, sizeof(unsigned));
+        if (!table || !index || !buckets || !active) {
+            free(table);
+            free(index);
+            free(buckets);
+            free(active);
+            return false;
+        }
+    }
+    if (FD_Table != FD_Table_Default) {
+        free(FD_Table);
+        free(FDT_Index);
+        free(FDT_Buckets);
+        free(FDT_Active);
+    }
+    FD_Table = table;
+    FDT_Index = index;
+    FDT_Buckets = buckets;
+    FDT_Active = active;
+    FDT_Size = size;
+    bbmd_fdt_reset();
+
+    return true;
+}
+
+/**
+ * @brief Get the number of foreign devices that can register
+ * @return number of Foreign Device Table entries
+ */
+unsigned bvlc_fdt_size(void)
+{
+    return FDT_Size;
+}
+
+/**
+ * @brief Get the number of registered foreign devices
+ * @return number of valid Foreign Device Table entries
+ */
+unsigned bvlc_fdt_count(void)
+{
+    return FDT_Count;
+}
+#endif
+
 /** A timer function that is called about once a second.
+ * The foreign devices are kept in a timer wheel slot for the second
+ * that their registration expires, so only the slots for the elapsed
+ * seconds are checked, rather than every Foreign Device Table entry.
  *
  * @param seconds - number of elapsed seconds since the last call
  */
 void bvlc_maintenance_timer(uint16_t seconds)
 {
 #if BBMD_ENABLED
-    bvlc_foreign_device_table_maintenance_timer(&FD_Table[0], seconds);
+    unsigned slot = 0;
+    unsigned slots = 0;
+    unsigned index = 0;
+    unsigned next = 0;
+
+    if (seconds == 0) {
+        return;
+    }
+    bbmd_fdt_init_check();
+    /* the slots of the seconds that elapsed, or every slot once */
+    slot = (FDT_Seconds + 1) % BBMD_FDT_TIMER_SLOTS;
+    if (seconds < BBMD_FDT_TIMER_SLOTS) {
+        slots = seconds;
+    } else {
+        slots = BBMD_FDT_TIMER_SLOTS;
+    }
+    if (seconds > (UINT32_MAX - FDT_Seconds)) {
+        FDT_Seconds = UINT32_MAX;
+    } else {
+        FDT_Seconds += seconds;
+    }
+    while (slots > 0) {
+        index = FDT_Timer_Wheel[slot];
+        while (index != FDT_NONE) {
+            next = FDT_Index[index].timer_next;
+            if (FDT_Index[index].expires <= FDT_Seconds) {
+                bbmd_fdt_remove(index);
+            }
+            index = next;
+        }
+        slot = (slot + 1) % BBMD_FDT_TIMER_SLOTS;
+        slots--;
+    }
 #else
     (void)seconds;
 #endif
@@ -351,6 +698,7 @@ static uint16_t bbmd_bdt_forward_npdu(
     uint8_t mtu[BIP_MPDU_MAX] = { 0 };
     uint16_t mtu_len = 0;
     unsigned i = 0; /* loop counter */
+    unsigned dest_count = 0;
     BACNET_IP_ADDRESS bip_dest = { 0 };
     BACNET_IP_ADDRESS my_addr = { 0 };
 
@@ -371,7 +719,7 @@ static uint16_t bbmd_bdt_forward_npdu(
         mtu_len = (uint16_t)bvlc_encode_forwarded_npdu(
             &mtu[0], (uint16_t)sizeof(mtu), bip_src, npdu, npdu_length);
     }
-    /* loop through the BDT and send one to each entry */
+    /* loop through the BDT and list each entry */
     for (i = 0; i < MAX_BBMD_ENTRIES; i++) {
         if (BBMD_Table[i].valid) {
             bvlc_broadcast_distribution_table_entry_forward_address(
@@ -392,10 +740,16 @@ static uint16_t bbmd_bdt_forward_npdu(
                     continue;
                 }
             }
-            bip_send_mpdu(&bip_dest, mtu, mtu_len);
+            bvlc_address_copy(&BBMD_Forward_Address[dest_count], &bip_dest);
+            dest_count++;
             debug_print_bip("BDT Send Forwarded-NPDU", &bip_dest);
         }
     }
+    /* send one to each entry */
+    if (dest_count > 0) {
+        bip_send_mpdu_multiple(
+            &BBMD_Forward_Address[0], dest_count, mtu, mtu_len);
+    }
 
     return mtu_len;
 }
@@ -418,7 +772,8 @@ static uint16_t bbmd_fdt_forward_npdu(
     uint8_t mtu[BIP_MPDU_MAX] = { 0 };
     uint16_t mtu_len = 0;
     unsigned i = 0; /* loop counter */
-    BACNET_IP_ADDRESS bip_dest = { 0 };
+    unsigned dest_count = 0;
+    const BACNET_IP_ADDRESS *bip_dest = NULL;
     BACNET_IP_ADDRESS my_addr = { 0 };
 
     bip_get_addr(&my_addr);
@@ -439,29 +794,39 @@ static uint16_t bbmd_fdt_forward_npdu(
             &mtu[0], (uint16_t)sizeof(mtu), bip_src, npdu, npdu_length);
     }
 
-    /* loop through the FDT and send one to each entry */
-    for (i = 0; i < MAX_FD_ENTRIES; i++) {
-        if (FD_Table[i].valid && FD_Table[i].ttl_seconds_remaining) {
-            bvlc_address_copy(&bip_dest, &FD_Table[i].dest_address);
-            if (!bvlc_address_different(&bip_dest, &my_addr)) {
-                /* don't forward to our selves */
-                continue;
-            }
-            if (!bvlc_address_different(&bip_dest, bip_src)) {
-                /* don't forward back to origin */
+    /* loop through the registered foreign devices */
+    bbmd_fdt_init_check();
+    for (i = 0; i < FDT_Count; i++) {
+        bip_dest = &FD_Table[FDT_Active[i]].dest_address;
+        if (!bvlc_address_different(bip_dest, &my_addr)) {
+            /* don't forward to our selves */
+            continue;
+        }
+        if (!bvlc_address_different(bip_dest, bip_src)) {
+            /* don't forward back to origin */
+            continue;
+        }
+        if (BVLC_NAT_Handling) {
+            if (bvlc_address_different(bip_dest, &BVLC_Global_Address)) {
+                /* NAT router port forwards BACnet packets from global IP.
+                   Packets sent to that global IP by us would end up back,
+                   creating a loop. */
                 continue;
             }
-            if (BVLC_NAT_Handling) {
-                if (bvlc_address_different(&bip_dest, &BVLC_Global_Address)) {
-                    /* NAT router port forwards BACnet packets from global IP.
-                       Packets sent to that global IP by us would end up back,
-                       creating a loop. */
-                    continue;
-                }
-            }
-            bip_send_mpdu(&bip_dest, mtu, mtu_len);
-            debug_print_bip("FDT Send Forwarded-NPDU", &bip_dest);
         }
+        bvlc_address_copy(&BBMD_Forward_Address[dest_count], bip_dest);
+        dest_count++;
+        debug_print_bip("FDT Send Forwarded-NPDU", bip_dest);
+        if (dest_count == BBMD_FORWARD_MAX) {
+            bip_send_mpdu_multiple(
+                &BBMD_Forward_Address[0], dest_count, mtu, mtu_len);
+            dest_count = 0;
+        }
+    }
+    /* send one to each entry */
+    if (dest_count > 0) {
+        bip_send_mpdu_multiple(
+            &BBMD_Forward_Address[0], dest_count, mtu, mtu_len);
     }
 
     return mtu_len;
@@ -854,6 +1219,7 @@ int bvlc_bbmd_enabled_handler(
     uint16_t ttl_seconds = 0;
     BACNET_IP_ADDRESS fwd_address = { 0 };
     BACNET_IP_ADDRESS broadcast_address = { 0 };
+    unsigned index = 0;
 
     header_len =
         bvlc_decode_header(mtu, mtu_len, &message_type, &message_length);
@@ -974,8 +1340,7 @@ int bvlc_bbmd_enabled_handler(
             function_len =
                 bvlc_decode_register_foreign_device(pdu, pdu_len, &ttl_seconds);
             if (function_len) {
-                if (bvlc_foreign_device_table_entry_add(
-                        &FD_Table[0], addr, ttl_seconds)) {
+                if (bbmd_fdt_add(addr, ttl_seconds)) {
                     result_code = BVLC_RESULT_SUCCESSFUL_COMPLETION;
                     send_result = true;
                 } else {
@@ -995,6 +1360,7 @@ int bvlc_bbmd_enabled_handler(
                it shall return a BVLC-Result message to the originating device
                with a result code of X'0040' indicating that the read attempt
                has failed. */
+            bvlc_fdt_remaining_update();
             BVLC_Buffer_Len = bvlc_encode_read_foreign_device_table_ack(
                 BVLC_Buffer, sizeof(BVLC_Buffer), &FD_Table[0]);
             if (BVLC_Buffer_Len > 0) {
@@ -1025,8 +1391,9 @@ int bvlc_bbmd_enabled_handler(
             function_len =
                 bvlc_decode_delete_foreign_device(pdu, pdu_len, &fwd_address);
             if (function_len > 0) {
-                if (bvlc_foreign_device_table_entry_delete(
-                        &FD_Table[0], &fwd_address)) {
+                index = bbmd_fdt_find(&fwd_address);
+                if (index != FDT_NONE) {
+                    bbmd_fdt_remove(index);
                     result_code = BVLC_RESULT_SUCCESSFUL_COMPLETION;
                     send_result = true;
                 } else {
@@ -1341,9 +1708,28 @@ void bvlc_set_function_code(uint8_t function_code)
  */
 BACNET_IP_FOREIGN_DEVICE_TABLE_ENTRY *bvlc_fdt_list(void)
 {
+    bvlc_fdt_remaining_update();
+
     return &FD_Table[0];
 }
 
+/**
+ * @brief Update the seconds remaining of the registered foreign devices
+ *  from their expiry second. The timer wheel does not count them down,
+ *  so call this before the table is read, as Read-FDT does.
+ */
+void bvlc_fdt_remaining_update(void)
+{
+    unsigned i, index;
+
+    bbmd_fdt_init_check();
+    for (i = 0; i < FDT_Count; i++) {
+        index = FDT_Active[i];
+        FD_Table[index].ttl_seconds_remaining =
+            (uint16_t)(FDT_Index[index].expires - FDT_Seconds);
+    }
+}
+
 /**
  * @brief Get handle to broadcast distribution table (BDT).
  * @return pointer to first entry of broadcast distribution table
@@ -1401,7 +1787,7 @@ void bvlc_init(void)
     debug_print_string("Initializing (BBMD Enabled).");
     bvlc_broadcast_distribution_table_link_array(
         &BBMD_Table[0], MAX_BBMD_ENTRIES);
-    bvlc_foreign_device_table_link_array(&FD_Table[0], MAX_FD_ENTRIES);
+    bbmd_fdt_reset();
 #else
     debug_print_string("Initializing (BBMD Disabled).");
 #endif
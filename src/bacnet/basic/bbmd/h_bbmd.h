@@ -113,6 +113,18 @@ void bvlc_bdt_list_clear(void);
 
 /* Get foreign device table list */
 BACNET_IP_FOREIGN_DEVICE_TABLE_ENTRY *bvlc_fdt_list(void);
+/* Update the seconds remaining of the foreign device table list */
+BACNET_STACK_EXPORT
+void bvlc_fdt_remaining_update(void);
+
+/* Set, and get, the number of foreign devices that can register */
+BACNET_STACK_EXPORT
+bool bvlc_fdt_size_set(unsigned size);
+BACNET_STACK_EXPORT
+unsigned bvlc_fdt_size(void);
+/* Get the number of registered foreign devices */
+BACNET_STACK_EXPORT
+unsigned bvlc_fdt_count(void);
 
 /* Backup broadcast distribution table to a file.
  * Filename is the BBMD_BACKUP_FILE constant
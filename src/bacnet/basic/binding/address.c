@@ -40,14 +40,50 @@ static uint32_t Own_Device_ID = 0xFFFFFFFF;
 #if !defined(MAX_ADDRESS_CACHE)
 #define MAX_ADDRESS_CACHE 255
 #endif
+/* number of one second slots in the time-to-live timer wheel */
+#if !defined(BACNET_ADDRESS_CACHE_TIMER_SLOTS)
+#define BACNET_ADDRESS_CACHE_TIMER_SLOTS 256
+#endif
+
+/* end of a list of entries */
+#define ADDRESS_CACHE_NONE UINT32_MAX
 
-static struct Address_Cache_Entry {
+struct Address_Cache_Entry {
     uint8_t Flags;
     uint32_t device_id;
     unsigned max_apdu;
     BACNET_ADDRESS address;
-    uint32_t TimeToLive;
-} Address_Cache[MAX_ADDRESS_CACHE];
+    /* time, in Address_Cache_Seconds, when the entry expires */
+    uint32_t Expires;
+    /* next entry in the same device-id or address hash bucket */
+    uint32_t next_device;
+    uint32_t next_address;
+    /* least recently used list, or the free list */
+    uint32_t lru_prev;
+    uint32_t lru_next;
+    /* timer wheel slot list */
+    uint32_t timer_prev;
+    uint32_t timer_next;
+};
+
+/* default storage, which may be replaced using address_cache_size_set() */
+static struct Address_Cache_Entry Address_Cache_Default[MAX_ADDRESS_CACHE];
+static uint32_t Address_Device_Hash_Default[MAX_ADDRESS_CACHE];
+static uint32_t Address_MAC_Hash_Default[MAX_ADDRESS_CACHE];
+static struct Address_Cache_Entry *Address_Cache = Address_Cache_Default;
+static uint32_t *Address_Device_Hash = Address_Device_Hash_Default;
+static uint32_t *Address_MAC_Hash = Address_MAC_Hash_Default;
+static uint32_t Address_Cache_Size = MAX_ADDRESS_CACHE;
+/* most recently used entry is the head, least recently used is the tail */
+static uint32_t Address_LRU_Head = ADDRESS_CACHE_NONE;
+static uint32_t Address_LRU_Tail = ADDRESS_CACHE_NONE;
+/* entries that are not in use */
+static uint32_t Address_Free_Head = ADDRESS_CACHE_NONE;
+/* entries with a time-to-live, by the second in which they expire */
+static uint32_t Address_Timer_Wheel[BACNET_ADDRESS_CACHE_TIMER_SLOTS];
+static uint32_t Address_Cache_Seconds;
+/* true once the indexes have been built */
+static bool Address_Cache_Indexed;
 
 /* State flags for cache entries */
 
@@ -59,6 +95,10 @@ static struct Address_Cache_Entry {
 #define BAC_ADDR_STATIC BIT(2)
 /* Opportunistically added address with short TTL */
 #define BAC_ADDR_SHORT_TTL BIT(3)
+/* Address is in the address hash index */
+#define BAC_ADDR_HASHED BIT(4)
+/* Entry is in the timer wheel */
+#define BAC_ADDR_TIMER BIT(5)
 /* Freed up but held for caller to fill */
 #define BAC_ADDR_RESERVED BIT(7)
 
@@ -70,119 +110,490 @@ static struct Address_Cache_Entry {
 #define BAC_ADDR_FOREVER 0xFFFFFFFF /* Permanent entry */
 
 /**
- * @brief Set the index of the first (top) address being protected.
- *
- * @param top_protected_entry_index  top protected index [0..n-1]
+ * @brief Hash a device instance into a bucket of the device-id index
+ * @param device_id  ID of the device
+ * @return bucket index
  */
-void address_protected_entry_index_set(uint32_t top_protected_entry_index)
+static uint32_t address_device_hash(uint32_t device_id)
 {
-    if (top_protected_entry_index <= (MAX_ADDRESS_CACHE - 1)) {
-        Top_Protected_Entry = top_protected_entry_index;
+    return (device_id * 2654435761UL) % Address_Cache_Size;
+}
+
+/**
+ * @brief Hash an address into a bucket of the address index, using
+ *  the same fields that bacnet_address_same() compares.
+ * @param src  Pointer to the BACnet address
+ * @return bucket index
+ */
+static uint32_t address_mac_hash(const BACNET_ADDRESS *src)
+{
+    uint32_t hash = 2166136261UL;
+    uint8_t i;
+
+    hash = (hash ^ src->mac_len) * 16777619UL;
+    for (i = 0; (i < src->mac_len) && (i < MAX_MAC_LEN); i++) {
+        hash = (hash ^ src->mac[i]) * 16777619UL;
+    }
+    hash = (hash ^ (src->net & 0xFF)) * 16777619UL;
+    hash = (hash ^ (src->net >> 8)) * 16777619UL;
+    if (src->net) {
+        hash = (hash ^ src->len) * 16777619UL;
+        for (i = 0; (i < src->len) && (i < MAX_MAC_LEN); i++) {
+            hash = (hash ^ src->adr[i]) * 16777619UL;
+        }
     }
+
+    return hash % Address_Cache_Size;
 }
 
 /**
- * @brief Set the address of our own device.
- *
- * @param own_id  Own device id
+ * @brief Remove an entry from a singly linked hash bucket
+ * @param head  Pointer to the bucket head
+ * @param index  Table index of the entry to remove
+ * @param address  true for the address links, false for the device links
  */
-void address_own_device_id_set(uint32_t own_id)
+static void address_hash_unlink(uint32_t *head, uint32_t index, bool address)
 {
-    Own_Device_ID = own_id;
+    uint32_t *link = head;
+    struct Address_Cache_Entry *pMatch;
+
+    while (*link != ADDRESS_CACHE_NONE) {
+        pMatch = &Address_Cache[*link];
+        if (*link == index) {
+            *link = address ? pMatch->next_address : pMatch->next_device;
+            break;
+        }
+        link = address ? &pMatch->next_address : &pMatch->next_device;
+    }
 }
 
 /**
- * @brief Remove a device from the address list.
- *
+ * @brief Move an in-use entry to the head of the least recently used list
+ * @param index  Table index of the entry
+ * @param linked  true if the entry is already in the list
+ */
+static void address_lru_touch(uint32_t index, bool linked)
+{
+    struct Address_Cache_Entry *pMatch = &Address_Cache[index];
+
+    if (linked) {
+        if (Address_LRU_Head == index) {
+            return;
+        }
+        /* unlink */
+        if (pMatch->lru_prev != ADDRESS_CACHE_NONE) {
+            Address_Cache[pMatch->lru_prev].lru_next = pMatch->lru_next;
+        }
+        if (pMatch->lru_next != ADDRESS_CACHE_NONE) {
+            Address_Cache[pMatch->lru_next].lru_prev = pMatch->lru_prev;
+        } else {
+            Address_LRU_Tail = pMatch->lru_prev;
+        }
+    }
+    pMatch->lru_prev = ADDRESS_CACHE_NONE;
+    pMatch->lru_next = Address_LRU_Head;
+    if (Address_LRU_Head != ADDRESS_CACHE_NONE) {
+        Address_Cache[Address_LRU_Head].lru_prev = index;
+    } else {
+        Address_LRU_Tail = index;
+    }
+    Address_LRU_Head = index;
+}
+
+/**
+ * @brief Remove an entry from the least recently used list
+ * @param index  Table index of the entry
+ */
+static void address_lru_unlink(uint32_t index)
+{
+    struct Address_Cache_Entry *pMatch = &Address_Cache[index];
+
+    if (pMatch->lru_prev != ADDRESS_CACHE_NONE) {
+        Address_Cache[pMatch->lru_prev].lru_next = pMatch->lru_next;
+    } else {
+        Address_LRU_Head = pMatch->lru_next;
+    }
+    if (pMatch->lru_next != ADDRESS_CACHE_NONE) {
+        Address_Cache[pMatch->lru_next].lru_prev = pMatch->lru_prev;
+    } else {
+        Address_LRU_Tail = pMatch->lru_prev;
+    }
+}
+
+/**
+ * @brief Remove an entry from its timer wheel slot
+ * @param index  Table index of the entry
+ */
+static void address_timer_unlink(uint32_t index)
+{
+    struct Address_Cache_Entry *pMatch = &Address_Cache[index];
+    uint32_t slot;
+
+    if ((pMatch->Flags & BAC_ADDR_TIMER) == 0) {
+        return;
+    }
+    if (pMatch->timer_prev != ADDRESS_CACHE_NONE) {
+        Address_Cache[pMatch->timer_prev].timer_next = pMatch->timer_next;
+    } else {
+        slot = (pMatch->Expires + 1) % BACNET_ADDRESS_CACHE_TIMER_SLOTS;
+        Address_Timer_Wheel[slot] = pMatch->timer_next;
+    }
+    if (pMatch->timer_next != ADDRESS_CACHE_NONE) {
+        Address_Cache[pMatch->timer_next].timer_prev = pMatch->timer_prev;
+    }
+    pMatch->Flags &= ~BAC_ADDR_TIMER;
+}
+
+/**
+ * @brief Get the remaining time-to-live of an entry
+ * @param pMatch  Pointer to the entry
+ * @return time-to-live in seconds
+ */
+static uint32_t address_ttl(const struct Address_Cache_Entry *pMatch)
+{
+    if ((pMatch->Flags & BAC_ADDR_TIMER) == 0) {
+        return BAC_ADDR_FOREVER;
+    }
+    if (pMatch->Expires < Address_Cache_Seconds) {
+        return 0;
+    }
+
+    return pMatch->Expires - Address_Cache_Seconds;
+}
+
+/**
+ * @brief Set the time-to-live of an entry. The entry is placed in the
+ *  timer wheel slot of the second after it expires. Static entries
+ *  and entries that live forever are not in the timer wheel.
+ * @param index  Table index of the entry
+ * @param seconds  time-to-live in seconds
+ */
+static void address_ttl_set(uint32_t index, uint32_t seconds)
+{
+    struct Address_Cache_Entry *pMatch = &Address_Cache[index];
+    uint32_t slot;
+
+    address_timer_unlink(index);
+    if (((pMatch->Flags & BAC_ADDR_STATIC) != 0) ||
+        (seconds == BAC_ADDR_FOREVER)) {
+        return;
+    }
+    if (seconds > (BAC_ADDR_FOREVER - 1 - Address_Cache_Seconds)) {
+        pMatch->Expires = BAC_ADDR_FOREVER - 1;
+    } else {
+        pMatch->Expires = Address_Cache_Seconds + seconds;
+    }
+    slot = (pMatch->Expires + 1) % BACNET_ADDRESS_CACHE_TIMER_SLOTS;
+    pMatch->timer_prev = ADDRESS_CACHE_NONE;
+    pMatch->timer_next = Address_Timer_Wheel[slot];
+    if (pMatch->timer_next != ADDRESS_CACHE_NONE) {
+        Address_Cache[pMatch->timer_next].timer_prev = index;
+    }
+    Address_Timer_Wheel[slot] = index;
+    pMatch->Flags |= BAC_ADDR_TIMER;
+}
+
+/**
+ * @brief Store the address of an entry and index it
+ * @param index  Table index of the entry
+ * @param src  Pointer to the BACnet address
+ */
+static void
+address_entry_address_set(uint32_t index, const BACNET_ADDRESS *src)
+{
+    struct Address_Cache_Entry *pMatch = &Address_Cache[index];
+    uint32_t bucket;
+
+    if ((pMatch->Flags & BAC_ADDR_HASHED) != 0) {
+        bucket = address_mac_hash(&pMatch->address);
+        address_hash_unlink(&Address_MAC_Hash[bucket], index, true);
+    }
+    bacnet_address_copy(&pMatch->address, src);
+    bucket = address_mac_hash(&pMatch->address);
+    pMatch->next_address = Address_MAC_Hash[bucket];
+    Address_MAC_Hash[bucket] = index;
+    pMatch->Flags |= BAC_ADDR_HASHED;
+}
+
+/**
+ * @brief Return an entry to the free list, removing it from all indexes
+ * @param index  Table index of the entry
+ */
+static void address_entry_free(uint32_t index)
+{
+    struct Address_Cache_Entry *pMatch = &Address_Cache[index];
+    uint32_t bucket;
+
+    if ((pMatch->Flags & BAC_ADDR_IN_USE) != 0) {
+        bucket = address_device_hash(pMatch->device_id);
+        address_hash_unlink(&Address_Device_Hash[bucket], index, false);
+        address_lru_unlink(index);
+    }
+    if ((pMatch->Flags & BAC_ADDR_HASHED) != 0) {
+        bucket = address_mac_hash(&pMatch->address);
+        address_hash_unlink(&Address_MAC_Hash[bucket], index, true);
+    }
+    address_timer_unlink(index);
+    if (pMatch->Flags != 0) {
+        pMatch->Flags = 0;
+        pMatch->lru_next = Address_Free_Head;
+        Address_Free_Head = index;
+    }
+}
+
+/**
+ * @brief Find the entry of a device, bound or with a bind request.
  * @param device_id  ID of the device
+ * @return table index of the entry, or ADDRESS_CACHE_NONE
  */
-void address_remove_device(uint32_t device_id)
+static uint32_t address_device_find(uint32_t device_id)
 {
-    struct Address_Cache_Entry *pMatch;
-    uint32_t index = 0;
+    uint32_t index;
 
-    for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
-        pMatch = &Address_Cache[index];
-        if (((pMatch->Flags & BAC_ADDR_IN_USE) != 0) &&
-            (pMatch->device_id == device_id)) {
-            pMatch->Flags = 0;
-            if (index < Top_Protected_Entry) {
-                Top_Protected_Entry--;
-            }
+    index = Address_Device_Hash[address_device_hash(device_id)];
+    while (index != ADDRESS_CACHE_NONE) {
+        if (Address_Cache[index].device_id == device_id) {
             break;
         }
+        index = Address_Cache[index].next_device;
     }
 
-    return;
+    return index;
 }
 
 /**
- * @brief Search the cache for the entry nearest expiry and delete it. Mark the
- * entry as reserved with a 1 hour TTL and return a pointer to the reserved
- * entry. Will not delete a static entry and returns NULL pointer if no
- * entry available to free up. Does not check for free entries as it is
- * assumed we are calling this due to the lack of those.
+ * @brief Search the least recently used entries for one to evict and free
+ * it. Static and protected entries are never evicted. Bound entries are
+ * evicted before entries with a bind request outstanding.
  *
- * @return Pointer to the entry that has been removed or NULL.
+ * @return true if an entry was freed
  */
-static struct Address_Cache_Entry *address_remove_oldest(void)
+static bool address_remove_oldest(void)
 {
+    uint32_t index;
     struct Address_Cache_Entry *pMatch;
-    struct Address_Cache_Entry *pCandidate;
-    uint32_t ulTime;
-    unsigned index;
 
-    pCandidate = NULL;
-    if (Top_Protected_Entry > (MAX_ADDRESS_CACHE - 1)) {
-        return pCandidate;
+    if (Top_Protected_Entry > (Address_Cache_Size - 1)) {
+        return false;
     }
-    /* Longest possible non static time to live */
-    ulTime = BAC_ADDR_FOREVER - 1;
-
     /* First pass - try only in use and bound entries */
-
-    for (index = Top_Protected_Entry; index < MAX_ADDRESS_CACHE; index++) {
+    for (index = Address_LRU_Tail; index != ADDRESS_CACHE_NONE;
+         index = pMatch->lru_prev) {
+        pMatch = &Address_Cache[index];
+        if ((index >= Top_Protected_Entry) &&
+            ((pMatch->Flags &
+              (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ | BAC_ADDR_STATIC)) ==
+             BAC_ADDR_IN_USE)) {
+            address_entry_free(index);
+            return true;
+        }
+    }
+    /* Second pass - try in use and un bound as last resort */
+    for (index = Address_LRU_Tail; index != ADDRESS_CACHE_NONE;
+         index = pMatch->lru_prev) {
         pMatch = &Address_Cache[index];
         if ((pMatch->Flags &
              (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ | BAC_ADDR_STATIC)) ==
-            BAC_ADDR_IN_USE) {
-            if (pMatch->TimeToLive <= ulTime) {
-                /* Shorter lived entry found */
-                ulTime = pMatch->TimeToLive;
-                pCandidate = pMatch;
-            }
+            ((uint8_t)(BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ))) {
+            address_entry_free(index);
+            return true;
         }
     }
 
-    if (pCandidate != NULL) {
-        /* Found something to free up */
-        pCandidate->Flags = BAC_ADDR_RESERVED;
-        /* only reserve it for a short while */
-        pCandidate->TimeToLive = BAC_ADDR_SHORT_TIME;
-        return (pCandidate);
+    return false;
+}
+
+/**
+ * @brief Take a free entry for a device, evicting the least recently
+ * used entry if the cache is full.
+ * @param device_id  ID of the device
+ * @param flags  initial flags for the entry
+ * @return table index of the entry, or ADDRESS_CACHE_NONE
+ */
+static uint32_t address_entry_new(uint32_t device_id, uint8_t flags)
+{
+    struct Address_Cache_Entry *pMatch;
+    uint32_t index;
+    uint32_t bucket;
+
+    if (Address_Free_Head == ADDRESS_CACHE_NONE) {
+        (void)address_remove_oldest();
+    }
+    index = Address_Free_Head;
+    if (index != ADDRESS_CACHE_NONE) {
+        pMatch = &Address_Cache[index];
+        Address_Free_Head = pMatch->lru_next;
+        pMatch->Flags = flags | BAC_ADDR_IN_USE;
+        pMatch->device_id = device_id;
+        bucket = address_device_hash(device_id);
+        pMatch->next_device = Address_Device_Hash[bucket];
+        Address_Device_Hash[bucket] = index;
+        address_lru_touch(index, false);
     }
 
-    /* Second pass - try in use and un bound as last resort */
-    for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
+    return index;
+}
+
+/**
+ * @brief Rebuild the hash indexes, least recently used list, free list,
+ * and timer wheel from the entry flags.
+ */
+static void address_index_rebuild(void)
+{
+    struct Address_Cache_Entry *pMatch;
+    uint32_t index;
+    uint32_t ttl;
+    uint8_t flags;
+
+    for (index = 0; index < Address_Cache_Size; index++) {
+        Address_Device_Hash[index] = ADDRESS_CACHE_NONE;
+        Address_MAC_Hash[index] = ADDRESS_CACHE_NONE;
+    }
+    for (index = 0; index < BACNET_ADDRESS_CACHE_TIMER_SLOTS; index++) {
+        Address_Timer_Wheel[index] = ADDRESS_CACHE_NONE;
+    }
+    Address_LRU_Head = ADDRESS_CACHE_NONE;
+    Address_LRU_Tail = ADDRESS_CACHE_NONE;
+    Address_Free_Head = ADDRESS_CACHE_NONE;
+    Address_Cache_Indexed = true;
+    /* lowest free entries are used first */
+    index = Address_Cache_Size;
+    while (index > 0) {
+        index--;
         pMatch = &Address_Cache[index];
-        if ((pMatch->Flags &
-             (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ | BAC_ADDR_STATIC)) ==
-            ((uint8_t)(BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ))) {
-            if (pMatch->TimeToLive <= ulTime) { /* Shorter lived entry found */
-                ulTime = pMatch->TimeToLive;
-                pCandidate = pMatch;
-            }
+        flags = pMatch->Flags;
+        if ((flags & BAC_ADDR_IN_USE) == 0) {
+            pMatch->Flags = 0;
+            pMatch->lru_next = Address_Free_Head;
+            Address_Free_Head = index;
+            continue;
         }
+        ttl = BAC_ADDR_FOREVER;
+        if ((flags & BAC_ADDR_TIMER) != 0) {
+            ttl = address_ttl(pMatch);
+        }
+        pMatch->Flags = flags & ~(BAC_ADDR_IN_USE | BAC_ADDR_HASHED |
+                                  BAC_ADDR_TIMER);
+        pMatch->Flags |= BAC_ADDR_IN_USE;
+        pMatch->next_device =
+            Address_Device_Hash[address_device_hash(pMatch->device_id)];
+        Address_Device_Hash[address_device_hash(pMatch->device_id)] = index;
+        address_lru_touch(index, false);
+        if ((flags & BAC_ADDR_HASHED) != 0) {
+            pMatch->Flags |= BAC_ADDR_HASHED;
+            pMatch->next_address =
+                Address_MAC_Hash[address_mac_hash(&pMatch->address)];
+            Address_MAC_Hash[address_mac_hash(&pMatch->address)] = index;
+        }
+        address_ttl_set(index, ttl);
+    }
+}
+
+/**
+ * @brief Build the indexes if the cache is used before address_init()
+ */
+static void address_index_check(void)
+{
+    if (!Address_Cache_Indexed) {
+        address_index_rebuild();
+    }
+}
+
+/**
+ * @brief Set the number of entries in the address cache. The cache is
+ * cleared. Sizes other than MAX_ADDRESS_CACHE are allocated from the heap.
+ *
+ * @param size  number of devices that can be bound, greater than zero
+ * @return true if the cache was resized
+ */
+bool address_cache_size_set(unsigned size)
+{
+    struct Address_Cache_Entry *cache = Address_Cache_Default;
+    uint32_t *device_hash = Address_Device_Hash_Default;
+    uint32_t *mac_hash = Address_MAC_Hash_Default;
+
+    if ((size == 0) || (size >= ADDRESS_CACHE_NONE)) {
+        return false;
+    }
+    if (size != MAX_ADDRESS_CACHE) {
+        cache = calloc(size, sizeof(struct Address_Cache_Entry));
+        device_hash = calloc(size, sizeof(uint32_t));
+        mac_hash = calloc(size, sizeof(uint32_t));
+        if (!cache || !device_hash || !mac_hash) {
+            free(cache);
+            free(device_hash);
+            free(mac_hash);
+            return false;
+        }
+    }
+    if (Address_Cache != Address_Cache_Default) {
+        free(Address_Cache);
+        free(Address_Device_Hash);
+        free(Address_MAC_Hash);
+    }
+    Address_Cache = cache;
+    Address_Device_Hash = device_hash;
+    Address_MAC_Hash = mac_hash;
+    Address_Cache_Size = size;
+    Top_Protected_Entry = 0;
+    for (size = 0; size < Address_Cache_Size; size++) {
+        Address_Cache[size].Flags = 0;
+    }
+    address_index_rebuild();
+
+    return true;
+}
+
+/**
+ * @brief Get the number of entries in the address cache
+ * @return number of devices that can be bound
+ */
+unsigned address_cache_size(void)
+{
+    return Address_Cache_Size;
+}
+
+/**
+ * @brief Set the index of the first (top) address being protected.
+ *
+ * @param top_protected_entry_index  top protected index [0..n-1]
+ */
+void address_protected_entry_index_set(uint32_t top_protected_entry_index)
+{
+    if (top_protected_entry_index <= (Address_Cache_Size - 1)) {
+        Top_Protected_Entry = top_protected_entry_index;
     }
+}
 
-    if (pCandidate != NULL) {
-        /* Found something to free up */
-        pCandidate->Flags = BAC_ADDR_RESERVED;
-        /* only reserve it for a short while */
-        pCandidate->TimeToLive = BAC_ADDR_SHORT_TIME;
+/**
+ * @brief Set the address of our own device.
+ *
+ * @param own_id  Own device id
+ */
+void address_own_device_id_set(uint32_t own_id)
+{
+    Own_Device_ID = own_id;
+}
+
+/**
+ * @brief Remove a device from the address list.
+ *
+ * @param device_id  ID of the device
+ */
+void address_remove_device(uint32_t device_id)
+{
+    uint32_t index;
+
+    address_index_check();
+    index = address_device_find(device_id);
+    if (index != ADDRESS_CACHE_NONE) {
+        address_entry_free(index);
+        if (index < Top_Protected_Entry) {
+            Top_Protected_Entry--;
+        }
     }
 
-    return (pCandidate);
+    return;
 }
 
 #ifdef BACNET_ADDRESS_CACHE_FILE
@@ -254,14 +665,13 @@ static void address_file_init(const char *pFilename)
  */
 void address_init(void)
 {
-    struct Address_Cache_Entry *pMatch;
     unsigned index;
 
     Top_Protected_Entry = 0;
-    for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
-        pMatch = &Address_Cache[index];
-        pMatch->Flags = 0;
+    for (index = 0; index < Address_Cache_Size; index++) {
+        Address_Cache[index].Flags = 0;
     }
+    address_index_rebuild();
 #ifdef BACNET_ADDRESS_CACHE_FILE
     address_file_init(Address_Cache_Filename);
 #endif
@@ -280,12 +690,12 @@ void address_init_partial(void)
     struct Address_Cache_Entry *pMatch;
     unsigned index;
 
-    for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
+    for (index = 0; index < Address_Cache_Size; index++) {
         pMatch = &Address_Cache[index];
         if ((pMatch->Flags & BAC_ADDR_IN_USE) != 0) {
             /* It's in use so let's check further */
             if (((pMatch->Flags & BAC_ADDR_BIND_REQ) != 0) ||
-                (pMatch->TimeToLive == 0)) {
+                (address_ttl(pMatch) == 0)) {
                 pMatch->Flags = 0;
             }
         }
@@ -295,6 +705,7 @@ void address_init_partial(void)
             pMatch->Flags = 0;
         }
     }
+    address_index_rebuild();
 #ifdef BACNET_ADDRESS_CACHE_FILE
     address_file_init(Address_Cache_Filename);
 #endif
@@ -316,26 +727,24 @@ void address_set_device_TTL(
     uint32_t device_id, uint32_t TimeOut, bool StaticFlag)
 {
     struct Address_Cache_Entry *pMatch;
-    unsigned index;
+    uint32_t index;
 
-    for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
+    address_index_check();
+    index = address_device_find(device_id);
+    if (index != ADDRESS_CACHE_NONE) {
         pMatch = &Address_Cache[index];
-        if (((pMatch->Flags & BAC_ADDR_IN_USE) != 0) &&
-            (pMatch->device_id == device_id)) {
-            if ((pMatch->Flags & BAC_ADDR_BIND_REQ) == 0) {
-                /* If bound then we have either static or normaal */
-                if (StaticFlag) {
-                    pMatch->Flags |= BAC_ADDR_STATIC;
-                    pMatch->TimeToLive = BAC_ADDR_FOREVER;
-                } else {
-                    pMatch->Flags &= ~BAC_ADDR_STATIC;
-                    pMatch->TimeToLive = TimeOut;
-                }
+        if ((pMatch->Flags & BAC_ADDR_BIND_REQ) == 0) {
+            /* If bound then we have either static or normaal */
+            if (StaticFlag) {
+                pMatch->Flags |= BAC_ADDR_STATIC;
+                address_ttl_set(index, BAC_ADDR_FOREVER);
             } else {
-                /* For unbound we can only set the time to live */
-                pMatch->TimeToLive = TimeOut;
+                pMatch->Flags &= ~BAC_ADDR_STATIC;
+                address_ttl_set(index, TimeOut);
             }
-            break; /* Exit now if found at all - bound or unbound */
+        } else {
+            /* For unbound we can only set the time to live */
+            address_ttl_set(index, TimeOut);
         }
     }
 }
@@ -352,23 +761,21 @@ bool address_get_by_device(
 {
     struct Address_Cache_Entry *pMatch;
     bool found = false; /* return value */
-    unsigned index;
+    uint32_t index;
 
-    for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
+    address_index_check();
+    index = address_device_find(device_id);
+    if (index != ADDRESS_CACHE_NONE) {
         pMatch = &Address_Cache[index];
-        if (((pMatch->Flags & BAC_ADDR_IN_USE) != 0) &&
-            (pMatch->device_id == device_id)) {
-            if ((pMatch->Flags & BAC_ADDR_BIND_REQ) == 0) {
-                /* If bound then fetch data */
-                bacnet_address_copy(src, &pMatch->address);
-                if (max_apdu) {
-                    *max_apdu = pMatch->max_apdu;
-                }
-                /* Prove we found it */
-                found = true;
+        if ((pMatch->Flags & BAC_ADDR_BIND_REQ) == 0) {
+            /* If bound then fetch data */
+            bacnet_address_copy(src, &pMatch->address);
+            if (max_apdu) {
+                *max_apdu = pMatch->max_apdu;
             }
-            /* Exit now if found at all - bound or unbound */
-            break;
+            address_lru_touch(index, true);
+            /* Prove we found it */
+            found = true;
         }
     }
 
@@ -386,25 +793,33 @@ bool address_get_by_device(
 bool address_get_device_id(const BACNET_ADDRESS *src, uint32_t *device_id)
 {
     struct Address_Cache_Entry *pMatch;
-    bool found = false; /* return value */
-    unsigned index;
+    uint32_t match = ADDRESS_CACHE_NONE;
+    uint32_t index;
 
-    for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
+    if (!src) {
+        return false;
+    }
+    address_index_check();
+    index = Address_MAC_Hash[address_mac_hash(src)];
+    while (index != ADDRESS_CACHE_NONE) {
         pMatch = &Address_Cache[index];
-        if ((pMatch->Flags & (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ)) ==
-            BAC_ADDR_IN_USE) {
-            /* If bound */
-            if (bacnet_address_same(&pMatch->address, src)) {
-                if (device_id) {
-                    *device_id = pMatch->device_id;
-                }
-                found = true;
-                break;
-            }
+        /* If bound - and use the first entry in the table */
+        if (((pMatch->Flags & (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ)) ==
+             BAC_ADDR_IN_USE) &&
+            (index < match) && bacnet_address_same(&pMatch->address, src)) {
+            match = index;
         }
+        index = pMatch->next_address;
+    }
+    if (match == ADDRESS_CACHE_NONE) {
+        return false;
     }
+    if (device_id) {
+        *device_id = Address_Cache[match].device_id;
+    }
+    address_lru_touch(match, true);
 
-    return found;
+    return true;
 }
 
 /**
@@ -417,13 +832,13 @@ bool address_get_device_id(const BACNET_ADDRESS *src, uint32_t *device_id)
 void address_add(
     uint32_t device_id, unsigned max_apdu, const BACNET_ADDRESS *src)
 {
-    bool found = false; /* return value */
     struct Address_Cache_Entry *pMatch;
-    unsigned index;
+    uint32_t index;
 
     if (Own_Device_ID == device_id) {
         return;
     }
+    address_index_check();
 
     /* Note: Previously this function would ignore bind request
        marked entries and in fact would probably overwrite the first
@@ -432,61 +847,40 @@ void address_add(
        bind request if it exists */
 
     /* existing device or bind request outstanding - update address */
-    for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
+    index = address_device_find(device_id);
+    if (index != ADDRESS_CACHE_NONE) {
         pMatch = &Address_Cache[index];
         /* Device already in the list, then update the values. */
-        if (((pMatch->Flags & BAC_ADDR_IN_USE) != 0) &&
-            (pMatch->device_id == device_id)) {
-            bacnet_address_copy(&pMatch->address, src);
-            pMatch->max_apdu = max_apdu;
-            /* Pick the right time to live */
-            if ((pMatch->Flags & BAC_ADDR_BIND_REQ) != 0) {
-                /* Bind requested so long time */
-                pMatch->TimeToLive = BAC_ADDR_LONG_TIME;
-            } else if ((pMatch->Flags & BAC_ADDR_STATIC) != 0) {
-                /* Static already so make sure it never expires */
-                pMatch->TimeToLive = BAC_ADDR_FOREVER;
-            } else if ((pMatch->Flags & BAC_ADDR_SHORT_TTL) != 0) {
-                /* Opportunistic entry so leave on short fuse */
-                pMatch->TimeToLive = BAC_ADDR_SHORT_TIME;
-            } else {
-                /* Renewing existing entry */
-                pMatch->TimeToLive = BAC_ADDR_LONG_TIME;
-            }
-            /* Clear bind request flag just in case */
-            pMatch->Flags &= ~BAC_ADDR_BIND_REQ;
-            found = true;
-            break;
-        }
-    }
-    /* New device - add to cache if there is room. */
-    if (!found) {
-        for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
-            pMatch = &Address_Cache[index];
-            if ((pMatch->Flags & BAC_ADDR_IN_USE) == 0) {
-                pMatch->Flags = BAC_ADDR_IN_USE;
-                pMatch->device_id = device_id;
-                pMatch->max_apdu = max_apdu;
-                bacnet_address_copy(&pMatch->address, src);
-                /* Opportunistic entry so leave on short fuse */
-                pMatch->TimeToLive = BAC_ADDR_SHORT_TIME;
-                found = true;
-                break;
-            }
-        }
-    }
-    /* If adding has failed, see if we can squeeze it in by removed the oldest
-     * entry. */
-    if (!found) {
-        pMatch = address_remove_oldest();
-        if (pMatch != NULL) {
-            pMatch->Flags = BAC_ADDR_IN_USE;
-            pMatch->device_id = device_id;
-            pMatch->max_apdu = max_apdu;
-            bacnet_address_copy(&pMatch->address, src);
+        address_entry_address_set(index, src);
+        pMatch->max_apdu = max_apdu;
+        /* Pick the right time to live */
+        if ((pMatch->Flags & BAC_ADDR_BIND_REQ) != 0) {
+            /* Bind requested so long time */
+            address_ttl_set(index, BAC_ADDR_LONG_TIME);
+        } else if ((pMatch->Flags & BAC_ADDR_STATIC) != 0) {
+            /* Static already so make sure it never expires */
+            address_ttl_set(index, BAC_ADDR_FOREVER);
+        } else if ((pMatch->Flags & BAC_ADDR_SHORT_TTL) != 0) {
             /* Opportunistic entry so leave on short fuse */
-            pMatch->TimeToLive = BAC_ADDR_SHORT_TIME;
+            address_ttl_set(index, BAC_ADDR_SHORT_TIME);
+        } else {
+            /* Renewing existing entry */
+            address_ttl_set(index, BAC_ADDR_LONG_TIME);
         }
+        /* Clear bind request flag just in case */
+        pMatch->Flags &= ~BAC_ADDR_BIND_REQ;
+        address_lru_touch(index, true);
+        return;
+    }
+    /* New device - add to cache if there is room, or squeeze it in
+       by removing the least recently used entry. */
+    index = address_entry_new(device_id, 0);
+    if (index != ADDRESS_CACHE_NONE) {
+        pMatch = &Address_Cache[index];
+        pMatch->max_apdu = max_apdu;
+        address_entry_address_set(index, src);
+        /* Opportunistic entry so leave on short fuse */
+        address_ttl_set(index, BAC_ADDR_SHORT_TIME);
     }
     return;
 }
@@ -512,61 +906,46 @@ bool address_device_bind_request(
 {
     bool found = false; /* return value */
     struct Address_Cache_Entry *pMatch;
-    unsigned index;
+    uint32_t index;
 
+    address_index_check();
     /* existing device - update address info if currently bound */
-    for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
+    index = address_device_find(device_id);
+    if (index != ADDRESS_CACHE_NONE) {
         pMatch = &Address_Cache[index];
-        if (((pMatch->Flags & BAC_ADDR_IN_USE) != 0) &&
-            (pMatch->device_id == device_id)) {
-            if ((pMatch->Flags & BAC_ADDR_BIND_REQ) == 0) {
-                /* Already bound */
-                found = true;
-                if (src) {
-                    bacnet_address_copy(src, &pMatch->address);
-                }
-                if (max_apdu) {
-                    *max_apdu = pMatch->max_apdu;
-                }
-                if (device_ttl) {
-                    *device_ttl = pMatch->TimeToLive;
-                }
-                if ((pMatch->Flags & BAC_ADDR_SHORT_TTL) != 0) {
-                    /* Was picked up opportunistacilly */
-                    /* Convert to normal entry  */
-                    pMatch->Flags &= ~BAC_ADDR_SHORT_TTL;
-                    /* And give it a decent time to live */
-                    pMatch->TimeToLive = BAC_ADDR_LONG_TIME;
-                }
+        if ((pMatch->Flags & BAC_ADDR_BIND_REQ) == 0) {
+            /* Already bound */
+            found = true;
+            if (src) {
+                bacnet_address_copy(src, &pMatch->address);
+            }
+            if (max_apdu) {
+                *max_apdu = pMatch->max_apdu;
+            }
+            if (device_ttl) {
+                *device_ttl = address_ttl(pMatch);
+            }
+            if ((pMatch->Flags & BAC_ADDR_SHORT_TTL) != 0) {
+                /* Was picked up opportunistacilly */
+                /* Convert to normal entry  */
+                pMatch->Flags &= ~BAC_ADDR_SHORT_TTL;
+                /* And give it a decent time to live */
+                address_ttl_set(index, BAC_ADDR_LONG_TIME);
             }
-            /* True if bound, false if bind request outstanding */
-            return (found);
         }
+        address_lru_touch(index, true);
+        /* True if bound, false if bind request outstanding */
+        return (found);
     }
 
-    /* Not there already so look for a free entry to put it in */
-    /* existing device - update address info if currently bound */
-    for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
-        pMatch = &Address_Cache[index];
-        if ((pMatch->Flags & (BAC_ADDR_IN_USE | BAC_ADDR_RESERVED)) == 0) {
-            /* In use and awaiting binding */
-            pMatch->Flags = (uint8_t)(BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ);
-            pMatch->device_id = device_id;
-            /* No point in leaving bind requests in for long haul */
-            pMatch->TimeToLive = BAC_ADDR_SHORT_TIME;
-            /* now would be a good time to do a Who-Is request */
-            return (false);
-        }
-    }
-
-    /* No free entries, See if we can squeeze it in by dropping an existing one
-     */
-    pMatch = address_remove_oldest();
-    if (pMatch != NULL) {
-        pMatch->Flags = (uint8_t)(BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ);
-        pMatch->device_id = device_id;
+    /* Not there already so put it in a free entry, or squeeze it in
+       by dropping the least recently used entry */
+    index = address_entry_new(device_id, BAC_ADDR_BIND_REQ);
+    if (index != ADDRESS_CACHE_NONE) {
+        /* In use and awaiting binding */
         /* No point in leaving bind requests in for long haul */
-        pMatch->TimeToLive = BAC_ADDR_SHORT_TIME;
+        address_ttl_set(index, BAC_ADDR_SHORT_TIME);
+        /* now would be a good time to do a Who-Is request */
     }
     return (false);
 }
@@ -600,24 +979,23 @@ void address_add_binding(
     uint32_t device_id, unsigned max_apdu, const BACNET_ADDRESS *src)
 {
     struct Address_Cache_Entry *pMatch;
-    unsigned index;
+    uint32_t index;
 
+    address_index_check();
     /* existing device or bind request - update address */
-    for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
+    index = address_device_find(device_id);
+    if (index != ADDRESS_CACHE_NONE) {
         pMatch = &Address_Cache[index];
-        if (((pMatch->Flags & BAC_ADDR_IN_USE) != 0) &&
-            (pMatch->device_id == device_id)) {
-            bacnet_address_copy(&pMatch->address, src);
-            pMatch->max_apdu = max_apdu;
-            /* Clear bind request flag in case it was set */
-            pMatch->Flags &= ~BAC_ADDR_BIND_REQ;
-            /* Only update TTL if not static */
-            if ((pMatch->Flags & BAC_ADDR_STATIC) == 0) {
-                /* and set it on a long fuse */
-                pMatch->TimeToLive = BAC_ADDR_LONG_TIME;
-            }
-            break;
+        address_entry_address_set(index, src);
+        pMatch->max_apdu = max_apdu;
+        /* Clear bind request flag in case it was set */
+        pMatch->Flags &= ~BAC_ADDR_BIND_REQ;
+        /* Only update TTL if not static */
+        if ((pMatch->Flags & BAC_ADDR_STATIC) == 0) {
+            /* and set it on a long fuse */
+            address_ttl_set(index, BAC_ADDR_LONG_TIME);
         }
+        address_lru_touch(index, true);
     }
     return;
 }
@@ -625,7 +1003,7 @@ void address_add_binding(
 /**
  * Return the device information from the given index in the table.
  *
- * @param index  Table index [0..MAX_ADDRESS_CACHE-1]
+ * @param index  Table index [0..address_cache_size()-1]
  * @param device_id  Pointer to the variable taking the device id.
  * @param device_ttl  Pointer to the variable taking the Time To Life for the
  * device.
@@ -645,7 +1023,7 @@ bool address_device_get_by_index(
     struct Address_Cache_Entry *pMatch;
     bool found = false; /* return value */
 
-    if (index < MAX_ADDRESS_CACHE) {
+    if (index < Address_Cache_Size) {
         pMatch = &Address_Cache[index];
         if ((pMatch->Flags & (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ)) ==
             BAC_ADDR_IN_USE) {
@@ -659,7 +1037,7 @@ bool address_device_get_by_index(
                 *max_apdu = pMatch->max_apdu;
             }
             if (device_ttl) {
-                *device_ttl = pMatch->TimeToLive;
+                *device_ttl = address_ttl(pMatch);
             }
             found = true;
         }
@@ -671,7 +1049,7 @@ bool address_device_get_by_index(
 /**
  * Return the device information from the given index in the table.
  *
- * @param index  Table index [0..MAX_ADDRESS_CACHE-1]
+ * @param index  Table index [0..address_cache_size()-1]
  * @param device_id  Pointer to the variable taking the device id.
  * @param max_apdu  Pointer to the variable taking the max APDU size of the
  * device.
@@ -691,7 +1069,7 @@ bool address_get_by_index(
 /**
  * Return the count of cached addresses.
  *
- * @return A value between zero and MAX_ADDRESS_CACHE.
+ * @return A value between zero and address_cache_size().
  */
 unsigned address_count(void)
 {
@@ -699,7 +1077,7 @@ unsigned address_count(void)
     unsigned count = 0; /* return value */
     unsigned index;
 
-    for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
+    for (index = 0; index < Address_Cache_Size; index++) {
         pMatch = &Address_Cache[index];
         /* Only count bound entries */
         if ((pMatch->Flags & (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ)) ==
@@ -728,7 +1106,7 @@ int address_list_encode(uint8_t *apdu, unsigned apdu_len)
     unsigned index;
 
     /* Look for matching address. */
-    for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
+    for (index = 0; index < Address_Cache_Size; index++) {
         pMatch = &Address_Cache[index];
         if ((pMatch->Flags & (BAC_ADDR_IN_USE | BAC_ADDR_BIND_REQ)) ==
             BAC_ADDR_IN_USE) {
@@ -823,7 +1201,7 @@ int rr_address_list_encode(uint8_t *apdu, BACNET_READ_RANGE_DATA *pRequest)
     bitstring_set_bit(&pRequest->ResultFlags, RESULT_FLAG_LAST_ITEM, false);
     bitstring_set_bit(&pRequest->ResultFlags, RESULT_FLAG_MORE_ITEMS, false);
     /* See how much space we have */
-    uiRemaining = (uint32_t)(MAX_APDU - pRequest->Overhead);
+    uiRemaining = (uint32_t)(rr_ack_apdu_max(pRequest) - pRequest->Overhead);
 
     pRequest->ItemCount = 0; /* Start out with nothing */
     uiTotal = address_count(); /* What do we have to work with here ? */
@@ -887,7 +1265,7 @@ int rr_address_list_encode(uint8_t *apdu, BACNET_READ_RANGE_DATA *pRequest)
            BAC_ADDR_IN_USE) { /* Find first bound entry */
         pMatch++;
         /* Shall not happen as the count has been checked first. */
-        if (pMatch > &Address_Cache[MAX_ADDRESS_CACHE - 1]) {
+        if (pMatch > &Address_Cache[Address_Cache_Size - 1]) {
             /* Issue with the table. */
             return (0);
         }
@@ -904,7 +1282,7 @@ int rr_address_list_encode(uint8_t *apdu, BACNET_READ_RANGE_DATA *pRequest)
             pMatch++;
         }
         /* Shall not happen as the count has been checked first. */
-        if (pMatch > &Address_Cache[MAX_ADDRESS_CACHE - 1]) {
+        if (pMatch > &Address_Cache[Address_Cache_Size - 1]) {
             /* Issue with the table. */
             return (0);
         }
@@ -955,7 +1333,7 @@ int rr_address_list_encode(uint8_t *apdu, BACNET_READ_RANGE_DATA *pRequest)
             /* Find next bound entry */
             pMatch++;
             /* Can normally not happen. */
-            if (pMatch > &Address_Cache[MAX_ADDRESS_CACHE - 1]) {
+            if (pMatch > &Address_Cache[Address_Cache_Size - 1]) {
                 /* Issue with the table. */
                 return (0);
             }
@@ -974,10 +1352,11 @@ int rr_address_list_encode(uint8_t *apdu, BACNET_READ_RANGE_DATA *pRequest)
 }
 
 /**
- * Scan the cache and eliminate any expired entries. Should be called
- * periodically to ensure the cache is managed correctly. If this function
- * is never called at all the whole cache is effectively rendered static and
- * entries never expire unless explicitly deleted.
+ * Eliminate any expired entries. Should be called periodically to ensure
+ * the cache is managed correctly. If this function is never called at all
+ * the whole cache is effectively rendered static and entries never expire
+ * unless explicitly deleted. Entries are kept in a timer wheel slot for
+ * the second after they expire, so only those slots are checked.
  *
  * @param uSeconds  Approximate number of seconds since last call to this
  * function
@@ -985,19 +1364,28 @@ int rr_address_list_encode(uint8_t *apdu, BACNET_READ_RANGE_DATA *pRequest)
 void address_cache_timer(uint16_t uSeconds)
 {
     struct Address_Cache_Entry *pMatch;
-    unsigned index;
-
-    for (index = 0; index < MAX_ADDRESS_CACHE; index++) {
-        pMatch = &Address_Cache[index];
-        if (((pMatch->Flags & (BAC_ADDR_IN_USE | BAC_ADDR_RESERVED)) != 0) &&
-            ((pMatch->Flags & BAC_ADDR_STATIC) ==
-             0)) { /* Check all entries holding a slot except statics
-                    */
-            if (pMatch->TimeToLive >= uSeconds) {
-                pMatch->TimeToLive -= uSeconds;
-            } else {
-                pMatch->Flags = 0;
+    uint32_t slots = uSeconds;
+    uint32_t slot;
+    uint32_t index;
+    uint32_t next;
+
+    address_index_check();
+    if (slots > BACNET_ADDRESS_CACHE_TIMER_SLOTS) {
+        slots = BACNET_ADDRESS_CACHE_TIMER_SLOTS;
+    }
+    Address_Cache_Seconds += uSeconds;
+    while (slots > 0) {
+        slots--;
+        slot = (Address_Cache_Seconds - slots) %
+            BACNET_ADDRESS_CACHE_TIMER_SLOTS;
+        index = Address_Timer_Wheel[slot];
+        while (index != ADDRESS_CACHE_NONE) {
+            pMatch = &Address_Cache[index];
+            next = pMatch->timer_next;
+            if (pMatch->Expires < Address_Cache_Seconds) {
+                address_entry_free(index);
             }
+            index = next;
         }
     }
 }
@@ -32,6 +32,11 @@ void address_init(void);
 BACNET_STACK_EXPORT
 void address_init_partial(void);
 
+BACNET_STACK_EXPORT
+bool address_cache_size_set(unsigned size);
+BACNET_STACK_EXPORT
+unsigned address_cache_size(void);
+
 BACNET_STACK_EXPORT
 void address_add(
     uint32_t device_id, unsigned max_apdu, const BACNET_ADDRESS *src);
@@ -43,6 +43,8 @@ typedef enum bacnet_discover_state_enum {
     BACNET_DISCOVER_STATE_OBJECT_LIST_SIZE_RESPONSE,
     BACNET_DISCOVER_STATE_OBJECT_LIST_REQUEST,
     BACNET_DISCOVER_STATE_OBJECT_LIST_RESPONSE,
+    BACNET_DISCOVER_STATE_OBJECT_LIST_ALL_REQUEST,
+    BACNET_DISCOVER_STATE_OBJECT_LIST_ALL_RESPONSE,
     BACNET_DISCOVER_STATE_OBJECT_GET_PROPERTY_REQUEST,
     BACNET_DISCOVER_STATE_OBJECT_GET_PROPERTY_RESPONSE,
     BACNET_DISCOVER_STATE_OBJECT_NEXT,
@@ -582,7 +584,8 @@ static void bacnet_device_object_property_add(
                     BACNET_DISCOVER_STATE_OBJECT_LIST_SIZE_RESPONSE;
             }
         } else if (value->tag == BACNET_APPLICATION_TAG_OBJECT_ID) {
-            if (rp_data->array_index <= device_data->Object_List_Size) {
+            if ((rp_data->array_index == BACNET_ARRAY_ALL) ||
+                (rp_data->array_index <= device_data->Object_List_Size)) {
                 object_data = bacnet_object_data_add(
                     device_data->Object_List, value->type.Object_Id.type,
                     value->type.Object_Id.instance);
@@ -596,6 +599,11 @@ static void bacnet_device_object_property_add(
                     BACNET_DISCOVER_STATE_OBJECT_LIST_REQUEST) {
                     device_data->Discovery_State =
                         BACNET_DISCOVER_STATE_OBJECT_LIST_RESPONSE;
+                } else if (
+                    device_data->Discovery_State ==
+                    BACNET_DISCOVER_STATE_OBJECT_LIST_ALL_REQUEST) {
+                    device_data->Discovery_State =
+                        BACNET_DISCOVER_STATE_OBJECT_LIST_ALL_RESPONSE;
                 }
             }
         }
@@ -700,6 +708,12 @@ static void Device_Error_Handler(
                 device_data->Discovery_State =
                     BACNET_DISCOVER_STATE_OBJECT_LIST_RESPONSE;
                 break;
+            case BACNET_DISCOVER_STATE_OBJECT_LIST_ALL_REQUEST:
+                /* fallback to reading one object-list element at a time */
+                device_data->Object_List_Index = 0;
+                device_data->Discovery_State =
+                    BACNET_DISCOVER_STATE_OBJECT_LIST_RESPONSE;
+                break;
             case BACNET_DISCOVER_STATE_OBJECT_GET_PROPERTY_REQUEST:
                 if (rp_data->error_code == ERROR_CODE_TIMEOUT) {
                     /* resend request */
@@ -802,9 +816,34 @@ bacnet_discover_device_fsm(uint32_t device_id, BACNET_DEVICE_DATA *device_data)
             return;
         case BACNET_DISCOVER_STATE_OBJECT_LIST_SIZE_RESPONSE:
             device_data->Object_List_Index = 0;
+#if BACNET_SEGMENTATION_ENABLED
+            /* read the whole object-list in one segmented transaction */
+            status = bacnet_read_property_queue(
+                device_id, OBJECT_DEVICE, device_id, PROP_OBJECT_LIST,
+                BACNET_ARRAY_ALL);
+            if (status) {
+                device_data->Discovery_State =
+                    BACNET_DISCOVER_STATE_OBJECT_LIST_ALL_REQUEST;
+                return;
+            }
+#endif
             device_data->Discovery_State =
                 BACNET_DISCOVER_STATE_OBJECT_LIST_RESPONSE;
             break;
+        case BACNET_DISCOVER_STATE_OBJECT_LIST_ALL_REQUEST:
+            /* waiting for response */
+            return;
+        case BACNET_DISCOVER_STATE_OBJECT_LIST_ALL_RESPONSE:
+            if (Keylist_Count(device_data->Object_List) <
+                (int)device_data->Object_List_Size) {
+                /* some are missing - read one element at a time */
+                device_data->Discovery_State =
+                    BACNET_DISCOVER_STATE_OBJECT_LIST_RESPONSE;
+            } else {
+                device_data->Discovery_State =
+                    BACNET_DISCOVER_STATE_OBJECT_GET_PROPERTY_RESPONSE;
+            }
+            break;
         case BACNET_DISCOVER_STATE_OBJECT_LIST_REQUEST:
             /* waiting for response */
             break;
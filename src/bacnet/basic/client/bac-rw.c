@@ -498,15 +498,16 @@ static bool bacnet_read_write_process(const TARGET_DATA *target)
         case BACNET_CLIENT_WAITING:
             if (Error_Detected) {
                 RW_State = BACNET_CLIENT_FINISHED;
-            } else if (tsm_invoke_id_free(Request_Invoke_ID)) {
+            } else if (tsm_invoke_id_free(&Target_Address, Request_Invoke_ID)) {
                 Error_Detected = false;
                 RW_State = BACNET_CLIENT_FINISHED;
-            } else if (tsm_invoke_id_failed(Request_Invoke_ID)) {
+            } else if (tsm_invoke_id_failed(
+                           &Target_Address, Request_Invoke_ID)) {
                 Error_Detected = true;
                 Error_Class = ERROR_CLASS_SERVICES;
                 Error_Code = ERROR_CODE_ABORT_TSM_TIMEOUT;
                 RW_State = BACNET_CLIENT_FINISHED;
-                tsm_free_invoke_id(Request_Invoke_ID);
+                tsm_free_invoke_id(&Target_Address, Request_Invoke_ID);
             }
             break;
         case BACNET_CLIENT_FINISHED:
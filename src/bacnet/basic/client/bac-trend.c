@@ -0,0 +1,778 @@
+/**
+ * @file
+ * @brief Acquire the values of the Trend Log Multiple objects from other
+ *  BACnet devices. The properties that are waited for are grouped by
+ *  device and read with one ReadPropertyMultiple per device, as many as
+ *  fit in the APDU of the device. The Present_Value of an object that
+ *  accepts a COV subscription is taken from its notifications instead.
+ * @author agent <agent@local>
+ * @date October 2026
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+/* BACnet Stack API */
+#include "bacnet/apdu.h"
+#include "bacnet/bacapp.h"
+#include "bacnet/cov.h"
+#include "bacnet/rp.h"
+#include "bacnet/rpm.h"
+#include "bacnet/basic/binding/address.h"
+#include "bacnet/basic/object/device.h"
+#include "bacnet/basic/object/trendlog_multiple.h"
+#include "bacnet/basic/services.h"
+#include "bacnet/basic/sys/keylist.h"
+#include "bacnet/basic/sys/mstimer.h"
+#include "bacnet/basic/tsm/tsm.h"
+/* me */
+#include "bacnet/basic/client/bac-trend.h"
+
+/* states of a COV subscription */
+typedef enum {
+    BACNET_TREND_COV_NONE,
+    BACNET_TREND_COV_SUBSCRIBED,
+    BACNET_TREND_COV_FAILED
+} BACNET_TREND_COV_STATE;
+
+/* object whose Present_Value is taken from COV notifications */
+struct trend_point {
+    BACNET_OBJECT_ID object;
+    BACNET_TREND_COV_STATE state;
+    /* renewal of the subscription, or retry after a failure */
+    struct mstimer timer;
+    /* asked for since the subscription was renewed */
+    bool used;
+    /* the latest value, encoded, or empty until one is notified */
+    uint8_t value[16];
+    uint8_t value_len;
+};
+
+/* property waiting to be read */
+struct trend_reference {
+    BACNET_OBJECT_ID object;
+    BACNET_PROPERTY_ID property;
+    BACNET_ARRAY_INDEX array_index;
+    bool answered;
+};
+
+struct trend_device {
+    uint32_t device_id;
+    BACNET_ADDRESS address;
+    unsigned max_apdu;
+    bool binding;
+    struct mstimer bind_timer;
+    /* the first request_count references are in the request in progress */
+    struct trend_reference queue[BACNET_TREND_QUEUE_MAX];
+    unsigned queue_count;
+    unsigned request_count;
+    uint8_t invoke_id;
+    bool acked;
+    BACNET_ERROR_CLASS error_class;
+    BACNET_ERROR_CODE error_code;
+    /* COV subscriptions, keyed by object */
+    OS_Keylist point_list;
+    uint8_t cov_invoke_id;
+    bool cov_acked;
+    KEY cov_key;
+};
+
+/* devices with properties to acquire, keyed by device instance */
+static OS_Keylist Device_List;
+/* ReadPropertyMultiple requests in progress */
+static unsigned Request_Count;
+static uint32_t COV_Lifetime = BACNET_TREND_COV_LIFETIME;
+/* device of the ReadPropertyMultiple-ACK being processed */
+static struct trend_device *Ack_Device;
+static BACNET_COV_NOTIFICATION COV_Notification;
+/* local storage - keeps it off the c-stack */
+static BACNET_APPLICATION_DATA_VALUE Trend_Value;
+static BACNET_READ_ACCESS_DATA Read_Access_Data[BACNET_TREND_QUEUE_MAX];
+static BACNET_PROPERTY_REFERENCE Property_List[BACNET_TREND_QUEUE_MAX];
+static uint8_t Request_Buffer[MAX_PDU];
+
+/**
+ * @brief Find the device that sent a message
+ * @param src [in] BACNET_ADDRESS of the source of the message
+ * @return the device, or NULL if it is not one of ours
+ */
+static struct trend_device *bacnet_trend_device_from_address(
+    const BACNET_ADDRESS *src)
+{
+    uint32_t device_id = 0;
+
+    if (!address_get_device_id(src, &device_id)) {
+        return NULL;
+    }
+
+    return Keylist_Data(Device_List, device_id);
+}
+
+/**
+ * @brief Find a COV subscription that serves a property
+ * @param device - device of the property
+ * @param object - object of the property
+ * @param property - property identifier
+ * @param array_index - array index of the property
+ * @return the subscription, or NULL if the property is not one of them
+ */
+static struct trend_point *bacnet_trend_point(
+    const struct trend_device *device,
+    const BACNET_OBJECT_ID *object,
+    BACNET_PROPERTY_ID property,
+    BACNET_ARRAY_INDEX array_index)
+{
+    if ((property != PROP_PRESENT_VALUE) ||
+        (array_index != BACNET_ARRAY_ALL)) {
+        return NULL;
+    }
+
+    return Keylist_Data(
+        device->point_list, KEY_ENCODE(object->type, object->instance));
+}
+
+/**
+ * @brief Hand one property to the Trend Log Multiple objects
+ * @param device_id - device of the property
+ * @param object - object of the property
+ * @param property - property identifier
+ * @param array_index - array index of the property
+ * @param value - the value, or NULL for an error
+ * @param error_class - error class used when there is no value
+ * @param error_code - error code used when there is no value
+ */
+static void bacnet_trend_value(
+    uint32_t device_id,
+    const BACNET_OBJECT_ID *object,
+    BACNET_PROPERTY_ID property,
+    BACNET_ARRAY_INDEX array_index,
+    BACNET_APPLICATION_DATA_VALUE *value,
+    BACNET_ERROR_CLASS error_class,
+    BACNET_ERROR_CODE error_code)
+{
+    BACNET_READ_PROPERTY_DATA rp_data = { 0 };
+
+    rp_data.object_type = object->type;
+    rp_data.object_instance = object->instance;
+    rp_data.object_property = property;
+    rp_data.array_index = array_index;
+    rp_data.error_class = error_class;
+    rp_data.error_code = error_code;
+    Trend_Log_Multiple_Remote_Value(device_id, &rp_data, value);
+}
+
+/**
+ * @brief Take a property that a Trend Log Multiple is waiting for
+ * @param device_id - device instance of the property
+ * @param object_id - object of the property
+ * @param property - property identifier
+ * @param array_index - array index of the property, or BACNET_ARRAY_ALL
+ * @return true if the property will be acquired
+ */
+static bool bacnet_trend_request(
+    uint32_t device_id,
+    const BACNET_OBJECT_ID *object_id,
+    BACNET_PROPERTY_ID property,
+    BACNET_ARRAY_INDEX array_index)
+{
+    struct trend_device *device;
+    struct trend_reference *reference;
+    struct trend_point *point;
+    KEY key;
+    unsigned i;
+
+    device = Keylist_Data(Device_List, device_id);
+    if (!device) {
+        device = calloc(1, sizeof(struct trend_device));
+        if (!device) {
+            return false;
+        }
+        device->device_id = device_id;
+        device->point_list = Keylist_Create();
+        if (!device->point_list ||
+            (Keylist_Data_Add(Device_List, device_id, device) < 0)) {
+            Keylist_Delete(device->point_list);
+            free(device);
+            return false;
+        }
+    }
+    if ((COV_Lifetime > 0) && (property == PROP_PRESENT_VALUE) &&
+        (array_index == BACNET_ARRAY_ALL)) {
+        key = KEY_ENCODE(object_id->type, object_id->instance);
+        point = Keylist_Data(device->point_list, key);
+        if (!point) {
+            point = calloc(1, sizeof(struct trend_point));
+            if (point) {
+                point->object = *object_id;
+                if (Keylist_Data_Add(device->point_list, key, point) < 0) {
+                    free(point);
+                    point = NULL;
+                }
+            }
+        }
+        if (point) {
+            point->used = true;
+        }
+    }
+    for (i = 0; i < device->queue_count; i++) {
+        reference = &device->queue[i];
+        if ((reference->object.type == object_id->type) &&
+            (reference->object.instance == object_id->instance) &&
+            (reference->property == property) &&
+            (reference->array_index == array_index)) {
+            /* one answer is handed to every log that waits for it */
+            return true;
+        }
+    }
+    if (device->queue_count >= BACNET_TREND_QUEUE_MAX) {
+        return false;
+    }
+    reference = &device->queue[device->queue_count];
+    reference->object = *object_id;
+    reference->property = property;
+    reference->array_index = array_index;
+    reference->answered = false;
+    device->queue_count++;
+
+    return true;
+}
+
+/**
+ * @brief Remove the references of the request that finished, reporting
+ *  the error of the request for each that was not answered, or the
+ *  references that could not be sent
+ * @param device - device of the request
+ */
+static void bacnet_trend_request_finish(struct trend_device *device)
+{
+    struct trend_reference *reference;
+    unsigned i;
+
+    for (i = 0; i < device->request_count; i++) {
+        reference = &device->queue[i];
+        if (!reference->answered) {
+            bacnet_trend_value(
+                device->device_id, &reference->object, reference->property,
+                reference->array_index, NULL, device->error_class,
+                device->error_code);
+        }
+    }
+    device->queue_count -= device->request_count;
+    memmove(
+        &device->queue[0], &device->queue[device->request_count],
+        device->queue_count * sizeof(device->queue[0]));
+    device->request_count = 0;
+}
+
+/**
+ * @brief Hand the values that are known from COV notifications to the
+ *  Trend Log Multiple objects, so that they are not read
+ * @param device - device of the properties
+ */
+static void bacnet_trend_cov_values(struct trend_device *device)
+{
+    struct trend_reference *reference;
+    const struct trend_point *point;
+    unsigned i = device->request_count;
+    int len;
+
+    while (i < device->queue_count) {
+        reference = &device->queue[i];
+        point = bacnet_trend_point(
+            device, &reference->object, reference->property,
+            reference->array_index);
+        if (point && (point->state == BACNET_TREND_COV_SUBSCRIBED) &&
+            (point->value_len > 0)) {
+            len = bacapp_decode_application_data(
+                point->value, point->value_len, &Trend_Value);
+            if (len > 0) {
+                bacnet_trend_value(
+                    device->device_id, &reference->object,
+                    reference->property, reference->array_index,
+                    &Trend_Value, ERROR_CLASS_PROPERTY, ERROR_CODE_OTHER);
+                device->queue_count--;
+                memmove(
+                    reference, reference + 1,
+                    (device->queue_count - i) * sizeof(device->queue[0]));
+                continue;
+            }
+        }
+        i++;
+    }
+}
+
+/**
+ * @brief Send one ReadPropertyMultiple with as many of the waiting
+ *  properties as fit in the APDU of the device. The properties are grouped
+ *  by object, and the size of the ACK is estimated from the size of a
+ *  value of a primitive type.
+ * @param device - device of the properties
+ */
+static void bacnet_trend_request_send(struct trend_device *device)
+{
+    BACNET_READ_ACCESS_DATA *rpm_object = NULL;
+    BACNET_PROPERTY_REFERENCE *rpm_property = NULL;
+    BACNET_PROPERTY_REFERENCE **rpm_next = NULL;
+    const struct trend_reference *reference;
+    unsigned object_count = 0;
+    unsigned apdu_len = 3;
+    unsigned len = 0;
+    unsigned i, j;
+
+    for (i = 0; i < device->queue_count; i++) {
+        reference = &device->queue[i];
+        rpm_object = NULL;
+        for (j = 0; j < object_count; j++) {
+            if ((Read_Access_Data[j].object_type == reference->object.type) &&
+                (Read_Access_Data[j].object_instance ==
+                 reference->object.instance)) {
+                rpm_object = &Read_Access_Data[j];
+                break;
+            }
+        }
+        /* context tags, property identifier and a primitive value */
+        len = 12;
+        if (reference->array_index != BACNET_ARRAY_ALL) {
+            len += 5;
+        }
+        if (!rpm_object) {
+            /* object identifier and the list of results */
+            len += 7;
+        }
+        if ((apdu_len + len) > device->max_apdu) {
+            break;
+        }
+        apdu_len += len;
+        if (!rpm_object) {
+            rpm_object = &Read_Access_Data[object_count];
+            rpm_object->object_type = reference->object.type;
+            rpm_object->object_instance = reference->object.instance;
+            rpm_object->listOfProperties = NULL;
+            rpm_object->next = NULL;
+            if (object_count > 0) {
+                Read_Access_Data[object_count - 1].next = rpm_object;
+            }
+            object_count++;
+        }
+        rpm_property = &Property_List[i];
+        rpm_property->propertyIdentifier = reference->property;
+        rpm_property->propertyArrayIndex = reference->array_index;
+        rpm_property->value = NULL;
+        rpm_property->next = NULL;
+        rpm_next = &rpm_object->listOfProperties;
+        while (*rpm_next) {
+            rpm_next = &(*rpm_next)->next;
+        }
+        *rpm_next = rpm_property;
+    }
+    if (i == 0) {
+        return;
+    }
+    device->invoke_id = Send_Read_Property_Multiple_Request(
+        Request_Buffer, sizeof(Request_Buffer), device->device_id,
+        &Read_Access_Data[0]);
+    if (device->invoke_id != 0) {
+        device->request_count = i;
+        device->acked = false;
+        device->error_class = ERROR_CLASS_SERVICES;
+        device->error_code = ERROR_CODE_OTHER;
+        Request_Count++;
+    }
+}
+
+/**
+ * @brief Subscribe to, renew, or drop the COV subscription of one object
+ *  of a device, one at a time. A subscription is renewed at half of its
+ *  lifetime, and dropped at renewal when no log asked for its value since
+ *  the previous renewal. A failed subscription is retried after its
+ *  lifetime, and its value is read meanwhile.
+ * @param device - device of the objects
+ */
+static void bacnet_trend_cov_task(struct trend_device *device)
+{
+    BACNET_SUBSCRIBE_COV_DATA cov_data = { 0 };
+    struct trend_point *point = NULL;
+    KEY key = 0;
+    int index;
+
+    if (device->cov_invoke_id != 0) {
+        point = Keylist_Data(device->point_list, device->cov_key);
+        if (tsm_invoke_id_failed(&device->address, device->cov_invoke_id)) {
+            tsm_free_invoke_id(&device->address, device->cov_invoke_id);
+        } else if (!tsm_invoke_id_free(
+                       &device->address, device->cov_invoke_id)) {
+            return;
+        }
+        if (point) {
+            if (device->cov_acked) {
+                point->state = BACNET_TREND_COV_SUBSCRIBED;
+                mstimer_set(&point->timer, COV_Lifetime * 1000UL / 2);
+            } else {
+                point->state = BACNET_TREND_COV_FAILED;
+                point->value_len = 0;
+                mstimer_set(&point->timer, COV_Lifetime * 1000UL);
+            }
+        }
+        device->cov_invoke_id = 0;
+    }
+    for (index = 0; index < Keylist_Count(device->point_list); index++) {
+        point = Keylist_Data_Index(device->point_list, index);
+        if (point && ((point->state == BACNET_TREND_COV_NONE) ||
+                      mstimer_expired(&point->timer))) {
+            Keylist_Index_Key(device->point_list, index, &key);
+            break;
+        }
+        point = NULL;
+    }
+    if (!point) {
+        return;
+    }
+    if ((point->state != BACNET_TREND_COV_NONE) && !point->used) {
+        /* the subscription lapses at the end of its lifetime */
+        point = Keylist_Data_Delete(device->point_list, key);
+        free(point);
+        return;
+    }
+    if (COV_Lifetime == 0) {
+        /* only polling, until the subscription is dropped */
+        point->state = BACNET_TREND_COV_FAILED;
+        point->value_len = 0;
+        point->used = false;
+        mstimer_set(&point->timer, BACNET_TREND_COV_LIFETIME * 1000UL);
+        return;
+    }
+    cov_data.subscriberProcessIdentifier = BACNET_TREND_COV_PROCESS_ID;
+    cov_data.monitoredObjectIdentifier = point->object;
+    cov_data.cancellationRequest = false;
+    cov_data.issueConfirmedNotifications = false;
+    cov_data.lifetime = COV_Lifetime;
+    device->cov_invoke_id = Send_COV_Subscribe(device->device_id, &cov_data);
+    if (device->cov_invoke_id != 0) {
+        device->cov_acked = false;
+        device->cov_key = key;
+        point->used = false;
+    }
+}
+
+/**
+ * @brief Acquire the properties of one device
+ * @param device - device of the properties
+ */
+static void bacnet_trend_device_task(struct trend_device *device)
+{
+    unsigned max_apdu = 0;
+    bool found = false;
+    bool finished = false;
+
+    if (device->invoke_id != 0) {
+        if (tsm_invoke_id_failed(&device->address, device->invoke_id)) {
+            device->error_class = ERROR_CLASS_SERVICES;
+            device->error_code = ERROR_CODE_ABORT_TSM_TIMEOUT;
+            tsm_free_invoke_id(&device->address, device->invoke_id);
+            finished = true;
+        } else if (tsm_invoke_id_free(&device->address, device->invoke_id)) {
+            if (device->acked) {
+                /* properties missing from the ACK */
+                device->error_class = ERROR_CLASS_SERVICES;
+                device->error_code = ERROR_CODE_INVALID_TAG;
+            }
+            /* otherwise freed by an Error, Reject or Abort */
+            finished = true;
+        }
+        if (finished) {
+            bacnet_trend_request_finish(device);
+            device->invoke_id = 0;
+            if (Request_Count > 0) {
+                Request_Count--;
+            }
+        }
+    }
+    bacnet_trend_cov_values(device);
+    if ((device->queue_count == 0) &&
+        (Keylist_Count(device->point_list) == 0)) {
+        return;
+    }
+    /* exclude our device - in case our ID changed */
+    address_own_device_id_set(Device_Object_Instance_Number());
+    found =
+        address_bind_request(device->device_id, &max_apdu, &device->address);
+    if (!found) {
+        if (device->invoke_id != 0) {
+            /* the request in progress finishes first */
+        } else if (!device->binding) {
+            Send_WhoIs(device->device_id, device->device_id);
+            mstimer_set(&device->bind_timer, apdu_timeout());
+            device->binding = true;
+        } else if (mstimer_expired(&device->bind_timer)) {
+            /* unable to bind within APDU timeout */
+            device->binding = false;
+            device->request_count = device->queue_count;
+            device->error_class = ERROR_CLASS_SERVICES;
+            device->error_code = ERROR_CODE_TIMEOUT;
+            bacnet_trend_request_finish(device);
+        }
+        return;
+    }
+    device->binding = false;
+    device->max_apdu = max_apdu;
+    if (device->max_apdu > MAX_APDU) {
+        device->max_apdu = MAX_APDU;
+    }
+    if ((device->invoke_id == 0) && (device->queue_count > 0) &&
+        (Request_Count < BACNET_TREND_REQUEST_MAX)) {
+        bacnet_trend_request_send(device);
+    }
+    bacnet_trend_cov_task(device);
+}
+
+/**
+ * @brief Process one property of a ReadPropertyMultiple-ACK
+ * @param device_id [in] The device ID of the source of the message
+ * @param rp_data [in] The contents of the service request.
+ */
+static void
+bacnet_trend_ack_process(uint32_t device_id, BACNET_READ_PROPERTY_DATA *rp_data)
+{
+    struct trend_reference *reference;
+    BACNET_APPLICATION_DATA_VALUE *value = NULL;
+    unsigned i;
+    int len;
+
+    if (!Ack_Device || !rp_data) {
+        return;
+    }
+    if (rp_data->error_code == ERROR_CODE_SUCCESS) {
+        len = bacapp_decode_known_property(
+            rp_data->application_data, rp_data->application_data_len,
+            &Trend_Value, rp_data->object_type, rp_data->object_property);
+        if (len > 0) {
+            value = &Trend_Value;
+        } else {
+            rp_data->error_class = ERROR_CLASS_PROPERTY;
+            rp_data->error_code = ERROR_CODE_DATATYPE_NOT_SUPPORTED;
+        }
+    }
+    Trend_Log_Multiple_Remote_Value(device_id, rp_data, value);
+    for (i = 0; i < Ack_Device->request_count; i++) {
+        reference = &Ack_Device->queue[i];
+        if ((reference->object.type == rp_data->object_type) &&
+            (reference->object.instance == rp_data->object_instance) &&
+            (reference->property == rp_data->object_property) &&
+            (reference->array_index == rp_data->array_index)) {
+            reference->answered = true;
+        }
+    }
+}
+
+/** Handler for a ReadPropertyMultiple ACK.
+ *
+ * @param service_request [in] The contents of the service request.
+ * @param service_len [in] The length of the service_request.
+ * @param src [in] BACNET_ADDRESS of the source of the message
+ * @param service_data [in] The BACNET_CONFIRMED_SERVICE_DATA information
+ * decoded from the APDU header of this message.
+ */
+static void bacnet_trend_rpm_ack_handler(
+    uint8_t *service_request,
+    uint16_t service_len,
+    BACNET_ADDRESS *src,
+    BACNET_CONFIRMED_SERVICE_ACK_DATA *service_data)
+{
+    BACNET_READ_PROPERTY_DATA rp_data = { 0 };
+    struct trend_device *device;
+
+    device = bacnet_trend_device_from_address(src);
+    if (device && (device->invoke_id != 0) &&
+        (service_data->invoke_id == device->invoke_id)) {
+        device->acked = true;
+        Ack_Device = device;
+        rp_data.error_code = ERROR_CODE_SUCCESS;
+        rpm_ack_object_property_process(
+            service_request, service_len, device->device_id, &rp_data,
+            bacnet_trend_ack_process);
+        Ack_Device = NULL;
+    }
+}
+
+/**
+ * @brief Handler for an Error PDU of a ReadPropertyMultiple
+ * @param src [in] BACNET_ADDRESS of the source of the message
+ * @param invoke_id [in] the invokeID from the rejected message
+ * @param error_class [in] the error class
+ * @param error_code [in] the error code
+ */
+static void bacnet_trend_rpm_error_handler(
+    BACNET_ADDRESS *src,
+    uint8_t invoke_id,
+    BACNET_ERROR_CLASS error_class,
+    BACNET_ERROR_CODE error_code)
+{
+    struct trend_device *device;
+
+    device = bacnet_trend_device_from_address(src);
+    if (device && (device->invoke_id != 0) &&
+        (invoke_id == device->invoke_id)) {
+        device->error_class = error_class;
+        device->error_code = error_code;
+    }
+}
+
+/** Handler for a SubscribeCOV Simple ACK PDU.
+ *
+ * @param src [in] BACNET_ADDRESS of the source of the message
+ * @param invoke_id [in] the invokeID from the rejected message
+ */
+static void
+bacnet_trend_cov_simple_ack_handler(BACNET_ADDRESS *src, uint8_t invoke_id)
+{
+    struct trend_device *device;
+
+    device = bacnet_trend_device_from_address(src);
+    if (device && (device->cov_invoke_id != 0) &&
+        (invoke_id == device->cov_invoke_id)) {
+        device->cov_acked = true;
+    }
+}
+
+/**
+ * @brief Keep the Present_Value of an unconfirmed COV notification of one
+ *  of our subscriptions
+ * @param cov_data [in] The decoded COV notification
+ */
+static void bacnet_trend_cov_notification(BACNET_COV_DATA *cov_data)
+{
+    struct trend_device *device;
+    struct trend_point *point;
+    const BACNET_PROPERTY_VALUE *property_value;
+    int len;
+
+    if (cov_data->subscriberProcessIdentifier !=
+        BACNET_TREND_COV_PROCESS_ID) {
+        return;
+    }
+    device = Keylist_Data(Device_List, cov_data->initiatingDeviceIdentifier);
+    if (!device) {
+        return;
+    }
+    point = bacnet_trend_point(
+        device, &cov_data->monitoredObjectIdentifier, PROP_PRESENT_VALUE,
+        BACNET_ARRAY_ALL);
+    if (!point) {
+        return;
+    }
+    property_value = cov_data->listOfValues;
+    while (property_value) {
+        if ((property_value->propertyIdentifier == PROP_PRESENT_VALUE) &&
+            (property_value->propertyArrayIndex == BACNET_ARRAY_ALL)) {
+            len = bacapp_encode_application_data(NULL, &property_value->value);
+            if ((len > 0) && (len <= (int)sizeof(point->value))) {
+                point->value_len = bacapp_encode_application_data(
+                    point->value, &property_value->value);
+            } else {
+                /* the value is read instead */
+                point->value_len = 0;
+            }
+            break;
+        }
+        property_value = property_value->next;
+    }
+}
+
+/**
+ * @brief Set the lifetime of the COV subscriptions. The subscriptions that
+ *  exist are renewed with the new lifetime.
+ * @param seconds - lifetime in seconds, or 0 to read every property
+ */
+void bacnet_trend_cov_lifetime_set(uint32_t seconds)
+{
+    COV_Lifetime = seconds;
+}
+
+/**
+ * @brief Get the lifetime of the COV subscriptions
+ * @return lifetime in seconds, or 0 if every property is read
+ */
+uint32_t bacnet_trend_cov_lifetime(void)
+{
+    return COV_Lifetime;
+}
+
+/**
+ * @brief Get the number of devices whose properties are acquired
+ * @return number of devices
+ */
+unsigned bacnet_trend_device_count(void)
+{
+    return Keylist_Count(Device_List);
+}
+
+/**
+ * @brief Acquire the properties of other devices that the Trend Log
+ *  Multiple objects are waiting for. Call this often, such as after each
+ *  received message.
+ */
+void bacnet_trend_task(void)
+{
+    struct trend_device *device;
+    int index;
+
+    Trend_Log_Multiple_Remote_Requests(bacnet_trend_request);
+    for (index = 0; index < Keylist_Count(Device_List); index++) {
+        device = Keylist_Data_Index(Device_List, index);
+        if (device) {
+            bacnet_trend_device_task(device);
+        }
+    }
+}
+
+/**
+ * @brief Release the devices and their COV subscriptions. The properties
+ *  that are waited for are acquired again by bacnet_trend_task().
+ */
+void bacnet_trend_cleanup(void)
+{
+    struct trend_device *device;
+    struct trend_point *point;
+
+    if (Device_List) {
+        do {
+            device = Keylist_Data_Pop(Device_List);
+            if (device) {
+                do {
+                    point = Keylist_Data_Pop(device->point_list);
+                    free(point);
+                } while (point);
+                Keylist_Delete(device->point_list);
+                free(device);
+            }
+        } while (device);
+        Keylist_Delete(Device_List);
+        Device_List = NULL;
+    }
+    Request_Count = 0;
+}
+
+/**
+ * @brief Initialize the acquisition. The ReadPropertyMultiple-ACK, the
+ *  ReadPropertyMultiple Error, and the SubscribeCOV Simple-ACK handlers
+ *  are taken, and the unconfirmed COV notifications are watched.
+ */
+void bacnet_trend_init(void)
+{
+    if (!Device_List) {
+        Device_List = Keylist_Create();
+    }
+    apdu_set_confirmed_ack_handler(
+        SERVICE_CONFIRMED_READ_PROP_MULTIPLE, bacnet_trend_rpm_ack_handler);
+    apdu_set_error_handler(
+        SERVICE_CONFIRMED_READ_PROP_MULTIPLE, bacnet_trend_rpm_error_handler);
+    apdu_set_confirmed_simple_ack_handler(
+        SERVICE_CONFIRMED_SUBSCRIBE_COV, bacnet_trend_cov_simple_ack_handler);
+    if (!COV_Notification.callback) {
+        COV_Notification.callback = bacnet_trend_cov_notification;
+        handler_ucov_notification_add(&COV_Notification);
+    }
+}
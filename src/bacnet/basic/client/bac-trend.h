@@ -0,0 +1,57 @@
+/**
+ * @file
+ * @brief API to acquire the values of the Trend Log Multiple objects from
+ *  other BACnet devices, with one ReadPropertyMultiple per device, or
+ *  with COV subscriptions
+ * @author agent <agent@local>
+ * @date October 2026
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#ifndef BACNET_BASIC_CLIENT_TREND_H
+#define BACNET_BASIC_CLIENT_TREND_H
+#include <stdint.h>
+#include <stdbool.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+
+/* properties of one device waiting to be read */
+#ifndef BACNET_TREND_QUEUE_MAX
+#define BACNET_TREND_QUEUE_MAX 64
+#endif
+
+/* ReadPropertyMultiple requests in progress, across all devices */
+#ifndef BACNET_TREND_REQUEST_MAX
+#define BACNET_TREND_REQUEST_MAX 16
+#endif
+
+/* lifetime of the COV subscriptions, in seconds; 0 to only poll */
+#ifndef BACNET_TREND_COV_LIFETIME
+#define BACNET_TREND_COV_LIFETIME 300
+#endif
+
+/* subscriber process identifier of the COV subscriptions */
+#ifndef BACNET_TREND_COV_PROCESS_ID
+#define BACNET_TREND_COV_PROCESS_ID 0x54524E44UL
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+BACNET_STACK_EXPORT
+void bacnet_trend_init(void);
+BACNET_STACK_EXPORT
+void bacnet_trend_task(void);
+BACNET_STACK_EXPORT
+void bacnet_trend_cov_lifetime_set(uint32_t seconds);
+BACNET_STACK_EXPORT
+uint32_t bacnet_trend_cov_lifetime(void);
+BACNET_STACK_EXPORT
+unsigned bacnet_trend_device_count(void);
+BACNET_STACK_EXPORT
+void bacnet_trend_cleanup(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
@@ -18,6 +18,7 @@
 #include "bacnet/npdu.h"
 #include "bacnet/apdu.h"
 #include "bacnet/bactext.h"
+#include "bacnet/whois.h"
 #include "bacnet/basic/object/device.h"
 #include "bacnet/basic/sys/debug.h"
 #include "bacnet/basic/services.h"
@@ -178,6 +179,41 @@ static void network_control_handler(
  * @param apdu [in] The apdu portion of the request, to be processed.
  * @param apdu_len [in] The total (remaining) length of the apdu.
  */
+/** Get the Device instance range of a Who-Is APDU.
+ *
+ * @param apdu [in] The APDU.
+ * @param apdu_len [in] The length of the APDU.
+ * @param low_limit [out] Lowest Device instance that is to reply.
+ * @param high_limit [out] Highest Device instance that is to reply.
+ * @return True if the APDU is a valid Who-Is.
+ */
+static bool routed_who_is_range(
+    const uint8_t *apdu,
+    uint16_t apdu_len,
+    uint32_t *low_limit,
+    uint32_t *high_limit)
+{
+    int32_t low = 0, high = 0;
+    int len;
+
+    if ((apdu_len < 2) || (apdu[0] != PDU_TYPE_UNCONFIRMED_SERVICE_REQUEST) ||
+        (apdu[1] != SERVICE_UNCONFIRMED_WHO_IS)) {
+        return false;
+    }
+    len = whois_decode_service_request(&apdu[2], apdu_len - 2, &low, &high);
+    if (len == 0) {
+        /* no limits */
+        low = 0;
+        high = BACNET_MAX_INSTANCE;
+    } else if (len < 0) {
+        return false;
+    }
+    *low_limit = (uint32_t)low;
+    *high_limit = (uint32_t)high;
+
+    return true;
+}
+
 static void routed_apdu_handler(
     BACNET_ADDRESS *src,
     BACNET_ADDRESS *dest,
@@ -187,6 +223,7 @@ static void routed_apdu_handler(
 {
     int cursor = 0; /* Starting hint */
     bool bGotOne = false;
+    uint32_t low_limit = 0, high_limit = 0;
 
     if (!Routed_Device_Is_Valid_Network(dest->net, DNET_list)) {
         /* We don't know how to reach this one.
@@ -217,11 +254,23 @@ static void routed_apdu_handler(
         return;
     }
 
-    while (Routed_Device_GetNext(dest, DNET_list, &cursor)) {
-        apdu_handler(src, apdu, apdu_len);
-        bGotOne = true;
-        if (cursor < 0) { /* If no more matches, */
-            break; /* We don't need to keep looking */
+    if (routed_who_is_range(apdu, apdu_len, &low_limit, &high_limit)) {
+        /* only the Devices in the range of a Who-Is will reply to it */
+        while (Routed_Device_GetNext_In_Range(
+            dest, DNET_list, low_limit, high_limit, &cursor)) {
+            apdu_handler(src, apdu, apdu_len);
+            bGotOne = true;
+            if (cursor < 0) {
+                break;
+            }
+        }
+    } else {
+        while (Routed_Device_GetNext(dest, DNET_list, &cursor)) {
+            apdu_handler(src, apdu, apdu_len);
+            bGotOne = true;
+            if (cursor < 0) { /* If no more matches, */
+                break; /* We don't need to keep looking */
+            }
         }
     }
     if (!bGotOne) {
@@ -0,0 +1,415 @@
+/**
+ * @file
+ * @brief A BACnet router routing table with learned-route aging
+ * @author agent <agent@local>
+ * @date October 2026
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+/* BACnet Stack API */
+#include "bacnet/basic/npdu/route_table.h"
+
+/* marks the end of a hash chain or of the free list */
+#define ROUTE_NONE UINT_MAX
+
+/* default storage, used until route_table_size_set() is called */
+static BACNET_ROUTE_TABLE_ENTRY Route_Table_Default[BACNET_ROUTE_TABLE_SIZE];
+static unsigned Route_Buckets_Default[BACNET_ROUTE_TABLE_SIZE];
+static BACNET_ROUTE_TABLE_ENTRY *Route_Table = Route_Table_Default;
+static unsigned *Route_Buckets = Route_Buckets_Default;
+static unsigned Route_Table_Size = BACNET_ROUTE_TABLE_SIZE;
+static unsigned Route_Table_Count;
+static unsigned Route_Table_Free;
+static uint32_t Route_Lifetime = BACNET_ROUTE_TABLE_LIFETIME;
+static bool Route_Table_Initialized;
+
+/**
+ * @brief Determine if an entry is in use
+ * @param entry - routing table entry
+ * @return true if the entry holds a network
+ */
+static bool route_entry_valid(const BACNET_ROUTE_TABLE_ENTRY *entry)
+{
+    /* network number zero is never in the routing table */
+    return entry->net != 0;
+}
+
+/**
+ * @brief Find the hash chain of a network number
+ * @param net - network number
+ * @return the head of the hash chain
+ */
+static unsigned *route_bucket(uint16_t net)
+{
+    return &Route_Buckets[net % Route_Table_Size];
+}
+
+/**
+ * @brief Initialize the routing table once, before it is first used
+ */
+static void route_table_init_check(void)
+{
+    if (!Route_Table_Initialized) {
+        route_table_init();
+    }
+}
+
+/**
+ * @brief Empty the routing table
+ */
+void route_table_init(void)
+{
+    unsigned index;
+
+    for (index = 0; index < Route_Table_Size; index++) {
+        memset(&Route_Table[index], 0, sizeof(BACNET_ROUTE_TABLE_ENTRY));
+        /* free entries are taken in index order */
+        if ((index + 1) < Route_Table_Size) {
+            Route_Table[index].next = index + 1;
+        } else {
+            Route_Table[index].next = ROUTE_NONE;
+        }
+        Route_Buckets[index] = ROUTE_NONE;
+    }
+    Route_Table_Free = 0;
+    Route_Table_Count = 0;
+    Route_Table_Initialized = true;
+}
+
+/**
+ * @brief Set the number of ports and networks the routing table holds.
+ *  The routing table is emptied.
+ * @param size - number of ports and networks
+ * @return true if the storage was allocated
+ */
+bool route_table_size_set(unsigned size)
+{
+    BACNET_ROUTE_TABLE_ENTRY *table = Route_Table_Default;
+    unsigned *buckets = Route_Buckets_Default;
+
+    if ((size == 0) || (size >= ROUTE_NONE)) {
+        return false;
+    }
+    if (size != BACNET_ROUTE_TABLE_SIZE) {
+        table = calloc(size, sizeof(BACNET_ROUTE_TABLE_ENTRY));
+        buckets = calloc(size, sizeof(unsigned));
+        if (!table || !buckets) {
+            free(table);
+            free(buckets);
+            return false;
+        }
+    }
+    if (Route_Table != Route_Table_Default) {
+        free(Route_Table);
+        free(Route_Buckets);
+    }
+    Route_Table = table;
+    Route_Buckets = buckets;
+    Route_Table_Size = size;
+    route_table_init();
+
+    return true;
+}
+
+/**
+ * @brief Get the number of ports and networks the routing table holds
+ * @return number of ports and networks
+ */
+unsigned route_table_size(void)
+{
+    return Route_Table_Size;
+}
+
+/**
+ * @brief Get the number of ports and networks in the routing table
+ * @return number of ports and networks
+ */
+unsigned route_table_count(void)
+{
+    return Route_Table_Count;
+}
+
+/**
+ * @brief Set the time a learned network is kept without hearing of it.
+ *  Networks that are already learned keep their remaining time.
+ * @param seconds - lifetime, or zero to keep learned networks
+ */
+void route_table_lifetime_set(uint32_t seconds)
+{
+    Route_Lifetime = seconds;
+}
+
+/**
+ * @brief Find a network in the routing table
+ * @param net - network number
+ * @return the routing table entry, or NULL if the network is not known
+ */
+BACNET_ROUTE_TABLE_ENTRY *route_table_find(uint16_t net)
+{
+    unsigned index;
+
+    if ((net == 0) || (net == BACNET_BROADCAST_NETWORK)) {
+        return NULL;
+    }
+    route_table_init_check();
+    index = *route_bucket(net);
+    while (index != ROUTE_NONE) {
+        if (Route_Table[index].net == net) {
+            return &Route_Table[index];
+        }
+        index = Route_Table[index].next;
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Get a routing table entry by index, to walk the table.
+ *  Ports and networks keep their index until they are removed.
+ * @param index - 0..route_table_size()-1
+ * @return the routing table entry, or NULL if the index is not in use
+ */
+BACNET_ROUTE_TABLE_ENTRY *route_table_entry(unsigned index)
+{
+    route_table_init_check();
+    if ((index < Route_Table_Size) &&
+        route_entry_valid(&Route_Table[index])) {
+        return &Route_Table[index];
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Copy the MAC address into a routing table entry
+ * @param entry - routing table entry
+ * @param mac - MAC address, or NULL
+ * @param mac_len - number of octets in the MAC address
+ */
+static void route_entry_mac_set(
+    BACNET_ROUTE_TABLE_ENTRY *entry, const uint8_t *mac, uint8_t mac_len)
+{
+    memset(entry->mac, 0, sizeof(entry->mac));
+    if (mac && (mac_len <= MAX_MAC_LEN)) {
+        memcpy(entry->mac, mac, mac_len);
+        entry->mac_len = mac_len;
+    } else {
+        entry->mac_len = 0;
+    }
+}
+
+/**
+ * @brief Take a free entry for a network, and add it to its hash chain
+ * @param net - network number
+ * @return the routing table entry, or NULL if the table is full
+ */
+static BACNET_ROUTE_TABLE_ENTRY *route_entry_add(uint16_t net)
+{
+    BACNET_ROUTE_TABLE_ENTRY *entry;
+    unsigned *bucket;
+    unsigned index;
+
+    index = Route_Table_Free;
+    if (index == ROUTE_NONE) {
+        return NULL;
+    }
+    entry = &Route_Table[index];
+    Route_Table_Free = entry->next;
+    memset(entry, 0, sizeof(BACNET_ROUTE_TABLE_ENTRY));
+    entry->net = net;
+    bucket = route_bucket(net);
+    entry->next = *bucket;
+    *bucket = index;
+    Route_Table_Count++;
+
+    return entry;
+}
+
+/**
+ * @brief Add a directly connected port to the routing table.
+ *  A learned network with the same number is replaced by the port.
+ * @param net - network number of the port
+ * @param mac - MAC address of the port on its network
+ * @param mac_len - number of octets in the MAC address
+ * @return true if the port is in the routing table
+ */
+bool route_table_port_add(uint16_t net, const uint8_t *mac, uint8_t mac_len)
+{
+    BACNET_ROUTE_TABLE_ENTRY *entry;
+
+    if ((net == 0) || (net == BACNET_BROADCAST_NETWORK)) {
+        return false;
+    }
+    entry = route_table_find(net);
+    if (!entry) {
+        entry = route_entry_add(net);
+        if (!entry) {
+            return false;
+        }
+    }
+    entry->port_net = net;
+    route_entry_mac_set(entry, mac, mac_len);
+    entry->status = BACNET_ROUTE_AVAILABLE;
+    entry->busy_seconds = 0;
+    entry->lifetime_seconds = 0;
+
+    return true;
+}
+
+/**
+ * @brief Add or refresh a network that is reachable through a port,
+ *  from an I-Am-Router-To-Network or a routed message.
+ *  A directly connected port is never replaced by a learned network.
+ * @param net - network number that is reachable
+ * @param port_net - network number of the port it is reachable through
+ * @param mac - MAC address of the next router on the path
+ * @param mac_len - number of octets in the MAC address
+ * @return true if the network is in the routing table
+ */
+bool route_table_learn(
+    uint16_t net, uint16_t port_net, const uint8_t *mac, uint8_t mac_len)
+{
+    BACNET_ROUTE_TABLE_ENTRY *entry;
+    BACNET_ROUTE_TABLE_ENTRY *port;
+
+    if ((net == 0) || (net == BACNET_BROADCAST_NETWORK)) {
+        return false;
+    }
+    port = route_table_find(port_net);
+    if (!port || (port->port_net != port_net)) {
+        return false;
+    }
+    entry = route_table_find(net);
+    if (entry) {
+        if (entry->port_net == entry->net) {
+            /* directly connected */
+            return false;
+        }
+    } else {
+        entry = route_entry_add(net);
+        if (!entry) {
+            return false;
+        }
+    }
+    entry->port_net = port_net;
+    route_entry_mac_set(entry, mac, mac_len);
+    entry->status = BACNET_ROUTE_AVAILABLE;
+    entry->busy_seconds = 0;
+    entry->lifetime_seconds = Route_Lifetime;
+
+    return true;
+}
+
+/**
+ * @brief Remove a port or network from the routing table.
+ *  The networks reachable through a removed port are removed too.
+ * @param net - network number
+ * @return true if the network was in the routing table
+ */
+bool route_table_remove(uint16_t net)
+{
+    BACNET_ROUTE_TABLE_ENTRY *entry;
+    unsigned *link;
+    unsigned index;
+    bool found = false;
+    bool port = false;
+
+    if ((net == 0) || (net == BACNET_BROADCAST_NETWORK)) {
+        return false;
+    }
+    route_table_init_check();
+    link = route_bucket(net);
+    while (*link != ROUTE_NONE) {
+        index = *link;
+        entry = &Route_Table[index];
+        if (entry->net == net) {
+            found = true;
+            port = (entry->port_net == net);
+            *link = entry->next;
+            memset(entry, 0, sizeof(BACNET_ROUTE_TABLE_ENTRY));
+            entry->next = Route_Table_Free;
+            Route_Table_Free = index;
+            Route_Table_Count--;
+            break;
+        }
+        link = &entry->next;
+    }
+    if (port) {
+        for (index = 0; index < Route_Table_Size; index++) {
+            entry = &Route_Table[index];
+            if (route_entry_valid(entry) && (entry->port_net == net)) {
+                route_table_remove(entry->net);
+            }
+        }
+    }
+
+    return found;
+}
+
+/**
+ * @brief Set the reachability status of a learned network, from
+ *  Router-Busy-To-Network, Router-Available-To-Network or
+ *  Reject-Message-To-Network. A busy network becomes available again
+ *  after BACNET_ROUTE_TABLE_BUSY_TIME seconds.
+ * @param net - network number
+ * @param status - reachability status
+ * @return true if the network is learned and its status was set
+ */
+bool route_table_status_set(uint16_t net, BACNET_ROUTE_STATUS status)
+{
+    BACNET_ROUTE_TABLE_ENTRY *entry;
+
+    entry = route_table_find(net);
+    if (!entry || (entry->port_net == entry->net)) {
+        return false;
+    }
+    entry->status = status;
+    if (status == BACNET_ROUTE_BUSY) {
+        entry->busy_seconds = BACNET_ROUTE_TABLE_BUSY_TIME;
+    } else {
+        entry->busy_seconds = 0;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Age the learned networks: busy networks become available,
+ *  and networks that were not heard of for their lifetime are removed.
+ * @param seconds - number of seconds elapsed since the previous call
+ */
+void route_table_timer_seconds(uint32_t seconds)
+{
+    BACNET_ROUTE_TABLE_ENTRY *entry;
+    unsigned index;
+
+    route_table_init_check();
+    for (index = 0; index < Route_Table_Size; index++) {
+        entry = &Route_Table[index];
+        if (!route_entry_valid(entry) || (entry->port_net == entry->net)) {
+            continue;
+        }
+        if (entry->status == BACNET_ROUTE_BUSY) {
+            if (entry->busy_seconds > seconds) {
+                entry->busy_seconds -= (uint16_t)seconds;
+            } else {
+                entry->busy_seconds = 0;
+                entry->status = BACNET_ROUTE_AVAILABLE;
+            }
+        }
+        if (entry->lifetime_seconds) {
+            if (entry->lifetime_seconds > seconds) {
+                entry->lifetime_seconds -= seconds;
+            } else {
+                route_table_remove(entry->net);
+            }
+        }
+    }
+}
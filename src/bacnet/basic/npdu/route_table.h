@@ -0,0 +1,101 @@
+/**
+ * @file
+ * @brief A BACnet router routing table with learned-route aging
+ * @author agent <agent@local>
+ * @date October 2026
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * 6.6.1 Routing Tables
+ *
+ * The routing table holds the network number of each directly connected
+ * port, and each network that is reachable through a port along with the
+ * MAC address of the next router on the path to it and its reachability
+ * status. The networks are found by number in a hash table, so that
+ * routing a packet does not depend on the number of known networks.
+ */
+#ifndef BACNET_BASIC_NPDU_ROUTE_TABLE_H
+#define BACNET_BASIC_NPDU_ROUTE_TABLE_H
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+
+/* number of ports and networks held without calling
+   route_table_size_set() */
+#ifndef BACNET_ROUTE_TABLE_SIZE
+#define BACNET_ROUTE_TABLE_SIZE 256
+#endif
+/* seconds a learned network is kept without hearing of it again,
+   or zero to keep it until it is removed */
+#ifndef BACNET_ROUTE_TABLE_LIFETIME
+#define BACNET_ROUTE_TABLE_LIFETIME 900
+#endif
+/* seconds a network stays busy without a Router-Available-To-Network */
+#ifndef BACNET_ROUTE_TABLE_BUSY_TIME
+#define BACNET_ROUTE_TABLE_BUSY_TIME 30
+#endif
+
+/* reachability status of a network in the routing table */
+typedef enum bacnet_route_status {
+    BACNET_ROUTE_AVAILABLE = 0,
+    /* temporarily unreachable due to congestion control */
+    BACNET_ROUTE_BUSY = 1,
+    /* permanent failure of the route */
+    BACNET_ROUTE_UNREACHABLE = 2
+} BACNET_ROUTE_STATUS;
+
+typedef struct bacnet_route_table_entry {
+    /* network number */
+    uint16_t net;
+    /* network number of the directly connected port to reach it.
+       For a directly connected port, it is the same as net. */
+    uint16_t port_net;
+    /* MAC address of the port, or of the next router on the path */
+    uint8_t mac[MAX_MAC_LEN];
+    uint8_t mac_len;
+    BACNET_ROUTE_STATUS status;
+    /* seconds until busy becomes available again */
+    uint16_t busy_seconds;
+    /* seconds until a learned network is forgotten */
+    uint32_t lifetime_seconds;
+    /* private: hash chain or free list */
+    unsigned next;
+} BACNET_ROUTE_TABLE_ENTRY;
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+BACNET_STACK_EXPORT
+void route_table_init(void);
+BACNET_STACK_EXPORT
+bool route_table_size_set(unsigned size);
+BACNET_STACK_EXPORT
+unsigned route_table_size(void);
+BACNET_STACK_EXPORT
+unsigned route_table_count(void);
+BACNET_STACK_EXPORT
+void route_table_lifetime_set(uint32_t seconds);
+
+BACNET_STACK_EXPORT
+bool route_table_port_add(
+    uint16_t net, const uint8_t *mac, uint8_t mac_len);
+BACNET_STACK_EXPORT
+bool route_table_learn(
+    uint16_t net, uint16_t port_net, const uint8_t *mac, uint8_t mac_len);
+BACNET_STACK_EXPORT
+bool route_table_remove(uint16_t net);
+BACNET_STACK_EXPORT
+BACNET_ROUTE_TABLE_ENTRY *route_table_find(uint16_t net);
+BACNET_STACK_EXPORT
+BACNET_ROUTE_TABLE_ENTRY *route_table_entry(unsigned index);
+BACNET_STACK_EXPORT
+bool route_table_status_set(uint16_t net, BACNET_ROUTE_STATUS status);
+BACNET_STACK_EXPORT
+void route_table_timer_seconds(uint32_t seconds);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
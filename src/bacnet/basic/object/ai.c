@@ -28,6 +28,12 @@
 
 /* Key List for storing the object data sorted by instance number  */
 static OS_Keylist Object_List;
+/* called when an object is created, deleted, renamed or changed */
+static object_changed_function Object_Changed_Callback;
+#if defined(INTRINSIC_REPORTING)
+/* Key List of the objects with an active event, sorted by instance */
+static OS_Keylist Event_Active_List;
+#endif
 /* common object type */
 static const BACNET_OBJECT_TYPE Object_Type = OBJECT_ANALOG_INPUT;
 
@@ -172,6 +178,48 @@ float Analog_Input_Present_Value(uint32_t object_instance)
     return value;
 }
 
+/**
+ * @brief Sets the COV flag of an object, and reports the change to the
+ *  object changed callback when the flag was clear
+ * @param  pObject - specific object with valid data
+ * @param  object_instance - object-instance number of the object
+ */
+static void Analog_Input_COV_Changed(
+    struct analog_input_descr *pObject, uint32_t object_instance)
+{
+    if (!pObject->Changed) {
+        pObject->Changed = true;
+        if (Object_Changed_Callback) {
+            Object_Changed_Callback(
+                Object_Type, object_instance, OBJECT_CHANGE_COV);
+        }
+    }
+}
+
+/**
+ * @brief Reports an event change to the object changed callback, so that
+ *  an object that can change its Event_State is evaluated on the next
+ *  intrinsic reporting tick
+ * @param  pObject - specific object with valid data
+ * @param  object_instance - object-instance number of the object
+ */
+static void Analog_Input_Event_Detection_Changed(
+    struct analog_input_descr *pObject, uint32_t object_instance)
+{
+#if defined(INTRINSIC_REPORTING)
+    if (Object_Changed_Callback && pObject->Event_Detection_Enable &&
+        (pObject->Event_Enable ||
+         (pObject->Event_State != EVENT_STATE_NORMAL) ||
+         pObject->Ack_notify_data.bSendAckNotify)) {
+        Object_Changed_Callback(
+            Object_Type, object_instance, OBJECT_CHANGE_EVENT);
+    }
+#else
+    (void)pObject;
+    (void)object_instance;
+#endif
+}
+
 /**
  * This function is used to detect a value change,
  * using the new value compared against the prior
@@ -179,11 +227,12 @@ float Analog_Input_Present_Value(uint32_t object_instance)
  *
  * This method will update the COV-changed attribute.
  *
- * @param index  Object index
+ * @param pObject  Object data
+ * @param object_instance  Object instance number
  * @param value  Given present value.
  */
-static void
-Analog_Input_COV_Detect(struct analog_input_descr *pObject, float value)
+static void Analog_Input_COV_Detect(
+    struct analog_input_descr *pObject, uint32_t object_instance, float value)
 {
     float prior_value = 0.0f;
     float cov_increment = 0.0f;
@@ -198,7 +247,7 @@ Analog_Input_COV_Detect(struct analog_input_descr *pObject, float value)
             cov_delta = value - prior_value;
         }
         if (cov_delta >= cov_increment) {
-            pObject->Changed = true;
+            Analog_Input_COV_Changed(pObject, object_instance);
             pObject->Prior_Value = value;
         }
     }
@@ -217,8 +266,9 @@ void Analog_Input_Present_Value_Set(uint32_t object_instance, float value)
 
     pObject = Analog_Input_Object(object_instance);
     if (pObject) {
-        Analog_Input_COV_Detect(pObject, value);
+        Analog_Input_COV_Detect(pObject, object_instance, value);
         pObject->Present_Value = value;
+        Analog_Input_Event_Detection_Changed(pObject, object_instance);
     }
 }
 
@@ -292,6 +342,10 @@ bool Analog_Input_Name_Set(uint32_t object_instance, const char *new_name)
     if (pObject) {
         status = characterstring_init_ansi(&pObject->Object_Name, new_name);
     }
+    if (status && Object_Changed_Callback) {
+        Object_Changed_Callback(
+            Object_Type, object_instance, OBJECT_CHANGE_NAME);
+    }
 
     return status;
 }
@@ -378,6 +432,7 @@ bool Analog_Input_Event_Detection_Enable_Set(
 
     if (pObject) {
         pObject->Event_Detection_Enable = value;
+        Analog_Input_Event_Detection_Changed(pObject, object_instance);
         retval = true;
     }
 
@@ -559,7 +614,8 @@ void Analog_Input_COV_Increment_Set(uint32_t object_instance, float value)
     pObject = Analog_Input_Object(object_instance);
     if (pObject) {
         pObject->COV_Increment = value;
-        Analog_Input_COV_Detect(pObject, pObject->Present_Value);
+        Analog_Input_COV_Detect(
+            pObject, object_instance, pObject->Present_Value);
     }
 }
 
@@ -638,7 +694,8 @@ void Analog_Input_Out_Of_Service_Set(uint32_t object_instance, bool value)
     pObject = Analog_Input_Object(object_instance);
     if (pObject) {
         if (pObject->Out_Of_Service != value) {
-            pObject->Changed = true;
+            Analog_Input_COV_Changed(pObject, object_instance);
+            Analog_Input_Event_Detection_Changed(pObject, object_instance);
             /* Lets backup Present_Value when going Out_Of_Service  or restore
              * when going out of Out_Of_Service */
             if ((pObject->Out_Of_Service = value)) {
@@ -685,6 +742,7 @@ bool Analog_Input_Time_Delay_Set(uint32_t object_instance, uint32_t time_delay)
 
     if (pObject) {
         pObject->Time_Delay = time_delay;
+        Analog_Input_Event_Detection_Changed(pObject, object_instance);
         status = true;
     }
 
@@ -768,6 +826,7 @@ bool Analog_Input_High_Limit_Set(uint32_t object_instance, float high_limit)
 
     if (pObject) {
         pObject->High_Limit = high_limit;
+        Analog_Input_Event_Detection_Changed(pObject, object_instance);
         status = true;
     }
 
@@ -808,6 +867,7 @@ bool Analog_Input_Low_Limit_Set(uint32_t object_instance, float low_limit)
 
     if (pObject) {
         pObject->Low_Limit = low_limit;
+        Analog_Input_Event_Detection_Changed(pObject, object_instance);
         status = true;
     }
 
@@ -848,6 +908,7 @@ bool Analog_Input_Deadband_Set(uint32_t object_instance, float deadband)
 
     if (pObject) {
         pObject->Deadband = deadband;
+        Analog_Input_Event_Detection_Changed(pObject, object_instance);
         status = true;
     }
 
@@ -891,6 +952,7 @@ bool Analog_Input_Limit_Enable_Set(
         if (!(limit_enable &
               ~(EVENT_LOW_LIMIT_ENABLE | EVENT_HIGH_LIMIT_ENABLE))) {
             pObject->Limit_Enable = limit_enable;
+            Analog_Input_Event_Detection_Changed(pObject, object_instance);
             status = true;
         }
     }
@@ -936,6 +998,7 @@ bool Analog_Input_Event_Enable_Set(
               ~(EVENT_ENABLE_TO_OFFNORMAL | EVENT_ENABLE_TO_FAULT |
                 EVENT_ENABLE_TO_NORMAL))) {
             pObject->Event_Enable = event_enable;
+            Analog_Input_Event_Detection_Changed(pObject, object_instance);
             status = true;
         }
     }
@@ -1407,9 +1470,43 @@ bool Analog_Input_Write_Property(BACNET_WRITE_PROPERTY_DATA *wp_data)
             break;
     }
 
+    if (status) {
+        /* an event property or the monitored value may have changed */
+        Analog_Input_Event_Detection_Changed(pObject, wp_data->object_instance);
+    }
+
     return status;
 }
 
+#if defined(INTRINSIC_REPORTING)
+/**
+ * @brief Keep an object in the list of objects with an active event while
+ *  its Event_State is not NORMAL or a transition is not acknowledged
+ * @param object_instance - object-instance number of the object
+ * @param pObject - object data
+ */
+static void Analog_Input_Event_Active_Update(
+    uint32_t object_instance, struct analog_input_descr *pObject)
+{
+    bool active;
+
+    active = (pObject->Event_State != EVENT_STATE_NORMAL) ||
+        !pObject->Acked_Transitions[TRANSITION_TO_OFFNORMAL].bIsAcked ||
+        !pObject->Acked_Transitions[TRANSITION_TO_FAULT].bIsAcked ||
+        !pObject->Acked_Transitions[TRANSITION_TO_NORMAL].bIsAcked;
+    if (active) {
+        if (!Event_Active_List) {
+            Event_Active_List = Keylist_Create();
+        }
+        if (Keylist_Index(Event_Active_List, object_instance) < 0) {
+            Keylist_Data_Add(Event_Active_List, object_instance, pObject);
+        }
+    } else {
+        Keylist_Data_Delete(Event_Active_List, object_instance);
+    }
+}
+#endif
+
 /**
  * @brief Handles the Intrinsic Reporting Service for the Analog Input Object
  * @param  object_instance - object-instance number of the object
@@ -1742,6 +1839,13 @@ void Analog_Input_Intrinsic_Reporting(uint32_t object_instance)
                     break;
             }
         }
+        Analog_Input_Event_Active_Update(object_instance, CurrentAI);
+    }
+    if ((CurrentAI->Remaining_Time_Delay != CurrentAI->Time_Delay) ||
+        (event_data.notifyType == NOTIFY_ACK_NOTIFICATION)) {
+        /* the Time_Delay is counting or has just elapsed, or the value
+           was not evaluated because an AckNotification was sent */
+        Analog_Input_Event_Detection_Changed(CurrentAI, object_instance);
     }
 #else
     (void)object_instance;
@@ -1749,6 +1853,33 @@ void Analog_Input_Intrinsic_Reporting(uint32_t object_instance)
 }
 
 #if defined(INTRINSIC_REPORTING)
+/**
+ * @brief Finds the next Analog Input object with an active event
+ * @param object_instance [in,out] object-instance number to start at,
+ *  and the object-instance number of the object found
+ * @param index [out] index of the object found, for
+ *  Analog_Input_Event_Information()
+ * @return true if an object was found
+ */
+bool Analog_Input_Event_Active_Next(uint32_t *object_instance, unsigned *index)
+{
+    KEY key = 0;
+    int i;
+
+    i = Keylist_Index_Next(Event_Active_List, *object_instance);
+    if ((i < 0) || !Keylist_Index_Key(Event_Active_List, i, &key)) {
+        return false;
+    }
+    i = Keylist_Index(Object_List, key);
+    if (i < 0) {
+        return false;
+    }
+    *object_instance = key;
+    *index = (unsigned)i;
+
+    return true;
+}
+
 /**
  * @brief Handles getting the Event Information for the Analog Input Object
  * @param  index - index number of the object 0..count
@@ -1935,6 +2066,10 @@ int Analog_Input_Alarm_Ack(
     /* Need to send AckNotification. */
     CurrentAI->Ack_notify_data.bSendAckNotify = true;
     CurrentAI->Ack_notify_data.EventState = alarmack_data->eventStateAcked;
+    Analog_Input_Event_Active_Update(
+        alarmack_data->eventObjectIdentifier.instance, CurrentAI);
+    Analog_Input_Event_Detection_Changed(
+        CurrentAI, alarmack_data->eventObjectIdentifier.instance);
 
     return 1;
 }
@@ -2041,6 +2176,10 @@ uint32_t Analog_Input_Create(uint32_t object_instance)
                 free(pObject);
                 return BACNET_MAX_INSTANCE;
             }
+            if (Object_Changed_Callback) {
+                Object_Changed_Callback(
+                    Object_Type, object_instance, OBJECT_CHANGE_CREATED);
+            }
         } else {
             return BACNET_MAX_INSTANCE;
         }
@@ -2061,13 +2200,41 @@ bool Analog_Input_Delete(uint32_t object_instance)
 
     pObject = Keylist_Data_Delete(Object_List, object_instance);
     if (pObject) {
+#if defined(INTRINSIC_REPORTING)
+        Keylist_Data_Delete(Event_Active_List, object_instance);
+#endif
         free(pObject);
         status = true;
+        if (Object_Changed_Callback) {
+            Object_Changed_Callback(
+                Object_Type, object_instance, OBJECT_CHANGE_DELETED);
+        }
     }
 
     return status;
 }
 
+/**
+ * @brief Sets the function that is called when an object is created,
+ *  deleted, renamed or changed, so that the Device object, the COV
+ *  handler and intrinsic reporting do not poll for them
+ * @param  cb - function to call, or NULL to stop calling
+ * @return the OBJECT_CHANGE_x changes that are reported
+ */
+unsigned Analog_Input_Changed_Callback_Set(object_changed_function cb)
+{
+    unsigned changes;
+
+    Object_Changed_Callback = cb;
+    changes = OBJECT_CHANGE_CREATED | OBJECT_CHANGE_DELETED |
+        OBJECT_CHANGE_NAME | OBJECT_CHANGE_COV;
+#if defined(INTRINSIC_REPORTING)
+    changes |= OBJECT_CHANGE_EVENT;
+#endif
+
+    return changes;
+}
+
 /**
  * @brief Deletes all the Analog Inputs and their data
  */
@@ -2085,6 +2252,10 @@ void Analog_Input_Cleanup(void)
         Keylist_Delete(Object_List);
         Object_List = NULL;
     }
+#if defined(INTRINSIC_REPORTING)
+    Keylist_Delete(Event_Active_List);
+    Event_Active_List = NULL;
+#endif
 }
 
 /**
@@ -2103,5 +2274,10 @@ void Analog_Input_Init(void)
     handler_alarm_ack_set(Object_Type, Analog_Input_Alarm_Ack);
     /* Set handler for GetAlarmSummary Service */
     handler_get_alarm_summary_set(Object_Type, Analog_Input_Alarm_Summary);
+    /* Set the index of active events for both services */
+    handler_get_event_information_active_set(
+        Object_Type, Analog_Input_Event_Active_Next);
+    handler_get_alarm_summary_active_set(
+        Object_Type, Analog_Input_Event_Active_Next);
 #endif
 }
@@ -16,6 +16,7 @@
 /* BACnet Stack API */
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/object/device.h"
 #if defined(INTRINSIC_REPORTING)
 #include "bacnet/basic/object/nc.h"
 #include "bacnet/getevent.h"
@@ -201,6 +202,8 @@ bool Analog_Input_Notify_Type_Set(
 BACNET_STACK_EXPORT
 int Analog_Input_Event_Information(
     unsigned index, BACNET_GET_EVENT_INFORMATION_DATA *getevent_data);
+BACNET_STACK_EXPORT
+bool Analog_Input_Event_Active_Next(uint32_t *object_instance, unsigned *index);
 
 BACNET_STACK_EXPORT
 int Analog_Input_Alarm_Ack(
@@ -216,6 +219,8 @@ uint32_t Analog_Input_Create(uint32_t object_instance);
 BACNET_STACK_EXPORT
 bool Analog_Input_Delete(uint32_t object_instance);
 BACNET_STACK_EXPORT
+unsigned Analog_Input_Changed_Callback_Set(object_changed_function cb);
+BACNET_STACK_EXPORT
 void Analog_Input_Cleanup(void);
 BACNET_STACK_EXPORT
 void Analog_Input_Init(void);
@@ -49,6 +49,8 @@ struct object_data {
 };
 /* Key List for storing the object data sorted by instance number  */
 static OS_Keylist Object_List;
+/* called when an object is created, deleted, renamed or changed */
+static object_changed_function Object_Changed_Callback;
 /* common object type */
 static const BACNET_OBJECT_TYPE Object_Type = OBJECT_ANALOG_OUTPUT;
 /* callback for present value writes */
@@ -281,14 +283,33 @@ bool Analog_Output_Relinquish_Default_Set(uint32_t object_instance, float value)
     return status;
 }
 
+/**
+ * @brief Sets the COV flag of an object, and reports the change to the
+ *  object changed callback when the flag was clear
+ * @param  pObject - specific object with valid data
+ * @param  object_instance - object-instance number of the object
+ */
+static void
+Analog_Output_COV_Changed(struct object_data *pObject, uint32_t object_instance)
+{
+    if (!pObject->Changed) {
+        pObject->Changed = true;
+        if (Object_Changed_Callback) {
+            Object_Changed_Callback(
+                Object_Type, object_instance, OBJECT_CHANGE_COV);
+        }
+    }
+}
+
 /**
  * For a given object instance-number, checks the present-value for COV
  *
  * @param  pObject - specific object with valid data
+ * @param  object_instance - object-instance number of the object
  * @param  value - floating point analog value
  */
-static void
-Analog_Output_Present_Value_COV_Detect(struct object_data *pObject, float value)
+static void Analog_Output_Present_Value_COV_Detect(
+    struct object_data *pObject, uint32_t object_instance, float value)
 {
     float prior_value = 0.0;
     float cov_increment = 0.0;
@@ -303,7 +324,7 @@ Analog_Output_Present_Value_COV_Detect(struct object_data *pObject, float value)
             cov_delta = value - prior_value;
         }
         if (cov_delta >= cov_increment) {
-            pObject->Changed = true;
+            Analog_Output_COV_Changed(pObject, object_instance);
             pObject->Prior_Value = value;
         }
     }
@@ -331,7 +352,8 @@ bool Analog_Output_Present_Value_Set(
             pObject->Relinquished[priority - 1] = false;
             pObject->Priority_Array[priority - 1] = value;
             Analog_Output_Present_Value_COV_Detect(
-                pObject, Analog_Output_Present_Value(object_instance));
+                pObject, object_instance,
+                Analog_Output_Present_Value(object_instance));
             status = true;
         }
     }
@@ -357,7 +379,8 @@ bool Analog_Output_Present_Value_Relinquish(
             pObject->Relinquished[priority - 1] = true;
             pObject->Priority_Array[priority - 1] = 0.0;
             Analog_Output_Present_Value_COV_Detect(
-                pObject, Analog_Output_Present_Value(object_instance));
+                pObject, object_instance,
+                Analog_Output_Present_Value(object_instance));
             status = true;
         }
     }
@@ -530,6 +553,10 @@ bool Analog_Output_Name_Set(uint32_t object_instance, const char *new_name)
         status = true;
         pObject->Object_Name = new_name;
     }
+    if (status && Object_Changed_Callback) {
+        Object_Changed_Callback(
+            Object_Type, object_instance, OBJECT_CHANGE_NAME);
+    }
 
     return status;
 }
@@ -630,7 +657,7 @@ void Analog_Output_Out_Of_Service_Set(uint32_t object_instance, bool value)
     if (pObject) {
         if (pObject->Out_Of_Service != value) {
             pObject->Out_Of_Service = value;
-            pObject->Changed = true;
+            Analog_Output_COV_Changed(pObject, object_instance);
         }
     }
 }
@@ -668,7 +695,7 @@ void Analog_Output_Overridden_Set(uint32_t object_instance, bool value)
     if (pObject) {
         if (pObject->Overridden != value) {
             pObject->Overridden = value;
-            pObject->Changed = true;
+            Analog_Output_COV_Changed(pObject, object_instance);
         }
     }
 }
@@ -728,7 +755,7 @@ bool Analog_Output_Reliability_Set(
             fault = Analog_Output_Object_Fault(pObject);
             pObject->Reliability = value;
             if (fault != Analog_Output_Object_Fault(pObject)) {
-                pObject->Changed = true;
+                Analog_Output_COV_Changed(pObject, object_instance);
             }
             status = true;
         }
@@ -1239,6 +1266,10 @@ uint32_t Analog_Output_Create(uint32_t object_instance)
                 free(pObject);
                 return BACNET_MAX_INSTANCE;
             }
+            if (Object_Changed_Callback) {
+                Object_Changed_Callback(
+                    Object_Type, object_instance, OBJECT_CHANGE_CREATED);
+            }
         } else {
             return BACNET_MAX_INSTANCE;
         }
@@ -1261,11 +1292,30 @@ bool Analog_Output_Delete(uint32_t object_instance)
     if (pObject) {
         free(pObject);
         status = true;
+        if (Object_Changed_Callback) {
+            Object_Changed_Callback(
+                Object_Type, object_instance, OBJECT_CHANGE_DELETED);
+        }
     }
 
     return status;
 }
 
+/**
+ * @brief Sets the function that is called when an object is created,
+ *  deleted, renamed or changed, so that the Device object and the COV
+ *  handler do not poll for them
+ * @param  cb - function to call, or NULL to stop calling
+ * @return the OBJECT_CHANGE_x changes that are reported
+ */
+unsigned Analog_Output_Changed_Callback_Set(object_changed_function cb)
+{
+    Object_Changed_Callback = cb;
+
+    return OBJECT_CHANGE_CREATED | OBJECT_CHANGE_DELETED | OBJECT_CHANGE_NAME |
+        OBJECT_CHANGE_COV;
+}
+
 /**
  * @brief Deletes all the Analog Outputs and their data
  */
@@ -17,6 +17,7 @@
 #include "bacnet/bacerror.h"
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/object/device.h"
 
 /**
  * @brief Callback for gateway write present value request
@@ -130,6 +131,8 @@ uint32_t Analog_Output_Create(uint32_t object_instance);
 BACNET_STACK_EXPORT
 bool Analog_Output_Delete(uint32_t object_instance);
 BACNET_STACK_EXPORT
+unsigned Analog_Output_Changed_Callback_Set(object_changed_function cb);
+BACNET_STACK_EXPORT
 void Analog_Output_Cleanup(void);
 BACNET_STACK_EXPORT
 void Analog_Output_Init(void);
@@ -30,6 +30,12 @@
 
 /* Key List for storing the object data sorted by instance number  */
 static OS_Keylist Object_List;
+/* called when an object is created, deleted, renamed or changed */
+static object_changed_function Object_Changed_Callback;
+#if defined(INTRINSIC_REPORTING)
+/* Key List of the objects with an active event, sorted by instance */
+static OS_Keylist Event_Active_List;
+#endif
 /* common object type */
 static const BACNET_OBJECT_TYPE Object_Type = OBJECT_ANALOG_VALUE;
 
@@ -174,6 +180,48 @@ float Analog_Value_Present_Value(uint32_t object_instance)
     return value;
 }
 
+/**
+ * @brief Sets the COV flag of an object, and reports the change to the
+ *  object changed callback when the flag was clear
+ * @param  pObject - specific object with valid data
+ * @param  object_instance - object-instance number of the object
+ */
+static void Analog_Value_COV_Changed(
+    struct analog_value_descr *pObject, uint32_t object_instance)
+{
+    if (!pObject->Changed) {
+        pObject->Changed = true;
+        if (Object_Changed_Callback) {
+            Object_Changed_Callback(
+                Object_Type, object_instance, OBJECT_CHANGE_COV);
+        }
+    }
+}
+
+/**
+ * @brief Reports an event change to the object changed callback, so that
+ *  an object that can change its Event_State is evaluated on the next
+ *  intrinsic reporting tick
+ * @param  pObject - specific object with valid data
+ * @param  object_instance - object-instance number of the object
+ */
+static void Analog_Value_Event_Detection_Changed(
+    struct analog_value_descr *pObject, uint32_t object_instance)
+{
+#if defined(INTRINSIC_REPORTING)
+    if (Object_Changed_Callback && pObject->Event_Detection_Enable &&
+        (pObject->Event_Enable ||
+         (pObject->Event_State != EVENT_STATE_NORMAL) ||
+         pObject->Ack_notify_data.bSendAckNotify)) {
+        Object_Changed_Callback(
+            Object_Type, object_instance, OBJECT_CHANGE_EVENT);
+    }
+#else
+    (void)pObject;
+    (void)object_instance;
+#endif
+}
+
 /**
  * This function is used to detect a value change,
  * using the new value compared against the prior
@@ -181,11 +229,12 @@ float Analog_Value_Present_Value(uint32_t object_instance)
  *
  * This method will update the COV-changed attribute.
  *
- * @param index  Object index
+ * @param pObject  Object data
+ * @param object_instance  Object instance number
  * @param value  Given present value.
  */
-static void
-Analog_Value_COV_Detect(struct analog_value_descr *pObject, float value)
+static void Analog_Value_COV_Detect(
+    struct analog_value_descr *pObject, uint32_t object_instance, float value)
 {
     float prior_value = 0.0f;
     float cov_increment = 0.0f;
@@ -200,7 +249,7 @@ Analog_Value_COV_Detect(struct analog_value_descr *pObject, float value)
             cov_delta = value - prior_value;
         }
         if (cov_delta >= cov_increment) {
-            pObject->Changed = true;
+            Analog_Value_COV_Changed(pObject, object_instance);
             pObject->Prior_Value = value;
         }
     }
@@ -225,8 +274,9 @@ bool Analog_Value_Present_Value_Set(
     (void)priority;
     pObject = Analog_Value_Object(object_instance);
     if (pObject) {
-        Analog_Value_COV_Detect(pObject, value);
+        Analog_Value_COV_Detect(pObject, object_instance, value);
         pObject->Present_Value = value;
+        Analog_Value_Event_Detection_Changed(pObject, object_instance);
         status = true;
     }
 
@@ -304,6 +354,10 @@ bool Analog_Value_Name_Set(uint32_t object_instance, const char *new_name)
     if (pObject) {
         status = characterstring_init_ansi(&pObject->Object_Name, new_name);
     }
+    if (status && Object_Changed_Callback) {
+        Object_Changed_Callback(
+            Object_Type, object_instance, OBJECT_CHANGE_NAME);
+    }
 
     return status;
 }
@@ -389,6 +443,7 @@ bool Analog_Value_Event_Detection_Enable_Set(
 
     if (pObject) {
         pObject->Event_Detection_Enable = value;
+        Analog_Value_Event_Detection_Changed(pObject, object_instance);
         retval = true;
     }
 #endif
@@ -570,7 +625,8 @@ void Analog_Value_COV_Increment_Set(uint32_t object_instance, float value)
     pObject = Analog_Value_Object(object_instance);
     if (pObject) {
         pObject->COV_Increment = value;
-        Analog_Value_COV_Detect(pObject, pObject->Present_Value);
+        Analog_Value_COV_Detect(
+            pObject, object_instance, pObject->Present_Value);
     }
 }
 
@@ -649,7 +705,8 @@ void Analog_Value_Out_Of_Service_Set(uint32_t object_instance, bool value)
     pObject = Analog_Value_Object(object_instance);
     if (pObject) {
         if (pObject->Out_Of_Service != value) {
-            pObject->Changed = true;
+            Analog_Value_COV_Changed(pObject, object_instance);
+            Analog_Value_Event_Detection_Changed(pObject, object_instance);
             /* Lets backup Present_Value when going Out_Of_Service  or restore
              * when going out of Out_Of_Service */
             if ((pObject->Out_Of_Service = value)) {
@@ -1123,9 +1180,44 @@ bool Analog_Value_Write_Property(BACNET_WRITE_PROPERTY_DATA *wp_data)
             break;
     }
 
+    if (status) {
+        /* an event property or the monitored value may have changed */
+        Analog_Value_Event_Detection_Changed(
+            CurrentAV, wp_data->object_instance);
+    }
+
     return status;
 }
 
+#if defined(INTRINSIC_REPORTING)
+/**
+ * @brief Keep an object in the list of objects with an active event while
+ *  its Event_State is not NORMAL or a transition is not acknowledged
+ * @param object_instance - object-instance number of the object
+ * @param pObject - object data
+ */
+static void Analog_Value_Event_Active_Update(
+    uint32_t object_instance, struct analog_value_descr *pObject)
+{
+    bool active;
+
+    active = (pObject->Event_State != EVENT_STATE_NORMAL) ||
+        !pObject->Acked_Transitions[TRANSITION_TO_OFFNORMAL].bIsAcked ||
+        !pObject->Acked_Transitions[TRANSITION_TO_FAULT].bIsAcked ||
+        !pObject->Acked_Transitions[TRANSITION_TO_NORMAL].bIsAcked;
+    if (active) {
+        if (!Event_Active_List) {
+            Event_Active_List = Keylist_Create();
+        }
+        if (Keylist_Index(Event_Active_List, object_instance) < 0) {
+            Keylist_Data_Add(Event_Active_List, object_instance, pObject);
+        }
+    } else {
+        Keylist_Data_Delete(Event_Active_List, object_instance);
+    }
+}
+#endif
+
 /**
  * @brief Analog Value intrinsic reporting function.
  * @param object_instance [in] BACnet object-instance number of the object
@@ -1476,6 +1568,13 @@ void Analog_Value_Intrinsic_Reporting(uint32_t object_instance)
                     break;
             }
         }
+        Analog_Value_Event_Active_Update(object_instance, CurrentAV);
+    }
+    if ((CurrentAV->Remaining_Time_Delay != CurrentAV->Time_Delay) ||
+        (event_data.notifyType == NOTIFY_ACK_NOTIFICATION)) {
+        /* the Time_Delay is counting or has just elapsed, or the value
+           was not evaluated because an AckNotification was sent */
+        Analog_Value_Event_Detection_Changed(CurrentAV, object_instance);
     }
 #else
     (void)object_instance;
@@ -1517,6 +1616,7 @@ bool Analog_Value_Time_Delay_Set(uint32_t object_instance, uint32_t time_delay)
 
     if (pObject) {
         pObject->Time_Delay = time_delay;
+        Analog_Value_Event_Detection_Changed(pObject, object_instance);
         status = true;
     }
 
@@ -1600,6 +1700,7 @@ bool Analog_Value_High_Limit_Set(uint32_t object_instance, float high_limit)
 
     if (pObject) {
         pObject->High_Limit = high_limit;
+        Analog_Value_Event_Detection_Changed(pObject, object_instance);
         status = true;
     }
 
@@ -1640,6 +1741,7 @@ bool Analog_Value_Low_Limit_Set(uint32_t object_instance, float low_limit)
 
     if (pObject) {
         pObject->Low_Limit = low_limit;
+        Analog_Value_Event_Detection_Changed(pObject, object_instance);
         status = true;
     }
 
@@ -1680,6 +1782,7 @@ bool Analog_Value_Deadband_Set(uint32_t object_instance, float deadband)
 
     if (pObject) {
         pObject->Deadband = deadband;
+        Analog_Value_Event_Detection_Changed(pObject, object_instance);
         status = true;
     }
 
@@ -1723,6 +1826,7 @@ bool Analog_Value_Limit_Enable_Set(
         if (!(limit_enable &
               ~(EVENT_LOW_LIMIT_ENABLE | EVENT_HIGH_LIMIT_ENABLE))) {
             pObject->Limit_Enable = limit_enable;
+            Analog_Value_Event_Detection_Changed(pObject, object_instance);
             status = true;
         }
     }
@@ -1768,6 +1872,7 @@ bool Analog_Value_Event_Enable_Set(
               ~(EVENT_ENABLE_TO_OFFNORMAL | EVENT_ENABLE_TO_FAULT |
                 EVENT_ENABLE_TO_NORMAL))) {
             pObject->Event_Enable = event_enable;
+            Analog_Value_Event_Detection_Changed(pObject, object_instance);
             status = true;
         }
     }
@@ -1818,6 +1923,33 @@ bool Analog_Value_Notify_Type_Set(
     return status;
 }
 
+/**
+ * @brief Finds the next Analog Value object with an active event
+ * @param object_instance [in,out] object-instance number to start at,
+ *  and the object-instance number of the object found
+ * @param index [out] index of the object found, for
+ *  Analog_Value_Event_Information()
+ * @return true if an object was found
+ */
+bool Analog_Value_Event_Active_Next(uint32_t *object_instance, unsigned *index)
+{
+    KEY key = 0;
+    int i;
+
+    i = Keylist_Index_Next(Event_Active_List, *object_instance);
+    if ((i < 0) || !Keylist_Index_Key(Event_Active_List, i, &key)) {
+        return false;
+    }
+    i = Keylist_Index(Object_List, key);
+    if (i < 0) {
+        return false;
+    }
+    *object_instance = key;
+    *index = (unsigned)i;
+
+    return true;
+}
+
 /**
  * @brief Handles getting the Event Information for this object.
  * @param  index - index number of the object 0..count
@@ -2003,6 +2135,10 @@ int Analog_Value_Alarm_Ack(
     /* Need to send AckNotification. */
     CurrentAV->Ack_notify_data.bSendAckNotify = true;
     CurrentAV->Ack_notify_data.EventState = alarmack_data->eventStateAcked;
+    Analog_Value_Event_Active_Update(
+        alarmack_data->eventObjectIdentifier.instance, CurrentAV);
+    Analog_Value_Event_Detection_Changed(
+        CurrentAV, alarmack_data->eventObjectIdentifier.instance);
 
     /* Return OK */
     return 1;
@@ -2109,6 +2245,10 @@ uint32_t Analog_Value_Create(uint32_t object_instance)
                 free(pObject);
                 return BACNET_MAX_INSTANCE;
             }
+            if (Object_Changed_Callback) {
+                Object_Changed_Callback(
+                    Object_Type, object_instance, OBJECT_CHANGE_CREATED);
+            }
         } else {
             return BACNET_MAX_INSTANCE;
         }
@@ -2129,13 +2269,41 @@ bool Analog_Value_Delete(uint32_t object_instance)
 
     pObject = Keylist_Data_Delete(Object_List, object_instance);
     if (pObject) {
+#if defined(INTRINSIC_REPORTING)
+        Keylist_Data_Delete(Event_Active_List, object_instance);
+#endif
         free(pObject);
         status = true;
+        if (Object_Changed_Callback) {
+            Object_Changed_Callback(
+                Object_Type, object_instance, OBJECT_CHANGE_DELETED);
+        }
     }
 
     return status;
 }
 
+/**
+ * @brief Sets the function that is called when an object is created,
+ *  deleted, renamed or changed, so that the Device object, the COV
+ *  handler and intrinsic reporting do not poll for them
+ * @param  cb - function to call, or NULL to stop calling
+ * @return the OBJECT_CHANGE_x changes that are reported
+ */
+unsigned Analog_Value_Changed_Callback_Set(object_changed_function cb)
+{
+    unsigned changes;
+
+    Object_Changed_Callback = cb;
+    changes = OBJECT_CHANGE_CREATED | OBJECT_CHANGE_DELETED |
+        OBJECT_CHANGE_NAME | OBJECT_CHANGE_COV;
+#if defined(INTRINSIC_REPORTING)
+    changes |= OBJECT_CHANGE_EVENT;
+#endif
+
+    return changes;
+}
+
 /**
  * @brief Deletes all the Analog Values and their data
  */
@@ -2153,6 +2321,10 @@ void Analog_Value_Cleanup(void)
         Keylist_Delete(Object_List);
         Object_List = NULL;
     }
+#if defined(INTRINSIC_REPORTING)
+    Keylist_Delete(Event_Active_List);
+    Event_Active_List = NULL;
+#endif
 }
 
 /**
@@ -2171,5 +2343,10 @@ void Analog_Value_Init(void)
     handler_alarm_ack_set(Object_Type, Analog_Value_Alarm_Ack);
     /* Set handler for GetAlarmSummary Service */
     handler_get_alarm_summary_set(Object_Type, Analog_Value_Alarm_Summary);
+    /* Set the index of active events for both services */
+    handler_get_event_information_active_set(
+        Object_Type, Analog_Value_Event_Active_Next);
+    handler_get_alarm_summary_active_set(
+        Object_Type, Analog_Value_Event_Active_Next);
 #endif
 }
@@ -17,6 +17,7 @@
 /* BACnet Stack API */
 #include "bacnet/bacerror.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/object/device.h"
 #include "bacnet/rp.h"
 #if defined(INTRINSIC_REPORTING)
 #include "bacnet/basic/object/nc.h"
@@ -201,6 +202,8 @@ bool Analog_Value_Notify_Type_Set(
 BACNET_STACK_EXPORT
 int Analog_Value_Event_Information(
     unsigned index, BACNET_GET_EVENT_INFORMATION_DATA *getevent_data);
+BACNET_STACK_EXPORT
+bool Analog_Value_Event_Active_Next(uint32_t *object_instance, unsigned *index);
 
 BACNET_STACK_EXPORT
 int Analog_Value_Alarm_Ack(
@@ -216,6 +219,8 @@ uint32_t Analog_Value_Create(uint32_t object_instance);
 BACNET_STACK_EXPORT
 bool Analog_Value_Delete(uint32_t object_instance);
 BACNET_STACK_EXPORT
+unsigned Analog_Value_Changed_Callback_Set(object_changed_function cb);
+BACNET_STACK_EXPORT
 void Analog_Value_Cleanup(void);
 BACNET_STACK_EXPORT
 void Analog_Value_Init(void);
@@ -43,6 +43,8 @@ struct object_data {
 };
 /* Key List for storing the object data sorted by instance number  */
 static OS_Keylist Object_List;
+/* called when an object is created or deleted */
+static object_changed_function Object_Changed_Callback;
 /* common object type */
 static const BACNET_OBJECT_TYPE Object_Type = OBJECT_FILE;
 /* These three arrays are used by the ReadPropertyMultiple handler */
@@ -754,14 +756,13 @@ bool bacfile_write_property(BACNET_WRITE_PROPERTY_DATA *wp_data)
 /* Another way would be to store the */
 /* invokeID and file instance in a list or table */
 /* when the request was sent */
-uint32_t bacfile_instance_from_tsm(uint8_t invokeID)
+uint32_t bacfile_instance_from_tsm(const BACNET_ADDRESS *src, uint8_t invokeID)
 {
     BACNET_NPDU_DATA npdu_data = { 0 }; /* dummy for getting npdu length */
     BACNET_CONFIRMED_SERVICE_DATA service_data = { 0 };
     uint8_t service_choice = 0;
     uint8_t *service_request = NULL;
     uint16_t service_request_len = 0;
-    BACNET_ADDRESS dest; /* where the original packet was destined */
     uint8_t apdu[MAX_PDU] = { 0 }; /* original APDU packet */
     uint16_t apdu_len = 0; /* original APDU packet length */
     int len = 0; /* apdu header length */
@@ -770,7 +771,7 @@ uint32_t bacfile_instance_from_tsm(uint8_t invokeID)
     bool found = false;
 
     found = tsm_get_transaction_pdu(
-        invokeID, &dest, &npdu_data, &apdu[0], &apdu_len);
+        src, invokeID, &npdu_data, &apdu[0], &apdu_len);
     if (found) {
         if (!npdu_data.network_layer_message &&
             npdu_data.data_expecting_reply &&
@@ -1031,6 +1032,10 @@ uint32_t bacfile_create(uint32_t object_instance)
                 free(pObject);
                 return BACNET_MAX_INSTANCE;
             }
+            if (Object_Changed_Callback) {
+                Object_Changed_Callback(
+                    Object_Type, object_instance, OBJECT_CHANGE_CREATED);
+            }
         } else {
             return BACNET_MAX_INSTANCE;
         }
@@ -1053,11 +1058,28 @@ bool bacfile_delete(uint32_t object_instance)
     if (pObject) {
         free(pObject);
         status = true;
+        if (Object_Changed_Callback) {
+            Object_Changed_Callback(
+                Object_Type, object_instance, OBJECT_CHANGE_DELETED);
+        }
     }
 
     return status;
 }
 
+/**
+ * @brief Sets the function that is called when an object is created
+ *  or deleted, so that the Device object does not poll for them
+ * @param  cb - function to call, or NULL to stop calling
+ * @return the OBJECT_CHANGE_x changes that are reported
+ */
+unsigned bacfile_changed_callback_set(object_changed_function cb)
+{
+    Object_Changed_Callback = cb;
+
+    return OBJECT_CHANGE_CREATED | OBJECT_CHANGE_DELETED;
+}
+
 /**
  * @brief Deletes all the objects and their data
  */
@@ -19,6 +19,7 @@
 #include "bacnet/awf.h"
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/object/device.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -77,7 +78,7 @@ bool bacfile_file_size_set(
 /* invokeID and file instance in a list or table */
 /* when the request was sent */
 BACNET_STACK_EXPORT
-uint32_t bacfile_instance_from_tsm(uint8_t invokeID);
+uint32_t bacfile_instance_from_tsm(const BACNET_ADDRESS *src, uint8_t invokeID);
 
 /* handler ACK helper */
 BACNET_STACK_EXPORT
@@ -122,6 +123,8 @@ uint32_t bacfile_create(uint32_t object_instance);
 BACNET_STACK_EXPORT
 bool bacfile_delete(uint32_t object_instance);
 BACNET_STACK_EXPORT
+unsigned bacfile_changed_callback_set(object_changed_function cb);
+BACNET_STACK_EXPORT
 void bacfile_cleanup(void);
 BACNET_STACK_EXPORT
 void bacfile_init(void);
@@ -17,6 +17,7 @@
 #include "bacnet/cov.h"
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/object/device.h"
 
 #if (INTRINSIC_REPORTING)
 #include "bacnet/basic/object/nc.h"
@@ -136,6 +137,8 @@ uint32_t Binary_Input_Create(uint32_t object_instance);
 BACNET_STACK_EXPORT
 bool Binary_Input_Delete(uint32_t object_instance);
 BACNET_STACK_EXPORT
+unsigned Binary_Input_Changed_Callback_Set(object_changed_function cb);
+BACNET_STACK_EXPORT
 void Binary_Input_Cleanup(void);
 BACNET_STACK_EXPORT
 void Binary_Input_Init(void);
@@ -150,6 +153,8 @@ bool Binary_Input_Event_Detection_Enable_Set(
 BACNET_STACK_EXPORT
 int Binary_Input_Event_Information(
     unsigned index, BACNET_GET_EVENT_INFORMATION_DATA *getevent_data);
+BACNET_STACK_EXPORT
+bool Binary_Input_Event_Active_Next(uint32_t *object_instance, unsigned *index);
 
 BACNET_STACK_EXPORT
 int Binary_Input_Alarm_Ack(
@@ -36,6 +36,8 @@ struct object_data {
 };
 /* Key List for storing the object data sorted by instance number  */
 static OS_Keylist Object_List;
+/* called when an object is renamed */
+static object_changed_function Object_Changed_Callback;
 /* callback for present value writes */
 static bitstring_value_write_present_value_callback
     BitString_Value_Write_Present_Value_Callback;
@@ -470,10 +472,27 @@ bool BitString_Value_Name_Set(uint32_t object_instance, const char *new_name)
         status = true;
         pObject->Object_Name = new_name;
     }
+    if (status && Object_Changed_Callback) {
+        Object_Changed_Callback(
+            OBJECT_BITSTRING_VALUE, object_instance, OBJECT_CHANGE_NAME);
+    }
 
     return status;
 }
 
+/**
+ * @brief Sets the function that is called when an object is
+ *  renamed, so that the Device object finds it by its new name
+ * @param  cb - function to call, or NULL to stop calling
+ * @return the OBJECT_CHANGE_x changes that are reported
+ */
+unsigned BitString_Value_Changed_Callback_Set(object_changed_function cb)
+{
+    Object_Changed_Callback = cb;
+
+    return OBJECT_CHANGE_NAME;
+}
+
 /**
  * @brief Return the object name C string
  * @param object_instance [in] BACnet object instance number
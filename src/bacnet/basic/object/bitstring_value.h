@@ -18,6 +18,7 @@
 #include "bacnet/cov.h"
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/object/device.h"
 
 /**
  * @brief Callback for gateway write present value request
@@ -66,6 +67,8 @@ bool BitString_Value_Object_Name(
 BACNET_STACK_EXPORT
 bool BitString_Value_Name_Set(uint32_t object_instance, const char *new_name);
 BACNET_STACK_EXPORT
+unsigned BitString_Value_Changed_Callback_Set(object_changed_function cb);
+BACNET_STACK_EXPORT
 const char *BitString_Value_Name_ASCII(uint32_t object_instance);
 
 BACNET_STACK_EXPORT
@@ -52,6 +52,8 @@ struct object_data {
 };
 /* Key List for storing the object data sorted by instance number  */
 static OS_Keylist Object_List;
+/* called when an object is created, deleted or renamed */
+static object_changed_function Object_Changed_Callback;
 /* callback for present value writes */
 static binary_lighting_output_write_value_callback
     Binary_Lighting_Output_Write_Value_Callback;
@@ -810,6 +812,10 @@ bool Binary_Lighting_Output_Name_Set(
         status = true;
         pObject->Object_Name = new_name;
     }
+    if (status && Object_Changed_Callback) {
+        Object_Changed_Callback(
+            OBJECT_BINARY_LIGHTING_OUTPUT, object_instance, OBJECT_CHANGE_NAME);
+    }
 
     return status;
 }
@@ -1538,6 +1544,11 @@ uint32_t Binary_Lighting_Output_Create(uint32_t object_instance)
             free(pObject);
             return BACNET_MAX_INSTANCE;
         }
+        if (Object_Changed_Callback) {
+            Object_Changed_Callback(
+                OBJECT_BINARY_LIGHTING_OUTPUT, object_instance,
+                OBJECT_CHANGE_CREATED);
+        }
     }
 
     return object_instance;
@@ -1557,11 +1568,29 @@ bool Binary_Lighting_Output_Delete(uint32_t object_instance)
     if (pObject) {
         free(pObject);
         status = true;
+        if (Object_Changed_Callback) {
+            Object_Changed_Callback(
+                OBJECT_BINARY_LIGHTING_OUTPUT, object_instance,
+                OBJECT_CHANGE_DELETED);
+        }
     }
 
     return status;
 }
 
+/**
+ * @brief Sets the function that is called when an object is created,
+ *  deleted or renamed, so that the Device object does not poll for them
+ * @param  cb - function to call, or NULL to stop calling
+ * @return the OBJECT_CHANGE_x changes that are reported
+ */
+unsigned Binary_Lighting_Output_Changed_Callback_Set(object_changed_function cb)
+{
+    Object_Changed_Callback = cb;
+
+    return OBJECT_CHANGE_CREATED | OBJECT_CHANGE_DELETED | OBJECT_CHANGE_NAME;
+}
+
 /**
  * Deletes all the objects and their data
  */
@@ -15,6 +15,7 @@
 #include "bacnet/bacerror.h"
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/object/device.h"
 
 /**
  * @brief Callback for write value request
@@ -151,6 +152,9 @@ uint32_t Binary_Lighting_Output_Create(uint32_t object_instance);
 BACNET_STACK_EXPORT
 bool Binary_Lighting_Output_Delete(uint32_t object_instance);
 BACNET_STACK_EXPORT
+unsigned Binary_Lighting_Output_Changed_Callback_Set(
+    object_changed_function cb);
+BACNET_STACK_EXPORT
 void Binary_Lighting_Output_Cleanup(void);
 BACNET_STACK_EXPORT
 void Binary_Lighting_Output_Init(void);
@@ -49,6 +49,8 @@ struct object_data {
 };
 /* Key List for storing the object data sorted by instance number  */
 static OS_Keylist Object_List;
+/* called when an object is created, deleted, renamed or changed */
+static object_changed_function Object_Changed_Callback;
 /* common object type */
 static const BACNET_OBJECT_TYPE Object_Type = OBJECT_BINARY_OUTPUT;
 /* callback for present value writes */
@@ -271,6 +273,24 @@ unsigned Binary_Output_Present_Value_Priority(uint32_t object_instance)
     return priority;
 }
 
+/**
+ * @brief Sets the COV flag of an object, and reports the change to the
+ *  object changed callback when the flag was clear
+ * @param  pObject - specific object with valid data
+ * @param  object_instance - object-instance number of the object
+ */
+static void
+Binary_Output_COV_Changed(struct object_data *pObject, uint32_t object_instance)
+{
+    if (!pObject->Changed) {
+        pObject->Changed = true;
+        if (Object_Changed_Callback) {
+            Object_Changed_Callback(
+                Object_Type, object_instance, OBJECT_CHANGE_COV);
+        }
+    }
+}
+
 /**
  * For a given object instance-number, sets the present-value at a given
  * priority 1..16.
@@ -305,7 +325,7 @@ bool Binary_Output_Present_Value_Set(
             }
             new_value = Object_Present_Value(pObject);
             if (old_value != new_value) {
-                pObject->Changed = true;
+                Binary_Output_COV_Changed(pObject, object_instance);
             }
         }
     }
@@ -339,7 +359,7 @@ bool Binary_Output_Present_Value_Relinquish(
             BIT_CLEAR(pObject->Priority_Array, priority);
             new_value = Object_Present_Value(pObject);
             if (old_value != new_value) {
-                pObject->Changed = true;
+                Binary_Output_COV_Changed(pObject, object_instance);
             }
             status = true;
         }
@@ -498,7 +518,7 @@ void Binary_Output_Out_Of_Service_Set(uint32_t object_instance, bool value)
     if (pObject) {
         if (pObject->Out_Of_Service != value) {
             pObject->Out_Of_Service = value;
-            pObject->Changed = true;
+            Binary_Output_COV_Changed(pObject, object_instance);
         }
     }
 }
@@ -555,6 +575,10 @@ bool Binary_Output_Name_Set(uint32_t object_instance, const char *new_name)
         status = true;
         pObject->Object_Name = new_name;
     }
+    if (status && Object_Changed_Callback) {
+        Object_Changed_Callback(
+            Object_Type, object_instance, OBJECT_CHANGE_NAME);
+    }
 
     return status;
 }
@@ -743,7 +767,7 @@ bool Binary_Output_Reliability_Set(
             fault = Binary_Output_Object_Fault(pObject);
             pObject->Reliability = value;
             if (fault != Binary_Output_Object_Fault(pObject)) {
-                pObject->Changed = true;
+                Binary_Output_COV_Changed(pObject, object_instance);
             }
             status = true;
         }
@@ -1223,6 +1247,10 @@ uint32_t Binary_Output_Create(uint32_t object_instance)
                 free(pObject);
                 return BACNET_MAX_INSTANCE;
             }
+            if (Object_Changed_Callback) {
+                Object_Changed_Callback(
+                    Object_Type, object_instance, OBJECT_CHANGE_CREATED);
+            }
         } else {
             return BACNET_MAX_INSTANCE;
         }
@@ -1262,11 +1290,30 @@ bool Binary_Output_Delete(uint32_t object_instance)
     if (pObject) {
         free(pObject);
         status = true;
+        if (Object_Changed_Callback) {
+            Object_Changed_Callback(
+                Object_Type, object_instance, OBJECT_CHANGE_DELETED);
+        }
     }
 
     return status;
 }
 
+/**
+ * @brief Sets the function that is called when an object is created,
+ *  deleted, renamed or changed, so that the Device object and the COV
+ *  handler do not poll for them
+ * @param  cb - function to call, or NULL to stop calling
+ * @return the OBJECT_CHANGE_x changes that are reported
+ */
+unsigned Binary_Output_Changed_Callback_Set(object_changed_function cb)
+{
+    Object_Changed_Callback = cb;
+
+    return OBJECT_CHANGE_CREATED | OBJECT_CHANGE_DELETED | OBJECT_CHANGE_NAME |
+        OBJECT_CHANGE_COV;
+}
+
 /**
  * Initializes the Binary Input object data
  */
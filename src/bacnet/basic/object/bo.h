@@ -18,6 +18,7 @@
 #include "bacnet/cov.h"
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/object/device.h"
 
 /**
  * @brief Callback for gateway write present value request
@@ -131,6 +132,8 @@ uint32_t Binary_Output_Create(uint32_t object_instance);
 BACNET_STACK_EXPORT
 bool Binary_Output_Delete(uint32_t object_instance);
 BACNET_STACK_EXPORT
+unsigned Binary_Output_Changed_Callback_Set(object_changed_function cb);
+BACNET_STACK_EXPORT
 void Binary_Output_Cleanup(void);
 
 #ifdef __cplusplus
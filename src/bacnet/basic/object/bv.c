@@ -64,6 +64,12 @@ struct object_data {
 };
 /* Key List for storing the object data sorted by instance number  */
 static OS_Keylist Object_List;
+/* called when an object is created, deleted, renamed or changed */
+static object_changed_function Object_Changed_Callback;
+#if defined(INTRINSIC_REPORTING) && (BINARY_VALUE_INTRINSIC_REPORTING)
+/* Key List of the objects with an active event, sorted by instance */
+static OS_Keylist Event_Active_List;
+#endif
 /* common object type */
 static const BACNET_OBJECT_TYPE Object_Type = OBJECT_BINARY_VALUE;
 /* callback for present value writes */
@@ -283,17 +289,38 @@ BACNET_BINARY_PV Binary_Value_Present_Value(uint32_t object_instance)
     return value;
 }
 
+/**
+ * @brief Sets the COV flag of an object, and reports the change to the
+ *  object changed callback when the flag was clear
+ * @param  pObject - specific object with valid data
+ * @param  object_instance - object-instance number of the object
+ */
+static void
+Binary_Value_COV_Changed(struct object_data *pObject, uint32_t object_instance)
+{
+    if (!pObject->Change_Of_Value) {
+        pObject->Change_Of_Value = true;
+        if (Object_Changed_Callback) {
+            Object_Changed_Callback(
+                Object_Type, object_instance, OBJECT_CHANGE_COV);
+        }
+    }
+}
+
 /**
  * @brief For a given object instance-number, checks the present-value for COV
  * @param  pObject - specific object with valid data
+ * @param  object_instance - object-instance number of the object
  * @param  value - floating point analog value
  */
 static void Binary_Value_Present_Value_COV_Detect(
-    struct object_data *pObject, BACNET_BINARY_PV value)
+    struct object_data *pObject,
+    uint32_t object_instance,
+    BACNET_BINARY_PV value)
 {
     if (pObject) {
         if (Binary_Present_Value(pObject->Present_Value) != value) {
-            pObject->Change_Of_Value = true;
+            Binary_Value_COV_Changed(pObject, object_instance);
         }
     }
 }
@@ -340,7 +367,7 @@ void Binary_Value_Out_Of_Service_Set(uint32_t object_instance, bool value)
                 pObject->Present_Value = pObject->Present_Value_Backup;
                 pObject->Write_Enabled = false;
             }
-            pObject->Change_Of_Value = true;
+            Binary_Value_COV_Changed(pObject, object_instance);
         }
     }
 
@@ -405,7 +432,7 @@ bool Binary_Value_Reliability_Set(
             fault = Binary_Value_Object_Fault(pObject);
             pObject->Reliability = value;
             if (fault != Binary_Value_Object_Fault(pObject)) {
-                pObject->Change_Of_Value = true;
+                Binary_Value_COV_Changed(pObject, object_instance);
             }
             status = true;
         }
@@ -521,7 +548,8 @@ bool Binary_Value_Present_Value_Set(
                     value = BINARY_INACTIVE;
                 }
             }
-            Binary_Value_Present_Value_COV_Detect(pObject, value);
+            Binary_Value_Present_Value_COV_Detect(
+                pObject, object_instance, value);
             pObject->Present_Value = Binary_Present_Value_Boolean(value);
             status = true;
         }
@@ -583,7 +611,8 @@ static bool Binary_Value_Present_Value_Write(
         if (value <= MAX_BINARY_PV) {
             if (pObject->Write_Enabled) {
                 old_value = Binary_Present_Value(pObject->Present_Value);
-                Binary_Value_Present_Value_COV_Detect(pObject, value);
+                Binary_Value_Present_Value_COV_Detect(
+                    pObject, object_instance, value);
                 pObject->Present_Value = Binary_Present_Value_Boolean(value);
                 if (pObject->Out_Of_Service) {
                     /* The physical point that the object represents
@@ -655,6 +684,10 @@ bool Binary_Value_Name_Set(uint32_t object_instance, const char *new_name)
     if (pObject) {
         status = characterstring_init_ansi(&pObject->Object_Name, new_name);
     }
+    if (status && Object_Changed_Callback) {
+        Object_Changed_Callback(
+            Object_Type, object_instance, OBJECT_CHANGE_NAME);
+    }
 
     return status;
 }
@@ -1368,6 +1401,11 @@ uint32_t Binary_Value_Create(uint32_t object_instance)
             /* Set handler for GetAlarmSummary Service */
             handler_get_alarm_summary_set(
                 Object_Type, Binary_Value_Alarm_Summary);
+            /* Set the index of active events for both services */
+            handler_get_event_information_active_set(
+                Object_Type, Binary_Value_Event_Active_Next);
+            handler_get_alarm_summary_active_set(
+                Object_Type, Binary_Value_Event_Active_Next);
 #endif
             /* add to list */
             index = Keylist_Data_Add(Object_List, object_instance, pObject);
@@ -1375,6 +1413,10 @@ uint32_t Binary_Value_Create(uint32_t object_instance)
                 free(pObject);
                 return BACNET_MAX_INSTANCE;
             }
+            if (Object_Changed_Callback) {
+                Object_Changed_Callback(
+                    Object_Type, object_instance, OBJECT_CHANGE_CREATED);
+            }
         } else {
             return BACNET_MAX_INSTANCE;
         }
@@ -1400,6 +1442,10 @@ void Binary_Value_Cleanup(void)
         Keylist_Delete(Object_List);
         Object_List = NULL;
     }
+#if defined(INTRINSIC_REPORTING) && (BINARY_VALUE_INTRINSIC_REPORTING)
+    Keylist_Delete(Event_Active_List);
+    Event_Active_List = NULL;
+#endif
 }
 
 /**
@@ -1412,13 +1458,35 @@ bool Binary_Value_Delete(uint32_t object_instance)
 
     pObject = Keylist_Data_Delete(Object_List, object_instance);
     if (pObject) {
+#if defined(INTRINSIC_REPORTING) && (BINARY_VALUE_INTRINSIC_REPORTING)
+        Keylist_Data_Delete(Event_Active_List, object_instance);
+#endif
         free(pObject);
         status = true;
+        if (Object_Changed_Callback) {
+            Object_Changed_Callback(
+                Object_Type, object_instance, OBJECT_CHANGE_DELETED);
+        }
     }
 
     return status;
 }
 
+/**
+ * @brief Sets the function that is called when an object is created,
+ *  deleted, renamed or changed, so that the Device object and the COV
+ *  handler do not poll for them
+ * @param  cb - function to call, or NULL to stop calling
+ * @return the OBJECT_CHANGE_x changes that are reported
+ */
+unsigned Binary_Value_Changed_Callback_Set(object_changed_function cb)
+{
+    Object_Changed_Callback = cb;
+
+    return OBJECT_CHANGE_CREATED | OBJECT_CHANGE_DELETED | OBJECT_CHANGE_NAME |
+        OBJECT_CHANGE_COV;
+}
+
 /**
  * Initializes the Binary Input object data
  */
@@ -1606,6 +1674,62 @@ bool Binary_Value_Notify_Type_Set(
 }
 #endif
 
+#if defined(INTRINSIC_REPORTING) && (BINARY_VALUE_INTRINSIC_REPORTING)
+/**
+ * @brief Keep an object in the list of objects with an active event while
+ *  its Event_State is not NORMAL or a transition is not acknowledged
+ * @param object_instance - object-instance number of the object
+ * @param pObject - object data
+ */
+static void Binary_Value_Event_Active_Update(
+    uint32_t object_instance, struct object_data *pObject)
+{
+    bool active;
+
+    active = (pObject->Event_State != EVENT_STATE_NORMAL) ||
+        !pObject->Acked_Transitions[TRANSITION_TO_OFFNORMAL].bIsAcked ||
+        !pObject->Acked_Transitions[TRANSITION_TO_FAULT].bIsAcked ||
+        !pObject->Acked_Transitions[TRANSITION_TO_NORMAL].bIsAcked;
+    if (active) {
+        if (!Event_Active_List) {
+            Event_Active_List = Keylist_Create();
+        }
+        if (Keylist_Index(Event_Active_List, object_instance) < 0) {
+            Keylist_Data_Add(Event_Active_List, object_instance, pObject);
+        }
+    } else {
+        Keylist_Data_Delete(Event_Active_List, object_instance);
+    }
+}
+
+/**
+ * @brief Finds the next Binary Value object with an active event
+ * @param object_instance [in,out] object-instance number to start at,
+ *  and the object-instance number of the object found
+ * @param index [out] index of the object found, for
+ *  Binary_Value_Event_Information()
+ * @return true if an object was found
+ */
+bool Binary_Value_Event_Active_Next(uint32_t *object_instance, unsigned *index)
+{
+    KEY key = 0;
+    int i;
+
+    i = Keylist_Index_Next(Event_Active_List, *object_instance);
+    if ((i < 0) || !Keylist_Index_Key(Event_Active_List, i, &key)) {
+        return false;
+    }
+    i = Keylist_Index(Object_List, key);
+    if (i < 0) {
+        return false;
+    }
+    *object_instance = key;
+    *index = (unsigned)i;
+
+    return true;
+}
+#endif
+
 int Binary_Value_Event_Information(
     unsigned index, BACNET_GET_EVENT_INFORMATION_DATA *getevent_data)
 {
@@ -1776,6 +1900,8 @@ int Binary_Value_Alarm_Ack(
     }
     pObject->Ack_notify_data.bSendAckNotify = true;
     pObject->Ack_notify_data.EventState = alarmack_data->eventStateAcked;
+    Binary_Value_Event_Active_Update(
+        alarmack_data->eventObjectIdentifier.instance, pObject);
 
     return 1;
 }
@@ -2230,6 +2356,7 @@ void Binary_Value_Intrinsic_Reporting(uint32_t object_instance)
                     break;
             }
         }
+        Binary_Value_Event_Active_Update(object_instance, pObject);
     }
 #endif /* defined(INTRINSIC_REPORTING) && (BINARY_VALUE_INTRINSIC_REPORTING) \
         */
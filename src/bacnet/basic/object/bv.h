@@ -17,6 +17,7 @@
 #include "bacnet/bacerror.h"
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/object/device.h"
 
 #if (INTRINSIC_REPORTING)
 #include "bacnet/basic/object/nc.h"
@@ -131,6 +132,8 @@ uint32_t Binary_Value_Create(uint32_t object_instance);
 BACNET_STACK_EXPORT
 bool Binary_Value_Delete(uint32_t object_instance);
 BACNET_STACK_EXPORT
+unsigned Binary_Value_Changed_Callback_Set(object_changed_function cb);
+BACNET_STACK_EXPORT
 void Binary_Value_Cleanup(void);
 
 BACNET_STACK_EXPORT
@@ -146,6 +149,8 @@ bool Binary_Value_Event_Detection_Enable_Set(
 BACNET_STACK_EXPORT
 int Binary_Value_Event_Information(
     unsigned index, BACNET_GET_EVENT_INFORMATION_DATA *getevent_data);
+BACNET_STACK_EXPORT
+bool Binary_Value_Event_Active_Next(uint32_t *object_instance, unsigned *index);
 
 BACNET_STACK_EXPORT
 int Binary_Value_Alarm_Ack(
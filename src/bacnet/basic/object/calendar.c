@@ -43,6 +43,8 @@ struct object_data {
 };
 /* Key List for storing the object data sorted by instance number  */
 static OS_Keylist Object_List;
+/* called when an object is created, deleted or renamed */
+static object_changed_function Object_Changed_Callback;
 /* callback for present value writes */
 static calendar_write_present_value_callback
     Calendar_Write_Present_Value_Callback;
@@ -413,6 +415,10 @@ bool Calendar_Name_Set(uint32_t object_instance, const char *new_name)
         status = true;
         pObject->Object_Name = new_name;
     }
+    if (status && Object_Changed_Callback) {
+        Object_Changed_Callback(
+            OBJECT_CALENDAR, object_instance, OBJECT_CHANGE_NAME);
+    }
 
     return status;
 }
@@ -730,6 +736,10 @@ uint32_t Calendar_Create(uint32_t object_instance)
             free(pObject);
             return BACNET_MAX_INSTANCE;
         }
+        if (Object_Changed_Callback) {
+            Object_Changed_Callback(
+                OBJECT_CALENDAR, object_instance, OBJECT_CHANGE_CREATED);
+        }
     }
 
     return object_instance;
@@ -751,11 +761,28 @@ bool Calendar_Delete(uint32_t object_instance)
         Keylist_Delete(pObject->Date_List);
         free(pObject);
         status = true;
+        if (Object_Changed_Callback) {
+            Object_Changed_Callback(
+                OBJECT_CALENDAR, object_instance, OBJECT_CHANGE_DELETED);
+        }
     }
 
     return status;
 }
 
+/**
+ * @brief Sets the function that is called when an object is created,
+ *  deleted or renamed, so that the Device object does not poll for them
+ * @param  cb - function to call, or NULL to stop calling
+ * @return the OBJECT_CHANGE_x changes that are reported
+ */
+unsigned Calendar_Changed_Callback_Set(object_changed_function cb)
+{
+    Object_Changed_Callback = cb;
+
+    return OBJECT_CHANGE_CREATED | OBJECT_CHANGE_DELETED | OBJECT_CHANGE_NAME;
+}
+
 /**
  * Deletes all the Calendars and their data
  */
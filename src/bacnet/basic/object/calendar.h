@@ -17,6 +17,7 @@
 #include "bacnet/bacerror.h"
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/object/device.h"
 
 /**
  * @brief Callback for gateway write present value request
@@ -94,6 +95,8 @@ uint32_t Calendar_Create(uint32_t object_instance);
 BACNET_STACK_EXPORT
 bool Calendar_Delete(uint32_t object_instance);
 BACNET_STACK_EXPORT
+unsigned Calendar_Changed_Callback_Set(object_changed_function cb);
+BACNET_STACK_EXPORT
 void Calendar_Cleanup(void);
 BACNET_STACK_EXPORT
 void Calendar_Init(void);
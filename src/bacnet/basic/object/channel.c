@@ -48,6 +48,8 @@ struct object_data {
 
 /* Key List for storing the object data sorted by instance number  */
 static OS_Keylist Object_List;
+/* called when an object is created, deleted or renamed */
+static object_changed_function Object_Changed_Callback;
 
 static write_property_function Write_Property_Internal_Callback;
 
@@ -1349,6 +1351,10 @@ bool Channel_Name_Set(uint32_t object_instance, const char *new_name)
         status = true;
         pObject->Object_Name = new_name;
     }
+    if (status && Object_Changed_Callback) {
+        Object_Changed_Callback(
+            OBJECT_CHANNEL, object_instance, OBJECT_CHANGE_NAME);
+    }
 
     return status;
 }
@@ -1732,6 +1738,10 @@ uint32_t Channel_Create(uint32_t object_instance)
                 free(pObject);
                 return BACNET_MAX_INSTANCE;
             }
+            if (Object_Changed_Callback) {
+                Object_Changed_Callback(
+                    OBJECT_CHANNEL, object_instance, OBJECT_CHANGE_CREATED);
+            }
         } else {
             return BACNET_MAX_INSTANCE;
         }
@@ -1754,11 +1764,28 @@ bool Channel_Delete(uint32_t object_instance)
     if (pObject) {
         free(pObject);
         status = true;
+        if (Object_Changed_Callback) {
+            Object_Changed_Callback(
+                OBJECT_CHANNEL, object_instance, OBJECT_CHANGE_DELETED);
+        }
     }
 
     return status;
 }
 
+/**
+ * @brief Sets the function that is called when an object is created,
+ *  deleted or renamed, so that the Device object does not poll for them
+ * @param  cb - function to call, or NULL to stop calling
+ * @return the OBJECT_CHANGE_x changes that are reported
+ */
+unsigned Channel_Changed_Callback_Set(object_changed_function cb)
+{
+    Object_Changed_Callback = cb;
+
+    return OBJECT_CHANGE_CREATED | OBJECT_CHANGE_DELETED | OBJECT_CHANGE_NAME;
+}
+
 /**
  * Deletes all the dynamic objects and their data
  */
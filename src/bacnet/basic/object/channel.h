@@ -15,6 +15,7 @@
 /* BACnet Stack API */
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/object/device.h"
 #include "bacnet/basic/object/lo.h"
 
 /* BACNET_CHANNEL_VALUE decodes WriteProperty service requests
@@ -194,6 +195,8 @@ uint32_t Channel_Create(uint32_t object_instance);
 BACNET_STACK_EXPORT
 bool Channel_Delete(uint32_t object_instance);
 BACNET_STACK_EXPORT
+unsigned Channel_Changed_Callback_Set(object_changed_function cb);
+BACNET_STACK_EXPORT
 void Channel_Cleanup(void);
 BACNET_STACK_EXPORT
 void Channel_Init(void);
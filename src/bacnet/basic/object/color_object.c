@@ -58,6 +58,8 @@ struct object_data {
 };
 /* Key List for storing the object data sorted by instance number  */
 static OS_Keylist Object_List;
+/* called when an object is created, deleted or renamed */
+static object_changed_function Object_Changed_Callback;
 /* callback for present value writes */
 static color_write_present_value_callback Color_Write_Present_Value_Callback;
 
@@ -730,6 +732,10 @@ bool Color_Name_Set(uint32_t object_instance, const char *new_name)
         pObject->Object_Name = new_name;
         status = true;
     }
+    if (status && Object_Changed_Callback) {
+        Object_Changed_Callback(
+            OBJECT_COLOR, object_instance, OBJECT_CHANGE_NAME);
+    }
 
     return status;
 }
@@ -1194,6 +1200,10 @@ uint32_t Color_Create(uint32_t object_instance)
                 free(pObject);
                 return BACNET_MAX_INSTANCE;
             }
+            if (Object_Changed_Callback) {
+                Object_Changed_Callback(
+                    OBJECT_COLOR, object_instance, OBJECT_CHANGE_CREATED);
+            }
         } else {
             return BACNET_MAX_INSTANCE;
         }
@@ -1216,11 +1226,28 @@ bool Color_Delete(uint32_t object_instance)
     if (pObject) {
         free(pObject);
         status = true;
+        if (Object_Changed_Callback) {
+            Object_Changed_Callback(
+                OBJECT_COLOR, object_instance, OBJECT_CHANGE_DELETED);
+        }
     }
 
     return status;
 }
 
+/**
+ * @brief Sets the function that is called when an object is created,
+ *  deleted or renamed, so that the Device object does not poll for them
+ * @param  cb - function to call, or NULL to stop calling
+ * @return the OBJECT_CHANGE_x changes that are reported
+ */
+unsigned Color_Changed_Callback_Set(object_changed_function cb)
+{
+    Object_Changed_Callback = cb;
+
+    return OBJECT_CHANGE_CREATED | OBJECT_CHANGE_DELETED | OBJECT_CHANGE_NAME;
+}
+
 /**
  * Deletes all the Colors and their data
  */
@@ -17,6 +17,7 @@
 #include "bacnet/bacerror.h"
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/object/device.h"
 
 /**
  * @brief Callback for tracking value
@@ -123,6 +124,8 @@ uint32_t Color_Create(uint32_t object_instance);
 BACNET_STACK_EXPORT
 bool Color_Delete(uint32_t object_instance);
 BACNET_STACK_EXPORT
+unsigned Color_Changed_Callback_Set(object_changed_function cb);
+BACNET_STACK_EXPORT
 void Color_Cleanup(void);
 BACNET_STACK_EXPORT
 void Color_Init(void);
@@ -15,6 +15,7 @@
 #include "bacnet/bacerror.h"
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/object/device.h"
 
 /**
  * @brief Callback for write present value request
@@ -146,6 +147,8 @@ uint32_t Color_Temperature_Create(uint32_t object_instance);
 BACNET_STACK_EXPORT
 bool Color_Temperature_Delete(uint32_t object_instance);
 BACNET_STACK_EXPORT
+unsigned Color_Temperature_Changed_Callback_Set(object_changed_function cb);
+BACNET_STACK_EXPORT
 void Color_Temperature_Cleanup(void);
 BACNET_STACK_EXPORT
 void Color_Temperature_Init(void);
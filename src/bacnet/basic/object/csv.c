@@ -24,6 +24,8 @@
 
 /* Key List for storing the object data sorted by instance number  */
 static OS_Keylist Object_List = NULL;
+/* called when an object is renamed */
+static object_changed_function Object_Changed_Callback;
 /* common object type */
 static const BACNET_OBJECT_TYPE Object_Type = OBJECT_CHARACTERSTRING_VALUE;
 
@@ -531,10 +533,27 @@ bool CharacterString_Value_Name_Set(
             status = characterstring_init_ansi(&pObject->Name, "");
         }
     }
+    if (status && Object_Changed_Callback) {
+        Object_Changed_Callback(
+            Object_Type, object_instance, OBJECT_CHANGE_NAME);
+    }
 
     return status;
 }
 
+/**
+ * @brief Sets the function that is called when an object is
+ *  renamed, so that the Device object finds it by its new name
+ * @param  cb - function to call, or NULL to stop calling
+ * @return the OBJECT_CHANGE_x changes that are reported
+ */
+unsigned CharacterString_Value_Changed_Callback_Set(object_changed_function cb)
+{
+    Object_Changed_Callback = cb;
+
+    return OBJECT_CHANGE_NAME;
+}
+
 /**
  * Return the requested property of the character string value.
  *
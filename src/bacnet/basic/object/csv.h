@@ -15,6 +15,7 @@
 #include "bacnet/bacerror.h"
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/object/device.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -55,6 +56,8 @@ bool CharacterString_Value_Object_Name(
 BACNET_STACK_EXPORT
 bool CharacterString_Value_Name_Set(
     uint32_t object_instance, const char *new_name);
+BACNET_STACK_EXPORT
+unsigned CharacterString_Value_Changed_Callback_Set(object_changed_function cb);
 
 BACNET_STACK_EXPORT
 bool CharacterString_Value_Present_Value(
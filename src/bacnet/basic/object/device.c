@@ -8,6 +8,7 @@
  */
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 /* BACnet Stack defines - first */
 #include "bacnet/bacdef.h"
@@ -26,6 +27,7 @@
 #include "bacnet/basic/object/device.h" /* me */
 #include "bacnet/basic/services.h"
 #include "bacnet/basic/binding/address.h"
+#include "bacnet/basic/sys/keylist.h"
 /* include the device object */
 #include "bacnet/basic/object/device.h"
 #include "bacnet/basic/object/acc.h"
@@ -46,6 +48,7 @@
 #include "bacnet/basic/object/schedule.h"
 #include "bacnet/basic/object/structured_view.h"
 #include "bacnet/basic/object/trendlog.h"
+#include "bacnet/basic/object/trendlog_multiple.h"
 #if defined(INTRINSIC_REPORTING)
 #include "bacnet/basic/object/nc.h"
 #endif /* defined(INTRINSIC_REPORTING) */
@@ -82,6 +85,53 @@ Routed_Device_Write_Property_Local(BACNET_WRITE_PROPERTY_DATA *wp_data);
 
 /* may be overridden by outside table */
 static object_functions_t *Object_Table;
+/* flat copy of the Object_List so that each element is found directly,
+   with an object appended when created and the last object moved into
+   the place of an object that is deleted */
+struct object_list_entry {
+    BACNET_OBJECT_ID object_id;
+    /* hash of the object name in the object name index */
+    uint32_t name_hash;
+};
+static struct object_list_entry *Object_List_Cache;
+static uint32_t Object_List_Cache_Size;
+static uint32_t Object_List_Cache_Count;
+static unsigned Object_List_Cache_Objects;
+static bool Object_List_Cache_Valid;
+/* open addressed hash index of the object identifiers in the cache,
+   holding the cache position plus one, so that a created or deleted
+   object is found without walking the cache */
+static uint32_t *Object_List_Index;
+static uint32_t Object_List_Index_Size;
+static uint32_t Object_List_Index_Used;
+/* Object_List_Index value of a free slot or a removed entry */
+#define OBJECT_LIST_INDEX_EMPTY 0
+#define OBJECT_LIST_INDEX_REMOVED UINT32_MAX
+/* open addressed hash index of object names, so that Who-Has and the
+   duplicate name checks find an object name without walking every object */
+struct object_name_index_entry {
+    uint32_t hash;
+    BACNET_OBJECT_ID object_id;
+};
+/* object_id.type marker for a free slot or a removed entry */
+#define OBJECT_NAME_INDEX_EMPTY MAX_BACNET_OBJECT_TYPE
+#define OBJECT_NAME_INDEX_REMOVED (MAX_BACNET_OBJECT_TYPE + 1)
+static struct object_name_index_entry *Object_Name_Index;
+static uint32_t Object_Name_Index_Size;
+static uint32_t Object_Name_Index_Used;
+static bool Object_Name_Index_Valid;
+#if defined(INTRINSIC_REPORTING)
+/* objects to evaluate on the next intrinsic reporting tick, sorted by
+   object identifier, and the list being evaluated during the tick */
+static OS_Keylist Event_Detection_List;
+static OS_Keylist Event_Detection_Work;
+/* object types that call Device_Event_Detection_Schedule() */
+static uint8_t Event_Detection_Types[(MAX_BACNET_OBJECT_TYPE + 7) / 8];
+#endif
+
+static void Device_Object_List_Cache_Invalidate(void);
+static void Device_Object_Name_Changed(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance);
 
 /* clang-format off */
 static object_functions_t My_Object_Table[] = {
@@ -93,7 +143,7 @@ static object_functions_t My_Object_Table[] = {
         NULL /* Value_Lists */, NULL /* COV */, NULL /* COV Clear */,
         NULL /* Intrinsic Reporting */, NULL /* Add_List_Element */,
         NULL /* Remove_List_Element */, NULL /* Create */, NULL /* Delete */,
-        NULL /* Timer */ },
+        NULL /* Timer */, NULL /* Changed */ },
 #if (BACNET_PROTOCOL_REVISION >= 17)
     { OBJECT_NETWORK_PORT, Network_Port_Init, Network_Port_Count,
         Network_Port_Index_To_Instance, Network_Port_Valid_Instance,
@@ -102,7 +152,8 @@ static object_functions_t My_Object_Table[] = {
         NULL /* ReadRangeInfo */, NULL /* Iterator */, NULL /* Value_Lists */,
         NULL /* COV */, NULL /* COV Clear */, NULL /* Intrinsic Reporting */,
         NULL /* Add_List_Element */, NULL /* Remove_List_Element */,
-        NULL /* Create */, NULL /* Delete */, NULL /* Timer */ },
+        NULL /* Create */, NULL /* Delete */, NULL /* Timer */,
+        Network_Port_Changed_Callback_Set },
 #endif
     { OBJECT_ANALOG_INPUT, Analog_Input_Init, Analog_Input_Count,
         Analog_Input_Index_To_Instance, Analog_Input_Valid_Instance,
@@ -112,7 +163,8 @@ static object_functions_t My_Object_Table[] = {
         Analog_Input_Encode_Value_List, Analog_Input_Change_Of_Value,
         Analog_Input_Change_Of_Value_Clear, Analog_Input_Intrinsic_Reporting,
         NULL /* Add_List_Element */, NULL /* Remove_List_Element */,
-        Analog_Input_Create, Analog_Input_Delete, NULL /* Timer */ },
+        Analog_Input_Create, Analog_Input_Delete, NULL /* Timer */,
+        Analog_Input_Changed_Callback_Set },
     { OBJECT_ANALOG_OUTPUT, Analog_Output_Init, Analog_Output_Count,
         Analog_Output_Index_To_Instance, Analog_Output_Valid_Instance,
         Analog_Output_Object_Name, Analog_Output_Read_Property,
@@ -121,7 +173,8 @@ static object_functions_t My_Object_Table[] = {
         Analog_Output_Encode_Value_List, Analog_Output_Change_Of_Value,
         Analog_Output_Change_Of_Value_Clear, NULL /* Intrinsic Reporting */,
         NULL /* Add_List_Element */, NULL /* Remove_List_Element */,
-        Analog_Output_Create, Analog_Output_Delete, NULL /* Timer */ },
+        Analog_Output_Create, Analog_Output_Delete, NULL /* Timer */,
+        Analog_Output_Changed_Callback_Set },
     { OBJECT_ANALOG_VALUE, Analog_Value_Init, Analog_Value_Count,
         Analog_Value_Index_To_Instance, Analog_Value_Valid_Instance,
         Analog_Value_Object_Name, Analog_Value_Read_Property,
@@ -130,7 +183,8 @@ static object_functions_t My_Object_Table[] = {
         Analog_Value_Encode_Value_List, Analog_Value_Change_Of_Value,
         Analog_Value_Change_Of_Value_Clear, Analog_Value_Intrinsic_Reporting,
         NULL /* Add_List_Element */, NULL /* Remove_List_Element */,
-        Analog_Value_Create, Analog_Value_Delete, NULL /* Timer */ },
+        Analog_Value_Create, Analog_Value_Delete, NULL /* Timer */,
+        Analog_Value_Changed_Callback_Set },
     { OBJECT_BINARY_INPUT, Binary_Input_Init, Binary_Input_Count,
         Binary_Input_Index_To_Instance, Binary_Input_Valid_Instance,
         Binary_Input_Object_Name, Binary_Input_Read_Property,
@@ -139,7 +193,8 @@ static object_functions_t My_Object_Table[] = {
         Binary_Input_Encode_Value_List, Binary_Input_Change_Of_Value,
         Binary_Input_Change_Of_Value_Clear, NULL /* Intrinsic Reporting */,
         NULL /* Add_List_Element */, NULL /* Remove_List_Element */,
-        Binary_Input_Create, Binary_Input_Delete, NULL /* Timer */ },
+        Binary_Input_Create, Binary_Input_Delete, NULL /* Timer */,
+        Binary_Input_Changed_Callback_Set },
     { OBJECT_BINARY_OUTPUT, Binary_Output_Init, Binary_Output_Count,
         Binary_Output_Index_To_Instance, Binary_Output_Valid_Instance,
         Binary_Output_Object_Name, Binary_Output_Read_Property,
@@ -148,7 +203,8 @@ static object_functions_t My_Object_Table[] = {
         Binary_Output_Encode_Value_List, Binary_Output_Change_Of_Value,
         Binary_Output_Change_Of_Value_Clear, NULL /* Intrinsic Reporting */,
         NULL /* Add_List_Element */, NULL /* Remove_List_Element */,
-        Binary_Output_Create, Binary_Output_Delete, NULL /* Timer */ },
+        Binary_Output_Create, Binary_Output_Delete, NULL /* Timer */,
+        Binary_Output_Changed_Callback_Set },
     { OBJECT_BINARY_VALUE, Binary_Value_Init, Binary_Value_Count,
         Binary_Value_Index_To_Instance, Binary_Value_Valid_Instance,
         Binary_Value_Object_Name, Binary_Value_Read_Property,
@@ -157,7 +213,8 @@ static object_functions_t My_Object_Table[] = {
         Binary_Value_Encode_Value_List, Binary_Value_Change_Of_Value,
         Binary_Value_Change_Of_Value_Clear, NULL /* Intrinsic Reporting */,
         NULL /* Add_List_Element */, NULL /* Remove_List_Element */,
-        Binary_Value_Create, Binary_Value_Delete, NULL /* Timer */ },
+        Binary_Value_Create, Binary_Value_Delete, NULL /* Timer */,
+        Binary_Value_Changed_Callback_Set },
     { OBJECT_CALENDAR, Calendar_Init, Calendar_Count,
         Calendar_Index_To_Instance, Calendar_Valid_Instance,
         Calendar_Object_Name, Calendar_Read_Property,
@@ -165,7 +222,8 @@ static object_functions_t My_Object_Table[] = {
         NULL /* ReadRangeInfo */, NULL /* Iterator */, NULL /* Value_Lists */,
         NULL /* COV */, NULL /* COV Clear */, NULL /* Intrinsic Reporting */,
         NULL /* Add_List_Element */, NULL /* Remove_List_Element */,
-        Calendar_Create, Calendar_Delete, NULL /* Timer */ },
+        Calendar_Create, Calendar_Delete, NULL /* Timer */,
+        Calendar_Changed_Callback_Set },
 #if (BACNET_PROTOCOL_REVISION >= 10)
     { OBJECT_BITSTRING_VALUE, BitString_Value_Init,
         BitString_Value_Count, BitString_Value_Index_To_Instance,
@@ -176,7 +234,7 @@ static object_functions_t My_Object_Table[] = {
         BitString_Value_Change_Of_Value, BitString_Value_Change_Of_Value_Clear,
         NULL /* Intrinsic Reporting */,  NULL /* Add_List_Element */,
         NULL /* Remove_List_Element */, NULL /* Create */, NULL /* Delete */,
-        NULL /* Timer */ },
+        NULL /* Timer */, BitString_Value_Changed_Callback_Set },
     { OBJECT_CHARACTERSTRING_VALUE, CharacterString_Value_Init,
         CharacterString_Value_Count, CharacterString_Value_Index_To_Instance,
         CharacterString_Value_Valid_Instance, CharacterString_Value_Object_Name,
@@ -188,7 +246,7 @@ static object_functions_t My_Object_Table[] = {
         CharacterString_Value_Change_Of_Value_Clear,
         NULL /* Intrinsic Reporting */, NULL /* Add_List_Element */,
         NULL /* Remove_List_Element */, NULL /* Create */, NULL /* Delete */,
-        NULL /* Timer */ },
+        NULL /* Timer */, CharacterString_Value_Changed_Callback_Set },
     { OBJECT_OCTETSTRING_VALUE, OctetString_Value_Init, OctetString_Value_Count,
         OctetString_Value_Index_To_Instance, OctetString_Value_Valid_Instance,
         OctetString_Value_Object_Name, OctetString_Value_Read_Property,
@@ -196,7 +254,8 @@ static object_functions_t My_Object_Table[] = {
         NULL /* ReadRangeInfo */, NULL /* Iterator */, NULL /* Value_Lists */,
         NULL /* COV */, NULL /* COV Clear */, NULL /* Intrinsic Reporting */,
         NULL /* Add_List_Element */, NULL /* Remove_List_Element */,
-        NULL /* Create */, NULL /* Delete */, NULL /* Timer */ },
+        NULL /* Create */, NULL /* Delete */, NULL /* Timer */,
+        NULL /* Changed */ },
     { OBJECT_POSITIVE_INTEGER_VALUE, PositiveInteger_Value_Init,
         PositiveInteger_Value_Count, PositiveInteger_Value_Index_To_Instance,
         PositiveInteger_Value_Valid_Instance, PositiveInteger_Value_Object_Name,
@@ -206,7 +265,8 @@ static object_functions_t My_Object_Table[] = {
         NULL /* Iterator */, NULL /* Value_Lists */, NULL /* COV */,
         NULL /* COV Clear */, NULL /* Intrinsic Reporting */,
         NULL /* Add_List_Element */, NULL /* Remove_List_Element */,
-        NULL /* Create */, NULL /* Delete */, NULL /* Timer */ },
+        NULL /* Create */, NULL /* Delete */, NULL /* Timer */,
+        NULL /* Changed */ },
     { OBJECT_TIME_VALUE, Time_Value_Init, Time_Value_Count,
         Time_Value_Index_To_Instance, Time_Value_Valid_Instance,
         Time_Value_Object_Name, Time_Value_Read_Property,
@@ -214,7 +274,8 @@ static object_functions_t My_Object_Table[] = {
         NULL /* ReadRangeInfo */, NULL /* Iterator */, NULL /* Value_Lists */,
         NULL /* COV */, NULL /* COV Clear */, NULL /* Intrinsic Reporting */,
         NULL /* Add_List_Element */, NULL /* Remove_List_Element */,
-        NULL /* Create */, NULL /* Delete */, NULL /* Timer */ },
+        NULL /* Create */, NULL /* Delete */, NULL /* Timer */,
+        Time_Value_Changed_Callback_Set },
 #endif
     { OBJECT_COMMAND, Command_Init, Command_Count, Command_Index_To_Instance,
         Command_Valid_Instance, Command_Object_Name, Command_Read_Property,
@@ -222,7 +283,8 @@ static object_functions_t My_Object_Table[] = {
         NULL /* ReadRangeInfo */, NULL /* Iterator */, NULL /* Value_Lists */,
         NULL /* COV */, NULL /* COV Clear */, NULL /* Intrinsic Reporting */,
         NULL /* Add_List_Element */, NULL /* Remove_List_Element */,
-        NULL /* Create */, NULL /* Delete */, NULL /* Timer */ },
+        NULL /* Create */, NULL /* Delete */, NULL /* Timer */,
+        NULL /* Changed */ },
     { OBJECT_INTEGER_VALUE, Integer_Value_Init, Integer_Value_Count,
         Integer_Value_Index_To_Instance, Integer_Value_Valid_Instance,
         Integer_Value_Object_Name, Integer_Value_Read_Property,
@@ -230,7 +292,8 @@ static object_functions_t My_Object_Table[] = {
         NULL /* ReadRangeInfo */, NULL /* Iterator */, NULL /* Value_Lists */,
         NULL /* COV */, NULL /* COV Clear */, NULL /* Intrinsic Reporting */,
         NULL /* Add_List_Element */, NULL /* Remove_List_Element */,
-        NULL /* Create */, NULL /* Delete */, NULL /* Timer */ },
+        NULL /* Create */, NULL /* Delete */, NULL /* Timer */,
+        Integer_Value_Changed_Callback_Set },
 #if defined(INTRINSIC_REPORTING)
     { OBJECT_NOTIFICATION_CLASS, Notification_Class_Init,
         Notification_Class_Count, Notification_Class_Index_To_Instance,
@@ -241,7 +304,7 @@ static object_functions_t My_Object_Table[] = {
         NULL /* COV Clear */, NULL /* Intrinsic Reporting */,
         Notification_Class_Add_List_Element,
         Notification_Class_Remove_List_Element, NULL /* Create */,
-        NULL /* Delete */, NULL /* Timer */ },
+        NULL /* Delete */, NULL /* Timer */, NULL /* Changed */ },
 #endif
     { OBJECT_LIFE_SAFETY_POINT, Life_Safety_Point_Init, Life_Safety_Point_Count,
         Life_Safety_Point_Index_To_Instance, Life_Safety_Point_Valid_Instance,
@@ -250,7 +313,8 @@ static object_functions_t My_Object_Table[] = {
         NULL /* ReadRangeInfo */, NULL /* Iterator */, NULL /* Value_Lists */,
         NULL /* COV */, NULL /* COV Clear */, NULL /* Intrinsic Reporting */,
         NULL /* Add_List_Element */, NULL /* Remove_List_Element */,
-        Life_Safety_Point_Create, Life_Safety_Point_Delete, NULL /* Timer */ },
+        Life_Safety_Point_Create, Life_Safety_Point_Delete, NULL /* Timer */,
+        Life_Safety_Point_Changed_Callback_Set },
     { OBJECT_LIFE_SAFETY_ZONE, Life_Safety_Zone_Init, Life_Safety_Zone_Count,
         Life_Safety_Zone_Index_To_Instance, Life_Safety_Zone_Valid_Instance,
         Life_Safety_Zone_Object_Name, Life_Safety_Zone_Read_Property,
@@ -258,7 +322,8 @@ static object_functions_t My_Object_Table[] = {
         NULL /* ReadRangeInfo */, NULL /* Iterator */, NULL /* Value_Lists */,
         NULL /* COV */, NULL /* COV Clear */, NULL /* Intrinsic Reporting */,
         NULL /* Add_List_Element */, NULL /* Remove_List_Element */,
-        Life_Safety_Zone_Create, Life_Safety_Zone_Delete, NULL /* Timer */ },
+        Life_Safety_Zone_Create, Life_Safety_Zone_Delete, NULL /* Timer */,
+        Life_Safety_Zone_Changed_Callback_Set },
     { OBJECT_LOAD_CONTROL, Load_Control_Init, Load_Control_Count,
         Load_Control_Index_To_Instance, Load_Control_Valid_Instance,
         Load_Control_Object_Name, Load_Control_Read_Property,
@@ -266,7 +331,8 @@ static object_functions_t My_Object_Table[] = {
         NULL /* ReadRangeInfo */, NULL /* Iterator */, NULL /* Value_Lists */,
         NULL /* COV */, NULL /* COV Clear */, NULL /* Intrinsic Reporting */,
         NULL /* Add_List_Element */, NULL /* Remove_List_Element */,
-        Load_Control_Create, Load_Control_Delete, Load_Control_Timer},
+        Load_Control_Create, Load_Control_Delete, Load_Control_Timer,
+        Load_Control_Changed_Callback_Set },
     { OBJECT_MULTI_STATE_INPUT, Multistate_Input_Init, Multistate_Input_Count,
         Multistate_Input_Index_To_Instance, Multistate_Input_Valid_Instance,
         Multistate_Input_Object_Name, Multistate_Input_Read_Property,
@@ -275,7 +341,8 @@ static object_functions_t My_Object_Table[] = {
         Multistate_Input_Encode_Value_List, Multistate_Input_Change_Of_Value,
         Multistate_Input_Change_Of_Value_Clear, NULL /* Intrinsic Reporting */,
         NULL /* Add_List_Element */, NULL /* Remove_List_Element */,
-        Multistate_Input_Create, Multistate_Input_Delete, NULL /* Timer */ },
+        Multistate_Input_Create, Multistate_Input_Delete, NULL /* Timer */,
+        Multistate_Input_Changed_Callback_Set },
     { OBJECT_MULTI_STATE_OUTPUT, Multistate_Output_Init,
         Multistate_Output_Count, Multistate_Output_Index_To_Instance,
         Multistate_Output_Valid_Instance, Multistate_Output_Object_Name,
@@ -285,7 +352,8 @@ static object_functions_t My_Object_Table[] = {
         Multistate_Output_Encode_Value_List, Multistate_Output_Change_Of_Value,
         Multistate_Output_Change_Of_Value_Clear, NULL /* Intrinsic Reporting */,
         NULL /* Add_List_Element */, NULL /* Remove_List_Element */,
-        Multistate_Output_Create, Multistate_Output_Delete, NULL /* Timer */ },
+        Multistate_Output_Create, Multistate_Output_Delete, NULL /* Timer */,
+        Multistate_Output_Changed_Callback_Set },
     { OBJECT_MULTI_STATE_VALUE, Multistate_Value_Init, Multistate_Value_Count,
         Multistate_Value_Index_To_Instance, Multistate_Value_Valid_Instance,
         Multistate_Value_Object_Name, Multistate_Value_Read_Property,
@@ -294,7 +362,8 @@ static object_functions_t My_Object_Table[] = {
         Multistate_Value_Encode_Value_List, Multistate_Value_Change_Of_Value,
         Multistate_Value_Change_Of_Value_Clear, NULL /* Intrinsic Reporting */,
         NULL /* Add_List_Element */, NULL /* Remove_List_Element */,
-        Multistate_Value_Create, Multistate_Value_Delete, NULL /* Timer */ },
+        Multistate_Value_Create, Multistate_Value_Delete, NULL /* Timer */,
+        Multistate_Value_Changed_Callback_Set },
     { OBJECT_TRENDLOG, Trend_Log_Init, Trend_Log_Count,
         Trend_Log_Index_To_Instance, Trend_Log_Valid_Instance,
         Trend_Log_Object_Name, Trend_Log_Read_Property,
@@ -302,7 +371,18 @@ static object_functions_t My_Object_Table[] = {
         NULL /* Iterator */, NULL /* Value_Lists */, NULL /* COV */,
         NULL /* COV Clear */, NULL /* Intrinsic Reporting */,
         NULL /* Add_List_Element */, NULL /* Remove_List_Element */,
-        NULL /* Create */, NULL /* Delete */, NULL /* Timer */ },
+        NULL /* Create */, NULL /* Delete */, NULL /* Timer */,
+        NULL /* Changed */ },
+    { OBJECT_TREND_LOG_MULTIPLE, Trend_Log_Multiple_Init,
+        Trend_Log_Multiple_Count, Trend_Log_Multiple_Index_To_Instance,
+        Trend_Log_Multiple_Valid_Instance, Trend_Log_Multiple_Object_Name,
+        Trend_Log_Multiple_Read_Property, Trend_Log_Multiple_Write_Property,
+        Trend_Log_Multiple_Property_Lists, Trend_Log_Multiple_Read_Range_Info,
+        NULL /* Iterator */, NULL /* Value_Lists */, NULL /* COV */,
+        NULL /* COV Clear */, NULL /* Intrinsic Reporting */,
+        NULL /* Add_List_Element */, NULL /* Remove_List_Element */,
+        Trend_Log_Multiple_Create, Trend_Log_Multiple_Delete,
+        Trend_Log_Multiple_Timer, Trend_Log_Multiple_Changed_Callback_Set },
 #if (BACNET_PROTOCOL_REVISION >= 14)
     { OBJECT_LIGHTING_OUTPUT, Lighting_Output_Init, Lighting_Output_Count,
         Lighting_Output_Index_To_Instance, Lighting_Output_Valid_Instance,
@@ -311,14 +391,16 @@ static object_functions_t My_Object_Table[] = {
         NULL /* ReadRangeInfo */, NULL /* Iterator */, NULL /* Value_Lists */,
         NULL /* COV */, NULL /* COV Clear */, NULL /* Intrinsic Reporting */,
         NULL /* Add_List_Element */, NULL /* Remove_List_Element */,
-        Lighting_Output_Create, Lighting_Output_Delete, Lighting_Output_Timer },
+        Lighting_Output_Create, Lighting_Output_Delete, Lighting_Output_Timer,
+        Lighting_Output_Changed_Callback_Set },
     { OBJECT_CHANNEL, Channel_Init, Channel_Count, Channel_Index_To_Instance,
         Channel_Valid_Instance, Channel_Object_Name, Channel_Read_Property,
         Channel_Write_Property, Channel_Property_Lists,
         NULL /* ReadRangeInfo */, NULL /* Iterator */, NULL /* Value_Lists */,
         NULL /* COV */, NULL /* COV Clear */, NULL /* Intrinsic Reporting */,
         NULL /* Add_List_Element */, NULL /* Remove_List_Element */,
-        Channel_Create, Channel_Delete, NULL /* Timer */ },
+        Channel_Create, Channel_Delete, NULL /* Timer */,
+        Channel_Changed_Callback_Set },
 #endif
 #if (BACNET_PROTOCOL_REVISION >= 16)
     { OBJECT_BINARY_LIGHTING_OUTPUT, Binary_Lighting_Output_Init,
@@ -332,7 +414,8 @@ static object_functions_t My_Object_Table[] = {
         NULL /* COV Clear */, NULL /* Intrinsic Reporting */,
         NULL /* Add_List_Element */, NULL /* Remove_List_Element */,
         Binary_Lighting_Output_Create, Binary_Lighting_Output_Delete,
-        Binary_Lighting_Output_Timer },
+        Binary_Lighting_Output_Timer,
+        Binary_Lighting_Output_Changed_Callback_Set },
 #endif
 #if (BACNET_PROTOCOL_REVISION >= 24)
     { OBJECT_COLOR, Color_Init, Color_Count, Color_Index_To_Instance,
@@ -341,7 +424,7 @@ static object_functions_t My_Object_Table[] = {
         NULL /* Iterator */, NULL /* Value_Lists */, NULL /* COV */,
         NULL /* COV Clear */, NULL /* Intrinsic Reporting */,
         NULL /* Add_List_Element */, NULL /* Remove_List_Element */,
-        Color_Create, Color_Delete, Color_Timer },
+        Color_Create, Color_Delete, Color_Timer, Color_Changed_Callback_Set },
     { OBJECT_COLOR_TEMPERATURE, Color_Temperature_Init, Color_Temperature_Count,
         Color_Temperature_Index_To_Instance, Color_Temperature_Valid_Instance,
         Color_Temperature_Object_Name, Color_Temperature_Read_Property,
@@ -350,7 +433,7 @@ static object_functions_t My_Object_Table[] = {
         NULL /* COV */, NULL /* COV Clear */, NULL /* Intrinsic Reporting */,
         NULL /* Add_List_Element */, NULL /* Remove_List_Element */,
         Color_Temperature_Create, Color_Temperature_Delete,
-        Color_Temperature_Timer },
+        Color_Temperature_Timer, Color_Temperature_Changed_Callback_Set },
 #endif
 #if defined(BACFILE)
     { OBJECT_FILE, bacfile_init, bacfile_count, bacfile_index_to_instance,
@@ -359,7 +442,8 @@ static object_functions_t My_Object_Table[] = {
         NULL /* ReadRangeInfo */, NULL /* Iterator */, NULL /* Value_Lists */,
         NULL /* COV */, NULL /* COV Clear */, NULL /* Intrinsic Reporting */,
         NULL /* Add_List_Element */, NULL /* Remove_List_Element */,
-        bacfile_create, bacfile_delete, NULL /* Timer */ },
+        bacfile_create, bacfile_delete, NULL /* Timer */,
+        bacfile_changed_callback_set },
 #endif
     { OBJECT_SCHEDULE, Schedule_Init, Schedule_Count,
         Schedule_Index_To_Instance, Schedule_Valid_Instance,
@@ -368,7 +452,7 @@ static object_functions_t My_Object_Table[] = {
         NULL /* Value_Lists */, NULL /* COV */, NULL /* COV Clear */,
         NULL /* Intrinsic Reporting */, NULL /* Add_List_Element */,
         NULL /* Remove_List_Element */, NULL /* Create */, NULL /* Delete */,
-        NULL /* Timer */ },
+        NULL /* Timer */, NULL /* Changed */ },
     { OBJECT_STRUCTURED_VIEW, Structured_View_Init, Structured_View_Count,
         Structured_View_Index_To_Instance, Structured_View_Valid_Instance,
         Structured_View_Object_Name, Structured_View_Read_Property,
@@ -376,7 +460,8 @@ static object_functions_t My_Object_Table[] = {
         NULL /* ReadRangeInfo */, NULL /* Iterator */, NULL /* Value_Lists */,
         NULL /* COV */, NULL /* COV Clear */,  NULL /* Intrinsic Reporting */,
         NULL /* Add_List_Element */, NULL /* Remove_List_Element */,
-        Structured_View_Create, Structured_View_Delete, NULL /* Timer */ },
+        Structured_View_Create, Structured_View_Delete, NULL /* Timer */,
+        Structured_View_Changed_Callback_Set },
     { OBJECT_ACCUMULATOR, Accumulator_Init, Accumulator_Count,
         Accumulator_Index_To_Instance, Accumulator_Valid_Instance,
         Accumulator_Object_Name, Accumulator_Read_Property,
@@ -384,7 +469,8 @@ static object_functions_t My_Object_Table[] = {
         NULL /* ReadRangeInfo */, NULL /* Iterator */, NULL /* Value_Lists */,
         NULL /* COV */, NULL /* COV Clear */, NULL /* Intrinsic Reporting */,
         NULL /* Add_List_Element */, NULL /* Remove_List_Element */,
-        NULL /* Create */, NULL /* Delete */, NULL /* Timer */ },
+        NULL /* Create */, NULL /* Delete */, NULL /* Timer */,
+        NULL /* Changed */ },
     { MAX_BACNET_OBJECT_TYPE, NULL /* Init */, NULL /* Count */,
         NULL /* Index_To_Instance */, NULL /* Valid_Instance */,
         NULL /* Object_Name */, NULL /* Read_Property */,
@@ -392,7 +478,8 @@ static object_functions_t My_Object_Table[] = {
         NULL /* ReadRangeInfo */, NULL /* Iterator */, NULL /* Value_Lists */,
         NULL /* COV */, NULL /* COV Clear */, NULL /* Intrinsic Reporting */,
         NULL /* Add_List_Element */, NULL /* Remove_List_Element */,
-        NULL /* Create */, NULL /* Delete */, NULL /* Timer */ },
+        NULL /* Create */, NULL /* Delete */, NULL /* Timer */,
+        NULL /* Changed */ },
 };
 /* clang-format on */
 
@@ -512,6 +599,9 @@ static const int Device_Properties_Optional[] = {
     PROP_DESCRIPTION, PROP_LOCAL_TIME, PROP_UTC_OFFSET, PROP_LOCAL_DATE,
     PROP_DAYLIGHT_SAVINGS_STATUS, PROP_LOCATION, PROP_ACTIVE_COV_SUBSCRIPTIONS,
     PROP_SERIAL_NUMBER,
+#if BACNET_SEGMENTATION_ENABLED
+    PROP_MAX_SEGMENTS_ACCEPTED, PROP_APDU_SEGMENT_TIMEOUT,
+#endif
 #if defined(BACNET_TIME_MASTER)
     PROP_TIME_SYNCHRONIZATION_RECIPIENTS, PROP_TIME_SYNCHRONIZATION_INTERVAL,
     PROP_ALIGN_INTERVALS, PROP_INTERVAL_OFFSET,
@@ -762,6 +852,7 @@ bool Device_Set_Object_Instance_Number(uint32_t object_id)
     if (object_id <= BACNET_MAX_INSTANCE) {
         /* Make the change and update the database revision */
         Object_Instance_Number = object_id;
+        Device_Object_List_Cache_Invalidate();
         Device_Inc_Database_Revision();
     } else {
         status = false;
@@ -794,6 +885,9 @@ bool Device_Set_Object_Name(const BACNET_CHARACTER_STRING *object_name)
     if (!characterstring_same(&My_Object_Name, object_name)) {
         /* Make the change and update the database revision */
         status = characterstring_copy(&My_Object_Name, object_name);
+        if (status) {
+            Device_Object_Name_Changed(OBJECT_DEVICE, Object_Instance_Number);
+        }
         Device_Inc_Database_Revision();
     }
 
@@ -802,6 +896,7 @@ bool Device_Set_Object_Name(const BACNET_CHARACTER_STRING *object_name)
 
 bool Device_Object_Name_ANSI_Init(const char *value)
 {
+    Device_Object_Name_Index_Invalidate();
     return characterstring_init_ansi(&My_Object_Name, value);
 }
 
@@ -995,7 +1090,11 @@ uint8_t Device_Protocol_Revision(void)
 
 BACNET_SEGMENTATION Device_Segmentation_Supported(void)
 {
+#if BACNET_SEGMENTATION_ENABLED
+    return SEGMENTATION_TRANSMIT;
+#else
     return SEGMENTATION_NONE;
+#endif
 }
 
 uint32_t Device_Database_Revision(void)
@@ -1018,12 +1117,10 @@ void Device_Inc_Database_Revision(void)
     Database_Revision++;
 }
 
-/** Get the total count of objects supported by this Device Object.
- * @note Since many network clients depend on the object list
- *       for discovery, it must be consistent!
+/** Count the objects of all the supported Object types.
  * @return The count of objects, for all supported Object types.
  */
-unsigned Device_Object_List_Count(void)
+static unsigned Device_Object_Table_Count(void)
 {
     unsigned count = 0; /* number of objects */
     struct object_functions *pObject = NULL;
@@ -1040,9 +1137,213 @@ unsigned Device_Object_List_Count(void)
     return count;
 }
 
-/** Lookup the Object at the given array index in the Device's Object List.
- * Even though we don't keep a single linear array of objects in the Device,
- * this method acts as though we do and works through a virtual, concatenated
+/** Mark the Object List cache as stale, after objects changed in a
+ * way that it cannot follow, so that it is rebuilt when next used.
+ */
+static void Device_Object_List_Cache_Invalidate(void)
+{
+    Object_List_Cache_Valid = false;
+    Object_Name_Index_Valid = false;
+}
+
+/** Compute the hash of an object identifier for the Object List index.
+ * @param object_type [in] The BACNET_OBJECT_TYPE of the Object
+ * @param object_instance [in] The object instance number of the Object
+ * @return hash of the object identifier
+ */
+static uint32_t Device_Object_Id_Hash(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+    uint32_t hash;
+
+    hash = ((uint32_t)object_type << 22) |
+        (object_instance & BACNET_MAX_INSTANCE);
+    /* spread the consecutive instances over the index */
+    hash ^= hash >> 16;
+    hash *= 0x45d9f3bUL;
+    hash ^= hash >> 16;
+
+    return hash;
+}
+
+/** Find the slot of an object in the Object List index.
+ * @param object_type [in] The BACNET_OBJECT_TYPE of the Object
+ * @param object_instance [in] The object instance number of the Object
+ * @return The slot of the object, or Object_List_Index_Size if the
+ *  object is not in the Object List cache.
+ */
+static uint32_t Device_Object_List_Index_Find(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+    const BACNET_OBJECT_ID *object_id = NULL;
+    uint32_t mask = Object_List_Index_Size - 1;
+    uint32_t value = 0;
+    uint32_t i = 0;
+    uint32_t n = 0;
+
+    i = Device_Object_Id_Hash(object_type, object_instance) & mask;
+    for (n = 0; n < Object_List_Index_Size; n++, i = (i + 1) & mask) {
+        value = Object_List_Index[i];
+        if (value == OBJECT_LIST_INDEX_EMPTY) {
+            break;
+        }
+        if (value != OBJECT_LIST_INDEX_REMOVED) {
+            object_id = &Object_List_Cache[value - 1].object_id;
+            if ((object_id->type == object_type) &&
+                (object_id->instance == object_instance)) {
+                return i;
+            }
+        }
+    }
+
+    return Object_List_Index_Size;
+}
+
+/** Add an object of the Object List cache to the Object List index.
+ * The object must not be in the index already.
+ * @param position [in] The position of the object in the cache
+ * @return True if the object was added, false if the index is full.
+ */
+static bool Device_Object_List_Index_Add(uint32_t position)
+{
+    const BACNET_OBJECT_ID *object_id =
+        &Object_List_Cache[position].object_id;
+    uint32_t mask = Object_List_Index_Size - 1;
+    uint32_t i = 0;
+    uint32_t n = 0;
+
+    i = Device_Object_Id_Hash(object_id->type, object_id->instance) & mask;
+    for (n = 0; n < Object_List_Index_Size; n++, i = (i + 1) & mask) {
+        if (Object_List_Index[i] == OBJECT_LIST_INDEX_EMPTY) {
+            Object_List_Index_Used++;
+            Object_List_Index[i] = position + 1;
+            return true;
+        }
+        if (Object_List_Index[i] == OBJECT_LIST_INDEX_REMOVED) {
+            /* removed slots that are reused are already counted */
+            Object_List_Index[i] = position + 1;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/** Rebuild the Object List index from the Object List cache.
+ * The index has at least twice as many slots as objects.
+ * @return True if the index is usable, false if out of memory.
+ */
+static bool Device_Object_List_Index_Build(void)
+{
+    uint32_t *index = NULL;
+    uint32_t size = 16;
+    uint32_t i = 0;
+
+    while (size < (Object_List_Cache_Count * 2)) {
+        size *= 2;
+    }
+    if (size != Object_List_Index_Size) {
+        index = realloc(Object_List_Index, size * sizeof(uint32_t));
+        if (!index) {
+            return false;
+        }
+        Object_List_Index = index;
+        Object_List_Index_Size = size;
+    }
+    for (i = 0; i < Object_List_Index_Size; i++) {
+        Object_List_Index[i] = OBJECT_LIST_INDEX_EMPTY;
+    }
+    Object_List_Index_Used = 0;
+    for (i = 0; i < Object_List_Cache_Count; i++) {
+        (void)Device_Object_List_Index_Add(i);
+    }
+
+    return true;
+}
+
+/** Rebuild the Object List cache from the object tables, if needed.
+ * Each object type is walked once, so this is O(N) for all N objects.
+ * @return True if the cache is usable, false if out of memory.
+ */
+static bool Device_Object_List_Cache_Update(void)
+{
+    struct object_functions *pObject = NULL;
+    struct object_list_entry *object_list = NULL;
+    unsigned objects = 0;
+    unsigned count = 0;
+    unsigned index = 0;
+    unsigned i = 0;
+    uint32_t n = 0;
+
+    if (Object_List_Cache_Valid) {
+        return true;
+    }
+    objects = Device_Object_Table_Count();
+    if (objects > Object_List_Cache_Size) {
+        object_list = realloc(
+            Object_List_Cache, objects * sizeof(struct object_list_entry));
+        if (!object_list) {
+            return false;
+        }
+        Object_List_Cache = object_list;
+        Object_List_Cache_Size = objects;
+    }
+    pObject = Object_Table;
+    while (pObject->Object_Type < MAX_BACNET_OBJECT_TYPE) {
+        if (pObject->Object_Count && pObject->Object_Index_To_Instance) {
+            count = pObject->Object_Count();
+            /* Use the iterator function if available otherwise
+             * the index is the same as the array index */
+            if (pObject->Object_Iterator) {
+                index = pObject->Object_Iterator(~(unsigned)0);
+            } else {
+                index = 0;
+            }
+            for (i = 0; (i < count) && (n < objects); i++) {
+                Object_List_Cache[n].object_id.type = pObject->Object_Type;
+                Object_List_Cache[n].object_id.instance =
+                    pObject->Object_Index_To_Instance(index);
+                n++;
+                if (pObject->Object_Iterator) {
+                    index = pObject->Object_Iterator(index);
+                } else {
+                    index++;
+                }
+            }
+        }
+        pObject++;
+    }
+    Object_List_Cache_Count = n;
+    Object_List_Cache_Objects = objects;
+    if (!Device_Object_List_Index_Build()) {
+        return false;
+    }
+    Object_List_Cache_Valid = true;
+
+    return true;
+}
+
+/** Get the total count of objects supported by this Device Object.
+ * @note Since many network clients depend on the object list
+ *       for discovery, it must be consistent!
+ * @return The count of objects, for all supported Object types.
+ */
+unsigned Device_Object_List_Count(void)
+{
+    unsigned count = 0; /* number of objects */
+
+    count = Device_Object_Table_Count();
+    if (count != Object_List_Cache_Objects) {
+        /* objects were added or removed without CreateObject or
+           DeleteObject, by an object type without a changed callback */
+        Device_Object_List_Cache_Invalidate();
+    }
+
+    return count;
+}
+
+/** Lookup the Object at the given array index in the Device's Object List
+ * without the cache. This method works through a virtual, concatenated
  * array of all of our object type arrays.
  *
  * @param array_index [in] The desired array index (1 to N)
@@ -1050,7 +1351,7 @@ unsigned Device_Object_List_Count(void)
  * @param instance [out] The object's instance number, if found.
  * @return True if found, else false.
  */
-bool Device_Object_List_Identifier(
+static bool Device_Object_List_Walk(
     uint32_t array_index, BACNET_OBJECT_TYPE *object_type, uint32_t *instance)
 {
     bool status = false;
@@ -1099,6 +1400,35 @@ bool Device_Object_List_Identifier(
     return status;
 }
 
+/** Lookup the Object at the given array index in the Device's Object List.
+ * The Object List is kept in a flat cache that is updated when objects
+ * are created or deleted, so each lookup is O(1).
+ *
+ * @param array_index [in] The desired array index (1 to N)
+ * @param object_type [out] The object's type, if found.
+ * @param instance [out] The object's instance number, if found.
+ * @return True if found, else false.
+ */
+bool Device_Object_List_Identifier(
+    uint32_t array_index, BACNET_OBJECT_TYPE *object_type, uint32_t *instance)
+{
+    /* array index zero is length - so invalid */
+    if (array_index == 0) {
+        return false;
+    }
+    if (!Device_Object_List_Cache_Update()) {
+        /* no memory for the cache */
+        return Device_Object_List_Walk(array_index, object_type, instance);
+    }
+    if (array_index > Object_List_Cache_Count) {
+        return false;
+    }
+    *object_type = Object_List_Cache[array_index - 1].object_id.type;
+    *instance = Object_List_Cache[array_index - 1].object_id.instance;
+
+    return true;
+}
+
 /**
  * @brief Encode a BACnetARRAY property element
  * @param object_instance [in] BACnet network port object instance number
@@ -1132,16 +1462,317 @@ int Device_Object_List_Element_Encode(
     return apdu_len;
 }
 
-/** Determine if we have an object with the given object_name.
- * If the object_type and object_instance pointers are not null,
- * and the lookup succeeds, they will be given the resulting values.
+/** Compute the hash of an object name for the object name index,
+ * using FNV-1a over the character set and the octets of the name.
+ * @param object_name [in] The object name
+ * @return hash of the object name
+ */
+static uint32_t Device_Object_Name_Hash(
+    const BACNET_CHARACTER_STRING *object_name)
+{
+    uint32_t hash = 2166136261UL;
+    size_t length;
+    size_t i;
+
+    hash ^= (uint8_t)object_name->encoding;
+    hash *= 16777619UL;
+    length = object_name->length;
+    if (length > MAX_CHARACTER_STRING_BYTES) {
+        length = MAX_CHARACTER_STRING_BYTES;
+    }
+    for (i = 0; i < length; i++) {
+        hash ^= (uint8_t)object_name->value[i];
+        hash *= 16777619UL;
+    }
+
+    return hash;
+}
+
+/** Add an object to the object name index, unless it is already there.
+ * @param hash [in] The hash of the object name
+ * @param object_type [in] The BACNET_OBJECT_TYPE of the Object
+ * @param object_instance [in] The object instance number of the Object
+ * @return True if the object is in the index, false if the index is full.
+ */
+static bool Device_Object_Name_Index_Add(
+    uint32_t hash, BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+    struct object_name_index_entry *entry = NULL;
+    struct object_name_index_entry *slot = NULL;
+    uint32_t mask = Object_Name_Index_Size - 1;
+    uint32_t i = 0;
+    uint32_t n = 0;
+
+    if (Object_Name_Index_Size == 0) {
+        return false;
+    }
+    for (n = 0, i = hash & mask; n < Object_Name_Index_Size;
+         n++, i = (i + 1) & mask) {
+        entry = &Object_Name_Index[i];
+        if (entry->object_id.type == OBJECT_NAME_INDEX_EMPTY) {
+            if (!slot) {
+                slot = entry;
+            }
+            break;
+        } else if (entry->object_id.type == OBJECT_NAME_INDEX_REMOVED) {
+            if (!slot) {
+                slot = entry;
+            }
+        } else if (
+            (entry->hash == hash) && (entry->object_id.type == object_type) &&
+            (entry->object_id.instance == object_instance)) {
+            return true;
+        }
+    }
+    if (!slot) {
+        return false;
+    }
+    if (slot->object_id.type == OBJECT_NAME_INDEX_EMPTY) {
+        /* removed slots that are reused are already counted */
+        Object_Name_Index_Used++;
+    }
+    slot->hash = hash;
+    slot->object_id.type = object_type;
+    slot->object_id.instance = object_instance;
+
+    return true;
+}
+
+/** Remove an object from the object name index.
+ * @param hash [in] The hash of the previous object name
+ * @param object_type [in] The BACNET_OBJECT_TYPE of the Object
+ * @param object_instance [in] The object instance number of the Object
+ */
+static void Device_Object_Name_Index_Remove(
+    uint32_t hash, BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+    struct object_name_index_entry *entry = NULL;
+    uint32_t mask = Object_Name_Index_Size - 1;
+    uint32_t i = 0;
+    uint32_t n = 0;
+
+    for (n = 0, i = hash & mask; n < Object_Name_Index_Size;
+         n++, i = (i + 1) & mask) {
+        entry = &Object_Name_Index[i];
+        if (entry->object_id.type == OBJECT_NAME_INDEX_EMPTY) {
+            break;
+        }
+        if ((entry->hash == hash) && (entry->object_id.type == object_type) &&
+            (entry->object_id.instance == object_instance)) {
+            entry->object_id.type = OBJECT_NAME_INDEX_REMOVED;
+            break;
+        }
+    }
+}
+
+/** Add an object of the Object List cache to the object name index, and
+ * keep the hash of its name in the cache for when it is renamed or deleted.
+ * @param entry [in,out] The object in the Object List cache
+ * @return True if the object is in the index or has no name, false if the
+ *  index is full.
+ */
+static bool Device_Object_Name_Index_Entry_Add(struct object_list_entry *entry)
+{
+    struct object_functions *pObject = NULL;
+    BACNET_CHARACTER_STRING object_name;
+
+    entry->name_hash = 0;
+    pObject = Device_Objects_Find_Functions(entry->object_id.type);
+    if ((pObject == NULL) || (pObject->Object_Name == NULL) ||
+        !pObject->Object_Name(entry->object_id.instance, &object_name)) {
+        return true;
+    }
+    entry->name_hash = Device_Object_Name_Hash(&object_name);
+
+    return Device_Object_Name_Index_Add(
+        entry->name_hash, entry->object_id.type, entry->object_id.instance);
+}
+
+/** Rebuild the object name index from the Object List, if needed.
+ * The index has at least twice as many slots as objects.
+ * @return True if the index is usable, false if out of memory.
+ */
+static bool Device_Object_Name_Index_Update(void)
+{
+    struct object_name_index_entry *index = NULL;
+    uint32_t size = 16;
+    uint32_t i = 0;
+
+    if (Object_Name_Index_Valid) {
+        return true;
+    }
+    if (!Device_Object_List_Cache_Update()) {
+        return false;
+    }
+    while (size < (Object_List_Cache_Count * 2)) {
+        size *= 2;
+    }
+    if (size != Object_Name_Index_Size) {
+        index = realloc(
+            Object_Name_Index, size * sizeof(struct object_name_index_entry));
+        if (!index) {
+            return false;
+        }
+        Object_Name_Index = index;
+        Object_Name_Index_Size = size;
+    }
+    for (i = 0; i < Object_Name_Index_Size; i++) {
+        Object_Name_Index[i].object_id.type = OBJECT_NAME_INDEX_EMPTY;
+    }
+    Object_Name_Index_Used = 0;
+    for (i = 0; i < Object_List_Cache_Count; i++) {
+        (void)Device_Object_Name_Index_Entry_Add(&Object_List_Cache[i]);
+    }
+    Object_Name_Index_Valid = true;
+
+    return true;
+}
+
+/** Update the object name index after an object was renamed. The entry
+ * of the previous name is found by the hash kept in the Object List cache.
+ * @param object_type [in] The BACNET_OBJECT_TYPE of the renamed Object
+ * @param object_instance [in] The object instance number of the Object
+ */
+static void Device_Object_Name_Changed(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+    struct object_list_entry *entry = NULL;
+    uint32_t slot = 0;
+
+    if (!Object_Name_Index_Valid) {
+        /* rebuilt with the new name when next used */
+        return;
+    }
+    slot = Device_Object_List_Index_Find(object_type, object_instance);
+    if (slot >= Object_List_Index_Size) {
+        /* not in the Object List yet - rebuild when next used */
+        Object_Name_Index_Valid = false;
+        return;
+    }
+    entry = &Object_List_Cache[Object_List_Index[slot] - 1];
+    Device_Object_Name_Index_Remove(
+        entry->name_hash, object_type, object_instance);
+    if ((Object_Name_Index_Used >= (Object_Name_Index_Size / 2)) ||
+        !Device_Object_Name_Index_Entry_Add(entry)) {
+        /* too many removed entries - rebuild when next used */
+        Object_Name_Index_Valid = false;
+    }
+}
+
+/** Mark the object name index as stale, so that it is rebuilt when next
+ * used. Call this after changing an object name without WriteProperty,
+ * in an object type that does not have a changed callback.
+ */
+void Device_Object_Name_Index_Invalidate(void)
+{
+    Object_Name_Index_Valid = false;
+}
+
+/** Append a created object to the Object List cache, and to the object
+ * name index, unless the object is already in the cache.
+ * @param object_type [in] The BACNET_OBJECT_TYPE of the created Object
+ * @param object_instance [in] The object instance number of the Object
+ */
+static void Device_Object_List_Add(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+    struct object_list_entry *object_list = NULL;
+    struct object_list_entry *entry = NULL;
+    uint32_t size = 0;
+
+    if (!Object_List_Cache_Valid) {
+        /* rebuilt with the object when next used */
+        return;
+    }
+    if (Device_Object_List_Index_Find(object_type, object_instance) <
+        Object_List_Index_Size) {
+        return;
+    }
+    if (Object_List_Cache_Count >= Object_List_Cache_Size) {
+        size = Object_List_Cache_Size * 2;
+        if (size < 16) {
+            size = 16;
+        }
+        object_list =
+            realloc(Object_List_Cache, size * sizeof(struct object_list_entry));
+        if (!object_list) {
+            Device_Object_List_Cache_Invalidate();
+            return;
+        }
+        Object_List_Cache = object_list;
+        Object_List_Cache_Size = size;
+    }
+    entry = &Object_List_Cache[Object_List_Cache_Count];
+    entry->object_id.type = object_type;
+    entry->object_id.instance = object_instance;
+    entry->name_hash = 0;
+    Object_List_Cache_Count++;
+    Object_List_Cache_Objects++;
+    if ((Object_List_Index_Used >= (Object_List_Index_Size / 2)) ||
+        !Device_Object_List_Index_Add(Object_List_Cache_Count - 1)) {
+        /* grow the index, and drop its removed entries */
+        if (!Device_Object_List_Index_Build()) {
+            Device_Object_List_Cache_Invalidate();
+            return;
+        }
+    }
+    if (!Object_Name_Index_Valid) {
+        return;
+    }
+    if ((Object_Name_Index_Used >= (Object_Name_Index_Size / 2)) ||
+        !Device_Object_Name_Index_Entry_Add(entry)) {
+        /* too many entries - rebuild when next used */
+        Object_Name_Index_Valid = false;
+    }
+}
+
+/** Remove a deleted object from the Object List cache and the object name
+ * index, by moving the last object of the cache into its place.
+ * @param object_type [in] The BACNET_OBJECT_TYPE of the deleted Object
+ * @param object_instance [in] The object instance number of the Object
+ */
+static void Device_Object_List_Remove(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+    uint32_t position = 0;
+    uint32_t last = 0;
+    uint32_t slot = 0;
+
+    if (!Object_List_Cache_Valid) {
+        return;
+    }
+    slot = Device_Object_List_Index_Find(object_type, object_instance);
+    if (slot >= Object_List_Index_Size) {
+        return;
+    }
+    position = Object_List_Index[slot] - 1;
+    Object_List_Index[slot] = OBJECT_LIST_INDEX_REMOVED;
+    if (Object_Name_Index_Valid) {
+        Device_Object_Name_Index_Remove(
+            Object_List_Cache[position].name_hash, object_type,
+            object_instance);
+    }
+    last = Object_List_Cache_Count - 1;
+    if (position != last) {
+        slot = Device_Object_List_Index_Find(
+            Object_List_Cache[last].object_id.type,
+            Object_List_Cache[last].object_id.instance);
+        Object_List_Index[slot] = position + 1;
+        Object_List_Cache[position] = Object_List_Cache[last];
+    }
+    Object_List_Cache_Count--;
+    Object_List_Cache_Objects--;
+}
+
+/** Determine if we have an object with the given object_name
+ * by walking all of the objects.
  * @param object_name [in] The desired Object Name to look for.
  * @param object_type [out] The BACNET_OBJECT_TYPE of the matching Object.
  * @param object_instance [out] The object instance number of the matching
  * Object.
  * @return True on success or else False if not found.
  */
-bool Device_Valid_Object_Name(
+static bool Device_Valid_Object_Name_Walk(
     const BACNET_CHARACTER_STRING *object_name1,
     BACNET_OBJECT_TYPE *object_type,
     uint32_t *object_instance)
@@ -1177,6 +1808,69 @@ bool Device_Valid_Object_Name(
     return found;
 }
 
+/** Determine if we have an object with the given object_name.
+ * If the object_type and object_instance pointers are not null,
+ * and the lookup succeeds, they will be given the resulting values.
+ * The object names are found using a hash index, and each candidate
+ * is confirmed by comparing its current name.
+ * @param object_name [in] The desired Object Name to look for.
+ * @param object_type [out] The BACNET_OBJECT_TYPE of the matching Object.
+ * @param object_instance [out] The object instance number of the matching
+ * Object.
+ * @return True on success or else False if not found.
+ */
+bool Device_Valid_Object_Name(
+    const BACNET_CHARACTER_STRING *object_name1,
+    BACNET_OBJECT_TYPE *object_type,
+    uint32_t *object_instance)
+{
+    struct object_name_index_entry *entry = NULL;
+    BACNET_CHARACTER_STRING object_name2;
+    struct object_functions *pObject = NULL;
+    uint32_t hash = 0;
+    uint32_t mask = 0;
+    uint32_t i = 0;
+    uint32_t n = 0;
+
+    if (!object_name1) {
+        return false;
+    }
+    /* detects objects added or removed without CreateObject or DeleteObject */
+    (void)Device_Object_List_Count();
+    if (!Device_Object_Name_Index_Update()) {
+        /* no memory for the index */
+        return Device_Valid_Object_Name_Walk(
+            object_name1, object_type, object_instance);
+    }
+    hash = Device_Object_Name_Hash(object_name1);
+    mask = Object_Name_Index_Size - 1;
+    for (n = 0, i = hash & mask; n < Object_Name_Index_Size;
+         n++, i = (i + 1) & mask) {
+        entry = &Object_Name_Index[i];
+        if (entry->object_id.type == OBJECT_NAME_INDEX_EMPTY) {
+            break;
+        }
+        if ((entry->object_id.type == OBJECT_NAME_INDEX_REMOVED) ||
+            (entry->hash != hash)) {
+            continue;
+        }
+        pObject = Device_Objects_Find_Functions(entry->object_id.type);
+        if ((pObject != NULL) && (pObject->Object_Name != NULL) &&
+            (pObject->Object_Name(entry->object_id.instance, &object_name2) &&
+             characterstring_same(object_name1, &object_name2))) {
+            if (object_type) {
+                *object_type = entry->object_id.type;
+            }
+            if (object_instance) {
+                *object_instance = entry->object_id.instance;
+            }
+            return true;
+        }
+    }
+
+    return false;
+}
+
 /** Determine if we have an object of this type and instance number.
  * @param object_type [in] The desired BACNET_OBJECT_TYPE
  * @param object_instance [in] The object instance number to be looked up.
@@ -1475,6 +2169,16 @@ int Device_Read_Property_Local(BACNET_READ_PROPERTY_DATA *rpdata)
         case PROP_APDU_TIMEOUT:
             apdu_len = encode_application_unsigned(&apdu[0], apdu_timeout());
             break;
+#if BACNET_SEGMENTATION_ENABLED
+        case PROP_MAX_SEGMENTS_ACCEPTED:
+            apdu_len = encode_application_unsigned(
+                &apdu[0], apdu_max_segments_accepted());
+            break;
+        case PROP_APDU_SEGMENT_TIMEOUT:
+            apdu_len =
+                encode_application_unsigned(&apdu[0], apdu_segment_timeout());
+            break;
+#endif
         case PROP_NUMBER_OF_APDU_RETRIES:
             apdu_len = encode_application_unsigned(&apdu[0], apdu_retries());
             break;
@@ -1692,6 +2396,15 @@ bool Device_Write_Property_Local(BACNET_WRITE_PROPERTY_DATA *wp_data)
                 apdu_timeout_set((uint16_t)value.type.Unsigned_Int);
             }
             break;
+#if BACNET_SEGMENTATION_ENABLED
+        case PROP_APDU_SEGMENT_TIMEOUT:
+            status = write_property_type_valid(
+                wp_data, &value, BACNET_APPLICATION_TAG_UNSIGNED_INT);
+            if (status) {
+                apdu_segment_timeout_set((uint16_t)value.type.Unsigned_Int);
+            }
+            break;
+#endif
         case PROP_VENDOR_IDENTIFIER:
             status = write_property_type_valid(
                 wp_data, &value, BACNET_APPLICATION_TAG_UNSIGNED_INT);
@@ -1936,6 +2649,10 @@ static bool Device_Write_Property_Object_Name(
             }
         } else {
             status = Object_Write_Property(wp_data);
+            if (status) {
+                Device_Object_Name_Changed(
+                    wp_data->object_type, wp_data->object_instance);
+            }
         }
     }
 
@@ -2203,6 +2920,7 @@ bool Device_Create_Object(BACNET_CREATE_OBJECT_DATA *data)
                 } else {
                     /* required by ACK */
                     data->object_instance = object_instance;
+                    Device_Object_List_Add(data->object_type, object_instance);
                     Device_Inc_Database_Revision();
                     status = true;
                 }
@@ -2242,6 +2960,8 @@ bool Device_Delete_Object(BACNET_DELETE_OBJECT_DATA *data)
             /* The object being deleted must already exist */
             status = pObject->Object_Delete(data->object_instance);
             if (status) {
+                Device_Object_List_Remove(
+                    data->object_type, data->object_instance);
                 Device_Inc_Database_Revision();
             } else {
                 /* The object exists but cannot be deleted. */
@@ -2263,29 +2983,136 @@ bool Device_Delete_Object(BACNET_DELETE_OBJECT_DATA *data)
 }
 
 #if defined(INTRINSIC_REPORTING)
-void Device_local_reporting(void)
+/**
+ * @brief Evaluate an object on the next intrinsic reporting tick. Called
+ *  by the objects when a monitored value or an event property changes,
+ *  when an event is acknowledged, and while a Time_Delay is counting.
+ * @param object_type - object type of the object to evaluate
+ * @param object_instance - object instance number of the object
+ */
+void Device_Event_Detection_Schedule(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
 {
-    struct object_functions *pObject = NULL;
-    uint32_t objects_count = 0;
-    uint32_t object_instance = 0;
-    BACNET_OBJECT_TYPE object_type = OBJECT_NONE;
-    uint32_t idx = 0;
+    KEY key;
+
+    if (!Event_Detection_List) {
+        Event_Detection_List = Keylist_Create();
+    }
+    key = KEY_ENCODE(object_type, object_instance);
+    if (Keylist_Index(Event_Detection_List, key) < 0) {
+        Keylist_Data_Add(Event_Detection_List, key, NULL);
+    }
+}
+
+/**
+ * @brief Get the number of objects scheduled for evaluation on the next
+ *  intrinsic reporting tick
+ * @return number of objects
+ */
+unsigned Device_Event_Detection_Pending(void)
+{
+    if (!Event_Detection_List) {
+        return 0;
+    }
+
+    return (unsigned)Keylist_Count(Event_Detection_List);
+}
+
+/**
+ * @brief Determine if an object type schedules its own evaluation
+ * @param object_type - object type to check
+ * @return true if the object type calls Device_Event_Detection_Schedule()
+ */
+static bool Device_Event_Detection_Scheduled(BACNET_OBJECT_TYPE object_type)
+{
+    if (object_type < MAX_BACNET_OBJECT_TYPE) {
+        if (Event_Detection_Types[object_type / 8] &
+            (1 << (object_type % 8))) {
+            return true;
+        }
+    }
 
-    objects_count = Device_Object_List_Count();
+    return false;
+}
 
-    /* loop for all objects */
-    for (idx = 1; idx <= objects_count; idx++) {
-        Device_Object_List_Identifier(idx, &object_type, &object_instance);
+/**
+ * @brief Configure the object types that schedule their intrinsic
+ *  reporting, and schedule each of their existing objects once
+ * @param pObject - object functions of an object type in the table
+ * @param changes - the OBJECT_CHANGE_x changes that the type reports
+ */
+static void Device_Object_Event_Detection_Init(
+    struct object_functions *pObject, unsigned changes)
+{
+    unsigned count, index;
 
-        pObject = Device_Objects_Find_Functions(object_type);
-        if (pObject != NULL) {
-            if (pObject->Object_Valid_Instance &&
-                pObject->Object_Valid_Instance(object_instance)) {
-                if (pObject->Object_Intrinsic_Reporting) {
-                    pObject->Object_Intrinsic_Reporting(object_instance);
-                }
+    if (pObject->Object_Type >= MAX_BACNET_OBJECT_TYPE) {
+        return;
+    }
+    if (pObject->Object_Intrinsic_Reporting &&
+        (changes & OBJECT_CHANGE_EVENT)) {
+        Event_Detection_Types[pObject->Object_Type / 8] |=
+            (1 << (pObject->Object_Type % 8));
+        count = pObject->Object_Count ? pObject->Object_Count() : 0;
+        for (index = 0; index < count; index++) {
+            Device_Event_Detection_Schedule(
+                pObject->Object_Type,
+                pObject->Object_Index_To_Instance(index));
+        }
+    } else {
+        Event_Detection_Types[pObject->Object_Type / 8] &=
+            ~(1 << (pObject->Object_Type % 8));
+    }
+}
+
+/**
+ * @brief Intrinsic reporting tick, called once each second. The objects
+ *  that schedule their evaluation are evaluated only when they have been
+ *  scheduled, and the objects of other types are evaluated each tick.
+ */
+void Device_local_reporting(void)
+{
+    struct object_functions *pObject = NULL;
+    OS_Keylist list;
+    BACNET_OBJECT_TYPE object_type;
+    uint32_t object_instance;
+    unsigned count, index;
+    KEY key = 0;
+    int i;
+
+    /* object types that do not schedule their evaluation */
+    pObject = Object_Table;
+    while (pObject && (pObject->Object_Type < MAX_BACNET_OBJECT_TYPE)) {
+        if (pObject->Object_Intrinsic_Reporting && pObject->Object_Count &&
+            pObject->Object_Index_To_Instance &&
+            !Device_Event_Detection_Scheduled(pObject->Object_Type)) {
+            count = pObject->Object_Count();
+            for (index = 0; index < count; index++) {
+                object_instance = pObject->Object_Index_To_Instance(index);
+                pObject->Object_Intrinsic_Reporting(object_instance);
             }
         }
+        pObject++;
+    }
+    /* the objects scheduled during this tick are evaluated on the next */
+    list = Event_Detection_List;
+    Event_Detection_List = Event_Detection_Work;
+    Event_Detection_Work = list;
+    for (i = 0; i < Keylist_Count(list); i++) {
+        if (!Keylist_Index_Key(list, i, &key)) {
+            continue;
+        }
+        object_type = (BACNET_OBJECT_TYPE)KEY_DECODE_TYPE(key);
+        object_instance = KEY_DECODE_ID(key);
+        pObject = Device_Objects_Find_Functions(object_type);
+        if (pObject && pObject->Object_Intrinsic_Reporting &&
+            pObject->Object_Valid_Instance &&
+            pObject->Object_Valid_Instance(object_instance)) {
+            pObject->Object_Intrinsic_Reporting(object_instance);
+        }
+    }
+    while (Keylist_Count(list) > 0) {
+        (void)Keylist_Data_Pop(list);
     }
 }
 #endif
@@ -2310,6 +3137,41 @@ bool Device_Value_List_Supported(BACNET_OBJECT_TYPE object_type)
     return (status);
 }
 
+/**
+ * @brief Called by the object types when one of their objects changes,
+ *  so that the Device object does not walk the objects to find it
+ * @param object_type - object type of the object
+ * @param object_instance - object instance number of the object
+ * @param change - what changed in the object
+ */
+static void Device_Object_Changed(
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
+    OBJECT_CHANGE change)
+{
+    switch (change) {
+        case OBJECT_CHANGE_CREATED:
+            Device_Object_List_Add(object_type, object_instance);
+            break;
+        case OBJECT_CHANGE_DELETED:
+            Device_Object_List_Remove(object_type, object_instance);
+            break;
+        case OBJECT_CHANGE_NAME:
+            Device_Object_Name_Changed(object_type, object_instance);
+            break;
+        case OBJECT_CHANGE_COV:
+            handler_cov_change_notify(object_type, object_instance);
+            break;
+#if defined(INTRINSIC_REPORTING)
+        case OBJECT_CHANGE_EVENT:
+            Device_Event_Detection_Schedule(object_type, object_instance);
+            break;
+#endif
+        default:
+            break;
+    }
+}
+
 /** Initialize the Device Object.
  Initialize the group of object helper functions for any supported Object.
  Initialize each of the Device Object child Object instances.
@@ -2321,6 +3183,8 @@ bool Device_Value_List_Supported(BACNET_OBJECT_TYPE object_type)
 void Device_Init(object_functions_t *object_table)
 {
     struct object_functions *pObject = NULL;
+    unsigned changes = 0;
+
     characterstring_init_ansi(&My_Object_Name, "SimpleServer");
     datetime_init();
     if (object_table) {
@@ -2328,11 +3192,23 @@ void Device_Init(object_functions_t *object_table)
     } else {
         Object_Table = &My_Object_Table[0];
     }
+    Device_Object_List_Cache_Invalidate();
     pObject = Object_Table;
     while (pObject->Object_Type < MAX_BACNET_OBJECT_TYPE) {
         if (pObject->Object_Init) {
             pObject->Object_Init();
         }
+        changes = 0;
+        if (pObject->Object_Changed_Callback_Set) {
+            changes =
+                pObject->Object_Changed_Callback_Set(Device_Object_Changed);
+        }
+        /* the COV handler polls the object types that do not report */
+        handler_cov_change_notify_type_set(
+            pObject->Object_Type, (changes & OBJECT_CHANGE_COV) != 0);
+#if defined(INTRINSIC_REPORTING)
+        Device_Object_Event_Detection_Init(pObject, changes);
+#endif
         pObject++;
     }
 #if (BACNET_PROTOCOL_REVISION >= 14)
@@ -96,6 +96,43 @@ typedef bool (*object_cov_function)(uint32_t object_instance);
  */
 typedef void (*object_cov_clear_function)(uint32_t object_instance);
 
+/** The changes that an object type reports about its objects.
+ * @ingroup ObjHelpers
+ */
+typedef enum object_change {
+    /* the object was created */
+    OBJECT_CHANGE_CREATED = 0x01,
+    /* the object was deleted */
+    OBJECT_CHANGE_DELETED = 0x02,
+    /* the object was renamed without WriteProperty */
+    OBJECT_CHANGE_NAME = 0x04,
+    /* the COV flag of the object was set */
+    OBJECT_CHANGE_COV = 0x08,
+    /* the object has to be evaluated by intrinsic reporting */
+    OBJECT_CHANGE_EVENT = 0x10
+} OBJECT_CHANGE;
+
+/** Called by an object type when one of its objects changes, so that
+ * the Device object keeps its Object_List and indexes without polling.
+ * @ingroup ObjHelpers
+ * @param [in] The object type of the object that changed.
+ * @param [in] The object instance number of the object.
+ * @param [in] The change to the object.
+ */
+typedef void (*object_changed_function)(
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
+    OBJECT_CHANGE change);
+
+/** Sets the function that an object type calls when one of its objects
+ * changes.
+ * @ingroup ObjHelpers
+ * @param [in] The function to call, or NULL to stop calling.
+ * @return The OBJECT_CHANGE values that the object type reports, or'ed.
+ */
+typedef unsigned (*object_changed_callback_set_function)(
+    object_changed_function cb);
+
 /** Intrinsic Reporting functionality.
  * @ingroup ObjHelpers
  * @param [in] Object instance.
@@ -140,6 +177,7 @@ typedef struct object_functions {
     create_object_function Object_Create;
     delete_object_function Object_Delete;
     object_timer_function Object_Timer;
+    object_changed_callback_set_function Object_Changed_Callback_Set;
 } object_functions_t;
 
 /* String Lengths - excluding any nul terminator */
@@ -370,6 +408,8 @@ bool Device_Valid_Object_Name(
     BACNET_OBJECT_TYPE *object_type,
     uint32_t *object_instance);
 BACNET_STACK_EXPORT
+void Device_Object_Name_Index_Invalidate(void);
+BACNET_STACK_EXPORT
 bool Device_Valid_Object_Id(
     BACNET_OBJECT_TYPE object_type, uint32_t object_instance);
 
@@ -399,6 +439,11 @@ void Device_Write_Property_Store_Callback_Set(write_property_function cb);
 #if defined(INTRINSIC_REPORTING)
 BACNET_STACK_EXPORT
 void Device_local_reporting(void);
+BACNET_STACK_EXPORT
+void Device_Event_Detection_Schedule(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance);
+BACNET_STACK_EXPORT
+unsigned Device_Event_Detection_Pending(void);
 #endif
 
 /* Prototypes for Routing functionality in the Device Object.
@@ -425,6 +470,13 @@ BACNET_STACK_EXPORT
 bool Routed_Device_GetNext(
     const BACNET_ADDRESS *dest, const int *DNET_list, int *cursor);
 BACNET_STACK_EXPORT
+bool Routed_Device_GetNext_In_Range(
+    const BACNET_ADDRESS *dest,
+    const int *DNET_list,
+    uint32_t low_limit,
+    uint32_t high_limit,
+    int *cursor);
+BACNET_STACK_EXPORT
 bool Routed_Device_Is_Valid_Network(uint16_t dest_net, const int *DNET_list);
 
 BACNET_STACK_EXPORT
@@ -439,6 +491,8 @@ uint32_t Routed_Device_Object_Instance_Number(void);
 BACNET_STACK_EXPORT
 bool Routed_Device_Set_Object_Instance_Number(uint32_t object_id);
 BACNET_STACK_EXPORT
+bool Routed_Device_Set_Address(const BACNET_ADDRESS *address);
+BACNET_STACK_EXPORT
 bool Routed_Device_Set_Object_Name(
     uint8_t encoding, const char *value, size_t length);
 BACNET_STACK_EXPORT
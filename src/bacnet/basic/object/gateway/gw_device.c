@@ -76,6 +76,128 @@ uint16_t Num_Managed_Devices = 0;
  */
 uint16_t iCurrent_Device_Idx = 0;
 
+/* Lookup indexes of the Devices[], so that a routed APDU is given to its
+ * device without a scan of every device.  The indexes are rebuilt on their
+ * next use after a device is added, or its address or instance changes. */
+/* marks the end of a hash chain */
+#define ROUTED_DEVICE_NONE UINT16_MAX
+/* hash chains of the devices by MAC address, and by device instance */
+static uint16_t Address_Bucket[MAX_NUM_DEVICES];
+static uint16_t Address_Next[MAX_NUM_DEVICES];
+static uint16_t Instance_Bucket[MAX_NUM_DEVICES];
+static uint16_t Instance_Next[MAX_NUM_DEVICES];
+/* the devices in order of device instance, for Who-Is ranges */
+static uint16_t Instance_Order[MAX_NUM_DEVICES];
+static bool Routed_Device_Index_Stale = true;
+
+/**
+ * @brief Hash a MAC address into an index of the address buckets
+ * @param dlen - number of octets in the MAC address
+ * @param dadr - MAC address
+ * @return bucket index
+ */
+static unsigned routed_device_address_hash(uint8_t dlen, const uint8_t *dadr)
+{
+    /* FNV-1a */
+    uint32_t hash = 2166136261UL;
+    uint8_t i;
+
+    for (i = 0; i < dlen; i++) {
+        hash ^= dadr[i];
+        hash *= 16777619UL;
+    }
+
+    return hash % MAX_NUM_DEVICES;
+}
+
+/**
+ * @brief Rebuild the lookup indexes of the devices, if they are stale
+ */
+static void routed_device_index_update(void)
+{
+    const DEVICE_OBJECT_DATA *pDev;
+    uint32_t instance;
+    unsigned bucket;
+    uint16_t i, j;
+
+    if (!Routed_Device_Index_Stale) {
+        return;
+    }
+    for (i = 0; i < MAX_NUM_DEVICES; i++) {
+        Address_Bucket[i] = ROUTED_DEVICE_NONE;
+        Instance_Bucket[i] = ROUTED_DEVICE_NONE;
+    }
+    /* add in reverse, so that each chain is in order of index */
+    for (i = Num_Managed_Devices; i > 0; i--) {
+        pDev = &Devices[i - 1];
+        bucket = routed_device_address_hash(
+            pDev->bacDevAddr.len, pDev->bacDevAddr.adr);
+        Address_Next[i - 1] = Address_Bucket[bucket];
+        Address_Bucket[bucket] = i - 1;
+        bucket = pDev->bacObj.Object_Instance_Number % MAX_NUM_DEVICES;
+        Instance_Next[i - 1] = Instance_Bucket[bucket];
+        Instance_Bucket[bucket] = i - 1;
+    }
+    /* insertion sort: devices are usually added in order of instance */
+    for (i = 0; i < Num_Managed_Devices; i++) {
+        instance = Devices[i].bacObj.Object_Instance_Number;
+        for (j = i; j > 0; j--) {
+            if (Devices[Instance_Order[j - 1]].bacObj.Object_Instance_Number <=
+                instance) {
+                break;
+            }
+            Instance_Order[j] = Instance_Order[j - 1];
+        }
+        Instance_Order[j] = i;
+    }
+    Routed_Device_Index_Stale = false;
+}
+
+/**
+ * @brief Find the next routed device in the chain of a MAC address.
+ *  The gateway device is not a routed device, and is skipped.
+ * @param dlen - number of octets in the MAC address
+ * @param dadr - MAC address
+ * @param idx - [in,out] 0 to start at the head of the chain, else the
+ *  next device in the chain to look at. On a match, returns the next
+ *  device to look at, or Num_Managed_Devices at the end of the chain.
+ * @return true if a device was found, and made the current device
+ */
+static bool routed_device_address_next(
+    uint8_t dlen, const uint8_t *dadr, int *idx)
+{
+    const DEVICE_OBJECT_DATA *pDev;
+    uint16_t i;
+
+    routed_device_index_update();
+    if (*idx == 0) {
+        i = Address_Bucket[routed_device_address_hash(dlen, dadr)];
+    } else {
+        i = (uint16_t)*idx;
+    }
+    while (i != ROUTED_DEVICE_NONE) {
+        pDev = &Devices[i];
+        if ((i != 0) && (pDev->bacDevAddr.len == dlen) &&
+            (memcmp(pDev->bacDevAddr.adr, dadr, dlen) == 0)) {
+            iCurrent_Device_Idx = i;
+            i = Address_Next[i];
+            if (i == 0) {
+                /* a cursor of 0 would start over */
+                i = Address_Next[0];
+            }
+            if (i == ROUTED_DEVICE_NONE) {
+                *idx = Num_Managed_Devices;
+            } else {
+                *idx = i;
+            }
+            return true;
+        }
+        i = Address_Next[i];
+    }
+
+    return false;
+}
+
 /* void Routing_Device_Init(uint32_t first_object_instance) is
  * found in device.c
  */
@@ -114,6 +236,7 @@ uint16_t Add_Routed_Device(
             Routed_Device_Set_Description("No Descr", strlen("No Descr"));
         }
         pDev->Database_Revision = 0; /* Reset/Initialize now */
+        Routed_Device_Index_Stale = true;
         return i;
     } else {
         return UINT16_MAX;
@@ -128,6 +251,9 @@ uint16_t Add_Routed_Device(
  *                 If valid idx, will set iCurrent_Device_Idx with the idx
  * @return Pointer to the requested Device Object data, or NULL if the idx
  *         is for an invalid row entry (eg, after the last good Device).
+ *         Use Routed_Device_Set_Address() and
+ *         Routed_Device_Set_Object_Instance_Number() to change the address
+ *         or the instance, so that the lookup indexes are kept current.
  */
 DEVICE_OBJECT_DATA *Get_Routed_Device_Object(int idx)
 {
@@ -149,6 +275,7 @@ DEVICE_OBJECT_DATA *Get_Routed_Device_Object(int idx)
  *                 If valid idx, will set iCurrent_Device_Idx with the idx
  * @return Pointer to the requested Device Object BACnet address, or NULL if the
  * idx is for an invalid row entry (eg, after the last good Device).
+ * Use Routed_Device_Set_Address() to change it.
  */
 BACNET_ADDRESS *Get_Routed_Device_Address(int idx)
 {
@@ -258,7 +385,7 @@ bool Routed_Device_GetNext(
     /* First, see if the index is out of range.
      * Eg, last call to GetNext may have been the last successful one.
      */
-    if ((idx < 0) || (idx >= MAX_NUM_DEVICES)) {
+    if ((idx < 0) || (idx >= Num_Managed_Devices)) {
         idx = -1;
 
         /* Next, see if it's a BACnet broadcast.
@@ -285,21 +412,23 @@ bool Routed_Device_GetNext(
      * For broadcasts, all Devices get a chance at it.
      */
     else if (dest->net == dnet) {
-        if (idx == 0) { /* Step over this case (starting point) */
-            idx = 1;
-        }
-        while (idx < MAX_NUM_DEVICES) {
-            bSuccess =
-                Routed_Device_Address_Lookup(idx++, dest->len, dest->adr);
-            if (bSuccess) {
-                break; /* We don't need to keep looking */
+        if (dest->len == 0) {
+            /* MAC broadcast: each routed Device in turn */
+            if (idx == 0) { /* Step over this case (starting point) */
+                idx = 1;
             }
+            if (idx < Num_Managed_Devices) {
+                bSuccess = Routed_Device_Address_Lookup(idx++, 0, NULL);
+            }
+        } else {
+            /* the cursor follows the hash chain of the MAC address */
+            bSuccess = routed_device_address_next(dest->len, dest->adr, &idx);
         }
     }
 
     if (!bSuccess) {
         *cursor = -1;
-    } else if (idx == MAX_NUM_DEVICES) { /* No more to GetNext */
+    } else if (idx >= Num_Managed_Devices) { /* No more to GetNext */
         *cursor = -1;
     } else {
         *cursor = idx;
@@ -307,6 +436,91 @@ bool Routed_Device_GetNext(
     return bSuccess;
 }
 
+/** Find the next Gateway or Routed Device for the destination, as
+ * Routed_Device_GetNext() does, whose Device instance is within a range,
+ * such as the range of a Who-Is.
+ * For a broadcast, the Devices are visited in order of Device instance,
+ * starting with a binary search for the low limit, so that Devices out of
+ * the range are not visited.
+ *
+ * @param dest [in] The BACNET_ADDRESS of the message's destination.
+ * @param DNET_list [in] List of our reachable downstream BACnet Network
+ * numbers. Normally just one valid entry; terminated with a -1 value.
+ * @param low_limit [in] Lowest Device instance of the range.
+ * @param high_limit [in] Highest Device instance of the range.
+ * @param cursor [in,out] Set to 0 on entry to start the search; on return
+ * it is the cursor for the next call, or -1 if there are no further
+ * matches.  The calling function should not alter or interpret it.
+ *
+ * @return True if a Device was found, and made the current Device.
+ */
+bool Routed_Device_GetNext_In_Range(
+    const BACNET_ADDRESS *dest,
+    const int *DNET_list,
+    uint32_t low_limit,
+    uint32_t high_limit,
+    int *cursor)
+{
+    const DEVICE_OBJECT_DATA *pDev;
+    bool broadcast = false;
+    uint16_t low, high, mid, i;
+    int pos = *cursor;
+
+    if (dest->net == BACNET_BROADCAST_NETWORK) {
+        broadcast = true;
+    } else if ((dest->net != 0) && (dest->net == DNET_list[0]) &&
+               (dest->len == 0)) {
+        broadcast = true;
+    }
+    if (!broadcast) {
+        /* at most a few Devices have the address */
+        while (Routed_Device_GetNext(dest, DNET_list, cursor)) {
+            pDev = &Devices[iCurrent_Device_Idx];
+            if ((pDev->bacObj.Object_Instance_Number >= low_limit) &&
+                (pDev->bacObj.Object_Instance_Number <= high_limit)) {
+                return true;
+            }
+        }
+        return false;
+    }
+    if ((pos < 0) || (pos >= Num_Managed_Devices)) {
+        *cursor = -1;
+        return false;
+    }
+    routed_device_index_update();
+    if (pos == 0) {
+        /* first Device at or above the low limit */
+        low = 0;
+        high = Num_Managed_Devices;
+        while (low < high) {
+            mid = low + ((high - low) / 2);
+            pDev = &Devices[Instance_Order[mid]];
+            if (pDev->bacObj.Object_Instance_Number < low_limit) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        pos = low;
+    }
+    while (pos < Num_Managed_Devices) {
+        i = Instance_Order[pos++];
+        if (Devices[i].bacObj.Object_Instance_Number > high_limit) {
+            break;
+        }
+        if ((i == 0) && (dest->net != BACNET_BROADCAST_NETWORK)) {
+            /* the gateway Device is not on the virtual network */
+            continue;
+        }
+        iCurrent_Device_Idx = i;
+        *cursor = (pos < Num_Managed_Devices) ? pos : -1;
+        return true;
+    }
+    *cursor = -1;
+
+    return false;
+}
+
 /** Check if the destination network is reachable - is it our virtual network,
  *  or local or else broadcast.
  *
@@ -357,13 +571,16 @@ uint32_t Routed_Device_Index_To_Instance(unsigned index)
  */
 static uint32_t Routed_Device_Instance_To_Index(uint32_t Instance_Number)
 {
-    int i;
+    uint16_t i;
 
-    for (i = 0; i < MAX_NUM_DEVICES; i++) {
+    routed_device_index_update();
+    i = Instance_Bucket[Instance_Number % MAX_NUM_DEVICES];
+    while (i != ROUTED_DEVICE_NONE) {
         if (Devices[i].bacObj.Object_Instance_Number == Instance_Number) {
             /* Found Instance, so return the Device Index Number */
             return i;
         }
+        i = Instance_Next[i];
     }
 
     /* We did not find instance... so simply return an Index of 0
@@ -524,6 +741,7 @@ bool Routed_Device_Set_Object_Instance_Number(uint32_t object_id)
     if (object_id <= BACNET_MAX_INSTANCE) {
         /* Make the change and update the database revision */
         Devices[iCurrent_Device_Idx].bacObj.Object_Instance_Number = object_id;
+        Routed_Device_Index_Stale = true;
         Routed_Device_Inc_Database_Revision();
     } else {
         status = false;
@@ -532,6 +750,23 @@ bool Routed_Device_Set_Object_Instance_Number(uint32_t object_id)
     return status;
 }
 
+/** Sets the BACnet address of a routed Device (or the gateway).
+ * Uses local variable iCurrent_Device_Idx to know which Device
+ * is to be updated.
+ * @param address [in] BACnet address of the Device.
+ * @return True if the address was set, else False.
+ */
+bool Routed_Device_Set_Address(const BACNET_ADDRESS *address)
+{
+    if (!address) {
+        return false;
+    }
+    bacnet_address_copy(&Devices[iCurrent_Device_Idx].bacDevAddr, address);
+    Routed_Device_Index_Stale = true;
+
+    return true;
+}
+
 /** Sets the Object Name for a routed Device (or the gateway).
  * Uses local variable iCurrent_Device_Idx to know which Device
  * is to be updated.
@@ -14,6 +14,7 @@
 /* BACnet Stack API */
 #include "bacnet/bacerror.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/object/device.h"
 #include "bacnet/rp.h"
 
 #ifdef __cplusplus
@@ -38,6 +39,8 @@ bool Integer_Value_Object_Name(
 BACNET_STACK_EXPORT
 bool Integer_Value_Name_Set(uint32_t object_instance, const char *new_name);
 BACNET_STACK_EXPORT
+unsigned Integer_Value_Changed_Callback_Set(object_changed_function cb);
+BACNET_STACK_EXPORT
 const char *Integer_Value_Name_ASCII(uint32_t object_instance);
 
 BACNET_STACK_EXPORT
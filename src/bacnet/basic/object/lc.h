@@ -15,6 +15,7 @@
 #include "bacnet/bacerror.h"
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/object/device.h"
 
 typedef struct shed_level_data {
     /* Represents the shed levels for the LEVEL choice of
@@ -115,6 +116,8 @@ uint32_t Load_Control_Create(uint32_t object_instance);
 BACNET_STACK_EXPORT
 bool Load_Control_Delete(uint32_t object_instance);
 BACNET_STACK_EXPORT
+unsigned Load_Control_Changed_Callback_Set(object_changed_function cb);
+BACNET_STACK_EXPORT
 void Load_Control_Cleanup(void);
 
 BACNET_STACK_EXPORT
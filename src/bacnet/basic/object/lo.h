@@ -15,6 +15,7 @@
 #include "bacnet/bacerror.h"
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/object/device.h"
 
 /**
  * @brief Callback for write present value request
@@ -184,6 +185,8 @@ uint32_t Lighting_Output_Create(uint32_t object_instance);
 BACNET_STACK_EXPORT
 bool Lighting_Output_Delete(uint32_t object_instance);
 BACNET_STACK_EXPORT
+unsigned Lighting_Output_Changed_Callback_Set(object_changed_function cb);
+BACNET_STACK_EXPORT
 void Lighting_Output_Cleanup(void);
 BACNET_STACK_EXPORT
 void Lighting_Output_Init(void);
@@ -15,6 +15,7 @@
 #include "bacnet/bacerror.h"
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/object/device.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -86,6 +87,8 @@ uint32_t Life_Safety_Point_Create(uint32_t object_instance);
 BACNET_STACK_EXPORT
 bool Life_Safety_Point_Delete(uint32_t object_instance);
 BACNET_STACK_EXPORT
+unsigned Life_Safety_Point_Changed_Callback_Set(object_changed_function cb);
+BACNET_STACK_EXPORT
 void Life_Safety_Point_Cleanup(void);
 BACNET_STACK_EXPORT
 void Life_Safety_Point_Init(void);
@@ -15,6 +15,7 @@
 #include "bacnet/bacerror.h"
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/object/device.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -99,6 +100,8 @@ uint32_t Life_Safety_Zone_Create(uint32_t object_instance);
 BACNET_STACK_EXPORT
 bool Life_Safety_Zone_Delete(uint32_t object_instance);
 BACNET_STACK_EXPORT
+unsigned Life_Safety_Zone_Changed_Callback_Set(object_changed_function cb);
+BACNET_STACK_EXPORT
 void Life_Safety_Zone_Cleanup(void);
 BACNET_STACK_EXPORT
 void Life_Safety_Zone_Init(void);
@@ -17,6 +17,7 @@
 #include "bacnet/cov.h"
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/object/device.h"
 
 /**
  * @brief Callback for gateway write present value request
@@ -122,6 +123,8 @@ uint32_t Multistate_Output_Create(uint32_t object_instance);
 BACNET_STACK_EXPORT
 bool Multistate_Output_Delete(uint32_t object_instance);
 BACNET_STACK_EXPORT
+unsigned Multistate_Output_Changed_Callback_Set(object_changed_function cb);
+BACNET_STACK_EXPORT
 void Multistate_Output_Cleanup(void);
 
 BACNET_STACK_EXPORT
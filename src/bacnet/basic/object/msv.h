@@ -16,6 +16,7 @@
 #include "bacnet/bacerror.h"
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/object/device.h"
 
 /**
  * @brief Callback for gateway write present value request
@@ -117,6 +118,8 @@ uint32_t Multistate_Value_Create(uint32_t object_instance);
 BACNET_STACK_EXPORT
 bool Multistate_Value_Delete(uint32_t object_instance);
 BACNET_STACK_EXPORT
+unsigned Multistate_Value_Changed_Callback_Set(object_changed_function cb);
+BACNET_STACK_EXPORT
 void Multistate_Value_Cleanup(void);
 
 BACNET_STACK_EXPORT
@@ -61,6 +61,8 @@ struct bacnet_ipv4_port {
     bool BBMD_Accept_FD_Registrations;
     void *BBMD_BD_Table;
     void *BBMD_FD_Table;
+    /* brings the time remaining of the FD-Table up to date */
+    network_port_table_update_function BBMD_FD_Table_Update;
     /* used for foreign device registration to remote BBMD */
     BACNET_HOST_N_PORT BBMD_Address;
     uint16_t BBMD_Lifetime;
@@ -123,6 +125,8 @@ struct object_data {
 #define BACNET_NETWORK_PORTS_MAX 1
 #endif
 static struct object_data Object_List[BACNET_NETWORK_PORTS_MAX];
+/* called when an object is renamed */
+static object_changed_function Object_Changed_Callback;
 
 /* These three arrays are used by the ReadPropertyMultiple handler */
 static const int Network_Port_Properties_Required[] = {
@@ -377,10 +381,27 @@ bool Network_Port_Name_Set(uint32_t object_instance, const char *new_name)
         Object_List[index].Object_Name = new_name;
         status = true;
     }
+    if (status && Object_Changed_Callback) {
+        Object_Changed_Callback(
+            OBJECT_NETWORK_PORT, object_instance, OBJECT_CHANGE_NAME);
+    }
 
     return status;
 }
 
+/**
+ * @brief Sets the function that is called when an object is
+ *  renamed, so that the Device object finds it by its new name
+ * @param  cb - function to call, or NULL to stop calling
+ * @return the OBJECT_CHANGE_x changes that are reported
+ */
+unsigned Network_Port_Changed_Callback_Set(object_changed_function cb)
+{
+    Object_Changed_Callback = cb;
+
+    return OBJECT_CHANGE_NAME;
+}
+
 /**
  * @brief For a given object instance-number, returns the ASCII object-name
  * @param  object_instance - object-instance number of the object
@@ -1707,7 +1728,7 @@ bool Network_Port_BBMD_BD_Table_Set(uint32_t object_instance, void *bdt_head)
 
 /**
  * For a given object instance-number, returns the BBMD-FD-Table head
- * property value
+ * property value, brought up to date by its update function
  *
  * @param  object_instance - object-instance number of the object
  *
@@ -1722,6 +1743,9 @@ void *Network_Port_BBMD_FD_Table(uint32_t object_instance)
     index = Network_Port_Instance_To_Index(object_instance);
     if (index < BACNET_NETWORK_PORTS_MAX) {
         ipv4 = &Object_List[index].Network.IPv4;
+        if (ipv4->BBMD_FD_Table_Update) {
+            ipv4->BBMD_FD_Table_Update();
+        }
         fdt_head = ipv4->BBMD_FD_Table;
     }
 
@@ -1756,6 +1780,31 @@ bool Network_Port_BBMD_FD_Table_Set(uint32_t object_instance, void *fdt_head)
     return status;
 }
 
+/**
+ * For a given object instance-number, sets the function that brings the
+ * BBMD-FD-Table up to date before it is encoded, such as the time
+ * remaining of each foreign device
+ *
+ * @param object_instance - object-instance number of the object
+ * @param update - function called before the FD-Table is read, or NULL
+ *
+ * @return true if the function was set
+ */
+bool Network_Port_BBMD_FD_Table_Update_Set(
+    uint32_t object_instance, network_port_table_update_function update)
+{
+    bool status = false;
+    unsigned index = 0;
+
+    index = Network_Port_Instance_To_Index(object_instance);
+    if (index < BACNET_NETWORK_PORTS_MAX) {
+        Object_List[index].Network.IPv4.BBMD_FD_Table_Update = update;
+        status = true;
+    }
+
+    return status;
+}
+
 /**
  * For a given object instance-number, loads the HostNPort into
  * BACNET_HOST_N_PORT.
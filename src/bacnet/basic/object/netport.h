@@ -16,6 +16,10 @@
 #include "bacnet/readrange.h"
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/object/device.h"
+
+/* brings a table of a Network Port up to date before it is read */
+typedef void (*network_port_table_update_function)(void);
 
 #ifdef __cplusplus
 extern "C" {
@@ -37,6 +41,8 @@ bool Network_Port_Object_Name(
 BACNET_STACK_EXPORT
 bool Network_Port_Name_Set(uint32_t object_instance, const char *new_name);
 BACNET_STACK_EXPORT
+unsigned Network_Port_Changed_Callback_Set(object_changed_function cb);
+BACNET_STACK_EXPORT
 const char *Network_Port_Object_Name_ASCII(uint32_t object_instance);
 
 BACNET_STACK_EXPORT
@@ -196,6 +202,9 @@ BACNET_STACK_EXPORT
 void *Network_Port_BBMD_FD_Table(uint32_t object_instance);
 BACNET_STACK_EXPORT
 bool Network_Port_BBMD_FD_Table_Set(uint32_t object_instance, void *fdt_head);
+BACNET_STACK_EXPORT
+bool Network_Port_BBMD_FD_Table_Update_Set(
+    uint32_t object_instance, network_port_table_update_function update);
 
 BACNET_STACK_EXPORT
 bool Network_Port_Remote_BBMD_IP_Address(
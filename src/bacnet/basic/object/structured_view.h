@@ -16,6 +16,7 @@
 #include "bacnet/bacstr.h"
 #include "bacnet/bacdevobjpropref.h"
 #include "bacnet/rp.h"
+#include "bacnet/basic/object/device.h"
 
 struct BACnetSubordinateData;
 typedef struct BACnetSubordinateData {
@@ -117,6 +118,8 @@ BACNET_STACK_EXPORT
 uint32_t Structured_View_Create(uint32_t object_instance);
 BACNET_STACK_EXPORT
 bool Structured_View_Delete(uint32_t object_instance);
+BACNET_STACK_EXPORT
+unsigned Structured_View_Changed_Callback_Set(object_changed_function cb);
 
 BACNET_STACK_EXPORT
 void Structured_View_Cleanup(void);
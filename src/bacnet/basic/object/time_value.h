@@ -16,6 +16,7 @@
 #include "bacnet/bacerror.h"
 #include "bacnet/rp.h"
 #include "bacnet/wp.h"
+#include "bacnet/basic/object/device.h"
 
 /**
  * @brief Callback for gateway write present value request
@@ -48,6 +49,8 @@ bool Time_Value_Object_Name(
 BACNET_STACK_EXPORT
 bool Time_Value_Name_Set(uint32_t object_instance, const char *new_name);
 BACNET_STACK_EXPORT
+unsigned Time_Value_Changed_Callback_Set(object_changed_function cb);
+BACNET_STACK_EXPORT
 const char *Time_Value_Name_ASCII(uint32_t object_instance);
 
 BACNET_STACK_EXPORT
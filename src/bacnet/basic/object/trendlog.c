@@ -7,6 +7,7 @@
  */
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 /* BACnet Stack defines - first */
 #include "bacnet/bacdef.h"
@@ -32,6 +33,8 @@
 #define MAX_TREND_LOGS 8
 #endif
 
+/* default log buffers, used until a log is given a larger buffer
+   from the heap or a buffer in storage */
 static TL_DATA_REC Logs[MAX_TREND_LOGS][TL_MAX_ENTRIES];
 static TL_LOG_INFO LogInfo[MAX_TREND_LOGS];
 
@@ -180,6 +183,9 @@ void Trend_Log_Init(void)
             month = iLog + 1;
             datetime_set_values(&bdatetime, 2009, month, 1, 0, 0, 0, 0);
             tClock = datetime_seconds_since_epoch(&bdatetime);
+            LogInfo[iLog].pRecords = &Logs[iLog][0];
+            LogInfo[iLog].ulBufferSize = TL_MAX_ENTRIES;
+            LogInfo[iLog].Commit = NULL;
             for (iEntry = 0; iEntry < TL_MAX_ENTRIES; iEntry++) {
                 Logs[iLog][iEntry].tTimeStamp = tClock;
                 Logs[iLog][iEntry].ucRecType = TL_TYPE_REAL;
@@ -231,6 +237,174 @@ void Trend_Log_Init(void)
     return;
 }
 
+/**
+ * @brief Release the log buffer of a Trend Log if it was taken from the
+ *  heap, and go back to the default log buffer, empty
+ * @param iLog - index of the Trend Log
+ */
+static void TL_Buffer_Default(int iLog)
+{
+    TL_LOG_INFO *CurrentLog = &LogInfo[iLog];
+
+    if (!CurrentLog->Commit && CurrentLog->pRecords &&
+        (CurrentLog->pRecords != &Logs[iLog][0])) {
+        free(CurrentLog->pRecords);
+    }
+    CurrentLog->pRecords = &Logs[iLog][0];
+    CurrentLog->ulBufferSize = TL_MAX_ENTRIES;
+    CurrentLog->Commit = NULL;
+    CurrentLog->ulRecordCount = 0;
+    CurrentLog->iIndex = 0;
+}
+
+/**
+ * @brief Get the Buffer_Size of a Trend Log
+ * @param object_instance - object-instance number of the object
+ * @return number of records the log buffer can hold
+ */
+uint32_t Trend_Log_Buffer_Size(uint32_t object_instance)
+{
+    unsigned index = Trend_Log_Instance_To_Index(object_instance);
+
+    if (index < MAX_TREND_LOGS) {
+        return LogInfo[index].ulBufferSize;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Set the Buffer_Size of a Trend Log that keeps its log buffer in
+ *  RAM. A buffer larger than TL_MAX_ENTRIES is taken from the heap.
+ *  The records in the log buffer are purged.
+ * @param object_instance - object-instance number of the object
+ * @param buffer_size - number of records the log buffer can hold
+ * @return true if the log buffer was resized
+ */
+bool Trend_Log_Buffer_Size_Set(uint32_t object_instance, uint32_t buffer_size)
+{
+    unsigned index = Trend_Log_Instance_To_Index(object_instance);
+    TL_DATA_REC *pRecords = NULL;
+
+    if ((index >= MAX_TREND_LOGS) || (buffer_size == 0) ||
+        LogInfo[index].Commit) {
+        /* a log buffer in storage is resized by the storage */
+        return false;
+    }
+    if (buffer_size > TL_MAX_ENTRIES) {
+        pRecords = calloc(buffer_size, sizeof(TL_DATA_REC));
+        if (!pRecords) {
+            return false;
+        }
+    }
+    TL_Buffer_Default(index);
+    if (pRecords) {
+        LogInfo[index].pRecords = pRecords;
+    }
+    LogInfo[index].ulBufferSize = buffer_size;
+    TL_Insert_Status_Rec(index, LOG_STATUS_BUFFER_PURGED, true);
+
+    return true;
+}
+
+/**
+ * @brief Keep the log buffer of a Trend Log in storage, such as in a
+ *  memory-mapped file, so that the records are read in place by ReadRange
+ *  and survive a restart.
+ * @param object_instance - object-instance number of the object
+ * @param storage - the log buffer and the position of its records,
+ *  or NULL to go back to the default log buffer
+ * @param commit - called after each record is added, to save the position
+ * @return true if the storage is used for the log buffer
+ */
+bool Trend_Log_Storage_Set(
+    uint32_t object_instance,
+    const TL_STORAGE *storage,
+    trend_log_commit_function commit)
+{
+    unsigned index = Trend_Log_Instance_To_Index(object_instance);
+    TL_LOG_INFO *CurrentLog;
+
+    if (index >= MAX_TREND_LOGS) {
+        return false;
+    }
+    if (storage) {
+        if (!storage->pRecords || (storage->ulBufferSize == 0) ||
+            (storage->ulIndex >= storage->ulBufferSize) ||
+            (storage->ulRecordCount > storage->ulBufferSize)) {
+            return false;
+        }
+    }
+    TL_Buffer_Default(index);
+    if (storage) {
+        CurrentLog = &LogInfo[index];
+        CurrentLog->pRecords = storage->pRecords;
+        CurrentLog->ulBufferSize = storage->ulBufferSize;
+        CurrentLog->iIndex = (int)storage->ulIndex;
+        CurrentLog->ulRecordCount = storage->ulRecordCount;
+        CurrentLog->ulTotalRecordCount = storage->ulTotalRecordCount;
+        CurrentLog->Commit = commit;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Get a record of the log buffer of a Trend Log, in place
+ * @param iLog - index of the Trend Log
+ * @param uiEntry - BACnet 1 based position of the record, oldest first
+ * @return the record
+ */
+static TL_DATA_REC *TL_Record(int iLog, uint32_t uiEntry)
+{
+    TL_LOG_INFO *CurrentLog = &LogInfo[iLog];
+    uint32_t uiOldest;
+
+    /* The oldest record is Record_Count records behind the insertion
+     * point. Convert from BACnet 1 based to 0 based array index and then
+     * handle wrap around of the circular buffer */
+    uiOldest = (uint32_t)CurrentLog->iIndex + CurrentLog->ulBufferSize -
+        CurrentLog->ulRecordCount;
+
+    return &CurrentLog
+                ->pRecords[(uiOldest + uiEntry - 1) % CurrentLog->ulBufferSize];
+}
+
+/**
+ * @brief Add a record to the log buffer of a Trend Log, pushing out the
+ *  oldest record when the log buffer is full. A log buffer in storage
+ *  first commits one record less, so that the oldest record is no longer
+ *  part of the log buffer when its slot is overwritten.
+ * @param iLog - index of the Trend Log
+ * @param pRecord - record to add
+ */
+static void TL_Insert_Record(int iLog, const TL_DATA_REC *pRecord)
+{
+    TL_LOG_INFO *CurrentLog = &LogInfo[iLog];
+
+    if (CurrentLog->Commit &&
+        (CurrentLog->ulRecordCount >= CurrentLog->ulBufferSize)) {
+        CurrentLog->Commit(
+            Trend_Log_Index_To_Instance(iLog), (uint32_t)CurrentLog->iIndex,
+            CurrentLog->ulBufferSize - 1, CurrentLog->ulTotalRecordCount);
+    }
+    CurrentLog->pRecords[CurrentLog->iIndex++] = *pRecord;
+    if ((uint32_t)CurrentLog->iIndex >= CurrentLog->ulBufferSize) {
+        CurrentLog->iIndex = 0;
+    }
+
+    CurrentLog->ulTotalRecordCount++;
+
+    if (CurrentLog->ulRecordCount < CurrentLog->ulBufferSize) {
+        CurrentLog->ulRecordCount++;
+    }
+    if (CurrentLog->Commit) {
+        CurrentLog->Commit(
+            Trend_Log_Index_To_Instance(iLog), (uint32_t)CurrentLog->iIndex,
+            CurrentLog->ulRecordCount, CurrentLog->ulTotalRecordCount);
+    }
+}
+
 /*
  * Note: we use the instance number here and build the name based
  * on the assumption that there is a 1 to 1 correspondence. If there
@@ -298,7 +472,8 @@ int Trend_Log_Read_Property(BACNET_READ_PROPERTY_DATA *rpdata)
             break;
 
         case PROP_BUFFER_SIZE:
-            apdu_len = encode_application_unsigned(&apdu[0], TL_MAX_ENTRIES);
+            apdu_len = encode_application_unsigned(
+                &apdu[0], CurrentLog->ulBufferSize);
             break;
 
         case PROP_LOG_BUFFER:
@@ -458,7 +633,7 @@ bool Trend_Log_Write_Property(BACNET_WRITE_PROPERTY_DATA *wp_data)
                  * set */
                 if ((CurrentLog->bEnable == false) &&
                     (CurrentLog->bStopWhenFull == true) &&
-                    (CurrentLog->ulRecordCount == TL_MAX_ENTRIES) &&
+                    (CurrentLog->ulRecordCount == CurrentLog->ulBufferSize) &&
                     (value.type.Boolean == true)) {
                     status = false;
                     wp_data->error_class = ERROR_CLASS_OBJECT;
@@ -501,7 +676,8 @@ bool Trend_Log_Write_Property(BACNET_WRITE_PROPERTY_DATA *wp_data)
                     CurrentLog->bStopWhenFull = value.type.Boolean;
 
                     if ((value.type.Boolean == true) &&
-                        (CurrentLog->ulRecordCount == TL_MAX_ENTRIES) &&
+                        (CurrentLog->ulRecordCount ==
+                         CurrentLog->ulBufferSize) &&
                         (CurrentLog->bEnable == true)) {
                         /* When full log is switched from normal to stop when
                          * full disable the log and record the fact - see
@@ -516,12 +692,25 @@ bool Trend_Log_Write_Property(BACNET_WRITE_PROPERTY_DATA *wp_data)
             break;
 
         case PROP_BUFFER_SIZE:
-            /* Fixed size buffer so deny write. If buffer size was writable
-             * we would probably erase the current log, resize, re-initalise
-             * and carry on - however write is not allowed if enable is true.
+            /* Resizing erases the current log, and is not allowed
+             * if enable is true.
              */
-            wp_data->error_class = ERROR_CLASS_PROPERTY;
-            wp_data->error_code = ERROR_CODE_WRITE_ACCESS_DENIED;
+            status = write_property_type_valid(
+                wp_data, &value, BACNET_APPLICATION_TAG_UNSIGNED_INT);
+            if (status) {
+                if (CurrentLog->bEnable || CurrentLog->Commit ||
+                    (value.type.Unsigned_Int > UINT32_MAX)) {
+                    status = false;
+                    wp_data->error_class = ERROR_CLASS_PROPERTY;
+                    wp_data->error_code = ERROR_CODE_WRITE_ACCESS_DENIED;
+                } else if (!Trend_Log_Buffer_Size_Set(
+                               wp_data->object_instance,
+                               (uint32_t)value.type.Unsigned_Int)) {
+                    status = false;
+                    wp_data->error_class = ERROR_CLASS_RESOURCES;
+                    wp_data->error_code = ERROR_CODE_NO_SPACE_TO_WRITE_PROPERTY;
+                }
+            }
             break;
 
         case PROP_RECORD_COUNT:
@@ -814,11 +1003,8 @@ bool TrendLogGetRRInfo(
 
 void TL_Insert_Status_Rec(int iLog, BACNET_LOG_STATUS eStatus, bool bState)
 {
-    TL_LOG_INFO *CurrentLog;
     TL_DATA_REC TempRec;
 
-    CurrentLog = &LogInfo[iLog];
-
     TempRec.tTimeStamp = Trend_Log_Epoch_Seconds_Now();
     TempRec.ucRecType = TL_TYPE_STATUS;
     TempRec.ucStatus = 0;
@@ -843,16 +1029,7 @@ void TL_Insert_Status_Rec(int iLog, BACNET_LOG_STATUS eStatus, bool bState)
             break;
     }
 
-    Logs[iLog][CurrentLog->iIndex++] = TempRec;
-    if (CurrentLog->iIndex >= TL_MAX_ENTRIES) {
-        CurrentLog->iIndex = 0;
-    }
-
-    CurrentLog->ulTotalRecordCount++;
-
-    if (CurrentLog->ulRecordCount < TL_MAX_ENTRIES) {
-        CurrentLog->ulRecordCount++;
-    }
+    TL_Insert_Record(iLog, &TempRec);
 }
 
 /*****************************************************************************
@@ -957,6 +1134,99 @@ void TL_Local_Time_To_BAC(BACNET_DATE_TIME *bdatetime, bacnet_time_t seconds)
 
 #define TL_MAX_ENC 23 /* Maximum size of encoded log entry, see above */
 
+/**
+ * @brief Find the first record of a Trend Log with a timestamp after, or
+ *  at or after, the reference time. The records are added in timestamp
+ *  order, so the ring is bisected in its oldest first order rather than
+ *  scanned record by record.
+ * @param iLog - index of the Trend Log
+ * @param tRefTime - reference time in local format
+ * @param bAfter - true to pass over the records at the reference time
+ * @return BACnet 1 based position of the record, or one past the newest
+ *  record if there is none
+ */
+static uint32_t TL_Search_Time(int iLog, bacnet_time_t tRefTime, bool bAfter)
+{
+    uint32_t uiLow = 1;
+    uint32_t uiHigh = LogInfo[iLog].ulRecordCount + 1;
+    uint32_t uiMiddle = 0;
+    bacnet_time_t tStamp = 0;
+
+    while (uiLow < uiHigh) {
+        uiMiddle = uiLow + ((uiHigh - uiLow) / 2);
+        tStamp = TL_Record(iLog, uiMiddle)->tTimeStamp;
+        if ((tStamp < tRefTime) || (bAfter && (tStamp == tRefTime))) {
+            uiLow = uiMiddle + 1;
+        } else {
+            uiHigh = uiMiddle;
+        }
+    }
+
+    return uiLow;
+}
+
+/**
+ * @brief Encode the records of a Trend Log, oldest first, until the count
+ *  is met, the end of the log is reached, or there is no more space, and
+ *  set the result flags and item count of the request.
+ * @param apdu - buffer for the encoded records
+ * @param pRequest - ReadRange request being answered
+ * @param iLog - index of the Trend Log
+ * @param uiIndex - BACnet 1 based position of the first record to encode,
+ *  within the log
+ * @param uiCount - number of records requested
+ * @return number of bytes encoded
+ */
+static int TL_encode_entries(
+    uint8_t *apdu,
+    BACNET_READ_RANGE_DATA *pRequest,
+    int iLog,
+    uint32_t uiIndex,
+    uint32_t uiCount)
+{
+    TL_LOG_INFO *CurrentLog = &LogInfo[iLog];
+    int iLen = 0;
+    int iTemp = 0;
+    uint32_t uiLast = 0; /* Entry number we finished encoding on */
+    uint32_t uiTarget = 0; /* Last entry we are required to encode */
+    uint32_t uiRemaining = 0; /* Amount of unused space in packet */
+
+    /* See how much space we have */
+    uiRemaining = rr_ack_apdu_max(pRequest) - pRequest->Overhead;
+    /* Index of last required entry, capped at end of list if necessary */
+    uiTarget = CurrentLog->ulRecordCount;
+    if (uiCount < (uiTarget - uiIndex + 1)) {
+        uiTarget = uiIndex + uiCount - 1;
+    }
+    if (uiIndex == 1) {
+        bitstring_set_bit(&pRequest->ResultFlags, RESULT_FLAG_FIRST_ITEM, true);
+    }
+    while (uiIndex <= uiTarget) {
+        if (uiRemaining < TL_MAX_ENC) {
+            /*
+             * Can't fit any more in! We just set the result flag to say there
+             * was more and drop out of the loop early
+             */
+            bitstring_set_bit(
+                &pRequest->ResultFlags, RESULT_FLAG_MORE_ITEMS, true);
+            break;
+        }
+
+        iTemp = TL_encode_entry(&apdu[iLen], iLog, uiIndex);
+
+        uiRemaining -= iTemp; /* Reduce the remaining space */
+        iLen += iTemp; /* and increase the length consumed */
+        uiLast = uiIndex; /* Record the last entry encoded */
+        uiIndex++; /* and get ready for next one */
+        pRequest->ItemCount++; /* Chalk up another one for the response count */
+    }
+    if (uiLast == CurrentLog->ulRecordCount) {
+        bitstring_set_bit(&pRequest->ResultFlags, RESULT_FLAG_LAST_ITEM, true);
+    }
+
+    return iLen;
+}
+
 int rr_trend_log_encode(uint8_t *apdu, BACNET_READ_RANGE_DATA *pRequest)
 {
     /* Initialise result flags to all false */
@@ -991,18 +1261,9 @@ int rr_trend_log_encode(uint8_t *apdu, BACNET_READ_RANGE_DATA *pRequest)
 int TL_encode_by_position(uint8_t *apdu, BACNET_READ_RANGE_DATA *pRequest)
 {
     int log_index = 0;
-    int iLen = 0;
     int32_t iTemp = 0;
     TL_LOG_INFO *CurrentLog = NULL;
 
-    uint32_t uiIndex = 0; /* Current entry number */
-    uint32_t uiFirst = 0; /* Entry number we started encoding from */
-    uint32_t uiLast = 0; /* Entry number we finished encoding on */
-    uint32_t uiTarget = 0; /* Last entry we are required to encode */
-    uint32_t uiRemaining = 0; /* Amount of unused space in packet */
-
-    /* See how much space we have */
-    uiRemaining = MAX_APDU - pRequest->Overhead;
     log_index = Trend_Log_Instance_To_Index(pRequest->object_instance);
     CurrentLog = &LogInfo[log_index];
     if (pRequest->RequestType == RR_READ_ALL) {
@@ -1045,51 +1306,15 @@ int TL_encode_by_position(uint8_t *apdu, BACNET_READ_RANGE_DATA *pRequest)
 
     /* From here on in we only have a starting point and a positive count */
 
-    if (pRequest->Range.RefIndex >
-        CurrentLog->ulRecordCount) { /* Nothing to return as we are past the end
-                                      of the list */
+    if ((pRequest->Range.RefIndex == 0) ||
+        (pRequest->Range.RefIndex > CurrentLog->ulRecordCount)) {
+        /* Nothing to return as we are outside of the list */
         return (0);
     }
 
-    uiTarget = pRequest->Range.RefIndex + pRequest->Count -
-        1; /* Index of last required entry */
-    if (uiTarget >
-        CurrentLog->ulRecordCount) { /* Capped at end of list if necessary */
-        uiTarget = CurrentLog->ulRecordCount;
-    }
-
-    uiIndex = pRequest->Range.RefIndex;
-    uiFirst = uiIndex; /* Record where we started from */
-    while (uiIndex <= uiTarget) {
-        if (uiRemaining < TL_MAX_ENC) {
-            /*
-             * Can't fit any more in! We just set the result flag to say there
-             * was more and drop out of the loop early
-             */
-            bitstring_set_bit(
-                &pRequest->ResultFlags, RESULT_FLAG_MORE_ITEMS, true);
-            break;
-        }
-
-        iTemp = TL_encode_entry(&apdu[iLen], log_index, uiIndex);
-
-        uiRemaining -= iTemp; /* Reduce the remaining space */
-        iLen += iTemp; /* and increase the length consumed */
-        uiLast = uiIndex; /* Record the last entry encoded */
-        uiIndex++; /* and get ready for next one */
-        pRequest->ItemCount++; /* Chalk up another one for the response count */
-    }
-
-    /* Set remaining result flags if necessary */
-    if (uiFirst == 1) {
-        bitstring_set_bit(&pRequest->ResultFlags, RESULT_FLAG_FIRST_ITEM, true);
-    }
-
-    if (uiLast == CurrentLog->ulRecordCount) {
-        bitstring_set_bit(&pRequest->ResultFlags, RESULT_FLAG_LAST_ITEM, true);
-    }
-
-    return (iLen);
+    return TL_encode_entries(
+        apdu, pRequest, log_index, pRequest->Range.RefIndex,
+        (uint32_t)pRequest->Count);
 }
 
 /****************************************************************************
@@ -1102,15 +1327,8 @@ int TL_encode_by_position(uint8_t *apdu, BACNET_READ_RANGE_DATA *pRequest)
 int TL_encode_by_sequence(uint8_t *apdu, BACNET_READ_RANGE_DATA *pRequest)
 {
     int log_index = 0;
-    int iLen = 0;
-    int32_t iTemp = 0;
     TL_LOG_INFO *CurrentLog = NULL;
 
-    uint32_t uiIndex = 0; /* Current entry number */
-    uint32_t uiFirst = 0; /* Entry number we started encoding from */
-    uint32_t uiLast = 0; /* Entry number we finished encoding on */
-    uint32_t uiSequence = 0; /* Tracking sequence number when encoding */
-    uint32_t uiRemaining = 0; /* Amount of unused space in packet */
     uint32_t uiFirstSeq = 0; /* Sequence number for 1st record in log */
 
     uint32_t uiBegin = 0; /* Starting Sequence number for request */
@@ -1120,8 +1338,6 @@ int TL_encode_by_sequence(uint8_t *apdu, BACNET_READ_RANGE_DATA *pRequest)
     bool bWrapLog =
         false; /* Has log sequence range spanned the max for uint32_t? */
 
-    /* See how much space we have */
-    uiRemaining = MAX_APDU - pRequest->Overhead;
     log_index = Trend_Log_Instance_To_Index(pRequest->object_instance);
     CurrentLog = &LogInfo[log_index];
     /* Figure out the sequence number for the first record, last is
@@ -1206,42 +1422,11 @@ int TL_encode_by_sequence(uint8_t *apdu, BACNET_READ_RANGE_DATA *pRequest)
     /* We now have a range that lies completely within the log buffer
      * and we need to figure out where that starts in the buffer.
      */
-    uiIndex = uiBegin - uiFirstSeq + 1;
-    uiSequence = uiBegin;
-    uiFirst = uiIndex; /* Record where we started from */
-    while (uiSequence != uiEnd + 1) {
-        if (uiRemaining < TL_MAX_ENC) {
-            /*
-             * Can't fit any more in! We just set the result flag to say there
-             * was more and drop out of the loop early
-             */
-            bitstring_set_bit(
-                &pRequest->ResultFlags, RESULT_FLAG_MORE_ITEMS, true);
-            break;
-        }
-
-        iTemp = TL_encode_entry(&apdu[iLen], log_index, uiIndex);
-
-        uiRemaining -= iTemp; /* Reduce the remaining space */
-        iLen += iTemp; /* and increase the length consumed */
-        uiLast = uiIndex; /* Record the last entry encoded */
-        uiIndex++; /* and get ready for next one */
-        uiSequence++;
-        pRequest->ItemCount++; /* Chalk up another one for the response count */
-    }
-
-    /* Set remaining result flags if necessary */
-    if (uiFirst == 1) {
-        bitstring_set_bit(&pRequest->ResultFlags, RESULT_FLAG_FIRST_ITEM, true);
-    }
-
-    if (uiLast == CurrentLog->ulRecordCount) {
-        bitstring_set_bit(&pRequest->ResultFlags, RESULT_FLAG_LAST_ITEM, true);
-    }
-
     pRequest->FirstSequence = uiBegin;
 
-    return (iLen);
+    return TL_encode_entries(
+        apdu, pRequest, log_index, uiBegin - uiFirstSeq + 1,
+        uiEnd - uiBegin + 1);
 }
 
 /****************************************************************************
@@ -1254,139 +1439,51 @@ int TL_encode_by_sequence(uint8_t *apdu, BACNET_READ_RANGE_DATA *pRequest)
 int TL_encode_by_time(uint8_t *apdu, BACNET_READ_RANGE_DATA *pRequest)
 {
     int log_index = 0;
-    int iLen = 0;
-    int32_t iTemp = 0;
-    int iCount = 0;
     TL_LOG_INFO *CurrentLog = NULL;
 
-    uint32_t uiIndex = 0; /* Current entry number */
-    uint32_t uiFirst = 0; /* Entry number we started encoding from */
-    uint32_t uiLast = 0; /* Entry number we finished encoding on */
-    uint32_t uiRemaining = 0; /* Amount of unused space in packet */
-    uint32_t uiFirstSeq = 0; /* Sequence number for 1st record in log */
+    uint32_t uiIndex = 0; /* Entry number we start encoding from */
+    uint32_t uiCount = 0; /* Number of entries to encode */
     bacnet_time_t tRefTime = 0; /* The time from the request in local format */
 
-    /* See how much space we have */
-    uiRemaining = MAX_APDU - pRequest->Overhead;
     log_index = Trend_Log_Instance_To_Index(pRequest->object_instance);
     CurrentLog = &LogInfo[log_index];
 
     tRefTime = TL_BAC_Time_To_Local(&pRequest->Range.RefTime);
-    /* Find correct position for oldest entry in log */
-    if (CurrentLog->ulRecordCount < TL_MAX_ENTRIES) {
-        uiIndex = 0;
-    } else {
-        uiIndex = CurrentLog->iIndex;
-    }
 
     if (pRequest->Count < 0) {
-        /* Start at end of log and look for record which has
-         * timestamp greater than or equal to the reference.
+        /* The last record with a timestamp before the reference
+         * is the end point for our request.
          */
-        iCount = CurrentLog->ulRecordCount - 1;
-        /* Start out with the sequence number for the last record */
-        uiFirstSeq = CurrentLog->ulTotalRecordCount;
-        for (;;) {
-            if (Logs[pRequest->object_instance]
-                    [(uiIndex + iCount) % TL_MAX_ENTRIES]
-                        .tTimeStamp < tRefTime) {
-                break;
-            }
-
-            uiFirstSeq--;
-            iCount--;
-            if (iCount < 0) {
-                return (0);
-            }
+        uiIndex = TL_Search_Time(log_index, tRefTime, false) - 1;
+        if (uiIndex == 0) {
+            return (0);
         }
-
-        /* We have an and point for our request,
-         * now work backwards to find where we should start from
-         */
-
-        pRequest->Count = -pRequest->Count; /* Conveert to +ve count */
         /* If count would bring us back beyond the limits
-         * Of the buffer then pin it to the start of the buffer
-         * otherwise adjust starting point and sequence number
-         * appropriately.
+         * of the buffer then pin it to the start of the buffer
+         * otherwise adjust the starting point appropriately.
          */
-        iTemp = pRequest->Count - 1;
-        if (iTemp > iCount) {
-            uiFirstSeq -= iCount;
-            pRequest->Count = iCount + 1;
-            iCount = 0;
-        } else {
-            uiFirstSeq -= iTemp;
-            iCount -= iTemp;
+        uiCount = 0U - (uint32_t)pRequest->Count;
+        if (uiCount > uiIndex) {
+            uiCount = uiIndex;
         }
+        uiIndex = uiIndex - uiCount + 1;
+        pRequest->Count = (int32_t)uiCount; /* Convert to +ve count */
     } else {
-        /* Start at beginning of log and look for 1st record which has
-         * timestamp greater than the reference time.
+        /* The 1st record with a timestamp after the reference
+         * is the starting point for our request.
          */
-        iCount = 0;
-        /* Figure out the sequence number for the first record, last is
-         * ulTotalRecordCount */
-        uiFirstSeq =
-            CurrentLog->ulTotalRecordCount - (CurrentLog->ulRecordCount - 1);
-        for (;;) {
-            if (Logs[pRequest->object_instance]
-                    [(uiIndex + iCount) % TL_MAX_ENTRIES]
-                        .tTimeStamp > tRefTime) {
-                break;
-            }
-
-            uiFirstSeq++;
-            iCount++;
-            if ((uint32_t)iCount == CurrentLog->ulRecordCount) {
-                return (0);
-            }
+        uiIndex = TL_Search_Time(log_index, tRefTime, true);
+        if (uiIndex > CurrentLog->ulRecordCount) {
+            return (0);
         }
+        uiCount = (uint32_t)pRequest->Count;
     }
 
     /* We now have a starting point for the operation and a +ve count */
+    pRequest->FirstSequence = CurrentLog->ulTotalRecordCount -
+        (CurrentLog->ulRecordCount - uiIndex);
 
-    uiIndex = iCount + 1; /* Convert to BACnet 1 based reference */
-    uiFirst = uiIndex; /* Record where we started from */
-    iCount = pRequest->Count;
-    while (iCount != 0) {
-        if (uiRemaining < TL_MAX_ENC) {
-            /*
-             * Can't fit any more in! We just set the result flag to say there
-             * was more and drop out of the loop early
-             */
-            bitstring_set_bit(
-                &pRequest->ResultFlags, RESULT_FLAG_MORE_ITEMS, true);
-            break;
-        }
-
-        iTemp = TL_encode_entry(&apdu[iLen], log_index, uiIndex);
-
-        uiRemaining -= iTemp; /* Reduce the remaining space */
-        iLen += iTemp; /* and increase the length consumed */
-        uiLast = uiIndex; /* Record the last entry encoded */
-        uiIndex++; /* and get ready for next one */
-        pRequest->ItemCount++; /* Chalk up another one for the response count */
-        iCount--; /* And finally cross another one off the requested count */
-
-        if (uiIndex >
-            CurrentLog
-                ->ulRecordCount) { /* Finish up if we hit the end of the log */
-            break;
-        }
-    }
-
-    /* Set remaining result flags if necessary */
-    if (uiFirst == 1) {
-        bitstring_set_bit(&pRequest->ResultFlags, RESULT_FLAG_FIRST_ITEM, true);
-    }
-
-    if (uiLast == CurrentLog->ulRecordCount) {
-        bitstring_set_bit(&pRequest->ResultFlags, RESULT_FLAG_LAST_ITEM, true);
-    }
-
-    pRequest->FirstSequence = uiFirstSeq;
-
-    return (iLen);
+    return TL_encode_entries(apdu, pRequest, log_index, uiIndex, uiCount);
 }
 
 int TL_encode_entry(uint8_t *apdu, int iLog, int iEntry)
@@ -1397,15 +1494,8 @@ int TL_encode_entry(uint8_t *apdu, int iLog, int iEntry)
     uint8_t ucCount = 0;
     BACNET_DATE_TIME TempTime;
 
-    /* Convert from BACnet 1 based to 0 based array index and then
-     * handle wrap around of the circular buffer */
-
-    if (LogInfo[iLog].ulRecordCount < TL_MAX_ENTRIES) {
-        pSource = &Logs[iLog][(iEntry - 1) % TL_MAX_ENTRIES];
-    } else {
-        pSource =
-            &Logs[iLog][(LogInfo[iLog].iIndex + iEntry - 1) % TL_MAX_ENTRIES];
-    }
+    /* The record is encoded in place from the log buffer */
+    pSource = TL_Record(iLog, iEntry);
 
     iLen = 0;
     /* First stick the time stamp in with tag [0] */
@@ -1667,16 +1757,7 @@ static void TL_fetch_property(int iLog)
         TempRec.ucStatus = 128 | bitstring_octet(&TempBits, 0);
     }
 
-    Logs[iLog][CurrentLog->iIndex++] = TempRec;
-    if (CurrentLog->iIndex >= TL_MAX_ENTRIES) {
-        CurrentLog->iIndex = 0;
-    }
-
-    CurrentLog->ulTotalRecordCount++;
-
-    if (CurrentLog->ulRecordCount < TL_MAX_ENTRIES) {
-        CurrentLog->ulRecordCount++;
-    }
+    TL_Insert_Record(iLog, &TempRec);
 }
 
 /****************************************************************************
@@ -67,7 +67,36 @@ typedef struct tl_data_record {
 #define TL_T_START_WILD 1 /* Start time is wild carded */
 #define TL_T_STOP_WILD 2 /* Stop Time is wild carded */
 
-#define TL_MAX_ENTRIES 1000 /* Entries per datalog */
+/* Entries per datalog in the default RAM buffer */
+#ifndef TL_MAX_ENTRIES
+#define TL_MAX_ENTRIES 1000
+#endif
+
+/**
+ * @brief Called after a record was added to the log buffer of a Trend Log,
+ *  and before the oldest record of a full log buffer is overwritten, so
+ *  that a persistent log buffer can save where its records are. The oldest
+ *  record is record_count records behind the insertion point.
+ * @param object_instance - object-instance number of the Trend Log
+ * @param index - insertion point, the position of the next record
+ * @param record_count - number of records in the log buffer
+ * @param total_record_count - number of records ever added
+ */
+typedef void (*trend_log_commit_function)(
+    uint32_t object_instance,
+    uint32_t index,
+    uint32_t record_count,
+    uint32_t total_record_count);
+
+/* Log buffer of a Trend Log that is kept outside of this module, such as
+   in a memory-mapped file, and the position of its records */
+typedef struct tl_storage {
+    TL_DATA_REC *pRecords; /* Ring of ulBufferSize records */
+    uint32_t ulBufferSize;
+    uint32_t ulIndex; /* Current insertion point */
+    uint32_t ulRecordCount;
+    uint32_t ulTotalRecordCount;
+} TL_STORAGE;
 
 /* Structure containing config and status info for a Trend Log */
 
@@ -92,6 +121,10 @@ typedef struct tl_log_info {
     bool bTrigger; /* Set to 1 to cause a reading to be taken */
     int iIndex; /* Current insertion point */
     bacnet_time_t tLastDataTime;
+    TL_DATA_REC *pRecords; /* Ring of records of the log buffer */
+    uint32_t ulBufferSize; /* Number of records in the ring */
+    /* Saves the position of the records of a log buffer in storage */
+    trend_log_commit_function Commit;
 } TL_LOG_INFO;
 
 /*
@@ -139,6 +172,16 @@ bool Trend_Log_Write_Property(BACNET_WRITE_PROPERTY_DATA *wp_data);
 BACNET_STACK_EXPORT
 void Trend_Log_Init(void);
 
+BACNET_STACK_EXPORT
+uint32_t Trend_Log_Buffer_Size(uint32_t object_instance);
+BACNET_STACK_EXPORT
+bool Trend_Log_Buffer_Size_Set(uint32_t object_instance, uint32_t buffer_size);
+BACNET_STACK_EXPORT
+bool Trend_Log_Storage_Set(
+    uint32_t object_instance,
+    const TL_STORAGE *storage,
+    trend_log_commit_function commit);
+
 BACNET_STACK_EXPORT
 void TL_Insert_Status_Rec(int iLog, BACNET_LOG_STATUS eStatus, bool bState);
 
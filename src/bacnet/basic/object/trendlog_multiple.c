@@ -0,0 +1,1950 @@
+/**
+ * @file
+ * @author agent <agent@local>
+ * @date October 2026
+ * @brief A basic Trend Log Multiple object, which logs a set of properties
+ *  of this device or of other devices together in each record.
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+/* BACnet Stack API */
+#include "bacnet/bacdcode.h"
+#include "bacnet/bacapp.h"
+#include "bacnet/bacdevobjpropref.h"
+#include "bacnet/datetime.h"
+#include "bacnet/proplist.h"
+#include "bacnet/readrange.h"
+#include "bacnet/rp.h"
+#include "bacnet/wp.h"
+#include "bacnet/basic/object/device.h"
+#include "bacnet/basic/sys/keylist.h"
+/* me! */
+#include "bacnet/basic/object/trendlog_multiple.h"
+
+/* seconds to wait for the values of other devices before a record
+   is added with a timeout error for the missing values */
+#ifndef TREND_LOG_MULTIPLE_ACQUIRE_TIMEOUT
+#define TREND_LOG_MULTIPLE_ACQUIRE_TIMEOUT 60
+#endif
+
+/* state of a member in the record being acquired */
+#define TLM_MEMBER_DONE 0
+#define TLM_MEMBER_WAITING 1
+#define TLM_MEMBER_REQUESTED 2
+
+struct object_data {
+    bool Enable : 1;
+    bool Stop_When_Full : 1;
+    bool Align_Intervals : 1;
+    bool Trigger : 1;
+    bool Sample_Pending : 1;
+    BACNET_LOGGING_TYPE Logging_Type;
+    uint32_t Log_Interval; /* seconds */
+    uint32_t Interval_Offset; /* seconds */
+    const char *Object_Name;
+    const char *Description;
+    BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE
+    Members[TREND_LOG_MULTIPLE_MEMBERS_MAX];
+    unsigned Member_Count;
+    /* ring of Buffer_Size records, and the values of each record */
+    TLM_DATA_REC *Records;
+    TLM_DATUM *Values;
+    uint32_t Buffer_Size;
+    uint32_t Index; /* current insertion point */
+    uint32_t Record_Count;
+    uint32_t Total_Record_Count;
+    bacnet_time_t Last_Data_Time;
+    /* record being acquired */
+    bacnet_time_t Sample_Time;
+    uint8_t Sample_State[TREND_LOG_MULTIPLE_MEMBERS_MAX];
+    TLM_DATUM Sample[TREND_LOG_MULTIPLE_MEMBERS_MAX];
+};
+
+/* Key List for storing the object data sorted by instance number  */
+static OS_Keylist Object_List;
+/* called when an object is created, deleted or renamed */
+static object_changed_function Object_Changed_Callback;
+/* local storage - keeps it off the c-stack */
+static uint8_t Read_Buffer[MAX_APDU];
+static BACNET_APPLICATION_DATA_VALUE Read_Value;
+
+/* These three arrays are used by the ReadPropertyMultiple handler */
+static const int Trend_Log_Multiple_Properties_Required[] = {
+    PROP_OBJECT_IDENTIFIER,
+    PROP_OBJECT_NAME,
+    PROP_OBJECT_TYPE,
+    PROP_STATUS_FLAGS,
+    PROP_EVENT_STATE,
+    PROP_ENABLE,
+    PROP_LOG_DEVICE_OBJECT_PROPERTY,
+    PROP_LOGGING_TYPE,
+    PROP_LOG_INTERVAL,
+    PROP_STOP_WHEN_FULL,
+    PROP_BUFFER_SIZE,
+    PROP_LOG_BUFFER,
+    PROP_RECORD_COUNT,
+    PROP_TOTAL_RECORD_COUNT,
+    -1
+};
+
+static const int Trend_Log_Multiple_Properties_Optional[] = {
+    PROP_DESCRIPTION, PROP_ALIGN_INTERVALS, PROP_INTERVAL_OFFSET,
+    PROP_TRIGGER, -1
+};
+
+static const int Trend_Log_Multiple_Properties_Proprietary[] = { -1 };
+
+/* standard properties that are arrays for this object,
+   but not necessary supported in this object */
+static const int BACnetARRAY_Properties[] = { PROP_LOG_DEVICE_OBJECT_PROPERTY,
+                                              PROP_EVENT_TIME_STAMPS,
+                                              PROP_EVENT_MESSAGE_TEXTS,
+                                              PROP_EVENT_MESSAGE_TEXTS_CONFIG,
+                                              PROP_TAGS,
+                                              -1 };
+
+/**
+ * Returns the list of required, optional, and proprietary properties.
+ * Used by ReadPropertyMultiple service.
+ *
+ * @param pRequired - pointer to list of int terminated by -1, of
+ * BACnet required properties for this object.
+ * @param pOptional - pointer to list of int terminated by -1, of
+ * BACnet optional properties for this object.
+ * @param pProprietary - pointer to list of int terminated by -1, of
+ * BACnet proprietary properties for this object.
+ */
+void Trend_Log_Multiple_Property_Lists(
+    const int **pRequired, const int **pOptional, const int **pProprietary)
+{
+    if (pRequired) {
+        *pRequired = Trend_Log_Multiple_Properties_Required;
+    }
+    if (pOptional) {
+        *pOptional = Trend_Log_Multiple_Properties_Optional;
+    }
+    if (pProprietary) {
+        *pProprietary = Trend_Log_Multiple_Properties_Proprietary;
+    }
+
+    return;
+}
+
+/**
+ * Determines if a given Trend Log Multiple instance is valid
+ *
+ * @param  object_instance - object-instance number of the object
+ *
+ * @return  true if the instance is valid, and false if not
+ */
+bool Trend_Log_Multiple_Valid_Instance(uint32_t object_instance)
+{
+    struct object_data *pObject;
+
+    pObject = Keylist_Data(Object_List, object_instance);
+    if (pObject) {
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * Determines the number of Trend Log Multiple objects
+ *
+ * @return  Number of Trend Log Multiple objects
+ */
+unsigned Trend_Log_Multiple_Count(void)
+{
+    return Keylist_Count(Object_List);
+}
+
+/**
+ * Determines the object instance-number for a given 0..N index
+ * of Trend Log Multiple objects where N is Trend_Log_Multiple_Count().
+ *
+ * @param  index - 0..N where N is Trend_Log_Multiple_Count()
+ *
+ * @return  object instance-number for the given index
+ */
+uint32_t Trend_Log_Multiple_Index_To_Instance(unsigned index)
+{
+    KEY key = UINT32_MAX;
+
+    Keylist_Index_Key(Object_List, index, &key);
+
+    return key;
+}
+
+/**
+ * For a given object instance-number, determines a 0..N index
+ * of Trend Log Multiple objects where N is Trend_Log_Multiple_Count().
+ *
+ * @param  object_instance - object-instance number of the object
+ *
+ * @return  index for the given instance-number, or
+ * Trend_Log_Multiple_Count() if not valid.
+ */
+unsigned Trend_Log_Multiple_Instance_To_Index(uint32_t object_instance)
+{
+    return Keylist_Index(Object_List, object_instance);
+}
+
+/**
+ * @brief Get the current time from the Device object
+ * @return current time in epoch seconds
+ */
+static bacnet_time_t Trend_Log_Multiple_Epoch_Seconds_Now(void)
+{
+    BACNET_DATE_TIME bdatetime = { 0 };
+
+    Device_getCurrentDateTime(&bdatetime);
+    return datetime_seconds_since_epoch(&bdatetime);
+}
+
+/**
+ * For a given object instance-number, loads the object-name into
+ * a characterstring. Note that the object name must be unique
+ * within this device.
+ *
+ * @param  object_instance - object-instance number of the object
+ * @param  object_name - holds the object-name retrieved
+ *
+ * @return  true if object-name was retrieved
+ */
+bool Trend_Log_Multiple_Object_Name(
+    uint32_t object_instance, BACNET_CHARACTER_STRING *object_name)
+{
+    bool status = false;
+    struct object_data *pObject;
+    char name_text[32] = "TREND-LOG-MULTIPLE-4194303";
+
+    pObject = Keylist_Data(Object_List, object_instance);
+    if (pObject) {
+        if (pObject->Object_Name) {
+            status =
+                characterstring_init_ansi(object_name, pObject->Object_Name);
+        } else {
+            snprintf(
+                name_text, sizeof(name_text), "TREND-LOG-MULTIPLE-%u",
+                object_instance);
+            status = characterstring_init_ansi(object_name, name_text);
+        }
+    }
+
+    return status;
+}
+
+/**
+ * For a given object instance-number, sets the object-name
+ * Note that the object name must be unique within this device.
+ *
+ * @param  object_instance - object-instance number of the object
+ * @param  value - holds the object-name to be set
+ *
+ * @return  true if object-name was set
+ */
+bool Trend_Log_Multiple_Name_Set(uint32_t object_instance, const char *value)
+{
+    bool status = false;
+    struct object_data *pObject;
+
+    pObject = Keylist_Data(Object_List, object_instance);
+    if (pObject) {
+        pObject->Object_Name = value;
+        status = true;
+    }
+    if (status && Object_Changed_Callback) {
+        Object_Changed_Callback(
+            OBJECT_TREND_LOG_MULTIPLE, object_instance, OBJECT_CHANGE_NAME);
+    }
+
+    return status;
+}
+
+/**
+ * For a given object instance-number, returns the description
+ *
+ * @param  object_instance - object-instance number of the object
+ *
+ * @return description text or NULL if not found
+ */
+const char *Trend_Log_Multiple_Description(uint32_t object_instance)
+{
+    const char *name = NULL;
+    const struct object_data *pObject;
+
+    pObject = Keylist_Data(Object_List, object_instance);
+    if (pObject) {
+        if (pObject->Description) {
+            name = pObject->Description;
+        } else {
+            name = "";
+        }
+    }
+
+    return name;
+}
+
+/**
+ * For a given object instance-number, sets the description
+ *
+ * @param  object_instance - object-instance number of the object
+ * @param  value - holds the description to be set
+ *
+ * @return  true if description was set
+ */
+bool Trend_Log_Multiple_Description_Set(
+    uint32_t object_instance, const char *value)
+{
+    bool status = false;
+    struct object_data *pObject;
+
+    pObject = Keylist_Data(Object_List, object_instance);
+    if (pObject) {
+        pObject->Description = value;
+        status = true;
+    }
+
+    return status;
+}
+
+/**
+ * @brief Get a record of the log buffer, in place
+ * @param pObject - object with valid data
+ * @param uiEntry - BACnet 1 based position of the record, oldest first
+ * @return ring position of the record
+ */
+static uint32_t
+TLM_Position(const struct object_data *pObject, uint32_t uiEntry)
+{
+    uint32_t uiOldest = 0;
+
+    if (pObject->Record_Count >= pObject->Buffer_Size) {
+        uiOldest = pObject->Index;
+    }
+
+    return (uiOldest + uiEntry - 1) % pObject->Buffer_Size;
+}
+
+/**
+ * @brief Add a record to the log buffer, pushing out the oldest record
+ *  when the log buffer is full
+ * @param pObject - object with valid data
+ * @param pRecord - record to add
+ * @param pValues - values of a TLM_TYPE_DATA record, one for each member
+ */
+static void TLM_Insert_Record(
+    struct object_data *pObject,
+    const TLM_DATA_REC *pRecord,
+    const TLM_DATUM *pValues)
+{
+    size_t count;
+
+    if (!pObject->Records) {
+        return;
+    }
+    if ((pRecord->ucRecType == TLM_TYPE_DATA) && pValues &&
+        (pRecord->ucCount > 0)) {
+        if (!pObject->Values) {
+            /* the values are taken when the first record needs them,
+               since each record holds one for each member */
+            count = (size_t)pObject->Buffer_Size * pObject->Member_Count;
+            pObject->Values = calloc(count, sizeof(TLM_DATUM));
+            if (!pObject->Values) {
+                return;
+            }
+        }
+        memcpy(
+            &pObject->Values[(size_t)pObject->Index * pObject->Member_Count],
+            pValues, pRecord->ucCount * sizeof(TLM_DATUM));
+    }
+    pObject->Records[pObject->Index++] = *pRecord;
+    if (pObject->Index >= pObject->Buffer_Size) {
+        pObject->Index = 0;
+    }
+    pObject->Total_Record_Count++;
+    if (pObject->Record_Count < pObject->Buffer_Size) {
+        pObject->Record_Count++;
+    }
+}
+
+/**
+ * @brief Add a log-status record to the log buffer
+ * @param pObject - object with valid data
+ * @param eStatus - status that changed
+ * @param bState - new state of the status
+ */
+static void TLM_Insert_Status_Rec(
+    struct object_data *pObject, BACNET_LOG_STATUS eStatus, bool bState)
+{
+    TLM_DATA_REC TempRec = { 0 };
+
+    TempRec.tTimeStamp = Trend_Log_Multiple_Epoch_Seconds_Now();
+    TempRec.ucRecType = TLM_TYPE_STATUS;
+    if (bState) {
+        TempRec.Datum.ucLogStatus = 1 << eStatus;
+    }
+    TLM_Insert_Record(pObject, &TempRec, NULL);
+}
+
+/**
+ * @brief Empty the log buffer, and record that it was purged. The values
+ *  are released, since their number follows the number of members.
+ * @param pObject - object with valid data
+ */
+static void TLM_Purge(struct object_data *pObject)
+{
+    free(pObject->Values);
+    pObject->Values = NULL;
+    pObject->Sample_Pending = false;
+    pObject->Record_Count = 0;
+    pObject->Index = 0;
+    TLM_Insert_Status_Rec(pObject, LOG_STATUS_BUFFER_PURGED, true);
+}
+
+/**
+ * For a given object instance-number, returns the Enable property value
+ *
+ * @param  object_instance - object-instance number of the object
+ *
+ * @return  true if logging is enabled
+ */
+bool Trend_Log_Multiple_Enable(uint32_t object_instance)
+{
+    bool value = false;
+    struct object_data *pObject;
+
+    pObject = Keylist_Data(Object_List, object_instance);
+    if (pObject) {
+        value = pObject->Enable;
+    }
+
+    return value;
+}
+
+/**
+ * @brief Set the Enable property, and record the change in the log buffer
+ * @param pObject - object with valid data
+ * @param value - true to enable logging
+ * @return false if a full log that stops when full would be enabled
+ */
+static bool TLM_Enable_Set(struct object_data *pObject, bool value)
+{
+    if (value && !pObject->Enable && pObject->Stop_When_Full &&
+        (pObject->Record_Count == pObject->Buffer_Size)) {
+        /* 12.30.6 can't enable a full log with stop when full set */
+        return false;
+    }
+    if (pObject->Enable != value) {
+        pObject->Enable = value;
+        pObject->Sample_Pending = false;
+        TLM_Insert_Status_Rec(pObject, LOG_STATUS_LOG_DISABLED, !value);
+    }
+
+    return true;
+}
+
+/**
+ * For a given object instance-number, sets the Enable property value
+ *
+ * @param  object_instance - object-instance number of the object
+ * @param  value - true to enable logging
+ *
+ * @return  true if the value was set
+ */
+bool Trend_Log_Multiple_Enable_Set(uint32_t object_instance, bool value)
+{
+    bool status = false;
+    struct object_data *pObject;
+
+    pObject = Keylist_Data(Object_List, object_instance);
+    if (pObject) {
+        status = TLM_Enable_Set(pObject, value);
+    }
+
+    return status;
+}
+
+/**
+ * For a given object instance-number, returns the Log_Interval
+ *
+ * @param  object_instance - object-instance number of the object
+ *
+ * @return  time between records, in seconds
+ */
+uint32_t Trend_Log_Multiple_Log_Interval(uint32_t object_instance)
+{
+    uint32_t value = 0;
+    struct object_data *pObject;
+
+    pObject = Keylist_Data(Object_List, object_instance);
+    if (pObject) {
+        value = pObject->Log_Interval;
+    }
+
+    return value;
+}
+
+/**
+ * For a given object instance-number, sets the Log_Interval
+ *
+ * @param  object_instance - object-instance number of the object
+ * @param  seconds - time between records, in seconds, greater than zero
+ *
+ * @return  true if the value was set
+ */
+bool Trend_Log_Multiple_Log_Interval_Set(
+    uint32_t object_instance, uint32_t seconds)
+{
+    bool status = false;
+    struct object_data *pObject;
+
+    pObject = Keylist_Data(Object_List, object_instance);
+    if (pObject && (seconds > 0)) {
+        pObject->Log_Interval = seconds;
+        status = true;
+    }
+
+    return status;
+}
+
+/**
+ * For a given object instance-number, returns the number of properties
+ * in the Log_DeviceObjectProperty array
+ *
+ * @param  object_instance - object-instance number of the object
+ *
+ * @return  number of properties that are logged
+ */
+unsigned Trend_Log_Multiple_Member_Count(uint32_t object_instance)
+{
+    unsigned count = 0;
+    struct object_data *pObject;
+
+    pObject = Keylist_Data(Object_List, object_instance);
+    if (pObject) {
+        count = pObject->Member_Count;
+    }
+
+    return count;
+}
+
+/**
+ * For a given object instance-number, gets a property that is logged
+ *
+ * @param  object_instance - object-instance number of the object
+ * @param  index - 0 based index of the Log_DeviceObjectProperty array
+ * @param  value - holds the reference to the property
+ *
+ * @return  true if the index is valid
+ */
+bool Trend_Log_Multiple_Member(
+    uint32_t object_instance,
+    unsigned index,
+    BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE *value)
+{
+    bool status = false;
+    struct object_data *pObject;
+
+    pObject = Keylist_Data(Object_List, object_instance);
+    if (pObject && (index < pObject->Member_Count)) {
+        if (value) {
+            *value = pObject->Members[index];
+        }
+        status = true;
+    }
+
+    return status;
+}
+
+/**
+ * For a given object instance-number, adds a property to be logged.
+ * The log buffer is purged.
+ *
+ * @param  object_instance - object-instance number of the object
+ * @param  value - reference to the property, of this device or
+ *  of another device
+ *
+ * @return  true if the property was added
+ */
+bool Trend_Log_Multiple_Member_Add(
+    uint32_t object_instance,
+    const BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE *value)
+{
+    bool status = false;
+    struct object_data *pObject;
+
+    pObject = Keylist_Data(Object_List, object_instance);
+    if (pObject && value &&
+        (pObject->Member_Count < TREND_LOG_MULTIPLE_MEMBERS_MAX)) {
+        pObject->Members[pObject->Member_Count] = *value;
+        pObject->Member_Count++;
+        TLM_Purge(pObject);
+        status = true;
+    }
+
+    return status;
+}
+
+/**
+ * For a given object instance-number, removes all of the properties
+ * that are logged. The log buffer is purged.
+ *
+ * @param  object_instance - object-instance number of the object
+ */
+void Trend_Log_Multiple_Member_Clear(uint32_t object_instance)
+{
+    struct object_data *pObject;
+
+    pObject = Keylist_Data(Object_List, object_instance);
+    if (pObject) {
+        pObject->Member_Count = 0;
+        TLM_Purge(pObject);
+    }
+}
+
+/**
+ * For a given object instance-number, returns the Buffer_Size
+ *
+ * @param  object_instance - object-instance number of the object
+ *
+ * @return  number of records the log buffer can hold
+ */
+uint32_t Trend_Log_Multiple_Buffer_Size(uint32_t object_instance)
+{
+    uint32_t value = 0;
+    struct object_data *pObject;
+
+    pObject = Keylist_Data(Object_List, object_instance);
+    if (pObject) {
+        value = pObject->Buffer_Size;
+    }
+
+    return value;
+}
+
+/**
+ * For a given object instance-number, sets the Buffer_Size.
+ * The log buffer is taken from the heap, and purged.
+ *
+ * @param  object_instance - object-instance number of the object
+ * @param  buffer_size - number of records the log buffer can hold
+ *
+ * @return  true if the log buffer was resized
+ */
+bool Trend_Log_Multiple_Buffer_Size_Set(
+    uint32_t object_instance, uint32_t buffer_size)
+{
+    struct object_data *pObject;
+    TLM_DATA_REC *pRecords;
+
+    pObject = Keylist_Data(Object_List, object_instance);
+    if (!pObject || (buffer_size == 0)) {
+        return false;
+    }
+    pRecords = calloc(buffer_size, sizeof(TLM_DATA_REC));
+    if (!pRecords) {
+        return false;
+    }
+    free(pObject->Records);
+    pObject->Records = pRecords;
+    pObject->Buffer_Size = buffer_size;
+    TLM_Purge(pObject);
+
+    return true;
+}
+
+/**
+ * For a given object instance-number, returns the Record_Count
+ *
+ * @param  object_instance - object-instance number of the object
+ *
+ * @return  number of records in the log buffer
+ */
+uint32_t Trend_Log_Multiple_Record_Count(uint32_t object_instance)
+{
+    uint32_t value = 0;
+    struct object_data *pObject;
+
+    pObject = Keylist_Data(Object_List, object_instance);
+    if (pObject) {
+        value = pObject->Record_Count;
+    }
+
+    return value;
+}
+
+/**
+ * For a given object instance-number, returns the Total_Record_Count
+ *
+ * @param  object_instance - object-instance number of the object
+ *
+ * @return  number of records ever added to the log buffer
+ */
+uint32_t Trend_Log_Multiple_Total_Record_Count(uint32_t object_instance)
+{
+    uint32_t value = 0;
+    struct object_data *pObject;
+
+    pObject = Keylist_Data(Object_List, object_instance);
+    if (pObject) {
+        value = pObject->Total_Record_Count;
+    }
+
+    return value;
+}
+
+/**
+ * For a given object instance-number, sets the Trigger property, so that
+ * a record is acquired at the next timer tick
+ *
+ * @param  object_instance - object-instance number of the object
+ *
+ * @return  true if the trigger was set
+ */
+bool Trend_Log_Multiple_Trigger(uint32_t object_instance)
+{
+    bool status = false;
+    struct object_data *pObject;
+
+    pObject = Keylist_Data(Object_List, object_instance);
+    if (pObject) {
+        pObject->Trigger = true;
+        status = true;
+    }
+
+    return status;
+}
+
+/**
+ * @brief Determine if a member is a property of another device
+ * @param pMember - reference to the property
+ * @return true if the property is read from another device
+ */
+static bool TLM_Member_Remote(
+    const BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE *pMember)
+{
+    return (pMember->deviceIdentifier.type == OBJECT_DEVICE) &&
+        (pMember->deviceIdentifier.instance !=
+         Device_Object_Instance_Number());
+}
+
+/**
+ * @brief Store a value in the form of a log record value. Bit strings are
+ *  truncated at 32 bits, and the types that cannot be logged are stored
+ *  as an error.
+ * @param pDatum - log record value
+ * @param value - decoded value, or NULL for an error
+ * @param error_class - error class used when there is no value
+ * @param error_code - error code used when there is no value
+ */
+static void TLM_Datum_Set(
+    TLM_DATUM *pDatum,
+    const BACNET_APPLICATION_DATA_VALUE *value,
+    BACNET_ERROR_CLASS error_class,
+    BACNET_ERROR_CODE error_code)
+{
+    uint8_t ucBits = 0;
+    uint8_t ucBytes = 0;
+    uint8_t ucCount = 0;
+
+    if (!value) {
+        pDatum->ucRecType = TL_TYPE_ERROR;
+        pDatum->Datum.Error.usClass = error_class;
+        pDatum->Datum.Error.usCode = error_code;
+        return;
+    }
+    switch (value->tag) {
+        case BACNET_APPLICATION_TAG_NULL:
+            pDatum->ucRecType = TL_TYPE_NULL;
+            break;
+        case BACNET_APPLICATION_TAG_BOOLEAN:
+            pDatum->ucRecType = TL_TYPE_BOOL;
+            pDatum->Datum.ucBoolean = value->type.Boolean;
+            break;
+        case BACNET_APPLICATION_TAG_UNSIGNED_INT:
+            pDatum->ucRecType = TL_TYPE_UNSIGN;
+            pDatum->Datum.ulUValue = (uint32_t)value->type.Unsigned_Int;
+            break;
+        case BACNET_APPLICATION_TAG_SIGNED_INT:
+            pDatum->ucRecType = TL_TYPE_SIGN;
+            pDatum->Datum.lSValue = (int32_t)value->type.Signed_Int;
+            break;
+        case BACNET_APPLICATION_TAG_REAL:
+            pDatum->ucRecType = TL_TYPE_REAL;
+            pDatum->Datum.fReal = value->type.Real;
+            break;
+        case BACNET_APPLICATION_TAG_ENUMERATED:
+            pDatum->ucRecType = TL_TYPE_ENUM;
+            pDatum->Datum.ulEnum = value->type.Enumerated;
+            break;
+        case BACNET_APPLICATION_TAG_BIT_STRING:
+            pDatum->ucRecType = TL_TYPE_BITS;
+            ucBits = bitstring_bits_used(&value->type.Bit_String);
+            if (ucBits > 32) {
+                ucBits = 32;
+            }
+            ucBytes = (ucBits + 7) / 8;
+            /* the bytes used and the bits free in the last byte */
+            pDatum->Datum.Bits.ucLen = ucBytes << 4;
+            pDatum->Datum.Bits.ucLen |= (ucBytes * 8) - ucBits;
+            for (ucCount = 0; ucCount < ucBytes; ucCount++) {
+                pDatum->Datum.Bits.ucStore[ucCount] =
+                    bitstring_octet(&value->type.Bit_String, ucCount);
+            }
+            break;
+        default:
+            pDatum->ucRecType = TL_TYPE_ERROR;
+            pDatum->Datum.Error.usClass = ERROR_CLASS_PROPERTY;
+            pDatum->Datum.Error.usCode = ERROR_CODE_DATATYPE_NOT_SUPPORTED;
+            break;
+    }
+}
+
+/**
+ * @brief Read a property of this device into a log record value
+ * @param pDatum - log record value
+ * @param pMember - reference to the property
+ */
+static void TLM_Member_Read_Local(
+    TLM_DATUM *pDatum, const BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE *pMember)
+{
+    BACNET_READ_PROPERTY_DATA rpdata = { 0 };
+    int len = 0;
+
+    rpdata.application_data = Read_Buffer;
+    rpdata.application_data_len = sizeof(Read_Buffer);
+    rpdata.object_type = pMember->objectIdentifier.type;
+    rpdata.object_instance = pMember->objectIdentifier.instance;
+    rpdata.object_property = pMember->propertyIdentifier;
+    rpdata.array_index = (BACNET_ARRAY_INDEX)pMember->arrayIndex;
+    len = Device_Read_Property(&rpdata);
+    if (len < 0) {
+        TLM_Datum_Set(pDatum, NULL, rpdata.error_class, rpdata.error_code);
+        return;
+    }
+    len = bacapp_decode_application_data(Read_Buffer, len, &Read_Value);
+    if (len <= 0) {
+        TLM_Datum_Set(
+            pDatum, NULL, ERROR_CLASS_PROPERTY,
+            ERROR_CODE_DATATYPE_NOT_SUPPORTED);
+        return;
+    }
+    TLM_Datum_Set(pDatum, &Read_Value, ERROR_CLASS_PROPERTY, ERROR_CODE_OTHER);
+}
+
+/**
+ * @brief Add the record being acquired to the log buffer once every member
+ *  has a value, or when the wait is over, with a timeout error for each
+ *  value that is still missing
+ * @param pObject - object with valid data
+ * @param bTimeout - true if the wait is over
+ */
+static void TLM_Sample_Commit(struct object_data *pObject, bool bTimeout)
+{
+    TLM_DATA_REC TempRec = { 0 };
+    unsigned i;
+
+    if (!pObject->Sample_Pending) {
+        return;
+    }
+    for (i = 0; i < pObject->Member_Count; i++) {
+        if (pObject->Sample_State[i] != TLM_MEMBER_DONE) {
+            if (!bTimeout) {
+                return;
+            }
+            TLM_Datum_Set(
+                &pObject->Sample[i], NULL, ERROR_CLASS_COMMUNICATION,
+                ERROR_CODE_TIMEOUT);
+            pObject->Sample_State[i] = TLM_MEMBER_DONE;
+        }
+    }
+    pObject->Sample_Pending = false;
+    if (pObject->Stop_When_Full &&
+        ((pObject->Record_Count + 1) >= pObject->Buffer_Size)) {
+        /* 12.30.12 the last record of a full log says it was disabled */
+        TLM_Enable_Set(pObject, false);
+        return;
+    }
+    TempRec.tTimeStamp = pObject->Sample_Time;
+    TempRec.ucRecType = TLM_TYPE_DATA;
+    TempRec.ucCount = (uint8_t)pObject->Member_Count;
+    TLM_Insert_Record(pObject, &TempRec, pObject->Sample);
+}
+
+/**
+ * @brief Start acquiring a record. The properties of this device are read
+ *  now, and those of other devices wait for Trend_Log_Multiple_Remote_Value()
+ * @param pObject - object with valid data
+ * @param tNow - time of the record
+ */
+static void TLM_Sample_Start(struct object_data *pObject, bacnet_time_t tNow)
+{
+    unsigned i;
+
+    pObject->Last_Data_Time = tNow;
+    if (pObject->Member_Count == 0) {
+        return;
+    }
+    pObject->Sample_Time = tNow;
+    pObject->Sample_Pending = true;
+    for (i = 0; i < pObject->Member_Count; i++) {
+        if (TLM_Member_Remote(&pObject->Members[i])) {
+            pObject->Sample_State[i] = TLM_MEMBER_WAITING;
+        } else {
+            TLM_Member_Read_Local(&pObject->Sample[i], &pObject->Members[i]);
+            pObject->Sample_State[i] = TLM_MEMBER_DONE;
+        }
+    }
+    TLM_Sample_Commit(pObject, false);
+}
+
+/**
+ * @brief Updates the object, acquiring a record when one is due
+ * @param object_instance - object-instance number of the object
+ * @param milliseconds - number of milliseconds elapsed since previously
+ *  called. Records are timed by the clock of the Device object, so that
+ *  they can be aligned to it.
+ */
+void Trend_Log_Multiple_Timer(uint32_t object_instance, uint16_t milliseconds)
+{
+    struct object_data *pObject;
+    bacnet_time_t tNow;
+    bool bDue = false;
+
+    (void)milliseconds;
+    pObject = Keylist_Data(Object_List, object_instance);
+    if (!pObject || !pObject->Enable) {
+        return;
+    }
+    tNow = Trend_Log_Multiple_Epoch_Seconds_Now();
+    if (pObject->Logging_Type == LOGGING_TYPE_POLLED) {
+        if (pObject->Align_Intervals) {
+            /* log once at the offset into each interval of the clock, or
+               as soon as possible when a whole interval was missed */
+            if ((tNow != pObject->Last_Data_Time) &&
+                (((tNow % pObject->Log_Interval) ==
+                  (pObject->Interval_Offset % pObject->Log_Interval)) ||
+                 ((tNow - pObject->Last_Data_Time) > pObject->Log_Interval))) {
+                bDue = true;
+            }
+        } else if (
+            ((tNow - pObject->Last_Data_Time) >= pObject->Log_Interval) ||
+            pObject->Trigger) {
+            bDue = true;
+        }
+        pObject->Trigger = false;
+    } else if (pObject->Logging_Type == LOGGING_TYPE_TRIGGERED) {
+        if (pObject->Trigger) {
+            bDue = true;
+            pObject->Trigger = false;
+        }
+    }
+    if (pObject->Sample_Pending &&
+        (bDue ||
+         ((tNow - pObject->Sample_Time) >=
+          TREND_LOG_MULTIPLE_ACQUIRE_TIMEOUT))) {
+        TLM_Sample_Commit(pObject, true);
+    }
+    if (bDue) {
+        TLM_Sample_Start(pObject, tNow);
+    }
+}
+
+/**
+ * @brief Hand each property of another device that a record is waiting for
+ *  to an acquisition engine, such as one that reads the properties of each
+ *  device together with ReadPropertyMultiple. A property that the engine
+ *  does not take is handed to it again on the next call.
+ * @param callback - takes the properties to be acquired
+ * @return number of properties that were taken
+ */
+unsigned Trend_Log_Multiple_Remote_Requests(
+    trend_log_multiple_request_function callback)
+{
+    struct object_data *pObject;
+    const BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE *pMember;
+    unsigned count = 0;
+    int index, object_count;
+    unsigned i;
+
+    if (!callback) {
+        return 0;
+    }
+    object_count = Keylist_Count(Object_List);
+    for (index = 0; index < object_count; index++) {
+        pObject = Keylist_Data_Index(Object_List, index);
+        if (!pObject || !pObject->Sample_Pending) {
+            continue;
+        }
+        for (i = 0; i < pObject->Member_Count; i++) {
+            if (pObject->Sample_State[i] != TLM_MEMBER_WAITING) {
+                continue;
+            }
+            pMember = &pObject->Members[i];
+            if (callback(
+                    pMember->deviceIdentifier.instance,
+                    &pMember->objectIdentifier, pMember->propertyIdentifier,
+                    (BACNET_ARRAY_INDEX)pMember->arrayIndex)) {
+                pObject->Sample_State[i] = TLM_MEMBER_REQUESTED;
+                count++;
+            }
+        }
+    }
+
+    return count;
+}
+
+/**
+ * @brief Store the value of a property of another device in each record
+ *  that is waiting for it. The signature matches the value callback of
+ *  the read-write client, so either can acquire the values.
+ * @param device_id - device instance of the property
+ * @param rp_data - the property, and the error when there is no value
+ * @param value - the decoded value, or NULL for an error
+ */
+void Trend_Log_Multiple_Remote_Value(
+    uint32_t device_id,
+    BACNET_READ_PROPERTY_DATA *rp_data,
+    BACNET_APPLICATION_DATA_VALUE *value)
+{
+    struct object_data *pObject;
+    const BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE *pMember;
+    int index, object_count;
+    bool bMatch;
+    unsigned i;
+
+    if (!rp_data) {
+        return;
+    }
+    object_count = Keylist_Count(Object_List);
+    for (index = 0; index < object_count; index++) {
+        pObject = Keylist_Data_Index(Object_List, index);
+        if (!pObject || !pObject->Sample_Pending) {
+            continue;
+        }
+        bMatch = false;
+        for (i = 0; i < pObject->Member_Count; i++) {
+            pMember = &pObject->Members[i];
+            if ((pObject->Sample_State[i] == TLM_MEMBER_DONE) ||
+                (pMember->deviceIdentifier.instance != device_id) ||
+                (pMember->objectIdentifier.type != rp_data->object_type) ||
+                (pMember->objectIdentifier.instance !=
+                 rp_data->object_instance) ||
+                (pMember->propertyIdentifier != rp_data->object_property) ||
+                (pMember->arrayIndex != rp_data->array_index) ||
+                !TLM_Member_Remote(pMember)) {
+                continue;
+            }
+            TLM_Datum_Set(
+                &pObject->Sample[i], value, rp_data->error_class,
+                rp_data->error_code);
+            pObject->Sample_State[i] = TLM_MEMBER_DONE;
+            bMatch = true;
+        }
+        if (bMatch) {
+            TLM_Sample_Commit(pObject, false);
+        }
+    }
+}
+
+/**
+ * @brief Encode one element of the Log_DeviceObjectProperty array
+ * @param object_instance [in] BACnet network port object instance number
+ * @param index [in] array index requested:
+ *    0 to N for individual array members
+ * @param apdu [out] Buffer in which the APDU contents are built, or NULL to
+ *  return the length of buffer if it had been built
+ * @return The length of the apdu encoded or
+ *   BACNET_STATUS_ERROR for ERROR_CODE_INVALID_ARRAY_INDEX
+ */
+static int Trend_Log_Multiple_Member_Encode(
+    uint32_t object_instance, BACNET_ARRAY_INDEX index, uint8_t *apdu)
+{
+    struct object_data *pObject;
+
+    pObject = Keylist_Data(Object_List, object_instance);
+    if (!pObject || (index >= pObject->Member_Count)) {
+        return BACNET_STATUS_ERROR;
+    }
+
+    return bacapp_encode_device_obj_property_ref(
+        apdu, &pObject->Members[index]);
+}
+
+/**
+ * @brief Determine if the object property is a BACnetARRAY property
+ * @param object_property - object-property to be checked
+ * @return true if the property is a BACnetARRAY property
+ */
+static bool BACnetARRAY_Property(int object_property)
+{
+    return property_list_member(BACnetARRAY_Properties, object_property);
+}
+
+/**
+ * ReadProperty handler for this object.  For the given ReadProperty
+ * data, the application_data is loaded or the error flags are set.
+ *
+ * @param  rpdata - BACNET_READ_PROPERTY_DATA data, including
+ * requested data and space for the reply, or error response.
+ *
+ * @return number of APDU bytes in the response, or
+ * BACNET_STATUS_ERROR on error.
+ */
+int Trend_Log_Multiple_Read_Property(BACNET_READ_PROPERTY_DATA *rpdata)
+{
+    int apdu_len = 0; /* return value */
+    BACNET_BIT_STRING bit_string;
+    BACNET_CHARACTER_STRING char_string;
+    struct object_data *pObject;
+    uint8_t *apdu = NULL;
+    int apdu_max = 0;
+
+    if ((rpdata == NULL) || (rpdata->application_data == NULL) ||
+        (rpdata->application_data_len == 0)) {
+        return 0;
+    }
+    pObject = Keylist_Data(Object_List, rpdata->object_instance);
+    if (!pObject) {
+        rpdata->error_class = ERROR_CLASS_OBJECT;
+        rpdata->error_code = ERROR_CODE_UNKNOWN_OBJECT;
+        return BACNET_STATUS_ERROR;
+    }
+    apdu = rpdata->application_data;
+    apdu_max = rpdata->application_data_len;
+    switch (rpdata->object_property) {
+        case PROP_OBJECT_IDENTIFIER:
+            apdu_len = encode_application_object_id(
+                &apdu[0], rpdata->object_type, rpdata->object_instance);
+            break;
+        case PROP_OBJECT_NAME:
+            Trend_Log_Multiple_Object_Name(
+                rpdata->object_instance, &char_string);
+            apdu_len =
+                encode_application_character_string(&apdu[0], &char_string);
+            break;
+        case PROP_OBJECT_TYPE:
+            apdu_len =
+                encode_application_enumerated(&apdu[0], rpdata->object_type);
+            break;
+        case PROP_DESCRIPTION:
+            characterstring_init_ansi(
+                &char_string,
+                Trend_Log_Multiple_Description(rpdata->object_instance));
+            apdu_len = encode_application_character_string(apdu, &char_string);
+            break;
+        case PROP_STATUS_FLAGS:
+            bitstring_init(&bit_string);
+            bitstring_set_bit(&bit_string, STATUS_FLAG_IN_ALARM, false);
+            bitstring_set_bit(&bit_string, STATUS_FLAG_FAULT, false);
+            bitstring_set_bit(&bit_string, STATUS_FLAG_OVERRIDDEN, false);
+            bitstring_set_bit(&bit_string, STATUS_FLAG_OUT_OF_SERVICE, false);
+            apdu_len = encode_application_bitstring(&apdu[0], &bit_string);
+            break;
+        case PROP_EVENT_STATE:
+            apdu_len =
+                encode_application_enumerated(&apdu[0], EVENT_STATE_NORMAL);
+            break;
+        case PROP_ENABLE:
+            apdu_len = encode_application_boolean(&apdu[0], pObject->Enable);
+            break;
+        case PROP_LOG_DEVICE_OBJECT_PROPERTY:
+            apdu_len = bacnet_array_encode(
+                rpdata->object_instance, rpdata->array_index,
+                Trend_Log_Multiple_Member_Encode, pObject->Member_Count, apdu,
+                apdu_max);
+            if (apdu_len == BACNET_STATUS_ABORT) {
+                rpdata->error_code =
+                    ERROR_CODE_ABORT_SEGMENTATION_NOT_SUPPORTED;
+            } else if (apdu_len == BACNET_STATUS_ERROR) {
+                rpdata->error_class = ERROR_CLASS_PROPERTY;
+                rpdata->error_code = ERROR_CODE_INVALID_ARRAY_INDEX;
+            }
+            break;
+        case PROP_LOGGING_TYPE:
+            apdu_len =
+                encode_application_enumerated(&apdu[0], pObject->Logging_Type);
+            break;
+        case PROP_LOG_INTERVAL:
+            /* We only log to 1 sec accuracy so must multiply by 100 before
+             * passing it on */
+            apdu_len = encode_application_unsigned(
+                &apdu[0], pObject->Log_Interval * 100);
+            break;
+        case PROP_STOP_WHEN_FULL:
+            apdu_len =
+                encode_application_boolean(&apdu[0], pObject->Stop_When_Full);
+            break;
+        case PROP_BUFFER_SIZE:
+            apdu_len =
+                encode_application_unsigned(&apdu[0], pObject->Buffer_Size);
+            break;
+        case PROP_LOG_BUFFER:
+            /* You can only read the buffer via the ReadRange service */
+            rpdata->error_class = ERROR_CLASS_PROPERTY;
+            rpdata->error_code = ERROR_CODE_READ_ACCESS_DENIED;
+            apdu_len = BACNET_STATUS_ERROR;
+            break;
+        case PROP_RECORD_COUNT:
+            apdu_len =
+                encode_application_unsigned(&apdu[0], pObject->Record_Count);
+            break;
+        case PROP_TOTAL_RECORD_COUNT:
+            apdu_len = encode_application_unsigned(
+                &apdu[0], pObject->Total_Record_Count);
+            break;
+        case PROP_ALIGN_INTERVALS:
+            apdu_len =
+                encode_application_boolean(&apdu[0], pObject->Align_Intervals);
+            break;
+        case PROP_INTERVAL_OFFSET:
+            apdu_len = encode_application_unsigned(
+                &apdu[0], pObject->Interval_Offset * 100);
+            break;
+        case PROP_TRIGGER:
+            apdu_len = encode_application_boolean(&apdu[0], pObject->Trigger);
+            break;
+        default:
+            rpdata->error_class = ERROR_CLASS_PROPERTY;
+            rpdata->error_code = ERROR_CODE_UNKNOWN_PROPERTY;
+            apdu_len = BACNET_STATUS_ERROR;
+            break;
+    }
+    /*  only array properties can have array options */
+    if ((apdu_len >= 0) && (!BACnetARRAY_Property(rpdata->object_property)) &&
+        (rpdata->array_index != BACNET_ARRAY_ALL)) {
+        rpdata->error_class = ERROR_CLASS_PROPERTY;
+        rpdata->error_code = ERROR_CODE_PROPERTY_IS_NOT_AN_ARRAY;
+        apdu_len = BACNET_STATUS_ERROR;
+    }
+
+    return apdu_len;
+}
+
+/**
+ * @brief Write the Log_DeviceObjectProperty array, or one element of it.
+ *  The log buffer is purged when the logged properties change.
+ * @param pObject - object with valid data
+ * @param wp_data - WriteProperty data, including the error response
+ * @return true if the array was written
+ */
+static bool TLM_Members_Write(
+    struct object_data *pObject, BACNET_WRITE_PROPERTY_DATA *wp_data)
+{
+    BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE
+    Members[TREND_LOG_MULTIPLE_MEMBERS_MAX];
+    unsigned count = 0;
+    int apdu_len = 0;
+    int len = 0;
+
+    if (wp_data->array_index == 0) {
+        /* the size of the array follows its elements */
+        wp_data->error_class = ERROR_CLASS_PROPERTY;
+        wp_data->error_code = ERROR_CODE_WRITE_ACCESS_DENIED;
+        return false;
+    }
+    if ((wp_data->array_index != BACNET_ARRAY_ALL) &&
+        (wp_data->array_index > pObject->Member_Count)) {
+        wp_data->error_class = ERROR_CLASS_PROPERTY;
+        wp_data->error_code = ERROR_CODE_INVALID_ARRAY_INDEX;
+        return false;
+    }
+    while (apdu_len < wp_data->application_data_len) {
+        if (count >= TREND_LOG_MULTIPLE_MEMBERS_MAX) {
+            wp_data->error_class = ERROR_CLASS_RESOURCES;
+            wp_data->error_code = ERROR_CODE_NO_SPACE_TO_WRITE_PROPERTY;
+            return false;
+        }
+        len = bacnet_device_object_property_reference_decode(
+            &wp_data->application_data[apdu_len],
+            wp_data->application_data_len - apdu_len, &Members[count]);
+        if (len <= 0) {
+            wp_data->error_class = ERROR_CLASS_PROPERTY;
+            wp_data->error_code = ERROR_CODE_INVALID_DATA_TYPE;
+            return false;
+        }
+        apdu_len += len;
+        count++;
+    }
+    if (wp_data->array_index == BACNET_ARRAY_ALL) {
+        if ((count != pObject->Member_Count) ||
+            (memcmp(Members, pObject->Members, count * sizeof(Members[0])) !=
+             0)) {
+            memcpy(pObject->Members, Members, count * sizeof(Members[0]));
+            pObject->Member_Count = count;
+            TLM_Purge(pObject);
+        }
+    } else if (count == 1) {
+        if (memcmp(
+                &Members[0], &pObject->Members[wp_data->array_index - 1],
+                sizeof(Members[0])) != 0) {
+            pObject->Members[wp_data->array_index - 1] = Members[0];
+            TLM_Purge(pObject);
+        }
+    } else {
+        wp_data->error_class = ERROR_CLASS_PROPERTY;
+        wp_data->error_code = ERROR_CODE_INVALID_DATA_TYPE;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * WriteProperty handler for this object.  For the given WriteProperty
+ * data, the application_data is loaded or the error flags are set.
+ *
+ * @param  wp_data - BACNET_WRITE_PROPERTY_DATA data, including
+ * requested data and space for the reply, or error response.
+ *
+ * @return false if an error is loaded, true if no errors
+ */
+bool Trend_Log_Multiple_Write_Property(BACNET_WRITE_PROPERTY_DATA *wp_data)
+{
+    bool status = false; /* return value */
+    BACNET_APPLICATION_DATA_VALUE value;
+    struct object_data *pObject;
+    int len = 0;
+
+    pObject = Keylist_Data(Object_List, wp_data->object_instance);
+    if (!pObject) {
+        wp_data->error_class = ERROR_CLASS_OBJECT;
+        wp_data->error_code = ERROR_CODE_UNKNOWN_OBJECT;
+        return false;
+    }
+    if ((!BACnetARRAY_Property(wp_data->object_property)) &&
+        (wp_data->array_index != BACNET_ARRAY_ALL)) {
+        /*  only array properties can have array options */
+        wp_data->error_class = ERROR_CLASS_PROPERTY;
+        wp_data->error_code = ERROR_CODE_PROPERTY_IS_NOT_AN_ARRAY;
+        return false;
+    }
+    if (wp_data->object_property == PROP_LOG_DEVICE_OBJECT_PROPERTY) {
+        /* the elements are context tagged */
+        return TLM_Members_Write(pObject, wp_data);
+    }
+    /* decode the some of the request */
+    len = bacapp_decode_application_data(
+        wp_data->application_data, wp_data->application_data_len, &value);
+    if (len < 0) {
+        /* error while decoding - a value larger than we can handle */
+        wp_data->error_class = ERROR_CLASS_PROPERTY;
+        wp_data->error_code = ERROR_CODE_VALUE_OUT_OF_RANGE;
+        return false;
+    }
+    switch (wp_data->object_property) {
+        case PROP_ENABLE:
+            status = write_property_type_valid(
+                wp_data, &value, BACNET_APPLICATION_TAG_BOOLEAN);
+            if (status && !TLM_Enable_Set(pObject, value.type.Boolean)) {
+                status = false;
+                wp_data->error_class = ERROR_CLASS_OBJECT;
+                wp_data->error_code = ERROR_CODE_LOG_BUFFER_FULL;
+            }
+            break;
+        case PROP_STOP_WHEN_FULL:
+            status = write_property_type_valid(
+                wp_data, &value, BACNET_APPLICATION_TAG_BOOLEAN);
+            if (status) {
+                pObject->Stop_When_Full = value.type.Boolean;
+                if (pObject->Stop_When_Full &&
+                    (pObject->Record_Count == pObject->Buffer_Size)) {
+                    /* 12.30.12 a full log stops when switched over */
+                    TLM_Enable_Set(pObject, false);
+                }
+            }
+            break;
+        case PROP_BUFFER_SIZE:
+            /* Resizing erases the current log, and is not allowed
+             * if enable is true.
+             */
+            status = write_property_type_valid(
+                wp_data, &value, BACNET_APPLICATION_TAG_UNSIGNED_INT);
+            if (status) {
+                if (pObject->Enable || (value.type.Unsigned_Int > UINT32_MAX)) {
+                    status = false;
+                    wp_data->error_class = ERROR_CLASS_PROPERTY;
+                    wp_data->error_code = ERROR_CODE_WRITE_ACCESS_DENIED;
+                } else if (!Trend_Log_Multiple_Buffer_Size_Set(
+                               wp_data->object_instance,
+                               (uint32_t)value.type.Unsigned_Int)) {
+                    status = false;
+                    wp_data->error_class = ERROR_CLASS_RESOURCES;
+                    wp_data->error_code = ERROR_CODE_NO_SPACE_TO_WRITE_PROPERTY;
+                }
+            }
+            break;
+        case PROP_RECORD_COUNT:
+            status = write_property_type_valid(
+                wp_data, &value, BACNET_APPLICATION_TAG_UNSIGNED_INT);
+            if (status) {
+                if (value.type.Unsigned_Int == 0) {
+                    TLM_Purge(pObject);
+                } else {
+                    status = false;
+                    wp_data->error_class = ERROR_CLASS_PROPERTY;
+                    wp_data->error_code = ERROR_CODE_VALUE_OUT_OF_RANGE;
+                }
+            }
+            break;
+        case PROP_LOGGING_TYPE:
+            status = write_property_type_valid(
+                wp_data, &value, BACNET_APPLICATION_TAG_ENUMERATED);
+            if (status) {
+                if (value.type.Enumerated == LOGGING_TYPE_POLLED) {
+                    pObject->Logging_Type = LOGGING_TYPE_POLLED;
+                    if (pObject->Log_Interval == 0) {
+                        pObject->Log_Interval = 900;
+                    }
+                } else if (value.type.Enumerated == LOGGING_TYPE_TRIGGERED) {
+                    pObject->Logging_Type = LOGGING_TYPE_TRIGGERED;
+                } else {
+                    /* We don't currently support COV */
+                    status = false;
+                    wp_data->error_class = ERROR_CLASS_PROPERTY;
+                    wp_data->error_code =
+                        ERROR_CODE_OPTIONAL_FUNCTIONALITY_NOT_SUPPORTED;
+                }
+            }
+            break;
+        case PROP_LOG_INTERVAL:
+            status = write_property_type_valid(
+                wp_data, &value, BACNET_APPLICATION_TAG_UNSIGNED_INT);
+            if (status) {
+                /* We only log to 1 sec accuracy so must divide by 100
+                 * before passing it on */
+                if ((value.type.Unsigned_Int / 100) > UINT32_MAX) {
+                    pObject->Log_Interval = UINT32_MAX;
+                } else if (value.type.Unsigned_Int < 100) {
+                    pObject->Log_Interval = 1;
+                } else {
+                    pObject->Log_Interval = value.type.Unsigned_Int / 100;
+                }
+            }
+            break;
+        case PROP_ALIGN_INTERVALS:
+            status = write_property_type_valid(
+                wp_data, &value, BACNET_APPLICATION_TAG_BOOLEAN);
+            if (status) {
+                pObject->Align_Intervals = value.type.Boolean;
+            }
+            break;
+        case PROP_INTERVAL_OFFSET:
+            status = write_property_type_valid(
+                wp_data, &value, BACNET_APPLICATION_TAG_UNSIGNED_INT);
+            if (status) {
+                pObject->Interval_Offset =
+                    (uint32_t)(value.type.Unsigned_Int / 100);
+            }
+            break;
+        case PROP_TRIGGER:
+            status = write_property_type_valid(
+                wp_data, &value, BACNET_APPLICATION_TAG_BOOLEAN);
+            if (status) {
+                if ((pObject->Logging_Type == LOGGING_TYPE_POLLED) &&
+                    pObject->Align_Intervals) {
+                    /* a trigger would give a record out of alignment */
+                    status = false;
+                    wp_data->error_class = ERROR_CLASS_PROPERTY;
+                    wp_data->error_code =
+                        ERROR_CODE_NOT_CONFIGURED_FOR_TRIGGERED_LOGGING;
+                } else {
+                    pObject->Trigger = value.type.Boolean;
+                }
+            }
+            break;
+        default:
+            if (property_lists_member(
+                    Trend_Log_Multiple_Properties_Required,
+                    Trend_Log_Multiple_Properties_Optional,
+                    Trend_Log_Multiple_Properties_Proprietary,
+                    wp_data->object_property)) {
+                wp_data->error_class = ERROR_CLASS_PROPERTY;
+                wp_data->error_code = ERROR_CODE_WRITE_ACCESS_DENIED;
+            } else {
+                wp_data->error_class = ERROR_CLASS_PROPERTY;
+                wp_data->error_code = ERROR_CODE_UNKNOWN_PROPERTY;
+            }
+            break;
+    }
+
+    return status;
+}
+
+/****************************************************************************
+ * The size of an encoded BACnetLogMultipleRecord is taken as 12 bytes for  *
+ * the time stamp + 4 for the context tags, and 8 bytes for each value,     *
+ * the size of an error, so that a record is only encoded if it fits.       *
+ ****************************************************************************/
+#define TLM_MAX_ENC_RECORD 16
+#define TLM_MAX_ENC_DATUM 8
+
+/**
+ * @brief Encode one value of a log-data record
+ * @param apdu - buffer for the encoded value
+ * @param pDatum - value to encode
+ * @return number of bytes encoded
+ */
+static int TLM_encode_datum(uint8_t *apdu, const TLM_DATUM *pDatum)
+{
+    BACNET_BIT_STRING TempBits;
+    uint8_t ucTag = pDatum->ucRecType - 1;
+    uint8_t ucCount;
+    int iLen = 0;
+
+    /* the value choices are tagged [0] - [8], one less than the
+       Trend Log datum types */
+    switch (pDatum->ucRecType) {
+        case TL_TYPE_BOOL:
+            iLen = encode_context_boolean(apdu, ucTag, pDatum->Datum.ucBoolean);
+            break;
+        case TL_TYPE_REAL:
+            iLen = encode_context_real(apdu, ucTag, pDatum->Datum.fReal);
+            break;
+        case TL_TYPE_ENUM:
+            iLen = encode_context_enumerated(apdu, ucTag, pDatum->Datum.ulEnum);
+            break;
+        case TL_TYPE_UNSIGN:
+            iLen = encode_context_unsigned(apdu, ucTag, pDatum->Datum.ulUValue);
+            break;
+        case TL_TYPE_SIGN:
+            iLen = encode_context_signed(apdu, ucTag, pDatum->Datum.lSValue);
+            break;
+        case TL_TYPE_BITS:
+            bitstring_init(&TempBits);
+            bitstring_set_bits_used(
+                &TempBits, (pDatum->Datum.Bits.ucLen >> 4) & 0x0F,
+                pDatum->Datum.Bits.ucLen & 0x0F);
+            for (ucCount = pDatum->Datum.Bits.ucLen >> 4; ucCount > 0;
+                 ucCount--) {
+                bitstring_set_octet(
+                    &TempBits, ucCount - 1,
+                    pDatum->Datum.Bits.ucStore[ucCount - 1]);
+            }
+            iLen = encode_context_bitstring(apdu, ucTag, &TempBits);
+            break;
+        case TL_TYPE_NULL:
+            iLen = encode_context_null(apdu, ucTag);
+            break;
+        case TL_TYPE_ERROR:
+        default:
+            iLen = encode_opening_tag(apdu, TL_TYPE_ERROR - 1);
+            iLen += encode_application_enumerated(
+                &apdu[iLen], pDatum->Datum.Error.usClass);
+            iLen += encode_application_enumerated(
+                &apdu[iLen], pDatum->Datum.Error.usCode);
+            iLen += encode_closing_tag(&apdu[iLen], TL_TYPE_ERROR - 1);
+            break;
+    }
+
+    return iLen;
+}
+
+/**
+ * @brief Encode a record of the log buffer as a BACnetLogMultipleRecord
+ * @param apdu - buffer for the encoded record
+ * @param pObject - object with valid data
+ * @param uiEntry - BACnet 1 based position of the record, oldest first
+ * @return number of bytes encoded
+ */
+static int TLM_encode_entry(
+    uint8_t *apdu, const struct object_data *pObject, uint32_t uiEntry)
+{
+    const TLM_DATA_REC *pSource;
+    const TLM_DATUM *pValues;
+    BACNET_BIT_STRING TempBits;
+    BACNET_DATE_TIME TempTime;
+    uint32_t uiPosition;
+    uint8_t ucCount;
+    int iLen = 0;
+
+    uiPosition = TLM_Position(pObject, uiEntry);
+    pSource = &pObject->Records[uiPosition];
+    /* First stick the time stamp in with tag [0] */
+    datetime_since_epoch_seconds(&TempTime, pSource->tTimeStamp);
+    iLen += bacapp_encode_context_datetime(apdu, 0, &TempTime);
+    /* Next comes the log-data with tag [1] */
+    iLen += encode_opening_tag(&apdu[iLen], 1);
+    switch (pSource->ucRecType) {
+        case TLM_TYPE_STATUS:
+            bitstring_init(&TempBits);
+            bitstring_set_bits_used(&TempBits, 1, 5);
+            bitstring_set_octet(&TempBits, 0, pSource->Datum.ucLogStatus);
+            iLen += encode_context_bitstring(
+                &apdu[iLen], TLM_TYPE_STATUS, &TempBits);
+            break;
+        case TLM_TYPE_DATA:
+            iLen += encode_opening_tag(&apdu[iLen], TLM_TYPE_DATA);
+            pValues = NULL;
+            if (pObject->Values) {
+                pValues = &pObject->Values
+                               [(size_t)uiPosition * pObject->Member_Count];
+            }
+            for (ucCount = 0; pValues && (ucCount < pSource->ucCount);
+                 ucCount++) {
+                iLen += TLM_encode_datum(&apdu[iLen], &pValues[ucCount]);
+            }
+            iLen += encode_closing_tag(&apdu[iLen], TLM_TYPE_DATA);
+            break;
+        case TLM_TYPE_DELTA:
+            iLen += encode_context_real(
+                &apdu[iLen], TLM_TYPE_DELTA, pSource->Datum.fTime);
+            break;
+        default:
+            break;
+    }
+    iLen += encode_closing_tag(&apdu[iLen], 1);
+
+    return iLen;
+}
+
+/**
+ * @brief Encode the records of the log buffer, oldest first, until the
+ *  count is met, the end of the log is reached, or there is no more space,
+ *  and set the result flags and item count of the request.
+ * @param apdu - buffer for the encoded records
+ * @param pRequest - ReadRange request being answered
+ * @param pObject - object with valid data
+ * @param uiIndex - BACnet 1 based position of the first record to encode
+ * @param uiCount - number of records requested
+ * @return number of bytes encoded
+ */
+static int TLM_encode_entries(
+    uint8_t *apdu,
+    BACNET_READ_RANGE_DATA *pRequest,
+    const struct object_data *pObject,
+    uint32_t uiIndex,
+    uint32_t uiCount)
+{
+    int iLen = 0;
+    int iTemp = 0;
+    uint32_t uiLast = 0;
+    uint32_t uiTarget = 0;
+    uint32_t uiRemaining = 0;
+    uint32_t uiMaxEnc = 0;
+
+    uiRemaining = rr_ack_apdu_max(pRequest) - pRequest->Overhead;
+    uiTarget = pObject->Record_Count;
+    if (uiCount < (uiTarget - uiIndex + 1)) {
+        uiTarget = uiIndex + uiCount - 1;
+    }
+    if (uiIndex == 1) {
+        bitstring_set_bit(&pRequest->ResultFlags, RESULT_FLAG_FIRST_ITEM, true);
+    }
+    uiMaxEnc =
+        TLM_MAX_ENC_RECORD + (TLM_MAX_ENC_DATUM * pObject->Member_Count);
+    while (uiIndex <= uiTarget) {
+        if (uiRemaining < uiMaxEnc) {
+            bitstring_set_bit(
+                &pRequest->ResultFlags, RESULT_FLAG_MORE_ITEMS, true);
+            break;
+        }
+        iTemp = TLM_encode_entry(&apdu[iLen], pObject, uiIndex);
+        uiRemaining -= iTemp;
+        iLen += iTemp;
+        uiLast = uiIndex;
+        uiIndex++;
+        pRequest->ItemCount++;
+    }
+    if (uiLast == pObject->Record_Count) {
+        bitstring_set_bit(&pRequest->ResultFlags, RESULT_FLAG_LAST_ITEM, true);
+    }
+
+    return iLen;
+}
+
+/**
+ * @brief Find the first record with a timestamp after, or at or after,
+ *  the reference time, bisecting the records in their oldest first order
+ * @param pObject - object with valid data
+ * @param tRefTime - reference time in epoch seconds
+ * @param bAfter - true to pass over the records at the reference time
+ * @return BACnet 1 based position of the record, or one past the newest
+ *  record if there is none
+ */
+static uint32_t TLM_Search_Time(
+    const struct object_data *pObject, bacnet_time_t tRefTime, bool bAfter)
+{
+    uint32_t uiLow = 1;
+    uint32_t uiHigh = pObject->Record_Count + 1;
+    uint32_t uiMiddle = 0;
+    bacnet_time_t tStamp = 0;
+
+    while (uiLow < uiHigh) {
+        uiMiddle = uiLow + ((uiHigh - uiLow) / 2);
+        tStamp = pObject->Records[TLM_Position(pObject, uiMiddle)].tTimeStamp;
+        if ((tStamp < tRefTime) || (bAfter && (tStamp == tRefTime))) {
+            uiLow = uiMiddle + 1;
+        } else {
+            uiHigh = uiMiddle;
+        }
+    }
+
+    return uiLow;
+}
+
+/**
+ * @brief Encode the records of the log buffer that were asked for by
+ *  position, by sequence number or by time in a ReadRange request
+ * @param apdu - buffer for the encoded records
+ * @param pRequest - ReadRange request being answered
+ * @return number of bytes encoded
+ */
+int Trend_Log_Multiple_Read_Range(
+    uint8_t *apdu, BACNET_READ_RANGE_DATA *pRequest)
+{
+    const struct object_data *pObject;
+    uint32_t uiIndex = 0;
+    uint32_t uiCount = 0;
+    int64_t llFirst = 0;
+    int64_t llBegin = 0;
+    int64_t llEnd = 0;
+
+    bitstring_init(&pRequest->ResultFlags);
+    bitstring_set_bit(&pRequest->ResultFlags, RESULT_FLAG_FIRST_ITEM, false);
+    bitstring_set_bit(&pRequest->ResultFlags, RESULT_FLAG_LAST_ITEM, false);
+    bitstring_set_bit(&pRequest->ResultFlags, RESULT_FLAG_MORE_ITEMS, false);
+    pRequest->ItemCount = 0;
+    pObject = Keylist_Data(Object_List, pRequest->object_instance);
+    if (!pObject || (pObject->Record_Count == 0)) {
+        return 0;
+    }
+    if (pRequest->RequestType == RR_READ_ALL) {
+        pRequest->Range.RefIndex = 1;
+        pRequest->Count = (int32_t)pObject->Record_Count;
+        pRequest->RequestType = RR_BY_POSITION;
+    }
+    if (pRequest->RequestType == RR_BY_POSITION) {
+        uiIndex = pRequest->Range.RefIndex;
+        if ((uiIndex == 0) || (uiIndex > pObject->Record_Count)) {
+            return 0;
+        }
+        if (pRequest->Count < 0) {
+            uiCount = 0U - (uint32_t)pRequest->Count;
+            if (uiCount > uiIndex) {
+                uiCount = uiIndex;
+            }
+            uiIndex = uiIndex - uiCount + 1;
+        } else {
+            uiCount = (uint32_t)pRequest->Count;
+        }
+    } else if (pRequest->RequestType == RR_BY_SEQUENCE) {
+        /* the sequence numbers of the records in the log buffer, taken
+           as not wrapping, which would take 2^32 records */
+        llFirst = (int64_t)pObject->Total_Record_Count -
+            pObject->Record_Count + 1;
+        if (pRequest->Count < 0) {
+            llEnd = pRequest->Range.RefSeqNum;
+            llBegin = llEnd + pRequest->Count + 1;
+        } else {
+            llBegin = pRequest->Range.RefSeqNum;
+            llEnd = llBegin + pRequest->Count - 1;
+        }
+        if (llBegin < llFirst) {
+            llBegin = llFirst;
+        }
+        if (llEnd > (int64_t)pObject->Total_Record_Count) {
+            llEnd = pObject->Total_Record_Count;
+        }
+        if (llBegin > llEnd) {
+            return 0;
+        }
+        pRequest->FirstSequence = (uint32_t)llBegin;
+        return TLM_encode_entries(
+            apdu, pRequest, pObject, (uint32_t)(llBegin - llFirst + 1),
+            (uint32_t)(llEnd - llBegin + 1));
+    } else {
+        if (pRequest->Count < 0) {
+            /* the last record before the reference time is the end */
+            uiIndex = TLM_Search_Time(
+                          pObject,
+                          datetime_seconds_since_epoch(
+                              &pRequest->Range.RefTime),
+                          false) -
+                1;
+            if (uiIndex == 0) {
+                return 0;
+            }
+            uiCount = 0U - (uint32_t)pRequest->Count;
+            if (uiCount > uiIndex) {
+                uiCount = uiIndex;
+            }
+            uiIndex = uiIndex - uiCount + 1;
+        } else {
+            /* the first record after the reference time is the start */
+            uiIndex = TLM_Search_Time(
+                pObject,
+                datetime_seconds_since_epoch(&pRequest->Range.RefTime), true);
+            if (uiIndex > pObject->Record_Count) {
+                return 0;
+            }
+            uiCount = (uint32_t)pRequest->Count;
+        }
+        pRequest->Count = (int32_t)uiCount;
+        pRequest->FirstSequence = pObject->Total_Record_Count -
+            (pObject->Record_Count - uiIndex);
+    }
+
+    return TLM_encode_entries(apdu, pRequest, pObject, uiIndex, uiCount);
+}
+
+/**
+ * @brief Get the ReadRange handler of a property of this object
+ * @param pRequest - ReadRange request, including the error response
+ * @param pInfo - the request types and handler of the property
+ * @return true if the property can be read with ReadRange
+ */
+bool Trend_Log_Multiple_Read_Range_Info(
+    BACNET_READ_RANGE_DATA *pRequest, RR_PROP_INFO *pInfo)
+{
+    if (!Trend_Log_Multiple_Valid_Instance(pRequest->object_instance)) {
+        pRequest->error_class = ERROR_CLASS_OBJECT;
+        pRequest->error_code = ERROR_CODE_UNKNOWN_OBJECT;
+    } else if (pRequest->object_property == PROP_LOG_BUFFER) {
+        pInfo->RequestTypes = RR_BY_POSITION | RR_BY_TIME | RR_BY_SEQUENCE;
+        pInfo->Handler = Trend_Log_Multiple_Read_Range;
+        return true;
+    } else {
+        pRequest->error_class = ERROR_CLASS_SERVICES;
+        pRequest->error_code = ERROR_CODE_PROPERTY_IS_NOT_A_LIST;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Release the log buffer of an object and the object itself
+ * @param pObject - object with valid data
+ */
+static void TLM_Free(struct object_data *pObject)
+{
+    free(pObject->Records);
+    free(pObject->Values);
+    free(pObject);
+}
+
+/**
+ * Creates a Trend Log Multiple object, disabled, polled every 15 minutes
+ * and without any properties to log
+ * @param object_instance - object-instance number of the object
+ * @return object_instance if the object is created, else BACNET_MAX_INSTANCE
+ */
+uint32_t Trend_Log_Multiple_Create(uint32_t object_instance)
+{
+    struct object_data *pObject = NULL;
+    int index = 0;
+
+    if (object_instance > BACNET_MAX_INSTANCE) {
+        return BACNET_MAX_INSTANCE;
+    } else if (object_instance == BACNET_MAX_INSTANCE) {
+        /* wildcard instance */
+        /* the Object_Identifier property of the newly created object
+            shall be initialized to a value that is unique within the
+            responding BACnet-user device. The method used to generate
+            the object identifier is a local matter.*/
+        object_instance = Keylist_Next_Empty_Key(Object_List, 1);
+    }
+    pObject = Keylist_Data(Object_List, object_instance);
+    if (!pObject) {
+        pObject = calloc(1, sizeof(struct object_data));
+        if (!pObject) {
+            return BACNET_MAX_INSTANCE;
+        }
+        pObject->Records =
+            calloc(TREND_LOG_MULTIPLE_BUFFER_SIZE, sizeof(TLM_DATA_REC));
+        if (!pObject->Records) {
+            free(pObject);
+            return BACNET_MAX_INSTANCE;
+        }
+        pObject->Buffer_Size = TREND_LOG_MULTIPLE_BUFFER_SIZE;
+        pObject->Logging_Type = LOGGING_TYPE_POLLED;
+        pObject->Log_Interval = 900;
+        /* add to list */
+        index = Keylist_Data_Add(Object_List, object_instance, pObject);
+        if (index < 0) {
+            TLM_Free(pObject);
+            return BACNET_MAX_INSTANCE;
+        }
+        if (Object_Changed_Callback) {
+            Object_Changed_Callback(
+                OBJECT_TREND_LOG_MULTIPLE, object_instance,
+                OBJECT_CHANGE_CREATED);
+        }
+    }
+
+    return object_instance;
+}
+
+/**
+ * Deletes a Trend Log Multiple object
+ * @param object_instance - object-instance number of the object
+ * @return true if the object is deleted
+ */
+bool Trend_Log_Multiple_Delete(uint32_t object_instance)
+{
+    bool status = false;
+    struct object_data *pObject = NULL;
+
+    pObject = Keylist_Data_Delete(Object_List, object_instance);
+    if (pObject) {
+        TLM_Free(pObject);
+        status = true;
+        if (Object_Changed_Callback) {
+            Object_Changed_Callback(
+                OBJECT_TREND_LOG_MULTIPLE, object_instance,
+                OBJECT_CHANGE_DELETED);
+        }
+    }
+
+    return status;
+}
+
+/**
+ * @brief Sets the function that is called when an object is created,
+ *  deleted or renamed, so that the Device object does not poll for them
+ * @param  cb - function to call, or NULL to stop calling
+ * @return the OBJECT_CHANGE_x changes that are reported
+ */
+unsigned Trend_Log_Multiple_Changed_Callback_Set(object_changed_function cb)
+{
+    Object_Changed_Callback = cb;
+
+    return OBJECT_CHANGE_CREATED | OBJECT_CHANGE_DELETED | OBJECT_CHANGE_NAME;
+}
+
+/**
+ * Deletes all the Trend Log Multiple objects and their data
+ */
+void Trend_Log_Multiple_Cleanup(void)
+{
+    struct object_data *pObject;
+
+    if (Object_List) {
+        do {
+            pObject = Keylist_Data_Pop(Object_List);
+            if (pObject) {
+                TLM_Free(pObject);
+            }
+        } while (pObject);
+        Keylist_Delete(Object_List);
+        Object_List = NULL;
+    }
+}
+
+/**
+ * Initializes the Trend Log Multiple object data
+ */
+void Trend_Log_Multiple_Init(void)
+{
+    if (!Object_List) {
+        Object_List = Keylist_Create();
+    }
+}
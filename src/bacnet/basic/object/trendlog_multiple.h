@@ -0,0 +1,188 @@
+/**
+ * @file
+ * @author agent <agent@local>
+ * @date October 2026
+ * @brief API for a basic Trend Log Multiple object implementation.
+ * @copyright SPDX-License-Identifier: MIT
+ *
+ * A Trend Log Multiple logs a set of properties, of this device or of
+ * other devices, together in each record of its log buffer. The members
+ * of this device are read when a record is started; the members of other
+ * devices are handed to an acquisition engine with
+ * Trend_Log_Multiple_Remote_Requests() and their values are returned with
+ * Trend_Log_Multiple_Remote_Value(). The record is added to the log buffer
+ * once every member has a value or an error.
+ */
+#ifndef BACNET_BASIC_OBJECT_TRENDLOG_MULTIPLE_H
+#define BACNET_BASIC_OBJECT_TRENDLOG_MULTIPLE_H
+#include <stdbool.h>
+#include <stdint.h>
+/* BACnet Stack defines - first */
+#include "bacnet/bacdef.h"
+/* BACnet Stack API */
+#include "bacnet/bacapp.h"
+#include "bacnet/bacdevobjpropref.h"
+#include "bacnet/readrange.h"
+#include "bacnet/rp.h"
+#include "bacnet/wp.h"
+#include "bacnet/basic/object/device.h"
+#include "bacnet/basic/object/trendlog.h"
+
+/* number of properties that a Trend Log Multiple can log */
+#ifndef TREND_LOG_MULTIPLE_MEMBERS_MAX
+#define TREND_LOG_MULTIPLE_MEMBERS_MAX 32
+#endif
+
+/* records in the log buffer of a new Trend Log Multiple */
+#ifndef TREND_LOG_MULTIPLE_BUFFER_SIZE
+#define TREND_LOG_MULTIPLE_BUFFER_SIZE 100
+#endif
+
+/*
+ * Types of BACnetLogMultipleRecord. They are also the tag numbers to use
+ * when encoding the log-data field.
+ */
+#define TLM_TYPE_STATUS 0
+#define TLM_TYPE_DATA 1
+#define TLM_TYPE_DELTA 2
+
+/* Value of one member in a record, with a TL_TYPE_ type */
+typedef struct tlm_datum {
+    uint8_t ucRecType;
+    union {
+        uint8_t ucBoolean;
+        float fReal;
+        uint32_t ulEnum;
+        uint32_t ulUValue;
+        int32_t lSValue;
+        TL_BITS Bits;
+        TL_ERROR Error;
+    } Datum;
+} TLM_DATUM;
+
+/* Record of a Trend Log Multiple. The values of a TLM_TYPE_DATA record
+   are kept apart, one for each member of the log. */
+typedef struct tlm_data_record {
+    bacnet_time_t tTimeStamp;
+    uint8_t ucRecType; /* TLM_TYPE_ of the record */
+    uint8_t ucCount; /* Number of values of a TLM_TYPE_DATA record */
+    union {
+        uint8_t ucLogStatus; /* Change of log state flags */
+        float fTime; /* Interval value for change of time - seconds */
+    } Datum;
+} TLM_DATA_REC;
+
+/**
+ * @brief Called for each property of another device that a Trend Log
+ *  Multiple is waiting for
+ * @param device_id - device instance of the property
+ * @param object_id - object of the property
+ * @param property - property identifier
+ * @param array_index - array index of the property, or BACNET_ARRAY_ALL
+ * @return true if the value will be returned with
+ *  Trend_Log_Multiple_Remote_Value(), or false to be asked again later
+ */
+typedef bool (*trend_log_multiple_request_function)(
+    uint32_t device_id,
+    const BACNET_OBJECT_ID *object_id,
+    BACNET_PROPERTY_ID property,
+    BACNET_ARRAY_INDEX array_index);
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+BACNET_STACK_EXPORT
+void Trend_Log_Multiple_Property_Lists(
+    const int **pRequired, const int **pOptional, const int **pProprietary);
+BACNET_STACK_EXPORT
+bool Trend_Log_Multiple_Valid_Instance(uint32_t object_instance);
+BACNET_STACK_EXPORT
+unsigned Trend_Log_Multiple_Count(void);
+BACNET_STACK_EXPORT
+uint32_t Trend_Log_Multiple_Index_To_Instance(unsigned index);
+BACNET_STACK_EXPORT
+unsigned Trend_Log_Multiple_Instance_To_Index(uint32_t instance);
+
+BACNET_STACK_EXPORT
+bool Trend_Log_Multiple_Object_Name(
+    uint32_t object_instance, BACNET_CHARACTER_STRING *object_name);
+BACNET_STACK_EXPORT
+bool Trend_Log_Multiple_Name_Set(uint32_t object_instance, const char *value);
+BACNET_STACK_EXPORT
+const char *Trend_Log_Multiple_Description(uint32_t object_instance);
+BACNET_STACK_EXPORT
+bool Trend_Log_Multiple_Description_Set(
+    uint32_t object_instance, const char *value);
+
+BACNET_STACK_EXPORT
+bool Trend_Log_Multiple_Enable(uint32_t object_instance);
+BACNET_STACK_EXPORT
+bool Trend_Log_Multiple_Enable_Set(uint32_t object_instance, bool value);
+BACNET_STACK_EXPORT
+uint32_t Trend_Log_Multiple_Log_Interval(uint32_t object_instance);
+BACNET_STACK_EXPORT
+bool Trend_Log_Multiple_Log_Interval_Set(
+    uint32_t object_instance, uint32_t seconds);
+BACNET_STACK_EXPORT
+unsigned Trend_Log_Multiple_Member_Count(uint32_t object_instance);
+BACNET_STACK_EXPORT
+bool Trend_Log_Multiple_Member(
+    uint32_t object_instance,
+    unsigned index,
+    BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE *value);
+BACNET_STACK_EXPORT
+bool Trend_Log_Multiple_Member_Add(
+    uint32_t object_instance,
+    const BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE *value);
+BACNET_STACK_EXPORT
+void Trend_Log_Multiple_Member_Clear(uint32_t object_instance);
+BACNET_STACK_EXPORT
+uint32_t Trend_Log_Multiple_Buffer_Size(uint32_t object_instance);
+BACNET_STACK_EXPORT
+bool Trend_Log_Multiple_Buffer_Size_Set(
+    uint32_t object_instance, uint32_t buffer_size);
+BACNET_STACK_EXPORT
+uint32_t Trend_Log_Multiple_Record_Count(uint32_t object_instance);
+BACNET_STACK_EXPORT
+uint32_t Trend_Log_Multiple_Total_Record_Count(uint32_t object_instance);
+BACNET_STACK_EXPORT
+bool Trend_Log_Multiple_Trigger(uint32_t object_instance);
+
+BACNET_STACK_EXPORT
+int Trend_Log_Multiple_Read_Property(BACNET_READ_PROPERTY_DATA *rpdata);
+BACNET_STACK_EXPORT
+bool Trend_Log_Multiple_Write_Property(BACNET_WRITE_PROPERTY_DATA *wp_data);
+BACNET_STACK_EXPORT
+bool Trend_Log_Multiple_Read_Range_Info(
+    BACNET_READ_RANGE_DATA *pRequest, RR_PROP_INFO *pInfo);
+BACNET_STACK_EXPORT
+int Trend_Log_Multiple_Read_Range(
+    uint8_t *apdu, BACNET_READ_RANGE_DATA *pRequest);
+
+BACNET_STACK_EXPORT
+void Trend_Log_Multiple_Timer(uint32_t object_instance, uint16_t milliseconds);
+BACNET_STACK_EXPORT
+unsigned Trend_Log_Multiple_Remote_Requests(
+    trend_log_multiple_request_function callback);
+BACNET_STACK_EXPORT
+void Trend_Log_Multiple_Remote_Value(
+    uint32_t device_id,
+    BACNET_READ_PROPERTY_DATA *rp_data,
+    BACNET_APPLICATION_DATA_VALUE *value);
+
+BACNET_STACK_EXPORT
+uint32_t Trend_Log_Multiple_Create(uint32_t object_instance);
+BACNET_STACK_EXPORT
+bool Trend_Log_Multiple_Delete(uint32_t object_instance);
+BACNET_STACK_EXPORT
+unsigned Trend_Log_Multiple_Changed_Callback_Set(object_changed_function cb);
+BACNET_STACK_EXPORT
+void Trend_Log_Multiple_Cleanup(void);
+BACNET_STACK_EXPORT
+void Trend_Log_Multiple_Init(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif
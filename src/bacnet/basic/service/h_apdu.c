@@ -25,6 +25,14 @@
 static uint16_t Timeout_Milliseconds = 3000;
 /* Number of APDU Retries */
 static uint8_t Number_Of_Retries = 3;
+#if BACNET_SEGMENTATION_ENABLED
+/* APDU Segment Timeout in Milliseconds */
+static uint16_t Segment_Timeout_Milliseconds = 2000;
+/* Number of segments we accept or send in one segmented message */
+static uint8_t Max_Segments_Accepted = BACNET_SEGMENTATION_MAX_SEGMENTS;
+/* Number of segments we propose or accept before a Segment-ACK */
+static uint8_t Segment_Window_Size = BACNET_SEGMENTATION_WINDOW_SIZE;
+#endif
 static uint8_t Local_Network_Priority; /* Fixing test 10.1.2 Network priority */
 
 /* a simple table for crossing the services supported */
@@ -492,6 +500,76 @@ void apdu_retries_set(uint8_t value)
     Number_Of_Retries = value;
 }
 
+#if BACNET_SEGMENTATION_ENABLED
+/**
+ * @brief Get the APDU Segment Timeout
+ * @return the segment timeout in milliseconds
+ */
+uint16_t apdu_segment_timeout(void)
+{
+    return Segment_Timeout_Milliseconds;
+}
+
+/**
+ * @brief Set the APDU Segment Timeout
+ * @param milliseconds - the segment timeout in milliseconds
+ */
+void apdu_segment_timeout_set(uint16_t milliseconds)
+{
+    Segment_Timeout_Milliseconds = milliseconds;
+}
+
+/**
+ * @brief Get the maximum number of segments in one segmented message
+ * @return the number of segments accepted
+ */
+uint8_t apdu_max_segments_accepted(void)
+{
+    return Max_Segments_Accepted;
+}
+
+/**
+ * @brief Set the maximum number of segments in one segmented message,
+ *  limited to the BACNET_SEGMENTATION_MAX_SEGMENTS budget.
+ * @param value - the number of segments accepted, 2 or more
+ */
+void apdu_max_segments_accepted_set(uint8_t value)
+{
+    if (value > BACNET_SEGMENTATION_MAX_SEGMENTS) {
+        value = BACNET_SEGMENTATION_MAX_SEGMENTS;
+    }
+    if (value < 2) {
+        value = 2;
+    }
+    Max_Segments_Accepted = value;
+}
+
+/**
+ * @brief Get the segment window size that we propose when sending
+ *  segments and accept when receiving segments
+ * @return the window size, 1..127
+ */
+uint8_t apdu_segment_window_size(void)
+{
+    return Segment_Window_Size;
+}
+
+/**
+ * @brief Set the segment window size
+ * @param value - the window size, limited to 1..127
+ */
+void apdu_segment_window_size_set(uint8_t value)
+{
+    if (value > 127) {
+        value = 127;
+    }
+    if (value < 1) {
+        value = 1;
+    }
+    Segment_Window_Size = value;
+}
+#endif
+
 /* When network communications are completely disabled,
    only DeviceCommunicationControl and ReinitializeDevice APDUs
    shall be processed and no messages shall be initiated.
@@ -637,6 +715,19 @@ void apdu_handler(
                 }
             }
             break;
+        case PDU_TYPE_SEGMENT_ACK:
+#if BACNET_SEGMENTATION_ENABLED
+            if (apdu_len < 4) {
+                break;
+            }
+            /* the TSM matches the source address and invoke ID
+               against its segmented transactions */
+            tsm_segment_ack_handler(
+                src, apdu[1], apdu[2], apdu[3],
+                (apdu[0] & BIT(1)) ? true : false,
+                (apdu[0] & BIT(0)) ? true : false);
+#endif
+            break;
 #if !BACNET_SVC_SERVER
         case PDU_TYPE_SIMPLE_ACK:
             if (apdu_len < 3) {
@@ -649,7 +740,7 @@ void apdu_handler(
                     Confirmed_ACK_Function[service_choice].simple(
                         src, invoke_id);
                 }
-                tsm_free_invoke_id(invoke_id);
+                tsm_free_invoke_id(src, invoke_id);
             }
             break;
         case PDU_TYPE_COMPLEX_ACK:
@@ -662,11 +753,22 @@ void apdu_handler(
             invoke_id = service_ack_data.invoke_id = apdu[1];
             len = 2;
             if (service_ack_data.segmented_message) {
+#if BACNET_SEGMENTATION_ENABLED
+                /* the TSM acknowledges the segments, and gives us
+                   the whole Complex-ACK after the final segment */
+                apdu_len = tsm_segmented_complex_ack_handler(
+                    src, apdu, apdu_len, &apdu);
+                if (apdu_len < 3) {
+                    break;
+                }
+                service_ack_data.more_follows = false;
+#else
                 if (apdu_len < 5) {
                     break;
                 }
                 service_ack_data.sequence_number = apdu[len++];
                 service_ack_data.proposed_window_number = apdu[len++];
+#endif
             }
             service_choice = apdu[len++];
             /* prepare the service request buffer and length */
@@ -681,14 +783,9 @@ void apdu_handler(
                             &service_ack_data);
                     }
                 }
-                tsm_free_invoke_id(invoke_id);
+                tsm_free_invoke_id(src, invoke_id);
             }
             break;
-        case PDU_TYPE_SEGMENT_ACK:
-            /* FIXME: what about a denial of service attack here?
-                we could check src to see if that matched the tsm */
-            tsm_free_invoke_id(invoke_id);
-            break;
         case PDU_TYPE_ERROR:
             if (apdu_len < 3) {
                 break;
@@ -714,7 +811,7 @@ void apdu_handler(
                         (BACNET_ERROR_CODE)error_code);
                 }
             }
-            tsm_free_invoke_id(invoke_id);
+            tsm_free_invoke_id(src, invoke_id);
             break;
         case PDU_TYPE_REJECT:
             if (apdu_len < 3) {
@@ -725,7 +822,7 @@ void apdu_handler(
             if (Reject_Function) {
                 Reject_Function(src, invoke_id, reason);
             }
-            tsm_free_invoke_id(invoke_id);
+            tsm_free_invoke_id(src, invoke_id);
             break;
         case PDU_TYPE_ABORT:
             if (apdu_len < 3) {
@@ -737,7 +834,14 @@ void apdu_handler(
             if (Abort_Function) {
                 Abort_Function(src, invoke_id, reason, server);
             }
-            tsm_free_invoke_id(invoke_id);
+#if BACNET_SEGMENTATION_ENABLED
+            if (!server) {
+                /* the client gave up on our segmented response */
+                tsm_segmented_response_abort(src, invoke_id);
+                break;
+            }
+#endif
+            tsm_free_invoke_id(src, invoke_id);
             break;
 #endif
         default:
@@ -155,6 +155,20 @@ BACNET_STACK_EXPORT
 uint8_t apdu_retries(void);
 BACNET_STACK_EXPORT
 void apdu_retries_set(uint8_t value);
+#if BACNET_SEGMENTATION_ENABLED
+BACNET_STACK_EXPORT
+uint16_t apdu_segment_timeout(void);
+BACNET_STACK_EXPORT
+void apdu_segment_timeout_set(uint16_t milliseconds);
+BACNET_STACK_EXPORT
+uint8_t apdu_max_segments_accepted(void);
+BACNET_STACK_EXPORT
+void apdu_max_segments_accepted_set(uint8_t value);
+BACNET_STACK_EXPORT
+uint8_t apdu_segment_window_size(void);
+BACNET_STACK_EXPORT
+void apdu_segment_window_size_set(uint8_t value);
+#endif
 
 BACNET_STACK_EXPORT
 void apdu_handler(
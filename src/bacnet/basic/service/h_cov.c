@@ -8,7 +8,9 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 #include <errno.h>
 /* BACnet Stack defines - first */
 #include "bacnet/bacdef.h"
@@ -38,6 +40,10 @@
 typedef struct BACnet_COV_Address {
     bool valid : 1;
     BACNET_ADDRESS dest;
+    /* number of subscriptions that use this address */
+    unsigned ref_count;
+    /* next address in the same hash bucket, or in the free list */
+    unsigned next;
 } BACNET_COV_ADDRESS;
 
 /* note: This COV service only monitors the properties
@@ -46,6 +52,10 @@ typedef struct BACnet_COV_Subscription_Flags {
     bool valid : 1;
     bool issueConfirmedNotifications : 1; /* optional */
     bool send_requested : 1;
+    /* in the list of subscriptions with a notification to send or free */
+    bool pending : 1;
+    /* the monitored object is polled for changes */
+    bool polled : 1;
 } BACNET_COV_SUBSCRIPTION_FLAGS;
 
 typedef struct BACnet_COV_Subscription {
@@ -53,18 +63,74 @@ typedef struct BACnet_COV_Subscription {
     unsigned dest_index;
     uint8_t invokeID; /* for confirmed COV */
     uint32_t subscriberProcessIdentifier;
-    uint32_t lifetime; /* optional */
+    uint32_t lifetime; /* optional, 0=indefinite */
     BACNET_OBJECT_ID monitoredObjectIdentifier;
+    /* value of COV_Seconds when a definite lifetime expires */
+    uint32_t expires;
+    /* next subscription in the same monitored object bucket,
+       or in the free list */
+    unsigned next;
+    /* next subscription in the same subscriber key bucket */
+    unsigned next_key;
+    /* subscriptions that expire in the same timer wheel slot */
+    unsigned timer_prev;
+    unsigned timer_next;
 } BACNET_COV_SUBSCRIPTION;
 
-#ifndef MAX_COV_SUBCRIPTIONS
-#define MAX_COV_SUBCRIPTIONS 128
+/* end of list, or not in a list */
+#define COV_NONE UINT_MAX
+
+static BACNET_COV_SUBSCRIPTION
+    COV_Subscriptions_Default[MAX_COV_SUBCRIPTIONS];
+static BACNET_COV_SUBSCRIPTION *COV_Subscriptions = COV_Subscriptions_Default;
+static unsigned COV_Subscriptions_Size = MAX_COV_SUBCRIPTIONS;
+static unsigned COV_Subscriptions_Free;
+static BACNET_COV_ADDRESS COV_Addresses_Default[MAX_COV_ADDRESSES];
+static BACNET_COV_ADDRESS *COV_Addresses = COV_Addresses_Default;
+static unsigned COV_Addresses_Size = MAX_COV_ADDRESSES;
+static unsigned COV_Addresses_Free;
+/* addresses by hash, one bucket for each address */
+static unsigned COV_Address_Buckets_Default[MAX_COV_ADDRESSES];
+static unsigned *COV_Address_Buckets = COV_Address_Buckets_Default;
+/* subscriptions by monitored object, and by subscriber key */
+#ifndef BACNET_COV_OBJECT_BUCKETS
+#define BACNET_COV_OBJECT_BUCKETS 64
+#endif
+static unsigned COV_Object_Buckets_Default[BACNET_COV_OBJECT_BUCKETS];
+static unsigned *COV_Object_Buckets = COV_Object_Buckets_Default;
+static unsigned COV_Key_Buckets_Default[BACNET_COV_OBJECT_BUCKETS];
+static unsigned *COV_Key_Buckets = COV_Key_Buckets_Default;
+static unsigned COV_Buckets_Size = BACNET_COV_OBJECT_BUCKETS;
+/* subscriptions with a notification to send, or a confirmation to free */
+static unsigned COV_Pending_Default[MAX_COV_SUBCRIPTIONS];
+static unsigned *COV_Pending = COV_Pending_Default;
+static unsigned COV_Pending_Count;
+/* valid subscriptions that are polled for changes */
+static unsigned COV_Polled_Count;
+/* subscriptions with a definite lifetime, by the second they expire */
+#ifndef BACNET_COV_TIMER_SLOTS
+#define BACNET_COV_TIMER_SLOTS 256
 #endif
-static BACNET_COV_SUBSCRIPTION COV_Subscriptions[MAX_COV_SUBCRIPTIONS];
-#ifndef MAX_COV_ADDRESSES
-#define MAX_COV_ADDRESSES 16
+static unsigned COV_Timer_Wheel[BACNET_COV_TIMER_SLOTS];
+static uint32_t COV_Seconds;
+/* objects that have changed, from handler_cov_change_notify() */
+#ifndef BACNET_COV_CHANGE_QUEUE_SIZE
+#define BACNET_COV_CHANGE_QUEUE_SIZE 32
 #endif
-static BACNET_COV_ADDRESS COV_Addresses[MAX_COV_ADDRESSES];
+static BACNET_OBJECT_ID COV_Change_Queue[BACNET_COV_CHANGE_QUEUE_SIZE];
+static unsigned COV_Change_Head;
+static unsigned COV_Change_Count;
+/* changes were lost, so poll every subscription once */
+static bool COV_Change_Overflow;
+/* object types that call handler_cov_change_notify() */
+static uint8_t COV_Change_Notify_Types[(MAX_BACNET_OBJECT_TYPE + 7) / 8];
+/* list of values of one object, encoded once for all of its subscribers */
+static uint8_t COV_Values_Buffer[MAX_APDU];
+static unsigned COV_Values_Len;
+static BACNET_OBJECT_ID COV_Values_Object;
+static bool COV_Values_Valid;
+/* the lists were initialized by handler_cov_init() */
+static bool COV_Initialized;
 
 /**
  * Gets the address from the list of COV addresses
@@ -78,7 +144,7 @@ static BACNET_ADDRESS *cov_address_get(unsigned index)
 {
     BACNET_ADDRESS *cov_dest = NULL;
 
-    if (index < MAX_COV_ADDRESSES) {
+    if (index < COV_Addresses_Size) {
         if (COV_Addresses[index].valid) {
             cov_dest = &COV_Addresses[index].dest;
         }
@@ -88,34 +154,99 @@ static BACNET_ADDRESS *cov_address_get(unsigned index)
 }
 
 /**
- * Removes the address from the list of COV addresses, if it is not
- * used by other COV subscriptions
+ * @brief Free the transaction of a confirmed notification to a subscriber
+ * @param pSub - subscription that may be waiting for a confirmation
+ */
+static void cov_invoke_id_free(BACNET_COV_SUBSCRIPTION *pSub)
+{
+    if (pSub->invokeID) {
+        tsm_free_invoke_id(cov_address_get(pSub->dest_index), pSub->invokeID);
+        pSub->invokeID = 0;
+    }
+}
+
+/**
+ * @brief Get the hash bucket of a COV address, using the same fields
+ *  that are compared by bacnet_address_same()
+ * @param  dest - address to hash
+ * @return bucket index
+ */
+static unsigned cov_address_bucket(const BACNET_ADDRESS *dest)
+{
+    uint32_t hash = 2166136261UL;
+    uint8_t i = 0;
+
+    for (i = 0; (i < dest->mac_len) && (i < MAX_MAC_LEN); i++) {
+        hash = (hash ^ dest->mac[i]) * 16777619UL;
+    }
+    hash = (hash ^ dest->net) * 16777619UL;
+    if (dest->net) {
+        for (i = 0; (i < dest->len) && (i < MAX_MAC_LEN); i++) {
+            hash = (hash ^ dest->adr[i]) * 16777619UL;
+        }
+    }
+
+    return (unsigned)(hash % COV_Addresses_Size);
+}
+
+/**
+ * Finds the address in the list of COV addresses
+ *
+ * @param  dest - address to be found
+ *
+ * @return index number 0..N, or -1 if not found
  */
-static void cov_address_remove_unused(void)
+static int cov_address_find(const BACNET_ADDRESS *dest)
 {
     unsigned index = 0;
-    unsigned cov_index = 0;
-    bool found = false;
 
-    for (cov_index = 0; cov_index < MAX_COV_ADDRESSES; cov_index++) {
-        if (COV_Addresses[cov_index].valid) {
-            found = false;
-            for (index = 0; index < MAX_COV_SUBCRIPTIONS; index++) {
-                if ((COV_Subscriptions[index].flag.valid) &&
-                    (COV_Subscriptions[index].dest_index == cov_index)) {
-                    found = true;
-                    break;
-                }
-            }
-            if (!found) {
-                COV_Addresses[cov_index].valid = false;
-            }
+    index = COV_Address_Buckets[cov_address_bucket(dest)];
+    while (index != COV_NONE) {
+        if (bacnet_address_same(dest, &COV_Addresses[index].dest)) {
+            return (int)index;
         }
+        index = COV_Addresses[index].next;
     }
+
+    return -1;
 }
 
 /**
- * Adds the address to the list of COV addresses
+ * Releases a subscription reference to the address, and removes the
+ * address from the list of COV addresses when it is no longer used
+ *
+ * @param  index - offset into COV address list where address is stored
+ */
+static void cov_address_release(unsigned index)
+{
+    BACNET_COV_ADDRESS *cov_address = NULL;
+    unsigned *link = NULL;
+
+    if (!cov_address_get(index)) {
+        return;
+    }
+    cov_address = &COV_Addresses[index];
+    if (cov_address->ref_count > 1) {
+        cov_address->ref_count--;
+        return;
+    }
+    link = &COV_Address_Buckets[cov_address_bucket(&cov_address->dest)];
+    while (*link != COV_NONE) {
+        if (*link == index) {
+            *link = cov_address->next;
+            break;
+        }
+        link = &COV_Addresses[*link].next;
+    }
+    cov_address->valid = false;
+    cov_address->ref_count = 0;
+    cov_address->next = COV_Addresses_Free;
+    COV_Addresses_Free = index;
+}
+
+/**
+ * Adds a subscription reference to the address in the list of
+ * COV addresses, adding the address if it is not already in the list
  *
  * @param  dest - address to be added if there is room in the list
  *
@@ -124,41 +255,47 @@ static void cov_address_remove_unused(void)
 static int cov_address_add(const BACNET_ADDRESS *dest)
 {
     int index = -1;
-    unsigned i = 0;
-    bool found = false;
-    bool valid = false;
-    BACNET_ADDRESS *cov_dest = NULL;
+    unsigned bucket = 0;
+    BACNET_COV_ADDRESS *cov_address = NULL;
 
     if (dest) {
-        for (i = 0; i < MAX_COV_ADDRESSES; i++) {
-            valid = COV_Addresses[i].valid;
-            if (valid) {
-                cov_dest = &COV_Addresses[i].dest;
-                found = bacnet_address_same(dest, cov_dest);
-                if (found) {
-                    index = i;
-                    break;
-                }
-            }
+        index = cov_address_find(dest);
+        if ((index < 0) && (COV_Addresses_Free != COV_NONE)) {
+            /* take a free place to add a new address */
+            index = (int)COV_Addresses_Free;
+            cov_address = &COV_Addresses[index];
+            COV_Addresses_Free = cov_address->next;
+            bacnet_address_copy(&cov_address->dest, dest);
+            cov_address->valid = true;
+            cov_address->ref_count = 0;
+            bucket = cov_address_bucket(dest);
+            cov_address->next = COV_Address_Buckets[bucket];
+            COV_Address_Buckets[bucket] = (unsigned)index;
         }
-        if (!found) {
-            /* find a free place to add a new address */
-            for (i = 0; i < MAX_COV_ADDRESSES; i++) {
-                valid = COV_Addresses[i].valid;
-                if (!valid) {
-                    index = i;
-                    cov_dest = &COV_Addresses[i].dest;
-                    bacnet_address_copy(cov_dest, dest);
-                    COV_Addresses[i].valid = true;
-                    break;
-                }
-            }
+        if (index >= 0) {
+            COV_Addresses[index].ref_count++;
         }
     }
 
     return index;
 }
 
+/**
+ * @brief Get the time remaining in the lifetime of a subscription
+ * @param  cov_subscription - subscription
+ * @return seconds remaining, or 0 for an indefinite lifetime
+ */
+static uint32_t
+cov_time_remaining(const BACNET_COV_SUBSCRIPTION *cov_subscription)
+{
+    if ((cov_subscription->lifetime) &&
+        (cov_subscription->expires > COV_Seconds)) {
+        return cov_subscription->expires - COV_Seconds;
+    }
+
+    return 0;
+}
+
 /*
 BACnetCOVSubscription ::= SEQUENCE {
 Recipient [0] BACnetRecipientProcess,
@@ -259,8 +396,8 @@ static int cov_encode_subscription(
         &apdu[apdu_len], 2, cov_subscription->flag.issueConfirmedNotifications);
     apdu_len += len;
     /* TimeRemaining [3] Unsigned, */
-    len =
-        encode_context_unsigned(&apdu[apdu_len], 3, cov_subscription->lifetime);
+    len = encode_context_unsigned(
+        &apdu[apdu_len], 3, cov_time_remaining(cov_subscription));
     apdu_len += len;
 
     return apdu_len;
@@ -290,7 +427,7 @@ int handler_cov_encode_subscriptions(uint8_t *apdu, int max_apdu)
         unsigned index = 0;
         int apdu_len = 0;
 
-        for (index = 0; index < MAX_COV_SUBCRIPTIONS; index++) {
+        for (index = 0; index < COV_Subscriptions_Size; index++) {
             if (COV_Subscriptions[index].flag.valid) {
                 /* Lets encode a COV subscription into an intermediate buffer
                  * that can hold it */
@@ -314,6 +451,358 @@ int handler_cov_encode_subscriptions(uint8_t *apdu, int max_apdu)
     return 0;
 }
 
+/**
+ * @brief Get the bucket of subscriptions for a monitored object
+ * @param object_type - object type of the monitored object
+ * @param object_instance - object instance of the monitored object
+ * @return bucket index
+ */
+static unsigned
+cov_object_bucket(BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+    uint32_t hash;
+
+    hash = ((uint32_t)object_type * 31UL) + object_instance;
+
+    return (unsigned)(hash % COV_Buckets_Size);
+}
+
+/**
+ * @brief Get the bucket of subscriptions for a subscriber and object
+ * @param object_id - monitored object
+ * @param process_id - subscriber process identifier
+ * @param dest_index - subscriber address index
+ * @return bucket index
+ */
+static unsigned cov_key_bucket(
+    const BACNET_OBJECT_ID *object_id,
+    uint32_t process_id,
+    unsigned dest_index)
+{
+    uint32_t hash;
+
+    hash = ((uint32_t)object_id->type * 31UL) + object_id->instance;
+    hash = (hash * 2654435761UL) ^ process_id;
+    hash = (hash * 2654435761UL) ^ (uint32_t)dest_index;
+
+    return (unsigned)(hash % COV_Buckets_Size);
+}
+
+/**
+ * @brief Determine if an object type is polled for changes
+ * @param object_type - object type
+ * @return true if the object type does not call handler_cov_change_notify()
+ */
+static bool cov_object_type_polled(BACNET_OBJECT_TYPE object_type)
+{
+    if (object_type < MAX_BACNET_OBJECT_TYPE) {
+        if (COV_Change_Notify_Types[object_type / 8] &
+            (1 << (object_type % 8))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Add a valid subscription to the monitored object index
+ *  and to the subscriber key index
+ * @param index - subscription index
+ */
+static void cov_index_add(unsigned index)
+{
+    BACNET_COV_SUBSCRIPTION *pSub = &COV_Subscriptions[index];
+    unsigned bucket;
+
+    bucket = cov_object_bucket(
+        pSub->monitoredObjectIdentifier.type,
+        pSub->monitoredObjectIdentifier.instance);
+    pSub->next = COV_Object_Buckets[bucket];
+    COV_Object_Buckets[bucket] = index;
+    bucket = cov_key_bucket(
+        &pSub->monitoredObjectIdentifier, pSub->subscriberProcessIdentifier,
+        pSub->dest_index);
+    pSub->next_key = COV_Key_Buckets[bucket];
+    COV_Key_Buckets[bucket] = index;
+    pSub->flag.polled =
+        cov_object_type_polled(pSub->monitoredObjectIdentifier.type);
+    if (pSub->flag.polled) {
+        COV_Polled_Count++;
+    }
+}
+
+/**
+ * @brief Remove a subscription from the monitored object index
+ *  and from the subscriber key index
+ * @param index - subscription index
+ */
+static void cov_index_remove(unsigned index)
+{
+    BACNET_COV_SUBSCRIPTION *pSub = &COV_Subscriptions[index];
+    unsigned *link;
+
+    link = &COV_Object_Buckets[cov_object_bucket(
+        pSub->monitoredObjectIdentifier.type,
+        pSub->monitoredObjectIdentifier.instance)];
+    while (*link != COV_NONE) {
+        if (*link == index) {
+            *link = pSub->next;
+            break;
+        }
+        link = &COV_Subscriptions[*link].next;
+    }
+    pSub->next = COV_NONE;
+    link = &COV_Key_Buckets[cov_key_bucket(
+        &pSub->monitoredObjectIdentifier, pSub->subscriberProcessIdentifier,
+        pSub->dest_index)];
+    while (*link != COV_NONE) {
+        if (*link == index) {
+            *link = pSub->next_key;
+            break;
+        }
+        link = &COV_Subscriptions[*link].next_key;
+    }
+    pSub->next_key = COV_NONE;
+    if (pSub->flag.polled) {
+        pSub->flag.polled = false;
+        COV_Polled_Count--;
+    }
+}
+
+/**
+ * @brief Find the subscription of a subscriber to an object
+ * @param object_id - monitored object
+ * @param process_id - subscriber process identifier
+ * @param dest_index - subscriber address index
+ * @return subscription index, or COV_NONE if not found
+ */
+static unsigned cov_index_find(
+    const BACNET_OBJECT_ID *object_id,
+    uint32_t process_id,
+    unsigned dest_index)
+{
+    BACNET_COV_SUBSCRIPTION *pSub;
+    unsigned index;
+
+    index = COV_Key_Buckets[cov_key_bucket(object_id, process_id, dest_index)];
+    while (index != COV_NONE) {
+        pSub = &COV_Subscriptions[index];
+        if ((pSub->flag.valid) && (pSub->dest_index == dest_index) &&
+            (pSub->subscriberProcessIdentifier == process_id) &&
+            (pSub->monitoredObjectIdentifier.type == object_id->type) &&
+            (pSub->monitoredObjectIdentifier.instance ==
+             object_id->instance)) {
+            break;
+        }
+        index = pSub->next_key;
+    }
+
+    return index;
+}
+
+/**
+ * @brief Start the lifetime of a subscription in the timer wheel.
+ *  Subscriptions with an indefinite lifetime are not in the timer wheel.
+ * @param index - subscription index
+ * @param lifetime - seconds until the subscription expires, 0=indefinite
+ */
+static void cov_timer_add(unsigned index, uint32_t lifetime)
+{
+    BACNET_COV_SUBSCRIPTION *pSub = &COV_Subscriptions[index];
+    unsigned slot;
+
+    pSub->lifetime = lifetime;
+    pSub->timer_prev = COV_NONE;
+    pSub->timer_next = COV_NONE;
+    if (lifetime == 0) {
+        return;
+    }
+    if (lifetime > (UINT32_MAX - COV_Seconds)) {
+        pSub->expires = UINT32_MAX;
+    } else {
+        pSub->expires = COV_Seconds + lifetime;
+    }
+    slot = pSub->expires % BACNET_COV_TIMER_SLOTS;
+    pSub->timer_next = COV_Timer_Wheel[slot];
+    if (pSub->timer_next != COV_NONE) {
+        COV_Subscriptions[pSub->timer_next].timer_prev = index;
+    }
+    COV_Timer_Wheel[slot] = index;
+}
+
+/**
+ * @brief Stop the lifetime of a subscription in the timer wheel
+ * @param index - subscription index
+ */
+static void cov_timer_remove(unsigned index)
+{
+    BACNET_COV_SUBSCRIPTION *pSub = &COV_Subscriptions[index];
+
+    if (pSub->lifetime == 0) {
+        return;
+    }
+    if (pSub->timer_prev != COV_NONE) {
+        COV_Subscriptions[pSub->timer_prev].timer_next = pSub->timer_next;
+    } else {
+        COV_Timer_Wheel[pSub->expires % BACNET_COV_TIMER_SLOTS] =
+            pSub->timer_next;
+    }
+    if (pSub->timer_next != COV_NONE) {
+        COV_Subscriptions[pSub->timer_next].timer_prev = pSub->timer_prev;
+    }
+    pSub->timer_prev = COV_NONE;
+    pSub->timer_next = COV_NONE;
+    pSub->lifetime = 0;
+}
+
+/**
+ * @brief Remove a subscription, and return it to the free list.
+ *  A subscription that is still in the pending list is skipped there.
+ * @param index - subscription index
+ */
+static void cov_subscription_remove(unsigned index)
+{
+    BACNET_COV_SUBSCRIPTION *pSub = &COV_Subscriptions[index];
+
+    if (!pSub->flag.valid) {
+        return;
+    }
+    cov_index_remove(index);
+    cov_timer_remove(index);
+    /* the transaction is found by the address, so free it first */
+    cov_invoke_id_free(pSub);
+    cov_address_release(pSub->dest_index);
+    /* initialize with invalid COV address */
+    pSub->dest_index = COV_Addresses_Size;
+    pSub->flag.valid = false;
+    pSub->flag.send_requested = false;
+    pSub->next = COV_Subscriptions_Free;
+    COV_Subscriptions_Free = index;
+}
+
+/**
+ * @brief Request a notification for a subscription
+ * @param index - subscription index
+ */
+static void cov_pending_add(unsigned index)
+{
+    COV_Subscriptions[index].flag.send_requested = true;
+    if (!COV_Subscriptions[index].flag.pending) {
+        COV_Subscriptions[index].flag.pending = true;
+        COV_Pending[COV_Pending_Count] = index;
+        COV_Pending_Count++;
+    }
+}
+
+/**
+ * @brief Request a notification for each subscription to an object
+ * @param object_type - object type of the monitored object
+ * @param object_instance - object instance of the monitored object
+ * @return true if the object has a subscription
+ */
+static bool
+cov_object_pending_add(BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+    BACNET_COV_SUBSCRIPTION *pSub;
+    unsigned index;
+    bool status = false;
+
+    index = COV_Object_Buckets[cov_object_bucket(object_type, object_instance)];
+    while (index != COV_NONE) {
+        pSub = &COV_Subscriptions[index];
+        if ((pSub->flag.valid) &&
+            (pSub->monitoredObjectIdentifier.type == object_type) &&
+            (pSub->monitoredObjectIdentifier.instance == object_instance)) {
+            cov_pending_add(index);
+            status = true;
+        }
+        index = pSub->next;
+    }
+
+    return status;
+}
+
+/**
+ * @brief Request notifications for the objects that have told us
+ *  that they changed
+ */
+static void cov_change_queue_process(void)
+{
+    BACNET_OBJECT_ID *object_id;
+
+    while (COV_Change_Count > 0) {
+        object_id = &COV_Change_Queue[COV_Change_Head];
+        COV_Change_Head = (COV_Change_Head + 1) % BACNET_COV_CHANGE_QUEUE_SIZE;
+        COV_Change_Count--;
+        if (!cov_object_pending_add(
+                (BACNET_OBJECT_TYPE)object_id->type, object_id->instance)) {
+            /* nobody is listening, so clear the flag to hear again */
+            Device_COV_Clear(
+                (BACNET_OBJECT_TYPE)object_id->type, object_id->instance);
+        }
+    }
+}
+
+/**
+ * @brief Called by an object when its COV flag is set. The subscriptions
+ *  to the object are notified by handler_cov_fsm() without polling.
+ * @param object_type - object type of the object that changed
+ * @param object_instance - object instance of the object that changed
+ */
+void handler_cov_change_notify(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+    unsigned tail;
+
+    if (COV_Change_Count < BACNET_COV_CHANGE_QUEUE_SIZE) {
+        tail = (COV_Change_Head + COV_Change_Count) %
+            BACNET_COV_CHANGE_QUEUE_SIZE;
+        COV_Change_Queue[tail].type = object_type;
+        COV_Change_Queue[tail].instance = object_instance;
+        COV_Change_Count++;
+    } else {
+        COV_Change_Overflow = true;
+    }
+}
+
+/**
+ * @brief Set whether the objects of a type call handler_cov_change_notify()
+ *  when they change. Subscriptions to other object types are polled.
+ * @param object_type - object type
+ * @param enable - true if the object type calls handler_cov_change_notify()
+ */
+void handler_cov_change_notify_type_set(
+    BACNET_OBJECT_TYPE object_type, bool enable)
+{
+    unsigned index;
+    bool polled;
+
+    if (object_type >= MAX_BACNET_OBJECT_TYPE) {
+        return;
+    }
+    if (enable) {
+        COV_Change_Notify_Types[object_type / 8] |= (1 << (object_type % 8));
+    } else {
+        COV_Change_Notify_Types[object_type / 8] &=
+            (uint8_t)~(1 << (object_type % 8));
+    }
+    polled = !enable;
+    for (index = 0; index < COV_Subscriptions_Size; index++) {
+        if ((COV_Subscriptions[index].flag.valid) &&
+            (COV_Subscriptions[index].monitoredObjectIdentifier.type ==
+             object_type) &&
+            (COV_Subscriptions[index].flag.polled != polled)) {
+            COV_Subscriptions[index].flag.polled = polled;
+            if (polled) {
+                COV_Polled_Count++;
+            } else {
+                COV_Polled_Count--;
+            }
+        }
+    }
+}
+
 /** Handler to initialize the COV list, clearing and disabling each entry.
  * @ingroup DSCOV
  */
@@ -321,10 +810,10 @@ void handler_cov_init(void)
 {
     unsigned index = 0;
 
-    for (index = 0; index < MAX_COV_SUBCRIPTIONS; index++) {
+    for (index = 0; index < COV_Subscriptions_Size; index++) {
         /* initialize with invalid COV address */
         COV_Subscriptions[index].flag.valid = false;
-        COV_Subscriptions[index].dest_index = MAX_COV_ADDRESSES;
+        COV_Subscriptions[index].dest_index = COV_Addresses_Size;
         COV_Subscriptions[index].subscriberProcessIdentifier = 0;
         COV_Subscriptions[index].monitoredObjectIdentifier.type =
             OBJECT_ANALOG_INPUT;
@@ -332,11 +821,149 @@ void handler_cov_init(void)
         COV_Subscriptions[index].flag.issueConfirmedNotifications = false;
         COV_Subscriptions[index].invokeID = 0;
         COV_Subscriptions[index].lifetime = 0;
+        COV_Subscriptions[index].expires = 0;
         COV_Subscriptions[index].flag.send_requested = false;
+        COV_Subscriptions[index].flag.pending = false;
+        COV_Subscriptions[index].flag.polled = false;
+        COV_Subscriptions[index].next_key = COV_NONE;
+        COV_Subscriptions[index].timer_prev = COV_NONE;
+        COV_Subscriptions[index].timer_next = COV_NONE;
+        /* free list in index order */
+        if ((index + 1) < COV_Subscriptions_Size) {
+            COV_Subscriptions[index].next = index + 1;
+        } else {
+            COV_Subscriptions[index].next = COV_NONE;
+        }
     }
-    for (index = 0; index < MAX_COV_ADDRESSES; index++) {
+    COV_Subscriptions_Free = 0;
+    for (index = 0; index < COV_Addresses_Size; index++) {
         COV_Addresses[index].valid = false;
+        COV_Addresses[index].ref_count = 0;
+        if ((index + 1) < COV_Addresses_Size) {
+            COV_Addresses[index].next = index + 1;
+        } else {
+            COV_Addresses[index].next = COV_NONE;
+        }
+        COV_Address_Buckets[index] = COV_NONE;
+    }
+    COV_Addresses_Free = 0;
+    for (index = 0; index < COV_Buckets_Size; index++) {
+        COV_Object_Buckets[index] = COV_NONE;
+        COV_Key_Buckets[index] = COV_NONE;
     }
+    for (index = 0; index < BACNET_COV_TIMER_SLOTS; index++) {
+        COV_Timer_Wheel[index] = COV_NONE;
+    }
+    COV_Seconds = 0;
+    COV_Pending_Count = 0;
+    COV_Polled_Count = 0;
+    COV_Change_Head = 0;
+    COV_Change_Count = 0;
+    COV_Change_Overflow = false;
+    COV_Values_Valid = false;
+    COV_Initialized = true;
+}
+
+/** Initialize the lists if they are used before handler_cov_init(). */
+static void cov_init_check(void)
+{
+    if (!COV_Initialized) {
+        handler_cov_init();
+    }
+}
+
+/** Set the number of COV subscriptions and subscriber addresses.
+ * @ingroup DSCOV
+ *  The default tables hold MAX_COV_SUBCRIPTIONS and MAX_COV_ADDRESSES.
+ *  Other sizes are allocated from the heap. The subscriptions are
+ *  cleared, as with handler_cov_init().
+ *
+ * @param subscriptions - number of subscriptions, greater than zero
+ * @param addresses - number of subscriber addresses, greater than zero
+ * @return true if the tables were resized
+ */
+bool handler_cov_size_set(unsigned subscriptions, unsigned addresses)
+{
+    BACNET_COV_SUBSCRIPTION *list = COV_Subscriptions_Default;
+    unsigned *pending = COV_Pending_Default;
+    unsigned *object_buckets = COV_Object_Buckets_Default;
+    unsigned *key_buckets = COV_Key_Buckets_Default;
+    unsigned buckets = BACNET_COV_OBJECT_BUCKETS;
+    BACNET_COV_ADDRESS *address_list = COV_Addresses_Default;
+    unsigned *address_buckets = COV_Address_Buckets_Default;
+    unsigned index = 0;
+
+    if ((subscriptions == 0) || (subscriptions >= COV_NONE) ||
+        (addresses == 0) || (addresses >= COV_NONE)) {
+        return false;
+    }
+    if (subscriptions != MAX_COV_SUBCRIPTIONS) {
+        /* one bucket per subscription keeps the chains short */
+        buckets = subscriptions;
+        list = calloc(subscriptions, sizeof(BACNET_COV_SUBSCRIPTION));
+        pending = calloc(subscriptions, sizeof(unsigned));
+        object_buckets = calloc(buckets, sizeof(unsigned));
+        key_buckets = calloc(buckets, sizeof(unsigned));
+        if (!list || !pending || !object_buckets || !key_buckets) {
+            free(list);
+            free(pending);
+            free(object_buckets);
+            free(key_buckets);
+            return false;
+        }
+    }
+    if (addresses != MAX_COV_ADDRESSES) {
+        address_list = calloc(addresses, sizeof(BACNET_COV_ADDRESS));
+        address_buckets = calloc(addresses, sizeof(unsigned));
+        if (!address_list || !address_buckets) {
+            free(address_list);
+            free(address_buckets);
+            if (list != COV_Subscriptions_Default) {
+                free(list);
+                free(pending);
+                free(object_buckets);
+                free(key_buckets);
+            }
+            return false;
+        }
+    }
+    /* the old subscriptions no longer wait for confirmations */
+    for (index = 0; index < COV_Subscriptions_Size; index++) {
+        if (COV_Subscriptions[index].flag.valid) {
+            cov_invoke_id_free(&COV_Subscriptions[index]);
+        }
+    }
+    if (COV_Subscriptions != COV_Subscriptions_Default) {
+        free(COV_Subscriptions);
+        free(COV_Pending);
+        free(COV_Object_Buckets);
+        free(COV_Key_Buckets);
+    }
+    if (COV_Addresses != COV_Addresses_Default) {
+        free(COV_Addresses);
+        free(COV_Address_Buckets);
+    }
+    COV_Subscriptions = list;
+    COV_Subscriptions_Size = subscriptions;
+    COV_Pending = pending;
+    COV_Object_Buckets = object_buckets;
+    COV_Key_Buckets = key_buckets;
+    COV_Buckets_Size = buckets;
+    COV_Addresses = address_list;
+    COV_Addresses_Size = addresses;
+    COV_Address_Buckets = address_buckets;
+    handler_cov_init();
+
+    return true;
+}
+
+/** Get the number of COV subscriptions in the table.
+ * @ingroup DSCOV
+ * @return number of subscriptions
+ */
+unsigned handler_cov_size(void)
+{
+    return COV_Subscriptions_Size;
 }
 
 static bool cov_list_subscribe(
@@ -345,105 +972,122 @@ static bool cov_list_subscribe(
     BACNET_ERROR_CLASS *error_class,
     BACNET_ERROR_CODE *error_code)
 {
-    bool existing_entry = false;
-    int index;
-    int first_invalid_index = -1;
+    BACNET_COV_SUBSCRIPTION *pSub = NULL;
+    unsigned index = COV_NONE;
+    int dest_index = -1;
     bool found = true;
-    bool address_match = false;
-    const BACNET_ADDRESS *dest = NULL;
-
-    /* unable to subscribe - resources? */
-    /* unable to cancel subscription - other? */
 
+    cov_init_check();
     /* existing? - match Object ID and Process ID and address */
-    for (index = 0; index < MAX_COV_SUBCRIPTIONS; index++) {
-        if (COV_Subscriptions[index].flag.valid) {
-            dest = cov_address_get(COV_Subscriptions[index].dest_index);
-            if (dest) {
-                address_match = bacnet_address_same(src, dest);
-            } else {
-                /* skip address matching - we don't have an address */
-                address_match = true;
-            }
-            if ((COV_Subscriptions[index].monitoredObjectIdentifier.type ==
-                 cov_data->monitoredObjectIdentifier.type) &&
-                (COV_Subscriptions[index].monitoredObjectIdentifier.instance ==
-                 cov_data->monitoredObjectIdentifier.instance) &&
-                (COV_Subscriptions[index].subscriberProcessIdentifier ==
-                 cov_data->subscriberProcessIdentifier) &&
-                address_match) {
-                existing_entry = true;
-                if (cov_data->cancellationRequest) {
-                    /* initialize with invalid COV address */
-                    COV_Subscriptions[index].flag.valid = false;
-                    COV_Subscriptions[index].dest_index = MAX_COV_ADDRESSES;
-                    cov_address_remove_unused();
-                } else {
-                    COV_Subscriptions[index].dest_index = cov_address_add(src);
-                    COV_Subscriptions[index].flag.issueConfirmedNotifications =
-                        cov_data->issueConfirmedNotifications;
-                    COV_Subscriptions[index].lifetime = cov_data->lifetime;
-                    COV_Subscriptions[index].flag.send_requested = true;
-                }
-                if (COV_Subscriptions[index].invokeID) {
-                    tsm_free_invoke_id(COV_Subscriptions[index].invokeID);
-                    COV_Subscriptions[index].invokeID = 0;
-                }
-                break;
-            }
+    dest_index = cov_address_find(src);
+    if (dest_index >= 0) {
+        index = cov_index_find(
+            &cov_data->monitoredObjectIdentifier,
+            cov_data->subscriberProcessIdentifier, (unsigned)dest_index);
+    }
+    if (index != COV_NONE) {
+        pSub = &COV_Subscriptions[index];
+        if (cov_data->cancellationRequest) {
+            cov_subscription_remove(index);
         } else {
-            if (first_invalid_index < 0) {
-                first_invalid_index = index;
-            }
+            pSub->flag.issueConfirmedNotifications =
+                cov_data->issueConfirmedNotifications;
+            cov_timer_remove(index);
+            cov_timer_add(index, cov_data->lifetime);
+            cov_invoke_id_free(pSub);
+            cov_pending_add(index);
         }
-    }
-    if (!existing_entry && (first_invalid_index >= 0) &&
-        (!cov_data->cancellationRequest)) {
-        const int addr_add_ret = cov_address_add(src);
-
-        if (addr_add_ret < 0) {
+    } else if (cov_data->cancellationRequest) {
+        /* cancellationRequest - valid object not subscribed */
+        /* From BACnet Standard 135-2010-13.14.2
+           ...Cancellations that are issued for which no matching COV
+           context can be found shall succeed as if a context had
+           existed, returning 'Result(+)'. */
+        found = true;
+    } else if (COV_Subscriptions_Free == COV_NONE) {
+        /* Out of resources */
+        *error_class = ERROR_CLASS_RESOURCES;
+        *error_code = ERROR_CODE_NO_SPACE_TO_ADD_LIST_ELEMENT;
+        found = false;
+    } else {
+        dest_index = cov_address_add(src);
+        if (dest_index < 0) {
             *error_class = ERROR_CLASS_RESOURCES;
             *error_code = ERROR_CODE_NO_SPACE_TO_ADD_LIST_ELEMENT;
             found = false;
         } else {
-            index = first_invalid_index;
-            found = true;
-            COV_Subscriptions[index].dest_index = addr_add_ret;
-            COV_Subscriptions[index].flag.valid = true;
-            COV_Subscriptions[index].monitoredObjectIdentifier.type =
+            index = COV_Subscriptions_Free;
+            pSub = &COV_Subscriptions[index];
+            COV_Subscriptions_Free = pSub->next;
+            pSub->dest_index = (unsigned)dest_index;
+            pSub->flag.valid = true;
+            pSub->monitoredObjectIdentifier.type =
                 cov_data->monitoredObjectIdentifier.type;
-            COV_Subscriptions[index].monitoredObjectIdentifier.instance =
+            pSub->monitoredObjectIdentifier.instance =
                 cov_data->monitoredObjectIdentifier.instance;
-            COV_Subscriptions[index].subscriberProcessIdentifier =
+            pSub->subscriberProcessIdentifier =
                 cov_data->subscriberProcessIdentifier;
-            COV_Subscriptions[index].flag.issueConfirmedNotifications =
+            pSub->flag.issueConfirmedNotifications =
                 cov_data->issueConfirmedNotifications;
-            COV_Subscriptions[index].invokeID = 0;
-            COV_Subscriptions[index].lifetime = cov_data->lifetime;
-            COV_Subscriptions[index].flag.send_requested = true;
-        }
-    } else if (!existing_entry) {
-        if (first_invalid_index < 0) {
-            /* Out of resources */
-            *error_class = ERROR_CLASS_RESOURCES;
-            *error_code = ERROR_CODE_NO_SPACE_TO_ADD_LIST_ELEMENT;
-            found = false;
-        } else {
-            /* cancellationRequest - valid object not subscribed */
-            /* From BACnet Standard 135-2010-13.14.2
-               ...Cancellations that are issued for which no matching COV
-               context can be found shall succeed as if a context had
-               existed, returning 'Result(+)'. */
-            found = true;
+            pSub->invokeID = 0;
+            cov_timer_add(index, cov_data->lifetime);
+            cov_index_add(index);
+            cov_pending_add(index);
         }
     }
 
     return found;
 }
 
+/**
+ * @brief Encode the list of values of a monitored object, unless it is
+ *  already encoded for another subscriber in this cycle
+ * @param object_type - object type of the monitored object
+ * @param object_instance - object instance of the monitored object
+ * @return true if the list of values is encoded in COV_Values_Buffer
+ */
+static bool
+cov_values_encode(BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+    BACNET_PROPERTY_VALUE value_list[MAX_COV_PROPERTIES];
+    int len = 0;
+
+    if (COV_Values_Valid && (COV_Values_Object.type == object_type) &&
+        (COV_Values_Object.instance == object_instance)) {
+        return true;
+    }
+    COV_Values_Valid = false;
+    /* configure the linked list for the two properties */
+    bacapp_property_value_list_init(&value_list[0], MAX_COV_PROPERTIES);
+    if (!Device_Encode_Value_List(
+            object_type, object_instance, &value_list[0])) {
+        return false;
+    }
+    len = cov_notify_values_encode(NULL, &value_list[0]);
+    if ((len <= 0) || (len > (int)sizeof(COV_Values_Buffer))) {
+        return false;
+    }
+    COV_Values_Len = (unsigned)cov_notify_values_encode(
+        &COV_Values_Buffer[0], &value_list[0]);
+    COV_Values_Object.type = object_type;
+    COV_Values_Object.instance = object_instance;
+    COV_Values_Valid = true;
+
+    return true;
+}
+
+/**
+ * @brief Send a COV notification to a subscriber, using the list of values
+ *  encoded by cov_values_encode()
+ * @param cov_subscription - subscription to notify
+ * @param values - encoded list of values
+ * @param values_len - number of bytes in the encoded list of values
+ * @return true if the notification was sent
+ */
 static bool cov_send_request(
     BACNET_COV_SUBSCRIPTION *cov_subscription,
-    BACNET_PROPERTY_VALUE *value_list)
+    const uint8_t *values,
+    unsigned values_len)
 {
     int len = 0;
     int pdu_len = 0;
@@ -451,6 +1095,7 @@ static bool cov_send_request(
     BACNET_ADDRESS my_address;
     int bytes_sent = 0;
     uint8_t invoke_id = 0;
+    uint8_t *pdu = &Handler_Transmit_Buffer[0];
     bool status = false; /* return value */
     BACNET_COV_DATA cov_data;
     BACNET_ADDRESS *dest = NULL;
@@ -471,10 +1116,21 @@ static bool cov_send_request(
 #endif
         return status;
     }
+    if (cov_subscription->flag.issueConfirmedNotifications) {
+        invoke_id = tsm_next_free_invokeID(dest);
+        if (!invoke_id) {
+            goto COV_FAILED;
+        }
+        cov_subscription->invokeID = invoke_id;
+        /* encode into the transaction, which keeps it for retries */
+        pdu = tsm_transaction_pdu_buffer(dest, invoke_id);
+        if (!pdu) {
+            pdu = &Handler_Transmit_Buffer[0];
+        }
+    }
     datalink_get_my_address(&my_address);
     npdu_encode_npdu_data(&npdu_data, false, MESSAGE_PRIORITY_NORMAL);
-    pdu_len = npdu_encode_pdu(
-        &Handler_Transmit_Buffer[0], dest, &my_address, &npdu_data);
+    pdu_len = npdu_encode_pdu(&pdu[0], dest, &my_address, &npdu_data);
     /* load the COV data structure for outgoing message */
     cov_data.subscriberProcessIdentifier =
         cov_subscription->subscriberProcessIdentifier;
@@ -483,33 +1139,27 @@ static bool cov_send_request(
         cov_subscription->monitoredObjectIdentifier.type;
     cov_data.monitoredObjectIdentifier.instance =
         cov_subscription->monitoredObjectIdentifier.instance;
-    cov_data.timeRemaining = cov_subscription->lifetime;
-    cov_data.listOfValues = value_list;
+    cov_data.timeRemaining = cov_time_remaining(cov_subscription);
+    cov_data.listOfValues = NULL;
     if (cov_subscription->flag.issueConfirmedNotifications) {
         npdu_data.data_expecting_reply = true;
-        invoke_id = tsm_next_free_invokeID();
-        if (invoke_id) {
-            cov_subscription->invokeID = invoke_id;
-            len = ccov_notify_encode_apdu(
-                &Handler_Transmit_Buffer[pdu_len],
-                sizeof(Handler_Transmit_Buffer) - pdu_len, invoke_id,
-                &cov_data);
-        } else {
-            goto COV_FAILED;
-        }
+        len = ccov_notify_encode_apdu_values(
+            &pdu[pdu_len], MAX_PDU - pdu_len, invoke_id, &cov_data, values,
+            values_len);
     } else {
-        len = ucov_notify_encode_apdu(
-            &Handler_Transmit_Buffer[pdu_len],
-            sizeof(Handler_Transmit_Buffer) - pdu_len, &cov_data);
+        len = ucov_notify_encode_apdu_values(
+            &pdu[pdu_len], MAX_PDU - pdu_len, &cov_data, values, values_len);
+    }
+    if (len <= 0) {
+        cov_invoke_id_free(cov_subscription);
+        goto COV_FAILED;
     }
     pdu_len += len;
     if (cov_subscription->flag.issueConfirmedNotifications) {
         tsm_set_confirmed_unsegmented_transaction(
-            invoke_id, dest, &npdu_data, &Handler_Transmit_Buffer[0],
-            (uint16_t)pdu_len);
+            invoke_id, dest, &npdu_data, &pdu[0], (uint16_t)pdu_len);
     }
-    bytes_sent = datalink_send_pdu(
-        dest, &npdu_data, &Handler_Transmit_Buffer[0], pdu_len);
+    bytes_sent = datalink_send_pdu(dest, &npdu_data, &pdu[0], pdu_len);
     if (bytes_sent > 0) {
         status = true;
 #if PRINT_ENABLED
@@ -522,99 +1172,95 @@ COV_FAILED:
     return status;
 }
 
-static void cov_lifetime_expiration_handler(
-    unsigned index, uint32_t elapsed_seconds, uint32_t lifetime_seconds)
+/**
+ * @brief Expire a subscription at the end of its lifetime
+ * @param index - subscription index
+ */
+static void cov_lifetime_expiration_handler(unsigned index)
 {
-    if (index < MAX_COV_SUBCRIPTIONS) {
-        /* handle lifetime expiration */
-        if (lifetime_seconds >= elapsed_seconds) {
-            COV_Subscriptions[index].lifetime -= elapsed_seconds;
-#if 0
-            fprintf(stderr, "COVtimer: subscription[%d].lifetime=%lu\n", index,
-                (unsigned long) COV_Subscriptions[index].lifetime);
-#endif
-        } else {
-            COV_Subscriptions[index].lifetime = 0;
-        }
-        if (COV_Subscriptions[index].lifetime == 0) {
-            /* expire the subscription */
 #if PRINT_ENABLED
-            fprintf(
-                stderr, "COVtimer: PID=%u ",
-                COV_Subscriptions[index].subscriberProcessIdentifier);
-            fprintf(
-                stderr, "%s %u ",
-                bactext_object_type_name(
-                    COV_Subscriptions[index].monitoredObjectIdentifier.type),
-                COV_Subscriptions[index].monitoredObjectIdentifier.instance);
-            fprintf(
-                stderr, "time remaining=%u seconds ",
-                COV_Subscriptions[index].lifetime);
-            fprintf(stderr, "\n");
+    fprintf(
+        stderr, "COVtimer: PID=%u ",
+        COV_Subscriptions[index].subscriberProcessIdentifier);
+    fprintf(
+        stderr, "%s %u ",
+        bactext_object_type_name(
+            COV_Subscriptions[index].monitoredObjectIdentifier.type),
+        COV_Subscriptions[index].monitoredObjectIdentifier.instance);
+    fprintf(stderr, "time remaining=0 seconds ");
+    fprintf(stderr, "\n");
 #endif
-            /* initialize with invalid COV address */
-            COV_Subscriptions[index].flag.valid = false;
-            COV_Subscriptions[index].dest_index = MAX_COV_ADDRESSES;
-            cov_address_remove_unused();
-            if (COV_Subscriptions[index].flag.issueConfirmedNotifications) {
-                if (COV_Subscriptions[index].invokeID) {
-                    tsm_free_invoke_id(COV_Subscriptions[index].invokeID);
-                    COV_Subscriptions[index].invokeID = 0;
-                }
-            }
-        }
-    }
+    cov_subscription_remove(index);
 }
 
-/** Handler to check the list of subscribed objects for any that have changed
- *  and so need to have notifications sent.
+/** Handler to expire the COV subscriptions at the end of their lifetime.
  * @ingroup DSCOV
  * This handler will be invoked by the main program every second or so.
- * This example only handles Binary Inputs, but can be easily extended to
- * support other types.
- * For each subscribed object,
- *  - See if the subscription has timed out
- *    - Remove it if it has timed out.
- *  - See if the subscribed object instance has changed
- *    (eg, check with Binary_Input_Change_Of_Value() )
- *  - If changed,
- *    - Clear the COV (eg, Binary_Input_Change_Of_Value_Clear() )
- *    - Send the notice with cov_send_request()
- *      - Will be confirmed or unconfirmed, as per the subscription.
- *
- * @note worst case tasking: MS/TP with the ability to send only
- *        one notification per task cycle.
+ * The subscriptions with a definite lifetime are kept in a timer wheel
+ * slot for the second that they expire, so only the slots for the
+ * elapsed seconds are checked, rather than every subscription.
  *
  * @param elapsed_seconds [in] How many seconds have elapsed since last called.
  */
 void handler_cov_timer_seconds(uint32_t elapsed_seconds)
 {
+    unsigned slot = 0;
+    unsigned slots = 0;
     unsigned index = 0;
-    uint32_t lifetime_seconds = 0;
+    unsigned next = 0;
 
-    if (elapsed_seconds) {
-        /* handle the subscription timeouts */
-        for (index = 0; index < MAX_COV_SUBCRIPTIONS; index++) {
-            if (COV_Subscriptions[index].flag.valid) {
-                lifetime_seconds = COV_Subscriptions[index].lifetime;
-                if (lifetime_seconds) {
-                    /* only expire COV with definite lifetimes */
-                    cov_lifetime_expiration_handler(
-                        index, elapsed_seconds, lifetime_seconds);
-                }
+    if (elapsed_seconds == 0) {
+        return;
+    }
+    cov_init_check();
+    /* the slots of the seconds that elapsed, or every slot once */
+    slot = (COV_Seconds + 1) % BACNET_COV_TIMER_SLOTS;
+    if (elapsed_seconds < BACNET_COV_TIMER_SLOTS) {
+        slots = elapsed_seconds;
+    } else {
+        slots = BACNET_COV_TIMER_SLOTS;
+    }
+    if (elapsed_seconds > (UINT32_MAX - COV_Seconds)) {
+        COV_Seconds = UINT32_MAX;
+    } else {
+        COV_Seconds += elapsed_seconds;
+    }
+    while (slots > 0) {
+        index = COV_Timer_Wheel[slot];
+        while (index != COV_NONE) {
+            next = COV_Subscriptions[index].timer_next;
+            if (COV_Subscriptions[index].expires <= COV_Seconds) {
+                /* expire the subscription */
+                cov_lifetime_expiration_handler(index);
             }
+            index = next;
         }
+        slot = (slot + 1) % BACNET_COV_TIMER_SLOTS;
+        slots--;
     }
 }
 
+/** Handler to send the COV notifications, one subscription per call.
+ * @ingroup DSCOV
+ *  - Objects that call handler_cov_change_notify() are not polled.
+ *    Only their subscriptions are marked to send a notification.
+ *  - Subscriptions to other objects are polled with Device_COV().
+ *  - Only the subscriptions that are marked are cleared, freed and sent.
+ *
+ * @param reset [in] true to start over at the beginning of a cycle
+ * @return true when the cycle is complete
+ */
 bool handler_cov_fsm(const bool reset)
 {
-    static int index = 0;
+    static unsigned index = 0;
+    /* poll every subscription in this cycle */
+    static bool poll_all = false;
+    BACNET_COV_SUBSCRIPTION *pSub = NULL;
+    const BACNET_ADDRESS *dest = NULL;
     BACNET_OBJECT_TYPE object_type = MAX_BACNET_OBJECT_TYPE;
     uint32_t object_instance = 0;
     bool status = false;
     bool send = false;
-    BACNET_PROPERTY_VALUE value_list[MAX_COV_PROPERTIES];
     /* states for transmitting */
     static enum {
         COV_STATE_IDLE = 0,
@@ -624,6 +1270,7 @@ bool handler_cov_fsm(const bool reset)
         COV_STATE_SEND
     } cov_task_state = COV_STATE_IDLE;
 
+    cov_init_check();
     if (reset) {
         index = 0;
         cov_task_state = COV_STATE_IDLE;
@@ -632,103 +1279,129 @@ bool handler_cov_fsm(const bool reset)
     switch (cov_task_state) {
         case COV_STATE_IDLE:
             index = 0;
+            cov_change_queue_process();
+            if (COV_Change_Overflow) {
+                COV_Change_Overflow = false;
+                poll_all = true;
+            }
             cov_task_state = COV_STATE_MARK;
             break;
         case COV_STATE_MARK:
-            /* mark any subscriptions where the value has changed */
-            if (COV_Subscriptions[index].flag.valid) {
-                object_type = (BACNET_OBJECT_TYPE)COV_Subscriptions[index]
-                                  .monitoredObjectIdentifier.type;
-                object_instance =
-                    COV_Subscriptions[index].monitoredObjectIdentifier.instance;
-                status = Device_COV(object_type, object_instance);
-                if (status) {
-                    COV_Subscriptions[index].flag.send_requested = true;
+            /* mark any polled subscriptions where the value has changed */
+            if ((index < COV_Subscriptions_Size) &&
+                (poll_all || (COV_Polled_Count > 0))) {
+                pSub = &COV_Subscriptions[index];
+                if ((pSub->flag.valid) && (poll_all || pSub->flag.polled)) {
+                    object_type = (BACNET_OBJECT_TYPE)
+                                      pSub->monitoredObjectIdentifier.type;
+                    object_instance = pSub->monitoredObjectIdentifier.instance;
+                    status = Device_COV(object_type, object_instance);
+                    if (status && !pSub->flag.send_requested) {
+                        /* keep the subscribers to an object together,
+                           so that its values are encoded once */
+                        cov_object_pending_add(object_type, object_instance);
 #if PRINT_ENABLED
-                    fprintf(stderr, "COVtask: Marking...\n");
+                        fprintf(stderr, "COVtask: Marking...\n");
 #endif
+                    }
                 }
+                index++;
+            } else {
+                index = COV_Subscriptions_Size;
             }
-            index++;
-            if (index >= MAX_COV_SUBCRIPTIONS) {
+            if (index >= COV_Subscriptions_Size) {
                 index = 0;
+                poll_all = false;
                 cov_task_state = COV_STATE_CLEAR;
             }
             break;
         case COV_STATE_CLEAR:
             /* clear the COV flag after checking all subscriptions */
-            if ((COV_Subscriptions[index].flag.valid) &&
-                (COV_Subscriptions[index].flag.send_requested)) {
-                object_type = (BACNET_OBJECT_TYPE)COV_Subscriptions[index]
-                                  .monitoredObjectIdentifier.type;
-                object_instance =
-                    COV_Subscriptions[index].monitoredObjectIdentifier.instance;
-                Device_COV_Clear(object_type, object_instance);
+            if (index < COV_Pending_Count) {
+                pSub = &COV_Subscriptions[COV_Pending[index]];
+                if ((pSub->flag.valid) && (pSub->flag.send_requested)) {
+                    object_type = (BACNET_OBJECT_TYPE)
+                                      pSub->monitoredObjectIdentifier.type;
+                    object_instance = pSub->monitoredObjectIdentifier.instance;
+                    Device_COV_Clear(object_type, object_instance);
+                }
+                index++;
             }
-            index++;
-            if (index >= MAX_COV_SUBCRIPTIONS) {
+            if (index >= COV_Pending_Count) {
                 index = 0;
                 cov_task_state = COV_STATE_FREE;
             }
             break;
         case COV_STATE_FREE:
             /* confirmed notification house keeping */
-            if ((COV_Subscriptions[index].flag.valid) &&
-                (COV_Subscriptions[index].flag.issueConfirmedNotifications) &&
-                (COV_Subscriptions[index].invokeID)) {
-                if (tsm_invoke_id_free(COV_Subscriptions[index].invokeID)) {
-                    COV_Subscriptions[index].invokeID = 0;
-                } else if (tsm_invoke_id_failed(
-                               COV_Subscriptions[index].invokeID)) {
-                    tsm_free_invoke_id(COV_Subscriptions[index].invokeID);
-                    COV_Subscriptions[index].invokeID = 0;
+            if (index < COV_Pending_Count) {
+                pSub = &COV_Subscriptions[COV_Pending[index]];
+                if ((pSub->flag.valid) &&
+                    (pSub->flag.issueConfirmedNotifications) &&
+                    (pSub->invokeID)) {
+                    dest = cov_address_get(pSub->dest_index);
+                    if (tsm_invoke_id_free(dest, pSub->invokeID)) {
+                        pSub->invokeID = 0;
+                    } else if (tsm_invoke_id_failed(dest, pSub->invokeID)) {
+                        cov_invoke_id_free(pSub);
+                    }
                 }
+                index++;
             }
-            index++;
-            if (index >= MAX_COV_SUBCRIPTIONS) {
+            if (index >= COV_Pending_Count) {
                 index = 0;
+                /* encode the values again for this cycle */
+                COV_Values_Valid = false;
                 cov_task_state = COV_STATE_SEND;
             }
             break;
         case COV_STATE_SEND:
             /* send any COVs that are requested */
-            if ((COV_Subscriptions[index].flag.valid) &&
-                (COV_Subscriptions[index].flag.send_requested)) {
-                send = true;
-                if (COV_Subscriptions[index].flag.issueConfirmedNotifications) {
-                    if (COV_Subscriptions[index].invokeID != 0) {
-                        /* already sending */
-                        send = false;
-                    }
-                    if (!tsm_transaction_available()) {
-                        /* no transactions available - can't send now */
-                        send = false;
+            if (index < COV_Pending_Count) {
+                pSub = &COV_Subscriptions[COV_Pending[index]];
+                if ((pSub->flag.valid) && (pSub->flag.send_requested)) {
+                    send = true;
+                    if (pSub->flag.issueConfirmedNotifications) {
+                        if (pSub->invokeID != 0) {
+                            /* already sending */
+                            send = false;
+                        }
+                        if (!tsm_transaction_available()) {
+                            /* no transactions available - can't send now */
+                            send = false;
+                        }
                     }
-                }
-                if (send) {
-                    object_type = (BACNET_OBJECT_TYPE)COV_Subscriptions[index]
-                                      .monitoredObjectIdentifier.type;
-                    object_instance = COV_Subscriptions[index]
-                                          .monitoredObjectIdentifier.instance;
+                    if (send) {
+                        object_type = (BACNET_OBJECT_TYPE)
+                                          pSub->monitoredObjectIdentifier.type;
+                        object_instance =
+                            pSub->monitoredObjectIdentifier.instance;
 #if PRINT_ENABLED
-                    fprintf(stderr, "COVtask: Sending...\n");
+                        fprintf(stderr, "COVtask: Sending...\n");
 #endif
-                    /* configure the linked list for the two properties */
-                    bacapp_property_value_list_init(
-                        &value_list[0], MAX_COV_PROPERTIES);
-                    status = Device_Encode_Value_List(
-                        object_type, object_instance, &value_list[0]);
-                    if (status) {
-                        status = cov_send_request(
-                            &COV_Subscriptions[index], &value_list[0]);
-                    }
-                    if (status) {
-                        COV_Subscriptions[index].flag.send_requested = false;
+                        /* the values are encoded once for each object */
+                        status =
+                            cov_values_encode(object_type, object_instance);
+                        if (status) {
+                            status = cov_send_request(
+                                pSub, &COV_Values_Buffer[0], COV_Values_Len);
+                        }
+                        if (status) {
+                            pSub->flag.send_requested = false;
+                        }
                     }
                 }
+                if ((!pSub->flag.valid) ||
+                    ((!pSub->flag.send_requested) && (pSub->invokeID == 0))) {
+                    /* done - move the last pending subscription here */
+                    pSub->flag.pending = false;
+                    COV_Pending_Count--;
+                    COV_Pending[index] = COV_Pending[COV_Pending_Count];
+                } else {
+                    index++;
+                }
             }
-            index++;
-            if (index >= MAX_COV_SUBCRIPTIONS) {
+            if (index >= COV_Pending_Count) {
                 index = 0;
                 cov_task_state = COV_STATE_IDLE;
             }
@@ -17,6 +17,15 @@
 /* BACnet Stack API */
 #include "bacnet/apdu.h"
 
+/* default number of COV subscriptions, see handler_cov_size_set() */
+#ifndef MAX_COV_SUBCRIPTIONS
+#define MAX_COV_SUBCRIPTIONS 128
+#endif
+/* default number of COV subscriber addresses */
+#ifndef MAX_COV_ADDRESSES
+#define MAX_COV_ADDRESSES 16
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -36,7 +45,17 @@ void handler_cov_timer_seconds(uint32_t elapsed_seconds);
 BACNET_STACK_EXPORT
 void handler_cov_init(void);
 BACNET_STACK_EXPORT
+bool handler_cov_size_set(unsigned subscriptions, unsigned addresses);
+BACNET_STACK_EXPORT
+unsigned handler_cov_size(void);
+BACNET_STACK_EXPORT
 int handler_cov_encode_subscriptions(uint8_t *apdu, int max_apdu);
+BACNET_STACK_EXPORT
+void handler_cov_change_notify(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance);
+BACNET_STACK_EXPORT
+void handler_cov_change_notify_type_set(
+    BACNET_OBJECT_TYPE object_type, bool enable);
 
 #ifdef __cplusplus
 }
@@ -23,6 +23,7 @@
 #include "bacnet/datalink/datalink.h"
 
 static get_alarm_summary_function Get_Alarm_Summary[MAX_BACNET_OBJECT_TYPE];
+static get_event_active_function Get_Alarm_Active[MAX_BACNET_OBJECT_TYPE];
 
 void handler_get_alarm_summary_set(
     BACNET_OBJECT_TYPE object_type, get_alarm_summary_function pFunction)
@@ -32,6 +33,65 @@ void handler_get_alarm_summary_set(
     }
 }
 
+/**
+ * @brief Set the function that finds the objects of a type in its index
+ *  of active events, so that the other objects are not visited
+ * @param object_type - type of the objects
+ * @param pFunction - function that finds the next object with an event
+ */
+void handler_get_alarm_summary_active_set(
+    BACNET_OBJECT_TYPE object_type, get_event_active_function pFunction)
+{
+    if (object_type < MAX_BACNET_OBJECT_TYPE) {
+        Get_Alarm_Active[object_type] = pFunction;
+    }
+}
+
+/**
+ * @brief Get the alarm summary of the next object of a type that is in
+ *  alarm
+ * @param object_type - type of the objects
+ * @param cursor [in,out] object instance to start at when the type has an
+ *  index of active events, or else the object index to start at
+ * @param getalarm_data [out] the alarm summary of the object
+ * @return true if an object was found
+ */
+static bool get_alarm_summary_next(
+    unsigned object_type,
+    uint32_t *cursor,
+    BACNET_GET_ALARM_SUMMARY_DATA *getalarm_data)
+{
+    uint32_t object_instance = *cursor;
+    unsigned index = 0;
+    int alarm_value = 0;
+
+    if (Get_Alarm_Active[object_type]) {
+        /* objects in alarm are a part of the objects with active events */
+        while ((object_instance <= BACNET_MAX_INSTANCE) &&
+               Get_Alarm_Active[object_type](&object_instance, &index)) {
+            alarm_value = Get_Alarm_Summary[object_type](index, getalarm_data);
+            object_instance++;
+            if (alarm_value > 0) {
+                *cursor = object_instance;
+                return true;
+            }
+        }
+        *cursor = object_instance;
+        return false;
+    }
+    while (*cursor < 0xffff) {
+        alarm_value = Get_Alarm_Summary[object_type](*cursor, getalarm_data);
+        *cursor += 1;
+        if (alarm_value > 0) {
+            return true;
+        } else if (alarm_value < 0) {
+            break;
+        }
+    }
+
+    return false;
+}
+
 void handler_get_alarm_summary(
     uint8_t *service_request,
     uint16_t service_len,
@@ -42,9 +102,8 @@ void handler_get_alarm_summary(
     int pdu_len = 0;
     int apdu_len = 0;
     int bytes_sent = 0;
-    int alarm_value = 0;
     unsigned i = 0;
-    unsigned j = 0;
+    uint32_t cursor = 0;
     bool error = false;
     BACNET_ADDRESS my_address;
     BACNET_NPDU_DATA npdu_data;
@@ -73,22 +132,19 @@ void handler_get_alarm_summary(
         &Handler_Transmit_Buffer[pdu_len], service_data->invoke_id);
 
     for (i = 0; i < MAX_BACNET_OBJECT_TYPE; i++) {
-        if (Get_Alarm_Summary[i]) {
-            for (j = 0; j < 0xffff; j++) {
-                alarm_value = Get_Alarm_Summary[i](j, &getalarm_data);
-                if (alarm_value > 0) {
-                    len = get_alarm_summary_ack_encode_apdu_data(
-                        &Handler_Transmit_Buffer[pdu_len + apdu_len],
-                        service_data->max_resp - apdu_len, &getalarm_data);
-                    if (len <= 0) {
-                        error = true;
-                        goto GET_ALARM_SUMMARY_ERROR;
-                    } else {
-                        apdu_len += len;
-                    }
-                } else if (alarm_value < 0) {
-                    break;
-                }
+        if (!Get_Alarm_Summary[i]) {
+            continue;
+        }
+        cursor = 0;
+        while (get_alarm_summary_next(i, &cursor, &getalarm_data)) {
+            len = get_alarm_summary_ack_encode_apdu_data(
+                &Handler_Transmit_Buffer[pdu_len + apdu_len],
+                service_data->max_resp - apdu_len, &getalarm_data);
+            if (len <= 0) {
+                error = true;
+                goto GET_ALARM_SUMMARY_ERROR;
+            } else {
+                apdu_len += len;
             }
         }
     }
@@ -16,6 +16,7 @@
 /* BACnet Stack API */
 #include "bacnet/apdu.h"
 #include "bacnet/get_alarm_sum.h"
+#include "bacnet/getevent.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -24,6 +25,9 @@ extern "C" {
 BACNET_STACK_EXPORT
 void handler_get_alarm_summary_set(
     BACNET_OBJECT_TYPE object_type, get_alarm_summary_function pFunction);
+BACNET_STACK_EXPORT
+void handler_get_alarm_summary_active_set(
+    BACNET_OBJECT_TYPE object_type, get_event_active_function pFunction);
 
 BACNET_STACK_EXPORT
 void handler_get_alarm_summary(
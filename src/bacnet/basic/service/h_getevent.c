@@ -27,6 +27,7 @@
 #include "bacnet/datalink/datalink.h"
 
 static get_event_info_function Get_Event_Info[MAX_BACNET_OBJECT_TYPE];
+static get_event_active_function Get_Event_Active[MAX_BACNET_OBJECT_TYPE];
 
 /** print eventState
  */
@@ -56,6 +57,64 @@ void handler_get_event_information_set(
     }
 }
 
+/**
+ * @brief Set the function that finds the objects of a type in its index
+ *  of active events, so that the other objects are not visited
+ * @param object_type - type of the objects
+ * @param pFunction - function that finds the next object with an event
+ */
+void handler_get_event_information_active_set(
+    BACNET_OBJECT_TYPE object_type, get_event_active_function pFunction)
+{
+    if (object_type < MAX_BACNET_OBJECT_TYPE) {
+        Get_Event_Active[object_type] = pFunction;
+    }
+}
+
+/**
+ * @brief Get the event information of the next object of a type that
+ *  has an active event, or unacknowledged transitions
+ * @param object_type - type of the objects
+ * @param cursor [in,out] object instance to start at when the type has an
+ *  index of active events, or else the object index to start at
+ * @param getevent_data [out] the event information of the object
+ * @return true if an object was found
+ */
+static bool get_event_info_next(
+    unsigned object_type,
+    uint32_t *cursor,
+    BACNET_GET_EVENT_INFORMATION_DATA *getevent_data)
+{
+    uint32_t object_instance = *cursor;
+    unsigned index = 0;
+    int valid_event = 0;
+
+    if (Get_Event_Active[object_type]) {
+        while ((object_instance <= BACNET_MAX_INSTANCE) &&
+               Get_Event_Active[object_type](&object_instance, &index)) {
+            valid_event = Get_Event_Info[object_type](index, getevent_data);
+            object_instance++;
+            if (valid_event > 0) {
+                *cursor = object_instance;
+                return true;
+            }
+        }
+        *cursor = object_instance;
+        return false;
+    }
+    while (*cursor < 0xffff) {
+        valid_event = Get_Event_Info[object_type](*cursor, getevent_data);
+        *cursor += 1;
+        if (valid_event > 0) {
+            return true;
+        } else if (valid_event < 0) {
+            break;
+        }
+    }
+
+    return false;
+}
+
 void handler_get_event_information(
     uint8_t *service_request,
     uint16_t service_len,
@@ -75,9 +134,9 @@ void handler_get_event_information(
     BACNET_ERROR_CODE error_code = ERROR_CODE_UNKNOWN_OBJECT;
     BACNET_ADDRESS my_address;
     BACNET_OBJECT_ID object_id;
-    unsigned i = 0, j = 0; /* counter */
+    unsigned i = 0; /* counter */
+    uint32_t cursor = 0;
     BACNET_GET_EVENT_INFORMATION_DATA getevent_data;
-    int valid_event = 0;
 
     /* initialize type of 'Last Received Object Identifier' using max value */
     object_id.type = MAX_BACNET_OBJECT_TYPE;
@@ -122,56 +181,62 @@ void handler_get_event_information(
     }
     pdu_len += len;
     apdu_len = len;
-    for (i = 0; i < MAX_BACNET_OBJECT_TYPE; i++) {
-        if (Get_Event_Info[i]) {
-            for (j = 0; j < 0xffff; j++) {
-                valid_event = Get_Event_Info[i](j, &getevent_data);
-                if (valid_event > 0) {
-                    /* encode GetEvent_data only when type of object_id has max
-                     * value */
-                    if (object_id.type != MAX_BACNET_OBJECT_TYPE) {
-                        if ((object_id.type ==
-                             getevent_data.objectIdentifier.type) &&
-                            (object_id.instance ==
-                             getevent_data.objectIdentifier.instance)) {
-                            /* found 'Last Received Object Identifier'
-                               so should set type of object_id to max value */
-                            object_id.type = MAX_BACNET_OBJECT_TYPE;
-                        }
-                        continue;
-                    }
+    for (i = 0; (i < MAX_BACNET_OBJECT_TYPE) && !more_events; i++) {
+        if (!Get_Event_Info[i]) {
+            continue;
+        }
+        cursor = 0;
+        if (Get_Event_Active[i] && (object_id.type != MAX_BACNET_OBJECT_TYPE)) {
+            /* the index is in order of instance, so resume after the
+               'Last Received Object Identifier' even if its event is
+               no longer active */
+            if (i < object_id.type) {
+                continue;
+            }
+            if (i == object_id.type) {
+                cursor = object_id.instance + 1;
+            }
+            object_id.type = MAX_BACNET_OBJECT_TYPE;
+        }
+        while (get_event_info_next(i, &cursor, &getevent_data)) {
+            /* encode GetEvent_data only when type of object_id has max
+             * value */
+            if (object_id.type != MAX_BACNET_OBJECT_TYPE) {
+                if ((object_id.type == getevent_data.objectIdentifier.type) &&
+                    (object_id.instance ==
+                     getevent_data.objectIdentifier.instance)) {
+                    /* found 'Last Received Object Identifier'
+                       so should set type of object_id to max value */
+                    object_id.type = MAX_BACNET_OBJECT_TYPE;
+                }
+                continue;
+            }
 
-                    getevent_data.next = NULL;
-                    len = getevent_ack_encode_apdu_data(
-                        &Handler_Transmit_Buffer[pdu_len],
-                        sizeof(Handler_Transmit_Buffer) - pdu_len,
-                        &getevent_data);
-                    if (len <= 0) {
-                        error = true;
-                        goto GET_EVENT_ERROR;
-                    }
-                    apdu_len += len;
-                    if ((apdu_len >= service_data->max_resp - 2) ||
-                        (apdu_len >= MAX_APDU - 2)) {
-                        /* Device must be able to fit minimum
-                           one event information.
-                           Length of one event information needs
-                           more than 50 octets. */
-                        if ((service_data->max_resp < 128) ||
-                            (MAX_APDU < 128)) {
-                            len = BACNET_STATUS_ABORT;
-                            error = true;
-                            goto GET_EVENT_ERROR;
-                        } else {
-                            more_events = true;
-                        }
-                        break;
-                    } else {
-                        pdu_len += len;
-                    }
-                } else if (valid_event < 0) {
-                    break;
+            getevent_data.next = NULL;
+            len = getevent_ack_encode_apdu_data(
+                &Handler_Transmit_Buffer[pdu_len],
+                sizeof(Handler_Transmit_Buffer) - pdu_len, &getevent_data);
+            if (len <= 0) {
+                error = true;
+                goto GET_EVENT_ERROR;
+            }
+            apdu_len += len;
+            if ((apdu_len >= service_data->max_resp - 2) ||
+                (apdu_len >= MAX_APDU - 2)) {
+                /* Device must be able to fit minimum
+                   one event information.
+                   Length of one event information needs
+                   more than 50 octets. */
+                if ((service_data->max_resp < 128) || (MAX_APDU < 128)) {
+                    len = BACNET_STATUS_ABORT;
+                    error = true;
+                    goto GET_EVENT_ERROR;
+                } else {
+                    more_events = true;
                 }
+                break;
+            } else {
+                pdu_len += len;
             }
         }
     }
@@ -26,6 +26,9 @@ extern "C" {
 BACNET_STACK_EXPORT
 void handler_get_event_information_set(
     BACNET_OBJECT_TYPE object_type, get_event_info_function pFunction);
+BACNET_STACK_EXPORT
+void handler_get_event_information_active_set(
+    BACNET_OBJECT_TYPE object_type, get_event_active_function pFunction);
 
 BACNET_STACK_EXPORT
 void handler_get_event_information(
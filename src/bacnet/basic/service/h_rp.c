@@ -59,9 +59,11 @@ void handler_read_property(
 {
     BACNET_READ_PROPERTY_DATA rpdata;
     int len = 0;
-    int pdu_len = 0;
     int apdu_len = -1;
     int npdu_len = -1;
+    uint8_t *apdu = NULL;
+    int apdu_size = 0; /* room in the buffer */
+    int apdu_max = 0; /* largest reply the requester accepts */
     BACNET_NPDU_DATA npdu_data;
     bool error = true; /* assume that there is an error */
     int bytes_sent = 0;
@@ -74,6 +76,16 @@ void handler_read_property(
     npdu_encode_npdu_data(&npdu_data, false, service_data->priority);
     npdu_len = npdu_encode_pdu(
         &Handler_Transmit_Buffer[0], src, &my_address, &npdu_data);
+#if BACNET_SEGMENTATION_ENABLED
+    /* the TSM encodes the NPDU and segments the reply, if needed */
+    apdu = &Handler_Segmented_Buffer[0];
+    apdu_max = tsm_segmented_response_apdu_max(service_data);
+    apdu_size = apdu_max;
+#else
+    apdu = &Handler_Transmit_Buffer[npdu_len];
+    apdu_max = service_data->max_resp;
+    apdu_size = (int)sizeof(Handler_Transmit_Buffer) - npdu_len;
+#endif
     if (npdu_len <= 0) {
         /* If 0 or negative, there were problems with the data or encoding. */
         len = BACNET_STATUS_ABORT;
@@ -126,20 +138,16 @@ void handler_read_property(
             }
 #endif
             apdu_len = rp_ack_encode_apdu_init(
-                &Handler_Transmit_Buffer[npdu_len], service_data->invoke_id,
-                &rpdata);
+                &apdu[0], service_data->invoke_id, &rpdata);
             /* configure our storage */
-            rpdata.application_data =
-                &Handler_Transmit_Buffer[npdu_len + apdu_len];
-            rpdata.application_data_len =
-                sizeof(Handler_Transmit_Buffer) - (npdu_len + apdu_len);
+            rpdata.application_data = &apdu[apdu_len];
+            rpdata.application_data_len = apdu_size - apdu_len;
             len = Device_Read_Property(&rpdata);
             if (len >= 0) {
                 apdu_len += len;
-                len = rp_ack_encode_apdu_object_property_end(
-                    &Handler_Transmit_Buffer[npdu_len + apdu_len]);
+                len = rp_ack_encode_apdu_object_property_end(&apdu[apdu_len]);
                 apdu_len += len;
-                if (apdu_len > service_data->max_resp) {
+                if (apdu_len > apdu_max) {
                     /* too big for the sender - send an abort!
                        Setting of error code needed here as read property
                        processing may have overridden the default set at start
@@ -176,14 +184,14 @@ void handler_read_property(
     if (error) {
         if (len == BACNET_STATUS_ABORT) {
             apdu_len = abort_encode_apdu(
-                &Handler_Transmit_Buffer[npdu_len], service_data->invoke_id,
+                &apdu[0], service_data->invoke_id,
                 abort_convert_error_code(rpdata.error_code), true);
 #if PRINT_ENABLED
             fprintf(stderr, "RP: Sending Abort!\n");
 #endif
         } else if (len == BACNET_STATUS_ERROR) {
             apdu_len = bacerror_encode_apdu(
-                &Handler_Transmit_Buffer[npdu_len], service_data->invoke_id,
+                &apdu[0], service_data->invoke_id,
                 SERVICE_CONFIRMED_READ_PROPERTY, rpdata.error_class,
                 rpdata.error_code);
 #if PRINT_ENABLED
@@ -191,7 +199,7 @@ void handler_read_property(
 #endif
         } else if (len == BACNET_STATUS_REJECT) {
             apdu_len = reject_encode_apdu(
-                &Handler_Transmit_Buffer[npdu_len], service_data->invoke_id,
+                &apdu[0], service_data->invoke_id,
                 reject_convert_error_code(rpdata.error_code));
 #if PRINT_ENABLED
             fprintf(stderr, "RP: Sending Reject!\n");
@@ -199,9 +207,15 @@ void handler_read_property(
         }
     }
 
-    pdu_len = npdu_len + apdu_len;
+#if BACNET_SEGMENTATION_ENABLED
+    if (apdu_len > 0) {
+        bytes_sent = tsm_confirmed_reply_send(
+            src, &npdu_data, service_data, &apdu[0], (uint16_t)apdu_len);
+    }
+#else
     bytes_sent = datalink_send_pdu(
-        src, &npdu_data, &Handler_Transmit_Buffer[0], pdu_len);
+        src, &npdu_data, &Handler_Transmit_Buffer[0], npdu_len + apdu_len);
+#endif
     if (bytes_sent <= 0) {
 #if PRINT_ENABLED
         fprintf(stderr, "Failed to send PDU (%s)!\n", strerror(errno));
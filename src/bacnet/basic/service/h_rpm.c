@@ -34,7 +34,12 @@
 #include "bacnet/basic/sys/debug.h"
 #include "bacnet/datalink/datalink.h"
 
+#if BACNET_SEGMENTATION_ENABLED
+/* a single property value may need all the segments */
+static uint8_t Temp_Buf[BACNET_SEGMENTATION_APDU_MAX] = { 0 };
+#else
 static uint8_t Temp_Buf[MAX_APDU] = { 0 };
+#endif
 
 /**
  * @brief Fetches the lists of properties (array of BACNET_PROPERTY_ID's) for
@@ -211,24 +216,35 @@ void handler_read_property_multiple(
     int len = 0;
     uint16_t copy_len = 0;
     uint16_t decode_len = 0;
-    int pdu_len = 0;
     BACNET_NPDU_DATA npdu_data;
     int bytes_sent;
-    BACNET_ADDRESS my_address;
     BACNET_RPM_DATA rpmdata;
+    uint8_t *apdu = NULL;
+    uint16_t apdu_max = 0;
     int apdu_len = 0;
-    int npdu_len = 0;
     int error = 0;
+#if !BACNET_SEGMENTATION_ENABLED
+    BACNET_ADDRESS my_address;
+    int npdu_len = 0;
+#endif
 
     if (service_data && (service_len > 0)) {
         /* jps_debug - see if we are utilizing all the buffer */
         /* memset(&Handler_Transmit_Buffer[0], 0xff,
          * sizeof(Handler_Transmit_Buffer)); */
+        npdu_encode_npdu_data(&npdu_data, false, MESSAGE_PRIORITY_NORMAL);
+#if BACNET_SEGMENTATION_ENABLED
+        /* the TSM encodes the NPDU and segments the reply, if needed */
+        apdu = &Handler_Segmented_Buffer[0];
+        apdu_max = tsm_segmented_response_apdu_max(service_data);
+#else
         /* encode the NPDU portion of the packet */
         datalink_get_my_address(&my_address);
-        npdu_encode_npdu_data(&npdu_data, false, MESSAGE_PRIORITY_NORMAL);
         npdu_len = npdu_encode_pdu(
             &Handler_Transmit_Buffer[0], src, &my_address, &npdu_data);
+        apdu = &Handler_Transmit_Buffer[npdu_len];
+        apdu_max = MAX_APDU;
+#endif
 
         if (service_data->segmented_message) {
             rpmdata.error_code = ERROR_CODE_ABORT_SEGMENTATION_NOT_SUPPORTED;
@@ -238,7 +254,7 @@ void handler_read_property_multiple(
             /* decode apdu request & encode apdu reply
                encode complex ack, invoke id, service choice */
             apdu_len = rpm_ack_encode_apdu_init(
-                &Handler_Transmit_Buffer[npdu_len], service_data->invoke_id);
+                &apdu[0], service_data->invoke_id);
 
             for (;;) {
                 /* Start by looking for an object ID */
@@ -280,8 +296,8 @@ void handler_read_property_multiple(
                 /* Stick this object id into the reply - if it will fit */
                 len = rpm_ack_encode_apdu_object_begin(&Temp_Buf[0], &rpmdata);
                 copy_len = memcopy(
-                    &Handler_Transmit_Buffer[npdu_len], &Temp_Buf[0], apdu_len,
-                    len, MAX_APDU);
+                    &apdu[0], &Temp_Buf[0], apdu_len,
+                    len, apdu_max);
                 if (copy_len == 0) {
                     debug_fprintf(stderr, "RPM: Response too big!\r\n");
                     rpmdata.error_code =
@@ -320,8 +336,8 @@ void handler_read_property_multiple(
                         if (!Device_Valid_Object_Id(
                                 rpmdata.object_type, rpmdata.object_instance)) {
                             len = RPM_Encode_Property(
-                                &Handler_Transmit_Buffer[npdu_len],
-                                (uint16_t)apdu_len, MAX_APDU, &rpmdata);
+                                &apdu[0],
+                                (uint16_t)apdu_len, apdu_max, &rpmdata);
                             if (len > 0) {
                                 apdu_len += len;
                             } else {
@@ -341,8 +357,8 @@ void handler_read_property_multiple(
                                 rpmdata.array_index);
 
                             copy_len = memcopy(
-                                &Handler_Transmit_Buffer[npdu_len],
-                                &Temp_Buf[0], apdu_len, len, MAX_APDU);
+                                &apdu[0],
+                                &Temp_Buf[0], apdu_len, len, apdu_max);
 
                             if (copy_len == 0) {
                                 debug_fprintf(
@@ -362,8 +378,8 @@ void handler_read_property_multiple(
                                 ERROR_CODE_PROPERTY_IS_NOT_AN_ARRAY);
 
                             copy_len = memcopy(
-                                &Handler_Transmit_Buffer[npdu_len],
-                                &Temp_Buf[0], apdu_len, len, MAX_APDU);
+                                &apdu[0],
+                                &Temp_Buf[0], apdu_len, len, apdu_max);
 
                             if (copy_len == 0) {
                                 debug_fprintf(
@@ -398,8 +414,8 @@ void handler_read_property_multiple(
                                         rpmdata.object_type,
                                         rpmdata.object_instance)) {
                                     len = RPM_Encode_Property(
-                                        &Handler_Transmit_Buffer[npdu_len],
-                                        (uint16_t)apdu_len, MAX_APDU, &rpmdata);
+                                        &apdu[0],
+                                        (uint16_t)apdu_len, apdu_max, &rpmdata);
                                     if (len > 0) {
                                         apdu_len += len;
                                     } else {
@@ -421,8 +437,8 @@ void handler_read_property_multiple(
                                             &property_list,
                                             special_object_property, index);
                                     len = RPM_Encode_Property(
-                                        &Handler_Transmit_Buffer[npdu_len],
-                                        (uint16_t)apdu_len, MAX_APDU, &rpmdata);
+                                        &apdu[0],
+                                        (uint16_t)apdu_len, apdu_max, &rpmdata);
                                     if (len > 0) {
                                         apdu_len += len;
                                     } else {
@@ -441,8 +457,8 @@ void handler_read_property_multiple(
                     } else {
                         /* handle an individual property */
                         len = RPM_Encode_Property(
-                            &Handler_Transmit_Buffer[npdu_len],
-                            (uint16_t)apdu_len, MAX_APDU, &rpmdata);
+                            &apdu[0],
+                            (uint16_t)apdu_len, apdu_max, &rpmdata);
                         if (len > 0) {
                             apdu_len += len;
                         } else {
@@ -463,8 +479,8 @@ void handler_read_property_multiple(
                         decode_len++;
                         len = rpm_ack_encode_apdu_object_end(&Temp_Buf[0]);
                         copy_len = memcopy(
-                            &Handler_Transmit_Buffer[npdu_len], &Temp_Buf[0],
-                            apdu_len, len, MAX_APDU);
+                            &apdu[0], &Temp_Buf[0],
+                            apdu_len, len, apdu_max);
                         if (copy_len == 0) {
                             debug_fprintf(
                                 stderr,
@@ -490,6 +506,7 @@ void handler_read_property_multiple(
                 }
             } /* for(;;) */
 
+#if !BACNET_SEGMENTATION_ENABLED
             /* If not having an error so far, check the remaining space. */
             if (!berror) {
                 if (apdu_len > service_data->max_resp) {
@@ -501,32 +518,37 @@ void handler_read_property_multiple(
                         stderr, "RPM: Message too large.  Sending Abort!\n");
                 }
             }
+#endif
         }
 
         /* Error fallback. */
         if (error) {
             if (error == BACNET_STATUS_ABORT) {
                 apdu_len = abort_encode_apdu(
-                    &Handler_Transmit_Buffer[npdu_len], service_data->invoke_id,
+                    &apdu[0], service_data->invoke_id,
                     abort_convert_error_code(rpmdata.error_code), true);
                 debug_fprintf(stderr, "RPM: Sending Abort!\n");
             } else if (error == BACNET_STATUS_ERROR) {
                 apdu_len = bacerror_encode_apdu(
-                    &Handler_Transmit_Buffer[npdu_len], service_data->invoke_id,
+                    &apdu[0], service_data->invoke_id,
                     SERVICE_CONFIRMED_READ_PROP_MULTIPLE, rpmdata.error_class,
                     rpmdata.error_code);
                 debug_fprintf(stderr, "RPM: Sending Error!\n");
             } else if (error == BACNET_STATUS_REJECT) {
                 apdu_len = reject_encode_apdu(
-                    &Handler_Transmit_Buffer[npdu_len], service_data->invoke_id,
+                    &apdu[0], service_data->invoke_id,
                     reject_convert_error_code(rpmdata.error_code));
                 debug_fprintf(stderr, "RPM: Sending Reject!\n");
             }
         }
 
-        pdu_len = apdu_len + npdu_len;
+#if BACNET_SEGMENTATION_ENABLED
+        bytes_sent = tsm_confirmed_reply_send(
+            src, &npdu_data, service_data, &apdu[0], (uint16_t)apdu_len);
+#else
         bytes_sent = datalink_send_pdu(
-            src, &npdu_data, &Handler_Transmit_Buffer[0], pdu_len);
+            src, &npdu_data, &Handler_Transmit_Buffer[0], npdu_len + apdu_len);
+#endif
         if (bytes_sent <= 0) {
             debug_fprintf(
                 stderr, "RPM: Failed to send PDU (errno=%d)!\n", errno);
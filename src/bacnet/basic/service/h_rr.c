@@ -27,7 +27,11 @@
 
 /** @file h_rr.c  Handles Read Range requests. */
 
+#if BACNET_SEGMENTATION_ENABLED
+static uint8_t Temp_Buf[BACNET_SEGMENTATION_APDU_MAX] = { 0 };
+#else
 static uint8_t Temp_Buf[MAX_APDU] = { 0 };
+#endif
 
 /**
  * Encodes the property APDU and returns the length,
@@ -113,25 +117,34 @@ void handler_read_range(
 {
     BACNET_READ_RANGE_DATA data;
     int len = 0;
-    int pdu_len = 0;
+    uint8_t *apdu = NULL;
     BACNET_NPDU_DATA npdu_data;
     bool error = false;
 #if PRINT_ENABLED
     int bytes_sent = 0;
 #endif
+#if !BACNET_SEGMENTATION_ENABLED
+    int pdu_len = 0;
     BACNET_ADDRESS my_address;
+#endif
 
     data.error_class = ERROR_CLASS_OBJECT;
     data.error_code = ERROR_CODE_UNKNOWN_OBJECT;
+    npdu_encode_npdu_data(&npdu_data, false, MESSAGE_PRIORITY_NORMAL);
+#if BACNET_SEGMENTATION_ENABLED
+    /* the TSM encodes the NPDU and segments the reply, if needed */
+    apdu = &Handler_Segmented_Buffer[0];
+#else
     /* encode the NPDU portion of the packet */
     datalink_get_my_address(&my_address);
-    npdu_encode_npdu_data(&npdu_data, false, MESSAGE_PRIORITY_NORMAL);
     pdu_len = npdu_encode_pdu(
         &Handler_Transmit_Buffer[0], src, &my_address, &npdu_data);
+    apdu = &Handler_Transmit_Buffer[pdu_len];
+#endif
     if (service_data->segmented_message) {
         /* we don't support segmentation - send an abort */
         len = abort_encode_apdu(
-            &Handler_Transmit_Buffer[pdu_len], service_data->invoke_id,
+            &apdu[0], service_data->invoke_id,
             ABORT_REASON_SEGMENTATION_NOT_SUPPORTED, true);
 #if PRINT_ENABLED
         fprintf(stderr, "RR: Segmented message.  Sending Abort!\n");
@@ -147,7 +160,7 @@ void handler_read_range(
         if (len < 0) {
             /* bad decoding - send an abort */
             len = abort_encode_apdu(
-                &Handler_Transmit_Buffer[pdu_len], service_data->invoke_id,
+                &apdu[0], service_data->invoke_id,
                 ABORT_REASON_OTHER, true);
 #if PRINT_ENABLED
             fprintf(stderr, "RR: Bad Encoding.  Sending Abort!\n");
@@ -155,6 +168,9 @@ void handler_read_range(
         } else {
             /* assume that there is an error */
             error = true;
+#if BACNET_SEGMENTATION_ENABLED
+            data.ApduMax = tsm_segmented_response_apdu_max(service_data);
+#endif
             len = Encode_RR_payload(&Temp_Buf[0], &data);
             if (len >= 0) {
                 /* encode the APDU portion of the packet */
@@ -162,8 +178,7 @@ void handler_read_range(
                 data.application_data_len = len;
                 /* FIXME: probably need a length limitation sent with encode */
                 len = rr_ack_encode_apdu(
-                    &Handler_Transmit_Buffer[pdu_len], service_data->invoke_id,
-                    &data);
+                    &apdu[0], service_data->invoke_id, &data);
 #if PRINT_ENABLED
                 fprintf(stderr, "RR: Sending Ack!\n");
 #endif
@@ -174,17 +189,16 @@ void handler_read_range(
                     /* BACnet APDU too small to fit data, so proper response is
                      * Abort */
                     len = abort_encode_apdu(
-                        &Handler_Transmit_Buffer[pdu_len],
-                        service_data->invoke_id,
+                        &apdu[0], service_data->invoke_id,
                         ABORT_REASON_SEGMENTATION_NOT_SUPPORTED, true);
 #if PRINT_ENABLED
                     fprintf(stderr, "RR: Reply too big to fit into APDU!\n");
 #endif
                 } else {
                     len = bacerror_encode_apdu(
-                        &Handler_Transmit_Buffer[pdu_len],
-                        service_data->invoke_id, SERVICE_CONFIRMED_READ_RANGE,
-                        data.error_class, data.error_code);
+                        &apdu[0], service_data->invoke_id,
+                        SERVICE_CONFIRMED_READ_RANGE, data.error_class,
+                        data.error_code);
 #if PRINT_ENABLED
                     fprintf(stderr, "RR: Sending Error!\n");
 #endif
@@ -193,12 +207,20 @@ void handler_read_range(
         }
     }
 
+#if BACNET_SEGMENTATION_ENABLED
+#if PRINT_ENABLED
+    bytes_sent =
+#endif
+        tsm_confirmed_reply_send(
+            src, &npdu_data, service_data, &apdu[0], (uint16_t)len);
+#else
     pdu_len += len;
 #if PRINT_ENABLED
     bytes_sent =
 #endif
         datalink_send_pdu(
             src, &npdu_data, &Handler_Transmit_Buffer[0], pdu_len);
+#endif
 #if PRINT_ENABLED
     if (bytes_sent <= 0) {
         fprintf(stderr, "Failed to send PDU (%s)!\n", strerror(errno));
@@ -8,12 +8,15 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
 #include <string.h>
 #include <errno.h>
 /* BACnet Stack defines - first */
 #include "bacnet/bacdef.h"
 /* BACnet Stack API */
 #include "bacnet/bacdcode.h"
+#include "bacnet/bacaddr.h"
 #include "bacnet/whois.h"
 #include "bacnet/iam.h"
 #include "bacnet/basic/object/device.h"
@@ -22,6 +25,359 @@
 
 /** @file h_whois.c  Handles Who-Is requests. */
 
+/* I-Am replies held for pacing, until handler_who_is_pacing_size_set() */
+#ifndef WHO_IS_PACING_REPLY_MAX
+#define WHO_IS_PACING_REPLY_MAX 32
+#endif
+/* end of a list */
+#define WHO_IS_PACING_NONE UINT_MAX
+typedef struct who_is_pacing_reply {
+    /* the Device that replies */
+    uint32_t device_id;
+    /* unicast to dest, or else a broadcast */
+    bool unicast;
+    BACNET_ADDRESS dest;
+    /* value of Pacing_Clock when the reply was sent */
+    uint32_t sent;
+    /* next reply in the queue, or in the free list */
+    unsigned next;
+    /* next reply with the same hash */
+    unsigned hash_next;
+} WHO_IS_PACING_REPLY;
+static WHO_IS_PACING_REPLY Pacing_Reply_Default[WHO_IS_PACING_REPLY_MAX];
+static unsigned Pacing_Buckets_Default[WHO_IS_PACING_REPLY_MAX];
+static WHO_IS_PACING_REPLY *Pacing_Reply = Pacing_Reply_Default;
+/* replies by the hash of their Device and destination */
+static unsigned *Pacing_Buckets = Pacing_Buckets_Default;
+static unsigned Pacing_Size = WHO_IS_PACING_REPLY_MAX;
+/* The queue is in the order the replies were made. From the head up to
+   Pacing_Send are replies that were sent, and are kept until the window
+   has passed so that a repeated Who-Is is not answered again. */
+static unsigned Pacing_Head = WHO_IS_PACING_NONE;
+static unsigned Pacing_Tail = WHO_IS_PACING_NONE;
+static unsigned Pacing_Send = WHO_IS_PACING_NONE;
+static unsigned Pacing_Free = WHO_IS_PACING_NONE;
+static unsigned Pacing_Pending;
+static bool Pacing_Initialized;
+/* I-Am per second, or 0 to reply without pacing */
+static uint16_t Pacing_Rate;
+/* most milliseconds of random delay before the first reply of a burst */
+static uint16_t Pacing_Jitter;
+/* milliseconds that a sent reply is not repeated */
+static uint16_t Pacing_Window;
+/* milliseconds counted by handler_who_is_pacing_timer() */
+static uint32_t Pacing_Clock;
+/* thousandths of an I-Am that may be sent */
+static uint32_t Pacing_Credit;
+/* milliseconds until the replies may be sent */
+static uint32_t Pacing_Delay;
+
+/**
+ * @brief Hash a Device and reply destination into a bucket index
+ * @param device_id - the Device that replies
+ * @param unicast - true if the reply is unicast to dest
+ * @param dest - the destination of a unicast reply
+ * @return bucket index
+ */
+static unsigned who_is_pacing_hash(
+    uint32_t device_id, bool unicast, const BACNET_ADDRESS *dest)
+{
+    /* FNV-1a */
+    uint32_t hash = 2166136261UL;
+    uint8_t i;
+
+    for (i = 0; i < 4; i++) {
+        hash ^= (uint8_t)(device_id >> (i * 8));
+        hash *= 16777619UL;
+    }
+    if (unicast) {
+        /* the fields compared by bacnet_address_same() */
+        for (i = 0; (i < dest->mac_len) && (i < MAX_MAC_LEN); i++) {
+            hash ^= dest->mac[i];
+            hash *= 16777619UL;
+        }
+        hash ^= (uint8_t)dest->net;
+        hash *= 16777619UL;
+        hash ^= (uint8_t)(dest->net >> 8);
+        hash *= 16777619UL;
+        if (dest->net) {
+            for (i = 0; (i < dest->len) && (i < MAX_MAC_LEN); i++) {
+                hash ^= dest->adr[i];
+                hash *= 16777619UL;
+            }
+        }
+    }
+
+    return hash % Pacing_Size;
+}
+
+/**
+ * @brief Empty the queue, and put every reply in the free list
+ */
+static void who_is_pacing_reset(void)
+{
+    unsigned i;
+
+    for (i = 0; i < Pacing_Size; i++) {
+        Pacing_Buckets[i] = WHO_IS_PACING_NONE;
+        Pacing_Reply[i].next = i + 1;
+    }
+    Pacing_Reply[Pacing_Size - 1].next = WHO_IS_PACING_NONE;
+    Pacing_Free = 0;
+    Pacing_Head = WHO_IS_PACING_NONE;
+    Pacing_Tail = WHO_IS_PACING_NONE;
+    Pacing_Send = WHO_IS_PACING_NONE;
+    Pacing_Pending = 0;
+    Pacing_Credit = 0;
+    Pacing_Delay = 0;
+    Pacing_Initialized = true;
+}
+
+/**
+ * @brief Remove the reply at the head of the queue, which was sent
+ */
+static void who_is_pacing_remove_head(void)
+{
+    WHO_IS_PACING_REPLY *reply;
+    unsigned index = Pacing_Head;
+    unsigned *link;
+
+    reply = &Pacing_Reply[index];
+    link = &Pacing_Buckets[who_is_pacing_hash(
+        reply->device_id, reply->unicast, &reply->dest)];
+    while (*link != index) {
+        link = &Pacing_Reply[*link].hash_next;
+    }
+    *link = reply->hash_next;
+    Pacing_Head = reply->next;
+    if (Pacing_Head == WHO_IS_PACING_NONE) {
+        Pacing_Tail = WHO_IS_PACING_NONE;
+    }
+    reply->next = Pacing_Free;
+    Pacing_Free = index;
+}
+
+/**
+ * @brief Queue an I-Am reply of a Device, unless the same reply is
+ *  already queued, or was sent within the window.
+ * @param device_id - the Device that replies
+ * @param dest - destination of a unicast reply, or NULL to broadcast
+ * @return true if the reply is queued or was coalesced, false if the
+ *  queue is full of replies waiting to be sent.
+ */
+static bool who_is_pacing_add(uint32_t device_id, const BACNET_ADDRESS *dest)
+{
+    WHO_IS_PACING_REPLY *reply;
+    bool unicast = (dest != NULL);
+    unsigned bucket, index;
+
+    if (!Pacing_Initialized) {
+        who_is_pacing_reset();
+    }
+    bucket = who_is_pacing_hash(device_id, unicast, dest);
+    for (index = Pacing_Buckets[bucket]; index != WHO_IS_PACING_NONE;
+         index = reply->hash_next) {
+        reply = &Pacing_Reply[index];
+        if ((reply->device_id == device_id) && (reply->unicast == unicast) &&
+            (!unicast || bacnet_address_same(&reply->dest, dest))) {
+            return true;
+        }
+    }
+    if ((Pacing_Free == WHO_IS_PACING_NONE) && (Pacing_Head != Pacing_Send)) {
+        /* forget the oldest sent reply before its window has passed */
+        who_is_pacing_remove_head();
+    }
+    if (Pacing_Free == WHO_IS_PACING_NONE) {
+        return false;
+    }
+    index = Pacing_Free;
+    reply = &Pacing_Reply[index];
+    Pacing_Free = reply->next;
+    reply->device_id = device_id;
+    reply->unicast = unicast;
+    if (unicast) {
+        bacnet_address_copy(&reply->dest, dest);
+    } else {
+        memset(&reply->dest, 0, sizeof(reply->dest));
+    }
+    reply->sent = 0;
+    reply->next = WHO_IS_PACING_NONE;
+    reply->hash_next = Pacing_Buckets[bucket];
+    Pacing_Buckets[bucket] = index;
+    if (Pacing_Tail == WHO_IS_PACING_NONE) {
+        Pacing_Head = index;
+    } else {
+        Pacing_Reply[Pacing_Tail].next = index;
+    }
+    Pacing_Tail = index;
+    if (Pacing_Send == WHO_IS_PACING_NONE) {
+        /* the first reply of a burst waits for the jitter, and then
+           can be sent at once */
+        Pacing_Send = index;
+        Pacing_Delay = Pacing_Jitter ? (rand() % (Pacing_Jitter + 1)) : 0;
+        Pacing_Credit = 1000;
+    }
+    Pacing_Pending++;
+
+    return true;
+}
+
+/**
+ * @brief Send a queued I-Am reply from its Device
+ * @param reply - the reply to send
+ */
+static void who_is_pacing_send(const WHO_IS_PACING_REPLY *reply)
+{
+#ifdef BAC_ROUTING
+    uint32_t device_id = Device_Object_Instance_Number();
+
+    /* make the replying Device the current one while it is encoded */
+    if (Routed_Device_Valid_Object_Instance_Number(reply->device_id)) {
+        if (reply->unicast) {
+            Send_I_Am_Unicast(&Handler_Transmit_Buffer[0], &reply->dest);
+        } else {
+            Send_I_Am(&Handler_Transmit_Buffer[0]);
+        }
+    }
+    Routed_Device_Valid_Object_Instance_Number(device_id);
+#else
+    /* the Device may have been renumbered since the Who-Is */
+    if (Device_Object_Instance_Number() == reply->device_id) {
+        if (reply->unicast) {
+            Send_I_Am_Unicast(&Handler_Transmit_Buffer[0], &reply->dest);
+        } else {
+            Send_I_Am(&Handler_Transmit_Buffer[0]);
+        }
+    }
+#endif
+}
+
+/**
+ * @brief Send an I-Am reply to a Who-Is from the current Device, at once
+ *  or paced by handler_who_is_pacing_timer(). The reply is sent at once
+ *  if the pacing queue is full, rather than dropped.
+ * @param dest - destination of a unicast reply, or NULL to broadcast
+ */
+static void who_is_reply(const BACNET_ADDRESS *dest)
+{
+    if ((Pacing_Rate != 0) &&
+        who_is_pacing_add(Device_Object_Instance_Number(), dest)) {
+        return;
+    }
+    if (dest) {
+        Send_I_Am_Unicast(&Handler_Transmit_Buffer[0], dest);
+    } else {
+        Send_I_Am(&Handler_Transmit_Buffer[0]);
+    }
+}
+
+/**
+ * @brief Configure the pacing of the I-Am replies to Who-Is.
+ *  A Who-Is that many Devices answer, such as a global Who-Is to a
+ *  gateway, would otherwise send all their I-Am at once.
+ * @param packets_per_second - most I-Am sent per second, or 0 to send
+ *  each I-Am when its Who-Is is handled
+ * @param jitter_ms - most milliseconds of random delay before the
+ *  first I-Am of a burst
+ * @param window_ms - milliseconds that an I-Am to the same destination
+ *  from the same Device is not sent again
+ */
+void handler_who_is_pacing_set(
+    uint16_t packets_per_second, uint16_t jitter_ms, uint16_t window_ms)
+{
+    Pacing_Rate = packets_per_second;
+    Pacing_Jitter = jitter_ms;
+    Pacing_Window = window_ms;
+}
+
+/**
+ * @brief Set the number of I-Am replies that can be queued for pacing.
+ *  The queue is emptied.
+ * @param size - number of replies
+ * @return true if the queue was resized
+ */
+bool handler_who_is_pacing_size_set(unsigned size)
+{
+    WHO_IS_PACING_REPLY *replies = Pacing_Reply_Default;
+    unsigned *buckets = Pacing_Buckets_Default;
+
+    if ((size == 0) || (size >= WHO_IS_PACING_NONE)) {
+        return false;
+    }
+    if (size != WHO_IS_PACING_REPLY_MAX) {
+        replies = calloc(size, sizeof(WHO_IS_PACING_REPLY));
+        buckets = calloc(size, sizeof(unsigned));
+        if (!replies || !buckets) {
+            free(replies);
+            free(buckets);
+            return false;
+        }
+    }
+    if (Pacing_Reply != Pacing_Reply_Default) {
+        free(Pacing_Reply);
+        free(Pacing_Buckets);
+    }
+    Pacing_Reply = replies;
+    Pacing_Buckets = buckets;
+    Pacing_Size = size;
+    who_is_pacing_reset();
+
+    return true;
+}
+
+/**
+ * @brief Get the number of I-Am replies waiting to be sent
+ * @return number of replies
+ */
+unsigned handler_who_is_pacing_pending(void)
+{
+    return Pacing_Pending;
+}
+
+/**
+ * @brief Send the queued I-Am replies that the pacing allows
+ * @param milliseconds - time elapsed since the previous call
+ */
+void handler_who_is_pacing_timer(uint16_t milliseconds)
+{
+    WHO_IS_PACING_REPLY *reply;
+
+    if (!Pacing_Initialized) {
+        return;
+    }
+    Pacing_Clock += milliseconds;
+    while ((Pacing_Head != Pacing_Send) &&
+           ((Pacing_Clock - Pacing_Reply[Pacing_Head].sent) >= Pacing_Window)) {
+        who_is_pacing_remove_head();
+    }
+    if (Pacing_Send == WHO_IS_PACING_NONE) {
+        return;
+    }
+    if (Pacing_Delay > milliseconds) {
+        Pacing_Delay -= milliseconds;
+        return;
+    }
+    Pacing_Delay = 0;
+    if (Pacing_Rate == 0) {
+        /* pacing was turned off: send the rest */
+        Pacing_Credit = Pacing_Pending * 1000UL;
+    } else {
+        Pacing_Credit += (uint32_t)milliseconds * Pacing_Rate;
+    }
+    while ((Pacing_Credit >= 1000) && (Pacing_Send != WHO_IS_PACING_NONE)) {
+        reply = &Pacing_Reply[Pacing_Send];
+        who_is_pacing_send(reply);
+        reply->sent = Pacing_Clock;
+        Pacing_Send = reply->next;
+        Pacing_Pending--;
+        Pacing_Credit -= 1000;
+    }
+    if (Pacing_Send == WHO_IS_PACING_NONE) {
+        /* no credit is saved while there is nothing to send */
+        Pacing_Credit = 0;
+    }
+}
+
 /** Handler for Who-Is requests, with broadcast I-Am response.
  * @ingroup DMDDB
  * @param service_request [in] The received message to be handled.
@@ -39,12 +395,12 @@ void handler_who_is(
     len = whois_decode_service_request(
         service_request, service_len, &low_limit, &high_limit);
     if (len == 0) {
-        Send_I_Am(&Handler_Transmit_Buffer[0]);
+        who_is_reply(NULL);
     } else if (len != BACNET_STATUS_ERROR) {
         /* is my device id within the limits? */
         if ((Device_Object_Instance_Number() >= (uint32_t)low_limit) &&
             (Device_Object_Instance_Number() <= (uint32_t)high_limit)) {
-            Send_I_Am(&Handler_Transmit_Buffer[0]);
+            who_is_reply(NULL);
         }
     }
 
@@ -70,12 +426,12 @@ void handler_who_is_unicast(
         service_request, service_len, &low_limit, &high_limit);
     /* If no limits, then always respond */
     if (len == 0) {
-        Send_I_Am_Unicast(&Handler_Transmit_Buffer[0], src);
+        who_is_reply(src);
     } else if (len != BACNET_STATUS_ERROR) {
         /* is my device id within the limits? */
         if ((Device_Object_Instance_Number() >= (uint32_t)low_limit) &&
             (Device_Object_Instance_Number() <= (uint32_t)high_limit)) {
-            Send_I_Am_Unicast(&Handler_Transmit_Buffer[0], src);
+            who_is_reply(src);
         }
     }
 
@@ -109,7 +465,6 @@ static void check_who_is_for_routing(
     int len = 0;
     int32_t low_limit = 0;
     int32_t high_limit = 0;
-    int32_t dev_instance;
     int cursor = 0; /* Starting hint */
     int my_list[2] = { 0, -1 }; /* Not really used, so dummy values */
     BACNET_ADDRESS bcast_net;
@@ -124,17 +479,15 @@ static void check_who_is_for_routing(
     memset(&bcast_net, 0, sizeof(BACNET_ADDRESS));
     bcast_net.net = BACNET_BROADCAST_NETWORK; /* That's all we have to set */
 
-    while (Routed_Device_GetNext(&bcast_net, my_list, &cursor)) {
-        dev_instance = Device_Object_Instance_Number();
-        /* If len == 0, no limits and always respond */
-        if ((len == 0) ||
-            ((dev_instance >= low_limit) && (dev_instance <= high_limit))) {
-            if (is_unicast) {
-                Send_I_Am_Unicast(&Handler_Transmit_Buffer[0], src);
-            } else {
-                Send_I_Am(&Handler_Transmit_Buffer[0]);
-            }
-        }
+    /* If len == 0, no limits and always respond */
+    if (len == 0) {
+        low_limit = 0;
+        high_limit = BACNET_MAX_INSTANCE;
+    }
+    /* only the Devices within the limits are visited */
+    while (Routed_Device_GetNext_In_Range(
+        &bcast_net, my_list, low_limit, high_limit, &cursor)) {
+        who_is_reply(is_unicast ? src : NULL);
     }
 }
 
@@ -40,6 +40,16 @@ BACNET_STACK_EXPORT
 void handler_who_is_unicast_for_routing(
     uint8_t *service_request, uint16_t service_len, BACNET_ADDRESS *src);
 
+BACNET_STACK_EXPORT
+void handler_who_is_pacing_set(
+    uint16_t packets_per_second, uint16_t jitter_ms, uint16_t window_ms);
+BACNET_STACK_EXPORT
+bool handler_who_is_pacing_size_set(unsigned size);
+BACNET_STACK_EXPORT
+unsigned handler_who_is_pacing_pending(void);
+BACNET_STACK_EXPORT
+void handler_who_is_pacing_timer(uint16_t milliseconds);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
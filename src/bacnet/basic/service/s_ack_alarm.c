@@ -58,7 +58,7 @@ uint8_t Send_Alarm_Acknowledgement_Address(
         return 0;
     }
     /* is there a tsm available? */
-    invoke_id = tsm_next_free_invokeID();
+    invoke_id = tsm_next_free_invokeID(dest);
     if (invoke_id) {
         /* encode the NPDU portion of the packet */
         datalink_get_my_address(&my_address);
@@ -83,7 +83,7 @@ uint8_t Send_Alarm_Acknowledgement_Address(
                     strerror(errno));
             }
         } else {
-            tsm_free_invoke_id(invoke_id);
+            tsm_free_invoke_id(dest, invoke_id);
             invoke_id = 0;
             PRINTF("Failed to Send Alarm Ack Request "
                    "(exceeds destination maximum APDU)!\n");
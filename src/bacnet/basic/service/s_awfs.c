@@ -37,6 +37,7 @@ uint8_t Send_Atomic_Write_File_Stream(
     BACNET_NPDU_DATA npdu_data;
     unsigned max_apdu = 0;
     uint8_t invoke_id = 0;
+    uint8_t *pdu = NULL;
     bool status = false;
     int len = 0;
     int pdu_len = 0;
@@ -54,9 +55,14 @@ uint8_t Send_Atomic_Write_File_Stream(
     status = address_get_by_device(device_id, &max_apdu, &dest);
     /* is there a tsm available? */
     if (status) {
-        invoke_id = tsm_next_free_invokeID();
+        invoke_id = tsm_next_free_invokeID(&dest);
     }
     if (invoke_id) {
+        /* encode into the transaction, which keeps it for retries */
+        pdu = tsm_transaction_pdu_buffer(&dest, invoke_id);
+        if (!pdu) {
+            pdu = &Handler_Transmit_Buffer[0];
+        }
         /* load the data for the encoding */
         data.object_type = OBJECT_FILE;
         data.object_instance = file_instance;
@@ -67,11 +73,9 @@ uint8_t Send_Atomic_Write_File_Stream(
             /* encode the NPDU portion of the packet */
             datalink_get_my_address(&my_address);
             npdu_encode_npdu_data(&npdu_data, true, MESSAGE_PRIORITY_NORMAL);
-            pdu_len = npdu_encode_pdu(
-                &Handler_Transmit_Buffer[0], &dest, &my_address, &npdu_data);
+            pdu_len = npdu_encode_pdu(&pdu[0], &dest, &my_address, &npdu_data);
             /* encode the APDU portion of the packet */
-            len = awf_encode_apdu(
-                &Handler_Transmit_Buffer[pdu_len], invoke_id, &data);
+            len = awf_encode_apdu(&pdu[pdu_len], invoke_id, &data);
             pdu_len += len;
             /* will the APDU fit the target device?
                note: if there is a bottleneck router in between
@@ -80,14 +84,11 @@ uint8_t Send_Atomic_Write_File_Stream(
                max_apdu in the address binding table. */
             if ((unsigned)pdu_len <= max_apdu) {
                 tsm_set_confirmed_unsegmented_transaction(
-                    invoke_id, &dest, &npdu_data, &Handler_Transmit_Buffer[0],
-                    (uint16_t)pdu_len);
+                    invoke_id, &dest, &npdu_data, &pdu[0], (uint16_t)pdu_len);
 #if PRINT_ENABLED
                 bytes_sent =
 #endif
-                    datalink_send_pdu(
-                        &dest, &npdu_data, &Handler_Transmit_Buffer[0],
-                        pdu_len);
+                    datalink_send_pdu(&dest, &npdu_data, &pdu[0], pdu_len);
 #if PRINT_ENABLED
                 if (bytes_sent <= 0) {
                     fprintf(
@@ -97,7 +98,7 @@ uint8_t Send_Atomic_Write_File_Stream(
                 }
 #endif
             } else {
-                tsm_free_invoke_id(invoke_id);
+                tsm_free_invoke_id(&dest, invoke_id);
                 invoke_id = 0;
 #if PRINT_ENABLED
                 fprintf(
@@ -108,7 +109,7 @@ uint8_t Send_Atomic_Write_File_Stream(
 #endif
             }
         } else {
-            tsm_free_invoke_id(invoke_id);
+            tsm_free_invoke_id(&dest, invoke_id);
             invoke_id = 0;
 #if PRINT_ENABLED
             fprintf(
@@ -105,6 +105,7 @@ uint8_t Send_COV_Subscribe(
     BACNET_ADDRESS my_address;
     unsigned max_apdu = 0;
     uint8_t invoke_id = 0;
+    uint8_t *pdu = NULL;
     bool status = false;
     int len = 0;
     int pdu_len = 0;
@@ -118,25 +119,27 @@ uint8_t Send_COV_Subscribe(
     status = address_get_by_device(device_id, &max_apdu, &dest);
     /* is there a tsm available? */
     if (status) {
-        invoke_id = tsm_next_free_invokeID();
+        invoke_id = tsm_next_free_invokeID(&dest);
     }
     if (invoke_id) {
+        /* encode into the transaction, which keeps it for retries */
+        pdu = tsm_transaction_pdu_buffer(&dest, invoke_id);
+        if (!pdu) {
+            pdu = &Handler_Transmit_Buffer[0];
+        }
         /* encode the NPDU portion of the packet */
         datalink_get_my_address(&my_address);
         npdu_encode_npdu_data(&npdu_data, true, MESSAGE_PRIORITY_NORMAL);
-        pdu_len = npdu_encode_pdu(
-            &Handler_Transmit_Buffer[0], &dest, &my_address, &npdu_data);
+        pdu_len = npdu_encode_pdu(&pdu[0], &dest, &my_address, &npdu_data);
         /* encode the APDU portion of the packet */
         if (cov_data->covSubscribeToProperty) {
             /* subscribe to 1 property */
             len = cov_subscribe_property_encode_apdu(
-                &Handler_Transmit_Buffer[pdu_len],
-                sizeof(Handler_Transmit_Buffer) - pdu_len, invoke_id, cov_data);
+                &pdu[pdu_len], MAX_PDU - pdu_len, invoke_id, cov_data);
         } else {
             /* subscribe to object */
             len = cov_subscribe_encode_apdu(
-                &Handler_Transmit_Buffer[pdu_len],
-                sizeof(Handler_Transmit_Buffer) - pdu_len, invoke_id, cov_data);
+                &pdu[pdu_len], MAX_PDU - pdu_len, invoke_id, cov_data);
         }
         pdu_len += len;
         /* will it fit in the sender?
@@ -146,10 +149,8 @@ uint8_t Send_COV_Subscribe(
            max_apdu in the address binding table. */
         if ((unsigned)pdu_len < max_apdu) {
             tsm_set_confirmed_unsegmented_transaction(
-                invoke_id, &dest, &npdu_data, &Handler_Transmit_Buffer[0],
-                (uint16_t)pdu_len);
-            bytes_sent = datalink_send_pdu(
-                &dest, &npdu_data, &Handler_Transmit_Buffer[0], pdu_len);
+                invoke_id, &dest, &npdu_data, &pdu[0], (uint16_t)pdu_len);
+            bytes_sent = datalink_send_pdu(&dest, &npdu_data, &pdu[0], pdu_len);
             if (bytes_sent <= 0) {
 #if PRINT_ENABLED
                 fprintf(
@@ -158,7 +159,7 @@ uint8_t Send_COV_Subscribe(
 #endif
             }
         } else {
-            tsm_free_invoke_id(invoke_id);
+            tsm_free_invoke_id(&dest, invoke_id);
             invoke_id = 0;
 #if PRINT_ENABLED
             fprintf(
@@ -49,6 +49,7 @@ uint8_t Send_Delete_Object_Request(
     BACNET_ADDRESS my_address;
     unsigned max_apdu = 0;
     uint8_t invoke_id = 0;
+    uint8_t *pdu = NULL;
     bool status = false;
     int len = 0;
     int pdu_len = 0;
@@ -64,20 +65,23 @@ uint8_t Send_Delete_Object_Request(
     status = address_get_by_device(device_id, &max_apdu, &dest);
     /* is there a tsm available? */
     if (status) {
-        invoke_id = tsm_next_free_invokeID();
+        invoke_id = tsm_next_free_invokeID(&dest);
     }
     if (invoke_id) {
+        /* encode into the transaction, which keeps it for retries */
+        pdu = tsm_transaction_pdu_buffer(&dest, invoke_id);
+        if (!pdu) {
+            pdu = &Handler_Transmit_Buffer[0];
+        }
         /* encode the NPDU portion of the packet */
         datalink_get_my_address(&my_address);
         npdu_encode_npdu_data(&npdu_data, true, MESSAGE_PRIORITY_NORMAL);
-        pdu_len = npdu_encode_pdu(
-            &Handler_Transmit_Buffer[0], &dest, &my_address, &npdu_data);
+        pdu_len = npdu_encode_pdu(&pdu[0], &dest, &my_address, &npdu_data);
         /* encode the APDU header portion of the packet */
-        Handler_Transmit_Buffer[pdu_len++] = PDU_TYPE_CONFIRMED_SERVICE_REQUEST;
-        Handler_Transmit_Buffer[pdu_len++] =
-            encode_max_segs_max_apdu(0, MAX_APDU);
-        Handler_Transmit_Buffer[pdu_len++] = invoke_id;
-        Handler_Transmit_Buffer[pdu_len++] = service;
+        pdu[pdu_len++] = PDU_TYPE_CONFIRMED_SERVICE_REQUEST;
+        pdu[pdu_len++] = encode_max_segs_max_apdu(0, MAX_APDU);
+        pdu[pdu_len++] = invoke_id;
+        pdu[pdu_len++] = service;
         /* encode the APDU service */
         data.object_type = object_type;
         data.object_instance = object_instance;
@@ -89,18 +93,14 @@ uint8_t Send_Delete_Object_Request(
            us and the destination, we won't know unless
            we have a way to check for that and update the
            max_apdu in the address binding table. */
-        if (((unsigned)pdu_len < max_apdu) &&
-            (pdu_len < sizeof(Handler_Transmit_Buffer))) {
+        if (((unsigned)pdu_len < max_apdu) && (pdu_len < MAX_PDU)) {
             /* shift back to the service portion of the buffer */
             pdu_len -= len;
-            len = delete_object_encode_service_request(
-                &Handler_Transmit_Buffer[pdu_len], &data);
+            len = delete_object_encode_service_request(&pdu[pdu_len], &data);
             pdu_len += len;
             tsm_set_confirmed_unsegmented_transaction(
-                invoke_id, &dest, &npdu_data, &Handler_Transmit_Buffer[0],
-                (uint16_t)pdu_len);
-            bytes_sent = datalink_send_pdu(
-                &dest, &npdu_data, &Handler_Transmit_Buffer[0], pdu_len);
+                invoke_id, &dest, &npdu_data, &pdu[0], (uint16_t)pdu_len);
+            bytes_sent = datalink_send_pdu(&dest, &npdu_data, &pdu[0], pdu_len);
             if (bytes_sent <= 0) {
                 debug_perror(
                     "%s service: Failed to Send %i/%i (%s)!\n",
@@ -108,7 +108,7 @@ uint8_t Send_Delete_Object_Request(
                     pdu_len, strerror(errno));
             }
         } else {
-            tsm_free_invoke_id(invoke_id);
+            tsm_free_invoke_id(&dest, invoke_id);
             invoke_id = 0;
             debug_perror(
                 "%s service: Failed to Send "
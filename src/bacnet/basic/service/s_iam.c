@@ -89,7 +89,12 @@ int iam_encode_pdu(
     /* encode the APDU portion of the packet */
     len = iam_encode_apdu(
         &buffer[pdu_len], Device_Object_Instance_Number(), MAX_APDU,
-        SEGMENTATION_NONE, Device_Vendor_Identifier());
+#if BACNET_SEGMENTATION_ENABLED
+        Device_Segmentation_Supported(),
+#else
+        SEGMENTATION_NONE,
+#endif
+        Device_Vendor_Identifier());
     pdu_len += len;
 
     return pdu_len;
@@ -161,7 +166,12 @@ int iam_unicast_encode_pdu(
     /* encode the APDU portion of the packet */
     apdu_len = iam_encode_apdu(
         &buffer[npdu_len], Device_Object_Instance_Number(), MAX_APDU,
-        SEGMENTATION_NONE, Device_Vendor_Identifier());
+#if BACNET_SEGMENTATION_ENABLED
+        Device_Segmentation_Supported(),
+#else
+        SEGMENTATION_NONE,
+#endif
+        Device_Vendor_Identifier());
     pdu_len = npdu_len + apdu_len;
 
     return pdu_len;
@@ -36,6 +36,7 @@ uint8_t Send_ReadRange_Request(
     BACNET_ADDRESS my_address;
     unsigned max_apdu = 0;
     uint8_t invoke_id = 0;
+    uint8_t *pdu = NULL;
     bool status = false;
     int len = 0;
     int pdu_len = 0;
@@ -52,22 +53,30 @@ uint8_t Send_ReadRange_Request(
     status = address_get_by_device(device_id, &max_apdu, &dest);
     /* is there a tsm available? */
     if (status) {
-        invoke_id = tsm_next_free_invokeID();
+        invoke_id = tsm_next_free_invokeID(&dest);
     }
 
     if (invoke_id) {
+        /* encode into the transaction, which keeps it for retries */
+        pdu = tsm_transaction_pdu_buffer(&dest, invoke_id);
+        if (!pdu) {
+            pdu = &Handler_Transmit_Buffer[0];
+        }
         /* encode the NPDU portion of the packet */
         datalink_get_my_address(&my_address);
         npdu_encode_npdu_data(&npdu_data, true, MESSAGE_PRIORITY_NORMAL);
-        pdu_len = npdu_encode_pdu(
-            &Handler_Transmit_Buffer[0], &dest, &my_address, &npdu_data);
+        pdu_len = npdu_encode_pdu(&pdu[0], &dest, &my_address, &npdu_data);
 
         /* encode the APDU portion of the packet */
-        len = rr_encode_apdu(
-            &Handler_Transmit_Buffer[pdu_len], invoke_id, read_access_data);
+        len = rr_encode_apdu(&pdu[pdu_len], invoke_id, read_access_data);
         if (len <= 0) {
+            tsm_free_invoke_id(&dest, invoke_id);
             return 0;
         }
+#if BACNET_SEGMENTATION_ENABLED
+        /* we can receive a segmented response */
+        tsm_confirmed_request_segmentation_set(&pdu[pdu_len], (uint16_t)len);
+#endif
 
         pdu_len += len;
         /* is it small enough for the the destination to receive?
@@ -77,13 +86,11 @@ uint8_t Send_ReadRange_Request(
            max_apdu in the address binding table. */
         if ((unsigned)pdu_len < max_apdu) {
             tsm_set_confirmed_unsegmented_transaction(
-                invoke_id, &dest, &npdu_data, &Handler_Transmit_Buffer[0],
-                (uint16_t)pdu_len);
+                invoke_id, &dest, &npdu_data, &pdu[0], (uint16_t)pdu_len);
 #if PRINT_ENABLED
             bytes_sent =
 #endif
-                datalink_send_pdu(
-                    &dest, &npdu_data, &Handler_Transmit_Buffer[0], pdu_len);
+                datalink_send_pdu(&dest, &npdu_data, &pdu[0], pdu_len);
 #if PRINT_ENABLED
             if (bytes_sent <= 0) {
                 fprintf(
@@ -92,7 +99,7 @@ uint8_t Send_ReadRange_Request(
             }
 #endif
         } else {
-            tsm_free_invoke_id(invoke_id);
+            tsm_free_invoke_id(&dest, invoke_id);
             invoke_id = 0;
 #if PRINT_ENABLED
             fprintf(
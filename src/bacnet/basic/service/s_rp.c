@@ -52,6 +52,7 @@ uint8_t Send_Read_Property_Request_Address(
 {
     BACNET_ADDRESS my_address;
     uint8_t invoke_id = 0;
+    uint8_t *pdu = NULL;
     int len = 0;
     int pdu_len = 0;
     int bytes_sent = 0;
@@ -65,20 +66,27 @@ uint8_t Send_Read_Property_Request_Address(
         return 0;
     }
     /* is there a tsm available? */
-    invoke_id = tsm_next_free_invokeID();
+    invoke_id = tsm_next_free_invokeID(dest);
     if (invoke_id) {
+        /* encode into the transaction, which keeps it for retries */
+        pdu = tsm_transaction_pdu_buffer(dest, invoke_id);
+        if (!pdu) {
+            pdu = &Handler_Transmit_Buffer[0];
+        }
         /* encode the NPDU portion of the packet */
         datalink_get_my_address(&my_address);
         npdu_encode_npdu_data(&npdu_data, true, MESSAGE_PRIORITY_NORMAL);
-        pdu_len = npdu_encode_pdu(
-            &Handler_Transmit_Buffer[0], dest, &my_address, &npdu_data);
+        pdu_len = npdu_encode_pdu(&pdu[0], dest, &my_address, &npdu_data);
         /* encode the APDU portion of the packet */
         data.object_type = object_type;
         data.object_instance = object_instance;
         data.object_property = object_property;
         data.array_index = array_index;
-        len =
-            rp_encode_apdu(&Handler_Transmit_Buffer[pdu_len], invoke_id, &data);
+        len = rp_encode_apdu(&pdu[pdu_len], invoke_id, &data);
+#if BACNET_SEGMENTATION_ENABLED
+        /* we can receive a segmented response */
+        tsm_confirmed_request_segmentation_set(&pdu[pdu_len], (uint16_t)len);
+#endif
         pdu_len += len;
         /* will it fit in the sender?
            note: if there is a bottleneck router in between
@@ -87,10 +95,8 @@ uint8_t Send_Read_Property_Request_Address(
            max_apdu in the address binding table. */
         if ((uint16_t)pdu_len < max_apdu) {
             tsm_set_confirmed_unsegmented_transaction(
-                invoke_id, dest, &npdu_data, &Handler_Transmit_Buffer[0],
-                (uint16_t)pdu_len);
-            bytes_sent = datalink_send_pdu(
-                dest, &npdu_data, &Handler_Transmit_Buffer[0], pdu_len);
+                invoke_id, dest, &npdu_data, &pdu[0], (uint16_t)pdu_len);
+            bytes_sent = datalink_send_pdu(dest, &npdu_data, &pdu[0], pdu_len);
             if (bytes_sent <= 0) {
 #if PRINT_ENABLED
                 fprintf(
@@ -99,7 +105,7 @@ uint8_t Send_Read_Property_Request_Address(
 #endif
             }
         } else {
-            tsm_free_invoke_id(invoke_id);
+            tsm_free_invoke_id(dest, invoke_id);
             invoke_id = 0;
 #if PRINT_ENABLED
             fprintf(
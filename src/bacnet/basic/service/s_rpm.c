@@ -63,7 +63,7 @@ uint8_t Send_Read_Property_Multiple_Request(
     status = address_get_by_device(device_id, &max_apdu, &dest);
     /* is there a tsm available? */
     if (status) {
-        invoke_id = tsm_next_free_invokeID();
+        invoke_id = tsm_next_free_invokeID(&dest);
     }
     if (invoke_id) {
         /* encode the NPDU portion of the packet */
@@ -74,8 +74,13 @@ uint8_t Send_Read_Property_Multiple_Request(
         len = rpm_encode_apdu(
             &pdu[pdu_len], max_pdu - pdu_len, invoke_id, read_access_data);
         if (len <= 0) {
+            tsm_free_invoke_id(&dest, invoke_id);
             return 0;
         }
+#if BACNET_SEGMENTATION_ENABLED
+        /* we can receive a segmented response */
+        tsm_confirmed_request_segmentation_set(&pdu[pdu_len], (uint16_t)len);
+#endif
         pdu_len += len;
         /* is it small enough for the destination to receive?
            note: if there is a bottleneck router in between
@@ -98,7 +103,7 @@ uint8_t Send_Read_Property_Multiple_Request(
             }
 #endif
         } else {
-            tsm_free_invoke_id(invoke_id);
+            tsm_free_invoke_id(&dest, invoke_id);
             invoke_id = 0;
 #if PRINT_ENABLED
             fprintf(
@@ -9,15 +9,26 @@
  * @date 2003
  * @copyright SPDX-License-Identifier: GPL-2.0-or-later WITH GCC-exception-2.0
  */
+#include <limits.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 #include "bacnet/basic/sys/keylist.h"
 
+#if BACNET_KEYLIST_INLINE_NODES
+/* the nodes are stored in the array */
+#define KEYLIST_NODE(list, index) (&(list)->array[index])
+#else
+/* the array stores pointers to the nodes */
+#define KEYLIST_NODE(list, index) ((list)->array[index])
+#endif
+
 /******************************************************************** */
 /* Generic node routines */
 /******************************************************************** */
 
+#if !BACNET_KEYLIST_INLINE_NODES
 /** Grab memory for a node (Keylist_Node).
  *
  * @return Pointer to the allocated memory or
@@ -27,6 +38,7 @@ static struct Keylist_Node *NodeCreate(void)
 {
     return calloc(1, sizeof(struct Keylist_Node));
 }
+#endif
 
 /** Grab memory for a list (Keylist).
  *
@@ -38,6 +50,51 @@ static struct Keylist *KeylistCreate(void)
     return calloc(1, sizeof(struct Keylist));
 }
 
+#if BACNET_KEYLIST_INLINE_NODES
+/** Check to see if the array is big enough for an addition
+ * or is too big when we are deleting and we can shrink.
+ * The array doubles when full, and halves when a quarter full,
+ * so that the cost of copying the nodes is O(1) amortized.
+ *
+ * @param list  Pointer to the list to be tested.
+ *
+ * @return Returns true if success, false if failed
+ */
+static bool CheckArraySize(OS_Keylist list)
+{
+    int new_size = 0; /* set it up so that no size change is the default */
+    const int chunk = 8; /* minimum number of nodes to allocate memory for */
+    struct Keylist_Node *new_array = NULL; /* new array of nodes, if needed */
+
+    if (!list) {
+        return false;
+    }
+    if (list->size == 0) {
+        new_size = chunk;
+    } else if (list->count == list->size) {
+        /* indicates the need for more memory allocation */
+        if (list->size > (INT_MAX / 2)) {
+            return false;
+        }
+        new_size = list->size * 2;
+    } else if ((list->size > chunk) && (list->count < (list->size / 4))) {
+        /* allow for shrinking memory */
+        new_size = list->size / 2;
+    }
+    if (new_size > 0) {
+        new_array = realloc(
+            list->array, (size_t)new_size * sizeof(struct Keylist_Node));
+        if (!new_array) {
+            /* usable if it was only going to shrink */
+            return (list->count < list->size);
+        }
+        list->array = new_array;
+        list->size = new_size;
+    }
+
+    return true;
+}
+#else
 /** Check to see if the array is big enough for an addition
  * or is too big when we are deleting and we can shrink.
  *
@@ -85,6 +142,7 @@ static bool CheckArraySize(OS_Keylist list)
 
     return true;
 }
+#endif
 
 /** Find the index of the key that we are looking for.
  * Since it is sorted, we can optimize the search.
@@ -122,7 +180,7 @@ static bool FindIndex(OS_Keylist list, KEY key, int *pIndex)
     do {
         /* A binary search */
         index = (left + right) / 2;
-        node = list->array[index];
+        node = KEYLIST_NODE(list, index);
         if (!node) {
             break;
         }
@@ -168,11 +226,17 @@ int Keylist_Data_Add(OS_Keylist list, KEY key, void *data)
 {
     struct Keylist_Node *node; /* holds the new node */
     int index = -1; /* return value */
+#if !BACNET_KEYLIST_INLINE_NODES
     int i; /* counts through the array */
+#endif
 
     if (list && CheckArraySize(list)) {
         /* figure out where to put the new node */
-        if (list->count) {
+        if (list->count &&
+            (key > KEYLIST_NODE(list, list->count - 1)->key)) {
+            /* keys added in ascending order go at the end */
+            index = list->count;
+        } else if (list->count) {
             (void)FindIndex(list, key, &index);
             if (index < 0) {
                 /* Add to the beginning of the list */
@@ -183,20 +247,32 @@ int Keylist_Data_Add(OS_Keylist list, KEY key, void *data)
                 index = list->count;
             }
             /* Move all the items up to make room for the new one */
+#if BACNET_KEYLIST_INLINE_NODES
+            memmove(
+                &list->array[index + 1], &list->array[index],
+                (size_t)(list->count - index) * sizeof(struct Keylist_Node));
+#else
             for (i = list->count; i > index; i--) {
                 list->array[i] = list->array[i - 1];
             }
+#endif
         } else {
             index = 0;
         }
 
         /* create and add the node */
+#if BACNET_KEYLIST_INLINE_NODES
+        node = &list->array[index];
+#else
         node = NodeCreate();
+#endif
         if (node) {
             list->count++;
             node->key = key;
             node->data = data;
+#if !BACNET_KEYLIST_INLINE_NODES
             list->array[index] = node;
+#endif
         }
     }
     return index;
@@ -218,7 +294,7 @@ void *Keylist_Data_Delete_By_Index(OS_Keylist list, int index)
     if (list) {
         if (list->array && list->count && (index >= 0) &&
             (index < list->count)) {
-            node = list->array[index];
+            node = KEYLIST_NODE(list, index);
             if (node) {
                 data = node->data;
             }
@@ -230,16 +306,25 @@ void *Keylist_Data_Delete_By_Index(OS_Keylist list, int index)
                 /* There is no node shifting to do */
             } else {
                 /* Move all the nodes down one */
+#if BACNET_KEYLIST_INLINE_NODES
+                memmove(
+                    &list->array[index], &list->array[index + 1],
+                    (size_t)(list->count - 1 - index) *
+                        sizeof(struct Keylist_Node));
+#else
                 int i; /* counter */
                 int count = list->count - 1;
                 for (i = index; i < count; i++) {
                     list->array[i] = list->array[i + 1];
                 }
+#endif
             }
             list->count--;
+#if !BACNET_KEYLIST_INLINE_NODES
             if (node) {
                 free(node);
             }
+#endif
 
             /* potentially reduce the size of the array */
             (void)CheckArraySize(list);
@@ -321,7 +406,7 @@ void *Keylist_Data(OS_Keylist list, KEY key)
     if (list) {
         if (list->array && list->count) {
             if (FindIndex(list, key, &index)) {
-                node = list->array[index];
+                node = KEYLIST_NODE(list, index);
             }
         }
     }
@@ -349,6 +434,28 @@ int Keylist_Index(OS_Keylist list, KEY key)
     return index;
 }
 
+/** Returns the index of the first node with a key at or after the given key.
+ *
+ * @param list  Pointer to the list
+ * @param key  Key to search for
+ *
+ * @return Index of the node, or -1 if every key is before the given key.
+ */
+int Keylist_Index_Next(OS_Keylist list, KEY key)
+{
+    int index = -1; /* used to look up the index of node */
+
+    if (list) {
+        if (list->array && list->count) {
+            (void)FindIndex(list, key, &index);
+            if (index >= list->count) {
+                index = -1;
+            }
+        }
+    }
+    return index;
+}
+
 /** Returns the data specified by index
  *
  * @param list  Pointer to the list
@@ -363,7 +470,7 @@ void *Keylist_Data_Index(OS_Keylist list, int index)
     if (list) {
         if (list->array && list->count && (index >= 0) &&
             (index < list->count)) {
-            node = list->array[index];
+            node = KEYLIST_NODE(list, index);
         }
     }
     return node ? node->data : NULL;
@@ -385,7 +492,7 @@ KEY Keylist_Key(OS_Keylist list, int index)
     if (list) {
         if (list->array && list->count && (index >= 0) &&
             (index < list->count)) {
-            node = list->array[index];
+            node = KEYLIST_NODE(list, index);
             if (node) {
                 key = node->key;
             }
@@ -410,7 +517,7 @@ bool Keylist_Index_Key(OS_Keylist list, int index, KEY *pKey)
     if (list) {
         if (list->array && list->count && (index >= 0) &&
             (index < list->count)) {
-            node = list->array[index];
+            node = KEYLIST_NODE(list, index);
             if (node) {
                 status = true;
                 if (pKey) {
@@ -492,7 +599,7 @@ void Keylist_Delete(OS_Keylist list)
     if (list) {
         /* clean out the list */
         while (list->count) {
-            (void)Keylist_Data_Delete_By_Index(list, 0);
+            (void)Keylist_Data_Delete_By_Index(list, list->count - 1);
         }
         if (list->array) {
             free(list->array);
@@ -16,6 +16,13 @@
 /* uses a key or index to access the data. */
 /* If the keys are duplicated, they can be added into the list like FIFO */
 
+/* Keep the nodes inline in one contiguous array that grows geometrically,
+   instead of an array of pointers to nodes that are each allocated.
+   Adding keys in ascending order is then O(1) amortized. */
+#ifndef BACNET_KEYLIST_INLINE_NODES
+#define BACNET_KEYLIST_INLINE_NODES 0
+#endif
+
 /* list data and datatype */
 struct Keylist_Node {
     KEY key; /* unique number that is sorted in the list */
@@ -23,7 +30,11 @@ struct Keylist_Node {
 };
 
 typedef struct Keylist {
+#if BACNET_KEYLIST_INLINE_NODES
+    struct Keylist_Node *array; /* contiguous array of nodes */
+#else
     struct Keylist_Node **array; /* array of nodes */
+#endif
     int count; /* number of nodes in this list - more efficient than loop */
     int size; /* number of available nodes on this list - can grow or shrink */
 } KEYLIST_TYPE;
@@ -73,6 +84,10 @@ void *Keylist_Data(OS_Keylist list, KEY key);
 BACNET_STACK_EXPORT
 int Keylist_Index(OS_Keylist list, KEY key);
 
+/* returns the index of the first node with a key at or after the key */
+BACNET_STACK_EXPORT
+int Keylist_Index_Next(OS_Keylist list, KEY key);
+
 /* returns the data specified by index */
 BACNET_STACK_EXPORT
 void *Keylist_Data_Index(OS_Keylist list, int index);
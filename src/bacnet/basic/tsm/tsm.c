@@ -8,10 +8,14 @@
  *********************************************************************/
 #include <stdbool.h>
 #include <stdint.h>
+#include <limits.h>
 #include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
 /* BACnet Stack defines - first */
 #include "bacnet/bacdef.h"
 /* BACnet Stack API */
+#include "bacnet/abort.h"
 #include "bacnet/apdu.h"
 #include "bacnet/bacaddr.h"
 #include "bacnet/bacdcode.h"
@@ -30,11 +34,42 @@ uint8_t Handler_Transmit_Buffer[MAX_PDU];
 /* If we are only a server and only initiate broadcasts, */
 /* then we don't need a TSM layer. */
 
-/* FIXME: not coded for segmentation */
+/* end of a list of transactions */
+#define TSM_NONE UINT_MAX
+/* number of hash buckets for finding a transaction by peer and invoke ID */
+#ifndef TSM_HASH_SIZE
+#define TSM_HASH_SIZE 256
+#endif
 
 /* declare space for the TSM transactions, and set it up in the init. */
 /* table rules: an Invoke ID = 0 is an unused spot in the table */
-static BACNET_TSM_DATA TSM_List[MAX_TSM_TRANSACTIONS];
+static BACNET_TSM_DATA TSM_List_Default[MAX_TSM_TRANSACTIONS];
+static unsigned TSM_Active_Default[MAX_TSM_TRANSACTIONS];
+static BACNET_TSM_DATA *TSM_List = TSM_List_Default;
+static unsigned TSM_List_Size = MAX_TSM_TRANSACTIONS;
+/* transactions in use, so the timer only visits those */
+static unsigned *TSM_Active = TSM_Active_Default;
+static unsigned TSM_Active_Count;
+/* transactions in use, hashed by peer address and invoke ID */
+static unsigned TSM_Hash_Head[TSM_HASH_SIZE];
+/* transactions not in use */
+static unsigned TSM_Free_Head = TSM_NONE;
+static bool TSM_List_Indexed;
+
+#if BACNET_SEGMENTATION_ENABLED
+/* service handlers encode large Complex-ACK here */
+uint8_t Handler_Segmented_Buffer[BACNET_SEGMENTATION_APDU_MAX];
+/* segmented responses in progress - keyed by peer address and invoke ID
+   since the invoke ID was chosen by the requester */
+static BACNET_TSM_SEGMENTED_DATA TSM_Segmented_List
+    [BACNET_SEGMENTATION_TRANSACTIONS];
+/* segmented Complex-ACK being received - keyed by peer address
+   and the invoke ID of our request */
+static BACNET_TSM_REASSEMBLY_DATA TSM_Reassembly_List
+    [BACNET_SEGMENTATION_REASSEMBLY_BUFFERS];
+/* segments are encoded here so the handler buffer is not disturbed */
+static uint8_t Segment_Transmit_Buffer[MAX_PDU];
+#endif
 
 /* invoke ID for incrementing between subsequent calls. */
 static uint8_t Current_Invoke_ID = 1;
@@ -46,51 +81,203 @@ void tsm_set_timeout_handler(tsm_timeout_function pFunction)
     Timeout_Function = pFunction;
 }
 
-/** Find the given Invoke-Id in the list and
- *  return the index.
+/** Build the free list and the indexes of an empty transaction table.
+ */
+static void tsm_list_index_init(void)
+{
+    unsigned i;
+
+    for (i = 0; i < TSM_HASH_SIZE; i++) {
+        TSM_Hash_Head[i] = TSM_NONE;
+    }
+    TSM_Free_Head = TSM_NONE;
+    TSM_Active_Count = 0;
+    i = TSM_List_Size;
+    while (i > 0) {
+        i--;
+        TSM_List[i].InvokeID = 0;
+        TSM_List[i].state = TSM_STATE_IDLE;
+        TSM_List[i].next = TSM_Free_Head;
+        TSM_Free_Head = i;
+    }
+    TSM_List_Indexed = true;
+}
+
+/** Build the indexes if the table is used before it was sized. */
+static void tsm_list_index_check(void)
+{
+    if (!TSM_List_Indexed) {
+        tsm_list_index_init();
+    }
+}
+
+/** Hash a peer address and invoke ID into a bucket. Only the parts
+ *  of the address that bacnet_address_same() compares are used.
  *
+ * @param dest  Address of the peer
  * @param invokeID  Invoke Id
  *
- * @return Index of the id or MAX_TSM_TRANSACTIONS
- *         if not found
+ * @return bucket index
  */
-static uint8_t tsm_find_invokeID_index(uint8_t invokeID)
+static unsigned tsm_hash(const BACNET_ADDRESS *dest, uint8_t invokeID)
 {
-    unsigned i = 0; /* counter */
-    uint8_t index = MAX_TSM_TRANSACTIONS; /* return value */
+    unsigned hash = dest->mac_len;
+    unsigned i;
 
-    const BACNET_TSM_DATA *plist = TSM_List;
+    for (i = 0; (i < dest->mac_len) && (i < MAX_MAC_LEN); i++) {
+        hash = (hash * 31U) + dest->mac[i];
+    }
+    hash = (hash * 31U) + dest->net;
+    if (dest->net) {
+        for (i = 0; (i < dest->len) && (i < MAX_MAC_LEN); i++) {
+            hash = (hash * 31U) + dest->adr[i];
+        }
+    }
+    /* consecutive invoke IDs of one peer land in different buckets */
+    hash = (hash * 31U) + invokeID;
 
-    for (i = 0; i < MAX_TSM_TRANSACTIONS; i++, plist++) {
-        if (plist->InvokeID == invokeID) {
-            index = (uint8_t)i;
-            break;
+    return hash % TSM_HASH_SIZE;
+}
+
+/** Find the transaction with the given peer and Invoke-Id.
+ *  An Invoke-Id is unique for each peer, so there is at most one.
+ *
+ * @param dest  Address of the peer
+ * @param invokeID  Invoke Id
+ *
+ * @return Pointer to the transaction, or NULL if not found
+ */
+static BACNET_TSM_DATA *
+tsm_find(const BACNET_ADDRESS *dest, uint8_t invokeID)
+{
+    BACNET_TSM_DATA *plist;
+    unsigned index;
+
+    if (!dest || (invokeID == 0)) {
+        return NULL;
+    }
+    tsm_list_index_check();
+    index = TSM_Hash_Head[tsm_hash(dest, invokeID)];
+    while (index != TSM_NONE) {
+        plist = &TSM_List[index];
+        if ((plist->InvokeID == invokeID) &&
+            bacnet_address_same(&plist->dest, dest)) {
+            return plist;
         }
+        index = plist->next;
     }
 
-    return index;
+    return NULL;
 }
 
-/** Find the first free index in the TSM table.
+/** Take a transaction from the free list for a peer and invoke ID.
  *
- * @return Index of the id or MAX_TSM_TRANSACTIONS
- *         if no entry is free.
+ * @param dest  Address of the peer
+ * @param invokeID  Invoke Id
+ * @return Pointer to the transaction, or NULL if none are free
  */
-static uint8_t tsm_find_first_free_index(void)
+static BACNET_TSM_DATA *
+tsm_reserve(const BACNET_ADDRESS *dest, uint8_t invokeID)
 {
-    unsigned i = 0; /* counter */
-    uint8_t index = MAX_TSM_TRANSACTIONS; /* return value */
+    BACNET_TSM_DATA *plist;
+    unsigned index;
+    unsigned bucket;
 
-    const BACNET_TSM_DATA *plist = TSM_List;
+    index = TSM_Free_Head;
+    if (index == TSM_NONE) {
+        return NULL;
+    }
+    plist = &TSM_List[index];
+    TSM_Free_Head = plist->next;
+    plist->InvokeID = invokeID;
+    plist->state = TSM_STATE_IDLE;
+    plist->RequestTimer = apdu_timeout();
+    bacnet_address_copy(&plist->dest, dest);
+    bucket = tsm_hash(dest, invokeID);
+    plist->next = TSM_Hash_Head[bucket];
+    TSM_Hash_Head[bucket] = index;
+    plist->active = TSM_Active_Count;
+    TSM_Active[TSM_Active_Count] = index;
+    TSM_Active_Count++;
 
-    for (i = 0; i < MAX_TSM_TRANSACTIONS; i++, plist++) {
-        if (plist->InvokeID == 0) {
-            index = (uint8_t)i;
-            break;
+    return plist;
+}
+
+/** Return a transaction to the free list.
+ *
+ * @param plist  Pointer to the transaction
+ */
+static void tsm_release(BACNET_TSM_DATA *plist)
+{
+    unsigned index = (unsigned)(plist - TSM_List);
+    unsigned last;
+    unsigned *link;
+
+    if (plist->InvokeID == 0) {
+        return;
+    }
+    /* unlink from the hash bucket */
+    link = &TSM_Hash_Head[tsm_hash(&plist->dest, plist->InvokeID)];
+    while (*link != index) {
+        link = &TSM_List[*link].next;
+    }
+    *link = plist->next;
+    /* move the last active transaction into this spot */
+    TSM_Active_Count--;
+    last = TSM_Active[TSM_Active_Count];
+    TSM_Active[plist->active] = last;
+    TSM_List[last].active = plist->active;
+    plist->state = TSM_STATE_IDLE;
+    plist->InvokeID = 0;
+    plist->next = TSM_Free_Head;
+    TSM_Free_Head = index;
+}
+
+/** Set the number of transactions in the table. Sizes other than
+ *  MAX_TSM_TRANSACTIONS are allocated from the heap. The table can
+ *  only be resized when no transactions are in use.
+ *
+ * @param size  number of transactions, shared by all peers,
+ *  since each peer has its own 255 invoke IDs
+ * @return true if the table was resized
+ */
+bool tsm_transaction_size_set(unsigned size)
+{
+    BACNET_TSM_DATA *list = TSM_List_Default;
+    unsigned *active = TSM_Active_Default;
+
+    tsm_list_index_check();
+    if ((size == 0) || (size >= TSM_NONE) || (TSM_Active_Count > 0)) {
+        return false;
+    }
+    if (size != MAX_TSM_TRANSACTIONS) {
+        list = calloc(size, sizeof(BACNET_TSM_DATA));
+        active = calloc(size, sizeof(unsigned));
+        if (!list || !active) {
+            free(list);
+            free(active);
+            return false;
         }
     }
+    if (TSM_List != TSM_List_Default) {
+        free(TSM_List);
+        free(TSM_Active);
+    }
+    TSM_List = list;
+    TSM_Active = active;
+    TSM_List_Size = size;
+    tsm_list_index_init();
+
+    return true;
+}
 
-    return index;
+/** Get the number of transactions in the table.
+ *
+ * @return number of transactions
+ */
+unsigned tsm_transaction_size(void)
+{
+    return TSM_List_Size;
 }
 
 /** Check if space for transactions is available.
@@ -99,41 +286,20 @@ static uint8_t tsm_find_first_free_index(void)
  */
 bool tsm_transaction_available(void)
 {
-    bool status = false; /* return value */
-    unsigned i = 0; /* counter */
+    tsm_list_index_check();
 
-    const BACNET_TSM_DATA *plist = TSM_List;
-
-    for (i = 0; i < MAX_TSM_TRANSACTIONS; i++, plist++) {
-        if (plist->InvokeID == 0) {
-            /* one is available! */
-            status = true;
-            break;
-        }
-    }
-
-    return status;
+    return (TSM_Free_Head != TSM_NONE);
 }
 
 /** Return the count of idle transaction.
  *
  * @return Count of idle transaction.
  */
-uint8_t tsm_transaction_idle_count(void)
+unsigned tsm_transaction_idle_count(void)
 {
-    uint8_t count = 0; /* return value */
-    unsigned i = 0; /* counter */
-
-    const BACNET_TSM_DATA *plist = TSM_List;
+    tsm_list_index_check();
 
-    for (i = 0; i < MAX_TSM_TRANSACTIONS; i++, plist++) {
-        if ((plist->InvokeID == 0) && (plist->state == TSM_STATE_IDLE)) {
-            /* one is available! */
-            count++;
-        }
-    }
-
-    return count;
+    return TSM_List_Size - TSM_Active_Count;
 }
 
 /**
@@ -149,49 +315,34 @@ void tsm_invokeID_set(uint8_t invokeID)
     Current_Invoke_ID = invokeID;
 }
 
-/** Gets the next free invokeID,
+/** Gets the next free invokeID that is not used with the peer,
  * and reserves a spot in the table
  * returns 0 if none are available.
  *
+ * @param dest  Address of the peer the request is sent to
  * @return free invoke ID
  */
-uint8_t tsm_next_free_invokeID(void)
+uint8_t tsm_next_free_invokeID(const BACNET_ADDRESS *dest)
 {
-    uint8_t index = 0;
     uint8_t invokeID = 0;
-    bool found = false;
-    BACNET_TSM_DATA *plist = NULL;
+    unsigned tries = 0;
 
     /* Is there even space available? */
-    if (tsm_transaction_available()) {
-        while (!found) {
-            index = tsm_find_invokeID_index(Current_Invoke_ID);
-            if (index == MAX_TSM_TRANSACTIONS) {
+    if (dest && tsm_transaction_available()) {
+        for (tries = 0; tries < 255; tries++) {
+            if (!tsm_find(dest, Current_Invoke_ID)) {
                 /* Not found, so this invokeID is not used */
-                found = true;
-                /* set this id into the table */
-                index = tsm_find_first_free_index();
-                if (index != MAX_TSM_TRANSACTIONS) {
-                    plist = &TSM_List[index];
-                    plist->InvokeID = invokeID = Current_Invoke_ID;
-                    plist->state = TSM_STATE_IDLE;
-                    plist->RequestTimer = apdu_timeout();
-                    /* update for the next call or check */
-                    Current_Invoke_ID++;
-                    /* skip zero - we treat that internally as invalid or no
-                     * free */
-                    if (Current_Invoke_ID == 0) {
-                        Current_Invoke_ID = 1;
-                    }
-                }
-            } else {
-                /* found! This invokeID is already used */
-                /* try next one */
-                Current_Invoke_ID++;
-                /* skip zero - we treat that internally as invalid or no free */
-                if (Current_Invoke_ID == 0) {
-                    Current_Invoke_ID = 1;
-                }
+                invokeID = Current_Invoke_ID;
+                (void)tsm_reserve(dest, invokeID);
+            }
+            /* update for the next call or check */
+            Current_Invoke_ID++;
+            /* skip zero - we treat that internally as invalid or no free */
+            if (Current_Invoke_ID == 0) {
+                Current_Invoke_ID = 1;
+            }
+            if (invokeID) {
+                break;
             }
         }
     }
@@ -199,8 +350,30 @@ uint8_t tsm_next_free_invokeID(void)
     return invokeID;
 }
 
+/** Get the buffer of a reserved transaction, so that a confirmed request
+ *  can be encoded into it and kept for retries without being copied.
+ *
+ * @param dest  Address of the peer the request is sent to
+ * @param invokeID  Invoke-ID from tsm_next_free_invokeID()
+ * @return pointer to a buffer of MAX_PDU octets, or NULL if not found
+ */
+uint8_t *
+tsm_transaction_pdu_buffer(const BACNET_ADDRESS *dest, uint8_t invokeID)
+{
+    BACNET_TSM_DATA *plist;
+
+    plist = tsm_find(dest, invokeID);
+    if (plist) {
+        return &plist->apdu[0];
+    }
+
+    return NULL;
+}
+
 /** Set for an unsegmented transaction
  *  the state to await confirmation.
+ *  The PDU is not copied if it was encoded in the transaction buffer
+ *  from tsm_transaction_pdu_buffer().
  *
  * @param invokeID  Invoke-ID
  * @param dest  Pointer to the BACnet destination address.
@@ -215,26 +388,23 @@ void tsm_set_confirmed_unsegmented_transaction(
     const uint8_t *apdu,
     uint16_t apdu_len)
 {
-    uint16_t j = 0;
-    uint8_t index;
     BACNET_TSM_DATA *plist;
 
-    if (invokeID && ndpu_data && apdu && (apdu_len > 0)) {
-        index = tsm_find_invokeID_index(invokeID);
-        if (index < MAX_TSM_TRANSACTIONS) {
-            plist = &TSM_List[index];
+    if (invokeID && ndpu_data && apdu && (apdu_len > 0) &&
+        (apdu_len <= MAX_PDU)) {
+        plist = tsm_find(dest, invokeID);
+        if (plist) {
             /* SendConfirmedUnsegmented */
             plist->state = TSM_STATE_AWAIT_CONFIRMATION;
             plist->RetryCount = 0;
             /* start the timer */
             plist->RequestTimer = apdu_timeout();
             /* copy the data */
-            for (j = 0; j < apdu_len; j++) {
-                plist->apdu[j] = apdu[j];
+            if (apdu != &plist->apdu[0]) {
+                memcpy(&plist->apdu[0], apdu, apdu_len);
             }
             plist->apdu_len = apdu_len;
             npdu_copy_data(&plist->npdu_data, ndpu_data);
-            bacnet_address_copy(&plist->dest, dest);
         }
     }
 
@@ -245,8 +415,8 @@ void tsm_set_confirmed_unsegmented_transaction(
  *  if we wanted to find out what we sent (i.e. when
  *  we get an ack).
  *
+ * @param dest  Pointer to the BACnet address of the peer.
  * @param invokeID  Invoke-ID
- * @param dest  Pointer to the BACnet destination address.
  * @param ndpu_data  Pointer to the NPDU structure.
  * @param apdu  Pointer to the received message.
  * @param apdu_len  Pointer to a variable, that takes
@@ -254,34 +424,27 @@ void tsm_set_confirmed_unsegmented_transaction(
  *                  received message.
  */
 bool tsm_get_transaction_pdu(
+    const BACNET_ADDRESS *dest,
     uint8_t invokeID,
-    BACNET_ADDRESS *dest,
     BACNET_NPDU_DATA *ndpu_data,
     uint8_t *apdu,
     uint16_t *apdu_len)
 {
-    uint16_t j = 0;
-    uint8_t index;
     bool found = false;
     BACNET_TSM_DATA *plist;
 
     if (invokeID && apdu && ndpu_data && apdu_len) {
-        index = tsm_find_invokeID_index(invokeID);
-        /* how much checking is needed?  state?  dest match? just invokeID? */
-        if (index < MAX_TSM_TRANSACTIONS) {
+        plist = tsm_find(dest, invokeID);
+        if (plist) {
             /* FIXME: we may want to free the transaction so it doesn't timeout
              */
             /* retrieve the transaction */
-            plist = &TSM_List[index];
             *apdu_len = (uint16_t)plist->apdu_len;
             if (*apdu_len > MAX_PDU) {
                 *apdu_len = MAX_PDU;
             }
-            for (j = 0; j < *apdu_len; j++) {
-                apdu[j] = plist->apdu[j];
-            }
+            memcpy(apdu, &plist->apdu[0], *apdu_len);
             npdu_copy_data(ndpu_data, &plist->npdu_data);
-            bacnet_address_copy(dest, &plist->dest);
             found = true;
         }
     }
@@ -289,6 +452,738 @@ bool tsm_get_transaction_pdu(
     return found;
 }
 
+#if BACNET_SEGMENTATION_ENABLED
+/** Determine the largest APDU segment that the requester accepts.
+ *
+ * @param service_data  Data from the header of the confirmed request.
+ *
+ * @return number of octets in one APDU segment
+ */
+static uint16_t tsm_segment_apdu_max(
+    const BACNET_CONFIRMED_SERVICE_DATA *service_data)
+{
+    uint16_t apdu_max = MAX_APDU;
+
+    if ((service_data->max_resp > 0) && (service_data->max_resp < apdu_max)) {
+        apdu_max = (uint16_t)service_data->max_resp;
+    }
+
+    return apdu_max;
+}
+
+/** Determine the number of segments we may use in a response.
+ *
+ * @param service_data  Data from the header of the confirmed request.
+ *
+ * @return number of segments allowed in the response
+ */
+static uint16_t
+tsm_segments_max(const BACNET_CONFIRMED_SERVICE_DATA *service_data)
+{
+    uint16_t segments = apdu_max_segments_accepted();
+
+    /* zero is unspecified, and more than 64 is encoded as 65 */
+    if ((service_data->max_segs > 0) && (service_data->max_segs <= 64) &&
+        (service_data->max_segs < segments)) {
+        segments = (uint16_t)service_data->max_segs;
+    }
+
+    return segments;
+}
+
+/** Determine the largest Complex-ACK that can be sent to the requester,
+ *  in segments if the requester accepts a segmented response.
+ *  Service handlers use this as the limit when encoding into
+ *  Handler_Segmented_Buffer.
+ *
+ * @param service_data  Data from the header of the confirmed request.
+ *
+ * @return number of octets of the whole unsegmented Complex-ACK APDU
+ */
+uint16_t tsm_segmented_response_apdu_max(
+    const BACNET_CONFIRMED_SERVICE_DATA *service_data)
+{
+    uint32_t apdu_max = 0;
+
+    if (!service_data) {
+        return 0;
+    }
+    apdu_max = tsm_segment_apdu_max(service_data);
+    if (service_data->segmented_response_accepted) {
+        /* each segment repeats the header with two more octets
+           than the 3 octet header of an unsegmented Complex-ACK */
+        apdu_max = 3 + (tsm_segments_max(service_data) * (apdu_max - 5));
+        if (apdu_max > BACNET_SEGMENTATION_APDU_MAX) {
+            apdu_max = BACNET_SEGMENTATION_APDU_MAX;
+        }
+    }
+
+    return (uint16_t)apdu_max;
+}
+
+/** Find the segmented response to the given peer and invoke ID.
+ *
+ * @param dest  Address of the requester.
+ * @param invokeID  Invoke ID chosen by the requester.
+ *
+ * @return the segmented transaction, or NULL if not found
+ */
+static BACNET_TSM_SEGMENTED_DATA *
+tsm_segmented_find(const BACNET_ADDRESS *dest, uint8_t invokeID)
+{
+    unsigned i = 0;
+    BACNET_TSM_SEGMENTED_DATA *plist = &TSM_Segmented_List[0];
+
+    for (i = 0; i < BACNET_SEGMENTATION_TRANSACTIONS; i++, plist++) {
+        if ((plist->state == TSM_STATE_SEGMENTED_RESPONSE) &&
+            (plist->InvokeID == invokeID) &&
+            bacnet_address_same(&plist->dest, dest)) {
+            return plist;
+        }
+    }
+
+    return NULL;
+}
+
+/** Find an idle segmented transaction slot.
+ *
+ * @return the segmented transaction, or NULL if none are idle
+ */
+static BACNET_TSM_SEGMENTED_DATA *tsm_segmented_find_free(void)
+{
+    unsigned i = 0;
+    BACNET_TSM_SEGMENTED_DATA *plist = &TSM_Segmented_List[0];
+
+    for (i = 0; i < BACNET_SEGMENTATION_TRANSACTIONS; i++, plist++) {
+        if (plist->state == TSM_STATE_IDLE) {
+            return plist;
+        }
+    }
+
+    return NULL;
+}
+
+/** Send one segment of a segmented Complex-ACK.
+ *
+ * @param plist  The segmented transaction.
+ * @param sequence_number  The segment to send.
+ *
+ * @return number of bytes sent, or less than or equal to zero on error
+ */
+static int
+tsm_segment_send(BACNET_TSM_SEGMENTED_DATA *plist, uint8_t sequence_number)
+{
+    BACNET_ADDRESS my_address;
+    uint8_t *apdu = NULL;
+    uint32_t offset = 0;
+    uint16_t len = 0;
+    int pdu_len = 0;
+
+    offset = (uint32_t)sequence_number * plist->segment_len;
+    if (offset >= plist->service_data_len) {
+        return 0;
+    }
+    len = plist->segment_len;
+    if ((offset + len) > plist->service_data_len) {
+        len = (uint16_t)(plist->service_data_len - offset);
+    }
+    datalink_get_my_address(&my_address);
+    pdu_len = npdu_encode_pdu(
+        &Segment_Transmit_Buffer[0], &plist->dest, &my_address,
+        &plist->npdu_data);
+    apdu = &Segment_Transmit_Buffer[pdu_len];
+    apdu[0] = PDU_TYPE_COMPLEX_ACK | BIT(3);
+    if ((sequence_number + 1U) < plist->segment_count) {
+        /* more follows */
+        apdu[0] |= BIT(2);
+    }
+    apdu[1] = plist->InvokeID;
+    apdu[2] = sequence_number;
+    apdu[3] = apdu_segment_window_size();
+    apdu[4] = plist->service_choice;
+    memcpy(&apdu[5], &plist->service_data[offset], len);
+    pdu_len += 5 + len;
+
+    return datalink_send_pdu(
+        &plist->dest, &plist->npdu_data, &Segment_Transmit_Buffer[0],
+        (unsigned)pdu_len);
+}
+
+/** Send the segments of the current window (FillWindow).
+ *
+ * @param plist  The segmented transaction.
+ */
+static void tsm_segmented_window_send(BACNET_TSM_SEGMENTED_DATA *plist)
+{
+    unsigned i = 0;
+    unsigned sequence_number = 0;
+
+    for (i = 0; i < plist->ActualWindowSize; i++) {
+        sequence_number = plist->InitialSequenceNumber + i;
+        if (sequence_number >= plist->segment_count) {
+            break;
+        }
+        tsm_segment_send(plist, (uint8_t)sequence_number);
+    }
+    plist->SegmentTimer = apdu_segment_timeout();
+}
+
+/** Send an Abort in reply to a confirmed request.
+ *
+ * @param dest  Address of the requester.
+ * @param npdu_data  Network layer info for the reply.
+ * @param invoke_id  Invoke ID chosen by the requester.
+ * @param reason  Abort reason.
+ *
+ * @return number of bytes sent, or less than or equal to zero on error
+ */
+static int tsm_abort_send(
+    BACNET_ADDRESS *dest,
+    const BACNET_NPDU_DATA *npdu_data,
+    uint8_t invoke_id,
+    BACNET_ABORT_REASON reason)
+{
+    BACNET_ADDRESS my_address;
+    BACNET_NPDU_DATA reply_data;
+    int pdu_len = 0;
+
+    datalink_get_my_address(&my_address);
+    npdu_copy_data(&reply_data, npdu_data);
+    reply_data.data_expecting_reply = false;
+    pdu_len = npdu_encode_pdu(
+        &Segment_Transmit_Buffer[0], dest, &my_address, &reply_data);
+    pdu_len += abort_encode_apdu(
+        &Segment_Transmit_Buffer[pdu_len], invoke_id, reason, true);
+
+    return datalink_send_pdu(
+        dest, &reply_data, &Segment_Transmit_Buffer[0], (unsigned)pdu_len);
+}
+
+/** Send the reply to a confirmed request. A Complex-ACK that does not
+ *  fit into one APDU is sent in segments when the requester accepts
+ *  a segmented response, otherwise an Abort is sent.
+ *
+ * @param dest  Address of the requester.
+ * @param npdu_data  Network layer info for the reply.
+ * @param service_data  Data from the header of the confirmed request.
+ * @param apdu  The reply APDU - Complex-ACK, Simple-ACK, Error,
+ *  Reject, or Abort, encoded unsegmented.
+ * @param apdu_len  Number of octets in the reply APDU.
+ *
+ * @return number of bytes sent, or less than or equal to zero on error
+ */
+int tsm_confirmed_reply_send(
+    BACNET_ADDRESS *dest,
+    const BACNET_NPDU_DATA *npdu_data,
+    const BACNET_CONFIRMED_SERVICE_DATA *service_data,
+    const uint8_t *apdu,
+    uint16_t apdu_len)
+{
+    BACNET_ADDRESS my_address;
+    BACNET_NPDU_DATA reply_data;
+    BACNET_TSM_SEGMENTED_DATA *plist;
+    uint16_t apdu_max = 0;
+    uint16_t segment_len = 0;
+    uint32_t segment_count = 0;
+    int pdu_len = 0;
+
+    if (!dest || !npdu_data || !service_data || !apdu || (apdu_len < 3)) {
+        return -1;
+    }
+    apdu_max = tsm_segment_apdu_max(service_data);
+    if ((apdu_len <= apdu_max) ||
+        ((apdu[0] & 0xF0) != PDU_TYPE_COMPLEX_ACK)) {
+        datalink_get_my_address(&my_address);
+        pdu_len = npdu_encode_pdu(
+            &Segment_Transmit_Buffer[0], dest, &my_address, npdu_data);
+        if ((pdu_len + apdu_len) > (int)sizeof(Segment_Transmit_Buffer)) {
+            return -1;
+        }
+        memcpy(&Segment_Transmit_Buffer[pdu_len], apdu, apdu_len);
+        pdu_len += apdu_len;
+        return datalink_send_pdu(
+            dest, (BACNET_NPDU_DATA *)npdu_data, &Segment_Transmit_Buffer[0],
+            (unsigned)pdu_len);
+    }
+    if (!service_data->segmented_response_accepted) {
+        return tsm_abort_send(
+            dest, npdu_data, service_data->invoke_id,
+            ABORT_REASON_SEGMENTATION_NOT_SUPPORTED);
+    }
+    segment_len = apdu_max - 5;
+    segment_count = ((apdu_len - 3) + segment_len - 1) / segment_len;
+    if ((segment_count > tsm_segments_max(service_data)) ||
+        ((apdu_len - 3) > BACNET_SEGMENTATION_APDU_MAX)) {
+        return tsm_abort_send(
+            dest, npdu_data, service_data->invoke_id,
+            ABORT_REASON_BUFFER_OVERFLOW);
+    }
+    /* a repeated request restarts the response */
+    plist = tsm_segmented_find(dest, service_data->invoke_id);
+    if (!plist) {
+        plist = tsm_segmented_find_free();
+    }
+    if (!plist) {
+        return tsm_abort_send(
+            dest, npdu_data, service_data->invoke_id,
+            ABORT_REASON_OUT_OF_RESOURCES);
+    }
+    /* SendSegmentedComplexACK */
+    plist->state = TSM_STATE_SEGMENTED_RESPONSE;
+    plist->InvokeID = service_data->invoke_id;
+    plist->service_choice = apdu[2];
+    plist->SegmentRetryCount = 0;
+    plist->InitialSequenceNumber = 0;
+    /* the requester tells us its window in the first Segment-ACK */
+    plist->ActualWindowSize = 1;
+    plist->segment_len = segment_len;
+    plist->segment_count = (uint16_t)segment_count;
+    plist->service_data_len = apdu_len - 3;
+    memcpy(&plist->service_data[0], &apdu[3], plist->service_data_len);
+    bacnet_address_copy(&plist->dest, dest);
+    npdu_copy_data(&reply_data, npdu_data);
+    /* each segment solicits a Segment-ACK */
+    reply_data.data_expecting_reply = true;
+    npdu_copy_data(&plist->npdu_data, &reply_data);
+    tsm_segmented_window_send(plist);
+
+    return apdu_len;
+}
+
+/** Handle a Segment-ACK for one of our segmented transactions.
+ *
+ * @param src  Address of the peer that sent the Segment-ACK.
+ * @param invoke_id  Invoke ID of the transaction.
+ * @param sequence_number  Sequence number being acknowledged.
+ * @param actual_window_size  Window size the peer will accept.
+ * @param nak  True if segments were received out of order.
+ * @param server  True if sent by a server - for segmented requests.
+ */
+void tsm_segment_ack_handler(
+    const BACNET_ADDRESS *src,
+    uint8_t invoke_id,
+    uint8_t sequence_number,
+    uint8_t actual_window_size,
+    bool nak,
+    bool server)
+{
+    BACNET_TSM_SEGMENTED_DATA *plist;
+    uint8_t window_offset = 0;
+
+    if (server || !src) {
+        /* we don't send segmented requests */
+        return;
+    }
+    plist = tsm_segmented_find(src, invoke_id);
+    if (!plist) {
+        return;
+    }
+    window_offset = (uint8_t)(sequence_number - plist->InitialSequenceNumber);
+    if (window_offset >= plist->ActualWindowSize) {
+        if (nak && (window_offset == 0xFF)) {
+            /* the requester missed the first segment of the window */
+            tsm_segmented_window_send(plist);
+            return;
+        }
+        /* DuplicateACK_Received */
+        plist->SegmentTimer = apdu_segment_timeout();
+        return;
+    }
+    if ((sequence_number + 1U) >= plist->segment_count) {
+        /* FinalACK_Received */
+        plist->state = TSM_STATE_IDLE;
+        return;
+    }
+    /* NewACK_Received - a negative ACK also resends
+       from the segment after the one acknowledged */
+    plist->InitialSequenceNumber = sequence_number + 1;
+    if (actual_window_size == 0) {
+        actual_window_size = 1;
+    } else if (actual_window_size > 127) {
+        actual_window_size = 127;
+    }
+    plist->ActualWindowSize = actual_window_size;
+    plist->SegmentRetryCount = 0;
+    tsm_segmented_window_send(plist);
+}
+
+/** Stop a segmented response because the requester sent an Abort.
+ *
+ * @param src  Address of the requester.
+ * @param invoke_id  Invoke ID chosen by the requester.
+ */
+void tsm_segmented_response_abort(const BACNET_ADDRESS *src, uint8_t invoke_id)
+{
+    BACNET_TSM_SEGMENTED_DATA *plist;
+
+    plist = tsm_segmented_find(src, invoke_id);
+    if (plist) {
+        plist->state = TSM_STATE_IDLE;
+    }
+}
+
+/** Count the segmented responses in progress.
+ *
+ * @return number of segmented responses in progress
+ */
+uint8_t tsm_segmented_response_count(void)
+{
+    unsigned i = 0;
+    uint8_t count = 0;
+
+    for (i = 0; i < BACNET_SEGMENTATION_TRANSACTIONS; i++) {
+        if (TSM_Segmented_List[i].state == TSM_STATE_SEGMENTED_RESPONSE) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/** Mark our confirmed request as failed, and keep the invoke ID
+ *  so that tsm_invoke_id_failed() reports the failure.
+ *
+ * @param dest  Address of the server.
+ * @param invokeID  Invoke-ID of our request.
+ */
+static void
+tsm_confirmation_failed(const BACNET_ADDRESS *dest, uint8_t invokeID)
+{
+    BACNET_TSM_DATA *plist;
+
+    plist = tsm_find(dest, invokeID);
+    if (plist) {
+        plist->state = TSM_STATE_IDLE;
+    }
+}
+
+/** Set the confirmed request header to accept a segmented response
+ *  with up to Max_Segments_Accepted segments of our MAX_APDU.
+ *  Called after the confirmed request is encoded.
+ *
+ * @param apdu  The encoded confirmed request APDU.
+ * @param apdu_len  Number of octets in the confirmed request APDU.
+ */
+void tsm_confirmed_request_segmentation_set(uint8_t *apdu, uint16_t apdu_len)
+{
+    if (!apdu || (apdu_len < 4)) {
+        return;
+    }
+    if ((apdu[0] & 0xF0) != PDU_TYPE_CONFIRMED_SERVICE_REQUEST) {
+        return;
+    }
+    /* segmented-response-accepted */
+    apdu[0] |= BIT(1);
+    apdu[1] = encode_max_segs_max_apdu(apdu_max_segments_accepted(), MAX_APDU);
+}
+
+/** Find the segmented Complex-ACK being received from the given peer.
+ *
+ * @param src  Address of the server.
+ * @param invokeID  Invoke ID of our request.
+ *
+ * @return the reassembly buffer, or NULL if not found
+ */
+static BACNET_TSM_REASSEMBLY_DATA *
+tsm_reassembly_find(const BACNET_ADDRESS *src, uint8_t invokeID)
+{
+    unsigned i = 0;
+    BACNET_TSM_REASSEMBLY_DATA *plist = &TSM_Reassembly_List[0];
+
+    for (i = 0; i < BACNET_SEGMENTATION_REASSEMBLY_BUFFERS; i++, plist++) {
+        if ((plist->state == TSM_STATE_SEGMENTED_CONFIRMATION) &&
+            (plist->InvokeID == invokeID) &&
+            bacnet_address_same(&plist->src, src)) {
+            return plist;
+        }
+    }
+
+    return NULL;
+}
+
+/** Find an idle reassembly buffer.
+ *
+ * @return the reassembly buffer, or NULL if none are idle
+ */
+static BACNET_TSM_REASSEMBLY_DATA *tsm_reassembly_find_free(void)
+{
+    unsigned i = 0;
+    BACNET_TSM_REASSEMBLY_DATA *plist = &TSM_Reassembly_List[0];
+
+    for (i = 0; i < BACNET_SEGMENTATION_REASSEMBLY_BUFFERS; i++, plist++) {
+        if (plist->state == TSM_STATE_IDLE) {
+            return plist;
+        }
+    }
+
+    return NULL;
+}
+
+/** Determine the time we wait for the next segment from the server.
+ *
+ * @return the time in milliseconds - four times the segment timeout
+ */
+static uint16_t tsm_reassembly_timeout(void)
+{
+    uint32_t milliseconds = 4UL * apdu_segment_timeout();
+
+    if (milliseconds > UINT16_MAX) {
+        milliseconds = UINT16_MAX;
+    }
+
+    return (uint16_t)milliseconds;
+}
+
+/** Send a Segment-ACK from the client to the server.
+ *
+ * @param dest  Address of the server.
+ * @param invoke_id  Invoke ID of our request.
+ * @param sequence_number  Sequence number being acknowledged.
+ * @param actual_window_size  Window size that we accept.
+ * @param nak  True if a segment was received out of order.
+ *
+ * @return number of bytes sent, or less than or equal to zero on error
+ */
+static int tsm_segment_ack_send(
+    BACNET_ADDRESS *dest,
+    uint8_t invoke_id,
+    uint8_t sequence_number,
+    uint8_t actual_window_size,
+    bool nak)
+{
+    BACNET_ADDRESS my_address;
+    BACNET_NPDU_DATA npdu_data;
+    uint8_t *apdu = NULL;
+    int pdu_len = 0;
+
+    datalink_get_my_address(&my_address);
+    npdu_encode_npdu_data(&npdu_data, false, MESSAGE_PRIORITY_NORMAL);
+    pdu_len = npdu_encode_pdu(
+        &Segment_Transmit_Buffer[0], dest, &my_address, &npdu_data);
+    apdu = &Segment_Transmit_Buffer[pdu_len];
+    apdu[0] = PDU_TYPE_SEGMENT_ACK;
+    if (nak) {
+        apdu[0] |= BIT(1);
+    }
+    apdu[1] = invoke_id;
+    apdu[2] = sequence_number;
+    apdu[3] = actual_window_size;
+    pdu_len += 4;
+
+    return datalink_send_pdu(
+        dest, &npdu_data, &Segment_Transmit_Buffer[0], (unsigned)pdu_len);
+}
+
+/** Abort our confirmed request because the segmented Complex-ACK
+ *  cannot be received.
+ *
+ * @param src  Address of the server.
+ * @param invoke_id  Invoke ID of our request.
+ * @param reason  Abort reason.
+ */
+static void tsm_reassembly_abort(
+    const BACNET_ADDRESS *src, uint8_t invoke_id, BACNET_ABORT_REASON reason)
+{
+    BACNET_ADDRESS dest;
+    BACNET_NPDU_DATA npdu_data;
+
+    bacnet_address_copy(&dest, src);
+    npdu_encode_npdu_data(&npdu_data, false, MESSAGE_PRIORITY_NORMAL);
+    tsm_abort_send(&dest, &npdu_data, invoke_id, reason);
+    tsm_confirmation_failed(src, invoke_id);
+}
+
+/** Handle one segment of a segmented Complex-ACK that answers one of
+ *  our confirmed requests. Each window of segments is acknowledged,
+ *  and the whole Complex-ACK is returned after the final segment.
+ *
+ * @param src  Address of the server that sent the segment.
+ * @param apdu  The segment - a Complex-ACK APDU with the segmented bit set.
+ * @param apdu_len  Number of octets in the segment.
+ * @param complex_ack  Set to the reassembled Complex-ACK, with an
+ *  unsegmented header, which is valid until the next segment is handled.
+ *
+ * @return number of octets in the reassembled Complex-ACK, or zero
+ *  if more segments are expected or the segment was discarded.
+ */
+uint16_t tsm_segmented_complex_ack_handler(
+    const BACNET_ADDRESS *src,
+    const uint8_t *apdu,
+    uint16_t apdu_len,
+    uint8_t **complex_ack)
+{
+    BACNET_TSM_REASSEMBLY_DATA *plist;
+    BACNET_TSM_DATA *request;
+    bool more_follows = false;
+    uint8_t invoke_id = 0;
+    uint8_t sequence_number = 0;
+    uint8_t window_size = 0;
+    uint16_t data_len = 0;
+
+    if (!src || !apdu || !complex_ack || (apdu_len < 5)) {
+        return 0;
+    }
+    more_follows = (apdu[0] & BIT(2)) ? true : false;
+    invoke_id = apdu[1];
+    sequence_number = apdu[2];
+    data_len = apdu_len - 5;
+    plist = tsm_reassembly_find(src, invoke_id);
+    if (!plist) {
+        if (sequence_number != 0) {
+            /* not for us, or after we gave up */
+            return 0;
+        }
+        request = tsm_find(src, invoke_id);
+        if (!request || (request->state != TSM_STATE_AWAIT_CONFIRMATION)) {
+            return 0;
+        }
+        plist = tsm_reassembly_find_free();
+        if (!plist) {
+            tsm_reassembly_abort(src, invoke_id, ABORT_REASON_OUT_OF_RESOURCES);
+            return 0;
+        }
+        /* SegmentedComplexACK_Received - stop the request timer */
+        request->state = TSM_STATE_SEGMENTED_CONFIRMATION;
+        plist->state = TSM_STATE_SEGMENTED_CONFIRMATION;
+        plist->InvokeID = invoke_id;
+        bacnet_address_copy(&plist->src, src);
+        window_size = apdu[3];
+        if (window_size > apdu_segment_window_size()) {
+            window_size = apdu_segment_window_size();
+        }
+        if (window_size == 0) {
+            window_size = 1;
+        }
+        plist->ActualWindowSize = window_size;
+        plist->InitialSequenceNumber = 0;
+        plist->LastSequenceNumber = 0;
+        plist->apdu[0] = PDU_TYPE_COMPLEX_ACK;
+        plist->apdu[1] = invoke_id;
+        plist->apdu[2] = apdu[4];
+        plist->apdu_len = 3;
+    } else if (sequence_number == (uint8_t)(plist->LastSequenceNumber + 1)) {
+        /* NewSegmentReceived */
+        plist->LastSequenceNumber = sequence_number;
+    } else if (
+        (uint8_t)(plist->LastSequenceNumber - sequence_number) <
+        plist->ActualWindowSize) {
+        /* DuplicateSegmentReceived - already received, so discard it
+           silently (clause 5.4) */
+        return 0;
+    } else {
+        /* SegmentReceivedOutOfOrder - ask for the segments after
+           the last one received in order */
+        plist->InitialSequenceNumber = plist->LastSequenceNumber;
+        plist->SegmentTimer = tsm_reassembly_timeout();
+        tsm_segment_ack_send(
+            &plist->src, invoke_id, plist->LastSequenceNumber,
+            plist->ActualWindowSize, true);
+        return 0;
+    }
+    if ((plist->apdu_len + data_len) > sizeof(plist->apdu)) {
+        plist->state = TSM_STATE_IDLE;
+        tsm_reassembly_abort(src, invoke_id, ABORT_REASON_BUFFER_OVERFLOW);
+        return 0;
+    }
+    memcpy(&plist->apdu[plist->apdu_len], &apdu[5], data_len);
+    plist->apdu_len += data_len;
+    plist->SegmentTimer = tsm_reassembly_timeout();
+    if (!more_follows) {
+        /* LastSegmentOfComplexACK_Received */
+        tsm_segment_ack_send(
+            &plist->src, invoke_id, sequence_number, plist->ActualWindowSize,
+            false);
+        plist->state = TSM_STATE_IDLE;
+        *complex_ack = &plist->apdu[0];
+        return plist->apdu_len;
+    }
+    if ((sequence_number == 0) ||
+        (sequence_number ==
+         (uint8_t)(plist->InitialSequenceNumber + plist->ActualWindowSize))) {
+        /* LastSegmentOfGroupReceived */
+        plist->InitialSequenceNumber = sequence_number;
+        tsm_segment_ack_send(
+            &plist->src, invoke_id, sequence_number, plist->ActualWindowSize,
+            false);
+    }
+
+    return 0;
+}
+
+/** Count the segmented Complex-ACK being received.
+ *
+ * @return number of segmented Complex-ACK being received
+ */
+uint8_t tsm_segmented_confirmation_count(void)
+{
+    unsigned i = 0;
+    uint8_t count = 0;
+
+    for (i = 0; i < BACNET_SEGMENTATION_REASSEMBLY_BUFFERS; i++) {
+        if (TSM_Reassembly_List[i].state == TSM_STATE_SEGMENTED_CONFIRMATION) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/** Give up on a segmented Complex-ACK when the server stops sending
+ *  segments, and report the timeout of our request.
+ *
+ * @param milliseconds - Count of milliseconds passed, since the last call.
+ */
+static void tsm_reassembly_timer(uint16_t milliseconds)
+{
+    unsigned i = 0;
+    BACNET_TSM_REASSEMBLY_DATA *plist = &TSM_Reassembly_List[0];
+
+    for (i = 0; i < BACNET_SEGMENTATION_REASSEMBLY_BUFFERS; i++, plist++) {
+        if (plist->state != TSM_STATE_SEGMENTED_CONFIRMATION) {
+            continue;
+        }
+        if (plist->SegmentTimer > milliseconds) {
+            plist->SegmentTimer -= milliseconds;
+            continue;
+        }
+        plist->SegmentTimer = 0;
+        plist->state = TSM_STATE_IDLE;
+        tsm_confirmation_failed(&plist->src, plist->InvokeID);
+        if (Timeout_Function) {
+            Timeout_Function(&plist->src, plist->InvokeID);
+        }
+    }
+}
+
+/** Resend the current window of segments when the requester does
+ *  not acknowledge them in time, and give up after the retries.
+ *
+ * @param milliseconds - Count of milliseconds passed, since the last call.
+ */
+static void tsm_segmented_timer(uint16_t milliseconds)
+{
+    unsigned i = 0;
+    BACNET_TSM_SEGMENTED_DATA *plist = &TSM_Segmented_List[0];
+
+    for (i = 0; i < BACNET_SEGMENTATION_TRANSACTIONS; i++, plist++) {
+        if (plist->state != TSM_STATE_SEGMENTED_RESPONSE) {
+            continue;
+        }
+        if (plist->SegmentTimer > milliseconds) {
+            plist->SegmentTimer -= milliseconds;
+            continue;
+        }
+        plist->SegmentTimer = 0;
+        if (plist->SegmentRetryCount < apdu_retries()) {
+            plist->SegmentRetryCount++;
+            tsm_segmented_window_send(plist);
+        } else {
+            plist->state = TSM_STATE_IDLE;
+        }
+    }
+}
+#endif
+
 /** Called once a millisecond or slower.
  *  This function calls the handler for a
  *  timeout 'Timeout_Function', if necessary.
@@ -297,11 +1192,19 @@ bool tsm_get_transaction_pdu(
  */
 void tsm_timer_milliseconds(uint16_t milliseconds)
 {
-    unsigned i = 0; /* counter */
-
-    BACNET_TSM_DATA *plist = &TSM_List[0];
+    unsigned i; /* counter */
+    BACNET_TSM_DATA *plist;
 
-    for (i = 0; i < MAX_TSM_TRANSACTIONS; i++, plist++) {
+    tsm_list_index_check();
+    /* backwards, so that a transaction freed by the timeout handler
+       does not move an unvisited one behind us */
+    i = TSM_Active_Count;
+    while (i > 0) {
+        i--;
+        if (i >= TSM_Active_Count) {
+            continue;
+        }
+        plist = &TSM_List[TSM_Active[i]];
         if (plist->state == TSM_STATE_AWAIT_CONFIRMATION) {
             if (plist->RequestTimer > milliseconds) {
                 plist->RequestTimer -= milliseconds;
@@ -323,67 +1226,100 @@ void tsm_timer_milliseconds(uint16_t milliseconds)
                     plist->state = TSM_STATE_IDLE;
                     if (plist->InvokeID != 0) {
                         if (Timeout_Function) {
-                            Timeout_Function(plist->InvokeID);
+                            Timeout_Function(&plist->dest, plist->InvokeID);
                         }
                     }
                 }
             }
         }
     }
+#if BACNET_SEGMENTATION_ENABLED
+    tsm_segmented_timer(milliseconds);
+    tsm_reassembly_timer(milliseconds);
+#endif
+}
+
+/** Check if any transaction is waiting on a timer, so that an idle
+ *  application can stop calling tsm_timer_milliseconds().
+ *
+ * @return true if a request, segment or reassembly is timing
+ */
+bool tsm_timer_active(void)
+{
+    unsigned i;
+
+    tsm_list_index_check();
+    for (i = 0; i < TSM_Active_Count; i++) {
+        if (TSM_List[TSM_Active[i]].state == TSM_STATE_AWAIT_CONFIRMATION) {
+            return true;
+        }
+    }
+#if BACNET_SEGMENTATION_ENABLED
+    if ((tsm_segmented_response_count() > 0) ||
+        (tsm_segmented_confirmation_count() > 0)) {
+        return true;
+    }
+#endif
+
+    return false;
 }
 
-/** Frees the invokeID and sets its state to IDLE
+/** Frees the invokeID of the peer and sets its state to IDLE.
+ *  The segmented Complex-ACK being received for it is also freed.
  *
+ * @param dest  Address of the peer
  * @param invokeID  Invoke-ID
  */
-void tsm_free_invoke_id(uint8_t invokeID)
+void tsm_free_invoke_id(const BACNET_ADDRESS *dest, uint8_t invokeID)
 {
-    uint8_t index;
     BACNET_TSM_DATA *plist;
+#if BACNET_SEGMENTATION_ENABLED
+    unsigned index;
+#endif
 
-    index = tsm_find_invokeID_index(invokeID);
-    if (index < MAX_TSM_TRANSACTIONS) {
-        plist = &TSM_List[index];
-        plist->state = TSM_STATE_IDLE;
-        plist->InvokeID = 0;
+    plist = tsm_find(dest, invokeID);
+    if (plist) {
+        tsm_release(plist);
     }
+#if BACNET_SEGMENTATION_ENABLED
+    for (index = 0; index < BACNET_SEGMENTATION_REASSEMBLY_BUFFERS; index++) {
+        if ((TSM_Reassembly_List[index].InvokeID == invokeID) &&
+            bacnet_address_same(&TSM_Reassembly_List[index].src, dest)) {
+            TSM_Reassembly_List[index].state = TSM_STATE_IDLE;
+        }
+    }
+#endif
 }
 
 /** Check if the invoke ID has been made free by the Transaction State Machine.
+ * @param dest [in] The address of the peer the message was sent to.
  * @param invokeID [in] The invokeID to be checked, normally of last message
  * sent.
  * @return True if it is free (done with), False if still pending in the TSM.
  */
-bool tsm_invoke_id_free(uint8_t invokeID)
+bool tsm_invoke_id_free(const BACNET_ADDRESS *dest, uint8_t invokeID)
 {
-    bool status = true;
-    uint8_t index;
-
-    index = tsm_find_invokeID_index(invokeID);
-    if (index < MAX_TSM_TRANSACTIONS) {
-        status = false;
-    }
-
-    return status;
+    return (tsm_find(dest, invokeID) == NULL);
 }
 
 /** See if we failed get a confirmation for the message associated
  *  with this invoke ID.
+ * @param dest [in] The address of the peer the message was sent to.
  * @param invokeID [in] The invokeID to be checked, normally of last message
  * sent.
  * @return True if already failed, False if done or segmented or still waiting
  *         for a confirmation.
  */
-bool tsm_invoke_id_failed(uint8_t invokeID)
+bool tsm_invoke_id_failed(const BACNET_ADDRESS *dest, uint8_t invokeID)
 {
     bool status = false;
-    uint8_t index;
+    BACNET_TSM_DATA *plist;
 
-    index = tsm_find_invokeID_index(invokeID);
-    if (index < MAX_TSM_TRANSACTIONS) {
+    plist = tsm_find(dest, invokeID);
+    if (plist) {
         /* a valid invoke ID and the state is IDLE is a
            message that failed to confirm */
-        if (TSM_List[index].state == TSM_STATE_IDLE) {
+        if (plist->state == TSM_STATE_IDLE) {
             status = true;
         }
     }
@@ -14,6 +14,7 @@
 /* BACnet Stack defines - first */
 #include "bacnet/bacdef.h"
 /* BACnet Stack API */
+#include "bacnet/apdu.h"
 #include "bacnet/npdu.h"
 
 /* note: TSM functionality is optional - only needed if we are
@@ -31,14 +32,16 @@ BACNET_STACK_EXPORT extern uint8_t Handler_Transmit_Buffer[MAX_PDU];
 #endif /* __cplusplus */
 
 #if (!MAX_TSM_TRANSACTIONS)
-#define tsm_free_invoke_id(x) (void)x;
+#define tsm_free_invoke_id(a, x) ((void)(a), (void)(x))
+#define tsm_timer_active() false
 #else
 typedef enum {
     TSM_STATE_IDLE,
     TSM_STATE_AWAIT_CONFIRMATION,
     TSM_STATE_AWAIT_RESPONSE,
     TSM_STATE_SEGMENTED_REQUEST,
-    TSM_STATE_SEGMENTED_CONFIRMATION
+    TSM_STATE_SEGMENTED_CONFIRMATION,
+    TSM_STATE_SEGMENTED_RESPONSE
 } BACNET_TSM_STATE;
 
 /* 5.4.1 Variables And Parameters */
@@ -65,7 +68,7 @@ typedef struct BACnet_TSM_Data {
     /* used to perform timeout on Confirmed Requests */
     /* in milliseconds */
     uint16_t RequestTimer;
-    /* unique id */
+    /* unique id for the peer in dest */
     uint8_t InvokeID;
     /* state that the TSM is in */
     BACNET_TSM_STATE state;
@@ -76,9 +79,65 @@ typedef struct BACnet_TSM_Data {
     /* copy of the APDU, should we need to send it again */
     uint8_t apdu[MAX_PDU];
     unsigned apdu_len;
+    /* next transaction in the free list, or in the hash bucket */
+    unsigned next;
+    /* position in the list of transactions in use */
+    unsigned active;
 } BACNET_TSM_DATA;
 
-typedef void (*tsm_timeout_function)(uint8_t invoke_id);
+#if BACNET_SEGMENTATION_ENABLED
+/* 5.4.5 Operation of Server - a segmented Complex-ACK in progress */
+typedef struct BACnet_TSM_Segmented_Data {
+    /* state that the TSM is in */
+    BACNET_TSM_STATE state;
+    /* invoke ID of the request that we are answering */
+    uint8_t InvokeID;
+    /* used to count segment retries */
+    uint8_t SegmentRetryCount;
+    /* sequence number of the first segment of the current window */
+    uint8_t InitialSequenceNumber;
+    /* stores the current window size */
+    uint8_t ActualWindowSize;
+    /* used to perform timeout on PDU segments, in milliseconds */
+    uint16_t SegmentTimer;
+    /* service ACK choice repeated in each segment */
+    uint8_t service_choice;
+    /* number of segments and service ACK octets in each segment */
+    uint16_t segment_count;
+    uint16_t segment_len;
+    /* the address we are sending to */
+    BACNET_ADDRESS dest;
+    /* the network layer info */
+    BACNET_NPDU_DATA npdu_data;
+    /* copy of the service ACK data that we are segmenting */
+    uint8_t service_data[BACNET_SEGMENTATION_APDU_MAX];
+    uint16_t service_data_len;
+} BACNET_TSM_SEGMENTED_DATA;
+
+/* 5.4.4 Operation of Client - a segmented Complex-ACK being received */
+typedef struct BACnet_TSM_Reassembly_Data {
+    /* state that the TSM is in */
+    BACNET_TSM_STATE state;
+    /* invoke ID of our request */
+    uint8_t InvokeID;
+    /* stores the sequence number of the last segment received in order */
+    uint8_t LastSequenceNumber;
+    /* sequence number of the first segment of the current window */
+    uint8_t InitialSequenceNumber;
+    /* stores the current window size */
+    uint8_t ActualWindowSize;
+    /* used to perform timeout on PDU segments, in milliseconds */
+    uint16_t SegmentTimer;
+    /* the address of the server sending the segments */
+    BACNET_ADDRESS src;
+    /* the reassembled Complex-ACK with an unsegmented header */
+    uint8_t apdu[BACNET_SEGMENTATION_APDU_MAX];
+    uint16_t apdu_len;
+} BACNET_TSM_REASSEMBLY_DATA;
+#endif
+
+typedef void (*tsm_timeout_function)(
+    const BACNET_ADDRESS *dest, uint8_t invoke_id);
 
 #ifdef __cplusplus
 extern "C" {
@@ -90,15 +149,24 @@ void tsm_set_timeout_handler(tsm_timeout_function pFunction);
 BACNET_STACK_EXPORT
 bool tsm_transaction_available(void);
 BACNET_STACK_EXPORT
-uint8_t tsm_transaction_idle_count(void);
+unsigned tsm_transaction_idle_count(void);
+BACNET_STACK_EXPORT
+bool tsm_transaction_size_set(unsigned size);
+BACNET_STACK_EXPORT
+unsigned tsm_transaction_size(void);
 BACNET_STACK_EXPORT
 void tsm_timer_milliseconds(uint16_t milliseconds);
-/* free the invoke ID when the reply comes back */
 BACNET_STACK_EXPORT
-void tsm_free_invoke_id(uint8_t invokeID);
-/* use these in tandem */
+bool tsm_timer_active(void);
+/* free the invoke ID when the reply comes back from the peer */
+BACNET_STACK_EXPORT
+void tsm_free_invoke_id(const BACNET_ADDRESS *dest, uint8_t invokeID);
+/* use these in tandem - invoke IDs are unique for each peer */
 BACNET_STACK_EXPORT
-uint8_t tsm_next_free_invokeID(void);
+uint8_t tsm_next_free_invokeID(const BACNET_ADDRESS *dest);
+BACNET_STACK_EXPORT
+uint8_t *
+tsm_transaction_pdu_buffer(const BACNET_ADDRESS *dest, uint8_t invokeID);
 BACNET_STACK_EXPORT
 void tsm_invokeID_set(uint8_t invokeID);
 /* returns the same invoke ID that was given */
@@ -112,16 +180,56 @@ void tsm_set_confirmed_unsegmented_transaction(
 /* returns true if transaction is found */
 BACNET_STACK_EXPORT
 bool tsm_get_transaction_pdu(
+    const BACNET_ADDRESS *dest,
     uint8_t invokeID,
-    BACNET_ADDRESS *dest,
     BACNET_NPDU_DATA *ndpu_data,
     uint8_t *apdu,
     uint16_t *apdu_len);
 
 BACNET_STACK_EXPORT
-bool tsm_invoke_id_free(uint8_t invokeID);
+bool tsm_invoke_id_free(const BACNET_ADDRESS *dest, uint8_t invokeID);
+BACNET_STACK_EXPORT
+bool tsm_invoke_id_failed(const BACNET_ADDRESS *dest, uint8_t invokeID);
+
+#if BACNET_SEGMENTATION_ENABLED
+/* buffer for service handlers to encode a Complex-ACK
+   that may be too big for one APDU */
+BACNET_STACK_EXPORT extern uint8_t
+    Handler_Segmented_Buffer[BACNET_SEGMENTATION_APDU_MAX];
+
+BACNET_STACK_EXPORT
+uint16_t tsm_segmented_response_apdu_max(
+    const BACNET_CONFIRMED_SERVICE_DATA *service_data);
+BACNET_STACK_EXPORT
+int tsm_confirmed_reply_send(
+    BACNET_ADDRESS *dest,
+    const BACNET_NPDU_DATA *npdu_data,
+    const BACNET_CONFIRMED_SERVICE_DATA *service_data,
+    const uint8_t *apdu,
+    uint16_t apdu_len);
+BACNET_STACK_EXPORT
+void tsm_segment_ack_handler(
+    const BACNET_ADDRESS *src,
+    uint8_t invoke_id,
+    uint8_t sequence_number,
+    uint8_t actual_window_size,
+    bool nak,
+    bool server);
+BACNET_STACK_EXPORT
+void tsm_segmented_response_abort(const BACNET_ADDRESS *src, uint8_t invoke_id);
+BACNET_STACK_EXPORT
+uint8_t tsm_segmented_response_count(void);
 BACNET_STACK_EXPORT
-bool tsm_invoke_id_failed(uint8_t invokeID);
+void tsm_confirmed_request_segmentation_set(uint8_t *apdu, uint16_t apdu_len);
+BACNET_STACK_EXPORT
+uint16_t tsm_segmented_complex_ack_handler(
+    const BACNET_ADDRESS *src,
+    const uint8_t *apdu,
+    uint16_t apdu_len,
+    uint8_t **complex_ack);
+BACNET_STACK_EXPORT
+uint8_t tsm_segmented_confirmation_count(void);
+#endif
 
 #ifdef __cplusplus
 }
@@ -152,6 +152,43 @@
 #if !defined(MAX_TSM_TRANSACTIONS)
 #define MAX_TSM_TRANSACTIONS 255
 #endif
+/* Segmentation of Complex-ACK responses that do not fit into one APDU. */
+/* Each segmented transaction keeps a copy of the whole response */
+/* until the requester has acknowledged all segments, and each */
+/* reassembly buffer holds a whole response that we requested, */
+/* so configure the budget to your memory constraints. Requires the TSM. */
+#if !defined(BACNET_SEGMENTATION_ENABLED)
+#define BACNET_SEGMENTATION_ENABLED 0
+#endif
+#if BACNET_SEGMENTATION_ENABLED
+#if !MAX_TSM_TRANSACTIONS
+#error "BACNET_SEGMENTATION_ENABLED requires MAX_TSM_TRANSACTIONS"
+#endif
+/* maximum number of segments in one segmented message, 2..255 */
+#if !defined(BACNET_SEGMENTATION_MAX_SEGMENTS)
+#define BACNET_SEGMENTATION_MAX_SEGMENTS 32
+#endif
+/* number of segments we send or accept before a Segment-ACK, 1..127 */
+#if !defined(BACNET_SEGMENTATION_WINDOW_SIZE)
+#define BACNET_SEGMENTATION_WINDOW_SIZE 16
+#endif
+/* number of segmented responses that can be in progress at once */
+#if !defined(BACNET_SEGMENTATION_TRANSACTIONS)
+#define BACNET_SEGMENTATION_TRANSACTIONS 4
+#endif
+/* number of segmented Complex-ACK that we can reassemble at once */
+#if !defined(BACNET_SEGMENTATION_REASSEMBLY_BUFFERS)
+#define BACNET_SEGMENTATION_REASSEMBLY_BUFFERS 2
+#endif
+/* largest APDU that can be sent or received in segments */
+#if !defined(BACNET_SEGMENTATION_APDU_MAX)
+#define BACNET_SEGMENTATION_APDU_MAX \
+    (MAX_APDU * BACNET_SEGMENTATION_MAX_SEGMENTS)
+#endif
+#if (BACNET_SEGMENTATION_APDU_MAX > 65535)
+#error "BACNET_SEGMENTATION_APDU_MAX must fit in 16 bits"
+#endif
+#endif
 /* The address cache is used for binding to BACnet devices */
 /* The number of entries corresponds to the number of */
 /* devices that might respond to an I-Am on the network. */
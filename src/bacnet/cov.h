@@ -57,6 +57,11 @@ size_t cov_notify_service_request_encode(
     uint8_t *apdu, size_t apdu_size, const BACNET_COV_DATA *data);
 
 BACNET_STACK_EXPORT
+int cov_notify_header_encode(uint8_t *apdu, const BACNET_COV_DATA *data);
+BACNET_STACK_EXPORT
+int cov_notify_values_encode(
+    uint8_t *apdu, const BACNET_PROPERTY_VALUE *value_list);
+BACNET_STACK_EXPORT
 int cov_notify_encode_apdu(uint8_t *apdu, const BACNET_COV_DATA *data);
 
 BACNET_STACK_EXPORT
@@ -78,6 +83,22 @@ int ccov_notify_encode_apdu(
     uint8_t invoke_id,
     const BACNET_COV_DATA *data);
 
+BACNET_STACK_EXPORT
+int ucov_notify_encode_apdu_values(
+    uint8_t *apdu,
+    unsigned apdu_size,
+    const BACNET_COV_DATA *data,
+    const uint8_t *values,
+    unsigned values_len);
+BACNET_STACK_EXPORT
+int ccov_notify_encode_apdu_values(
+    uint8_t *apdu,
+    unsigned apdu_size,
+    uint8_t invoke_id,
+    const BACNET_COV_DATA *data,
+    const uint8_t *values,
+    unsigned values_len);
+
 BACNET_STACK_EXPORT
 int ccov_notify_decode_apdu(
     const uint8_t *apdu,
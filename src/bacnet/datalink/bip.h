@@ -22,6 +22,26 @@
 #define BIP_HEADER_MAX (1 + 1 + 2)
 #define BIP_MPDU_MAX (BIP_HEADER_MAX + MAX_PDU)
 
+/* number of datagrams that bip_receive() drains from the sockets
+   in one system call */
+#ifndef BIP_RECEIVE_BATCH
+#define BIP_RECEIVE_BATCH 16
+#endif
+
+/* a datagram received by bip_receive_packets(). The BVLC header is
+   handled, and the NPDU is left in place in the datagram buffer. */
+typedef struct bip_packet {
+    /* [in] buffer for the datagram, and its size */
+    uint8_t *mpdu;
+    uint16_t mpdu_size;
+    /* [out] source of the NPDU, and the NPDU at mpdu[npdu_offset] */
+    BACNET_ADDRESS src;
+    uint16_t npdu_offset;
+    uint16_t npdu_len;
+    /* [out] BVLC function that carried the NPDU */
+    uint8_t bvlc_function;
+} BIP_PACKET;
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -60,10 +80,24 @@ BACNET_STACK_EXPORT
 int bip_send_mpdu(
     const BACNET_IP_ADDRESS *dest, const uint8_t *mtu, uint16_t mtu_len);
 
+/* implement in ports module - send the same MPDU to a list of
+   destinations, such as a Forwarded-NPDU to the BDT or FDT */
+BACNET_STACK_EXPORT
+int bip_send_mpdu_multiple(
+    const BACNET_IP_ADDRESS *dest,
+    unsigned dest_count,
+    const uint8_t *mtu,
+    uint16_t mtu_len);
+
 BACNET_STACK_EXPORT
 uint16_t bip_receive(
     BACNET_ADDRESS *src, uint8_t *pdu, uint16_t max_pdu, unsigned timeout);
 
+/* implemented in the Linux port */
+BACNET_STACK_EXPORT
+unsigned bip_receive_packets(
+    BIP_PACKET *packets, unsigned count, unsigned timeout);
+
 /* use host byte order for setting UDP port */
 BACNET_STACK_EXPORT
 void bip_set_port(uint16_t port);
@@ -72,6 +72,8 @@ BACNET_STACK_EXPORT
 void bip6_set_port(uint16_t port);
 BACNET_STACK_EXPORT
 uint16_t bip6_get_port(void);
+BACNET_STACK_EXPORT
+int bip6_get_socket(void);
 
 BACNET_STACK_EXPORT
 bool bip6_set_broadcast_addr(const BACNET_IP6_ADDRESS *addr);
@@ -385,6 +385,7 @@ void dlenv_network_port_init(void)
 #if BBMD_ENABLED
     Network_Port_BBMD_BD_Table_Set(instance, bvlc_bdt_list());
     Network_Port_BBMD_FD_Table_Set(instance, bvlc_fdt_list());
+    Network_Port_BBMD_FD_Table_Update_Set(instance, bvlc_fdt_remaining_update);
     /* foreign device registration */
     bbmd_address.host_ip_address = true;
     bbmd_address.host_name = false;
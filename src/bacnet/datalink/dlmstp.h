@@ -133,6 +133,8 @@ uint16_t dlmstp_receive(
     uint8_t *pdu, /* PDU data */
     uint16_t max_pdu, /* amount of space available in the PDU  */
     unsigned timeout); /* milliseconds to wait for a packet */
+BACNET_STACK_EXPORT
+int dlmstp_get_receive_fd(void);
 
 /* This parameter represents the value of the Max_Info_Frames property of */
 /* the node's Device object. The value of Max_Info_Frames specifies the */
@@ -556,10 +556,11 @@ void MSTP_Receive_Frame_FSM(struct mstp_port_struct_t *mstp_port)
                     if (((mstp_port->Index + 1) < mstp_port->InputBufferSize) &&
                         (mstp_port->FrameType >= Nmin_COBS_type) &&
                         (mstp_port->FrameType <= Nmax_COBS_type)) {
+                        /* decode in place, so that the client data
+                           is at the start of the InputBuffer */
                         mstp_port->DataLength = cobs_frame_decode(
-                            &mstp_port->InputBuffer[mstp_port->Index + 1],
-                            mstp_port->InputBufferSize, mstp_port->InputBuffer,
-                            mstp_port->Index + 1);
+                            mstp_port->InputBuffer, mstp_port->InputBufferSize,
+                            mstp_port->InputBuffer, mstp_port->Index + 1);
                         if (mstp_port->DataLength > 0) {
                             mstp_port->ReceivedValidFrame = true;
                         } else {
@@ -600,6 +601,99 @@ void MSTP_Receive_Frame_FSM(struct mstp_port_struct_t *mstp_port)
     return;
 }
 
+/**
+ * @brief Receive a span of octets, such as the result of one read() of
+ *  the UART, with the Receive Frame state machine. Octets between frames
+ *  and the data octets of a frame are handled in bulk, and the others are
+ *  given to MSTP_Receive_Frame_FSM() one at a time, so the states, the
+ *  EventCount and the SilenceTimer behave as if each octet was received
+ *  alone. The octets of a span are taken to have arrived together, so
+ *  the Tframe_abort timeout is only checked for the first octet.
+ * @param mstp_port MSTP port context data
+ * @param buffer octets received
+ * @param length number of octets received
+ * @return number of octets used. Receiving stops after the octet that
+ *  completes a frame, so that ReceivedValidFrame or ReceivedInvalidFrame
+ *  can be handled before the rest of the span is given again.
+ */
+unsigned MSTP_Receive_Frame_Span(
+    struct mstp_port_struct_t *mstp_port,
+    const uint8_t *buffer,
+    unsigned length)
+{
+    const uint8_t *preamble;
+    unsigned offset = 0;
+    unsigned count = 0;
+    unsigned i = 0;
+
+    if (!mstp_port || !buffer) {
+        return 0;
+    }
+    while (offset < length) {
+        if ((offset > 0) && !mstp_port->ReceiveError &&
+            (mstp_port->receive_state == MSTP_RECEIVE_STATE_IDLE)) {
+            /* EatAnOctet until the next Preamble1 */
+            preamble = memchr(&buffer[offset], 0x55, length - offset);
+            if (preamble) {
+                count = (unsigned)(preamble - &buffer[offset]);
+            } else {
+                count = length - offset;
+            }
+            if (count > 0) {
+                if (count < (unsigned)(0xFF - mstp_port->EventCount)) {
+                    mstp_port->EventCount += count;
+                } else {
+                    mstp_port->EventCount = 0xFF;
+                }
+                mstp_port->SilenceTimerReset((void *)mstp_port);
+                offset += count;
+                continue;
+            }
+        } else if (
+            (offset > 0) && !mstp_port->ReceiveError &&
+            ((mstp_port->receive_state == MSTP_RECEIVE_STATE_DATA) ||
+             (mstp_port->receive_state == MSTP_RECEIVE_STATE_SKIP_DATA)) &&
+            (mstp_port->Index < mstp_port->DataLength)) {
+            /* DataOctet, up to the CRC octets */
+            count = mstp_port->DataLength - mstp_port->Index;
+            if (count > (length - offset)) {
+                count = length - offset;
+            }
+            for (i = 0; i < count; i++) {
+                mstp_port->DataCRC =
+                    CRC_Calc_Data(buffer[offset + i], mstp_port->DataCRC);
+            }
+            if (mstp_port->Index < mstp_port->InputBufferSize) {
+                i = mstp_port->InputBufferSize - mstp_port->Index;
+                if (i > count) {
+                    i = count;
+                }
+                memcpy(
+                    &mstp_port->InputBuffer[mstp_port->Index], &buffer[offset],
+                    i);
+            }
+            mstp_port->Index += count;
+            mstp_port->SilenceTimerReset((void *)mstp_port);
+            offset += count;
+            continue;
+        }
+        mstp_port->DataRegister = buffer[offset];
+        mstp_port->DataAvailable = true;
+        MSTP_Receive_Frame_FSM(mstp_port);
+        if (mstp_port->DataAvailable) {
+            /* a timeout or error was handled - the octet is given again */
+            mstp_port->DataAvailable = false;
+        } else {
+            offset++;
+        }
+        if (mstp_port->ReceivedValidFrame || mstp_port->ReceivedInvalidFrame) {
+            break;
+        }
+    }
+
+    return offset;
+}
+
 /**
  * @brief Finite State Machine for receiving an MSTP frame
  * @param mstp_port MSTP port context data
@@ -34,6 +34,13 @@ typedef struct BACnet_Get_Event_Information_Data {
 typedef int (*get_event_info_function)(
     unsigned index, BACNET_GET_EVENT_INFORMATION_DATA *getevent_data);
 
+/* find the first object, at or after object_instance, that is in the
+   index of objects with an active event, or with unacknowledged
+   transitions.
+   return true and the object instance and index if found */
+typedef bool (*get_event_active_function)(
+    uint32_t *object_instance, unsigned *index);
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -403,6 +403,21 @@ int rr_decode_service_request(
  * }
  */
 
+/**
+ * @brief Determine the largest ReadRange-ACK APDU for a request,
+ *  which is larger than MAX_APDU when the reply can be segmented.
+ * @param rrdata - ReadRange data with ApduMax set by the server
+ * @return the largest ReadRange-ACK APDU in octets
+ */
+int rr_ack_apdu_max(const BACNET_READ_RANGE_DATA *rrdata)
+{
+    if (rrdata && (rrdata->ApduMax > 0)) {
+        return rrdata->ApduMax;
+    }
+
+    return MAX_APDU;
+}
+
 /**
  * Build a ReadRange response packet
  *
@@ -419,8 +434,10 @@ int rr_ack_encode_apdu(
     int imax = 0;
     int len = 0; /* length of each encoding */
     int apdu_len = 0; /* total length of the apdu, return value */
+    int apdu_max = 0;
 
     if (apdu) {
+        apdu_max = rr_ack_apdu_max(rrdata);
         apdu[0] = PDU_TYPE_COMPLEX_ACK; /* complex ACK service */
         apdu[1] = invoke_id; /* original invoke id from request */
         apdu[2] = SERVICE_CONFIRMED_READ_RANGE; /* service choice */
@@ -448,8 +465,8 @@ int rr_ack_encode_apdu(
         apdu_len += encode_opening_tag(&apdu[apdu_len], 5);
         if (rrdata->ItemCount != 0) {
             imax = rrdata->application_data_len;
-            if (imax > (MAX_APDU - apdu_len - 2 /*closing*/)) {
-                imax = (MAX_APDU - apdu_len - 2);
+            if (imax > (apdu_max - apdu_len - 2 /*closing*/)) {
+                imax = (apdu_max - apdu_len - 2);
             }
             for (len = 0; len < imax; len++) {
                 apdu[apdu_len++] = rrdata->application_data[len];
@@ -461,7 +478,7 @@ int rr_ack_encode_apdu(
             (rrdata->RequestType != RR_BY_POSITION) &&
             (rrdata->RequestType != RR_READ_ALL)) {
             /* Context 6 Sequence number of first item */
-            if (apdu_len < (MAX_APDU - 4)) {
+            if (apdu_len < (apdu_max - 4)) {
                 apdu_len += encode_context_unsigned(
                     &apdu[apdu_len], 6, rrdata->FirstSequence);
             }
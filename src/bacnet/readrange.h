@@ -29,6 +29,7 @@ typedef struct BACnet_Read_Range_Data {
     BACNET_BIT_STRING ResultFlags; /**<  FIRST_ITEM, LAST_ITEM, MORE_ITEMS. */
     int RequestType; /**< Index, sequence or time based request. */
     int Overhead; /**< How much space the baggage takes in the response. */
+    int ApduMax; /**< Largest ReadRange-ACK accepted, 0 for MAX_APDU. */
     uint32_t ItemCount;
     uint32_t FirstSequence;
     union { /**< Pick the appropriate data type. */
@@ -132,6 +133,9 @@ BACNET_STACK_EXPORT
 int rr_decode_service_request(
     const uint8_t *apdu, unsigned apdu_len, BACNET_READ_RANGE_DATA *rrdata);
 
+BACNET_STACK_EXPORT
+int rr_ack_apdu_max(const BACNET_READ_RANGE_DATA *rrdata);
+
 BACNET_STACK_EXPORT
 int rr_ack_encode_apdu(
     uint8_t *apdu, uint8_t invoke_id, const BACNET_READ_RANGE_DATA *rrdata);
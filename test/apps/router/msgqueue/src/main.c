@@ -0,0 +1,287 @@
+/**
+ * @file
+ * @brief Unit test for the router message boxes and packet pool
+ * @author agent <agent@local>
+ * @date October 2026
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <zephyr/ztest.h>
+#include "msgqueue.h"
+
+/**
+ * @addtogroup bacnet_tests
+ * @{
+ */
+
+/* threads that send to, and receive from, one message box */
+#define TEST_PRODUCERS 4
+#define TEST_CONSUMERS 3
+#define TEST_MESSAGES 20000
+/* threads that take packets from, and return them to, the pool */
+#define TEST_POOL_THREADS 4
+#define TEST_POOL_ROUNDS 20000
+
+static MSGBOX_ID Test_Msgbox_ID;
+static unsigned Test_Received[TEST_PRODUCERS][TEST_MESSAGES];
+static unsigned Test_Errors;
+
+static void *test_producer(void *arg)
+{
+    BACMSG msg = { 0 };
+    uintptr_t producer = (uintptr_t)arg;
+    uintptr_t i;
+
+    msg.type = DATA;
+    msg.origin = (MSGBOX_ID)producer;
+    for (i = 0; i < TEST_MESSAGES; i++) {
+        msg.data = (void *)i;
+        while (!send_to_msgbox(Test_Msgbox_ID, &msg)) {
+            /* full until a consumer catches up */
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+static void *test_consumer(void *arg)
+{
+    BACMSG msg;
+    uintptr_t i;
+
+    (void)arg;
+    for (;;) {
+        if (!recv_from_msgbox(Test_Msgbox_ID, &msg, 0)) {
+            __atomic_add_fetch(&Test_Errors, 1, __ATOMIC_RELAXED);
+            break;
+        }
+        if (msg.type == SERVICE) {
+            break;
+        }
+        i = (uintptr_t)msg.data;
+        if ((msg.origin < 0) || (msg.origin >= TEST_PRODUCERS) ||
+            (i >= TEST_MESSAGES)) {
+            __atomic_add_fetch(&Test_Errors, 1, __ATOMIC_RELAXED);
+            continue;
+        }
+        __atomic_add_fetch(
+            &Test_Received[msg.origin][i], 1, __ATOMIC_RELAXED);
+    }
+
+    return NULL;
+}
+
+static void *test_pool_user(void *arg)
+{
+    MSG_DATA *data;
+    uint8_t marker = (uint8_t)(uintptr_t)arg;
+    unsigned i, j;
+
+    for (i = 0; i < TEST_POOL_ROUNDS; i++) {
+        data = alloc_data();
+        if (!data) {
+            /* every packet is taken by the other threads */
+            sched_yield();
+            continue;
+        }
+        /* a packet is owned by one thread at a time */
+        memset(data->pdu, marker, 16);
+        sched_yield();
+        for (j = 0; j < 16; j++) {
+            if (data->pdu[j] != marker) {
+                __atomic_add_fetch(&Test_Errors, 1, __ATOMIC_RELAXED);
+                break;
+            }
+        }
+        free_data(data);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Take every packet of the pool
+ * @param data - packets taken, ROUTER_PACKET_POOL_SIZE of them
+ * @return number of packets taken
+ */
+static unsigned test_pool_take_all(MSG_DATA **data)
+{
+    unsigned count = 0;
+
+    while (count <= ROUTER_PACKET_POOL_SIZE) {
+        data[count] = alloc_data();
+        if (!data[count]) {
+            break;
+        }
+        count++;
+    }
+
+    return count;
+}
+
+/**
+ * @brief Test that a message box is a bounded first-in first-out queue
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(msgqueue_tests, testMsgbox)
+#else
+static void testMsgbox(void)
+#endif
+{
+    BACMSG msg = { 0 };
+    BACMSG received = { 0 };
+    MSGBOX_ID id;
+    uintptr_t i;
+    unsigned lap;
+
+    id = create_msgbox();
+    zassert_not_equal(id, INVALID_MSGBOX_ID, NULL);
+    zassert_is_null(recv_from_msgbox(id, &received, MSGBOX_NOWAIT), NULL);
+    msg.type = DATA;
+    msg.origin = id;
+    /* several laps of the ring */
+    for (lap = 0; lap < 3; lap++) {
+        for (i = 0; i < ROUTER_MSGBOX_SIZE; i++) {
+            msg.data = (void *)i;
+            zassert_true(send_to_msgbox(id, &msg), NULL);
+        }
+        zassert_false(send_to_msgbox(id, &msg), NULL);
+        for (i = 0; i < ROUTER_MSGBOX_SIZE; i++) {
+            zassert_not_null(
+                recv_from_msgbox(id, &received, MSGBOX_NOWAIT), NULL);
+            zassert_equal((uintptr_t)received.data, i, NULL);
+            zassert_equal(received.origin, id, NULL);
+        }
+        zassert_is_null(recv_from_msgbox(id, &received, MSGBOX_NOWAIT), NULL);
+    }
+    del_msgbox(id);
+    zassert_false(send_to_msgbox(id, &msg), NULL);
+    zassert_is_null(recv_from_msgbox(id, &received, MSGBOX_NOWAIT), NULL);
+    zassert_false(send_to_msgbox(INVALID_MSGBOX_ID, &msg), NULL);
+}
+
+/**
+ * @brief Test that every message from several producers is received
+ *  exactly once by several consumers
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(msgqueue_tests, testMsgboxThreads)
+#else
+static void testMsgboxThreads(void)
+#endif
+{
+    pthread_t producer[TEST_PRODUCERS];
+    pthread_t consumer[TEST_CONSUMERS];
+    BACMSG msg = { 0 };
+    uintptr_t i, j;
+
+    memset(Test_Received, 0, sizeof(Test_Received));
+    Test_Errors = 0;
+    Test_Msgbox_ID = create_msgbox();
+    zassert_not_equal(Test_Msgbox_ID, INVALID_MSGBOX_ID, NULL);
+    for (i = 0; i < TEST_CONSUMERS; i++) {
+        zassert_equal(
+            pthread_create(&consumer[i], NULL, test_consumer, NULL), 0, NULL);
+    }
+    for (i = 0; i < TEST_PRODUCERS; i++) {
+        zassert_equal(
+            pthread_create(&producer[i], NULL, test_producer, (void *)i), 0,
+            NULL);
+    }
+    for (i = 0; i < TEST_PRODUCERS; i++) {
+        pthread_join(producer[i], NULL);
+    }
+    /* then stop each consumer, after the messages before it */
+    msg.type = SERVICE;
+    msg.subtype = SHUTDOWN;
+    for (i = 0; i < TEST_CONSUMERS; i++) {
+        while (!send_to_msgbox(Test_Msgbox_ID, &msg)) {
+            sched_yield();
+        }
+    }
+    for (i = 0; i < TEST_CONSUMERS; i++) {
+        pthread_join(consumer[i], NULL);
+    }
+    zassert_equal(Test_Errors, 0, NULL);
+    for (i = 0; i < TEST_PRODUCERS; i++) {
+        for (j = 0; j < TEST_MESSAGES; j++) {
+            zassert_equal(Test_Received[i][j], 1, NULL);
+        }
+    }
+    del_msgbox(Test_Msgbox_ID);
+}
+
+/**
+ * @brief Test taking packets from the pool and returning them
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(msgqueue_tests, testPacketPool)
+#else
+static void testPacketPool(void)
+#endif
+{
+    MSG_DATA *data[ROUTER_PACKET_POOL_SIZE + 1] = { 0 };
+    pthread_t thread[TEST_POOL_THREADS];
+    MSG_DATA *packet;
+    unsigned count, i, j;
+
+    count = test_pool_take_all(data);
+    zassert_equal(count, ROUTER_PACKET_POOL_SIZE, NULL);
+    for (i = 0; i < count; i++) {
+        zassert_equal(data[i]->pdu_len, 0, NULL);
+        zassert_equal(data[i]->ref_count, 1, NULL);
+        zassert_equal(
+            data[i]->pdu, &data[i]->buffer[ROUTER_PACKET_HEADROOM], NULL);
+        for (j = 0; j < i; j++) {
+            zassert_not_equal(data[i], data[j], NULL);
+        }
+    }
+    /* a packet shared by two ports is freed by the last one */
+    packet = data[0];
+    packet->ref_count = 2;
+    check_data(packet);
+    zassert_is_null(alloc_data(), NULL);
+    check_data(packet);
+    zassert_equal(alloc_data(), packet, NULL);
+    for (i = 0; i < count; i++) {
+        free_data(data[i]);
+    }
+    free_data(NULL);
+    /* the pool is shared by the router port threads */
+    Test_Errors = 0;
+    for (i = 0; i < TEST_POOL_THREADS; i++) {
+        zassert_equal(
+            pthread_create(
+                &thread[i], NULL, test_pool_user, (void *)(uintptr_t)(i + 1)),
+            0, NULL);
+    }
+    for (i = 0; i < TEST_POOL_THREADS; i++) {
+        pthread_join(thread[i], NULL);
+    }
+    zassert_equal(Test_Errors, 0, NULL);
+    count = test_pool_take_all(data);
+    zassert_equal(count, ROUTER_PACKET_POOL_SIZE, NULL);
+    for (i = 0; i < count; i++) {
+        free_data(data[i]);
+    }
+}
+/**
+ * @}
+ */
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST_SUITE(msgqueue_tests, NULL, NULL, NULL, NULL, NULL);
+#else
+void test_main(void)
+{
+    ztest_test_suite(
+        msgqueue_tests, ztest_unit_test(testMsgbox),
+        ztest_unit_test(testMsgboxThreads), ztest_unit_test(testPacketPool));
+
+    ztest_run_test_suite(msgqueue_tests);
+}
+#endif
@@ -36,6 +36,7 @@ static uint8_t Test_Sent_Message_Length;
 static uint8_t Test_Sent_Message_Buffer[MAX_APDU];
 static uint16_t Test_Sent_Message_Buffer_Length;
 static BACNET_IP_ADDRESS Test_Sent_Message_Dest;
+static unsigned Test_Sent_Message_Count;
 
 /* network stub functions */
 /**
@@ -82,6 +83,7 @@ int bip_send_mpdu(
     Test_Sent_Message_Type = message_type;
     Test_Sent_Message_Length = message_length;
     bvlc_address_copy(&Test_Sent_Message_Dest, dest);
+    Test_Sent_Message_Count++;
     if ((header_len == 4) && (mtu_len >= 4)) {
         memcpy(&Test_Sent_Message_Buffer[0], &mtu[4], mtu_len - 4);
         Test_Sent_Message_Buffer_Length = mtu_len - 4;
@@ -92,6 +94,31 @@ int bip_send_mpdu(
     return 0;
 }
 
+/**
+ * The send function for BACnet/IP driver layer, to many destinations
+ *
+ * @param dest - array of destination addresses
+ * @param dest_count - number of destination addresses
+ * @param mtu - the bytes of data to send
+ * @param mtu_len - the number of bytes of data to send
+ *
+ * @return number of destinations sent to
+ */
+int bip_send_mpdu_multiple(
+    const BACNET_IP_ADDRESS *dest,
+    unsigned dest_count,
+    const uint8_t *mtu,
+    uint16_t mtu_len)
+{
+    unsigned i;
+
+    for (i = 0; i < dest_count; i++) {
+        bip_send_mpdu(&dest[i], mtu, mtu_len);
+    }
+
+    return (int)dest_count;
+}
+
 /** Return the Object Instance number for our (single) Device Object.
  * This is a key function, widely invoked by the handler code, since
  * it provides "our" (ie, local) address.
@@ -227,10 +254,115 @@ static void test_BBMD_Result(void)
     }
 }
 
+/**
+ * @brief Get the result code of the BVLC-Result sent by the handler
+ * @return result code, or BVLC_RESULT_INVALID if none was sent
+ */
+static uint16_t test_sent_result(void)
+{
+    uint16_t result_code = BVLC_RESULT_INVALID;
+
+    if (Test_Sent_Message_Type == BVLC_RESULT) {
+        bvlc_decode_result(
+            Test_Sent_Message_Buffer, Test_Sent_Message_Buffer_Length,
+            &result_code);
+    }
+
+    return result_code;
+}
+
+/**
+ * @brief Register foreign devices, forward to them, and expire them
+ */
+static void test_BBMD_Foreign_Device_Table(void)
+{
+    BACNET_IP_FOREIGN_DEVICE_TABLE_ENTRY *fdt_head;
+    BACNET_IP_FOREIGN_DEVICE_TABLE_ENTRY *fdt_entry;
+    BACNET_IP_ADDRESS addr[3] = { 0 };
+    BACNET_ADDRESS src = { 0 };
+    uint8_t npdu[2] = { 0x01, 0x00 };
+    uint8_t mtu[MAX_APDU] = { 0 };
+    uint16_t mtu_len = 0;
+    unsigned i = 0, count = 0, size = 0;
+    int result = 0;
+
+    test_setup();
+    assert(bvlc_fdt_count() == 0);
+    size = bvlc_fdt_size();
+    assert(size > 0);
+    for (i = 0; i < 3; i++) {
+        bvlc_address_set(&addr[i], 10, 0, (uint8_t)i, 1);
+        addr[i].port = 0xBAC0;
+        mtu_len =
+            bvlc_encode_register_foreign_device(mtu, sizeof(mtu), 60 + i);
+        result = bvlc_bbmd_enabled_handler(&addr[i], &src, mtu, mtu_len);
+        assert(result == 0);
+        assert(test_sent_result() == BVLC_RESULT_SUCCESSFUL_COMPLETION);
+    }
+    assert(bvlc_fdt_count() == 3);
+    /* registering again restarts the timer, and adds no entry */
+    mtu_len = bvlc_encode_register_foreign_device(mtu, sizeof(mtu), 61);
+    bvlc_bbmd_enabled_handler(&addr[2], &src, mtu, mtu_len);
+    assert(bvlc_fdt_count() == 3);
+    /* forwarded to the other foreign devices, and the local broadcast */
+    mtu_len = bvlc_encode_distribute_broadcast_to_network(
+        mtu, sizeof(mtu), npdu, sizeof(npdu));
+    Test_Sent_Message_Count = 0;
+    bvlc_bbmd_enabled_handler(&addr[0], &src, mtu, mtu_len);
+    assert(Test_Sent_Message_Count == 3);
+    /* the time remaining is computed when the table is read, also in the
+       table that the Network Port object keeps from before the timer */
+    fdt_head = bvlc_fdt_list();
+    bvlc_maintenance_timer(10);
+    bvlc_fdt_remaining_update();
+    count = 0;
+    for (fdt_entry = fdt_head; fdt_entry; fdt_entry = fdt_entry->next) {
+        if (fdt_entry->valid) {
+            assert(fdt_entry->ttl_seconds_remaining ==
+                   (fdt_entry->ttl_seconds + 30 - 10));
+            count++;
+        }
+    }
+    assert(count == 3);
+    mtu_len = bvlc_encode_delete_foreign_device(mtu, sizeof(mtu), &addr[1]);
+    bvlc_bbmd_enabled_handler(&addr[1], &src, mtu, mtu_len);
+    assert(test_sent_result() == BVLC_RESULT_SUCCESSFUL_COMPLETION);
+    assert(bvlc_fdt_count() == 2);
+    bvlc_bbmd_enabled_handler(&addr[1], &src, mtu, mtu_len);
+    assert(
+        test_sent_result() ==
+        BVLC_RESULT_DELETE_FOREIGN_DEVICE_TABLE_ENTRY_NAK);
+    /* the registrations expire at TTL plus the grace period */
+    bvlc_maintenance_timer(79);
+    assert(bvlc_fdt_count() == 2);
+    bvlc_maintenance_timer(1);
+    assert(bvlc_fdt_count() == 1);
+    bvlc_maintenance_timer(1);
+    assert(bvlc_fdt_count() == 0);
+    /* resized storage */
+    assert(!bvlc_fdt_size_set(0));
+    assert(bvlc_fdt_size_set(1000));
+    assert(bvlc_fdt_size() == 1000);
+    for (i = 0; i < 1000; i++) {
+        bvlc_address_set(&addr[0], 10, 1, (uint8_t)(i >> 8), (uint8_t)i);
+        mtu_len = bvlc_encode_register_foreign_device(mtu, sizeof(mtu), 60);
+        bvlc_bbmd_enabled_handler(&addr[0], &src, mtu, mtu_len);
+    }
+    assert(bvlc_fdt_count() == 1000);
+    bvlc_address_set(&addr[0], 10, 2, 0, 1);
+    bvlc_bbmd_enabled_handler(&addr[0], &src, mtu, mtu_len);
+    assert(test_sent_result() == BVLC_RESULT_REGISTER_FOREIGN_DEVICE_NAK);
+    bvlc_maintenance_timer(UINT16_MAX);
+    assert(bvlc_fdt_count() == 0);
+    assert(bvlc_fdt_size_set(size));
+    test_cleanup();
+}
+
 int main(void)
 {
     /* individual tests */
     test_BBMD_Result();
+    test_BBMD_Foreign_Device_Table();
     test_Initiate_Original_Broadcast_NPDU();
 
     return 0;
@@ -8,6 +8,7 @@
  * @brief test BACnet integer encode/decode APIs
  */
 
+#include <stdio.h>
 #include <zephyr/ztest.h>
 #include <bacnet/bacaddr.h>
 #include <bacnet/basic/binding/address.h>
@@ -200,6 +201,86 @@ static void testAddress(void)
         zassert_equal(count, (MAX_ADDRESS_CACHE - i - 1), NULL);
     }
 }
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(address_tests, testAddressCacheSize)
+#else
+static void testAddressCacheSize(void)
+#endif
+{
+    const unsigned size = 8;
+    unsigned i;
+    BACNET_ADDRESS src;
+    BACNET_ADDRESS test_address;
+    uint32_t test_device_id = 0;
+    uint32_t device_ttl = 0;
+    unsigned test_max_apdu = 0;
+
+#ifdef BACNET_ADDRESS_CACHE_FILE
+    /* start without any static entries */
+    remove(Address_Cache_Filename);
+#endif
+    zassert_false(address_cache_size_set(0), NULL);
+    zassert_true(address_cache_size_set(size), NULL);
+    zassert_equal(address_cache_size(), size, NULL);
+    address_init();
+    for (i = 0; i < size; i++) {
+        set_address(i, &src);
+        address_add(1000 + i, 480, &src);
+    }
+    zassert_equal(address_count(), size, NULL);
+    /* use the first device, so the second is least recently used */
+    zassert_true(
+        address_get_by_device(1000, &test_max_apdu, &test_address), NULL);
+    set_address(size, &src);
+    address_add(1000 + size, 480, &src);
+    zassert_equal(address_count(), size, NULL);
+    zassert_true(
+        address_get_by_device(1000, &test_max_apdu, &test_address), NULL);
+    zassert_false(
+        address_get_by_device(1001, &test_max_apdu, &test_address), NULL);
+    zassert_true(address_get_device_id(&src, &test_device_id), NULL);
+    zassert_equal(test_device_id, 1000 + size, NULL);
+    set_address(1, &src);
+    zassert_false(address_get_device_id(&src, &test_device_id), NULL);
+    /* a static entry never expires, and bound entries use their TTL */
+    address_set_device_TTL(1000, 0, true);
+    address_set_device_TTL(1002, 10, false);
+    zassert_true(
+        address_device_get_by_index(
+            2, &test_device_id, &device_ttl, NULL, NULL),
+        NULL);
+    zassert_equal(test_device_id, 1002, NULL);
+    zassert_equal(device_ttl, 10, NULL);
+    address_cache_timer(10);
+    zassert_true(
+        address_get_by_device(1002, &test_max_apdu, &test_address), NULL);
+    address_cache_timer(1);
+    zassert_false(
+        address_get_by_device(1002, &test_max_apdu, &test_address), NULL);
+    zassert_equal(address_count(), size - 1, NULL);
+    /* the opportunistic entries expire after an hour */
+    for (i = 0; i < 3; i++) {
+        address_cache_timer(900);
+    }
+    address_cache_timer(3600 - 2700 - 11);
+    zassert_equal(address_count(), size - 1, NULL);
+    address_cache_timer(1);
+    zassert_equal(address_count(), 1, NULL);
+    zassert_true(
+        address_get_by_device(1000, &test_max_apdu, &test_address), NULL);
+    /* bind requests hold an entry without an address */
+    zassert_false(address_bind_request(2000, &test_max_apdu, &src), NULL);
+    zassert_equal(address_count(), 1, NULL);
+    set_address(2000 % 256, &src);
+    address_add_binding(2000, 480, &src);
+    zassert_true(
+        address_bind_request(2000, &test_max_apdu, &test_address), NULL);
+    zassert_true(bacnet_address_same(&test_address, &src), NULL);
+    zassert_equal(address_count(), 2, NULL);
+    zassert_true(address_cache_size_set(MAX_ADDRESS_CACHE), NULL);
+    address_init();
+}
 /**
  * @}
  */
@@ -212,11 +293,13 @@ void test_main(void)
 #ifdef BACNET_ADDRESS_CACHE_FILE
     ztest_test_suite(
         address_tests, ztest_unit_test(testAddressFile),
-        ztest_unit_test(testAddress));
+        ztest_unit_test(testAddress), ztest_unit_test(testAddressCacheSize));
 
     ztest_run_test_suite(address_tests);
 #else
-    ztest_test_suite(address_tests, ztest_unit_test(testAddress));
+    ztest_test_suite(
+        address_tests, ztest_unit_test(testAddress),
+        ztest_unit_test(testAddressCacheSize));
 
     ztest_run_test_suite(address_tests);
 #endif
@@ -0,0 +1,165 @@
+/**
+ * @file
+ * @brief Unit test for the BACnet router routing table
+ * @author agent <agent@local>
+ * @date October 2026
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <zephyr/ztest.h>
+#include <bacnet/basic/npdu/route_table.h>
+
+/**
+ * @addtogroup bacnet_tests
+ * @{
+ */
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(route_table_tests, testRouteTable)
+#else
+static void testRouteTable(void)
+#endif
+{
+    BACNET_ROUTE_TABLE_ENTRY *entry;
+    const uint8_t port_mac[6] = { 192, 168, 0, 1, 0xBA, 0xC0 };
+    uint8_t router_mac[6] = { 192, 168, 0, 2, 0xBA, 0xC0 };
+    const uint8_t mstp_mac = 1;
+    unsigned index, count;
+    uint16_t net;
+
+    route_table_init();
+    zassert_equal(route_table_count(), 0, NULL);
+    zassert_is_null(route_table_find(1), NULL);
+    zassert_true(route_table_port_add(1, port_mac, sizeof(port_mac)), NULL);
+    zassert_true(route_table_port_add(2, &mstp_mac, 1), NULL);
+    zassert_false(route_table_port_add(0, NULL, 0), NULL);
+    zassert_false(
+        route_table_port_add(BACNET_BROADCAST_NETWORK, NULL, 0), NULL);
+    entry = route_table_find(1);
+    zassert_not_null(entry, NULL);
+    zassert_equal(entry->port_net, 1, NULL);
+    zassert_equal(entry->mac_len, sizeof(port_mac), NULL);
+    zassert_mem_equal(entry->mac, port_mac, sizeof(port_mac), NULL);
+    /* learned through a port; a port is never replaced */
+    zassert_true(
+        route_table_learn(100, 1, router_mac, sizeof(router_mac)), NULL);
+    zassert_false(
+        route_table_learn(2, 1, router_mac, sizeof(router_mac)), NULL);
+    zassert_false(
+        route_table_learn(101, 3, router_mac, sizeof(router_mac)), NULL);
+    zassert_false(
+        route_table_learn(101, 100, router_mac, sizeof(router_mac)), NULL);
+    entry = route_table_find(100);
+    zassert_not_null(entry, NULL);
+    zassert_equal(entry->port_net, 1, NULL);
+    zassert_equal(entry->status, BACNET_ROUTE_AVAILABLE, NULL);
+    zassert_mem_equal(entry->mac, router_mac, sizeof(router_mac), NULL);
+    /* a route moves when it is heard through another router */
+    router_mac[3] = 3;
+    zassert_true(
+        route_table_learn(100, 1, router_mac, sizeof(router_mac)), NULL);
+    entry = route_table_find(100);
+    zassert_equal(entry->mac[3], 3, NULL);
+    zassert_equal(route_table_count(), 3, NULL);
+    /* fill the table - the buckets chain colliding networks */
+    net = 100 + route_table_size();
+    while (route_table_count() < route_table_size()) {
+        zassert_true(route_table_learn(net, 2, &mstp_mac, 1), NULL);
+        net += route_table_size();
+    }
+    zassert_false(route_table_learn(net, 2, &mstp_mac, 1), NULL);
+    zassert_not_null(route_table_find(100), NULL);
+    zassert_not_null(route_table_find(100 + route_table_size()), NULL);
+    count = 0;
+    for (index = 0; index < route_table_size(); index++) {
+        if (route_table_entry(index)) {
+            count++;
+        }
+    }
+    zassert_equal(count, route_table_count(), NULL);
+    zassert_is_null(route_table_entry(route_table_size()), NULL);
+    /* removing a port removes the networks reachable through it */
+    zassert_true(route_table_remove(2), NULL);
+    zassert_false(route_table_remove(2), NULL);
+    zassert_equal(route_table_count(), 2, NULL);
+    zassert_is_null(route_table_find(100 + route_table_size()), NULL);
+    zassert_not_null(route_table_find(100), NULL);
+    zassert_true(route_table_remove(100), NULL);
+    zassert_is_null(route_table_find(100), NULL);
+    zassert_not_null(route_table_find(1), NULL);
+}
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(route_table_tests, testRouteTableAging)
+#else
+static void testRouteTableAging(void)
+#endif
+{
+    BACNET_ROUTE_TABLE_ENTRY *entry;
+    const uint8_t mac = 5;
+
+    route_table_init();
+    route_table_lifetime_set(120);
+    zassert_true(route_table_port_add(1, &mac, 1), NULL);
+    zassert_true(route_table_learn(10, 1, &mac, 1), NULL);
+    zassert_true(route_table_learn(11, 1, &mac, 1), NULL);
+    /* busy until available, or the busy time ends */
+    zassert_false(route_table_status_set(1, BACNET_ROUTE_BUSY), NULL);
+    zassert_true(route_table_status_set(10, BACNET_ROUTE_BUSY), NULL);
+    zassert_true(route_table_status_set(11, BACNET_ROUTE_BUSY), NULL);
+    zassert_true(route_table_status_set(11, BACNET_ROUTE_AVAILABLE), NULL);
+    route_table_timer_seconds(BACNET_ROUTE_TABLE_BUSY_TIME - 1);
+    entry = route_table_find(10);
+    zassert_equal(entry->status, BACNET_ROUTE_BUSY, NULL);
+    zassert_equal(route_table_find(11)->status, BACNET_ROUTE_AVAILABLE, NULL);
+    route_table_timer_seconds(1);
+    zassert_equal(entry->status, BACNET_ROUTE_AVAILABLE, NULL);
+    /* unreachable stays until the network is heard of again */
+    zassert_true(route_table_status_set(10, BACNET_ROUTE_UNREACHABLE), NULL);
+    route_table_timer_seconds(BACNET_ROUTE_TABLE_BUSY_TIME);
+    zassert_equal(entry->status, BACNET_ROUTE_UNREACHABLE, NULL);
+    zassert_true(route_table_learn(10, 1, &mac, 1), NULL);
+    zassert_equal(entry->status, BACNET_ROUTE_AVAILABLE, NULL);
+    /* learned networks are forgotten; ports never are */
+    route_table_timer_seconds(60);
+    zassert_not_null(route_table_find(10), NULL);
+    zassert_is_null(route_table_find(11), NULL);
+    route_table_timer_seconds(59);
+    zassert_not_null(route_table_find(10), NULL);
+    route_table_timer_seconds(1);
+    zassert_is_null(route_table_find(10), NULL);
+    route_table_timer_seconds(3600);
+    zassert_not_null(route_table_find(1), NULL);
+    zassert_equal(route_table_count(), 1, NULL);
+    /* a lifetime of zero keeps learned networks */
+    route_table_lifetime_set(0);
+    zassert_true(route_table_learn(10, 1, &mac, 1), NULL);
+    route_table_timer_seconds(3600);
+    zassert_not_null(route_table_find(10), NULL);
+    route_table_lifetime_set(BACNET_ROUTE_TABLE_LIFETIME);
+    /* resized storage */
+    zassert_false(route_table_size_set(0), NULL);
+    zassert_true(route_table_size_set(1000), NULL);
+    zassert_equal(route_table_size(), 1000, NULL);
+    zassert_equal(route_table_count(), 0, NULL);
+    zassert_true(route_table_port_add(1, &mac, 1), NULL);
+    zassert_true(route_table_learn(999, 1, &mac, 1), NULL);
+    zassert_not_null(route_table_find(999), NULL);
+    zassert_true(route_table_size_set(BACNET_ROUTE_TABLE_SIZE), NULL);
+    zassert_is_null(route_table_find(999), NULL);
+}
+/**
+ * @}
+ */
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST_SUITE(route_table_tests, NULL, NULL, NULL, NULL, NULL);
+#else
+void test_main(void)
+{
+    ztest_test_suite(
+        route_table_tests, ztest_unit_test(testRouteTable),
+        ztest_unit_test(testRouteTableAging));
+
+    ztest_run_test_suite(route_table_tests);
+}
+#endif
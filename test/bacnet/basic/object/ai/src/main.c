@@ -45,6 +45,58 @@ static void testAnalogInput(void)
     status = Analog_Input_Delete(object_instance);
     zassert_true(status, NULL);
 }
+static unsigned Test_COV_Changed_Count;
+static uint32_t Test_COV_Changed_Instance;
+
+static void test_cov_changed(
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
+    OBJECT_CHANGE change)
+{
+    if (change != OBJECT_CHANGE_COV) {
+        return;
+    }
+    zassert_equal(object_type, OBJECT_ANALOG_INPUT, NULL);
+    Test_COV_Changed_Instance = object_instance;
+    Test_COV_Changed_Count++;
+}
+
+/**
+ * @brief Test the COV changes reported by the object changed callback
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(ai_tests, testAnalogInputCOVChanged)
+#else
+static void testAnalogInputCOVChanged(void)
+#endif
+{
+    uint32_t object_instance = 0;
+    unsigned changes = 0;
+
+    Analog_Input_Init();
+    object_instance = Analog_Input_Create(42);
+    Analog_Input_COV_Increment_Set(object_instance, 1.0f);
+    Analog_Input_Change_Of_Value_Clear(object_instance);
+    changes = Analog_Input_Changed_Callback_Set(test_cov_changed);
+    zassert_true(changes & OBJECT_CHANGE_COV, NULL);
+    Test_COV_Changed_Count = 0;
+    /* less than the COV increment is not a change */
+    Analog_Input_Present_Value_Set(object_instance, 0.5f);
+    zassert_equal(Test_COV_Changed_Count, 0, NULL);
+    zassert_false(Analog_Input_Change_Of_Value(object_instance), NULL);
+    /* only the first change is told until the flag is cleared */
+    Analog_Input_Present_Value_Set(object_instance, 2.0f);
+    zassert_equal(Test_COV_Changed_Count, 1, NULL);
+    zassert_equal(Test_COV_Changed_Instance, object_instance, NULL);
+    zassert_true(Analog_Input_Change_Of_Value(object_instance), NULL);
+    Analog_Input_Present_Value_Set(object_instance, 4.0f);
+    zassert_equal(Test_COV_Changed_Count, 1, NULL);
+    Analog_Input_Change_Of_Value_Clear(object_instance);
+    Analog_Input_Out_Of_Service_Set(object_instance, true);
+    zassert_equal(Test_COV_Changed_Count, 2, NULL);
+    Analog_Input_Changed_Callback_Set(NULL);
+    zassert_true(Analog_Input_Delete(object_instance), NULL);
+}
 /**
  * @}
  */
@@ -54,7 +106,9 @@ ZTEST_SUITE(ai_tests, NULL, NULL, NULL, NULL, NULL);
 #else
 void test_main(void)
 {
-    ztest_test_suite(ai_tests, ztest_unit_test(testAnalogInput));
+    ztest_test_suite(
+        ai_tests, ztest_unit_test(testAnalogInput),
+        ztest_unit_test(testAnalogInputCOVChanged));
 
     ztest_run_test_suite(ai_tests);
 }
@@ -65,3 +65,17 @@ void handler_get_alarm_summary_set(
     (void)object_type;
     (void)pFunction;
 }
+
+void handler_get_event_information_active_set(
+    BACNET_OBJECT_TYPE object_type, get_event_active_function pFunction)
+{
+    (void)object_type;
+    (void)pFunction;
+}
+
+void handler_get_alarm_summary_active_set(
+    BACNET_OBJECT_TYPE object_type, get_event_active_function pFunction)
+{
+    (void)object_type;
+    (void)pFunction;
+}
@@ -10,6 +10,10 @@
 
 #include <zephyr/ztest.h>
 #include <bacnet/basic/object/device.h>
+#include <bacnet/basic/object/ai.h>
+#include <bacnet/basic/object/av.h>
+#include <bacnet/basic/service/h_cov.h>
+#include <bacnet/cov.h>
 #include <bacnet/bactext.h>
 
 /**
@@ -227,6 +231,452 @@ static void testDevice(void)
 
     return;
 }
+/**
+ * @brief Find an object in the Device Object_List
+ * @return array index of the object, or zero if not found
+ */
+static uint32_t test_Object_List_Index(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+    BACNET_OBJECT_TYPE type = OBJECT_NONE;
+    uint32_t instance = 0;
+    uint32_t count, i;
+
+    count = Device_Object_List_Count();
+    for (i = 1; i <= count; i++) {
+        if (Device_Object_List_Identifier(i, &type, &instance) &&
+            (type == object_type) && (instance == object_instance)) {
+            return i;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Test the Object_List after objects are created and deleted
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(device_tests, testDevice_Object_List)
+#else
+static void testDevice_Object_List(void)
+#endif
+{
+    BACNET_CREATE_OBJECT_DATA create_data = { 0 };
+    BACNET_DELETE_OBJECT_DATA delete_data = { 0 };
+    BACNET_OBJECT_TYPE type = OBJECT_NONE;
+    uint32_t instance = 0;
+    uint32_t index = 0;
+    unsigned count = 0;
+    unsigned i = 0;
+    bool status = false;
+
+    Device_Init(NULL);
+    count = Device_Object_List_Count();
+    zassert_true(count > 0, NULL);
+    zassert_false(Device_Object_List_Identifier(0, &type, &instance), NULL);
+    zassert_false(
+        Device_Object_List_Identifier(count + 1, &type, &instance), NULL);
+    status = Device_Object_List_Identifier(1, &type, &instance);
+    zassert_true(status, NULL);
+    zassert_equal(type, OBJECT_DEVICE, NULL);
+    zassert_equal(instance, Device_Object_Instance_Number(), NULL);
+    /* created objects are in the list */
+    create_data.object_type = OBJECT_ANALOG_INPUT;
+    create_data.object_instance = 1234;
+    status = Device_Create_Object(&create_data);
+    zassert_true(status, NULL);
+    zassert_equal(Device_Object_List_Count(), count + 1, NULL);
+    zassert_not_equal(
+        test_Object_List_Index(OBJECT_ANALOG_INPUT, 1234), 0, NULL);
+    zassert_false(
+        Device_Object_List_Identifier(count + 2, &type, &instance), NULL);
+    /* objects created outside of CreateObject are in the list */
+    zassert_equal(Analog_Input_Create(4321), 4321, NULL);
+    zassert_equal(Device_Object_List_Count(), count + 2, NULL);
+    zassert_not_equal(
+        test_Object_List_Index(OBJECT_ANALOG_INPUT, 4321), 0, NULL);
+    /* deleted objects are not in the list */
+    delete_data.object_type = OBJECT_ANALOG_INPUT;
+    delete_data.object_instance = 1234;
+    status = Device_Delete_Object(&delete_data);
+    zassert_true(status, NULL);
+    zassert_equal(Device_Object_List_Count(), count + 1, NULL);
+    zassert_equal(test_Object_List_Index(OBJECT_ANALOG_INPUT, 1234), 0, NULL);
+    zassert_not_equal(
+        test_Object_List_Index(OBJECT_ANALOG_INPUT, 4321), 0, NULL);
+    /* an object replaced outside of CreateObject and DeleteObject,
+       which keeps the count, is in the list */
+    zassert_true(Analog_Input_Delete(4321), NULL);
+    zassert_equal(Analog_Input_Create(5678), 5678, NULL);
+    zassert_equal(Device_Object_List_Count(), count + 1, NULL);
+    zassert_equal(test_Object_List_Index(OBJECT_ANALOG_INPUT, 4321), 0, NULL);
+    zassert_not_equal(
+        test_Object_List_Index(OBJECT_ANALOG_INPUT, 5678), 0, NULL);
+    zassert_true(Analog_Input_Delete(5678), NULL);
+    zassert_equal(Device_Object_List_Count(), count, NULL);
+    zassert_equal(test_Object_List_Index(OBJECT_ANALOG_INPUT, 5678), 0, NULL);
+    /* many objects created and deleted in place, past the growth of the
+       cache and of its index */
+    for (i = 0; i < 100; i++) {
+        zassert_equal(Analog_Value_Create(1000 + i), 1000 + i, NULL);
+    }
+    zassert_equal(Device_Object_List_Count(), count + 100, NULL);
+    for (i = 0; i < 100; i += 3) {
+        zassert_true(Analog_Value_Delete(1000 + i), NULL);
+    }
+    for (i = 0; i < 100; i++) {
+        index = test_Object_List_Index(OBJECT_ANALOG_VALUE, 1000 + i);
+        if ((i % 3) == 0) {
+            zassert_equal(index, 0, NULL);
+        } else {
+            zassert_not_equal(index, 0, NULL);
+        }
+    }
+    status = Device_Object_List_Identifier(1, &type, &instance);
+    zassert_true(status, NULL);
+    zassert_equal(type, OBJECT_DEVICE, NULL);
+    for (i = 0; i < 100; i++) {
+        (void)Analog_Value_Delete(1000 + i);
+    }
+    zassert_equal(Device_Object_List_Count(), count, NULL);
+    for (i = 1; i <= count; i++) {
+        zassert_true(Device_Object_List_Identifier(i, &type, &instance), NULL);
+        zassert_equal(test_Object_List_Index(type, instance), i, NULL);
+    }
+}
+
+/**
+ * @brief Test the object name lookup after objects are renamed,
+ * created, and deleted
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(device_tests, testDevice_Object_Name)
+#else
+static void testDevice_Object_Name(void)
+#endif
+{
+    BACNET_CREATE_OBJECT_DATA create_data = { 0 };
+    BACNET_DELETE_OBJECT_DATA delete_data = { 0 };
+    BACNET_CHARACTER_STRING object_name = { 0 };
+    BACNET_CHARACTER_STRING old_name = { 0 };
+    BACNET_OBJECT_TYPE type = OBJECT_NONE;
+    uint32_t instance = 0;
+    bool status = false;
+
+    Device_Init(NULL);
+    /* the device object name is found */
+    status = Device_Object_Name_Copy(
+        OBJECT_DEVICE, Device_Object_Instance_Number(), &object_name);
+    zassert_true(status, NULL);
+    status = Device_Valid_Object_Name(&object_name, &type, &instance);
+    zassert_true(status, NULL);
+    zassert_equal(type, OBJECT_DEVICE, NULL);
+    zassert_equal(instance, Device_Object_Instance_Number(), NULL);
+    /* a renamed device object is found by the new name only */
+    old_name = object_name;
+    characterstring_init_ansi(&object_name, "Renamed Device");
+    zassert_true(Device_Set_Object_Name(&object_name), NULL);
+    zassert_false(Device_Valid_Object_Name(&old_name, NULL, NULL), NULL);
+    zassert_true(Device_Valid_Object_Name(&object_name, &type, NULL), NULL);
+    zassert_equal(type, OBJECT_DEVICE, NULL);
+    /* created objects are found by name */
+    create_data.object_type = OBJECT_ANALOG_INPUT;
+    create_data.object_instance = 1234;
+    status = Device_Create_Object(&create_data);
+    zassert_true(status, NULL);
+    zassert_true(Analog_Input_Name_Set(1234, "AI-1234"), NULL);
+    characterstring_init_ansi(&object_name, "AI-1234");
+    status = Device_Valid_Object_Name(&object_name, &type, &instance);
+    zassert_true(status, NULL);
+    zassert_equal(type, OBJECT_ANALOG_INPUT, NULL);
+    zassert_equal(instance, 1234, NULL);
+    /* an object renamed by its object type is found by the new name */
+    zassert_true(Analog_Input_Name_Set(1234, "AI-5678"), NULL);
+    zassert_false(Device_Valid_Object_Name(&object_name, NULL, NULL), NULL);
+    characterstring_init_ansi(&object_name, "AI-5678");
+    status = Device_Valid_Object_Name(&object_name, &type, &instance);
+    zassert_true(status, NULL);
+    zassert_equal(type, OBJECT_ANALOG_INPUT, NULL);
+    zassert_equal(instance, 1234, NULL);
+    /* an unknown name is not found */
+    characterstring_init_ansi(&object_name, "AI-4321");
+    zassert_false(Device_Valid_Object_Name(&object_name, NULL, NULL), NULL);
+    /* deleted objects are not found by name */
+    delete_data.object_type = OBJECT_ANALOG_INPUT;
+    delete_data.object_instance = 1234;
+    status = Device_Delete_Object(&delete_data);
+    zassert_true(status, NULL);
+    characterstring_init_ansi(&object_name, "AI-5678");
+    zassert_false(Device_Valid_Object_Name(&object_name, NULL, NULL), NULL);
+    /* the names follow the objects that are moved in the Object_List
+       when another object is deleted */
+    zassert_equal(Analog_Value_Create(2000), 2000, NULL);
+    zassert_equal(Analog_Value_Create(2001), 2001, NULL);
+    zassert_true(Analog_Value_Name_Set(2000, "AV-2000"), NULL);
+    zassert_true(Analog_Value_Name_Set(2001, "AV-2001"), NULL);
+    characterstring_init_ansi(&object_name, "AV-2000");
+    zassert_true(Device_Valid_Object_Name(&object_name, NULL, NULL), NULL);
+    zassert_true(Analog_Value_Delete(2000), NULL);
+    zassert_false(Device_Valid_Object_Name(&object_name, NULL, NULL), NULL);
+    zassert_true(Analog_Value_Name_Set(2001, "AV-2002"), NULL);
+    characterstring_init_ansi(&object_name, "AV-2001");
+    zassert_false(Device_Valid_Object_Name(&object_name, NULL, NULL), NULL);
+    characterstring_init_ansi(&object_name, "AV-2002");
+    status = Device_Valid_Object_Name(&object_name, &type, &instance);
+    zassert_true(status, NULL);
+    zassert_equal(type, OBJECT_ANALOG_VALUE, NULL);
+    zassert_equal(instance, 2001, NULL);
+    zassert_true(Analog_Value_Delete(2001), NULL);
+    zassert_false(Device_Valid_Object_Name(&object_name, NULL, NULL), NULL);
+}
+/**
+ * @brief Run the COV task until it has completed one cycle
+ */
+static void test_cov_cycle(void)
+{
+    unsigned count = 0;
+
+    handler_cov_fsm(false);
+    while (!handler_cov_fsm(false)) {
+        count++;
+        zassert_true(count < 10000, NULL);
+    }
+}
+
+/**
+ * @brief Test that objects that tell the COV handler when they change
+ *  are sent without polling
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(device_tests, testDevice_COV_Changed)
+#else
+static void testDevice_COV_Changed(void)
+#endif
+{
+    BACNET_SUBSCRIBE_COV_DATA cov_data = { 0 };
+    BACNET_CONFIRMED_SERVICE_DATA service_data = { 0 };
+    BACNET_ADDRESS src = { 0 };
+    uint8_t service_request[MAX_APDU] = { 0 };
+    uint32_t object_instance = 7;
+    uint32_t other_instance = 8;
+    int len;
+
+    Device_Init(NULL);
+    handler_cov_init();
+    Analog_Input_Create(object_instance);
+    Analog_Input_Create(other_instance);
+    Analog_Input_COV_Increment_Set(object_instance, 1.0f);
+    Analog_Input_COV_Increment_Set(other_instance, 1.0f);
+    cov_data.subscriberProcessIdentifier = 1;
+    cov_data.monitoredObjectIdentifier.type = OBJECT_ANALOG_INPUT;
+    cov_data.monitoredObjectIdentifier.instance = object_instance;
+    cov_data.issueConfirmedNotifications = false;
+    cov_data.lifetime = 300;
+    len = cov_subscribe_service_request_encode(
+        service_request, sizeof(service_request), &cov_data);
+    zassert_true(len > 0, NULL);
+    src.mac_len = 1;
+    src.mac[0] = 1;
+    service_data.invoke_id = 1;
+    handler_cov_subscribe(service_request, len, &src, &service_data);
+    /* the initial notification clears the COV flag */
+    test_cov_cycle();
+    zassert_false(Analog_Input_Change_Of_Value(object_instance), NULL);
+    /* a change is found and cleared */
+    Analog_Input_Present_Value_Set(object_instance, 100.0f);
+    zassert_true(Analog_Input_Change_Of_Value(object_instance), NULL);
+    test_cov_cycle();
+    zassert_false(Analog_Input_Change_Of_Value(object_instance), NULL);
+    /* a change without a subscription is cleared, to be told again */
+    Analog_Input_Present_Value_Set(other_instance, 100.0f);
+    zassert_true(Analog_Input_Change_Of_Value(other_instance), NULL);
+    test_cov_cycle();
+    zassert_false(Analog_Input_Change_Of_Value(other_instance), NULL);
+    /* polled objects are still found */
+    handler_cov_change_notify_type_set(OBJECT_ANALOG_INPUT, false);
+    Analog_Input_Changed_Callback_Set(NULL);
+    Analog_Input_Present_Value_Set(object_instance, 200.0f);
+    zassert_true(Analog_Input_Change_Of_Value(object_instance), NULL);
+    test_cov_cycle();
+    zassert_false(Analog_Input_Change_Of_Value(object_instance), NULL);
+    handler_cov_init();
+    Device_Init(NULL);
+}
+
+/**
+ * @brief Subscribe to COV of Analog Input 7 for testing
+ */
+static void test_cov_subscribe(
+    BACNET_ADDRESS *src, uint32_t pid, uint32_t lifetime, bool cancel)
+{
+    BACNET_SUBSCRIBE_COV_DATA cov_data = { 0 };
+    BACNET_CONFIRMED_SERVICE_DATA service_data = { 0 };
+    uint8_t service_request[MAX_APDU] = { 0 };
+    int len;
+
+    cov_data.subscriberProcessIdentifier = pid;
+    cov_data.monitoredObjectIdentifier.type = OBJECT_ANALOG_INPUT;
+    cov_data.monitoredObjectIdentifier.instance = 7;
+    cov_data.cancellationRequest = cancel;
+    cov_data.issueConfirmedNotifications = false;
+    cov_data.lifetime = lifetime;
+    len = cov_subscribe_service_request_encode(
+        service_request, sizeof(service_request), &cov_data);
+    zassert_true(len > 0, NULL);
+    service_data.invoke_id = 1;
+    handler_cov_subscribe(service_request, len, src, &service_data);
+}
+
+/**
+ * @brief Count the active COV subscriptions for testing. Each one
+ *  has the same encoded length when the PIDs are less than 256.
+ */
+static int test_cov_count(int subscription_len)
+{
+    static uint8_t apdu[8192];
+    int len;
+
+    len = handler_cov_encode_subscriptions(apdu, sizeof(apdu));
+    zassert_true(len >= 0, NULL);
+    zassert_equal(len % subscription_len, 0, NULL);
+
+    return len / subscription_len;
+}
+
+/**
+ * @brief Test the resized COV subscription table, the shared
+ *  subscriber addresses, and the subscription lifetimes
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(device_tests, testDevice_COV_Subscriptions)
+#else
+static void testDevice_COV_Subscriptions(void)
+#endif
+{
+    BACNET_ADDRESS src[3] = { 0 };
+    uint8_t apdu[MAX_APDU] = { 0 };
+    int subscription_len;
+    uint32_t pid;
+    unsigned i;
+
+    for (i = 0; i < 3; i++) {
+        src[i].mac_len = 1;
+        src[i].mac[0] = i + 1;
+    }
+    Device_Init(NULL);
+    Analog_Input_Create(7);
+    zassert_false(handler_cov_size_set(0, 2), NULL);
+    zassert_true(handler_cov_size_set(200, 2), NULL);
+    zassert_equal(handler_cov_size(), 200, NULL);
+    test_cov_subscribe(&src[0], 0, 0, false);
+    subscription_len = handler_cov_encode_subscriptions(apdu, sizeof(apdu));
+    zassert_true(subscription_len > 0, NULL);
+    /* more than the default number of subscriptions, from two addresses;
+       the odd ones expire in 10 seconds */
+    for (pid = 1; pid < 200; pid++) {
+        test_cov_subscribe(&src[pid % 2], pid, (pid % 2) ? 10 : 0, false);
+    }
+    zassert_equal(test_cov_count(subscription_len), 200, NULL);
+    /* the table is full */
+    test_cov_subscribe(&src[0], 200, 0, false);
+    zassert_equal(test_cov_count(subscription_len), 200, NULL);
+    /* a subscription is renewed rather than added */
+    test_cov_subscribe(&src[0], 0, 0, false);
+    zassert_equal(test_cov_count(subscription_len), 200, NULL);
+    /* the address table is full */
+    test_cov_subscribe(&src[0], 0, 0, true);
+    zassert_equal(test_cov_count(subscription_len), 199, NULL);
+    test_cov_subscribe(&src[2], 0, 0, false);
+    zassert_equal(test_cov_count(subscription_len), 199, NULL);
+    /* the odd subscriptions expire, releasing their address */
+    handler_cov_timer_seconds(9);
+    zassert_equal(test_cov_count(subscription_len), 199, NULL);
+    handler_cov_timer_seconds(1);
+    zassert_equal(test_cov_count(subscription_len), 99, NULL);
+    test_cov_subscribe(&src[2], 0, 0, false);
+    zassert_equal(test_cov_count(subscription_len), 100, NULL);
+    /* a lifetime shorter than the elapsed time */
+    test_cov_subscribe(&src[2], 1, 5, false);
+    zassert_equal(test_cov_count(subscription_len), 101, NULL);
+    handler_cov_timer_seconds(1000);
+    zassert_equal(test_cov_count(subscription_len), 100, NULL);
+    test_cov_cycle();
+    zassert_true(
+        handler_cov_size_set(MAX_COV_SUBCRIPTIONS, MAX_COV_ADDRESSES), NULL);
+    zassert_equal(test_cov_count(subscription_len), 0, NULL);
+    Device_Init(NULL);
+}
+
+/**
+ * @brief Determine if an Analog Input has an active event
+ */
+static bool test_analog_input_event_active(uint32_t object_instance)
+{
+    uint32_t instance = object_instance;
+    unsigned index = 0;
+
+    if (!Analog_Input_Event_Active_Next(&instance, &index)) {
+        return false;
+    }
+
+    return (instance == object_instance);
+}
+
+/**
+ * @brief Test that the Analog Input objects are evaluated by the intrinsic
+ *  reporting tick only when they are scheduled
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(device_tests, testDevice_Event_Detection)
+#else
+static void testDevice_Event_Detection(void)
+#endif
+{
+    uint32_t object_instance = 11;
+    unsigned i;
+
+    Device_Init(NULL);
+    Analog_Input_Create(object_instance);
+    /* every object is evaluated once after the Device_Init() */
+    Device_local_reporting();
+    Device_local_reporting();
+    zassert_equal(Device_Event_Detection_Pending(), 0, NULL);
+    /* without Event_Enable, an object is never evaluated */
+    Analog_Input_High_Limit_Set(object_instance, 50.0f);
+    Analog_Input_Low_Limit_Set(object_instance, 0.0f);
+    Analog_Input_Limit_Enable_Set(
+        object_instance, EVENT_HIGH_LIMIT_ENABLE | EVENT_LOW_LIMIT_ENABLE);
+    Analog_Input_Time_Delay_Set(object_instance, 2);
+    Analog_Input_Present_Value_Set(object_instance, 100.0f);
+    zassert_equal(Device_Event_Detection_Pending(), 0, NULL);
+    Device_local_reporting();
+    zassert_equal(Device_Event_Detection_Pending(), 0, NULL);
+    zassert_false(test_analog_input_event_active(object_instance), NULL);
+    Analog_Input_Present_Value_Set(object_instance, 10.0f);
+    Analog_Input_Event_Enable_Set(
+        object_instance, EVENT_ENABLE_TO_OFFNORMAL | EVENT_ENABLE_TO_NORMAL);
+    zassert_equal(Device_Event_Detection_Pending(), 1, NULL);
+    Device_local_reporting();
+    zassert_equal(Device_Event_Detection_Pending(), 0, NULL);
+    /* a Present_Value change schedules exactly one evaluation */
+    Analog_Input_Present_Value_Set(object_instance, 100.0f);
+    Analog_Input_Present_Value_Set(object_instance, 101.0f);
+    zassert_equal(Device_Event_Detection_Pending(), 1, NULL);
+    /* the Time_Delay schedules it again each tick until the transition */
+    for (i = 0; i < 2; i++) {
+        Device_local_reporting();
+        zassert_equal(Device_Event_Detection_Pending(), 1, NULL);
+        zassert_false(test_analog_input_event_active(object_instance), NULL);
+    }
+    Device_local_reporting();
+    zassert_true(test_analog_input_event_active(object_instance), NULL);
+    Device_local_reporting();
+    zassert_equal(Device_Event_Detection_Pending(), 0, NULL);
+    Device_local_reporting();
+    zassert_equal(Device_Event_Detection_Pending(), 0, NULL);
+    Analog_Input_Delete(object_instance);
+}
 /**
  * @}
  */
@@ -238,7 +688,12 @@ void test_main(void)
 {
     ztest_test_suite(
         device_tests, ztest_unit_test(testDevice),
-        ztest_unit_test(test_Device_Data_Sharing));
+        ztest_unit_test(test_Device_Data_Sharing),
+        ztest_unit_test(testDevice_Object_List),
+        ztest_unit_test(testDevice_Object_Name),
+        ztest_unit_test(testDevice_COV_Changed),
+        ztest_unit_test(testDevice_COV_Subscriptions),
+        ztest_unit_test(testDevice_Event_Detection));
 
     ztest_run_test_suite(device_tests);
 }
@@ -13,6 +13,7 @@
 #include "bacnet/datetime.h"
 #include "bacnet/bacdef.h"
 #include "bacnet/npdu.h"
+#include "bacnet/basic/services.h"
 
 void datetime_init(void)
 {
@@ -50,3 +51,65 @@ int bip_send_pdu(
 
     return 0;
 }
+
+int Send_UEvent_Notify(
+    uint8_t *buffer,
+    const BACNET_EVENT_NOTIFICATION_DATA *data,
+    BACNET_ADDRESS *dest)
+{
+    (void)buffer;
+    (void)data;
+    (void)dest;
+
+    return 0;
+}
+
+uint8_t Send_CEvent_Notify(
+    uint32_t device_id, const BACNET_EVENT_NOTIFICATION_DATA *data)
+{
+    (void)device_id;
+    (void)data;
+
+    return 0;
+}
+
+void Send_WhoIs(int32_t low_limit, int32_t high_limit)
+{
+    (void)low_limit;
+    (void)high_limit;
+}
+
+void handler_get_event_information_set(
+    BACNET_OBJECT_TYPE object_type, get_event_info_function pFunction)
+{
+    (void)object_type;
+    (void)pFunction;
+}
+
+void handler_alarm_ack_set(
+    BACNET_OBJECT_TYPE object_type, alarm_ack_function pFunction)
+{
+    (void)object_type;
+    (void)pFunction;
+}
+
+void handler_get_alarm_summary_set(
+    BACNET_OBJECT_TYPE object_type, get_alarm_summary_function pFunction)
+{
+    (void)object_type;
+    (void)pFunction;
+}
+
+void handler_get_event_information_active_set(
+    BACNET_OBJECT_TYPE object_type, get_event_active_function pFunction)
+{
+    (void)object_type;
+    (void)pFunction;
+}
+
+void handler_get_alarm_summary_active_set(
+    BACNET_OBJECT_TYPE object_type, get_event_active_function pFunction)
+{
+    (void)object_type;
+    (void)pFunction;
+}
@@ -10,14 +10,14 @@
 #include <bacnet/basic/tsm/tsm.h>
 
 bool tsm_get_transaction_pdu(
+    const BACNET_ADDRESS *dest,
     uint8_t invokeID,
-    BACNET_ADDRESS *dest,
     BACNET_NPDU_DATA *ndpu_data,
     uint8_t *apdu,
     uint16_t *apdu_len)
 {
-    (void)invokeID;
     (void)dest;
+    (void)invokeID;
     (void)ndpu_data;
     (void)apdu;
     (void)apdu_len;
@@ -8,14 +8,156 @@
  */
 
 #include <zephyr/ztest.h>
+#include <bacnet/bacapp.h>
 #include <bacnet/basic/object/trendlog.h>
+#include <bacnet/datetime.h>
+#include <bacnet/readrange.h>
 #include <property_test.h>
+#if defined(__linux__)
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "trendlog-mmap.h"
+#endif
 
 /**
  * @addtogroup bacnet_tests
  * @{
  */
 
+/* log buffer in storage, and the positions it committed */
+static TL_DATA_REC Test_Records[4];
+static struct test_commit {
+    uint32_t object_instance;
+    uint32_t index;
+    uint32_t record_count;
+    uint32_t total_record_count;
+} Test_Commit[8];
+static unsigned Test_Commit_Count;
+
+static void test_trend_log_commit(
+    uint32_t object_instance,
+    uint32_t index,
+    uint32_t record_count,
+    uint32_t total_record_count)
+{
+    if (Test_Commit_Count < ARRAY_SIZE(Test_Commit)) {
+        Test_Commit[Test_Commit_Count].object_instance = object_instance;
+        Test_Commit[Test_Commit_Count].index = index;
+        Test_Commit[Test_Commit_Count].record_count = record_count;
+        Test_Commit[Test_Commit_Count].total_record_count =
+            total_record_count;
+    }
+    Test_Commit_Count++;
+}
+
+static void test_trend_log_commit_check(
+    unsigned n,
+    uint32_t object_instance,
+    uint32_t index,
+    uint32_t record_count,
+    uint32_t total_record_count)
+{
+    zassert_true(n < Test_Commit_Count, NULL);
+    zassert_equal(Test_Commit[n].object_instance, object_instance, NULL);
+    zassert_equal(Test_Commit[n].index, index, NULL);
+    zassert_equal(Test_Commit[n].record_count, record_count, NULL);
+    zassert_equal(
+        Test_Commit[n].total_record_count, total_record_count, NULL);
+}
+
+/**
+ * @brief Read an unsigned property of a Trend Log
+ * @param object_instance - object-instance number of the Trend Log
+ * @param property - property to read
+ * @return the value of the property
+ */
+static uint32_t
+test_trend_log_unsigned(uint32_t object_instance, BACNET_PROPERTY_ID property)
+{
+    uint8_t apdu[MAX_APDU] = { 0 };
+    BACNET_READ_PROPERTY_DATA rpdata = { 0 };
+    BACNET_APPLICATION_DATA_VALUE value = { 0 };
+    int len = 0;
+
+    rpdata.application_data = apdu;
+    rpdata.application_data_len = sizeof(apdu);
+    rpdata.object_type = OBJECT_TRENDLOG;
+    rpdata.object_instance = object_instance;
+    rpdata.object_property = property;
+    rpdata.array_index = BACNET_ARRAY_ALL;
+    len = Trend_Log_Read_Property(&rpdata);
+    zassert_true(len > 0, NULL);
+    len = bacapp_decode_application_data(apdu, len, &value);
+    zassert_true(len > 0, NULL);
+    zassert_equal(value.tag, BACNET_APPLICATION_TAG_UNSIGNED_INT, NULL);
+
+    return (uint32_t)value.type.Unsigned_Int;
+}
+
+/**
+ * @brief Write a property of a Trend Log
+ * @param object_instance - object-instance number of the Trend Log
+ * @param property - property to write
+ * @param value - value to write
+ * @param error_code - error code of a failed write
+ * @return true if the property was written
+ */
+static bool test_trend_log_write(
+    uint32_t object_instance,
+    BACNET_PROPERTY_ID property,
+    BACNET_APPLICATION_DATA_VALUE *value,
+    BACNET_ERROR_CODE *error_code)
+{
+    BACNET_WRITE_PROPERTY_DATA wp_data = { 0 };
+    bool status = false;
+
+    wp_data.object_type = OBJECT_TRENDLOG;
+    wp_data.object_instance = object_instance;
+    wp_data.object_property = property;
+    wp_data.array_index = BACNET_ARRAY_ALL;
+    wp_data.priority = BACNET_NO_PRIORITY;
+    wp_data.application_data_len =
+        bacapp_encode_application_data(wp_data.application_data, value);
+    status = Trend_Log_Write_Property(&wp_data);
+    *error_code = wp_data.error_code;
+
+    return status;
+}
+
+/**
+ * @brief Check the sequence number of the oldest record of a Trend Log
+ * @param object_instance - object-instance number of the Trend Log
+ * @param sequence - sequence number of the oldest record
+ */
+static void
+test_trend_log_first_sequence(uint32_t object_instance, uint32_t sequence)
+{
+    uint8_t apdu[MAX_APDU] = { 0 };
+    BACNET_READ_RANGE_DATA request = { 0 };
+    int len = 0;
+
+    request.object_type = OBJECT_TRENDLOG;
+    request.object_instance = object_instance;
+    request.object_property = PROP_LOG_BUFFER;
+    request.array_index = BACNET_ARRAY_ALL;
+    request.RequestType = RR_BY_POSITION;
+    request.Range.RefIndex = 1;
+    request.Count = 1;
+    len = rr_trend_log_encode(apdu, &request);
+    zassert_true(len > 0, NULL);
+    zassert_equal(request.ItemCount, 1, NULL);
+    request.RequestType = RR_BY_SEQUENCE;
+    request.Range.RefSeqNum = sequence;
+    request.Count = 1;
+    len = rr_trend_log_encode(apdu, &request);
+    zassert_true(len > 0, NULL);
+    zassert_equal(request.ItemCount, 1, NULL);
+    zassert_equal(request.FirstSequence, sequence, NULL);
+    zassert_true(
+        bitstring_bit(&request.ResultFlags, RESULT_FLAG_FIRST_ITEM), NULL);
+}
+
 /**
  * @brief Test
  */
@@ -37,6 +179,334 @@ static void test_Trend_Log_ReadProperty(void)
         Trend_Log_Read_Property, Trend_Log_Write_Property,
         known_fail_property_list);
 }
+
+/**
+ * @brief Test ReadRange of the log buffer by time and by sequence
+ */
+static void test_Trend_Log_ReadRange(void)
+{
+    uint8_t apdu[MAX_APDU] = { 0 };
+    BACNET_READ_RANGE_DATA request = { 0 };
+    BACNET_DATE_TIME bdatetime = { 0 };
+    bacnet_time_t tFirst = 0;
+    int len = 0;
+
+    Trend_Log_Init();
+    /* the first log holds 1000 records, 15 minutes apart, with
+       the sequence numbers 9001 to 10000 */
+    datetime_set_values(&bdatetime, 2009, 1, 1, 0, 0, 0, 0);
+    tFirst = TL_BAC_Time_To_Local(&bdatetime);
+    request.object_type = OBJECT_TRENDLOG;
+    request.object_instance = Trend_Log_Index_To_Instance(0);
+    request.object_property = PROP_LOG_BUFFER;
+    request.array_index = BACNET_ARRAY_ALL;
+    /* records after the reference time of the 11th record */
+    request.RequestType = RR_BY_TIME;
+    TL_Local_Time_To_BAC(&request.Range.RefTime, tFirst + (10 * 900));
+    request.Count = 5;
+    len = rr_trend_log_encode(apdu, &request);
+    zassert_true(len > 0, NULL);
+    zassert_equal(request.ItemCount, 5, NULL);
+    zassert_equal(request.FirstSequence, 9012, NULL);
+    /* records before the reference time of the 11th record */
+    TL_Local_Time_To_BAC(&request.Range.RefTime, tFirst + (10 * 900));
+    request.Count = -5;
+    len = rr_trend_log_encode(apdu, &request);
+    zassert_true(len > 0, NULL);
+    zassert_equal(request.ItemCount, 5, NULL);
+    zassert_equal(request.FirstSequence, 9006, NULL);
+    /* records before the reference time, pinned to the oldest record */
+    TL_Local_Time_To_BAC(&request.Range.RefTime, tFirst + 900 + 1);
+    request.Count = -5;
+    len = rr_trend_log_encode(apdu, &request);
+    zassert_true(len > 0, NULL);
+    zassert_equal(request.ItemCount, 2, NULL);
+    zassert_equal(request.FirstSequence, 9001, NULL);
+    zassert_true(
+        bitstring_bit(&request.ResultFlags, RESULT_FLAG_FIRST_ITEM), NULL);
+    /* no records before the oldest, or after the newest */
+    TL_Local_Time_To_BAC(&request.Range.RefTime, tFirst);
+    request.Count = -1;
+    len = rr_trend_log_encode(apdu, &request);
+    zassert_equal(len, 0, NULL);
+    TL_Local_Time_To_BAC(&request.Range.RefTime, tFirst + (999 * 900));
+    request.Count = 1;
+    len = rr_trend_log_encode(apdu, &request);
+    zassert_equal(len, 0, NULL);
+    /* records by sequence number, to the newest */
+    request.RequestType = RR_BY_SEQUENCE;
+    request.Range.RefSeqNum = 9998;
+    request.Count = 5;
+    len = rr_trend_log_encode(apdu, &request);
+    zassert_true(len > 0, NULL);
+    zassert_equal(request.ItemCount, 3, NULL);
+    zassert_equal(request.FirstSequence, 9998, NULL);
+    zassert_true(
+        bitstring_bit(&request.ResultFlags, RESULT_FLAG_LAST_ITEM), NULL);
+}
+
+/**
+ * @brief Test writing the Buffer_Size, which purges and resizes the log
+ */
+static void test_Trend_Log_Buffer_Size(void)
+{
+    BACNET_APPLICATION_DATA_VALUE value = { 0 };
+    BACNET_ERROR_CODE error_code = ERROR_CODE_SUCCESS;
+    uint32_t object_instance = 0;
+    unsigned i = 0;
+    bool status = false;
+
+    Trend_Log_Init();
+    object_instance = Trend_Log_Index_To_Instance(1);
+    zassert_equal(Trend_Log_Buffer_Size(object_instance), TL_MAX_ENTRIES, NULL);
+    /* not while the log is enabled */
+    value.tag = BACNET_APPLICATION_TAG_UNSIGNED_INT;
+    value.type.Unsigned_Int = 10;
+    status = test_trend_log_write(
+        object_instance, PROP_BUFFER_SIZE, &value, &error_code);
+    zassert_false(status, NULL);
+    zassert_equal(error_code, ERROR_CODE_WRITE_ACCESS_DENIED, NULL);
+    value.tag = BACNET_APPLICATION_TAG_BOOLEAN;
+    value.type.Boolean = false;
+    status =
+        test_trend_log_write(object_instance, PROP_ENABLE, &value, &error_code);
+    zassert_true(status, NULL);
+    /* resizing purges the log, leaving the buffer-purged record */
+    value.tag = BACNET_APPLICATION_TAG_UNSIGNED_INT;
+    value.type.Unsigned_Int = 10;
+    status = test_trend_log_write(
+        object_instance, PROP_BUFFER_SIZE, &value, &error_code);
+    zassert_true(status, NULL);
+    zassert_equal(Trend_Log_Buffer_Size(object_instance), 10, NULL);
+    zassert_equal(
+        test_trend_log_unsigned(object_instance, PROP_BUFFER_SIZE), 10, NULL);
+    zassert_equal(
+        test_trend_log_unsigned(object_instance, PROP_RECORD_COUNT), 1, NULL);
+    zassert_equal(
+        test_trend_log_unsigned(object_instance, PROP_TOTAL_RECORD_COUNT),
+        10001, NULL);
+    test_trend_log_first_sequence(object_instance, 10001);
+    /* the smaller buffer wraps */
+    for (i = 0; i < 14; i++) {
+        TL_Insert_Status_Rec(1, LOG_STATUS_LOG_INTERRUPTED, true);
+    }
+    zassert_equal(
+        test_trend_log_unsigned(object_instance, PROP_RECORD_COUNT), 10, NULL);
+    test_trend_log_first_sequence(object_instance, 10006);
+    /* a buffer larger than the default comes from the heap */
+    status = Trend_Log_Buffer_Size_Set(object_instance, 2 * TL_MAX_ENTRIES);
+    zassert_true(status, NULL);
+    zassert_equal(
+        Trend_Log_Buffer_Size(object_instance), 2 * TL_MAX_ENTRIES, NULL);
+    zassert_equal(
+        test_trend_log_unsigned(object_instance, PROP_RECORD_COUNT), 1, NULL);
+    for (i = 0; i < (2 * TL_MAX_ENTRIES) + 100; i++) {
+        TL_Insert_Status_Rec(1, LOG_STATUS_LOG_INTERRUPTED, true);
+    }
+    zassert_equal(
+        test_trend_log_unsigned(object_instance, PROP_RECORD_COUNT),
+        2 * TL_MAX_ENTRIES, NULL);
+    test_trend_log_first_sequence(object_instance, 10117);
+    /* and goes back to the heap when the log is resized again */
+    status = Trend_Log_Buffer_Size_Set(object_instance, 10);
+    zassert_true(status, NULL);
+    zassert_equal(Trend_Log_Buffer_Size(object_instance), 10, NULL);
+    zassert_equal(
+        test_trend_log_unsigned(object_instance, PROP_RECORD_COUNT), 1, NULL);
+    test_trend_log_first_sequence(object_instance, 12117);
+    /* Record_Count of 0 purges the log */
+    TL_Insert_Status_Rec(1, LOG_STATUS_LOG_INTERRUPTED, true);
+    value.type.Unsigned_Int = 0;
+    status = test_trend_log_write(
+        object_instance, PROP_RECORD_COUNT, &value, &error_code);
+    zassert_true(status, NULL);
+    zassert_equal(
+        test_trend_log_unsigned(object_instance, PROP_RECORD_COUNT), 1, NULL);
+    test_trend_log_first_sequence(object_instance, 12119);
+    /* no empty buffer, and no buffer for an unknown log */
+    status = Trend_Log_Buffer_Size_Set(object_instance, 0);
+    zassert_false(status, NULL);
+    status = Trend_Log_Buffer_Size_Set(Trend_Log_Count(), 10);
+    zassert_false(status, NULL);
+    zassert_equal(Trend_Log_Buffer_Size(Trend_Log_Count()), 0, NULL);
+}
+
+/**
+ * @brief Test handing the log buffer over to storage and back
+ */
+static void test_Trend_Log_Storage(void)
+{
+    TL_STORAGE storage = { 0 };
+    uint32_t object_instance = 0;
+    bool status = false;
+
+    Trend_Log_Init();
+    object_instance = Trend_Log_Index_To_Instance(2);
+    Test_Commit_Count = 0;
+    /* the records with sequence numbers 19 and 20 are in storage */
+    storage.pRecords = Test_Records;
+    storage.ulBufferSize = ARRAY_SIZE(Test_Records);
+    storage.ulIndex = 2;
+    storage.ulRecordCount = 2;
+    storage.ulTotalRecordCount = 20;
+    /* the position has to be in the log buffer */
+    storage.ulIndex = 4;
+    status = Trend_Log_Storage_Set(
+        object_instance, &storage, test_trend_log_commit);
+    zassert_false(status, NULL);
+    storage.ulIndex = 2;
+    storage.ulRecordCount = 5;
+    status = Trend_Log_Storage_Set(
+        object_instance, &storage, test_trend_log_commit);
+    zassert_false(status, NULL);
+    storage.ulRecordCount = 2;
+    status = Trend_Log_Storage_Set(
+        Trend_Log_Count(), &storage, test_trend_log_commit);
+    zassert_false(status, NULL);
+    status = Trend_Log_Storage_Set(
+        object_instance, &storage, test_trend_log_commit);
+    zassert_true(status, NULL);
+    zassert_equal(Trend_Log_Buffer_Size(object_instance), 4, NULL);
+    zassert_equal(
+        test_trend_log_unsigned(object_instance, PROP_RECORD_COUNT), 2, NULL);
+    zassert_equal(
+        test_trend_log_unsigned(object_instance, PROP_TOTAL_RECORD_COUNT), 20,
+        NULL);
+    test_trend_log_first_sequence(object_instance, 19);
+    /* the storage sizes its own log buffer */
+    status = Trend_Log_Buffer_Size_Set(object_instance, 10);
+    zassert_false(status, NULL);
+    zassert_equal(Trend_Log_Buffer_Size(object_instance), 4, NULL);
+    /* records go into storage, and their position is committed */
+    TL_Insert_Status_Rec(2, LOG_STATUS_LOG_INTERRUPTED, true);
+    zassert_equal(Test_Records[2].ucRecType, TL_TYPE_STATUS, NULL);
+    zassert_equal(Test_Commit_Count, 1, NULL);
+    test_trend_log_commit_check(0, object_instance, 3, 3, 21);
+    TL_Insert_Status_Rec(2, LOG_STATUS_LOG_INTERRUPTED, true);
+    zassert_equal(Test_Commit_Count, 2, NULL);
+    test_trend_log_commit_check(1, object_instance, 0, 4, 22);
+    /* the oldest record leaves the committed log buffer before its slot
+       is reused, so a crash while it is overwritten loses only that one */
+    TL_Insert_Status_Rec(2, LOG_STATUS_LOG_INTERRUPTED, true);
+    zassert_equal(Test_Commit_Count, 4, NULL);
+    test_trend_log_commit_check(2, object_instance, 0, 3, 22);
+    test_trend_log_commit_check(3, object_instance, 1, 4, 23);
+    zassert_equal(Test_Records[0].ucRecType, TL_TYPE_STATUS, NULL);
+    test_trend_log_first_sequence(object_instance, 20);
+    /* a log buffer from storage that is already wrapped */
+    status = Trend_Log_Storage_Set(object_instance, NULL, NULL);
+    zassert_true(status, NULL);
+    storage.ulIndex = 0;
+    storage.ulRecordCount = 3;
+    storage.ulTotalRecordCount = 22;
+    status = Trend_Log_Storage_Set(
+        object_instance, &storage, test_trend_log_commit);
+    zassert_true(status, NULL);
+    test_trend_log_first_sequence(object_instance, 20);
+    /* back to the default log buffer, empty */
+    status = Trend_Log_Storage_Set(object_instance, NULL, NULL);
+    zassert_true(status, NULL);
+    zassert_equal(Trend_Log_Buffer_Size(object_instance), TL_MAX_ENTRIES, NULL);
+    zassert_equal(
+        test_trend_log_unsigned(object_instance, PROP_RECORD_COUNT), 0, NULL);
+    Test_Commit_Count = 0;
+    TL_Insert_Status_Rec(2, LOG_STATUS_LOG_INTERRUPTED, true);
+    zassert_equal(Test_Commit_Count, 0, NULL);
+    zassert_equal(
+        test_trend_log_unsigned(object_instance, PROP_RECORD_COUNT), 1, NULL);
+}
+
+/**
+ * @brief Test keeping the log buffer in a memory-mapped file, reopened
+ *  as after a restart
+ */
+static void test_Trend_Log_Mmap(void)
+{
+#if defined(__linux__)
+    char pathname[] = "/tmp/test_trendlog_XXXXXX";
+    const uint32_t magic = 0;
+    uint32_t object_instance = 0;
+    unsigned i = 0;
+    bool status = false;
+    int fd = 0;
+
+    Trend_Log_Init();
+    object_instance = Trend_Log_Index_To_Instance(3);
+    fd = mkstemp(pathname);
+    zassert_true(fd >= 0, NULL);
+    close(fd);
+    /* a new file starts empty */
+    status = trend_log_mmap_open(object_instance, pathname, 5);
+    zassert_true(status, NULL);
+    zassert_equal(Trend_Log_Buffer_Size(object_instance), 5, NULL);
+    zassert_equal(
+        test_trend_log_unsigned(object_instance, PROP_RECORD_COUNT), 0, NULL);
+    for (i = 0; i < 7; i++) {
+        TL_Insert_Status_Rec(3, LOG_STATUS_LOG_INTERRUPTED, true);
+    }
+    zassert_equal(
+        test_trend_log_unsigned(object_instance, PROP_RECORD_COUNT), 5, NULL);
+    test_trend_log_first_sequence(object_instance, 3);
+    zassert_true(trend_log_mmap_sync(object_instance), NULL);
+    trend_log_mmap_close(object_instance);
+    zassert_false(trend_log_mmap_sync(object_instance), NULL);
+    zassert_equal(Trend_Log_Buffer_Size(object_instance), TL_MAX_ENTRIES, NULL);
+    zassert_equal(
+        test_trend_log_unsigned(object_instance, PROP_RECORD_COUNT), 0, NULL);
+    /* reopened, the records are where they were left */
+    status = trend_log_mmap_open(object_instance, pathname, 5);
+    zassert_true(status, NULL);
+    zassert_equal(
+        test_trend_log_unsigned(object_instance, PROP_RECORD_COUNT), 5, NULL);
+    zassert_equal(
+        test_trend_log_unsigned(object_instance, PROP_TOTAL_RECORD_COUNT), 7,
+        NULL);
+    test_trend_log_first_sequence(object_instance, 3);
+    TL_Insert_Status_Rec(3, LOG_STATUS_LOG_INTERRUPTED, true);
+    test_trend_log_first_sequence(object_instance, 4);
+    trend_log_mmap_close(object_instance);
+    status = trend_log_mmap_open(object_instance, pathname, 5);
+    zassert_true(status, NULL);
+    test_trend_log_first_sequence(object_instance, 4);
+    zassert_equal(
+        test_trend_log_unsigned(object_instance, PROP_TOTAL_RECORD_COUNT), 8,
+        NULL);
+    trend_log_mmap_close(object_instance);
+    /* another Buffer_Size starts empty */
+    status = trend_log_mmap_open(object_instance, pathname, 6);
+    zassert_true(status, NULL);
+    zassert_equal(Trend_Log_Buffer_Size(object_instance), 6, NULL);
+    zassert_equal(
+        test_trend_log_unsigned(object_instance, PROP_RECORD_COUNT), 0, NULL);
+    zassert_equal(
+        test_trend_log_unsigned(object_instance, PROP_TOTAL_RECORD_COUNT), 0,
+        NULL);
+    for (i = 0; i < 3; i++) {
+        TL_Insert_Status_Rec(3, LOG_STATUS_LOG_INTERRUPTED, true);
+    }
+    trend_log_mmap_cleanup();
+    status = trend_log_mmap_open(object_instance, pathname, 6);
+    zassert_true(status, NULL);
+    zassert_equal(
+        test_trend_log_unsigned(object_instance, PROP_RECORD_COUNT), 3, NULL);
+    trend_log_mmap_close(object_instance);
+    /* so does a file with another layout */
+    fd = open(pathname, O_RDWR);
+    zassert_true(fd >= 0, NULL);
+    zassert_equal(pwrite(fd, &magic, sizeof(magic), 0), sizeof(magic), NULL);
+    close(fd);
+    status = trend_log_mmap_open(object_instance, pathname, 6);
+    zassert_true(status, NULL);
+    zassert_equal(
+        test_trend_log_unsigned(object_instance, PROP_RECORD_COUNT), 0, NULL);
+    trend_log_mmap_cleanup();
+    status = trend_log_mmap_open(object_instance, NULL, 6);
+    zassert_false(status, NULL);
+    status = trend_log_mmap_open(object_instance, pathname, 0);
+    zassert_false(status, NULL);
+    unlink(pathname);
+#endif
+}
 /**
  * @}
  */
@@ -44,7 +514,11 @@ static void test_Trend_Log_ReadProperty(void)
 void test_main(void)
 {
     ztest_test_suite(
-        trendlog_tests, ztest_unit_test(test_Trend_Log_ReadProperty));
+        trendlog_tests, ztest_unit_test(test_Trend_Log_ReadRange),
+        ztest_unit_test(test_Trend_Log_ReadProperty),
+        ztest_unit_test(test_Trend_Log_Buffer_Size),
+        ztest_unit_test(test_Trend_Log_Storage),
+        ztest_unit_test(test_Trend_Log_Mmap));
 
     ztest_run_test_suite(trendlog_tests);
 }
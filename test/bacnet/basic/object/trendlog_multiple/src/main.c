@@ -0,0 +1,194 @@
+/**
+ * @file
+ * @brief Unit test for object
+ * @author agent <agent@local>
+ * @date October 2026
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/ztest.h>
+#include <bacnet/basic/object/trendlog_multiple.h>
+#include <bacnet/readrange.h>
+#include <property_test.h>
+
+/**
+ * @addtogroup bacnet_tests
+ * @{
+ */
+
+static unsigned Request_Count;
+
+/**
+ * @brief Take every property that is waited for
+ */
+static bool test_request(
+    uint32_t device_id,
+    const BACNET_OBJECT_ID *object_id,
+    BACNET_PROPERTY_ID property,
+    BACNET_ARRAY_INDEX array_index)
+{
+    (void)device_id;
+    (void)object_id;
+    (void)property;
+    (void)array_index;
+    Request_Count++;
+
+    return true;
+}
+
+/**
+ * @brief Add a member of another device to a log
+ */
+static void test_member_add(
+    uint32_t object_instance,
+    uint32_t device_id,
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t instance)
+{
+    BACNET_DEVICE_OBJECT_PROPERTY_REFERENCE member = { 0 };
+    bool status = false;
+
+    member.deviceIdentifier.type = OBJECT_DEVICE;
+    member.deviceIdentifier.instance = device_id;
+    member.objectIdentifier.type = object_type;
+    member.objectIdentifier.instance = instance;
+    member.propertyIdentifier = PROP_PRESENT_VALUE;
+    member.arrayIndex = BACNET_ARRAY_ALL;
+    status = Trend_Log_Multiple_Member_Add(object_instance, &member);
+    zassert_true(status, NULL);
+}
+
+/**
+ * @brief Test
+ */
+static void test_Trend_Log_Multiple_ReadProperty(void)
+{
+    unsigned count = 0;
+    uint32_t object_instance = 0;
+    bool status = false;
+    const int known_fail_property_list[] = { -1 };
+
+    Trend_Log_Multiple_Init();
+    object_instance = Trend_Log_Multiple_Create(BACNET_MAX_INSTANCE);
+    zassert_not_equal(object_instance, BACNET_MAX_INSTANCE, NULL);
+    count = Trend_Log_Multiple_Count();
+    zassert_true(count > 0, NULL);
+    object_instance = Trend_Log_Multiple_Index_To_Instance(0);
+    status = Trend_Log_Multiple_Valid_Instance(object_instance);
+    zassert_true(status, NULL);
+    test_member_add(object_instance, 123, OBJECT_ANALOG_INPUT, 1);
+    test_member_add(object_instance, 123, OBJECT_ANALOG_VALUE, 2);
+    bacnet_object_properties_read_write_test(
+        OBJECT_TREND_LOG_MULTIPLE, object_instance,
+        Trend_Log_Multiple_Property_Lists, Trend_Log_Multiple_Read_Property,
+        Trend_Log_Multiple_Write_Property, known_fail_property_list);
+    status = Trend_Log_Multiple_Delete(object_instance);
+    zassert_true(status, NULL);
+    Trend_Log_Multiple_Cleanup();
+}
+
+/**
+ * @brief Test a record acquired from other devices, and read by ReadRange
+ */
+static void test_Trend_Log_Multiple_Remote(void)
+{
+    uint8_t apdu[MAX_APDU] = { 0 };
+    BACNET_READ_RANGE_DATA request = { 0 };
+    BACNET_READ_PROPERTY_DATA rp_data = { 0 };
+    BACNET_APPLICATION_DATA_VALUE value = { 0 };
+    uint32_t object_instance = 1;
+    uint32_t total = 0;
+    unsigned count = 0;
+    int len = 0;
+
+    Trend_Log_Multiple_Init();
+    object_instance = Trend_Log_Multiple_Create(object_instance);
+    zassert_equal(object_instance, 1, NULL);
+    test_member_add(object_instance, 123, OBJECT_ANALOG_INPUT, 1);
+    test_member_add(object_instance, 123, OBJECT_ANALOG_VALUE, 2);
+    test_member_add(object_instance, 456, OBJECT_BINARY_INPUT, 3);
+    /* purged, then enabled */
+    zassert_true(Trend_Log_Multiple_Enable_Set(object_instance, true), NULL);
+    zassert_equal(Trend_Log_Multiple_Record_Count(object_instance), 2, NULL);
+    /* nothing is waited for until a record is started */
+    count = Trend_Log_Multiple_Remote_Requests(test_request);
+    zassert_equal(count, 0, NULL);
+    zassert_true(Trend_Log_Multiple_Trigger(object_instance), NULL);
+    Trend_Log_Multiple_Timer(object_instance, 100);
+    count = Trend_Log_Multiple_Remote_Requests(test_request);
+    zassert_equal(count, 3, NULL);
+    zassert_equal(Request_Count, 3, NULL);
+    /* each property is taken once */
+    count = Trend_Log_Multiple_Remote_Requests(test_request);
+    zassert_equal(count, 0, NULL);
+    /* the record waits for every member */
+    rp_data.object_type = OBJECT_ANALOG_INPUT;
+    rp_data.object_instance = 1;
+    rp_data.object_property = PROP_PRESENT_VALUE;
+    rp_data.array_index = BACNET_ARRAY_ALL;
+    value.tag = BACNET_APPLICATION_TAG_REAL;
+    value.type.Real = 21.5f;
+    Trend_Log_Multiple_Remote_Value(123, &rp_data, &value);
+    /* another device, same object */
+    rp_data.object_type = OBJECT_ANALOG_VALUE;
+    rp_data.object_instance = 2;
+    Trend_Log_Multiple_Remote_Value(456, &rp_data, &value);
+    zassert_equal(Trend_Log_Multiple_Record_Count(object_instance), 2, NULL);
+    Trend_Log_Multiple_Remote_Value(123, &rp_data, &value);
+    zassert_equal(Trend_Log_Multiple_Record_Count(object_instance), 2, NULL);
+    rp_data.object_type = OBJECT_BINARY_INPUT;
+    rp_data.object_instance = 3;
+    rp_data.error_class = ERROR_CLASS_OBJECT;
+    rp_data.error_code = ERROR_CODE_UNKNOWN_OBJECT;
+    Trend_Log_Multiple_Remote_Value(456, &rp_data, NULL);
+    zassert_equal(Trend_Log_Multiple_Record_Count(object_instance), 3, NULL);
+    total = Trend_Log_Multiple_Total_Record_Count(object_instance);
+    /* the whole log buffer */
+    request.object_type = OBJECT_TREND_LOG_MULTIPLE;
+    request.object_instance = object_instance;
+    request.object_property = PROP_LOG_BUFFER;
+    request.array_index = BACNET_ARRAY_ALL;
+    request.RequestType = RR_READ_ALL;
+    len = Trend_Log_Multiple_Read_Range(apdu, &request);
+    zassert_true(len > 0, NULL);
+    zassert_equal(request.ItemCount, 3, NULL);
+    zassert_true(
+        bitstring_bit(&request.ResultFlags, RESULT_FLAG_FIRST_ITEM), NULL);
+    zassert_true(
+        bitstring_bit(&request.ResultFlags, RESULT_FLAG_LAST_ITEM), NULL);
+    /* the newest record by sequence number */
+    request.RequestType = RR_BY_SEQUENCE;
+    request.Range.RefSeqNum = total;
+    request.Count = 5;
+    len = Trend_Log_Multiple_Read_Range(apdu, &request);
+    zassert_true(len > 0, NULL);
+    zassert_equal(request.ItemCount, 1, NULL);
+    zassert_equal(request.FirstSequence, total, NULL);
+    /* the two oldest records by position */
+    request.RequestType = RR_BY_POSITION;
+    request.Range.RefIndex = 2;
+    request.Count = -5;
+    len = Trend_Log_Multiple_Read_Range(apdu, &request);
+    zassert_true(len > 0, NULL);
+    zassert_equal(request.ItemCount, 2, NULL);
+    zassert_false(
+        bitstring_bit(&request.ResultFlags, RESULT_FLAG_LAST_ITEM), NULL);
+    /* changing the members purges the log buffer */
+    Trend_Log_Multiple_Member_Clear(object_instance);
+    zassert_equal(Trend_Log_Multiple_Record_Count(object_instance), 1, NULL);
+    Trend_Log_Multiple_Cleanup();
+}
+/**
+ * @}
+ */
+
+void test_main(void)
+{
+    ztest_test_suite(
+        trendlog_multiple_tests,
+        ztest_unit_test(test_Trend_Log_Multiple_ReadProperty),
+        ztest_unit_test(test_Trend_Log_Multiple_Remote));
+
+    ztest_run_test_suite(trendlog_multiple_tests);
+}
@@ -0,0 +1,188 @@
+/**
+ * @file
+ * @brief Unit test for the ReadPropertyMultiple service handler
+ * @author agent <agent@local>
+ * @date October 2026
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <string.h>
+#include <zephyr/ztest.h>
+#include <bacnet/bacdcode.h>
+#include <bacnet/npdu.h>
+#include <bacnet/rpm.h>
+#include <bacnet/basic/object/device.h>
+#include <bacnet/basic/object/netport.h>
+#include <bacnet/basic/services.h>
+#include <bacnet/datalink/datalink.h>
+
+/**
+ * @addtogroup bacnet_tests
+ * @{
+ */
+
+/* the most recent PDU sent by the handler */
+static uint8_t Test_Sent_PDU[MAX_PDU];
+static unsigned Test_Sent_PDU_Len;
+static unsigned Test_Sent_Count;
+/* the values found in the ReadPropertyMultiple-ACK */
+static unsigned Test_Ack_Value_Count;
+
+int bip_send_pdu(
+    BACNET_ADDRESS *dest,
+    BACNET_NPDU_DATA *npdu_data,
+    uint8_t *pdu,
+    unsigned pdu_len)
+{
+    (void)dest;
+    (void)npdu_data;
+    if (pdu_len <= sizeof(Test_Sent_PDU)) {
+        memcpy(Test_Sent_PDU, pdu, pdu_len);
+        Test_Sent_PDU_Len = pdu_len;
+    }
+    Test_Sent_Count++;
+
+    return (int)pdu_len;
+}
+
+void bip_get_my_address(BACNET_ADDRESS *my_address)
+{
+    if (my_address) {
+        memset(my_address, 0, sizeof(*my_address));
+        my_address->mac_len = 6;
+        my_address->mac[0] = 192;
+        my_address->mac[1] = 168;
+        my_address->mac[2] = 0;
+        my_address->mac[3] = 1;
+        my_address->mac[4] = 0xBA;
+        my_address->mac[5] = 0xC0;
+    }
+}
+
+uint32_t Device_Object_Instance_Number(void)
+{
+    return 1234;
+}
+
+uint32_t Network_Port_Index_To_Instance(unsigned find_index)
+{
+    (void)find_index;
+
+    return 1;
+}
+
+bool Device_Valid_Object_Id(
+    BACNET_OBJECT_TYPE object_type, uint32_t object_instance)
+{
+    return (object_type == OBJECT_ANALOG_INPUT) && (object_instance == 1);
+}
+
+void Device_Objects_Property_List(
+    BACNET_OBJECT_TYPE object_type,
+    uint32_t object_instance,
+    struct special_property_list_t *pPropertyList)
+{
+    (void)object_type;
+    (void)object_instance;
+    memset(pPropertyList, 0, sizeof(*pPropertyList));
+}
+
+int Device_Read_Property(BACNET_READ_PROPERTY_DATA *rpdata)
+{
+    if (!Device_Valid_Object_Id(
+            rpdata->object_type, rpdata->object_instance)) {
+        rpdata->error_class = ERROR_CLASS_OBJECT;
+        rpdata->error_code = ERROR_CODE_UNKNOWN_OBJECT;
+        return BACNET_STATUS_ERROR;
+    }
+    if (rpdata->object_property != PROP_PRESENT_VALUE) {
+        rpdata->error_class = ERROR_CLASS_PROPERTY;
+        rpdata->error_code = ERROR_CODE_UNKNOWN_PROPERTY;
+        return BACNET_STATUS_ERROR;
+    }
+
+    return encode_application_real(rpdata->application_data, 21.5f);
+}
+
+static void test_rpm_ack_value(
+    uint32_t device_id, BACNET_READ_PROPERTY_DATA *rp_data)
+{
+    (void)device_id;
+    if (rp_data->error_code == ERROR_CODE_SUCCESS) {
+        Test_Ack_Value_Count++;
+    }
+}
+
+/**
+ * @brief Get the APDU portion of the most recent PDU that was sent
+ * @return pointer to the APDU, and apdu_len is set to its length
+ */
+static uint8_t *test_sent_apdu(unsigned *apdu_len)
+{
+    BACNET_ADDRESS dest = { 0 };
+    BACNET_ADDRESS src = { 0 };
+    BACNET_NPDU_DATA npdu_data = { 0 };
+    int npdu_len = 0;
+
+    npdu_len = bacnet_npdu_decode(
+        Test_Sent_PDU, Test_Sent_PDU_Len, &dest, &src, &npdu_data);
+    zassert_true(npdu_len > 0, NULL);
+    *apdu_len = Test_Sent_PDU_Len - (unsigned)npdu_len;
+
+    return &Test_Sent_PDU[npdu_len];
+}
+
+/**
+ * @brief Test the handler reply when segmentation is not enabled
+ */
+static void test_handler_read_property_multiple(void)
+{
+    uint8_t service_request[MAX_APDU] = { 0 };
+    BACNET_CONFIRMED_SERVICE_DATA service_data = { 0 };
+    BACNET_READ_PROPERTY_DATA rp_data = { 0 };
+    BACNET_ADDRESS src = { 0 };
+    uint8_t *apdu = NULL;
+    unsigned apdu_len = 0;
+    int len = 0;
+
+    len = rpm_encode_apdu_object_begin(
+        &service_request[0], OBJECT_ANALOG_INPUT, 1);
+    len += rpm_encode_apdu_object_property(
+        &service_request[len], PROP_PRESENT_VALUE, BACNET_ARRAY_ALL);
+    len += rpm_encode_apdu_object_property(
+        &service_request[len], PROP_DESCRIPTION, BACNET_ARRAY_ALL);
+    len += rpm_encode_apdu_object_end(&service_request[len]);
+    service_data.invoke_id = 42;
+    service_data.max_resp = MAX_APDU;
+    src.mac_len = 1;
+    src.mac[0] = 1;
+    handler_read_property_multiple(
+        service_request, (uint16_t)len, &src, &service_data);
+    zassert_equal(Test_Sent_Count, 1, NULL);
+    apdu = test_sent_apdu(&apdu_len);
+    zassert_true(apdu_len > 3, NULL);
+    zassert_equal(apdu[0], PDU_TYPE_COMPLEX_ACK, NULL);
+    zassert_equal(apdu[1], 42, NULL);
+    zassert_equal(apdu[2], SERVICE_CONFIRMED_READ_PROP_MULTIPLE, NULL);
+    rpm_ack_object_property_process(
+        &apdu[3], apdu_len - 3, 1234, &rp_data, test_rpm_ack_value);
+    zassert_equal(Test_Ack_Value_Count, 1, NULL);
+    /* a reply larger than the requester accepts is aborted */
+    service_data.max_resp = 10;
+    handler_read_property_multiple(
+        service_request, (uint16_t)len, &src, &service_data);
+    zassert_equal(Test_Sent_Count, 2, NULL);
+    apdu = test_sent_apdu(&apdu_len);
+    zassert_equal(apdu[0] & 0xF0, PDU_TYPE_ABORT, NULL);
+    zassert_equal(apdu[1], 42, NULL);
+}
+/**
+ * @}
+ */
+
+void test_main(void)
+{
+    ztest_test_suite(
+        h_rpm_tests, ztest_unit_test(test_handler_read_property_multiple));
+
+    ztest_run_test_suite(h_rpm_tests);
+}
@@ -0,0 +1,191 @@
+/**
+ * @file
+ * @brief Unit test for the Who-Is service handler and I-Am pacing
+ * @author agent <agent@local>
+ * @date October 2026
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <string.h>
+#include <zephyr/ztest.h>
+#include <bacnet/whois.h>
+#include <bacnet/basic/object/device.h>
+#include <bacnet/basic/services.h>
+#include <bacnet/basic/tsm/tsm.h>
+
+/**
+ * @addtogroup bacnet_tests
+ * @{
+ */
+
+uint8_t Handler_Transmit_Buffer[MAX_PDU];
+/* the I-Am sent by the handler */
+static unsigned Test_Broadcast_Count;
+static unsigned Test_Unicast_Count;
+static BACNET_ADDRESS Test_Unicast_Dest;
+
+void Send_I_Am(uint8_t *buffer)
+{
+    (void)buffer;
+    Test_Broadcast_Count++;
+}
+
+void Send_I_Am_Unicast(uint8_t *buffer, const BACNET_ADDRESS *src)
+{
+    (void)buffer;
+    bacnet_address_copy(&Test_Unicast_Dest, src);
+    Test_Unicast_Count++;
+}
+
+uint32_t Device_Object_Instance_Number(void)
+{
+    return 1234;
+}
+
+static void test_reset(void)
+{
+    Test_Broadcast_Count = 0;
+    Test_Unicast_Count = 0;
+    memset(&Test_Unicast_Dest, 0, sizeof(Test_Unicast_Dest));
+}
+
+static void test_address_init(BACNET_ADDRESS *src, uint8_t mac)
+{
+    memset(src, 0, sizeof(*src));
+    src->mac_len = 1;
+    src->mac[0] = mac;
+}
+
+/**
+ * @brief Test the replies to Who-Is without pacing
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(h_whois_tests, testWhoIs)
+#else
+static void testWhoIs(void)
+#endif
+{
+    uint8_t apdu[MAX_APDU] = { 0 };
+    BACNET_ADDRESS src;
+    int len;
+
+    test_reset();
+    test_address_init(&src, 1);
+    handler_who_is_pacing_set(0, 0, 0);
+    handler_who_is(NULL, 0, &src);
+    zassert_equal(Test_Broadcast_Count, 1, NULL);
+    /* the Who-Is service request follows the 2 octet APDU header */
+    len = whois_encode_apdu(apdu, 1000, 2000);
+    handler_who_is(&apdu[2], (uint16_t)(len - 2), &src);
+    zassert_equal(Test_Broadcast_Count, 2, NULL);
+    len = whois_encode_apdu(apdu, 2000, 3000);
+    handler_who_is(&apdu[2], (uint16_t)(len - 2), &src);
+    zassert_equal(Test_Broadcast_Count, 2, NULL);
+    handler_who_is_unicast(NULL, 0, &src);
+    zassert_equal(Test_Unicast_Count, 1, NULL);
+    zassert_true(bacnet_address_same(&Test_Unicast_Dest, &src), NULL);
+    zassert_equal(handler_who_is_pacing_pending(), 0, NULL);
+}
+
+/**
+ * @brief Test the pacing, coalescing, and window of the I-Am replies
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(h_whois_tests, testWhoIsPacing)
+#else
+static void testWhoIsPacing(void)
+#endif
+{
+    BACNET_ADDRESS src;
+    unsigned i;
+
+    test_reset();
+    zassert_true(handler_who_is_pacing_size_set(8), NULL);
+    /* 10 I-Am per second, no jitter, and a 1 second window */
+    handler_who_is_pacing_set(10, 0, 1000);
+    test_address_init(&src, 1);
+    /* the same reply is only queued once */
+    handler_who_is(NULL, 0, &src);
+    handler_who_is(NULL, 0, &src);
+    zassert_equal(handler_who_is_pacing_pending(), 1, NULL);
+    zassert_equal(Test_Broadcast_Count, 0, NULL);
+    handler_who_is_pacing_timer(1);
+    zassert_equal(Test_Broadcast_Count, 1, NULL);
+    zassert_equal(handler_who_is_pacing_pending(), 0, NULL);
+    /* and is not sent again within the window */
+    handler_who_is(NULL, 0, &src);
+    zassert_equal(handler_who_is_pacing_pending(), 0, NULL);
+    handler_who_is_pacing_timer(999);
+    zassert_equal(Test_Broadcast_Count, 1, NULL);
+    handler_who_is_pacing_timer(1);
+    handler_who_is(NULL, 0, &src);
+    zassert_equal(handler_who_is_pacing_pending(), 1, NULL);
+    handler_who_is_pacing_timer(1);
+    zassert_equal(Test_Broadcast_Count, 2, NULL);
+    /* replies to different requesters are sent at the paced rate */
+    handler_who_is_pacing_timer(1000);
+    for (i = 0; i < 5; i++) {
+        test_address_init(&src, (uint8_t)(10 + i));
+        handler_who_is_unicast(NULL, 0, &src);
+    }
+    zassert_equal(handler_who_is_pacing_pending(), 5, NULL);
+    handler_who_is_pacing_timer(1);
+    zassert_equal(Test_Unicast_Count, 1, NULL);
+    handler_who_is_pacing_timer(50);
+    zassert_equal(Test_Unicast_Count, 1, NULL);
+    handler_who_is_pacing_timer(50);
+    zassert_equal(Test_Unicast_Count, 2, NULL);
+    handler_who_is_pacing_timer(300);
+    zassert_equal(Test_Unicast_Count, 5, NULL);
+    zassert_equal(handler_who_is_pacing_pending(), 0, NULL);
+    test_address_init(&src, 14);
+    zassert_true(bacnet_address_same(&Test_Unicast_Dest, &src), NULL);
+    handler_who_is_pacing_set(0, 0, 0);
+    zassert_true(handler_who_is_pacing_size_set(32), NULL);
+}
+
+/**
+ * @brief Test that a reply is sent at once when the pacing queue is full
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(h_whois_tests, testWhoIsPacingFull)
+#else
+static void testWhoIsPacingFull(void)
+#endif
+{
+    BACNET_ADDRESS src;
+    unsigned i;
+
+    test_reset();
+    zassert_true(handler_who_is_pacing_size_set(2), NULL);
+    handler_who_is_pacing_set(1, 0, 0);
+    for (i = 0; i < 3; i++) {
+        test_address_init(&src, (uint8_t)(20 + i));
+        handler_who_is_unicast(NULL, 0, &src);
+    }
+    zassert_equal(handler_who_is_pacing_pending(), 2, NULL);
+    zassert_equal(Test_Unicast_Count, 1, NULL);
+    zassert_true(bacnet_address_same(&Test_Unicast_Dest, &src), NULL);
+    /* turning the pacing off sends the rest */
+    handler_who_is_pacing_set(0, 0, 0);
+    handler_who_is_pacing_timer(1);
+    zassert_equal(Test_Unicast_Count, 3, NULL);
+    zassert_equal(handler_who_is_pacing_pending(), 0, NULL);
+    zassert_true(handler_who_is_pacing_size_set(32), NULL);
+}
+/**
+ * @}
+ */
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST_SUITE(h_whois_tests, NULL, NULL, NULL, NULL, NULL);
+#else
+void test_main(void)
+{
+    ztest_test_suite(
+        h_whois_tests, ztest_unit_test(testWhoIs),
+        ztest_unit_test(testWhoIsPacing),
+        ztest_unit_test(testWhoIsPacingFull));
+
+    ztest_run_test_suite(h_whois_tests);
+}
+#endif
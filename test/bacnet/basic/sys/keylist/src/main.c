@@ -314,6 +314,100 @@ static void testKeyListLarge(void)
     return;
 }
 
+/* test the sort order when keys are added and deleted out of order */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(keylist_tests, testKeyListOrder)
+#else
+static void testKeyListOrder(void)
+#endif
+{
+    bool status = false;
+    int data_list[1024] = { 0 };
+    int *data;
+    OS_Keylist list;
+    KEY key;
+    KEY last_key;
+    int index;
+    const unsigned num_keys = 1024;
+    unsigned i;
+
+    list = Keylist_Create();
+    zassert_not_null(list, NULL);
+    /* descending, then a stride through the remaining keys */
+    for (i = 0; i < num_keys; i += 2) {
+        key = num_keys - 2 - i;
+        data_list[key] = 42 + key;
+        index = Keylist_Data_Add(list, key, &data_list[key]);
+        zassert_equal(index, 0, NULL);
+    }
+    for (i = 0; i < num_keys / 2; i++) {
+        key = ((i * 7) % (num_keys / 2)) * 2 + 1;
+        data_list[key] = 42 + key;
+        index = Keylist_Data_Add(list, key, &data_list[key]);
+        zassert_equal(Keylist_Index(list, key), index, NULL);
+    }
+    zassert_equal(Keylist_Count(list), num_keys, NULL);
+    for (index = 0; index < num_keys; index++) {
+        status = Keylist_Index_Key(list, index, &key);
+        zassert_true(status, NULL);
+        zassert_equal(key, index, NULL);
+        data = Keylist_Data_Index(list, index);
+        zassert_equal(*data, data_list[key], NULL);
+    }
+    /* delete the odd keys, and the list shrinks but stays sorted */
+    for (key = 1; key < num_keys; key += 2) {
+        data = Keylist_Data_Delete(list, key);
+        zassert_not_null(data, NULL);
+        zassert_equal(*data, data_list[key], NULL);
+    }
+    zassert_equal(Keylist_Count(list), num_keys / 2, NULL);
+    last_key = 0;
+    for (index = 0; index < Keylist_Count(list); index++) {
+        status = Keylist_Index_Key(list, index, &key);
+        zassert_true(status, NULL);
+        zassert_equal(key % 2, 0, NULL);
+        if (index > 0) {
+            zassert_true(key > last_key, NULL);
+        }
+        last_key = key;
+    }
+    zassert_equal(Keylist_Next_Empty_Key(list, 0), 1, NULL);
+    Keylist_Delete(list);
+
+    return;
+}
+
+/* test finding the first key at or after a key */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(keylist_tests, testKeyListIndexNext)
+#else
+static void testKeyListIndexNext(void)
+#endif
+{
+    OS_Keylist list;
+    KEY key;
+    int index;
+    int data = 42;
+    const KEY num_keys = 100;
+
+    list = Keylist_Create();
+    zassert_not_null(list, NULL);
+    zassert_equal(Keylist_Index_Next(list, 0), -1, NULL);
+    /* keys 10, 20, ... 100 */
+    for (key = num_keys; key > 0; key -= 10) {
+        index = Keylist_Data_Add(list, key, &data);
+        zassert_true(index >= 0, NULL);
+    }
+    for (key = 0; key <= num_keys; key++) {
+        index = Keylist_Index_Next(list, key);
+        zassert_equal(index, (key == 0) ? 0 : ((key - 1) / 10), NULL);
+    }
+    zassert_equal(Keylist_Index_Next(list, num_keys + 1), -1, NULL);
+    Keylist_Delete(list);
+
+    return;
+}
+
 /* test the encode and decode macros */
 #if defined(CONFIG_ZTEST_NEW_API)
 ZTEST(keylist_tests, testKeySample)
@@ -359,7 +453,8 @@ void test_main(void)
         keylist_tests, ztest_unit_test(testKeyListFIFO),
         ztest_unit_test(testKeyListFILO), ztest_unit_test(testKeyListDataKey),
         ztest_unit_test(testKeyListDataIndex),
-        ztest_unit_test(testKeyListLarge), ztest_unit_test(testKeySample));
+        ztest_unit_test(testKeyListLarge), ztest_unit_test(testKeyListOrder),
+        ztest_unit_test(testKeyListIndexNext), ztest_unit_test(testKeySample));
 
     ztest_run_test_suite(keylist_tests);
 }
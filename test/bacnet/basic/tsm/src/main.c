@@ -0,0 +1,547 @@
+/**
+ * @file
+ * @brief Unit test for the BACnet Transaction State Machine segmentation
+ * @author agent <agent@local>
+ * @date October 2026
+ * @copyright SPDX-License-Identifier: MIT
+ */
+#include <string.h>
+#include <zephyr/ztest.h>
+#include <bacnet/bacaddr.h>
+#include <bacnet/bacdcode.h>
+#include <bacnet/npdu.h>
+#include <bacnet/basic/services.h>
+#include <bacnet/basic/tsm/tsm.h>
+#include <bacnet/datalink/datalink.h>
+
+/**
+ * @addtogroup bacnet_tests
+ * @{
+ */
+
+/* the most recent PDU sent by the TSM */
+static uint8_t Test_Sent_PDU[MAX_PDU];
+static unsigned Test_Sent_PDU_Len;
+static unsigned Test_Sent_Count;
+
+int bip_send_pdu(
+    BACNET_ADDRESS *dest,
+    BACNET_NPDU_DATA *npdu_data,
+    uint8_t *pdu,
+    unsigned pdu_len)
+{
+    (void)dest;
+    (void)npdu_data;
+    if (pdu_len <= sizeof(Test_Sent_PDU)) {
+        memcpy(Test_Sent_PDU, pdu, pdu_len);
+        Test_Sent_PDU_Len = pdu_len;
+    }
+    Test_Sent_Count++;
+
+    return (int)pdu_len;
+}
+
+void bip_get_my_address(BACNET_ADDRESS *my_address)
+{
+    if (my_address) {
+        memset(my_address, 0, sizeof(*my_address));
+        my_address->mac_len = 6;
+        my_address->mac[0] = 192;
+        my_address->mac[1] = 168;
+        my_address->mac[2] = 0;
+        my_address->mac[3] = 1;
+        my_address->mac[4] = 0xBA;
+        my_address->mac[5] = 0xC0;
+    }
+}
+
+/**
+ * @brief Get the APDU portion of the most recent PDU that was sent
+ * @return pointer to the APDU, and apdu_len is set to its length
+ */
+static uint8_t *test_sent_apdu(unsigned *apdu_len)
+{
+    BACNET_ADDRESS dest = { 0 };
+    BACNET_ADDRESS src = { 0 };
+    BACNET_NPDU_DATA npdu_data = { 0 };
+    int npdu_len = 0;
+
+    npdu_len = bacnet_npdu_decode(
+        Test_Sent_PDU, Test_Sent_PDU_Len, &dest, &src, &npdu_data);
+    zassert_true(npdu_len > 0, NULL);
+    *apdu_len = Test_Sent_PDU_Len - (unsigned)npdu_len;
+
+    return &Test_Sent_PDU[npdu_len];
+}
+
+/**
+ * @brief Encode a Complex-ACK with a recognizable service ACK payload
+ * @return number of octets in the Complex-ACK
+ */
+static uint16_t test_complex_ack_encode(
+    uint8_t *apdu, uint8_t invoke_id, uint16_t service_len)
+{
+    uint16_t i;
+
+    apdu[0] = PDU_TYPE_COMPLEX_ACK;
+    apdu[1] = invoke_id;
+    apdu[2] = SERVICE_CONFIRMED_READ_PROP_MULTIPLE;
+    for (i = 0; i < service_len; i++) {
+        apdu[3 + i] = (uint8_t)i;
+    }
+
+    return 3 + service_len;
+}
+
+static void test_service_data_init(
+    BACNET_CONFIRMED_SERVICE_DATA *service_data,
+    uint8_t invoke_id,
+    bool segmented_response_accepted)
+{
+    memset(service_data, 0, sizeof(*service_data));
+    service_data->invoke_id = invoke_id;
+    service_data->max_resp = MAX_APDU;
+    service_data->max_segs = 64;
+    service_data->segmented_response_accepted = segmented_response_accepted;
+}
+
+static void test_address_init(BACNET_ADDRESS *src, uint8_t station)
+{
+    memset(src, 0, sizeof(*src));
+    src->mac_len = 1;
+    src->mac[0] = station;
+}
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(tsm_tests, testSegmentedResponse)
+#else
+static void testSegmentedResponse(void)
+#endif
+{
+    BACNET_CONFIRMED_SERVICE_DATA service_data;
+    BACNET_NPDU_DATA npdu_data = { 0 };
+    BACNET_ADDRESS src;
+    uint8_t *apdu = Handler_Segmented_Buffer;
+    uint8_t *segment;
+    uint16_t apdu_len, segment_len;
+    unsigned sent_len = 0;
+    uint8_t invoke_id = 42;
+    int bytes_sent;
+
+    test_address_init(&src, 1);
+    npdu_encode_npdu_data(&npdu_data, false, MESSAGE_PRIORITY_NORMAL);
+    test_service_data_init(&service_data, invoke_id, true);
+    segment_len = MAX_APDU - 5;
+    zassert_equal(
+        tsm_segmented_response_apdu_max(&service_data),
+        3 + (BACNET_SEGMENTATION_MAX_SEGMENTS * segment_len), NULL);
+    /* five segments, the last one partly filled */
+    apdu_len = test_complex_ack_encode(apdu, invoke_id, (4 * segment_len) + 7);
+    Test_Sent_Count = 0;
+    bytes_sent = tsm_confirmed_reply_send(
+        &src, &npdu_data, &service_data, apdu, apdu_len);
+    zassert_true(bytes_sent > 0, NULL);
+    zassert_equal(tsm_segmented_response_count(), 1, NULL);
+    /* only the first segment until the client tells us its window */
+    zassert_equal(Test_Sent_Count, 1, NULL);
+    segment = test_sent_apdu(&sent_len);
+    zassert_equal(segment[0], PDU_TYPE_COMPLEX_ACK | BIT(3) | BIT(2), NULL);
+    zassert_equal(segment[1], invoke_id, NULL);
+    zassert_equal(segment[2], 0, NULL);
+    zassert_equal(segment[3], apdu_segment_window_size(), NULL);
+    zassert_equal(segment[4], SERVICE_CONFIRMED_READ_PROP_MULTIPLE, NULL);
+    zassert_equal(sent_len, MAX_APDU, NULL);
+    zassert_equal(memcmp(&segment[5], &apdu[3], segment_len), 0, NULL);
+    /* a Segment-ACK from someone else is ignored */
+    test_address_init(&src, 2);
+    tsm_segment_ack_handler(&src, invoke_id, 0, 3, false, false);
+    zassert_equal(Test_Sent_Count, 1, NULL);
+    test_address_init(&src, 1);
+    /* the window of three segments follows the Segment-ACK */
+    tsm_segment_ack_handler(&src, invoke_id, 0, 3, false, false);
+    zassert_equal(Test_Sent_Count, 4, NULL);
+    segment = test_sent_apdu(&sent_len);
+    zassert_equal(segment[2], 3, NULL);
+    zassert_equal(
+        memcmp(&segment[5], &apdu[3 + (3 * segment_len)], segment_len), 0,
+        NULL);
+    /* a duplicate Segment-ACK does not send anything */
+    tsm_segment_ack_handler(&src, invoke_id, 0, 3, false, false);
+    zassert_equal(Test_Sent_Count, 4, NULL);
+    /* the final segment has no more-follows and the remaining data */
+    tsm_segment_ack_handler(&src, invoke_id, 3, 3, false, false);
+    zassert_equal(Test_Sent_Count, 5, NULL);
+    segment = test_sent_apdu(&sent_len);
+    zassert_equal(segment[0], PDU_TYPE_COMPLEX_ACK | BIT(3), NULL);
+    zassert_equal(segment[2], 4, NULL);
+    zassert_equal(sent_len, 5 + 7, NULL);
+    zassert_equal(
+        memcmp(&segment[5], &apdu[3 + (4 * segment_len)], 7), 0, NULL);
+    zassert_equal(tsm_segmented_response_count(), 1, NULL);
+    /* the final Segment-ACK ends the transaction */
+    tsm_segment_ack_handler(&src, invoke_id, 4, 3, false, false);
+    zassert_equal(tsm_segmented_response_count(), 0, NULL);
+    zassert_equal(Test_Sent_Count, 5, NULL);
+}
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(tsm_tests, testSegmentedResponseRetry)
+#else
+static void testSegmentedResponseRetry(void)
+#endif
+{
+    BACNET_CONFIRMED_SERVICE_DATA service_data;
+    BACNET_NPDU_DATA npdu_data = { 0 };
+    BACNET_ADDRESS src;
+    uint8_t *apdu = Handler_Segmented_Buffer;
+    uint16_t apdu_len;
+    unsigned i;
+
+    test_address_init(&src, 3);
+    npdu_encode_npdu_data(&npdu_data, false, MESSAGE_PRIORITY_NORMAL);
+    test_service_data_init(&service_data, 7, true);
+    apdu_len = test_complex_ack_encode(apdu, 7, MAX_APDU);
+    Test_Sent_Count = 0;
+    tsm_confirmed_reply_send(&src, &npdu_data, &service_data, apdu, apdu_len);
+    zassert_equal(Test_Sent_Count, 1, NULL);
+    /* the segment is resent after each segment timeout */
+    for (i = 0; i < apdu_retries(); i++) {
+        tsm_timer_milliseconds(apdu_segment_timeout());
+        zassert_equal(Test_Sent_Count, 2 + i, NULL);
+    }
+    /* then the transaction is abandoned */
+    tsm_timer_milliseconds(apdu_segment_timeout());
+    zassert_equal(tsm_segmented_response_count(), 0, NULL);
+    zassert_equal(Test_Sent_Count, 1 + apdu_retries(), NULL);
+    /* an Abort from the client also ends the transaction */
+    tsm_confirmed_reply_send(&src, &npdu_data, &service_data, apdu, apdu_len);
+    zassert_equal(tsm_segmented_response_count(), 1, NULL);
+    tsm_segmented_response_abort(&src, 7);
+    zassert_equal(tsm_segmented_response_count(), 0, NULL);
+}
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(tsm_tests, testSegmentedResponseRefused)
+#else
+static void testSegmentedResponseRefused(void)
+#endif
+{
+    BACNET_CONFIRMED_SERVICE_DATA service_data;
+    BACNET_NPDU_DATA npdu_data = { 0 };
+    BACNET_ADDRESS src;
+    uint8_t *apdu = Handler_Segmented_Buffer;
+    uint8_t *reply;
+    uint16_t apdu_len;
+    unsigned sent_len = 0;
+    unsigned i;
+
+    test_address_init(&src, 4);
+    npdu_encode_npdu_data(&npdu_data, false, MESSAGE_PRIORITY_NORMAL);
+    /* small replies are sent as they are */
+    test_service_data_init(&service_data, 1, false);
+    apdu_len = test_complex_ack_encode(apdu, 1, 10);
+    tsm_confirmed_reply_send(&src, &npdu_data, &service_data, apdu, apdu_len);
+    reply = test_sent_apdu(&sent_len);
+    zassert_equal(sent_len, apdu_len, NULL);
+    zassert_equal(memcmp(reply, apdu, apdu_len), 0, NULL);
+    /* the client did not accept a segmented response */
+    zassert_equal(
+        tsm_segmented_response_apdu_max(&service_data), MAX_APDU, NULL);
+    apdu_len = test_complex_ack_encode(apdu, 1, MAX_APDU);
+    tsm_confirmed_reply_send(&src, &npdu_data, &service_data, apdu, apdu_len);
+    reply = test_sent_apdu(&sent_len);
+    zassert_equal(reply[0], PDU_TYPE_ABORT | 1, NULL);
+    zassert_equal(reply[2], ABORT_REASON_SEGMENTATION_NOT_SUPPORTED, NULL);
+    zassert_equal(tsm_segmented_response_count(), 0, NULL);
+    /* the client accepts fewer segments than needed */
+    test_service_data_init(&service_data, 1, true);
+    service_data.max_segs = 2;
+    apdu_len = test_complex_ack_encode(apdu, 1, 3 * (MAX_APDU - 5));
+    tsm_confirmed_reply_send(&src, &npdu_data, &service_data, apdu, apdu_len);
+    reply = test_sent_apdu(&sent_len);
+    zassert_equal(reply[0], PDU_TYPE_ABORT | 1, NULL);
+    zassert_equal(reply[2], ABORT_REASON_BUFFER_OVERFLOW, NULL);
+    /* all the segmented transactions are busy */
+    service_data.max_segs = 0;
+    for (i = 0; i < BACNET_SEGMENTATION_TRANSACTIONS; i++) {
+        service_data.invoke_id = 10 + i;
+        apdu_len = test_complex_ack_encode(apdu, 10 + i, MAX_APDU);
+        tsm_confirmed_reply_send(
+            &src, &npdu_data, &service_data, apdu, apdu_len);
+    }
+    zassert_equal(
+        tsm_segmented_response_count(), BACNET_SEGMENTATION_TRANSACTIONS,
+        NULL);
+    service_data.invoke_id = 20;
+    apdu_len = test_complex_ack_encode(apdu, 20, MAX_APDU);
+    tsm_confirmed_reply_send(&src, &npdu_data, &service_data, apdu, apdu_len);
+    reply = test_sent_apdu(&sent_len);
+    zassert_equal(reply[0], PDU_TYPE_ABORT | 1, NULL);
+    zassert_equal(reply[2], ABORT_REASON_OUT_OF_RESOURCES, NULL);
+    for (i = 0; i < BACNET_SEGMENTATION_TRANSACTIONS; i++) {
+        tsm_segmented_response_abort(&src, 10 + i);
+    }
+    zassert_equal(tsm_segmented_response_count(), 0, NULL);
+}
+/* the most recent Complex-ACK given to the service ACK handler */
+static uint8_t Test_Complex_ACK[BACNET_SEGMENTATION_APDU_MAX];
+static uint16_t Test_Complex_ACK_Len;
+static unsigned Test_Complex_ACK_Count;
+
+static void test_complex_ack_handler(
+    uint8_t *service_request,
+    uint16_t service_len,
+    BACNET_ADDRESS *src,
+    BACNET_CONFIRMED_SERVICE_ACK_DATA *service_data)
+{
+    (void)src;
+    (void)service_data;
+    memcpy(Test_Complex_ACK, service_request, service_len);
+    Test_Complex_ACK_Len = service_len;
+    Test_Complex_ACK_Count++;
+}
+
+/**
+ * @brief Send one segment of a Complex-ACK from a server to apdu_handler()
+ */
+static void test_complex_ack_segment(
+    BACNET_ADDRESS *src,
+    uint8_t invoke_id,
+    uint8_t sequence_number,
+    bool more_follows,
+    uint16_t segment_len)
+{
+    uint8_t apdu[MAX_APDU] = { 0 };
+    uint16_t i;
+
+    apdu[0] = PDU_TYPE_COMPLEX_ACK | BIT(3);
+    if (more_follows) {
+        apdu[0] |= BIT(2);
+    }
+    apdu[1] = invoke_id;
+    apdu[2] = sequence_number;
+    apdu[3] = 16;
+    apdu[4] = SERVICE_CONFIRMED_READ_PROPERTY;
+    for (i = 0; i < segment_len; i++) {
+        apdu[5 + i] = sequence_number;
+    }
+    apdu_handler(src, apdu, 5 + segment_len);
+}
+
+/**
+ * @brief Start a confirmed request from us to the server
+ * @return invoke ID of the request
+ */
+static uint8_t test_confirmed_request(BACNET_ADDRESS *dest)
+{
+    BACNET_NPDU_DATA npdu_data = { 0 };
+    uint8_t apdu[4] = { PDU_TYPE_CONFIRMED_SERVICE_REQUEST, 0x05, 0,
+                        SERVICE_CONFIRMED_READ_PROPERTY };
+    uint8_t invoke_id;
+
+    invoke_id = tsm_next_free_invokeID(dest);
+    zassert_not_equal(invoke_id, 0, NULL);
+    apdu[2] = invoke_id;
+    tsm_confirmed_request_segmentation_set(apdu, sizeof(apdu));
+    zassert_equal(apdu[0], PDU_TYPE_CONFIRMED_SERVICE_REQUEST | BIT(1), NULL);
+    zassert_equal(
+        decode_max_segs(apdu[1]), BACNET_SEGMENTATION_MAX_SEGMENTS, NULL);
+    zassert_equal(decode_max_apdu(apdu[1]), MAX_APDU, NULL);
+    npdu_encode_npdu_data(&npdu_data, true, MESSAGE_PRIORITY_NORMAL);
+    tsm_set_confirmed_unsegmented_transaction(
+        invoke_id, dest, &npdu_data, apdu, sizeof(apdu));
+
+    return invoke_id;
+}
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(tsm_tests, testSegmentedComplexACK)
+#else
+static void testSegmentedComplexACK(void)
+#endif
+{
+    BACNET_ADDRESS src;
+    uint8_t *segment_ack;
+    unsigned sent_len = 0;
+    uint8_t invoke_id;
+    uint16_t i;
+
+    test_address_init(&src, 5);
+    apdu_set_confirmed_ack_handler(
+        SERVICE_CONFIRMED_READ_PROPERTY, test_complex_ack_handler);
+    apdu_segment_window_size_set(2);
+    invoke_id = test_confirmed_request(&src);
+    Test_Sent_Count = 0;
+    Test_Complex_ACK_Count = 0;
+    /* the first segment is acknowledged with our window size */
+    test_complex_ack_segment(&src, invoke_id, 0, true, 100);
+    zassert_equal(tsm_segmented_confirmation_count(), 1, NULL);
+    zassert_equal(Test_Sent_Count, 1, NULL);
+    segment_ack = test_sent_apdu(&sent_len);
+    zassert_equal(sent_len, 4, NULL);
+    zassert_equal(segment_ack[0], PDU_TYPE_SEGMENT_ACK, NULL);
+    zassert_equal(segment_ack[1], invoke_id, NULL);
+    zassert_equal(segment_ack[2], 0, NULL);
+    zassert_equal(segment_ack[3], 2, NULL);
+    /* the request is no longer waiting for a confirmation */
+    tsm_timer_milliseconds(apdu_timeout());
+    zassert_equal(Test_Sent_Count, 1, NULL);
+    zassert_false(tsm_invoke_id_failed(&src, invoke_id), NULL);
+    /* the last segment of the window is acknowledged */
+    test_complex_ack_segment(&src, invoke_id, 1, true, 100);
+    zassert_equal(Test_Sent_Count, 1, NULL);
+    test_complex_ack_segment(&src, invoke_id, 2, true, 100);
+    zassert_equal(Test_Sent_Count, 2, NULL);
+    segment_ack = test_sent_apdu(&sent_len);
+    zassert_equal(segment_ack[0], PDU_TYPE_SEGMENT_ACK, NULL);
+    zassert_equal(segment_ack[2], 2, NULL);
+    /* a duplicate segment is discarded without a reply */
+    test_complex_ack_segment(&src, invoke_id, 2, true, 100);
+    test_complex_ack_segment(&src, invoke_id, 1, true, 100);
+    zassert_equal(Test_Sent_Count, 2, NULL);
+    /* a missing segment asks for the segments after the last one */
+    test_complex_ack_segment(&src, invoke_id, 4, false, 10);
+    zassert_equal(Test_Sent_Count, 3, NULL);
+    segment_ack = test_sent_apdu(&sent_len);
+    zassert_equal(segment_ack[0], PDU_TYPE_SEGMENT_ACK | BIT(1), NULL);
+    zassert_equal(segment_ack[2], 2, NULL);
+    zassert_equal(Test_Complex_ACK_Count, 0, NULL);
+    /* the final segment delivers the whole Complex-ACK */
+    test_complex_ack_segment(&src, invoke_id, 3, true, 100);
+    test_complex_ack_segment(&src, invoke_id, 4, false, 10);
+    segment_ack = test_sent_apdu(&sent_len);
+    zassert_equal(segment_ack[0], PDU_TYPE_SEGMENT_ACK, NULL);
+    zassert_equal(segment_ack[2], 4, NULL);
+    zassert_equal(Test_Complex_ACK_Count, 1, NULL);
+    zassert_equal(Test_Complex_ACK_Len, (4 * 100) + 10, NULL);
+    for (i = 0; i < Test_Complex_ACK_Len; i++) {
+        zassert_equal(Test_Complex_ACK[i], i / 100, NULL);
+    }
+    zassert_equal(tsm_segmented_confirmation_count(), 0, NULL);
+    zassert_true(tsm_invoke_id_free(&src, invoke_id), NULL);
+    /* the server stops sending segments */
+    invoke_id = test_confirmed_request(&src);
+    test_complex_ack_segment(&src, invoke_id, 0, true, 100);
+    zassert_equal(tsm_segmented_confirmation_count(), 1, NULL);
+    for (i = 0; i < 4; i++) {
+        tsm_timer_milliseconds(apdu_segment_timeout());
+    }
+    zassert_equal(tsm_segmented_confirmation_count(), 0, NULL);
+    zassert_true(tsm_invoke_id_failed(&src, invoke_id), NULL);
+    tsm_free_invoke_id(&src, invoke_id);
+    /* segments from a server that we did not ask are ignored */
+    Test_Sent_Count = 0;
+    test_complex_ack_segment(&src, 99, 0, true, 100);
+    zassert_equal(tsm_segmented_confirmation_count(), 0, NULL);
+    zassert_equal(Test_Sent_Count, 0, NULL);
+    apdu_segment_window_size_set(BACNET_SEGMENTATION_WINDOW_SIZE);
+}
+/* the most recent transaction that timed out */
+static BACNET_ADDRESS Test_Timeout_Address;
+static uint8_t Test_Timeout_Invoke_ID;
+
+static void test_timeout_handler(const BACNET_ADDRESS *dest, uint8_t invoke_id)
+{
+    bacnet_address_copy(&Test_Timeout_Address, dest);
+    Test_Timeout_Invoke_ID = invoke_id;
+}
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(tsm_tests, testTransactions)
+#else
+static void testTransactions(void)
+#endif
+{
+    BACNET_ADDRESS peer;
+    BACNET_ADDRESS other;
+    BACNET_NPDU_DATA npdu_data;
+    uint8_t apdu[3];
+    uint8_t *pdu;
+    unsigned i;
+    uint8_t invoke_id;
+
+    test_address_init(&peer, 1);
+    test_address_init(&other, 2);
+    zassert_false(tsm_transaction_size_set(0), NULL);
+    zassert_true(tsm_transaction_size_set(300), NULL);
+    zassert_equal(tsm_transaction_size(), 300, NULL);
+    zassert_equal(tsm_transaction_idle_count(), 300, NULL);
+    /* each peer has its own invoke IDs */
+    tsm_invokeID_set(1);
+    for (i = 0; i < 255; i++) {
+        zassert_equal(tsm_next_free_invokeID(&peer), (uint8_t)(i + 1), NULL);
+    }
+    zassert_equal(tsm_next_free_invokeID(&peer), 0, NULL);
+    for (i = 0; i < 45; i++) {
+        zassert_equal(tsm_next_free_invokeID(&other), (uint8_t)(i + 1), NULL);
+    }
+    zassert_equal(tsm_transaction_idle_count(), 0, NULL);
+    zassert_equal(tsm_next_free_invokeID(&other), 0, NULL);
+    zassert_false(tsm_transaction_size_set(MAX_TSM_TRANSACTIONS), NULL);
+    /* nothing is timing until a request is sent */
+    zassert_false(tsm_timer_active(), NULL);
+    /* a reply frees the transaction of that peer only */
+    apdu[0] = PDU_TYPE_SIMPLE_ACK;
+    apdu[1] = 5;
+    apdu[2] = SERVICE_CONFIRMED_WRITE_PROPERTY;
+    zassert_false(tsm_invoke_id_free(&peer, 5), NULL);
+    apdu_handler(&peer, apdu, sizeof(apdu));
+    zassert_true(tsm_invoke_id_free(&peer, 5), NULL);
+    zassert_false(tsm_invoke_id_free(&other, 5), NULL);
+    zassert_equal(tsm_next_free_invokeID(&peer), 5, NULL);
+    /* a request encoded in the transaction is sent again as is */
+    pdu = tsm_transaction_pdu_buffer(&peer, 7);
+    zassert_not_null(pdu, NULL);
+    zassert_not_equal(pdu, tsm_transaction_pdu_buffer(&other, 7), NULL);
+    npdu_encode_npdu_data(&npdu_data, true, MESSAGE_PRIORITY_NORMAL);
+    for (i = 0; i < 20; i++) {
+        pdu[i] = (uint8_t)(i + 1);
+    }
+    tsm_set_confirmed_unsegmented_transaction(7, &peer, &npdu_data, pdu, 20);
+    zassert_true(tsm_timer_active(), NULL);
+    Test_Sent_Count = 0;
+    Test_Sent_PDU_Len = 0;
+    tsm_timer_milliseconds(apdu_timeout());
+    zassert_equal(Test_Sent_Count, 1, NULL);
+    zassert_equal(Test_Sent_PDU_Len, 20, NULL);
+    zassert_mem_equal(Test_Sent_PDU, pdu, 20, NULL);
+    zassert_false(tsm_invoke_id_failed(&peer, 7), NULL);
+    /* the timeout handler is told which peer did not confirm */
+    tsm_set_timeout_handler(test_timeout_handler);
+    Test_Timeout_Invoke_ID = 0;
+    for (i = 0; i < apdu_retries(); i++) {
+        tsm_timer_milliseconds(apdu_timeout());
+    }
+    tsm_set_timeout_handler(NULL);
+    zassert_equal(Test_Timeout_Invoke_ID, 7, NULL);
+    zassert_true(bacnet_address_same(&Test_Timeout_Address, &peer), NULL);
+    zassert_true(tsm_invoke_id_failed(&peer, 7), NULL);
+    zassert_false(tsm_timer_active(), NULL);
+    for (i = 1; i < 256; i++) {
+        invoke_id = (uint8_t)i;
+        tsm_free_invoke_id(&peer, invoke_id);
+        tsm_free_invoke_id(&other, invoke_id);
+    }
+    zassert_equal(tsm_transaction_idle_count(), 300, NULL);
+    zassert_true(tsm_transaction_size_set(MAX_TSM_TRANSACTIONS), NULL);
+    zassert_not_equal(tsm_next_free_invokeID(&peer), 0, NULL);
+}
+/**
+ * @}
+ */
+
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST_SUITE(tsm_tests, NULL, NULL, NULL, NULL, NULL);
+#else
+void test_main(void)
+{
+    ztest_test_suite(
+        tsm_tests, ztest_unit_test(testSegmentedResponse),
+        ztest_unit_test(testSegmentedResponseRetry),
+        ztest_unit_test(testSegmentedResponseRefused),
+        ztest_unit_test(testSegmentedComplexACK),
+        ztest_unit_test(testTransactions));
+
+    ztest_run_test_suite(tsm_tests);
+}
+#endif
@@ -191,12 +191,25 @@ static void testUCOVNotifyData(const BACNET_COV_DATA *data)
     int len = 0, null_len = 0, apdu_len = 0;
     BACNET_COV_DATA test_data = { 0 };
     BACNET_PROPERTY_VALUE value_list[5] = { { 0 } };
+    uint8_t values[480] = { 0 };
+    uint8_t test_apdu[480] = { 0 };
+    int values_len = 0;
 
     null_len = ucov_notify_encode_apdu(NULL, sizeof(apdu), data);
     len = ucov_notify_encode_apdu(&apdu[0], sizeof(apdu), data);
     zassert_true(len > 0, NULL);
     zassert_equal(len, null_len, NULL);
     apdu_len = len;
+    /* the same notification from a list of values encoded once */
+    values_len = cov_notify_values_encode(&values[0], data->listOfValues);
+    zassert_true(values_len > 0, NULL);
+    len = ucov_notify_encode_apdu_values(
+        &test_apdu[0], sizeof(test_apdu), data, &values[0], values_len);
+    zassert_equal(len, apdu_len, NULL);
+    zassert_mem_equal(&test_apdu[0], &apdu[0], apdu_len, NULL);
+    len = ucov_notify_encode_apdu_values(
+        &test_apdu[0], apdu_len - 1, data, &values[0], values_len);
+    zassert_equal(len, 0, NULL);
 
     cov_data_value_list_link(
         &test_data, &value_list[0], ARRAY_SIZE(value_list));
@@ -212,12 +225,23 @@ static void testCCOVNotifyData(uint8_t invoke_id, const BACNET_COV_DATA *data)
     BACNET_COV_DATA test_data = { 0 };
     BACNET_PROPERTY_VALUE value_list[2] = { { 0 } };
     uint8_t test_invoke_id = 0;
+    uint8_t values[480] = { 0 };
+    uint8_t test_apdu[480] = { 0 };
+    int values_len = 0;
 
     null_len = ccov_notify_encode_apdu(NULL, sizeof(apdu), invoke_id, data);
     len = ccov_notify_encode_apdu(&apdu[0], sizeof(apdu), invoke_id, data);
     zassert_not_equal(len, 0, NULL);
     zassert_equal(len, null_len, NULL);
     apdu_len = len;
+    /* the same notification from a list of values encoded once */
+    values_len = cov_notify_values_encode(&values[0], data->listOfValues);
+    zassert_true(values_len > 0, NULL);
+    len = ccov_notify_encode_apdu_values(
+        &test_apdu[0], sizeof(test_apdu), invoke_id, data, &values[0],
+        values_len);
+    zassert_equal(len, apdu_len, NULL);
+    zassert_mem_equal(&test_apdu[0], &apdu[0], apdu_len, NULL);
 
     cov_data_value_list_link(&test_data, &value_list[0], 2);
     len = ccov_notify_decode_apdu(
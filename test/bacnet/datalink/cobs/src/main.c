@@ -11,6 +11,7 @@
 #include <zephyr/ztest.h>
 #include <stdlib.h>
 #include <bacnet/datalink/cobs.h>
+#include <bacnet/datalink/mstpdef.h>
 #include <bacnet/basic/sys/bytes.h>
 
 /**
@@ -52,6 +53,50 @@ static void test_COBS_Encode_Decode(void)
     zassert_true(
         test_buffer_length == sizeof(buffer), "COBS encode/decode length fail");
 }
+
+/**
+ * @brief Test the CRC-32K table and buffer against the bitwise CRC-32K
+ */
+#if defined(CONFIG_ZTEST_NEW_API)
+ZTEST(cobs_tests, test_COBS_CRC32K)
+#else
+static void test_COBS_CRC32K(void)
+#endif
+{
+    uint8_t buffer[Nmax_COBS_length_BACnet] = { 0 };
+    uint32_t crc32K, test_crc32K;
+    unsigned i, length, offset;
+
+    for (i = 0; i < 256; i++) {
+        zassert_equal(
+            cobs_crc32k((uint8_t)i, 0xFFFFFFFF),
+            cobs_crc32k_bitwise((uint8_t)i, 0xFFFFFFFF), NULL);
+        zassert_equal(
+            cobs_crc32k(0, i), cobs_crc32k_bitwise(0, i), NULL);
+    }
+    for (i = 0; i < sizeof(buffer); i++) {
+        buffer[i] = (uint8_t)rand();
+    }
+    /* lengths and alignments around the eight octets of a slice */
+    for (offset = 0; offset < 8; offset++) {
+        for (length = 0; length < 20; length++) {
+            crc32K = CRC32K_INITIAL_VALUE;
+            for (i = 0; i < length; i++) {
+                crc32K = cobs_crc32k_bitwise(buffer[offset + i], crc32K);
+            }
+            test_crc32K = cobs_crc32k_buffer(
+                &buffer[offset], length, CRC32K_INITIAL_VALUE);
+            zassert_equal(crc32K, test_crc32K, NULL);
+        }
+    }
+    crc32K = CRC32K_INITIAL_VALUE;
+    for (i = 0; i < sizeof(buffer); i++) {
+        crc32K = cobs_crc32k_bitwise(buffer[i], crc32K);
+    }
+    test_crc32K =
+        cobs_crc32k_buffer(buffer, sizeof(buffer), CRC32K_INITIAL_VALUE);
+    zassert_equal(crc32K, test_crc32K, NULL);
+}
 /**
  * @}
  */
@@ -61,7 +106,9 @@ ZTEST_SUITE(cobs_tests, NULL, NULL, NULL, NULL, NULL);
 #else
 void test_main(void)
 {
-    ztest_test_suite(cobs_tests, ztest_unit_test(test_COBS_Encode_Decode));
+    ztest_test_suite(
+        cobs_tests, ztest_unit_test(test_COBS_Encode_Decode),
+        ztest_unit_test(test_COBS_CRC32K));
 
     ztest_run_test_suite(cobs_tests);
 }
@@ -573,6 +573,118 @@ static void testReceiveNodeFSM(void)
         NULL);
 }
 
+/**
+ * @brief Receive frames from one span of octets, as from one read()
+ */
+static void testReceiveFrameSpan(void)
+{
+    struct mstp_port_struct_t mstp_port = { 0 };
+    static uint8_t span[MAX_MPDU * 4];
+    uint8_t data[600] = { 0 };
+    const uint8_t noise[] = { 0x00, 0x11, 0xFF, 0x55, 0x00 };
+    const uint8_t my_mac = 0x05;
+    unsigned len = 0, offset = 0, count = 0, i = 0;
+    unsigned bad_crc_offset = 0;
+
+    mstp_port.InputBuffer = &RxBuffer[0];
+    mstp_port.InputBufferSize = sizeof(RxBuffer);
+    mstp_port.OutputBuffer = &TxBuffer[0];
+    mstp_port.OutputBufferSize = sizeof(TxBuffer);
+    mstp_port.SilenceTimer = Timer_Silence;
+    mstp_port.SilenceTimerReset = Timer_Silence_Reset;
+    mstp_port.This_Station = my_mac;
+    mstp_port.Nmax_info_frames = 1;
+    mstp_port.Nmax_master = 127;
+    MSTP_Init(&mstp_port);
+    for (i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)i;
+    }
+    /* noise, with a Preamble1 that is not followed by Preamble2 */
+    memcpy(&span[len], noise, sizeof(noise));
+    len += sizeof(noise);
+    len += MSTP_Create_Frame(
+        &span[len], sizeof(span) - len, FRAME_TYPE_TOKEN, my_mac, 1, NULL, 0);
+    len += MSTP_Create_Frame(
+        &span[len], sizeof(span) - len,
+        FRAME_TYPE_BACNET_DATA_NOT_EXPECTING_REPLY, my_mac, 1, data, 100);
+    /* not for us */
+    len += MSTP_Create_Frame(
+        &span[len], sizeof(span) - len,
+        FRAME_TYPE_BACNET_DATA_NOT_EXPECTING_REPLY, my_mac + 1, 1, data, 200);
+    len += MSTP_Create_Frame(
+        &span[len], sizeof(span) - len,
+        FRAME_TYPE_BACNET_EXTENDED_DATA_NOT_EXPECTING_REPLY,
+        MSTP_BROADCAST_ADDRESS, 1, data, sizeof(data));
+    bad_crc_offset = len;
+    len += MSTP_Create_Frame(
+        &span[len], sizeof(span) - len,
+        FRAME_TYPE_BACNET_DATA_NOT_EXPECTING_REPLY, my_mac, 1, data, 50);
+    /* corrupt the last data CRC octet */
+    span[len - 1] ^= 0xFF;
+    zassert_true(len > bad_crc_offset, NULL);
+    SilenceTime = 0;
+    while (offset < len) {
+        offset +=
+            MSTP_Receive_Frame_Span(&mstp_port, &span[offset], len - offset);
+        if (mstp_port.ReceivedValidFrame) {
+            mstp_port.ReceivedValidFrame = false;
+            count++;
+            if (count == 1) {
+                zassert_equal(mstp_port.FrameType, FRAME_TYPE_TOKEN, NULL);
+                zassert_equal(mstp_port.DataLength, 0, NULL);
+            } else if (count == 2) {
+                zassert_equal(mstp_port.DataLength, 100, NULL);
+                zassert_mem_equal(mstp_port.InputBuffer, data, 100, NULL);
+            } else if (count == 3) {
+                /* skipped, but the state machine reports it */
+                zassert_equal(mstp_port.DestinationAddress, my_mac + 1, NULL);
+            } else if (count == 4) {
+                zassert_equal(
+                    mstp_port.FrameType,
+                    FRAME_TYPE_BACNET_EXTENDED_DATA_NOT_EXPECTING_REPLY, NULL);
+                zassert_equal(mstp_port.DataLength, sizeof(data), NULL);
+                zassert_mem_equal(
+                    mstp_port.InputBuffer, data, sizeof(data), NULL);
+            }
+        } else if (mstp_port.ReceivedInvalidFrame) {
+            mstp_port.ReceivedInvalidFrame = false;
+            zassert_equal(count, 4, NULL);
+            zassert_equal(offset, len, NULL);
+            count++;
+        }
+    }
+    zassert_equal(count, 5, NULL);
+    zassert_equal(mstp_port.receive_state, MSTP_RECEIVE_STATE_IDLE, NULL);
+    /* the same events as receiving one octet at a time */
+    count = mstp_port.EventCount;
+    MSTP_Init(&mstp_port);
+    mstp_port.EventCount = 0;
+    for (offset = 0; offset < len; offset++) {
+        mstp_port.DataRegister = span[offset];
+        mstp_port.DataAvailable = true;
+        MSTP_Receive_Frame_FSM(&mstp_port);
+    }
+    zassert_equal(mstp_port.EventCount, count, NULL);
+    /* a frame split across spans, with a timeout between them */
+    MSTP_Init(&mstp_port);
+    len = MSTP_Create_Frame(
+        span, sizeof(span), FRAME_TYPE_BACNET_DATA_NOT_EXPECTING_REPLY, my_mac,
+        1, data, 100);
+    offset = MSTP_Receive_Frame_Span(&mstp_port, span, 50);
+    zassert_equal(offset, 50, NULL);
+    zassert_equal(mstp_port.receive_state, MSTP_RECEIVE_STATE_DATA, NULL);
+    offset += MSTP_Receive_Frame_Span(&mstp_port, &span[offset], len - offset);
+    zassert_equal(offset, len, NULL);
+    zassert_true(mstp_port.ReceivedValidFrame, NULL);
+    mstp_port.ReceivedValidFrame = false;
+    offset = MSTP_Receive_Frame_Span(&mstp_port, span, 50);
+    SilenceTime = mstp_port.Tframe_abort + 1;
+    offset += MSTP_Receive_Frame_Span(&mstp_port, &span[offset], len - offset);
+    zassert_true(mstp_port.ReceivedInvalidFrame, NULL);
+    zassert_equal(offset, 50, NULL);
+    zassert_equal(MSTP_Receive_Frame_Span(&mstp_port, NULL, 1), 0, NULL);
+}
+
 static void testMasterNodeFSM(void)
 {
     struct mstp_port_struct_t MSTP_Port; /* port data */
@@ -1134,6 +1246,7 @@ void test_main(void)
 {
     ztest_test_suite(
         crc_tests, ztest_unit_test(testReceiveNodeFSM),
+        ztest_unit_test(testReceiveFrameSpan),
         ztest_unit_test(testMasterNodeFSM), ztest_unit_test(testSlaveNodeFSM),
         ztest_unit_test(testZeroConfigNodeFSM));
 
@@ -204,6 +204,23 @@ static void testReadPropertyMultiple(void)
     zassert_equal(len, service_request_len, NULL);
 }
 
+static unsigned Ack_Value_Count;
+static unsigned Ack_Error_Count;
+
+/**
+ * @brief Count the values and the errors of the ACK
+ */
+static void
+test_rpm_ack_process(uint32_t device_id, BACNET_READ_PROPERTY_DATA *rp_data)
+{
+    (void)device_id;
+    if (rp_data->error_code == ERROR_CODE_SUCCESS) {
+        Ack_Value_Count++;
+    } else {
+        Ack_Error_Count++;
+    }
+}
+
 #if defined(CONFIG_ZTEST_NEW_API)
 ZTEST(rpm_tests, testReadPropertyMultipleAck)
 #else
@@ -229,6 +246,7 @@ static void testReadPropertyMultipleAck(void)
     BACNET_ERROR_CLASS error_class;
     BACNET_ERROR_CODE error_code;
     BACNET_RPM_DATA rpmdata;
+    BACNET_READ_PROPERTY_DATA rp_data = { 0 };
 
     /* build the RPM - try to make it easy for the
        Application Layer development */
@@ -431,6 +449,17 @@ static void testReadPropertyMultipleAck(void)
         &object_instance);
     zassert_equal(test_len, 0, NULL);
     zassert_equal(len, service_request_len, NULL);
+    /* process every property of every object */
+    Ack_Value_Count = 0;
+    Ack_Error_Count = 0;
+    rp_data.error_code = ERROR_CODE_SUCCESS;
+    rpm_ack_object_property_process(
+        service_request, service_request_len, 123, &rp_data,
+        test_rpm_ack_process);
+    zassert_equal(Ack_Value_Count, 3, NULL);
+    zassert_equal(Ack_Error_Count, 1, NULL);
+    zassert_equal(rp_data.object_type, OBJECT_ANALOG_INPUT, NULL);
+    zassert_equal(rp_data.error_code, ERROR_CODE_UNKNOWN_PROPERTY, NULL);
 }
 /**
  * @}